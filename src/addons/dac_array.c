@@ -38,6 +38,7 @@
 /* #define ARRAY_DEBUG */
 
 #define ARRAY_MD_KEY "daos_array_metadata"
+#define ENUM_KEY_BUF	32
 #define CELL_SIZE "daos_array_cell_size"
 #define BLOCK_SIZE "daos_array_block_size"
 
@@ -48,6 +49,8 @@ struct dac_array {
 	daos_size_t	cell_size;
 	/** elems to store in 1 dkey before moving to the next one in the grp */
 	daos_size_t	block_size;
+	/** dkeys are uint64 block numbers, see array_dkey_ordered() */
+	bool		ordered;
 	/** ref count on array */
 	unsigned int	cob_ref;
 };
@@ -109,6 +112,91 @@ array_hdl2ptr(daos_handle_t oh)
 	return obj;
 }
 
+/** uint64 dkey of the array metadata for array with ordered dkeys */
+static uint64_t array_md_dkey;
+
+/**
+ * An array object created with DAOS_OF_DKEY_UINT64 stores dkey number N as
+ * native uint64 N + 1 (0 is reserved for metadata), so dkeys are sorted by
+ * block number and the last one can be located without full enumeration.
+ * Other array objects use decimal strings as dkeys.
+ */
+static inline bool
+array_dkey_ordered(daos_obj_id_t oid)
+{
+	return daos_obj_id2feat(oid) & DAOS_OF_DKEY_UINT64;
+}
+
+static void
+array_md_dkey_set(daos_obj_id_t oid, daos_key_t *dkey)
+{
+	if (array_dkey_ordered(oid))
+		daos_iov_set(dkey, &array_md_dkey, sizeof(array_md_dkey));
+	else
+		daos_iov_set(dkey, ARRAY_MD_KEY, strlen(ARRAY_MD_KEY));
+}
+
+/** allocate the dkey buffer of dkey number \a dkey_num */
+static int
+array_dkey_alloc(bool ordered, daos_size_t dkey_num, char **dkey_str)
+{
+	int ret;
+
+	if (ordered) {
+		uint64_t key = dkey_num + 1;
+
+		*dkey_str = malloc(sizeof(key));
+		if (*dkey_str == NULL)
+			return -DER_NOMEM;
+		memcpy(*dkey_str, &key, sizeof(key));
+		return 0;
+	}
+
+	ret = asprintf(dkey_str, "%zu", dkey_num);
+	if (ret < 0 || *dkey_str == NULL)
+		return -DER_NOMEM;
+	return 0;
+}
+
+static daos_size_t
+array_dkey_len(bool ordered, char *dkey_str)
+{
+	return ordered ? sizeof(uint64_t) : strlen(dkey_str);
+}
+
+/**
+ * Convert an enumerated dkey to its dkey number, returns false if it is
+ * the metadata dkey.
+ */
+static bool
+array_dkey2num(bool ordered, char *key, daos_size_t key_len,
+	       daos_size_t *dkey_num)
+{
+	char	buf[ENUM_KEY_BUF];
+	int	ret;
+
+	if (ordered) {
+		uint64_t val;
+
+		D__ASSERT(key_len == sizeof(val));
+		memcpy(&val, key, sizeof(val));
+		if (val == 0)
+			return false;
+		*dkey_num = val - 1;
+		return true;
+	}
+
+	if (key_len == strlen(ARRAY_MD_KEY) &&
+	    !strncmp(ARRAY_MD_KEY, key, key_len))
+		return false;
+
+	D__ASSERT(key_len < ENUM_KEY_BUF);
+	snprintf(buf, key_len + 1, "%s", key);
+	ret = sscanf(buf, "%zu", dkey_num);
+	D__ASSERT(ret == 1);
+	return true;
+}
+
 
 static int
 free_io_params_cb(tse_task_t *task, void *data)
@@ -163,6 +251,7 @@ create_handle_cb(tse_task_t *task, void *data)
 	array->daos_oh = *args->oh;
 	array->cell_size = args->cell_size;
 	array->block_size = args->block_size;
+	array->ordered = array_dkey_ordered(args->oid);
 
 	*args->oh = array_ptr2hdl(array);
 
@@ -225,7 +314,7 @@ write_md_cb(tse_task_t *task, void *data)
 	params->user_sgl_used = false;
 
 	/** init dkey */
-	daos_iov_set(&params->dkey, ARRAY_MD_KEY, strlen(ARRAY_MD_KEY));
+	array_md_dkey_set(args->oid, &params->dkey);
 
 	/** init scatter/gather */
 	params->sgl.sg_iovs = malloc(sizeof(daos_iov_t) * 2);
@@ -357,6 +446,7 @@ open_handle_cb(tse_task_t *task, void *data)
 	array->daos_oh = *args->oh;
 	array->cell_size = *args->cell_size;
 	array->block_size = *args->block_size;
+	array->ordered = array_dkey_ordered(args->oid);
 
 	*args->oh = array_ptr2hdl(array);
 
@@ -395,7 +485,7 @@ fetch_md_cb(tse_task_t *task, void *data)
 	params->user_sgl_used = false;
 
 	/** init dkey */
-	daos_iov_set(&params->dkey, ARRAY_MD_KEY, strlen(ARRAY_MD_KEY));
+	array_md_dkey_set(args->oid, &params->dkey);
 
 	/** init scatter/gather */
 	params->sgl.sg_iovs = malloc(sizeof(daos_iov_t) * 2);
@@ -612,12 +702,12 @@ compute_dkey(struct dac_array *array, daos_off_t array_idx,
 		*num_records = array->block_size - *record_i;
 
 	if (dkey_str) {
-		int ret;
+		int rc;
 
-		ret = asprintf(dkey_str, "%zu", dkey_num);
-		if (ret < 0 || *dkey_str == NULL) {
+		rc = array_dkey_alloc(array->ordered, dkey_num, dkey_str);
+		if (rc != 0) {
 			D__ERROR("Failed memory allocation\n");
-			return -DER_NOMEM;
+			return rc;
 		}
 	}
 
@@ -793,7 +883,8 @@ dac_array_io(daos_handle_t array_oh, daos_epoch_t epoch,
 		printf("array_idx = %d\t num_records = %zu\t record_i = %d\n",
 		       (int)array_idx, num_records, (int)record_i);
 #endif
-		daos_iov_set(dkey, (void *)dkey_str, strlen(dkey_str));
+		daos_iov_set(dkey, (void *)dkey_str,
+			     array_dkey_len(array->ordered, dkey_str));
 
 		/* set descriptor for KV object */
 		daos_iov_set(&iod->iod_name, (void *)params->akey_str,
@@ -890,7 +981,8 @@ dac_array_io(daos_handle_t array_oh, daos_epoch_t epoch,
 					return rc;
 				}
 
-				D__ASSERT(strcmp(dkey_str_tmp, dkey_str) == 0);
+				D__ASSERT(memcmp(dkey_str_tmp, dkey_str,
+						 dkey->iov_len) == 0);
 
 				free(dkey_str_tmp);
 				dkey_str_tmp = NULL;
@@ -1018,13 +1110,11 @@ dac_array_write(tse_task_t *task)
 			    DAOS_OPC_ARRAY_WRITE, task);
 }
 
-#define ENUM_KEY_BUF	32
 #define ENUM_DESC_BUF	512
 #define ENUM_DESC_NR	5
 
 struct get_size_props {
 	struct dac_array *array;
-	char		key[ENUM_DESC_BUF];
 	char		buf[ENUM_DESC_BUF];
 	daos_key_desc_t kds[ENUM_DESC_NR];
 	daos_iov_t	iov;
@@ -1040,6 +1130,7 @@ struct get_size_props {
 struct list_recxs_params {
 	daos_key_t		dkey;
 	char			*dkey_str;
+	daos_size_t		dkey_num;
 	daos_key_t		akey;
 	char			*akey_str;
 	daos_recx_t		recx;
@@ -1056,8 +1147,6 @@ list_recxs_cb(tse_task_t *task, void *data)
 {
 	daos_obj_list_recx_t *args = daos_task_get_args(task);
 	struct list_recxs_params *params = *((struct list_recxs_params **)data);
-	daos_size_t dkey_num;
-	int ret;
 	int rc = task->dt_result;
 	daos_size_t cur_size;
 
@@ -1067,9 +1156,7 @@ list_recxs_cb(tse_task_t *task, void *data)
 	       (int)params->recx.rx_nr);
 #endif
 
-	ret = sscanf(params->dkey_str, "%zu", &dkey_num);
-	D__ASSERT(ret == 1);
-	cur_size = dkey_num * params->block_size + params->recx.rx_idx +
+	cur_size = params->dkey_num * params->block_size + params->recx.rx_idx +
 		params->recx.rx_nr;
 	if (*params->size < cur_size)
 		*params->size = cur_size;
@@ -1121,24 +1208,21 @@ get_array_size_cb(tse_task_t *task, void *data)
 
 	/** track the highest dkey from the ones currently enumerated */
 	for (ptr = props->buf, i = 0; i < props->nr; i++) {
-		daos_size_t dkey_num;
-		int ret;
+		daos_size_t	dkey_num;
+		bool		found;
 
-		snprintf(props->key, args->kds[i].kd_key_len + 1, "%s", ptr);
+		found = array_dkey2num(array->ordered, ptr,
+				       args->kds[i].kd_key_len, &dkey_num);
 #ifdef ARRAY_DEBUG
-		printf("%d: key %s len %d\n", i, props->key,
-		       (int)args->kds[i].kd_key_len);
+		printf("%d: key len %d\n", i, (int)args->kds[i].kd_key_len);
 #endif
 		ptr += args->kds[i].kd_key_len;
 
-		if (!strcmp(ARRAY_MD_KEY, props->key))
+		if (!found)
 			continue;
 
 		props->found_dkey = true;
 		/** Keep a record of the highest dkey */
-		ret = sscanf(props->key, "%zu", &dkey_num);
-		D__ASSERT(ret == 1);
-
 		if (dkey_num > props->dkey_num)
 			props->dkey_num = dkey_num;
 	}
@@ -1168,10 +1252,6 @@ get_array_size_cb(tse_task_t *task, void *data)
 	if (!props->found_dkey)
 		D__GOTO(out, rc = 0);
 
-	char key[ENUM_KEY_BUF];
-
-	sprintf(key, "%zu", props->dkey_num);
-
 	/** retrieve the highest index from the highest key */
 	props->nr = ENUM_DESC_NR;
 
@@ -1191,9 +1271,14 @@ get_array_size_cb(tse_task_t *task, void *data)
 
 	io_task = params->task;
 	params->akey_str = strdup("akey_not_used");
-	params->dkey_str = strdup(key);
-	daos_iov_set(dkey, (void *)params->dkey_str, strlen(params->dkey_str));
+	rc = array_dkey_alloc(array->ordered, props->dkey_num,
+			      &params->dkey_str);
+	if (rc != 0)
+		D__GOTO(out, rc);
+	daos_iov_set(dkey, (void *)params->dkey_str,
+		     array_dkey_len(array->ordered, params->dkey_str));
 	daos_iov_set(akey, (void *)params->akey_str, strlen(params->akey_str));
+	params->dkey_num = props->dkey_num;
 	params->nr = 1;
 	params->block_size = array->block_size;
 	params->size = props->size;
@@ -1289,6 +1374,9 @@ dac_array_get_size(tse_task_t *task)
 	enum_args->kds	  = get_size_props->kds;
 	enum_args->sgl	  = &get_size_props->sgl;
 	enum_args->anchor = &get_size_props->anchor;
+	/** ordered dkeys: only the last dkey of each target is needed */
+	if (array->ordered)
+		enum_args->flags = DAOS_OBJ_LIST_DKEY_LAST;
 
 	rc = tse_task_register_cbs(enum_task, NULL, NULL, 0, get_array_size_cb,
 				    &get_size_props, sizeof(get_size_props));
@@ -1322,7 +1410,6 @@ err_task:
 } /* end daos_array_get_size */
 
 struct set_size_props {
-	char		key[ENUM_DESC_BUF];
 	char		buf[ENUM_DESC_BUF];
 	daos_key_desc_t kds[ENUM_DESC_NR];
 	char		*val;
@@ -1337,6 +1424,7 @@ struct set_size_props {
 	daos_size_t	num_records;
 	daos_size_t	block_size;
 	daos_off_t	record_i;
+	bool		ordered;
 	tse_task_t	*ptask;
 };
 
@@ -1366,23 +1454,19 @@ adjust_array_size_cb(tse_task_t *task, void *data)
 		props->update_dkey = false;
 
 	for (ptr = props->buf, j = 0; j < props->nr; j++) {
-		daos_size_t dkey_num;
-		int ret;
+		daos_size_t	dkey_num;
+		bool		found;
 
-		snprintf(props->key, args->kds[j].kd_key_len + 1, "%s", ptr);
+		found = array_dkey2num(props->ordered, ptr,
+				       args->kds[j].kd_key_len, &dkey_num);
 #ifdef ARRAY_DEBUG
-		printf("%d: key %s len %d\n", j, props->key,
-		       (int)args->kds[j].kd_key_len);
+		printf("%d: key len %d\n", j, (int)args->kds[j].kd_key_len);
 #endif
 		ptr += args->kds[j].kd_key_len;
 
-		if (!strcmp(ARRAY_MD_KEY, props->key))
+		if (!found)
 			continue;
 
-		/** Keep a record of the highest dkey */
-		ret = sscanf(props->key, "%zu", &dkey_num);
-		D__ASSERT(ret == 1);
-
 		if (props->size == 0 || dkey_num > props->dkey_num) {
 			daos_obj_punch_t	*p_args;
 			daos_key_t		*dkey;
@@ -1399,10 +1483,14 @@ adjust_array_size_cb(tse_task_t *task, void *data)
 			}
 
 			io_task = params->task;
-			params->dkey_str = strdup(props->key);
+			rc = array_dkey_alloc(props->ordered, dkey_num,
+					      &params->dkey_str);
+			if (rc != 0)
+				D__GOTO(err_out, rc);
 			dkey = &params->dkey;
 			daos_iov_set(dkey, (void *)params->dkey_str,
-				     strlen(params->dkey_str));
+				     array_dkey_len(props->ordered,
+						    params->dkey_str));
 
 			/** Punch this entire dkey */
 #ifdef ARRAY_DEBUG
@@ -1465,10 +1553,14 @@ adjust_array_size_cb(tse_task_t *task, void *data)
 			params->next = NULL;
 			params->user_sgl_used = false;
 
-			params->dkey_str = strdup(props->key);
+			rc = array_dkey_alloc(props->ordered, dkey_num,
+					      &params->dkey_str);
+			if (rc != 0)
+				D__GOTO(err_out, rc);
 			dkey = &params->dkey;
 			daos_iov_set(dkey, (void *)params->dkey_str,
-				     strlen(params->dkey_str));
+				     array_dkey_len(props->ordered,
+						    params->dkey_str));
 
 			/* set descriptor for KV object */
 			daos_iov_set(&iod->iod_name, (void *)params->akey_str,
@@ -1566,13 +1658,14 @@ adjust_array_size_cb(tse_task_t *task, void *data)
 		params->next = NULL;
 		params->user_sgl_used = false;
 
-		rc = asprintf(&params->dkey_str, "%zu", props->dkey_num);
-		if (rc < 0 || params->dkey_str == NULL) {
+		rc = array_dkey_alloc(props->ordered, props->dkey_num,
+				      &params->dkey_str);
+		if (rc != 0) {
 			D__ERROR("Failed memory allocation\n");
-			D__GOTO(err_out, -DER_NOMEM);
+			D__GOTO(err_out, rc);
 		}
 		daos_iov_set(dkey, (void *)params->dkey_str,
-			     strlen(params->dkey_str));
+			     array_dkey_len(props->ordered, params->dkey_str));
 
 		/** set memory location */
 		props->val = calloc(1, props->cell_size);
@@ -1641,13 +1734,13 @@ dac_array_set_size(tse_task_t *task)
 	daos_array_set_size_t	*args;
 	daos_handle_t		oh;
 	struct dac_array	*array;
-	char			*dkey_str = NULL;
+	daos_size_t		dkey_num;
 	daos_size_t		num_records;
 	daos_off_t		record_i;
 	daos_obj_list_dkey_t	*enum_args;
 	struct set_size_props	*set_size_props = NULL;
 	tse_task_t		*enum_task;
-	int			rc, ret;
+	int			rc;
 
 	args = daos_task_get_args(task);
 	array = array_hdl2ptr(args->oh);
@@ -1658,12 +1751,13 @@ dac_array_set_size(tse_task_t *task)
 
 	/** get key information for the last record */
 	if (args->size == 0) {
-		dkey_str = strdup("0_0");
+		dkey_num = 0;
 		num_records = array->block_size;
 		record_i = 0;
 	} else {
+		dkey_num = (args->size - 1) / array->block_size;
 		rc = compute_dkey(array, args->size-1, &num_records, &record_i,
-				  &dkey_str);
+				  NULL);
 		if (rc != 0) {
 			D__ERROR("Failed to compute dkey\n");
 			D__GOTO(err_task, rc);
@@ -1673,14 +1767,11 @@ dac_array_set_size(tse_task_t *task)
 	D__ASSERT(record_i + num_records == array->block_size);
 
 	D__ALLOC_PTR(set_size_props);
-	if (set_size_props == NULL) {
-		free(dkey_str);
+	if (set_size_props == NULL)
 		D__GOTO(err_task, rc = -DER_NOMEM);
-	}
 
-	ret = sscanf(dkey_str, "%zu", &set_size_props->dkey_num);
-	D__ASSERT(ret == 1);
-	free(dkey_str);
+	set_size_props->dkey_num = dkey_num;
+	set_size_props->ordered = array->ordered;
 
 	set_size_props->cell_size = array->cell_size;
 	set_size_props->num_records = num_records;
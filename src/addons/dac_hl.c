@@ -231,74 +231,3 @@ dac_kv_remove(tse_task_t *task)
 {
 	return -DER_NOSYS;
 }
-
-static int
-dac_multi_io(daos_handle_t oh, daos_epoch_t epoch, unsigned int num_dkeys,
-	     daos_dkey_io_t *io_array, daos_opc_t opc, tse_task_t *task)
-{
-	daos_opc_t	d_opc;
-	daos_list_t	head;
-	int		i;
-	int		rc = 0;
-
-	d_opc = (opc == DAOS_OPC_OBJ_FETCH_MULTI ? DAOS_OPC_OBJ_FETCH :
-		DAOS_OPC_OBJ_UPDATE);
-	DAOS_INIT_LIST_HEAD(&head);
-
-	for (i = 0; i < num_dkeys; i++) {
-		tse_task_t	 *io_task;
-		daos_obj_fetch_t *args;
-
-		rc = daos_task_create(d_opc, tse_task2sched(task), 0, NULL,
-				      &io_task);
-		if (rc != 0)
-			D__GOTO(err_task, rc);
-
-		args = daos_task_get_args(io_task);
-		args->oh	= oh;
-		args->epoch	= epoch;
-		args->dkey	= io_array[i].ioa_dkey;
-		args->nr	= io_array[i].ioa_nr;
-		args->iods	= io_array[i].ioa_iods;
-		args->sgls	= io_array[i].ioa_sgls;
-		args->maps	= io_array[i].ioa_maps;
-
-		tse_task_list_add(io_task, &head);
-	}
-
-	rc = tse_task_depend_list(task, &head);
-	if (rc != 0)
-		D__GOTO(err_task, rc);
-
-	tse_task_list_sched(&head, false);
-	tse_sched_progress(tse_task2sched(task));
-	return 0;
-
-err_task:
-	while (!daos_list_empty(&head)) {
-		tse_task_t *tmp = tse_task_list_first(&head);
-
-		tse_task_list_del(tmp);
-		tse_task_decref(tmp);
-	}
-	tse_task_complete(task, rc);
-	return rc;
-}
-
-int
-dac_obj_fetch_multi(tse_task_t *task)
-{
-	daos_obj_multi_io_t *args = daos_task_get_args(task);
-
-	return dac_multi_io(args->oh, args->epoch, args->num_dkeys,
-			    args->io_array, DAOS_OPC_OBJ_FETCH_MULTI, task);
-}
-
-int
-dac_obj_update_multi(tse_task_t *task)
-{
-	daos_obj_multi_io_t *args = daos_task_get_args(task);
-
-	return dac_multi_io(args->oh, args->epoch, args->num_dkeys,
-			    args->io_array, DAOS_OPC_OBJ_UPDATE_MULTI, task);
-}
@@ -31,6 +31,7 @@
 #include <daos/common.h>
 #include <daos/event.h>
 #include <daos/addons.h>
+#include <daos/object.h>
 #include <daos_addons.h>
 
 int
@@ -97,7 +98,7 @@ daos_obj_fetch_multi(daos_handle_t oh, daos_epoch_t epoch,
 	if (num_dkeys == 0)
 		return 0;
 
-	rc = dc_task_create(dac_obj_fetch_multi, NULL, ev, &task);
+	rc = dc_task_create(dc_obj_fetch_multi, NULL, ev, &task);
 	if (rc)
 		return rc;
 
@@ -122,7 +123,7 @@ daos_obj_update_multi(daos_handle_t oh, daos_epoch_t epoch,
 	if (num_dkeys == 0)
 		return 0;
 
-	rc = dc_task_create(dac_obj_update_multi, NULL, ev, &task);
+	rc = dc_task_create(dc_obj_update_multi, NULL, ev, &task);
 	if (rc)
 		return rc;
 
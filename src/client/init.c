@@ -46,6 +46,7 @@ const struct daos_task_api dc_funcs[] = {
 	{dc_pool_extend, sizeof(daos_pool_extend_t)},
 	{dc_pool_evict, sizeof(daos_pool_evict_t)},
 	{dc_mgmt_params_set, sizeof(daos_params_set_t)},
+	{dc_mgmt_metrics_query, sizeof(daos_metrics_query_t)},
 	{dc_pool_connect, sizeof(daos_pool_connect_t)},
 	{dc_pool_disconnect, sizeof(daos_pool_disconnect_t)},
 	{dc_pool_exclude, sizeof(daos_pool_update_t)},
@@ -97,8 +98,8 @@ const struct daos_task_api dc_funcs[] = {
 	{dac_kv_get, sizeof(daos_kv_get_t)},
 	{dac_kv_put, sizeof(daos_kv_put_t)},
 	{dac_kv_remove, sizeof(daos_kv_remove_t)},
-	{dac_obj_fetch_multi, sizeof(daos_obj_multi_io_t)},
-	{dac_obj_update_multi, sizeof(daos_obj_multi_io_t)},
+	{dc_obj_fetch_multi, sizeof(daos_obj_multi_io_t)},
+	{dc_obj_update_multi, sizeof(daos_obj_multi_io_t)},
 };
 
 /**
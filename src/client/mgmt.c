@@ -72,6 +72,27 @@ daos_mgmt_params_set(const char *grp, d_rank_t rank, unsigned int key_id,
 	return dc_task_schedule(task, true);
 }
 
+int
+daos_mgmt_metrics_query(const char *grp, d_rank_t rank,
+			struct daos_metrics *metrics, daos_event_t *ev)
+{
+	daos_metrics_query_t	*args;
+	tse_task_t		*task;
+	int			 rc;
+
+	DAOS_API_ARG_ASSERT(*args, METRICS_QUERY);
+	rc = dc_task_create(dc_mgmt_metrics_query, NULL, ev, &task);
+	if (rc)
+		return rc;
+
+	args = dc_task_get_args(task);
+	args->grp	= grp;
+	args->rank	= rank;
+	args->metrics	= metrics;
+
+	return dc_task_schedule(task, true);
+}
+
 int
 daos_pool_create(unsigned int mode, unsigned int uid, unsigned int gid,
 		 const char *grp, const d_rank_list_t *tgts, const char *dev,
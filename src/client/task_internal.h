@@ -72,6 +72,7 @@ struct daos_task_args {
 		daos_obj_punch_t	obj_punch;
 		daos_obj_query_t	obj_query;
 		daos_obj_fetch_t	obj_fetch;
+		daos_obj_fetch_shard_t	obj_fetch_shard;
 		daos_obj_update_t	obj_update;
 		daos_obj_list_dkey_t	obj_list_dkey;
 		daos_obj_list_akey_t	obj_list_akey;
@@ -31,6 +31,14 @@
 
 #include <daos_errno.h>
 #include <daos/btree.h>
+#include <daos/metrics.h>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define BTR_HAS_AVX2		1
+#else
+#define BTR_HAS_AVX2		0
+#endif
 
 /**
  * Tree node types.
@@ -59,7 +67,8 @@ union btr_rec_buf {
 	struct btr_record		rb_rec;
 	struct {
 		struct btr_record	rec;
-		char			key[DAOS_HKEY_MAX];
+		char			key[DAOS_HKEY_MAX +
+					    BTR_REC_INLINE_MAX];
 	}				rb_buf;
 };
 
@@ -102,6 +111,13 @@ struct btr_trace {
 /** backtrace depth */
 #define BTR_TRACE_MAX		40
 
+/**
+ * Percentage of records kept by the left node when splitting the rightmost
+ * node for an append, instead of splitting it in the middle. Nodes filled by
+ * sequential keys are almost full.
+ */
+#define BTR_SPLIT_TAIL_PCT	90
+
 /**
  * Context for btree operations.
  * NB: object cache will retain this data structure.
@@ -119,14 +135,80 @@ struct btr_context {
 	unsigned short			 tc_ref;
 	/** cached tree class, avoid loading from slow memory */
 	unsigned short			 tc_class;
+	/**
+	 * the last update of this context appended a key to the rightmost
+	 * leaf, so the next one tries to append it again from the trace
+	 * instead of probing from the root, see btr_append_prep.
+	 */
+	unsigned short			 tc_append;
 	/** cached feature bits, avoid loading from slow memory */
 	uint64_t			 tc_feats;
+	/** the pinned snapshot if this is a read-only snapshot handle */
+	struct btr_snap			*tc_snap;
 	/** trace for the tree root */
 	struct btr_trace		*tc_trace;
 	/** trace buffer */
 	struct btr_trace		 tc_traces[BTR_TRACE_MAX];
 };
 
+/**
+ * Snapshot of a tree, it pins the root of the tree at a generation. Nodes
+ * and records visible to a snapshot are copied on write, and the replaced
+ * ones are retired instead of being freed, see dbtree_snapshot.
+ */
+struct btr_snap {
+	/** link on btr_cow::bc_snaps */
+	daos_list_t			 bs_link;
+	/** copy-on-write state of the tree */
+	struct btr_cow			*bs_cow;
+	/** generation of the tree when the snapshot was taken */
+	uint64_t			 bs_gen;
+	/** refcount, the snapshot handle and its iterators */
+	unsigned int			 bs_ref;
+	/** copy of the tree root when the snapshot was taken */
+	struct btr_root			 bs_root;
+};
+
+/** Node or record which is freed after all snapshots which can see it */
+struct btr_retired {
+	/** link on btr_cow::bc_retired */
+	daos_list_t			 br_link;
+	/** generation of the tree when it was retired */
+	uint64_t			 br_gen;
+	/** the retired node, it is NULL for a record */
+	TMMID(struct btr_node)		 br_node;
+	/** copy of the retired record */
+	union btr_rec_buf		 br_rec;
+};
+
+/**
+ * Copy-on-write state of a tree which has snapshots. It is found by the
+ * address of the tree root, so all open handles of the tree copy on write.
+ * It outlives the last snapshot if some retired nodes or records could not
+ * be freed, they are freed by the release of a later snapshot, or by the
+ * destroy of the tree.
+ */
+struct btr_cow {
+	/** next tree with snapshots */
+	struct btr_cow			*bc_next;
+	/**
+	 * root of the tree, it is pinned by the snapshots because the tree
+	 * cannot be destroyed, neither can the record which holds it, while
+	 * it has snapshots.
+	 */
+	struct btr_root			*bc_root;
+	/** pinned snapshots, the oldest first */
+	daos_list_t			 bc_snaps;
+	/** retired nodes and records, the oldest first */
+	daos_list_t			 bc_retired;
+};
+
+/**
+ * Trees with snapshots. A tree is only accessed by one xstream, so they are
+ * per-thread and readers of snapshots don't need any lock.
+ */
+static __thread struct btr_cow	*btr_cows;
+
 /** size of print buffer */
 #define BTR_PRINT_BUF			128
 
@@ -140,10 +222,23 @@ static struct btr_record *btr_node_rec_at(struct btr_context *tcx,
 static int btr_node_insert_rec(struct btr_context *tcx,
 			       struct btr_trace *trace,
 			       struct btr_record *rec);
-static void btr_node_destroy(struct btr_context *tcx,
-			     TMMID(struct btr_node) nd_mmid,
-			     void *args);
+static int btr_node_empty(struct btr_context *tcx,
+			  TMMID(struct btr_node) nd_mmid, void *args);
+static int btr_node_destroy(struct btr_context *tcx,
+			    TMMID(struct btr_node) nd_mmid,
+			    void *args);
 static int btr_root_tx_add(struct btr_context *tcx);
+static bool btr_node_is_shared(struct btr_context *tcx,
+			       TMMID(struct btr_node) nd_mmid);
+static struct btr_cow *btr_cow_find(struct btr_context *tcx);
+static int btr_retire(struct btr_context *tcx, struct btr_cow *cow,
+		      TMMID(struct btr_node) nd_mmid, struct btr_record *rec);
+static struct btr_cow *btr_cow_lookup(struct btr_context *tcx);
+static int btr_cow_free(struct btr_context *tcx, struct btr_cow *cow, int nr,
+			int *freed);
+static void btr_cow_forget(struct btr_cow *cow, int nr);
+static void btr_cow_release(struct btr_cow *cow);
+static void btr_snap_put(struct btr_context *tcx);
 static bool btr_probe_prev(struct btr_context *tcx);
 static bool btr_probe_next(struct btr_context *tcx);
 static bool btr_probe_is_public(dbtree_probe_opc_t opc);
@@ -201,8 +296,11 @@ btr_context_decref(struct btr_context *tcx)
 {
 	D__ASSERT(tcx->tc_ref > 0);
 	tcx->tc_ref--;
-	if (tcx->tc_ref == 0)
+	if (tcx->tc_ref == 0) {
+		if (tcx->tc_snap != NULL)
+			btr_snap_put(tcx);
 		D__FREE_PTR(tcx);
+	}
 }
 
 static void
@@ -281,6 +379,11 @@ btr_context_clone(struct btr_context *tcx, struct btr_context **tcx_p)
 	umem_attr_get(&tcx->tc_tins.ti_umm, &uma);
 	rc = btr_context_create(tcx->tc_tins.ti_root_mmid,
 				tcx->tc_tins.ti_root, -1, -1, -1, &uma, tcx_p);
+	if (rc == 0 && tcx->tc_snap != NULL) {
+		/* iterator of a snapshot, it also pins the snapshot */
+		(*tcx_p)->tc_snap = tcx->tc_snap;
+		tcx->tc_snap->bs_ref++;
+	}
 	return rc;
 }
 
@@ -363,9 +466,27 @@ btr_hkey_copy(struct btr_context *tcx, char *dst_key, char *src_key)
 	memcpy(dst_key, src_key, btr_hkey_size(tcx));
 }
 
+/** load the 64-bit prefix of a hashed key, see BTR_FEAT_HKEY_PREFIX */
+static inline uint64_t
+btr_hkey_prefix(void *hkey)
+{
+	uint64_t prefix;
+
+	memcpy(&prefix, hkey, sizeof(prefix));
+	return prefix;
+}
+
 static int
 btr_hkey_cmp(struct btr_context *tcx, struct btr_record *rec, void *hkey)
 {
+	if (tcx->tc_feats & BTR_FEAT_HKEY_PREFIX) {
+		uint64_t prefix1 = btr_hkey_prefix(&rec->rec_hkey[0]);
+		uint64_t prefix2 = btr_hkey_prefix(hkey);
+
+		if (prefix1 != prefix2)
+			return prefix1 < prefix2 ? -1 : 1;
+	}
+
 	if (btr_ops(tcx)->to_hkey_cmp)
 		return btr_ops(tcx)->to_hkey_cmp(&tcx->tc_tins, rec, hkey);
 	else
@@ -388,11 +509,23 @@ btr_rec_alloc(struct btr_context *tcx, daos_iov_t *key, daos_iov_t *val,
 	return btr_ops(tcx)->to_rec_alloc(&tcx->tc_tins, key, val, rec);
 }
 
-static void
+static int
 btr_rec_free(struct btr_context *tcx, struct btr_record *rec, void *args)
 {
-	if (!UMMID_IS_NULL(rec->rec_mmid))
-		btr_ops(tcx)->to_rec_free(&tcx->tc_tins, rec, args);
+	struct btr_cow *cow;
+
+	if (UMMID_IS_NULL(rec->rec_mmid))
+		return 0;
+
+	/* The record body may be visible to a snapshot, free it after the
+	 * snapshot is released. NB: \a args may take over the record body,
+	 * which cannot be deferred.
+	 */
+	cow = btr_cow_find(tcx);
+	if (cow != NULL && args == NULL)
+		return btr_retire(tcx, cow, BTR_NODE_NULL, rec);
+
+	return btr_ops(tcx)->to_rec_free(&tcx->tc_tins, rec, args);
 }
 
 /**
@@ -441,10 +574,24 @@ btr_rec_string(struct btr_context *tcx, struct btr_record *rec,
 					   buf_len);
 }
 
+static int
+btr_rec_inline_size(struct btr_context *tcx)
+{
+	int size;
+
+	if (!(tcx->tc_feats & BTR_FEAT_REC_INLINE))
+		return 0;
+
+	size = btr_ops(tcx)->to_rec_inline_size(&tcx->tc_tins);
+	D__ASSERT(size <= BTR_REC_INLINE_MAX);
+	return size;
+}
+
 static inline int
 btr_rec_size(struct btr_context *tcx)
 {
-	return btr_hkey_size(tcx) + sizeof(struct btr_record);
+	return btr_hkey_size(tcx) + btr_rec_inline_size(tcx) +
+	       sizeof(struct btr_record);
 }
 
 static struct btr_record *
@@ -504,20 +651,43 @@ btr_node_alloc(struct btr_context *tcx, TMMID(struct btr_node) *nd_mmid_p)
 	D__DEBUG(DB_TRACE, "Allocate new node "TMMID_PF"\n", TMMID_P(nd_mmid));
 	nd = btr_mmid2ptr(tcx, nd_mmid);
 	nd->tn_child = BTR_NODE_NULL;
+	nd->tn_gen = tcx->tc_tins.ti_root->tr_gen;
 
 	*nd_mmid_p = nd_mmid;
 	return 0;
 }
 
+/**
+ * Free a node which is invisible to snapshots, e.g. a node changed by a
+ * deletion, which has been copied by btr_delete_unshare().
+ */
 static void
-btr_node_free(struct btr_context *tcx, TMMID(struct btr_node) nd_mmid)
+btr_node_free_unshared(struct btr_context *tcx,
+		       TMMID(struct btr_node) nd_mmid)
 {
+	D__ASSERT(!btr_node_is_shared(tcx, nd_mmid));
 	if (btr_ops(tcx)->to_node_free)
 		btr_ops(tcx)->to_node_free(&tcx->tc_tins, nd_mmid);
 	else
 		umem_free_typed(btr_umm(tcx), nd_mmid);
 }
 
+/**
+ * Free a node, or retire it if it is visible to snapshots. It fails if the
+ * node cannot be retired, the caller should abort the transaction.
+ */
+static int
+btr_node_free(struct btr_context *tcx, TMMID(struct btr_node) nd_mmid)
+{
+	if (btr_node_is_shared(tcx, nd_mmid)) {
+		/* free it after all snapshots which can see it */
+		return btr_retire(tcx, btr_cow_find(tcx), nd_mmid, NULL);
+	}
+
+	btr_node_free_unshared(tcx, nd_mmid);
+	return 0;
+}
+
 static int
 btr_node_tx_add(struct btr_context *tcx, TMMID(struct btr_node) nd_mmid)
 {
@@ -615,6 +785,272 @@ btr_node_is_equal(struct btr_context *tcx, TMMID(struct btr_node) mmid1,
 	return umem_id_equal_typed(btr_umm(tcx), mmid1, mmid2);
 }
 
+/**
+ * Copy-on-write functions
+ */
+
+/** Look up the copy-on-write state of the tree, NULL if there is none */
+static struct btr_cow *
+btr_cow_lookup(struct btr_context *tcx)
+{
+	struct btr_cow *cow;
+
+	for (cow = btr_cows; cow != NULL; cow = cow->bc_next) {
+		if (cow->bc_root == tcx->tc_tins.ti_root)
+			return cow;
+	}
+	return NULL;
+}
+
+/** Find the copy-on-write state of the tree, NULL if it has no snapshot */
+static struct btr_cow *
+btr_cow_find(struct btr_context *tcx)
+{
+	struct btr_cow *cow = btr_cow_lookup(tcx);
+
+	/* it may only have retired nodes left by the last snapshot */
+	if (cow == NULL || daos_list_empty(&cow->bc_snaps))
+		return NULL;
+	return cow;
+}
+
+/**
+ * Is the node visible to any snapshot, it is if the newest snapshot is not
+ * older than the node.
+ */
+static bool
+btr_node_is_shared(struct btr_context *tcx, TMMID(struct btr_node) nd_mmid)
+{
+	struct btr_cow	*cow = btr_cow_find(tcx);
+	struct btr_snap	*snap;
+
+	if (cow == NULL)
+		return false;
+
+	D__ASSERT(!daos_list_empty(&cow->bc_snaps));
+	snap = daos_list_entry(cow->bc_snaps.prev, struct btr_snap, bs_link);
+	return btr_mmid2ptr(tcx, nd_mmid)->tn_gen <= snap->bs_gen;
+}
+
+/** Retire a node, or a record if \a rec is not NULL */
+static int
+btr_retire(struct btr_context *tcx, struct btr_cow *cow,
+	   TMMID(struct btr_node) nd_mmid, struct btr_record *rec)
+{
+	struct btr_retired *ret;
+
+	D__ALLOC_PTR(ret);
+	if (ret == NULL)
+		return -DER_NOMEM;
+
+	ret->br_gen  = tcx->tc_tins.ti_root->tr_gen;
+	ret->br_node = nd_mmid;
+	if (rec != NULL)
+		btr_rec_copy(tcx, &ret->br_rec.rb_rec, rec, 1);
+
+	daos_list_add_tail(&ret->br_link, &cow->bc_retired);
+	return 0;
+}
+
+/**
+ * Drop nodes and records retired by aborted transactions, they are still
+ * in the tree. The generation of the tree is bumped by each modification
+ * of a tree with snapshots, so they are newer than the tree.
+ */
+static void
+btr_cow_drop_aborted(struct btr_cow *cow)
+{
+	struct btr_retired *ret;
+
+	while (!daos_list_empty(&cow->bc_retired)) {
+		ret = daos_list_entry(cow->bc_retired.prev, struct btr_retired,
+				      br_link);
+		if (ret->br_gen <= cow->bc_root->tr_gen)
+			break;
+
+		daos_list_del(&ret->br_link);
+		D__FREE_PTR(ret);
+	}
+}
+
+/**
+ * Start to modify the tree. If it has snapshots, bump the generation of
+ * the tree, so nodes allocated by this modification are newer than all
+ * snapshots, and nodes retired by it can be told from those retired by
+ * an aborted transaction.
+ */
+static int
+btr_cow_start(struct btr_context *tcx)
+{
+	struct btr_cow	*cow = btr_cow_find(tcx);
+	int		 rc;
+
+	if (cow == NULL)
+		return 0;
+
+	btr_cow_drop_aborted(cow);
+	if (btr_has_tx(tcx)) {
+		rc = btr_root_tx_add(tcx);
+		if (rc != 0)
+			return rc;
+	}
+	tcx->tc_tins.ti_root->tr_gen++;
+	return 0;
+}
+
+/** Replace the child \a at of a non-leaf node */
+static void
+btr_node_child_set(struct btr_context *tcx, TMMID(struct btr_node) nd_mmid,
+		   unsigned int at, TMMID(struct btr_node) child_mmid)
+{
+	struct btr_node	  *nd = btr_mmid2ptr(tcx, nd_mmid);
+	struct btr_record *rec;
+
+	D__ASSERT(!(nd->tn_flags & BTR_NODE_LEAF));
+	if (at == 0) {
+		nd->tn_child = child_mmid;
+	} else {
+		rec = btr_node_rec_at(tcx, nd_mmid, at - 1);
+		rec->rec_mmid = umem_id_t2u(child_mmid);
+	}
+}
+
+/**
+ * Copy the node if it is visible to a snapshot, the copy replaces it as the
+ * child \a at of \a par_mmid, or as the root node if \a par_mmid is NULL.
+ * The original node is retired.
+ *
+ * \param nd_mmid_p	[IN/OUT]
+ *				The node to copy, it returns the copy.
+ */
+static int
+btr_node_unshare(struct btr_context *tcx, TMMID(struct btr_node) par_mmid,
+		 unsigned int at, TMMID(struct btr_node) *nd_mmid_p)
+{
+	struct btr_node		*nd;
+	TMMID(struct btr_node)	 nd_mmid;
+	uint64_t		 gen;
+	int			 rc;
+
+	if (!btr_node_is_shared(tcx, *nd_mmid_p))
+		return 0;
+
+	rc = btr_node_alloc(tcx, &nd_mmid);
+	if (rc != 0)
+		return rc;
+
+	nd = btr_mmid2ptr(tcx, nd_mmid);
+	gen = nd->tn_gen;
+	memcpy(nd, btr_mmid2ptr(tcx, *nd_mmid_p), btr_node_size(tcx));
+	nd->tn_gen = gen;
+
+	if (TMMID_IS_NULL(par_mmid))
+		rc = btr_has_tx(tcx) ? btr_root_tx_add(tcx) : 0;
+	else
+		rc = btr_has_tx(tcx) ? btr_node_tx_add(tcx, par_mmid) : 0;
+	if (rc == 0)
+		rc = btr_retire(tcx, btr_cow_find(tcx), *nd_mmid_p, NULL);
+	if (rc != 0) {
+		btr_node_free_unshared(tcx, nd_mmid);
+		return rc;
+	}
+
+	D__DEBUG(DB_TRACE, "Copy node "TMMID_PF" to "TMMID_PF"\n",
+		 TMMID_P(*nd_mmid_p), TMMID_P(nd_mmid));
+
+	if (TMMID_IS_NULL(par_mmid))
+		tcx->tc_tins.ti_root->tr_node = nd_mmid;
+	else
+		btr_node_child_set(tcx, par_mmid, at, nd_mmid);
+
+	*nd_mmid_p = nd_mmid;
+	return 0;
+}
+
+/**
+ * Copy nodes of the trace from the root to \a level if they are visible to
+ * snapshots, so they can be changed in place.
+ */
+static int
+btr_trace_unshare(struct btr_context *tcx, int level)
+{
+	struct btr_trace	*par_tr = NULL;
+	struct btr_trace	*trace;
+	int			 rc;
+
+	if (btr_cow_find(tcx) == NULL)
+		return 0;
+
+	for (trace = tcx->tc_trace; trace <= &tcx->tc_trace[level];
+	     par_tr = trace, trace++) {
+		rc = btr_node_unshare(tcx,
+				      par_tr ? par_tr->tr_node : BTR_NODE_NULL,
+				      par_tr ? par_tr->tr_at : 0,
+				      &trace->tr_node);
+		if (rc != 0)
+			return rc;
+	}
+	return 0;
+}
+
+/**
+ * Copy nodes which can be changed by deleting the record or child pointed
+ * by the trace at \a level if they are visible to snapshots: nodes of the
+ * trace, siblings for rebalance or merge, and the child which replaces the
+ * root if the tree shrinks.
+ */
+static int
+btr_delete_unshare(struct btr_context *tcx, int level)
+{
+	struct btr_trace	*par_tr;
+	struct btr_node		*nd;
+	TMMID(struct btr_node)	 nd_mmid;
+	int			 rc;
+
+	if (btr_cow_find(tcx) == NULL)
+		return 0;
+
+	rc = btr_trace_unshare(tcx, level);
+	if (rc != 0)
+		return rc;
+
+	for (; level > 0; level--) {
+		nd = btr_mmid2ptr(tcx, tcx->tc_trace[level].tr_node);
+		if (nd->tn_keyn > 1)
+			return 0; /* no rebalance, no bubble up */
+
+		par_tr = &tcx->tc_trace[level - 1];
+		nd = btr_mmid2ptr(tcx, par_tr->tr_node);
+		if (par_tr->tr_at > 0) {
+			nd_mmid = btr_node_child_at(tcx, par_tr->tr_node,
+						    par_tr->tr_at - 1);
+			rc = btr_node_unshare(tcx, par_tr->tr_node,
+					      par_tr->tr_at - 1, &nd_mmid);
+			if (rc != 0)
+				return rc;
+		}
+		if (par_tr->tr_at < nd->tn_keyn) {
+			nd_mmid = btr_node_child_at(tcx, par_tr->tr_node,
+						    par_tr->tr_at + 1);
+			rc = btr_node_unshare(tcx, par_tr->tr_node,
+					      par_tr->tr_at + 1, &nd_mmid);
+			if (rc != 0)
+				return rc;
+		}
+	}
+
+	nd = btr_mmid2ptr(tcx, tcx->tc_trace->tr_node);
+	if (!btr_node_is_leaf(tcx, tcx->tc_trace->tr_node) &&
+	    nd->tn_keyn == 1) {
+		/* the other child may become the new root */
+		nd_mmid = btr_node_child_at(tcx, tcx->tc_trace->tr_node,
+					    !tcx->tc_trace->tr_at);
+		rc = btr_node_unshare(tcx, tcx->tc_trace->tr_node,
+				      !tcx->tc_trace->tr_at, &nd_mmid);
+	}
+	return rc;
+}
+
 static bool
 btr_root_empty(struct btr_context *tcx)
 {
@@ -841,6 +1277,24 @@ btr_node_insert_rec_only(struct btr_context *tcx, struct btr_trace *trace,
 	nd->tn_keyn++;
 }
 
+/**
+ * Is the trace at the end of the rightmost node of \a level, e.g. the trace
+ * of appending a key which is bigger than all the keys of the tree.
+ */
+static bool
+btr_trace_at_tail(struct btr_context *tcx, int level)
+{
+	struct btr_trace *trace;
+	int		  i;
+
+	for (i = 0; i <= level; i++) {
+		trace = &tcx->tc_trace[i];
+		if (trace->tr_at != btr_mmid2ptr(tcx, trace->tr_node)->tn_keyn)
+			return false;
+	}
+	return true;
+}
+
 /**
  * Where I should split a node.
  */
@@ -852,9 +1306,20 @@ btr_split_at(struct btr_context *tcx, int level,
 	struct btr_trace *trace = &tcx->tc_trace[level];
 	int		  order = tcx->tc_order;
 	int		  split_at;
+	int		  tail;
 	bool		  left;
 
 	split_at = order / 2;
+	if (btr_trace_at_tail(tcx, level)) {
+		/* Appending to the rightmost node, nothing is going to be
+		 * inserted to the left node, so it keeps most of the records.
+		 * A non-leaf node has to leave one record to bubble up.
+		 */
+		tail = (order - 1) * BTR_SPLIT_TAIL_PCT / 100;
+		if (!btr_node_is_leaf(tcx, mmid_left))
+			tail = min(tail, order - 2);
+		split_at = max(split_at, tail);
+	}
 
 	left = (trace->tr_at < split_at);
 	if (!btr_node_is_leaf(tcx, mmid_left))
@@ -990,6 +1455,120 @@ btr_node_insert_rec(struct btr_context *tcx, struct btr_trace *trace,
 	return rc;
 }
 
+/**
+ * Maximum number of records to be compared by btr_prefix_count() while
+ * searching a node of BTR_FEAT_HKEY_PREFIX tree.
+ */
+#define BTR_SEARCH_VEC		16
+
+/**
+ * Count the records whose key prefix is less than \a prefix, \a addr is the
+ * hashed key of the first record, \a rec_size is distance between hashed
+ * keys of two adjacent records.
+ */
+static int
+btr_prefix_count_scalar(char *addr, int rec_size, int nr, uint64_t prefix)
+{
+	int	count = 0;
+	int	i;
+
+	for (i = 0; i < nr; i++)
+		count += btr_hkey_prefix(&addr[i * rec_size]) < prefix;
+	return count;
+}
+
+#if BTR_HAS_AVX2
+static int __attribute__((target("avx2")))
+btr_prefix_count_avx2(char *addr, int rec_size, int nr, uint64_t prefix)
+{
+	__m256i	sign;
+	__m256i	key;
+	__m256i	idx;
+	int	count = 0;
+
+	/* AVX2 only has signed compare, flip the sign bit of both sides */
+	sign = _mm256_set1_epi64x(INT64_MIN);
+	key  = _mm256_xor_si256(_mm256_set1_epi64x(prefix), sign);
+	idx  = _mm256_set_epi64x(3 * rec_size, 2 * rec_size, rec_size, 0);
+
+	for (; nr >= 4; nr -= 4, addr += 4 * rec_size) {
+		__m256i	pfx;
+		__m256i	lt;
+
+		pfx = _mm256_i64gather_epi64((const long long *)addr, idx, 1);
+		pfx = _mm256_xor_si256(pfx, sign);
+		lt  = _mm256_cmpgt_epi64(key, pfx);
+		count += __builtin_popcount(
+				_mm256_movemask_pd(_mm256_castsi256_pd(lt)));
+	}
+	return count + btr_prefix_count_scalar(addr, rec_size, nr, prefix);
+}
+#endif
+
+/** vectorized version is selected by dbtree_class_register() if possible */
+static int (*btr_prefix_count)(char *addr, int rec_size, int nr,
+			       uint64_t prefix) = btr_prefix_count_scalar;
+
+/**
+ * Search \a hkey within a node of BTR_FEAT_HKEY_PREFIX tree.
+ *
+ * It narrows down the search range by a branch-free binary search on the
+ * 64-bit key prefix, counts the prefixes less than \a hkey in the remaining
+ * range with vector compare, then only calls the customized comparison for
+ * records whose prefix equals to the prefix of \a hkey.
+ *
+ * \param cmp	[OUT]	Comparison result of the returned record and \a hkey,
+ *			see btr_hkey_cmp().
+ *
+ * \return		Index of the first record which is greater than or
+ *			equal to \a hkey, or the last record of the node if
+ *			all records are less than \a hkey.
+ */
+static int
+btr_node_search_prefix(struct btr_context *tcx,
+		       TMMID(struct btr_node) nd_mmid, void *hkey, int *cmp)
+{
+	struct btr_node	*nd = btr_mmid2ptr(tcx, nd_mmid);
+	char		*addr;
+	uint64_t	 prefix;
+	int		 rec_size;
+	int		 base;
+	int		 nr;
+	int		 at;
+
+	D__ASSERT(nd->tn_keyn > 0);
+
+	addr	 = &btr_node_rec_at(tcx, nd_mmid, 0)->rec_hkey[0];
+	rec_size = btr_rec_size(tcx);
+	prefix	 = btr_hkey_prefix(hkey);
+
+	/* lower bound of the prefix is always in [base, base + nr] */
+	for (base = 0, nr = nd->tn_keyn; nr > BTR_SEARCH_VEC;) {
+		int	half = nr / 2;
+		char   *mid  = &addr[(base + half) * rec_size];
+
+		base = btr_hkey_prefix(mid) < prefix ? base + half : base;
+		nr  -= half;
+	}
+	at = base + btr_prefix_count(&addr[base * rec_size], rec_size, nr,
+				     prefix);
+
+	for (; at < nd->tn_keyn; at++) {
+		struct btr_record *rec = btr_node_rec_at(tcx, nd_mmid, at);
+
+		if (btr_hkey_prefix(&rec->rec_hkey[0]) != prefix) {
+			*cmp = 1;
+			return at;
+		}
+		/* tie of the prefix, resolved by the full comparison */
+		*cmp = btr_hkey_cmp(tcx, rec, hkey);
+		if (*cmp >= 0)
+			return at;
+	}
+	*cmp = -1;
+	return nd->tn_keyn - 1;
+}
+
 enum btr_probe_rc {
 	/** not found */
 	PROBE_RC_NONE,
@@ -1060,7 +1639,15 @@ btr_probe(struct btr_context *tcx, int opc, daos_iov_t *key,
 				level, TMMID_P(nd_mmid), end + 1);
 		}
 
-		if (opc & BTR_PROBE_EQ) {
+		if ((opc & BTR_PROBE_EQ) &&
+		    (tcx->tc_feats & BTR_FEAT_HKEY_PREFIX)) {
+			at = btr_node_search_prefix(tcx, nd_mmid, hkey, &cmp);
+			start = end = at;
+
+			D__DEBUG(DB_TRACE, "prefix search found %d, cmp %d\n",
+				at, cmp);
+
+		} else if (opc & BTR_PROBE_EQ) {
 			/* binary search */
 			at = (start + end) / 2;
 			rec = btr_node_rec_at(tcx, nd_mmid, at);
@@ -1106,6 +1693,7 @@ btr_probe(struct btr_context *tcx, int opc, daos_iov_t *key,
 	/* leaf node */
 	D__ASSERT(level == tcx->tc_depth - 1);
 	D__ASSERT(!TMMID_IS_NULL(nd_mmid));
+	daos_metric_record(DMH_BTR_PROBE_DEPTH, level + 1);
 
 	if (cmp == 0 && key != NULL) {
 		rec = btr_node_rec_at(tcx, nd_mmid, at);
@@ -1333,12 +1921,24 @@ btr_update_only(struct btr_context *tcx, daos_iov_t *key, daos_iov_t *val)
 	int		   rc;
 	char		   sbuf[BTR_PRINT_BUF];
 
+	rc = btr_trace_unshare(tcx, tcx->tc_depth - 1);
+	if (rc != 0)
+		return rc;
+
 	rec = btr_trace2rec(tcx, tcx->tc_depth - 1);
 
 	D__DEBUG(DB_TRACE, "Update record %s\n",
 		btr_rec_string(tcx, rec, true, sbuf, BTR_PRINT_BUF));
 
-	rc = btr_rec_update(tcx, rec, key, val);
+	/* NB: the record body may be visible to a snapshot, replace it
+	 * unless the update cannot change it.
+	 */
+	if (btr_cow_find(tcx) != NULL &&
+	    !(tcx->tc_feats & BTR_FEAT_REC_SUBTREE))
+		rc = -DER_NO_PERM;
+	else
+		rc = btr_rec_update(tcx, rec, key, val);
+
 	if (rc == -DER_NO_PERM) { /* cannot make inplace change */
 		struct btr_trace *trace = &tcx->tc_trace[tcx->tc_depth - 1];
 
@@ -1346,8 +1946,9 @@ btr_update_only(struct btr_context *tcx, daos_iov_t *key, daos_iov_t *val)
 			btr_node_tx_add(tcx, trace->tr_node);
 
 		D__DEBUG(DB_TRACE, "Replace the original record\n");
-		btr_rec_free(tcx, rec, NULL);
-		rc = btr_rec_alloc(tcx, key, val, rec);
+		rc = btr_rec_free(tcx, rec, NULL);
+		if (rc == 0)
+			rc = btr_rec_alloc(tcx, key, val, rec);
 	}
 
 	if (rc != 0) { /* failed */
@@ -1383,6 +1984,10 @@ btr_insert(struct btr_context *tcx, daos_iov_t *key, daos_iov_t *val)
 	if (tcx->tc_depth != 0) {
 		struct btr_trace *trace;
 
+		rc = btr_trace_unshare(tcx, tcx->tc_depth - 1);
+		if (rc != 0)
+			goto failed;
+
 		/* trace for the leaf */
 		trace = &tcx->tc_trace[tcx->tc_depth - 1];
 		btr_trace_debug(tcx, trace, "try to insert\n");
@@ -1413,16 +2018,30 @@ btr_insert(struct btr_context *tcx, daos_iov_t *key, daos_iov_t *val)
 	return rc;
 }
 
+static bool btr_append_prep(struct btr_context *tcx, daos_iov_t *key);
+
 static int
 btr_update(struct btr_context *tcx, daos_iov_t *key, daos_iov_t *val)
 {
 	int	rc;
 
+	rc = btr_cow_start(tcx);
+	if (rc != 0)
+		return rc;
+
+	if (tcx->tc_append) {
+		if (btr_append_prep(tcx, key))
+			return btr_insert(tcx, key, val);
+		tcx->tc_append = false;
+	}
+
 	rc = btr_probe(tcx, BTR_PROBE_UPDATE, key, NULL);
 	if (rc == PROBE_RC_EQ) {
 		rc = btr_update_only(tcx, key, val);
 	} else {
 		D__ASSERT(rc == PROBE_RC_NONE);
+		tcx->tc_append = tcx->tc_depth == 0 ||
+				 btr_trace_at_tail(tcx, tcx->tc_depth - 1);
 		rc = btr_insert(tcx, key, val);
 	}
 	return rc;
@@ -1457,6 +2076,10 @@ btr_tx_update(struct btr_context *tcx, daos_iov_t *key, daos_iov_t *val)
 /**
  * Update value of the provided key.
  *
+ * If the last update of \a toh appended a key to the end of the tree, this
+ * one tries to append after it without probing the tree, so loading keys in
+ * ascending order is cheap.
+ *
  * \param toh		[IN]	Tree open handle.
  * \param key		[IN]	Key to search.
  * \param val		[IN]	New value for the key, it will punch the
@@ -1475,6 +2098,9 @@ dbtree_update(daos_handle_t toh, daos_iov_t *key, daos_iov_t *val)
 	if (tcx == NULL)
 		return -DER_NO_HDL;
 
+	if (tcx->tc_snap != NULL)
+		return -DER_NO_PERM; /* snapshot is read-only */
+
 	if (btr_has_tx(tcx))
 		rc = btr_tx_update(tcx, key, val);
 	else
@@ -1484,8 +2110,166 @@ dbtree_update(daos_handle_t toh, daos_iov_t *key, daos_iov_t *val)
 }
 
 /**
- * Delete the leaf record pointed by @cur_tr from the current node, then fill
- * the deletion gap by shifting remainded records on the specified direction.
+ * Is the trace still the rightmost path of the tree? The trace could be left
+ * by any former operation of this context, and the tree could have been
+ * changed by other contexts since then, so only the nodes which are proved to
+ * be in the tree can be accessed: the root, then the rightmost child of each
+ * of them. The index in the leaf is not checked.
+ */
+static bool
+btr_trace_is_rightmost(struct btr_context *tcx)
+{
+	struct btr_root		*root = tcx->tc_tins.ti_root;
+	struct btr_trace	*trace;
+	struct btr_node		*nd;
+	int			 level;
+
+	if (tcx->tc_depth == 0 || tcx->tc_depth != root->tr_depth ||
+	    !btr_node_is_equal(tcx, tcx->tc_trace[0].tr_node, root->tr_node))
+		return false;
+
+	for (level = 0; level < tcx->tc_depth - 1; level++) {
+		trace = &tcx->tc_trace[level];
+		nd = btr_mmid2ptr(tcx, trace->tr_node);
+		if (trace->tr_at != nd->tn_keyn ||
+		    !btr_node_is_equal(tcx, trace[1].tr_node,
+				       btr_node_child_at(tcx, trace->tr_node,
+							 trace->tr_at)))
+			return false;
+	}
+	return btr_node_is_leaf(tcx, tcx->tc_trace[level].tr_node);
+}
+
+/**
+ * Check if \a key can be appended to the end of the rightmost leaf, and set
+ * the trace to the insertion point if it can.
+ *
+ * If the trace left by the former append is still the rightmost path, there
+ * is no need to walk down the tree, only the last key of the leaf is compared.
+ */
+static bool
+btr_append_prep(struct btr_context *tcx, daos_iov_t *key)
+{
+	struct btr_trace	*trace;
+	struct btr_record	*rec;
+	struct btr_node		*nd;
+	char			 hkey[DAOS_HKEY_MAX];
+
+	if (!btr_trace_is_rightmost(tcx)) {
+		/* no key comparison, just walk down the rightmost path */
+		btr_probe(tcx, BTR_PROBE_LAST, NULL, NULL);
+		if (tcx->tc_depth == 0)
+			return false; /* empty tree */
+	}
+
+	trace = &tcx->tc_trace[tcx->tc_depth - 1];
+	nd = btr_mmid2ptr(tcx, trace->tr_node);
+	rec = btr_node_rec_at(tcx, trace->tr_node, nd->tn_keyn - 1);
+
+	btr_hkey_gen(tcx, key, &hkey[0]);
+	if (btr_hkey_cmp(tcx, rec, &hkey[0]) >= 0)
+		return false; /* not the biggest key */
+
+	trace->tr_at = nd->tn_keyn;
+	return true;
+}
+
+static int
+btr_update_batch(struct btr_context *tcx, unsigned int nr, daos_iov_t *keys,
+		 daos_iov_t *vals)
+{
+	int	i;
+	int	rc = 0;
+
+	/* keys are expected to be sorted, always try to append them */
+	tcx->tc_append = true;
+	for (i = 0; i < nr; i++) {
+		rc = btr_update(tcx, &keys[i], &vals[i]);
+		if (rc != 0)
+			break;
+		tcx->tc_append = true;
+	}
+
+	if (rc != 0)
+		D__DEBUG(DB_TRACE, "Batch update stopped at %d/%d: %d\n",
+			 i, nr, rc);
+	return rc;
+}
+
+static int
+btr_tx_update_batch(struct btr_context *tcx, unsigned int nr,
+		    daos_iov_t *keys, daos_iov_t *vals)
+{
+#if DAOS_HAS_PMDK
+	struct umem_instance *umm = btr_umm(tcx);
+	int		      rc = 0;
+
+	TX_BEGIN(umm->umm_u.pmem_pool) {
+		rc = btr_update_batch(tcx, nr, keys, vals);
+		if (rc != 0)
+			umem_tx_abort(btr_umm(tcx), rc);
+	} TX_ONABORT {
+		rc = umem_tx_errno(rc);
+		D__DEBUG(DB_TRACE, "dbtree_update_batch tx aborted: %d\n", rc);
+
+	} TX_FINALLY {
+		D__DEBUG(DB_TRACE, "dbtree_update_batch tx exited\n");
+	} TX_END
+
+	return rc;
+#else
+	D__ASSERT(0);
+	return -DER_NO_PERM;
+#endif
+}
+
+/**
+ * Update values of an array of keys within a single transaction.
+ *
+ * Keys should be sorted in ascending order of their hashed keys, then each
+ * key is appended to the rightmost leaf without probing the tree from root,
+ * this is the efficient way to load a large number of records into a tree.
+ * Unsorted keys and keys which already exist are still updated correctly,
+ * but each of them has to be probed like dbtree_update().
+ *
+ * \param toh		[IN]	Tree open handle.
+ * \param nr		[IN]	Number of keys.
+ * \param keys		[IN]	Array of keys.
+ * \param vals		[IN]	Array of values, vals[i] is the value of keys[i].
+ *
+ * \return		0	success
+ *			-ve	error code, none of the keys is updated if the
+ *				tree is in transactional memory, otherwise
+ *				keys before the failed one have been updated.
+ */
+int
+dbtree_update_batch(daos_handle_t toh, unsigned int nr, daos_iov_t *keys,
+		    daos_iov_t *vals)
+{
+	struct btr_context *tcx;
+	int		    rc = 0;
+
+	tcx = btr_hdl2tcx(toh);
+	if (tcx == NULL)
+		return -DER_NO_HDL;
+
+	if (tcx->tc_snap != NULL)
+		return -DER_NO_PERM; /* snapshot is read-only */
+
+	if (nr == 0)
+		return 0;
+
+	if (btr_has_tx(tcx))
+		rc = btr_tx_update_batch(tcx, nr, keys, vals);
+	else
+		rc = btr_update_batch(tcx, nr, keys, vals);
+
+	return rc;
+}
+
+/**
+ * Delete the leaf record pointed by @cur_tr from the current node, then fill
+ * the deletion gap by shifting remainded records on the specified direction.
  *
  * NB: this function can delete the last record in the node, it means that
  * caller should be responsible for deleting this node.
@@ -1739,7 +2523,7 @@ btr_node_del_child_only(struct btr_context *tcx, struct btr_trace *trace,
 	/* NB: we always delete record/node from the bottom to top, so it is
 	 * unnecessary to do cascading free anymore (btr_node_destroy).
 	 */
-	btr_node_free(tcx, mmid);
+	btr_node_free_unshared(tcx, mmid);
 
 	nd->tn_keyn--;
 	if (shift_left) {
@@ -2125,7 +2909,7 @@ btr_root_del_rec(struct btr_context *tcx, struct btr_trace *trace, void *args)
 
 			btr_context_set_depth(tcx, root->tr_depth);
 			btr_node_set(tcx, node->tn_child, BTR_NODE_ROOT);
-			btr_node_free(tcx, trace->tr_node);
+			btr_node_free_unshared(tcx, trace->tr_node);
 
 			D__DEBUG(DB_TRACE, "Shrink tree depth to %d\n",
 				tcx->tc_depth);
@@ -2133,13 +2917,48 @@ btr_root_del_rec(struct btr_context *tcx, struct btr_trace *trace, void *args)
 	}
 }
 
+/**
+ * Free bodies of \a nr leaf records from the one pointed by \a trace before
+ * deleting them, so a failure, e.g. a body holds a subtree which has
+ * snapshots, is returned before the tree is changed. The leaf must have been
+ * unshared.
+ */
 static int
-btr_delete(struct btr_context *tcx, void *args)
+btr_rec_free_early(struct btr_context *tcx, struct btr_trace *trace, int nr,
+		   void *args)
+{
+	struct btr_record	*rec;
+	int			 i;
+	int			 rc;
+
+	if (btr_has_tx(tcx)) {
+		rc = btr_node_tx_add(tcx, trace->tr_node);
+		if (rc != 0)
+			return rc;
+	}
+
+	rec = btr_node_rec_at(tcx, trace->tr_node, trace->tr_at);
+	for (i = 0; i < nr; i++, rec = btr_rec_at(tcx, rec, 1)) {
+		rc = btr_rec_free(tcx, rec, args);
+		if (rc != 0)
+			return rc;
+		/* NB: it is deleted later, don't free it again */
+		rec->rec_mmid = UMMID_NULL;
+	}
+	return 0;
+}
+
+/**
+ * Delete the record or child pointed by the trace at \a level, the deletion
+ * bubbles up if it leaves an empty node.
+ */
+static void
+btr_delete_at(struct btr_context *tcx, int level, void *args)
 {
 	struct btr_trace	*par_tr;
 	struct btr_trace	*cur_tr;
 
-	for (cur_tr = &tcx->tc_trace[tcx->tc_depth - 1];; cur_tr = par_tr) {
+	for (cur_tr = &tcx->tc_trace[level];; cur_tr = par_tr) {
 		bool	bubble_up;
 
 		if (cur_tr == tcx->tc_trace) { /* root */
@@ -2153,7 +2972,24 @@ btr_delete(struct btr_context *tcx, void *args)
 			break;
 	}
 	D__DEBUG(DB_TRACE, "Deletion done\n");
-	return 0; /* no error so far */
+}
+
+static int
+btr_delete(struct btr_context *tcx, void *args)
+{
+	int	rc;
+
+	rc = btr_cow_start(tcx);
+	if (rc == 0)
+		rc = btr_delete_unshare(tcx, tcx->tc_depth - 1);
+	if (rc == 0)
+		rc = btr_rec_free_early(tcx, &tcx->tc_trace[tcx->tc_depth - 1],
+					1, args);
+	if (rc != 0)
+		return rc;
+
+	btr_delete_at(tcx, tcx->tc_depth - 1, args);
+	return 0;
 }
 
 static int
@@ -2202,6 +3038,9 @@ dbtree_delete(daos_handle_t toh, daos_iov_t *key,
 	if (tcx == NULL)
 		return -DER_NO_HDL;
 
+	if (tcx->tc_snap != NULL)
+		return -DER_NO_PERM; /* snapshot is read-only */
+
 	rc = btr_probe(tcx, BTR_PROBE_EQ, key, NULL);
 	if (rc != PROBE_RC_EQ) {
 		D__DEBUG(DB_TRACE, "Cannot find key\n");
@@ -2216,6 +3055,267 @@ dbtree_delete(daos_handle_t toh, daos_iov_t *key,
 	return rc;
 }
 
+/** Is the hashed key of \a rec not beyond \a hkey_hi, NULL means no limit */
+static bool
+btr_rec_in_range(struct btr_context *tcx, struct btr_record *rec,
+		 void *hkey_hi)
+{
+	return hkey_hi == NULL || btr_hkey_cmp(tcx, rec, hkey_hi) <= 0;
+}
+
+/** Return the last record of the subtree rooted at \a nd_mmid */
+static struct btr_record *
+btr_node_last_rec(struct btr_context *tcx, TMMID(struct btr_node) nd_mmid)
+{
+	struct btr_node *nd;
+
+	while (!btr_node_is_leaf(tcx, nd_mmid)) {
+		nd = btr_mmid2ptr(tcx, nd_mmid);
+		nd_mmid = btr_node_child_at(tcx, nd_mmid, nd->tn_keyn);
+	}
+	nd = btr_mmid2ptr(tcx, nd_mmid);
+	return btr_node_rec_at(tcx, nd_mmid, nd->tn_keyn - 1);
+}
+
+/**
+ * Delete \a nr leaf records starting from the trace, the leaf should keep
+ * at least one record so the parent node is not changed. It is fine to
+ * delete the first records of the leaf, because the hashed key in the parent
+ * is only the lower bound of the leaf.
+ */
+static void
+btr_node_del_leaf_nr(struct btr_context *tcx, struct btr_trace *trace,
+		     int nr, void *args)
+{
+	struct btr_record	*rec;
+	struct btr_node		*nd;
+	int			 i;
+
+	nd = btr_mmid2ptr(tcx, trace->tr_node);
+	D__ASSERT(nr > 0 && nr < nd->tn_keyn);
+
+	if (btr_has_tx(tcx))
+		btr_node_tx_add(tcx, trace->tr_node);
+
+	rec = btr_node_rec_at(tcx, trace->tr_node, trace->tr_at);
+	for (i = 0; i < nr; i++)
+		btr_rec_free(tcx, btr_rec_at(tcx, rec, i), args);
+
+	nd->tn_keyn -= nr;
+	if (trace->tr_at != nd->tn_keyn) {
+		btr_rec_move(tcx, rec, btr_rec_at(tcx, rec, nr),
+			     nd->tn_keyn - trace->tr_at);
+	}
+}
+
+/**
+ * Delete the subtree rooted at the node of the trace at \a level, all its
+ * records and descendants are freed straightaway, then the subtree is
+ * removed from its parent like a single empty child.
+ */
+static int
+btr_subtree_delete(struct btr_context *tcx, int level, void *args)
+{
+	struct btr_root		*root = tcx->tc_tins.ti_root;
+	struct btr_trace	*trace = &tcx->tc_trace[level];
+	int			 rc;
+
+	D__DEBUG(DB_TRACE, "Delete subtree "TMMID_PF" at level %d\n",
+		TMMID_P(trace->tr_node), level);
+
+	if (level == 0) { /* the whole tree */
+		rc = btr_node_destroy(tcx, trace->tr_node, args);
+		if (rc != 0)
+			return rc;
+
+		if (btr_has_tx(tcx))
+			btr_root_tx_add(tcx);
+
+		root->tr_depth	= 0;
+		root->tr_node	= BTR_NODE_NULL;
+		btr_context_set_depth(tcx, 0);
+		return 0;
+	}
+
+	/* the empty node is freed by the deletion from its parent, which
+	 * cannot retire it, so copy it if it is visible to snapshots.
+	 */
+	rc = btr_node_unshare(tcx, trace[-1].tr_node, trace[-1].tr_at,
+			      &trace->tr_node);
+	if (rc != 0)
+		return rc;
+
+	rc = btr_node_empty(tcx, trace->tr_node, args);
+	if (rc != 0)
+		return rc;
+
+	btr_delete_at(tcx, level - 1, args);
+	return 0;
+}
+
+/**
+ * Delete all records within [\a key_lo, \a key_hi]. Each round locates the
+ * first record in the range, then either deletes the records of a partially
+ * covered leaf in one go, or climbs up to the biggest subtree which is
+ * covered by the range and deletes it as a whole. Only nodes on the boundary
+ * of the range are rebalanced, so the cost is O(log(n)) for each subtree
+ * plus the number of deleted nodes and records.
+ */
+static int
+btr_delete_range(struct btr_context *tcx, daos_iov_t *key_lo,
+		 daos_iov_t *key_hi, void *args)
+{
+	char	 hkey_buf[DAOS_HKEY_MAX];
+	char	*hkey_hi = NULL;
+	int	 rc;
+
+	rc = btr_cow_start(tcx);
+	if (rc != 0)
+		return rc;
+
+	if (key_hi != NULL) {
+		hkey_hi = &hkey_buf[0];
+		btr_hkey_gen(tcx, key_hi, hkey_hi);
+	}
+
+	while (1) {
+		struct btr_trace	*trace;
+		struct btr_node		*nd;
+		int			 level;
+		int			 nr;
+
+		if (key_lo != NULL)
+			rc = btr_probe(tcx, BTR_PROBE_GE, key_lo, NULL);
+		else
+			rc = btr_probe(tcx, BTR_PROBE_FIRST, NULL, NULL);
+
+		if (rc == PROBE_RC_NONE)
+			break; /* nothing left after key_lo */
+
+		level = tcx->tc_depth - 1;
+		trace = &tcx->tc_trace[level];
+		nd = btr_mmid2ptr(tcx, trace->tr_node);
+
+		for (nr = 0; trace->tr_at + nr < nd->tn_keyn; nr++) {
+			struct btr_record *rec;
+
+			rec = btr_node_rec_at(tcx, trace->tr_node,
+					      trace->tr_at + nr);
+			if (!btr_rec_in_range(tcx, rec, hkey_hi))
+				break;
+		}
+
+		if (nr == 0)
+			break; /* the first record is beyond key_hi */
+
+		if (nr < nd->tn_keyn) {
+			bool done = trace->tr_at + nr < nd->tn_keyn;
+
+			rc = btr_trace_unshare(tcx, level);
+			if (rc == 0)
+				rc = btr_rec_free_early(tcx, trace, nr, args);
+			if (rc != 0)
+				return rc;
+
+			btr_node_del_leaf_nr(tcx, trace, nr, args);
+			if (done) /* stopped by key_hi */
+				break;
+			continue;
+		}
+
+		/* The whole leaf is in the range, so is its parent if the
+		 * leaf is the first child and the last record of the parent
+		 * is in the range, and so on.
+		 */
+		for (; level > 0; level--) {
+			trace = &tcx->tc_trace[level - 1];
+			if (trace->tr_at != 0)
+				break;
+
+			if (!btr_rec_in_range(tcx,
+					      btr_node_last_rec(tcx,
+								trace->tr_node),
+					      hkey_hi))
+				break;
+		}
+
+		if (level > 0) {
+			rc = btr_delete_unshare(tcx, level - 1);
+			if (rc != 0)
+				return rc;
+		}
+		rc = btr_subtree_delete(tcx, level, args);
+		if (rc != 0)
+			return rc;
+	}
+	return 0;
+}
+
+static int
+btr_tx_delete_range(struct btr_context *tcx, daos_iov_t *key_lo,
+		    daos_iov_t *key_hi, void *args)
+{
+#if DAOS_HAS_PMDK
+	struct umem_instance *umm = btr_umm(tcx);
+	int		      rc = 0;
+
+	TX_BEGIN(umm->umm_u.pmem_pool) {
+		rc = btr_delete_range(tcx, key_lo, key_hi, args);
+		if (rc != 0)
+			umem_tx_abort(btr_umm(tcx), rc);
+	} TX_ONABORT {
+		rc = umem_tx_errno(rc);
+		D__DEBUG(DB_TRACE, "dbtree_delete_range tx aborted: %d\n",
+			 rc);
+
+	} TX_FINALLY {
+		D__DEBUG(DB_TRACE, "dbtree_delete_range tx exited\n");
+	} TX_END
+
+	return rc;
+#else
+	D__ASSERT(0);
+	return -DER_NO_PERM;
+#endif
+}
+
+/**
+ * Delete all records whose hashed keys are within [\a key_lo, \a key_hi]
+ * in one transaction. The range is defined by the order of hashed keys, so
+ * it is only meaningful for tree classes whose hashed keys keep the order of
+ * keys, e.g. integer keys with BTR_FEAT_HKEY_PREFIX.
+ *
+ * \param toh		[IN]	Tree open handle.
+ * \param key_lo	[IN]	The low bound of the range, NULL means the
+ *				first record.
+ * \param key_hi	[IN]	The high bound of the range, NULL means the
+ *				last record.
+ * \param args		[IN/OUT]
+ *				Optional: passed to the record free function
+ *				of each deleted record.
+ */
+int
+dbtree_delete_range(daos_handle_t toh, daos_iov_t *key_lo, daos_iov_t *key_hi,
+		    void *args)
+{
+	struct btr_context *tcx;
+	int		    rc;
+
+	tcx = btr_hdl2tcx(toh);
+	if (tcx == NULL)
+		return -DER_NO_HDL;
+
+	if (tcx->tc_snap != NULL)
+		return -DER_NO_PERM; /* snapshot is read-only */
+
+	if (btr_has_tx(tcx))
+		rc = btr_tx_delete_range(tcx, key_lo, key_hi, args);
+	else
+		rc = btr_delete_range(tcx, key_lo, key_hi, args);
+
+	return rc;
+}
+
 /** gather statistics from a tree node and all its children recursively. */
 static void
 btr_node_stat(struct btr_context *tcx, TMMID(struct btr_node) nd_mmid,
@@ -2554,14 +3654,15 @@ dbtree_close(daos_handle_t toh)
 	return 0;
 }
 
-/** Destroy a tree node and all its children recursively. */
-static void
-btr_node_destroy(struct btr_context *tcx, TMMID(struct btr_node) nd_mmid,
-		 void *args)
+/** Free all records and descendants of a tree node, but not the node. */
+static int
+btr_node_empty(struct btr_context *tcx, TMMID(struct btr_node) nd_mmid,
+	       void *args)
 {
 	struct btr_node *nd	= btr_mmid2ptr(tcx, nd_mmid);
 	bool		 leaf	= btr_node_is_leaf(tcx, nd_mmid);
 	int		 i;
+	int		 rc;
 
 	/* NB: don't need to call TX_ADD_RANGE(nd_mmid, ...) because I never
 	 * change it so nothing to undo on transaction failure, I may destroy
@@ -2575,18 +3676,39 @@ btr_node_destroy(struct btr_context *tcx, TMMID(struct btr_node) nd_mmid,
 			struct btr_record *rec;
 
 			rec = btr_node_rec_at(tcx, nd_mmid, i);
-			btr_rec_free(tcx, rec, args);
+			rc = btr_rec_free(tcx, rec, args);
+			if (rc != 0)
+				return rc;
 		}
-		return;
+		return 0;
 	}
 
 	for (i = 0; i <= nd->tn_keyn; i++) {
 		TMMID(struct btr_node) child_mmid;
 
 		child_mmid = btr_node_child_at(tcx, nd_mmid, i);
-		btr_node_destroy(tcx, child_mmid, NULL);
+		rc = btr_node_destroy(tcx, child_mmid, args);
+		if (rc != 0)
+			return rc;
 	}
-	btr_node_free(tcx, nd_mmid);
+	return 0;
+}
+
+/**
+ * Destroy a tree node and all its children recursively. It fails if a record
+ * body cannot be freed, the caller should abort the transaction.
+ */
+static int
+btr_node_destroy(struct btr_context *tcx, TMMID(struct btr_node) nd_mmid,
+		 void *args)
+{
+	int	rc;
+
+	rc = btr_node_empty(tcx, nd_mmid, args);
+	if (rc != 0)
+		return rc;
+
+	return btr_node_free(tcx, nd_mmid);
 }
 
 /** destroy all tree nodes and records, then release the root */
@@ -2594,14 +3716,27 @@ static int
 btr_tree_destroy(struct btr_context *tcx)
 {
 	struct btr_root *root;
+	struct btr_cow	*cow;
+	int		 freed;
+	int		 rc;
 
 	D__DEBUG(DB_TRACE, "Destroy "TMMID_PF", order %d\n",
 		TMMID_P(tcx->tc_tins.ti_root_mmid), tcx->tc_order);
 
+	/* retired nodes and records left by the last snapshot */
+	cow = btr_cow_lookup(tcx);
+	if (cow != NULL) {
+		rc = btr_cow_free(tcx, cow, -1, &freed);
+		if (rc != 0)
+			return rc;
+	}
+
 	root = tcx->tc_tins.ti_root;
 	if (!TMMID_IS_NULL(root->tr_node)) {
 		/* destroy the root and all descendants */
-		btr_node_destroy(tcx, root->tr_node, NULL);
+		rc = btr_node_destroy(tcx, root->tr_node, NULL);
+		if (rc != 0)
+			return rc;
 	}
 
 	btr_root_free(tcx);
@@ -2636,7 +3771,8 @@ btr_tx_tree_destroy(struct btr_context *tcx)
 
 /**
  * Destroy a btree.
- * The tree open handle is invalid after the destroy.
+ * The tree open handle is invalid after a successful destroy. It fails with
+ * -DER_BUSY if the tree, or a subtree under its records, has snapshots.
  *
  * \param toh	[IN]	Tree open handle.
  */
@@ -2644,18 +3780,337 @@ int
 dbtree_destroy(daos_handle_t toh)
 {
 	struct btr_context *tcx;
+	struct btr_cow	   *cow;
 	int		    rc;
 
 	tcx = btr_hdl2tcx(toh);
 	if (tcx == NULL)
 		return -DER_NO_HDL;
 
+	if (tcx->tc_snap != NULL)
+		return -DER_NO_PERM; /* snapshot is read-only */
+
+	if (btr_cow_find(tcx) != NULL) {
+		D__DEBUG(DB_TRACE, "Cannot destroy tree with snapshots\n");
+		return -DER_BUSY;
+	}
+
 	if (btr_has_tx(tcx))
 		rc = btr_tx_tree_destroy(tcx);
 	else
 		rc = btr_tree_destroy(tcx);
+	if (rc != 0)
+		return rc;
 
+	cow = btr_cow_lookup(tcx);
+	if (cow != NULL) {
+		btr_cow_forget(cow, -1);
+		btr_cow_release(cow);
+	}
 	btr_context_decref(tcx);
+	return 0;
+}
+
+/**** Snapshot APIs *********************************************************/
+
+/**
+ * Free the first \a nr retired nodes and records, or all of them if \a nr is
+ * negative, \a freed returns the number of freed ones. A record cannot be
+ * freed while it holds a subtree which has snapshots.
+ */
+static int
+btr_cow_free(struct btr_context *tcx, struct btr_cow *cow, int nr,
+	     int *freed)
+{
+	struct btr_retired *ret;
+	int		    rc;
+
+	*freed = 0;
+	daos_list_for_each_entry(ret, &cow->bc_retired, br_link) {
+		if (*freed == nr)
+			break;
+
+		/* NB: \a tcx is a snapshot handle, so they are freed
+		 * straightaway instead of being retired again.
+		 */
+		if (TMMID_IS_NULL(ret->br_node))
+			rc = btr_rec_free(tcx, &ret->br_rec.rb_rec, NULL);
+		else
+			rc = btr_node_free(tcx, ret->br_node);
+		if (rc != 0)
+			return rc;
+		(*freed)++;
+	}
+	return 0;
+}
+
+static int
+btr_tx_cow_free(struct btr_context *tcx, struct btr_cow *cow, int nr,
+		int *freed)
+{
+#if DAOS_HAS_PMDK
+	struct umem_instance *umm = btr_umm(tcx);
+	int		      rc = 0;
+
+	TX_BEGIN(umm->umm_u.pmem_pool) {
+		rc = btr_cow_free(tcx, cow, nr, freed);
+		if (rc != 0)
+			umem_tx_abort(btr_umm(tcx), rc);
+	} TX_ONABORT {
+		*freed = 0; /* nothing is freed */
+		rc = umem_tx_errno(rc);
+		D__DEBUG(DB_TRACE, "Failed to free retired nodes: %d\n", rc);
+	} TX_FINALLY {
+		D__DEBUG(DB_TRACE, "btr_cow_free tx exited\n");
+	} TX_END
+
+	return rc;
+#else
+	D__ASSERT(0);
+	return -DER_NO_PERM;
+#endif
+}
+
+/**
+ * Free retired nodes and records which are invisible to all snapshots,
+ * a snapshot can see them if it is older than their retirement.
+ */
+static void
+btr_cow_reclaim(struct btr_context *tcx, struct btr_cow *cow)
+{
+	struct btr_retired	*ret;
+	struct btr_snap		*snap = NULL;
+	int			 nr = 0;
+	int			 freed;
+	int			 rc;
+
+	btr_cow_drop_aborted(cow);
+	if (!daos_list_empty(&cow->bc_snaps))
+		snap = daos_list_entry(cow->bc_snaps.next, struct btr_snap,
+				       bs_link);
+
+	daos_list_for_each_entry(ret, &cow->bc_retired, br_link) {
+		if (snap != NULL && snap->bs_gen < ret->br_gen)
+			break;
+		nr++;
+	}
+
+	if (nr == 0)
+		return;
+
+	if (btr_has_tx(tcx))
+		rc = btr_tx_cow_free(tcx, cow, nr, &freed);
+	else
+		rc = btr_cow_free(tcx, cow, nr, &freed);
+
+	if (rc != 0) /* try the others again on the next release */
+		D__DEBUG(DB_TRACE, "Failed to free retired records: %d\n", rc);
+
+	D__DEBUG(DB_TRACE, "Freed %d retired nodes and records\n", freed);
+	btr_cow_forget(cow, freed);
+}
+
+/**
+ * Remove the first \a nr retired nodes and records, or all of them if \a nr
+ * is negative, after they have been freed.
+ */
+static void
+btr_cow_forget(struct btr_cow *cow, int nr)
+{
+	struct btr_retired *ret;
+	struct btr_retired *tmp;
+
+	daos_list_for_each_entry_safe(ret, tmp, &cow->bc_retired, br_link) {
+		if (nr-- == 0)
+			break;
+		daos_list_del(&ret->br_link);
+		D__FREE_PTR(ret);
+	}
+}
+
+/**
+ * Release the copy-on-write state of a tree if it has neither snapshot nor
+ * retired node.
+ */
+static void
+btr_cow_release(struct btr_cow *cow)
+{
+	struct btr_cow	**prev;
+
+	if (!daos_list_empty(&cow->bc_snaps) ||
+	    !daos_list_empty(&cow->bc_retired))
+		return;
+
+	for (prev = &btr_cows; *prev != cow; prev = &(*prev)->bc_next)
+		D__ASSERT(*prev != NULL);
+	*prev = cow->bc_next;
+	D__FREE_PTR(cow);
+}
+
+/** Release a snapshot by one of its handles */
+static void
+btr_snap_put(struct btr_context *tcx)
+{
+	struct btr_snap	 *snap = tcx->tc_snap;
+	struct btr_cow	 *cow = snap->bs_cow;
+
+	D__ASSERT(snap->bs_ref > 0);
+	tcx->tc_snap = NULL;
+	if (--snap->bs_ref > 0)
+		return;
+
+	D__DEBUG(DB_TRACE, "Release snapshot "DF_U64"\n", snap->bs_gen);
+	daos_list_del(&snap->bs_link);
+	btr_cow_reclaim(tcx, cow);
+	D__FREE_PTR(snap);
+
+	/* keep retired nodes which failed to be freed for a later reclaim */
+	if (daos_list_empty(&cow->bc_snaps) &&
+	    !daos_list_empty(&cow->bc_retired))
+		D__DEBUG(DB_TRACE, "Keep retired nodes of the last snapshot\n");
+
+	btr_cow_release(cow);
+}
+
+/** Bump the generation of the tree for a new snapshot */
+static int
+btr_gen_bump(struct btr_context *tcx)
+{
+	int	rc;
+
+	if (btr_has_tx(tcx)) {
+		rc = btr_root_tx_add(tcx);
+		if (rc != 0)
+			return rc;
+	}
+	tcx->tc_tins.ti_root->tr_gen++;
+	return 0;
+}
+
+static int
+btr_tx_gen_bump(struct btr_context *tcx)
+{
+#if DAOS_HAS_PMDK
+	struct umem_instance *umm = btr_umm(tcx);
+	int		      rc = 0;
+
+	TX_BEGIN(umm->umm_u.pmem_pool) {
+		rc = btr_gen_bump(tcx);
+		if (rc != 0)
+			umem_tx_abort(btr_umm(tcx), rc);
+	} TX_ONABORT {
+		rc = umem_tx_errno(rc);
+		D__DEBUG(DB_TRACE, "Failed to bump generation: %d\n", rc);
+	} TX_FINALLY {
+		D__DEBUG(DB_TRACE, "btr_gen_bump tx exited\n");
+	} TX_END
+
+	return rc;
+#else
+	D__ASSERT(0);
+	return -DER_NO_PERM;
+#endif
+}
+
+/**
+ * Take a read-only snapshot of the tree. The snapshot handle can be looked
+ * up and iterated like an open handle without any lock, it always sees the
+ * tree as it was when the snapshot was taken, so a long running scan, e.g.
+ * enumeration, rebuild or aggregation, doesn't need to re-probe its anchor
+ * after yielding to updates.
+ *
+ * While a tree has snapshots, updates through any open handle of it copy the
+ * nodes visible to snapshots instead of changing them in place, record
+ * bodies are replaced instead of being updated in place, and the replaced
+ * nodes and records are freed after all snapshots which can see them are
+ * released. Trees without snapshot are changed in place as before.
+ *
+ * NB:
+ * - snapshots are volatile, the tree and its snapshots must be accessed by
+ *   the same xstream, and a snapshot must not be taken in a transaction.
+ * - only nodes and records of this tree are protected, a record body taken
+ *   over by \a args of dbtree_delete() and subtrees under records are not,
+ *   records of a tree with BTR_FEAT_REC_SUBTREE are updated in place.
+ * - the snapshots pin the root of the tree, so the tree cannot be destroyed
+ *   while it has snapshots. If the root is stored in a record of another
+ *   tree, to_rec_free() of that tree should fail with -DER_BUSY which is
+ *   returned by dbtree_destroy(), then deleting the record fails as well.
+ *
+ * \param toh		[IN]	Tree open handle.
+ * \param snap_toh	[OUT]	Returned snapshot handle, the snapshot is
+ *				released by dbtree_close() of it and of all
+ *				iterators prepared from it.
+ */
+int
+dbtree_snapshot(daos_handle_t toh, daos_handle_t *snap_toh)
+{
+	struct btr_context	*tcx;
+	struct btr_context	*snap_tcx;
+	struct btr_snap		*snap;
+	struct btr_cow		*cow;
+	struct umem_attr	 uma;
+	bool			 new_cow = false;
+	int			 rc;
+
+	tcx = btr_hdl2tcx(toh);
+	if (tcx == NULL)
+		return -DER_NO_HDL;
+
+	if (tcx->tc_snap != NULL)
+		return -DER_NO_PERM; /* snapshot of snapshot */
+
+	D__ALLOC_PTR(snap);
+	if (snap == NULL)
+		return -DER_NOMEM;
+
+	cow = btr_cow_lookup(tcx);
+	if (cow == NULL) {
+		new_cow = true;
+		D__ALLOC_PTR(cow);
+		if (cow == NULL)
+			D__GOTO(failed, rc = -DER_NOMEM);
+
+		cow->bc_root = tcx->tc_tins.ti_root;
+		DAOS_INIT_LIST_HEAD(&cow->bc_snaps);
+		DAOS_INIT_LIST_HEAD(&cow->bc_retired);
+	}
+
+	snap->bs_root = *tcx->tc_tins.ti_root;
+	snap->bs_gen  = snap->bs_root.tr_gen;
+	snap->bs_cow  = cow;
+	snap->bs_ref  = 1;
+
+	umem_attr_get(&tcx->tc_tins.ti_umm, &uma);
+	rc = btr_context_create(BTR_ROOT_NULL, &snap->bs_root, -1, -1, -1,
+				&uma, &snap_tcx);
+	if (rc != 0)
+		D__GOTO(failed, rc);
+
+	/* nodes allocated from now on are newer than the snapshot */
+	if (btr_has_tx(tcx))
+		rc = btr_tx_gen_bump(tcx);
+	else
+		rc = btr_gen_bump(tcx);
+	if (rc != 0) {
+		btr_context_decref(snap_tcx);
+		D__GOTO(failed, rc);
+	}
+
+	if (new_cow) {
+		cow->bc_next = btr_cows;
+		btr_cows = cow;
+	}
+	daos_list_add_tail(&snap->bs_link, &cow->bc_snaps);
+	snap_tcx->tc_snap = snap;
+
+	D__DEBUG(DB_TRACE, "Take snapshot "DF_U64" of "TMMID_PF"\n",
+		 snap->bs_gen, TMMID_P(snap->bs_root.tr_node));
+	*snap_toh = btr_tcx2hdl(snap_tcx);
+	return 0;
+ failed:
+	if (new_cow && cow != NULL)
+		D__FREE_PTR(cow);
+	D__FREE_PTR(snap);
 	return rc;
 }
 
@@ -2912,6 +4367,9 @@ dbtree_iter_delete(daos_handle_t ih, void *args)
 	if (tcx == NULL)
 		return -DER_NO_HDL;
 
+	if (tcx->tc_snap != NULL)
+		return -DER_NO_PERM; /* snapshot is read-only */
+
 	itr = &tcx->tc_itr;
 	rc = btr_iter_is_ready(itr);
 	if (rc != 0)
@@ -3077,6 +4535,17 @@ btr_class_init(TMMID(struct btr_root) root_mmid, struct btr_root *root,
 	}
 
 	tins->ti_ops = tc->tc_ops;
+	if ((tree_feats & BTR_FEAT_HKEY_PREFIX) &&
+	    tins->ti_ops->to_hkey_size(tins) < sizeof(uint64_t)) {
+		D__ERROR("Hashed key is too small for prefix search\n");
+		return -DER_INVAL;
+	}
+
+	if ((tree_feats & BTR_FEAT_REC_INLINE) &&
+	    tins->ti_ops->to_rec_inline_size == NULL) {
+		D__ERROR("Tree class cannot store inline record\n");
+		return -DER_INVAL;
+	}
 	return rc;
 }
 
@@ -3109,5 +4578,11 @@ dbtree_class_register(unsigned int tree_class, uint64_t tree_feats,
 	btr_class_registered[tree_class].tc_ops = ops;
 	btr_class_registered[tree_class].tc_feats = tree_feats;
 
+#if BTR_HAS_AVX2
+	if ((tree_feats & BTR_FEAT_HKEY_PREFIX) &&
+	    __builtin_cpu_supports("avx2"))
+		btr_prefix_count = btr_prefix_count_avx2;
+#endif
+
 	return 0;
 }
@@ -0,0 +1,431 @@
+/**
+ * (C) Copyright 2017 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * GOVERNMENT LICENSE RIGHTS-OPEN SOURCE SOFTWARE
+ * The Government's rights to use, modify, reproduce, release, perform, display,
+ * or disclose this software are subject to the terms of the Apache License as
+ * provided in Contract No. B609815.
+ * Any reproduction of computer software, computer software documentation, or
+ * portions thereof marked with this legend must also reproduce the markings.
+ */
+/**
+ * This file is part of daos
+ *
+ * common/csum.c
+ *
+ * CRC32C and CRC64 checksums of VOS records.
+ *
+ * The portable kernels are table driven and consume eight bytes per step
+ * (slicing-by-8). On x86, CRC32C uses the crc32 instruction of SSE4.2 and
+ * CRC64 folds 16-byte blocks with carry-less multiplications (PCLMULQDQ):
+ * a block is multiplied by x^(8 * distance) mod P and added to the block
+ * at that distance, so four independent accumulators can be folded over
+ * the buffer and reduced by the table kernel at the end.
+ */
+#define DDSUBSYS	DDFAC(common)
+
+#include <pthread.h>
+#include <endian.h>
+#include <daos_errno.h>
+#include <daos/csum.h>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define CSUM_HAS_HW		1
+#else
+#define CSUM_HAS_HW		0
+#endif
+
+/** reflected Castagnoli polynomial */
+#define CRC32C_POLY		0x82f63b78U
+/** ECMA-182 polynomial without x^64, and reflected */
+#define CRC64_POLY		0x42f0e1eba9ea3693ULL
+#define CRC64_POLY_REFL		0xc96c5795d7870f42ULL
+/** shorter buffers are not worth setting up the folding */
+#define CRC64_FOLD_MIN		128
+
+typedef uint32_t (*crc32c_func_t)(uint32_t crc, const uint8_t *buf,
+				  daos_size_t len);
+typedef uint64_t (*crc64_func_t)(uint64_t crc, const uint8_t *buf,
+				 daos_size_t len);
+
+static uint32_t		crc32c_tbl[8][256];
+static uint64_t		crc64_tbl[8][256];
+/**
+ * folding constants of CRC64 for distances of 16 and 64 bytes, the first
+ * one is for the low half of a block, see crc64_fold_const()
+ */
+static uint64_t		crc64_k16[2] __attribute__((aligned(16)));
+static uint64_t		crc64_k64[2] __attribute__((aligned(16)));
+static crc32c_func_t	crc32c_func;
+static crc64_func_t	crc64_func;
+static pthread_once_t	csum_once = PTHREAD_ONCE_INIT;
+
+/* NB: the functions below work on the raw CRC register, the pre and post
+ * inversions are done by daos_crc32c() and daos_crc64().
+ */
+static uint32_t
+crc32c_c(uint32_t crc, const uint8_t *buf, daos_size_t len)
+{
+	for (; len != 0 && ((uintptr_t)buf & 7) != 0; len--)
+		crc = crc32c_tbl[0][(crc ^ *buf++) & 0xff] ^ (crc >> 8);
+
+	for (; len >= 8; len -= 8, buf += 8) {
+		uint64_t	w = le64toh(*(const uint64_t *)buf) ^ crc;
+
+		crc = crc32c_tbl[7][w & 0xff] ^
+		      crc32c_tbl[6][(w >> 8) & 0xff] ^
+		      crc32c_tbl[5][(w >> 16) & 0xff] ^
+		      crc32c_tbl[4][(w >> 24) & 0xff] ^
+		      crc32c_tbl[3][(w >> 32) & 0xff] ^
+		      crc32c_tbl[2][(w >> 40) & 0xff] ^
+		      crc32c_tbl[1][(w >> 48) & 0xff] ^
+		      crc32c_tbl[0][w >> 56];
+	}
+
+	for (; len != 0; len--)
+		crc = crc32c_tbl[0][(crc ^ *buf++) & 0xff] ^ (crc >> 8);
+	return crc;
+}
+
+static uint64_t
+crc64_c(uint64_t crc, const uint8_t *buf, daos_size_t len)
+{
+	for (; len != 0 && ((uintptr_t)buf & 7) != 0; len--)
+		crc = crc64_tbl[0][(crc ^ *buf++) & 0xff] ^ (crc >> 8);
+
+	for (; len >= 8; len -= 8, buf += 8) {
+		uint64_t	w = le64toh(*(const uint64_t *)buf) ^ crc;
+
+		crc = crc64_tbl[7][w & 0xff] ^
+		      crc64_tbl[6][(w >> 8) & 0xff] ^
+		      crc64_tbl[5][(w >> 16) & 0xff] ^
+		      crc64_tbl[4][(w >> 24) & 0xff] ^
+		      crc64_tbl[3][(w >> 32) & 0xff] ^
+		      crc64_tbl[2][(w >> 40) & 0xff] ^
+		      crc64_tbl[1][(w >> 48) & 0xff] ^
+		      crc64_tbl[0][w >> 56];
+	}
+
+	for (; len != 0; len--)
+		crc = crc64_tbl[0][(crc ^ *buf++) & 0xff] ^ (crc >> 8);
+	return crc;
+}
+
+#if CSUM_HAS_HW
+static uint32_t __attribute__((target("sse4.2")))
+crc32c_hw(uint32_t crc, const uint8_t *buf, daos_size_t len)
+{
+	uint64_t	c = crc;
+
+	for (; len != 0 && ((uintptr_t)buf & 7) != 0; len--)
+		c = _mm_crc32_u8(c, *buf++);
+
+	for (; len >= 8; len -= 8, buf += 8)
+		c = _mm_crc32_u64(c, *(const uint64_t *)buf);
+
+	for (; len != 0; len--)
+		c = _mm_crc32_u8(c, *buf++);
+	return c;
+}
+
+/** multiply both halves of \a x by the constants \a k and add \a next */
+static inline __m128i __attribute__((target("pclmul")))
+crc64_fold(__m128i x, __m128i k, __m128i next)
+{
+	return _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x, k, 0x00),
+					   _mm_clmulepi64_si128(x, k, 0x11)),
+			     next);
+}
+
+static uint64_t __attribute__((target("pclmul")))
+crc64_hw(uint64_t crc, const uint8_t *buf, daos_size_t len)
+{
+	__m128i		k16;
+	__m128i		k64;
+	__m128i		x0;
+	__m128i		x1;
+	__m128i		x2;
+	__m128i		x3;
+	uint8_t		last[16];
+
+	if (len < CRC64_FOLD_MIN)
+		return crc64_c(crc, buf, len);
+
+	k16 = _mm_load_si128((__m128i *)crc64_k16);
+	k64 = _mm_load_si128((__m128i *)crc64_k64);
+
+	/* the CRC register is added to the first eight bytes */
+	x0 = _mm_xor_si128(_mm_loadu_si128((__m128i *)buf),
+			   _mm_cvtsi64_si128(crc));
+	x1 = _mm_loadu_si128((__m128i *)&buf[16]);
+	x2 = _mm_loadu_si128((__m128i *)&buf[32]);
+	x3 = _mm_loadu_si128((__m128i *)&buf[48]);
+	buf += 64;
+	len -= 64;
+
+	for (; len >= 64; len -= 64, buf += 64) {
+		x0 = crc64_fold(x0, k64, _mm_loadu_si128((__m128i *)buf));
+		x1 = crc64_fold(x1, k64,
+				_mm_loadu_si128((__m128i *)&buf[16]));
+		x2 = crc64_fold(x2, k64,
+				_mm_loadu_si128((__m128i *)&buf[32]));
+		x3 = crc64_fold(x3, k64,
+				_mm_loadu_si128((__m128i *)&buf[48]));
+	}
+
+	x0 = crc64_fold(x0, k16, x1);
+	x0 = crc64_fold(x0, k16, x2);
+	x0 = crc64_fold(x0, k16, x3);
+	for (; len >= 16; len -= 16, buf += 16)
+		x0 = crc64_fold(x0, k16, _mm_loadu_si128((__m128i *)buf));
+
+	/* the remaining 16 bytes carry the whole state */
+	_mm_storeu_si128((__m128i *)last, x0);
+	crc = crc64_c(0, last, sizeof(last));
+	return crc64_c(crc, buf, len);
+}
+#endif /* CSUM_HAS_HW */
+
+static int
+csum_kernel_select(enum daos_csum_kernel kernel)
+{
+	switch (kernel) {
+	default:
+		return -DER_INVAL;
+	case DAOS_CSUM_KERNEL_AUTO:
+		crc32c_func = crc32c_c;
+		crc64_func = crc64_c;
+#if CSUM_HAS_HW
+		if (__builtin_cpu_supports("sse4.2"))
+			crc32c_func = crc32c_hw;
+		if (__builtin_cpu_supports("pclmul"))
+			crc64_func = crc64_hw;
+#endif
+		return 0;
+	case DAOS_CSUM_KERNEL_C:
+		crc32c_func = crc32c_c;
+		crc64_func = crc64_c;
+		return 0;
+	case DAOS_CSUM_KERNEL_HW:
+#if CSUM_HAS_HW
+		if (!__builtin_cpu_supports("sse4.2") ||
+		    !__builtin_cpu_supports("pclmul"))
+			return -DER_NOSYS;
+		crc32c_func = crc32c_hw;
+		crc64_func = crc64_hw;
+		return 0;
+#else
+		return -DER_NOSYS;
+#endif
+	}
+}
+
+static uint64_t
+bit_reflect64(uint64_t val)
+{
+	uint64_t	res = 0;
+	int		i;
+
+	for (i = 0; i < 64; i++, val >>= 1)
+		res = (res << 1) | (val & 1);
+	return res;
+}
+
+/** reflected x^n mod P */
+static uint64_t
+crc64_xpow(unsigned int n)
+{
+	uint64_t	val = 1;
+
+	for (; n != 0; n--)
+		val = (val << 1) ^ ((val >> 63) ? CRC64_POLY : 0);
+	return bit_reflect64(val);
+}
+
+/**
+ * Constants to fold a block forward by \a dist bytes. A reflected product
+ * of two 64-bit polynomials is one bit short of 128 bits, so the exponents
+ * are reduced by one: x^(8 * dist + 64 - 1) for the low (leading) half and
+ * x^(8 * dist - 1) for the high half.
+ */
+static void
+crc64_fold_const(unsigned int dist, uint64_t *k)
+{
+	k[0] = crc64_xpow(8 * dist + 63);
+	k[1] = crc64_xpow(8 * dist - 1);
+}
+
+static void
+csum_init_once(void)
+{
+	uint32_t	c32;
+	uint64_t	c64;
+	int		i;
+	int		j;
+
+	for (i = 0; i < 256; i++) {
+		c32 = i;
+		c64 = i;
+		for (j = 0; j < 8; j++) {
+			c32 = (c32 >> 1) ^ ((c32 & 1) ? CRC32C_POLY : 0);
+			c64 = (c64 >> 1) ^ ((c64 & 1) ? CRC64_POLY_REFL : 0);
+		}
+		crc32c_tbl[0][i] = c32;
+		crc64_tbl[0][i] = c64;
+	}
+
+	for (i = 0; i < 256; i++) {
+		for (j = 1; j < 8; j++) {
+			c32 = crc32c_tbl[j - 1][i];
+			crc32c_tbl[j][i] = (c32 >> 8) ^
+					   crc32c_tbl[0][c32 & 0xff];
+			c64 = crc64_tbl[j - 1][i];
+			crc64_tbl[j][i] = (c64 >> 8) ^ crc64_tbl[0][c64 & 0xff];
+		}
+	}
+
+	crc64_fold_const(16, crc64_k16);
+	crc64_fold_const(64, crc64_k64);
+
+	csum_kernel_select(DAOS_CSUM_KERNEL_AUTO);
+}
+
+int
+daos_csum_kernel_set(enum daos_csum_kernel kernel)
+{
+	pthread_once(&csum_once, csum_init_once);
+	return csum_kernel_select(kernel);
+}
+
+uint32_t
+daos_crc32c(uint32_t crc, const void *buf, daos_size_t len)
+{
+	pthread_once(&csum_once, csum_init_once);
+	return ~crc32c_func(~crc, buf, len);
+}
+
+uint64_t
+daos_crc64(uint64_t crc, const void *buf, daos_size_t len)
+{
+	pthread_once(&csum_once, csum_init_once);
+	return ~crc64_func(~crc, buf, len);
+}
+
+static const char *csum_names[] = {
+	[DAOS_CSUM_CRC32C]	= "crc32c",
+	[DAOS_CSUM_CRC64]	= "crc64",
+};
+
+int
+daos_csum_name2type(const char *name)
+{
+	int	i;
+
+	if (name == NULL)
+		return DAOS_CSUM_NONE;
+
+	for (i = DAOS_CSUM_CRC32C; i < ARRAY_SIZE(csum_names); i++) {
+		if (strcasecmp(csum_names[i], name) == 0)
+			return i;
+	}
+	D__ERROR("Unsupported checksum type: %s\n", name);
+	return DAOS_CSUM_NONE;
+}
+
+const char *
+daos_csum_type2name(int type)
+{
+	if (type <= DAOS_CSUM_NONE || type >= ARRAY_SIZE(csum_names))
+		return "none";
+	return csum_names[type];
+}
+
+int
+daos_csum_type2size(int type)
+{
+	switch (type) {
+	default:
+		return 0;
+	case DAOS_CSUM_CRC32C:
+		return sizeof(uint32_t);
+	case DAOS_CSUM_CRC64:
+		return sizeof(uint64_t);
+	}
+}
+
+void
+daos_csum_update(struct daos_csum_ctx *ctx, const void *buf, daos_size_t len)
+{
+	switch (ctx->cc_type) {
+	default:
+		D__ASSERTF(0, "invalid checksum type %d\n", ctx->cc_type);
+		break;
+	case DAOS_CSUM_CRC32C:
+		ctx->cc_val = daos_crc32c(ctx->cc_val, buf, len);
+		break;
+	case DAOS_CSUM_CRC64:
+		ctx->cc_val = daos_crc64(ctx->cc_val, buf, len);
+		break;
+	}
+	ctx->cc_len += len;
+}
+
+void
+daos_csum_update_sgl(struct daos_csum_ctx *ctx, daos_sg_list_t *sgl,
+		     unsigned int nr)
+{
+	int	i;
+
+	for (i = 0; i < nr; i++) {
+		if (sgl->sg_iovs[i].iov_buf != NULL)
+			daos_csum_update(ctx, sgl->sg_iovs[i].iov_buf,
+					 sgl->sg_iovs[i].iov_len);
+	}
+}
+
+void
+daos_csum_final(struct daos_csum_ctx *ctx, daos_csum_buf_t *csum)
+{
+	uint32_t	crc32;
+	uint64_t	crc64;
+
+	csum->cs_type = ctx->cc_type;
+	csum->cs_len = daos_csum_type2size(ctx->cc_type);
+	D__ASSERT(csum->cs_buf_len >= csum->cs_len);
+
+	if (ctx->cc_type == DAOS_CSUM_CRC32C) {
+		crc32 = ctx->cc_val;
+		memcpy(csum->cs_csum, &crc32, sizeof(crc32));
+	} else if (ctx->cc_type == DAOS_CSUM_CRC64) {
+		crc64 = ctx->cc_val;
+		memcpy(csum->cs_csum, &crc64, sizeof(crc64));
+	}
+}
+
+int
+daos_csum_verify(struct daos_csum_ctx *ctx, daos_csum_buf_t *csum)
+{
+	daos_csum_buf_t	cbuf;
+	uint64_t	val;
+
+	daos_csum_set(&cbuf, &val, sizeof(val));
+	daos_csum_final(ctx, &cbuf);
+
+	if (csum->cs_type != cbuf.cs_type || csum->cs_len != cbuf.cs_len ||
+	    memcmp(csum->cs_csum, cbuf.cs_csum, cbuf.cs_len) != 0)
+		return -DER_IO;
+	return 0;
+}
@@ -0,0 +1,439 @@
+/**
+ * (C) Copyright 2017 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * GOVERNMENT LICENSE RIGHTS-OPEN SOURCE SOFTWARE
+ * The Government's rights to use, modify, reproduce, release, perform, display,
+ * or disclose this software are subject to the terms of the Apache License as
+ * provided in Contract No. B609815.
+ * Any reproduction of computer software, computer software documentation, or
+ * portions thereof marked with this legend must also reproduce the markings.
+ */
+/**
+ * This file is part of daos
+ *
+ * common/ec.c
+ *
+ * Reed-Solomon codec over GF(2^8). The parity rows of the generator matrix
+ * are a Cauchy matrix, so any k rows of the generator are invertible.
+ *
+ * Multiplying a vector by a constant c uses the split table method: the
+ * product of c and a byte x is tbl_lo[x & 0xf] ^ tbl_hi[x >> 4], with two
+ * 16-byte tables per coefficient, which maps onto one pshufb per nibble
+ * on x86.
+ */
+#define DDSUBSYS	DDFAC(common)
+
+#include <pthread.h>
+#include <daos_errno.h>
+#include <daos/ec.h>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define EC_HAS_SIMD		1
+#else
+#define EC_HAS_SIMD		0
+#endif
+
+/** primitive polynomial x^8 + x^4 + x^3 + x^2 + 1 */
+#define GF_POLY			0x11d
+/** bytes processed for all cells before moving to the next range */
+#define EC_CHUNK_SIZE		(16 << 10)
+
+/** coefficient and its split multiplication tables */
+struct ec_coef {
+	uint8_t		ecf_tbl[32];
+	uint8_t		ecf_val;
+};
+
+struct daos_ec_codec {
+	unsigned int	 ec_k;
+	unsigned int	 ec_p;
+	/** Cauchy matrix, ec_p rows of ec_k coefficients */
+	struct ec_coef	*ec_coefs;
+};
+
+/** dst = c * src, or dst ^= c * src if \a acc is true */
+typedef void (*ec_vect_mad_t)(daos_size_t len, struct ec_coef *coef,
+			      const uint8_t *src, uint8_t *dst, bool acc);
+
+static uint8_t		gf_exp[512];
+static uint8_t		gf_log[256];
+static ec_vect_mad_t	ec_vect_mad;
+static pthread_once_t	ec_once = PTHREAD_ONCE_INIT;
+
+static inline uint8_t
+gf_mul(uint8_t a, uint8_t b)
+{
+	if (a == 0 || b == 0)
+		return 0;
+	return gf_exp[gf_log[a] + gf_log[b]];
+}
+
+static inline uint8_t
+gf_inv(uint8_t a)
+{
+	D__ASSERT(a != 0);
+	return gf_exp[255 - gf_log[a]];
+}
+
+static void
+ec_coef_init(struct ec_coef *coef, uint8_t c)
+{
+	int	i;
+
+	coef->ecf_val = c;
+	for (i = 0; i < 16; i++) {
+		coef->ecf_tbl[i] = gf_mul(c, i);
+		coef->ecf_tbl[16 + i] = gf_mul(c, i << 4);
+	}
+}
+
+static void
+ec_vect_mad_c(daos_size_t len, struct ec_coef *coef, const uint8_t *src,
+	      uint8_t *dst, bool acc)
+{
+	const uint8_t	*lo = &coef->ecf_tbl[0];
+	const uint8_t	*hi = &coef->ecf_tbl[16];
+	daos_size_t	 i;
+
+	if (acc) {
+		for (i = 0; i < len; i++)
+			dst[i] ^= lo[src[i] & 0xf] ^ hi[src[i] >> 4];
+	} else {
+		for (i = 0; i < len; i++)
+			dst[i] = lo[src[i] & 0xf] ^ hi[src[i] >> 4];
+	}
+}
+
+#if EC_HAS_SIMD
+static void __attribute__((target("ssse3")))
+ec_vect_mad_ssse3(daos_size_t len, struct ec_coef *coef, const uint8_t *src,
+		  uint8_t *dst, bool acc)
+{
+	__m128i		lo = _mm_loadu_si128((__m128i *)&coef->ecf_tbl[0]);
+	__m128i		hi = _mm_loadu_si128((__m128i *)&coef->ecf_tbl[16]);
+	__m128i		mask = _mm_set1_epi8(0x0f);
+	daos_size_t	i;
+
+	for (i = 0; i + 16 <= len; i += 16) {
+		__m128i	x = _mm_loadu_si128((__m128i *)&src[i]);
+		__m128i	r;
+
+		r = _mm_xor_si128(
+			_mm_shuffle_epi8(lo, _mm_and_si128(x, mask)),
+			_mm_shuffle_epi8(hi, _mm_and_si128(
+				_mm_srli_epi64(x, 4), mask)));
+		if (acc)
+			r = _mm_xor_si128(r,
+					  _mm_loadu_si128((__m128i *)&dst[i]));
+		_mm_storeu_si128((__m128i *)&dst[i], r);
+	}
+	ec_vect_mad_c(len - i, coef, &src[i], &dst[i], acc);
+}
+
+static void __attribute__((target("avx2")))
+ec_vect_mad_avx2(daos_size_t len, struct ec_coef *coef, const uint8_t *src,
+		 uint8_t *dst, bool acc)
+{
+	__m256i		lo;
+	__m256i		hi;
+	__m256i		mask = _mm256_set1_epi8(0x0f);
+	daos_size_t	i;
+
+	/* pshufb works within 128-bit lanes, so both lanes get the table */
+	lo = _mm256_broadcastsi128_si256(
+			_mm_loadu_si128((__m128i *)&coef->ecf_tbl[0]));
+	hi = _mm256_broadcastsi128_si256(
+			_mm_loadu_si128((__m128i *)&coef->ecf_tbl[16]));
+
+	for (i = 0; i + 32 <= len; i += 32) {
+		__m256i	x = _mm256_loadu_si256((__m256i *)&src[i]);
+		__m256i	r;
+
+		r = _mm256_xor_si256(
+			_mm256_shuffle_epi8(lo, _mm256_and_si256(x, mask)),
+			_mm256_shuffle_epi8(hi, _mm256_and_si256(
+				_mm256_srli_epi64(x, 4), mask)));
+		if (acc)
+			r = _mm256_xor_si256(r,
+				_mm256_loadu_si256((__m256i *)&dst[i]));
+		_mm256_storeu_si256((__m256i *)&dst[i], r);
+	}
+	ec_vect_mad_ssse3(len - i, coef, &src[i], &dst[i], acc);
+}
+#endif /* EC_HAS_SIMD */
+
+int
+daos_ec_kernel_set(enum daos_ec_kernel kernel)
+{
+	switch (kernel) {
+	default:
+		return -DER_INVAL;
+	case DAOS_EC_KERNEL_AUTO:
+#if EC_HAS_SIMD
+		if (__builtin_cpu_supports("avx2"))
+			return daos_ec_kernel_set(DAOS_EC_KERNEL_AVX2);
+		if (__builtin_cpu_supports("ssse3"))
+			return daos_ec_kernel_set(DAOS_EC_KERNEL_SSSE3);
+#endif
+		return daos_ec_kernel_set(DAOS_EC_KERNEL_C);
+	case DAOS_EC_KERNEL_C:
+		ec_vect_mad = ec_vect_mad_c;
+		return 0;
+#if EC_HAS_SIMD
+	case DAOS_EC_KERNEL_SSSE3:
+		if (!__builtin_cpu_supports("ssse3"))
+			return -DER_NOSYS;
+		ec_vect_mad = ec_vect_mad_ssse3;
+		return 0;
+	case DAOS_EC_KERNEL_AVX2:
+		if (!__builtin_cpu_supports("avx2"))
+			return -DER_NOSYS;
+		ec_vect_mad = ec_vect_mad_avx2;
+		return 0;
+#else
+	case DAOS_EC_KERNEL_SSSE3:
+	case DAOS_EC_KERNEL_AVX2:
+		return -DER_NOSYS;
+#endif
+	}
+}
+
+static void
+ec_init_once(void)
+{
+	unsigned int	x = 1;
+	int		i;
+
+	for (i = 0; i < 255; i++) {
+		gf_exp[i] = x;
+		gf_log[x] = i;
+		x <<= 1;
+		if (x & 0x100)
+			x ^= GF_POLY;
+	}
+	/* no modulo in gf_mul() */
+	for (i = 255; i < 512; i++)
+		gf_exp[i] = gf_exp[i - 255];
+
+	daos_ec_kernel_set(DAOS_EC_KERNEL_AUTO);
+}
+
+int
+daos_ec_codec_create(unsigned int k, unsigned int p,
+		     struct daos_ec_codec **codec_p)
+{
+	struct daos_ec_codec	*codec;
+	int			 i;
+	int			 j;
+
+	if (k == 0 || p == 0 || k + p > DAOS_EC_CELL_MAX)
+		return -DER_INVAL;
+
+	pthread_once(&ec_once, ec_init_once);
+
+	D__ALLOC_PTR(codec);
+	if (codec == NULL)
+		return -DER_NOMEM;
+
+	D__ALLOC(codec->ec_coefs, k * p * sizeof(*codec->ec_coefs));
+	if (codec->ec_coefs == NULL) {
+		D__FREE_PTR(codec);
+		return -DER_NOMEM;
+	}
+
+	codec->ec_k = k;
+	codec->ec_p = p;
+	/* Cauchy matrix 1 / (x_i + y_j), x_i = k + i and y_j = j are all
+	 * distinct, so none of the sums is zero.
+	 */
+	for (i = 0; i < p; i++) {
+		for (j = 0; j < k; j++)
+			ec_coef_init(&codec->ec_coefs[i * k + j],
+				     gf_inv((k + i) ^ j));
+	}
+	*codec_p = codec;
+	return 0;
+}
+
+void
+daos_ec_codec_destroy(struct daos_ec_codec *codec)
+{
+	D__FREE(codec->ec_coefs,
+		codec->ec_k * codec->ec_p * sizeof(*codec->ec_coefs));
+	D__FREE_PTR(codec);
+}
+
+/**
+ * out[i] = sum(coefs[i * nr + j] * in[j]), it walks the cells by chunks so
+ * the inputs stay in cache while all outputs are computed.
+ */
+static void
+ec_matrix_mul(daos_size_t len, struct ec_coef *coefs, unsigned int nr,
+	      unsigned char **in, unsigned int out_nr, unsigned char **out)
+{
+	daos_size_t	off;
+	daos_size_t	size;
+	int		i;
+	int		j;
+
+	for (off = 0; off < len; off += size) {
+		size = min(len - off, EC_CHUNK_SIZE);
+		for (i = 0; i < out_nr; i++) {
+			for (j = 0; j < nr; j++)
+				ec_vect_mad(size, &coefs[i * nr + j],
+					    &in[j][off], &out[i][off], j != 0);
+		}
+	}
+}
+
+void
+daos_ec_encode(struct daos_ec_codec *codec, daos_size_t len,
+	       unsigned char **data, unsigned char **parity)
+{
+	ec_matrix_mul(len, codec->ec_coefs, codec->ec_k, data, codec->ec_p,
+		      parity);
+}
+
+/** generator row of cell \a row, the first k rows are the identity */
+static uint8_t
+ec_gen_coef(struct daos_ec_codec *codec, int row, int col)
+{
+	if (row < codec->ec_k)
+		return row == col;
+	return codec->ec_coefs[(row - codec->ec_k) * codec->ec_k + col].ecf_val;
+}
+
+/** Gauss-Jordan inversion of the \a n x \a n matrix \a mat into \a inv */
+static int
+ec_matrix_invert(uint8_t *mat, uint8_t *inv, int n)
+{
+	int	i;
+	int	j;
+	int	r;
+
+	memset(inv, 0, n * n);
+	for (i = 0; i < n; i++)
+		inv[i * n + i] = 1;
+
+	for (i = 0; i < n; i++) {
+		uint8_t	c;
+
+		if (mat[i * n + i] == 0) {
+			for (r = i + 1; r < n; r++) {
+				if (mat[r * n + i] != 0)
+					break;
+			}
+			if (r == n)
+				return -DER_INVAL; /* singular */
+
+			for (j = 0; j < n; j++) {
+				uint8_t	t;
+
+				t = mat[i * n + j];
+				mat[i * n + j] = mat[r * n + j];
+				mat[r * n + j] = t;
+				t = inv[i * n + j];
+				inv[i * n + j] = inv[r * n + j];
+				inv[r * n + j] = t;
+			}
+		}
+
+		c = gf_inv(mat[i * n + i]);
+		for (j = 0; j < n; j++) {
+			mat[i * n + j] = gf_mul(mat[i * n + j], c);
+			inv[i * n + j] = gf_mul(inv[i * n + j], c);
+		}
+
+		for (r = 0; r < n; r++) {
+			c = mat[r * n + i];
+			if (r == i || c == 0)
+				continue;
+			for (j = 0; j < n; j++) {
+				mat[r * n + j] ^= gf_mul(c, mat[i * n + j]);
+				inv[r * n + j] ^= gf_mul(c, inv[i * n + j]);
+			}
+		}
+	}
+	return 0;
+}
+
+int
+daos_ec_decode(struct daos_ec_codec *codec, daos_size_t len,
+	       unsigned char **cells, uint32_t lost)
+{
+	unsigned int	 k = codec->ec_k;
+	unsigned char	*in[DAOS_EC_CELL_MAX];
+	unsigned char	*out[DAOS_EC_CELL_MAX];
+	int		 rows[DAOS_EC_CELL_MAX];
+	uint8_t		 mat[DAOS_EC_CELL_MAX * DAOS_EC_CELL_MAX];
+	uint8_t		 inv[DAOS_EC_CELL_MAX * DAOS_EC_CELL_MAX];
+	struct ec_coef	*coefs;
+	int		 out_nr;
+	int		 nr;
+	int		 i;
+	int		 j;
+	int		 m;
+	int		 rc;
+
+	if (lost == 0)
+		return 0;
+
+	for (i = nr = 0; i < k + codec->ec_p && nr < k; i++) {
+		if (cells[i] != NULL && !(lost & (1U << i))) {
+			rows[nr] = i;
+			in[nr++] = cells[i];
+		}
+	}
+	if (nr < k)
+		return -DER_IO;
+
+	/* rows of the generator for the surviving cells */
+	for (i = 0; i < k; i++) {
+		for (j = 0; j < k; j++)
+			mat[i * k + j] = ec_gen_coef(codec, rows[i], j);
+	}
+
+	rc = ec_matrix_invert(mat, inv, k);
+	if (rc != 0)
+		return rc;
+
+	D__ALLOC(coefs, k * codec->ec_p * sizeof(*coefs));
+	if (coefs == NULL)
+		return -DER_NOMEM;
+
+	/* a lost cell is its generator row times the inverted matrix applied
+	 * to the surviving cells
+	 */
+	for (i = out_nr = 0; i < k + codec->ec_p; i++) {
+		if (!(lost & (1U << i)))
+			continue;
+
+		D__ASSERT(out_nr < codec->ec_p);
+		for (j = 0; j < k; j++) {
+			uint8_t	c = 0;
+
+			for (m = 0; m < k; m++)
+				c ^= gf_mul(ec_gen_coef(codec, i, m),
+					    inv[m * k + j]);
+			ec_coef_init(&coefs[out_nr * k + j], c);
+		}
+		out[out_nr++] = cells[i];
+	}
+
+	ec_matrix_mul(len, coefs, k, in, out_nr, out);
+	D__FREE(coefs, k * codec->ec_p * sizeof(*coefs));
+	return 0;
+}
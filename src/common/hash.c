@@ -30,6 +30,7 @@
 #define DDSUBSYS	DDFAC(common)
 
 #include <pthread.h>
+#include <sched.h>
 #include <daos/common.h>
 #include <daos/list.h>
 #include <daos/hash.h>
@@ -241,21 +242,17 @@ dh_unlock(struct dhash_table *htable, bool read_only)
  */
 
 /**
- * Convert key to hash bucket id.
+ * Hash key to a 32-bit value, the bucket is chosen by dh_bucket().
  *
  * It calls DJB2 hash if no customized hash function is provided.
  */
-static unsigned int
+static uint32_t
 dh_key_hash(struct dhash_table *htable, const void *key, unsigned int ksize)
 {
-	unsigned int idx;
-
 	if (htable->ht_ops->hop_key_hash)
-		idx = htable->ht_ops->hop_key_hash(htable, key, ksize);
+		return htable->ht_ops->hop_key_hash(htable, key, ksize);
 	else
-		idx = daos_hash_string_u32((const char *)key, ksize);
-
-	return idx & ((1U << htable->ht_bits) - 1);
+		return daos_hash_string_u32((const char *)key, ksize);
 }
 
 static void
@@ -280,17 +277,41 @@ dh_key_get(struct dhash_table *htable, daos_list_t *rlink, void **key_pp)
 	return htable->ht_ops->hop_key_get(htable, rlink, key_pp);
 }
 
-static void
-dh_rec_insert(struct dhash_table *htable, unsigned idx, daos_list_t *rlink)
+/** hash of the key of the record @rlink */
+static uint32_t
+dh_rec_hash(struct dhash_table *htable, daos_list_t *rlink)
 {
-	struct dhash_bucket *bucket = &htable->ht_buckets[idx];
+	void		*key;
+	unsigned int	 ksize;
 
-	daos_list_add(rlink, &bucket->hb_head);
-#if DHASH_DEBUG
-	htable->ht_nr++;
-	if (htable->ht_nr > htable->ht_nr_max)
-		htable->ht_nr_max = htable->ht_nr;
+	ksize = dh_key_get(htable, rlink, &key);
+	return dh_key_hash(htable, key, ksize);
+}
 
+/**
+ * Return the bucket of @hash. While the table is being rehashed, a record
+ * stays in the old buckets until its old bucket is rehashed.
+ *
+ * Records are only moved by writers, so the bucket is stable for readers
+ * of a DHASH_FT_RWLOCK hash table.
+ */
+static struct dhash_bucket *
+dh_bucket(struct dhash_table *htable, uint32_t hash)
+{
+	unsigned int	idx;
+
+	if (htable->ht_old_buckets != NULL) {
+		idx = hash & ((1U << htable->ht_old_bits) - 1);
+		if (idx >= htable->ht_rehash_idx)
+			return &htable->ht_old_buckets[idx];
+	}
+	return &htable->ht_buckets[hash & ((1U << htable->ht_bits) - 1)];
+}
+
+static void
+dh_bucket_depth_inc(struct dhash_table *htable, struct dhash_bucket *bucket)
+{
+#if DHASH_DEBUG
 	if (htable->ht_ops->hop_key_get) {
 		bucket->hb_dep++;
 		if (bucket->hb_dep > htable->ht_dep_max) {
@@ -303,29 +324,132 @@ dh_rec_insert(struct dhash_table *htable, unsigned idx, daos_list_t *rlink)
 #endif
 }
 
+static void
+dh_rec_insert(struct dhash_table *htable, struct dhash_bucket *bucket,
+	      daos_list_t *rlink)
+{
+	daos_list_add(rlink, &bucket->hb_head);
+	htable->ht_nr++;
+#if DHASH_DEBUG
+	if (htable->ht_nr > htable->ht_nr_max)
+		htable->ht_nr_max = htable->ht_nr;
+#endif
+	dh_bucket_depth_inc(htable, bucket);
+}
+
 static void
 dh_rec_delete(struct dhash_table *htable, daos_list_t *rlink)
 {
 	daos_list_del_init(rlink);
-#if DHASH_DEBUG
+	D__ASSERT(htable->ht_nr > 0);
 	htable->ht_nr--;
-	if (htable->ht_ops->hop_key_get) {
-		struct dhash_bucket *bucket;
-		void		    *key;
-		unsigned int	     size;
+#if DHASH_DEBUG
+	if (htable->ht_ops->hop_key_get)
+		dh_bucket(htable, dh_rec_hash(htable, rlink))->hb_dep--;
+#endif
+}
 
-		size = htable->ht_ops->hop_key_get(htable, rlink, &key);
-		bucket = &htable->ht_buckets[dh_key_hash(htable, key, size)];
-		bucket->hb_dep--;
-	}
+static bool
+dh_resizable(struct dhash_table *htable)
+{
+	return htable->ht_ops->hop_key_get != NULL &&
+	       !(htable->ht_feats & DHASH_FT_NORESIZE);
+}
+
+/**
+ * Move the records of the next DHASH_REHASH_STEP old buckets to the new
+ * buckets, and free the old buckets after moving the last one.
+ */
+static void
+dh_rehash_step(struct dhash_table *htable)
+{
+	struct dhash_bucket *old;
+	struct dhash_bucket *bucket;
+	daos_list_t	    *rlink;
+	unsigned int	     old_nr = 1U << htable->ht_old_bits;
+	unsigned int	     idx;
+	int		     i;
+
+	for (i = 0; i < DHASH_REHASH_STEP; i++) {
+		old = &htable->ht_old_buckets[htable->ht_rehash_idx];
+		while (!daos_list_empty(&old->hb_head)) {
+			rlink = old->hb_head.next;
+			/* the rehash index is not moved yet, so it can't
+			 * return the old bucket
+			 */
+			idx = dh_rec_hash(htable, rlink) &
+			      ((1U << htable->ht_bits) - 1);
+			bucket = &htable->ht_buckets[idx];
+			daos_list_move(rlink, &bucket->hb_head);
+#if DHASH_DEBUG
+			old->hb_dep--;
 #endif
+			dh_bucket_depth_inc(htable, bucket);
+		}
+
+		if (++htable->ht_rehash_idx < old_nr)
+			continue;
+
+		D__DEBUG(DB_TRACE, "hash table %p rehashed, bits %u->%u, "
+			 "nr %u\n", htable, htable->ht_old_bits,
+			 htable->ht_bits, htable->ht_nr);
+		D__FREE(htable->ht_old_buckets, sizeof(*old) * old_nr);
+		htable->ht_old_bits = 0;
+		htable->ht_rehash_idx = 0;
+		break;
+	}
+}
+
+/**
+ * Called by insert and delete with the write lock held. It continues the
+ * rehash in progress, or starts a new one if the number of records is out
+ * of the load factor range. Nothing happens if the new buckets can't be
+ * allocated, it is retried by the next insert or delete.
+ */
+static void
+dh_resize(struct dhash_table *htable)
+{
+	struct dhash_bucket *buckets;
+	unsigned int	     bits = htable->ht_bits;
+	unsigned int	     nr = 1U << bits;
+	int		     i;
+
+	if (!dh_resizable(htable))
+		return;
+
+	if (htable->ht_old_buckets != NULL) {
+		dh_rehash_step(htable);
+		return;
+	}
+
+	if (htable->ht_nr > nr * DHASH_LOAD_MAX && bits < DHASH_BITS_MAX)
+		bits++;
+	else if (htable->ht_nr < nr / DHASH_LOAD_MIN &&
+		 bits > htable->ht_min_bits)
+		bits--;
+	else
+		return;
+
+	nr = 1U << bits;
+	D__ALLOC(buckets, sizeof(*buckets) * nr);
+	if (buckets == NULL)
+		return;
+
+	for (i = 0; i < nr; i++)
+		DAOS_INIT_LIST_HEAD(&buckets[i].hb_head);
+
+	htable->ht_old_buckets	= htable->ht_buckets;
+	htable->ht_old_bits	= htable->ht_bits;
+	htable->ht_rehash_idx	= 0;
+	htable->ht_buckets	= buckets;
+	htable->ht_bits		= bits;
+	dh_rehash_step(htable);
 }
 
 static daos_list_t *
-dh_rec_find(struct dhash_table *htable, unsigned idx, const void *key,
-	     unsigned int ksize)
+dh_rec_find(struct dhash_table *htable, struct dhash_bucket *bucket,
+	    const void *key, unsigned int ksize)
 {
-	struct dhash_bucket *bucket = &htable->ht_buckets[idx];
 	daos_list_t	    *rlink;
 
 	daos_list_for_each(rlink, &bucket->hb_head) {
@@ -368,14 +492,14 @@ daos_list_t *
 dhash_rec_find(struct dhash_table *htable, const void *key, unsigned int ksize)
 {
 	daos_list_t	*rlink;
-	int		 idx;
+	uint32_t	 hash;
 
 	D__ASSERT(key != NULL);
 
-	idx = dh_key_hash(htable, key, ksize);
+	hash = dh_key_hash(htable, key, ksize);
 	dh_lock(htable, true);
 
-	rlink = dh_rec_find(htable, idx, key, ksize);
+	rlink = dh_rec_find(htable, dh_bucket(htable, hash), key, ksize);
 	if (rlink != NULL)
 		dh_rec_addref(htable, rlink);
 
@@ -401,19 +525,20 @@ int
 dhash_rec_insert(struct dhash_table *htable, const void *key,
 		 unsigned int ksize, daos_list_t *rlink, bool exclusive)
 {
-	int	idx;
-	int	rc = 0;
+	struct dhash_bucket	*bucket;
+	int			 rc = 0;
 
 	D__ASSERT(key != NULL && ksize != 0);
 
-	idx = dh_key_hash(htable, key, ksize);
 	dh_lock(htable, false);
 
-	if (exclusive && dh_rec_find(htable, idx, key, ksize))
+	bucket = dh_bucket(htable, dh_key_hash(htable, key, ksize));
+	if (exclusive && dh_rec_find(htable, bucket, key, ksize))
 		D__GOTO(out, rc = -DER_EXIST);
 
 	dh_rec_addref(htable, rlink);
-	dh_rec_insert(htable, idx, rlink);
+	dh_rec_insert(htable, bucket, rlink);
+	dh_resize(htable);
  out:
 	dh_unlock(htable, false);
 	return 0;
@@ -432,9 +557,7 @@ int
 dhash_rec_insert_anonym(struct dhash_table *htable, daos_list_t *rlink,
 			void *args)
 {
-	void	*key;
-	int	 idx;
-	int	 ksize;
+	struct dhash_bucket *bucket;
 
 	if (htable->ht_ops->hop_key_init == NULL ||
 	    htable->ht_ops->hop_key_get == NULL)
@@ -444,11 +567,10 @@ dhash_rec_insert_anonym(struct dhash_table *htable, daos_list_t *rlink,
 	/* has no key, hash table should have provided key generator */
 	dh_key_init(htable, rlink, args);
 
-	ksize = dh_key_get(htable, rlink, &key);
-	idx = dh_key_hash(htable, key, ksize);
-
+	bucket = dh_bucket(htable, dh_rec_hash(htable, rlink));
 	dh_rec_addref(htable, rlink);
-	dh_rec_insert(htable, idx, rlink);
+	dh_rec_insert(htable, bucket, rlink);
+	dh_resize(htable);
 
 	dh_unlock(htable, false);
 	return 0;
@@ -469,20 +591,21 @@ dhash_rec_delete(struct dhash_table *htable, const void *key,
 		 unsigned int ksize)
 {
 	daos_list_t	*rlink;
-	int		 idx;
+	uint32_t	 hash;
 	bool		 deleted = false;
 	bool		 zombie  = false;
 
 	D__ASSERT(key != NULL);
 
-	idx = dh_key_hash(htable, key, ksize);
+	hash = dh_key_hash(htable, key, ksize);
 	dh_lock(htable, false);
 
-	rlink = dh_rec_find(htable, idx, key, ksize);
+	rlink = dh_rec_find(htable, dh_bucket(htable, hash), key, ksize);
 	if (rlink != NULL) {
 		dh_rec_delete(htable, rlink);
 		zombie = dh_rec_decref(htable, rlink);
 		deleted = true;
+		dh_resize(htable);
 	}
 
 	dh_unlock(htable, false);
@@ -516,6 +639,7 @@ dhash_rec_delete_at(struct dhash_table *htable, daos_list_t *rlink)
 		dh_rec_delete(htable, rlink);
 		zombie = dh_rec_decref(htable, rlink);
 		deleted = true;
+		dh_resize(htable);
 	}
 	dh_unlock(htable, false);
 
@@ -580,7 +704,8 @@ dhash_rec_unlinked(daos_list_t *rlink)
  * see dhash_feats for the details.
  *
  * \param feats		[IN]	Feature bits, see DHASH_FT_*
- * \param bits		[IN]	power2(bits) is the size of hash table
+ * \param bits		[IN]	power2(bits) is the initial and minimum size
+ *				of hash table, see DHASH_FT_NORESIZE
  * \param priv		[IN]	Private data for the hash table
  * \param hops		[IN]	Customized member functions
  * \param htable	[IN]	Hash table to be initialised
@@ -595,11 +720,14 @@ dhash_table_create_inplace(uint32_t feats, unsigned int bits, void *priv,
 
 	D__ASSERT(hops != NULL);
 	D__ASSERT(hops->hop_key_cmp != NULL);
+	D__ASSERT(bits <= DHASH_BITS_MAX);
 
-	htable->ht_feats = feats;
-	htable->ht_bits	 = bits;
-	htable->ht_ops	 = hops;
-	htable->ht_priv	 = priv;
+	memset(htable, 0, sizeof(*htable));
+	htable->ht_feats    = feats;
+	htable->ht_bits	    = bits;
+	htable->ht_min_bits = bits;
+	htable->ht_ops	    = hops;
+	htable->ht_priv	    = priv;
 
 	D__ALLOC(buckets, sizeof(*buckets) * nr);
 	if (buckets == NULL)
@@ -621,7 +749,8 @@ dhash_table_create_inplace(uint32_t feats, unsigned int bits, void *priv,
  * see dhash_feats for the details.
  *
  * \param feats		[IN]	Feature bits, see DHASH_FT_*
- * \param bits		[IN]	power2(bits) is the size of hash table
+ * \param bits		[IN]	power2(bits) is the initial and minimum size
+ *				of hash table, see DHASH_FT_NORESIZE
  * \param priv		[IN]	Private data for the hash table
  * \param hops		[IN]	Customized member functions
  * \param htable_pp	[OUT]	The newly created hash table
@@ -660,15 +789,29 @@ dhash_table_create(uint32_t feats, unsigned int bits, void *priv,
  *
  * \return			zero on success, negative value if error.
  */
+static int
+dh_buckets_traverse(struct dhash_bucket *buckets, unsigned int nr,
+		    dhash_traverse_cb_t cb, void *args)
+{
+	daos_list_t	*rlink;
+	int		 i;
+	int		 rc;
+
+	for (i = 0; i < nr; i++) {
+		daos_list_for_each(rlink, &buckets[i].hb_head) {
+			rc = cb(rlink, args);
+			if (rc != 0)
+				return rc;
+		}
+	}
+	return 0;
+}
+
 int
 dhash_table_traverse(struct dhash_table *htable, dhash_traverse_cb_t cb,
 		     void *args)
 {
 	struct dhash_bucket *buckets = htable->ht_buckets;
-	daos_list_t	    *rlink;
-
-	int		     nr;
-	int		     i;
 	int		     rc = 0;
 
 	if (buckets == NULL) {
@@ -683,15 +826,14 @@ dhash_table_traverse(struct dhash_table *htable, dhash_traverse_cb_t cb,
 
 	dh_lock(htable, true);
 
-	nr = 1U << htable->ht_bits;
-	for (i = 0; i < nr; i++) {
-		daos_list_for_each(rlink, &buckets[i].hb_head) {
-			rc = cb(rlink, args);
-			if (rc != 0)
-				D__GOTO(unlock, rc);
-		}
+	if (htable->ht_old_buckets != NULL) {
+		rc = dh_buckets_traverse(htable->ht_old_buckets,
+					 1U << htable->ht_old_bits, cb, args);
+		if (rc != 0)
+			D__GOTO(unlock, rc);
 	}
-
+	rc = dh_buckets_traverse(htable->ht_buckets, 1U << htable->ht_bits,
+				 cb, args);
 unlock:
 	dh_unlock(htable, true);
 out:
@@ -709,26 +851,42 @@ out:
  *				Finalise the hash table only if it is empty,
  *				otherwise returns error
  */
+static void
+dh_buckets_purge(struct dhash_table *htable, struct dhash_bucket *buckets,
+		 unsigned int nr)
+{
+	int	i;
+
+	for (i = 0; i < nr; i++) {
+		while (!daos_list_empty(&buckets[i].hb_head))
+			dhash_rec_delete_at(htable, buckets[i].hb_head.next);
+	}
+}
+
 int
 dhash_table_destroy_inplace(struct dhash_table *htable, bool force)
 {
 	struct dhash_bucket *buckets = htable->ht_buckets;
-	int		     nr;
-	int		     i;
+	unsigned int	     nr;
 
 	if (buckets == NULL)
 		goto out;
 
-	nr = 1U << htable->ht_bits;
-	for (i = 0; i < nr; i++) {
-		while (!daos_list_empty(&buckets[i].hb_head)) {
-			if (!force) {
-				D__DEBUG(DB_TRACE, "Warning, non-empty hash\n");
-				return -DER_BUSY;
-			}
-			dhash_rec_delete_at(htable, buckets[i].hb_head.next);
-		}
+	if (!force && htable->ht_nr != 0) {
+		D__DEBUG(DB_TRACE, "Warning, non-empty hash\n");
+		return -DER_BUSY;
+	}
+
+	/* don't move the buckets while purging them */
+	htable->ht_feats |= DHASH_FT_NORESIZE;
+	if (htable->ht_old_buckets != NULL) {
+		nr = 1U << htable->ht_old_bits;
+		dh_buckets_purge(htable, htable->ht_old_buckets, nr);
+		D__FREE(htable->ht_old_buckets, sizeof(*buckets) * nr);
 	}
+
+	nr = 1U << htable->ht_bits;
+	dh_buckets_purge(htable, buckets, nr);
 	D__FREE(buckets, sizeof(*buckets) * nr);
 	dh_lock_fini(htable);
  out:
@@ -768,12 +926,65 @@ dhash_table_debug(struct dhash_table *htable)
 }
 
 /**
- * daos handle hash table: the first user of dhash_table
+ * daos handle hash table: a lock-free handle table.
+ *
+ * A handle is an index into an array of slots, the cookie also has the
+ * generation of the slot so a stale handle can't find the new record of a
+ * reused slot:
+ *
+ *	| generation | slot index (HH_IDX_BITS) | type (DAOS_HTYPE_BITS) |
+ *
+ * Slots are allocated by chunks which are never moved or freed before the
+ * table is destroyed, so lookup only indexes the array and checks the
+ * generation, without any lock. Insert and delete are serialized by a
+ * mutex.
+ *
+ * The state of a slot has the generation of the record in it, zero if the
+ * slot is free, and the number of lookups in progress. Lookup "pins" the
+ * slot with a CAS which succeeds only if the generation matches, then takes
+ * a refcount on the record. Delete clears the generation and waits for the
+ * pins to go away before releasing the refcount of the table, so the record
+ * can't be freed under a lookup.
  */
 
+/** handles per chunk of slots */
+#define HH_CHUNK_BITS		10
+#define HH_CHUNK_SIZE		(1U << HH_CHUNK_BITS)
+/** a table has at most 2^(HH_CHUNK_BITS + HH_DIR_BITS), 4M handles */
+#define HH_DIR_BITS		12
+#define HH_DIR_SIZE		(1U << HH_DIR_BITS)
+#define HH_IDX_BITS		(HH_CHUNK_BITS + HH_DIR_BITS)
+#define HH_IDX_MASK		((1ULL << HH_IDX_BITS) - 1)
+#define HH_GEN_BITS		(64 - HH_IDX_BITS - DAOS_HTYPE_BITS)
+#define HH_GEN_MASK		((1ULL << HH_GEN_BITS) - 1)
+/** low bits of the slot state are the number of lookups in progress */
+#define HH_PIN_BITS		20
+#define HH_PIN_MASK		((1ULL << HH_PIN_BITS) - 1)
+/** end of the free slot list */
+#define HH_SLOT_NONE		((uint32_t)-1)
+
+struct daos_hhash_slot {
+	/** generation << HH_PIN_BITS | pins, generation is zero if free */
+	uint64_t		 hs_state;
+	/** the record, only valid while the generation is not zero */
+	struct daos_hlink	*hs_link;
+	/** generation of the next record of this slot */
+	uint64_t		 hs_gen;
+	/** next free slot */
+	uint32_t		 hs_next;
+};
+
 struct daos_hhash {
-	uint64_t                dh_cookie;
-	struct dhash_table	dh_htable;
+	/** serialize insert and delete */
+	pthread_mutex_t		 dh_lock;
+	/** list of all the records, for destroy */
+	daos_list_t		 dh_links;
+	/** head of the free slot list */
+	uint32_t		 dh_free;
+	/** number of allocated chunks */
+	unsigned int		 dh_chunk_nr;
+	/** chunks of slots, read without lock by lookup */
+	struct daos_hhash_slot	*dh_chunks[HH_DIR_SIZE];
 };
 
 static struct daos_rlink*
@@ -816,24 +1027,16 @@ rlink_op_empty(struct daos_rlink *rlink)
 	return dhash_rec_unlinked(&rlink->rl_link);
 }
 
-static struct daos_hlink *
-hh_link2ptr(daos_list_t *link)
+static void
+hh_op_rec_addref(struct dhash_table *hhtab, daos_list_t *link)
 {
-	struct daos_rlink	*rlink;
-
-	rlink = link2rlink(link);
-	return	container_of(rlink, struct daos_hlink, hl_link);
+	rlink_op_addref(link2rlink(link));
 }
 
-static void
-hh_op_key_init(struct dhash_table *hhtab, daos_list_t *rlink, void *args)
+static bool
+hh_op_rec_decref(struct dhash_table *hhtab, daos_list_t *link)
 {
-	struct daos_hhash *dht;
-	struct daos_hlink *hlink = hh_link2ptr(rlink);
-	int		   type = *(int *)args;
-
-	dht = container_of(hhtab, struct daos_hhash, dh_htable);
-	hlink->hl_key = ((dht->dh_cookie++) << DAOS_HTYPE_BITS) | type;
+	return rlink_op_decref(link2rlink(link));
 }
 
 static int
@@ -847,93 +1050,134 @@ hh_key_type(const void *key)
 	return cookie & DAOS_HTYPE_MASK;
 }
 
-static int
-hh_op_key_get(struct dhash_table *hhtab, daos_list_t *rlink, void **key_pp)
+static uint64_t
+hh_key_gen(uint64_t key)
 {
-	struct daos_hlink *hlink = hh_link2ptr(rlink);
-
-	*key_pp = (void *)&hlink->hl_key;
-	return sizeof(hlink->hl_key);
+	return key >> (HH_IDX_BITS + DAOS_HTYPE_BITS);
 }
 
-static uint32_t
-hh_op_key_hash(struct dhash_table *hhtab, const void *key, unsigned int ksize)
+/** return the slot of @key, NULL if the key can't be a valid handle */
+static struct daos_hhash_slot *
+hh_key2slot(struct daos_hhash *hhtab, uint64_t key)
 {
-	D__ASSERT(ksize == sizeof(uint64_t));
+	struct daos_hhash_slot	*chunk;
+	uint64_t		 idx;
+
+	idx = (key >> DAOS_HTYPE_BITS) & HH_IDX_MASK;
+	chunk = __atomic_load_n(&hhtab->dh_chunks[idx >> HH_CHUNK_BITS],
+				__ATOMIC_ACQUIRE);
+	if (chunk == NULL)
+		return NULL;
 
-	return (unsigned int)(*(const uint64_t *)key >> DAOS_HTYPE_BITS);
+	return &chunk[idx & (HH_CHUNK_SIZE - 1)];
 }
 
-static bool
-hh_op_key_cmp(struct dhash_table *hhtab, daos_list_t *link,
-	  const void *key, unsigned int ksize)
+/** allocate a new chunk and put all its slots to the free list */
+static int
+hh_chunk_alloc(struct daos_hhash *hhtab)
 {
-	struct daos_hlink *hlink = hh_link2ptr(link);
+	struct daos_hhash_slot	*chunk;
+	uint32_t		 base;
+	int			 i;
 
-	D__ASSERT(ksize == sizeof(uint64_t));
-	return hlink->hl_key == *(uint64_t *)key;
-}
+	if (hhtab->dh_chunk_nr == HH_DIR_SIZE) {
+		D__ERROR("Too many handles: %u\n", HH_DIR_SIZE * HH_CHUNK_SIZE);
+		return -DER_NOSPACE;
+	}
 
-static void
-hh_op_rec_addref(struct dhash_table *hhtab, daos_list_t *link)
-{
-	rlink_op_addref(link2rlink(link));
+	D__ALLOC(chunk, sizeof(*chunk) * HH_CHUNK_SIZE);
+	if (chunk == NULL)
+		return -DER_NOMEM;
+
+	base = hhtab->dh_chunk_nr << HH_CHUNK_BITS;
+	for (i = 0; i < HH_CHUNK_SIZE; i++) {
+		chunk[i].hs_gen = 1;
+		chunk[i].hs_next = i == HH_CHUNK_SIZE - 1 ?
+				   hhtab->dh_free : base + i + 1;
+	}
+	hhtab->dh_free = base;
+
+	/* lookup may see the chunk as soon as it is stored */
+	__atomic_store_n(&hhtab->dh_chunks[hhtab->dh_chunk_nr], chunk,
+			 __ATOMIC_RELEASE);
+	hhtab->dh_chunk_nr++;
+	return 0;
 }
 
-static bool
-hh_op_rec_decref(struct dhash_table *hhtab, daos_list_t *link)
+static void
+hh_link_addref(struct daos_hlink *hlink)
 {
-	return rlink_op_decref(link2rlink(link));
+	__atomic_add_fetch(&hlink->hl_link.rl_ref, 1, __ATOMIC_RELAXED);
 }
 
 static void
-hh_op_rec_free(struct dhash_table *hhtab, daos_list_t *link)
+hh_link_decref(struct daos_hlink *hlink)
 {
-	struct daos_hlink *hlink = hh_link2ptr(link);
+	unsigned int	ref;
 
+	ref = __atomic_sub_fetch(&hlink->hl_link.rl_ref, 1, __ATOMIC_ACQ_REL);
+	D__ASSERT(ref != (unsigned int)-1);
+	if (ref != 0)
+		return;
+
+	D__ASSERT(dhash_rec_unlinked(&hlink->hl_link.rl_link));
 	if (hlink->hl_ops != NULL &&
 	    hlink->hl_ops->hop_free != NULL)
 		hlink->hl_ops->hop_free(hlink);
 }
 
-static dhash_table_ops_t hh_ops = {
-	.hop_key_init		= hh_op_key_init,
-	.hop_key_get		= hh_op_key_get,
-	.hop_key_hash		= hh_op_key_hash,
-	.hop_key_cmp		= hh_op_key_cmp,
-	.hop_rec_addref		= hh_op_rec_addref,
-	.hop_rec_decref		= hh_op_rec_decref,
-	.hop_rec_free		= hh_op_rec_free,
-};
-
+/**
+ * Create a handle table, \a bits is only a hint of the number of handles,
+ * slots are allocated on demand.
+ */
 int
 daos_hhash_create(unsigned int bits, struct daos_hhash **htable_pp)
 {
 	struct daos_hhash *hhtab;
 	int		   rc;
 
+	D_CASSERT(HH_GEN_BITS + HH_PIN_BITS <= 64);
+
 	D__ALLOC_PTR(hhtab);
 	if (hhtab == NULL)
 		return -DER_NOMEM;
 
-	rc = dhash_table_create_inplace(0, bits, NULL, &hh_ops,
-					&hhtab->dh_htable);
-	if (rc != 0)
-		goto failed;
+	rc = pthread_mutex_init(&hhtab->dh_lock, NULL);
+	if (rc != 0) {
+		D__FREE_PTR(hhtab);
+		return daos_errno2der(rc);
+	}
+
+	DAOS_INIT_LIST_HEAD(&hhtab->dh_links);
+	hhtab->dh_free = HH_SLOT_NONE;
+	rc = hh_chunk_alloc(hhtab);
+	if (rc != 0) {
+		pthread_mutex_destroy(&hhtab->dh_lock);
+		D__FREE_PTR(hhtab);
+		return rc;
+	}
 
-	hhtab->dh_cookie = 1;
 	*htable_pp = hhtab;
 	return 0;
- failed:
-	D__FREE_PTR(hhtab);
-	return -DER_NOMEM;
 }
 
 void
 daos_hhash_destroy(struct daos_hhash *hhtab)
 {
-	dhash_table_debug(&hhtab->dh_htable);
-	dhash_table_destroy_inplace(&hhtab->dh_htable, true);
+	struct daos_hlink	*hlink;
+	int			 i;
+
+	while (!daos_list_empty(&hhtab->dh_links)) {
+		hlink = container_of(hhtab->dh_links.next, struct daos_hlink,
+				     hl_link.rl_link);
+		daos_hhash_link_delete(hhtab, hlink);
+	}
+
+	for (i = 0; i < hhtab->dh_chunk_nr; i++)
+		D__FREE(hhtab->dh_chunks[i],
+			sizeof(struct daos_hhash_slot) * HH_CHUNK_SIZE);
+
+	pthread_mutex_destroy(&hhtab->dh_lock);
 	D__FREE_PTR(hhtab);
 }
 
@@ -950,46 +1194,126 @@ daos_uhash_link_empty(struct daos_ulink *ulink)
 	return rlink_op_empty(&ulink->ul_link);
 }
 
+/**
+ * Insert \a hlink and generate its key, the table holds a refcount on it.
+ * If the table can't grow, \a hlink is left unlinked and its key is zero,
+ * which is never found by lookup.
+ */
 void
 daos_hhash_link_insert(struct daos_hhash *hhtab, struct daos_hlink *hlink,
 		       int type)
 {
+	struct daos_hhash_slot	*slot;
+	uint32_t		 idx;
+	uint64_t		 gen;
+
 	D__ASSERT(hlink->hl_link.rl_initialized);
-	dhash_rec_insert_anonym(&hhtab->dh_htable, &hlink->hl_link.rl_link,
-				(void *)&type);
-}
+	D__ASSERT(type >= 0 && type <= DAOS_HTYPE_MASK);
 
-static inline struct daos_hlink*
-daos_hlink_find(struct dhash_table *htable, void *key, size_t size)
-{
-	daos_list_t		*link;
+	pthread_mutex_lock(&hhtab->dh_lock);
+	if (hhtab->dh_free == HH_SLOT_NONE && hh_chunk_alloc(hhtab) != 0) {
+		hlink->hl_key = 0;
+		goto out;
+	}
 
-	link = dhash_rec_find(htable, key, size);
-	return link == NULL ? NULL : hh_link2ptr(link);
+	idx = hhtab->dh_free;
+	slot = hh_key2slot(hhtab, (uint64_t)idx << DAOS_HTYPE_BITS);
+	hhtab->dh_free = slot->hs_next;
+
+	gen = slot->hs_gen;
+	hlink->hl_key = (((gen << HH_IDX_BITS) | idx) << DAOS_HTYPE_BITS) |
+			type;
+	hh_link_addref(hlink);
+	daos_list_add_tail(&hlink->hl_link.rl_link, &hhtab->dh_links);
+
+	slot->hs_link = hlink;
+	/* no lookup can pin a free slot, so there is no pin to keep */
+	__atomic_store_n(&slot->hs_state, gen << HH_PIN_BITS,
+			 __ATOMIC_RELEASE);
+out:
+	pthread_mutex_unlock(&hhtab->dh_lock);
 }
 
 struct daos_hlink *
 daos_hhash_link_lookup(struct daos_hhash *hhtab, uint64_t key)
 {
-	return daos_hlink_find(&hhtab->dh_htable, (void *)&key, sizeof(key));
+	struct daos_hhash_slot	*slot;
+	struct daos_hlink	*hlink;
+	uint64_t		 gen = hh_key_gen(key);
+	uint64_t		 state;
+
+	if (gen == 0)
+		return NULL;
+
+	slot = hh_key2slot(hhtab, key);
+	if (slot == NULL)
+		return NULL;
+
+	state = __atomic_load_n(&slot->hs_state, __ATOMIC_ACQUIRE);
+	do {
+		if ((state >> HH_PIN_BITS) != gen)
+			return NULL;
+	} while (!__atomic_compare_exchange_n(&slot->hs_state, &state,
+					      state + 1, true,
+					      __ATOMIC_ACQUIRE,
+					      __ATOMIC_ACQUIRE));
+
+	/* pinned, the record can't be released by delete */
+	hlink = slot->hs_link;
+	if (hlink->hl_key == key)
+		hh_link_addref(hlink);
+	else /* type mismatch */
+		hlink = NULL;
+
+	__atomic_sub_fetch(&slot->hs_state, 1, __ATOMIC_RELEASE);
+	return hlink;
 }
 
 bool
 daos_hhash_link_delete(struct daos_hhash *hhtab, struct daos_hlink *hlink)
 {
-	return dhash_rec_delete_at(&hhtab->dh_htable, &hlink->hl_link.rl_link);
+	struct daos_hhash_slot	*slot;
+	uint32_t		 idx;
+
+	pthread_mutex_lock(&hhtab->dh_lock);
+	if (dhash_rec_unlinked(&hlink->hl_link.rl_link)) {
+		pthread_mutex_unlock(&hhtab->dh_lock);
+		return false;
+	}
+	daos_list_del_init(&hlink->hl_link.rl_link);
+
+	idx = (hlink->hl_key >> DAOS_HTYPE_BITS) & HH_IDX_MASK;
+	slot = hh_key2slot(hhtab, hlink->hl_key);
+	D__ASSERT(slot != NULL && slot->hs_link == hlink);
+
+	/* no new pin after clearing the generation, wait for the old ones */
+	__atomic_and_fetch(&slot->hs_state, HH_PIN_MASK, __ATOMIC_ACQ_REL);
+	while (__atomic_load_n(&slot->hs_state, __ATOMIC_ACQUIRE) != 0)
+		sched_yield();
+
+	slot->hs_link = NULL;
+	slot->hs_gen = (slot->hs_gen + 1) & HH_GEN_MASK;
+	if (slot->hs_gen == 0)
+		slot->hs_gen = 1;
+	slot->hs_next = hhtab->dh_free;
+	hhtab->dh_free = idx;
+	pthread_mutex_unlock(&hhtab->dh_lock);
+
+	/* release the refcount of the table */
+	hh_link_decref(hlink);
+	return true;
 }
 
 void
 daos_hhash_link_getref(struct daos_hhash *hhtab, struct daos_hlink *hlink)
 {
-	dhash_rec_addref(&hhtab->dh_htable, &hlink->hl_link.rl_link);
+	hh_link_addref(hlink);
 }
 
 void
 daos_hhash_link_putref(struct daos_hhash *hhtab, struct daos_hlink *hlink)
 {
-	dhash_rec_decref(&hhtab->dh_htable, &hlink->hl_link.rl_link);
+	hh_link_decref(hlink);
 }
 
 bool
@@ -1050,6 +1374,15 @@ uh_op_key_cmp(struct dhash_table *uhtab, daos_list_t *link, const void *key,
 	return !uuid_compare(ulink->ul_uuid.uuid, lkey->uuid);
 }
 
+static int
+uh_op_key_get(struct dhash_table *uhtab, daos_list_t *link, void **key_pp)
+{
+	struct daos_ulink *ulink = uh_link2ptr(link);
+
+	*key_pp = (void *)&ulink->ul_uuid;
+	return sizeof(ulink->ul_uuid);
+}
+
 static void
 uh_op_rec_free(struct dhash_table *hhtab, daos_list_t *link)
 {
@@ -1063,6 +1396,7 @@ uh_op_rec_free(struct dhash_table *hhtab, daos_list_t *link)
 
 
 static dhash_table_ops_t uh_ops = {
+	.hop_key_get	= uh_op_key_get,
 	.hop_key_hash	= uh_op_key_hash,
 	.hop_key_cmp	= uh_op_key_cmp,
 	.hop_rec_addref	= hh_op_rec_addref, /* Reuse hh_op_add/decref */
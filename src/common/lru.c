@@ -124,6 +124,7 @@ daos_lru_cache_create(int bits, uint32_t feats,
 	lru_cache->dlc_ops = ops;
 
 	DAOS_INIT_LIST_HEAD(&lru_cache->dlc_idle_list);
+	DAOS_INIT_LIST_HEAD(&lru_cache->dlc_hot_list);
 	DAOS_INIT_LIST_HEAD(&lru_cache->dlc_busy_list);
 
 	*lcache = lru_cache;
@@ -151,12 +152,42 @@ daos_lru_cache_destroy(struct daos_lru_cache *lcache)
 	D__FREE_PTR(lcache);
 }
 
+/** remove an idle item from the cache, it is freed by the hash callback */
+static void
+lru_idle_delete(struct daos_lru_cache *lcache, struct daos_llink *llink)
+{
+	D__ASSERT(lcache->dlc_idle_nr > 0);
+	lcache->dlc_idle_nr--;
+	if (llink->ll_hot) {
+		D__ASSERT(lcache->dlc_hot_nr > 0);
+		lcache->dlc_hot_nr--;
+	}
+	daos_list_del_init(&llink->ll_qlink);
+	dhash_rec_delete_at(&lcache->dlc_htable, &llink->ll_hlink);
+}
+
+static unsigned int
+lru_idle_evict(struct daos_lru_cache *lcache, daos_list_t *head,
+	       daos_lru_cond_cb_t cond, void *args)
+{
+	struct daos_llink *llink;
+	struct daos_llink *tmp;
+	unsigned int	   cntr = 0;
+
+	daos_list_for_each_entry_safe(llink, tmp, head, ll_qlink) {
+		if (cond == NULL || cond(llink, args)) {
+			lru_idle_delete(lcache, llink);
+			cntr++;
+		}
+	}
+	return cntr;
+}
+
 void
 daos_lru_cache_evict(struct daos_lru_cache *lcache,
 		     daos_lru_cond_cb_t cond, void *args)
 {
 	struct daos_llink *llink;
-	struct daos_llink *tmp;
 	unsigned int	   cntr;
 
 	cntr = 0;
@@ -167,20 +198,60 @@ daos_lru_cache_evict(struct daos_lru_cache *lcache,
 	}
 	D__DEBUG(DB_TRACE, "Marked %d busy items as evicted\n", cntr);
 
-	cntr = 0;
-	daos_list_for_each_entry_safe(llink, tmp, &lcache->dlc_idle_list,
-				      ll_qlink) {
-		if (cond == NULL || cond(llink, args)) {
-			daos_list_del_init(&llink->ll_qlink);
-			dhash_rec_delete_at(&lcache->dlc_htable,
-					    &llink->ll_hlink);
-			lcache->dlc_idle_nr--;
-			cntr++;
-		}
-	}
+	cntr = lru_idle_evict(lcache, &lcache->dlc_idle_list, cond, args);
+	cntr += lru_idle_evict(lcache, &lcache->dlc_hot_list, cond, args);
 	D__DEBUG(DB_TRACE, "Evicted %d items from idle list\n", cntr);
 }
 
+/**
+ * Demote hot items beyond DAOS_LRU_HOT_PCT to the cold list, then evict idle
+ * items until the cache fits in its size, cold items go first.
+ */
+static void
+lru_cache_trim(struct daos_lru_cache *lcache)
+{
+	struct daos_llink *llink;
+	daos_list_t	  *head;
+
+	while (lcache->dlc_hot_nr >
+	       (uint64_t)lcache->dlc_csize * DAOS_LRU_HOT_PCT / 100) {
+		llink = container_of(lcache->dlc_hot_list.prev,
+				     struct daos_llink, ll_qlink);
+		D__DEBUG(DB_TRACE, "Demote %p to the cold list\n", llink);
+
+		llink->ll_hot = 0;
+		lcache->dlc_hot_nr--;
+		daos_list_move(&llink->ll_qlink, &lcache->dlc_idle_list);
+	}
+
+	while (lcache->dlc_idle_nr != 0 &&
+	       (lcache->dlc_busy_nr + lcache->dlc_idle_nr >=
+		lcache->dlc_csize)) {
+		D__DEBUG(DB_TRACE, "Evicting from object cache :%d, %d\n",
+			lcache->dlc_idle_nr, lcache->dlc_busy_nr);
+
+		head = &lcache->dlc_idle_list;
+		if (daos_list_empty(head))
+			head = &lcache->dlc_hot_list;
+
+		/** evict from the tail of the list */
+		D__ASSERT(!daos_list_empty(head));
+		llink = container_of(head->prev, struct daos_llink, ll_qlink);
+		lru_idle_delete(lcache, llink);
+		lcache->dlc_stats.ls_evictions++;
+	}
+}
+
+void
+daos_lru_cache_resize(struct daos_lru_cache *lcache, uint32_t size)
+{
+	D__DEBUG(DB_TRACE, "Resize LRU cache from %u to %u\n",
+		lcache->dlc_csize, size);
+
+	lcache->dlc_csize = size;
+	lru_cache_trim(lcache);
+}
+
 static struct daos_llink *
 lru_fast_search(struct daos_lru_cache *lcache, daos_list_t *head,
 		void *key, unsigned int key_size)
@@ -196,7 +267,8 @@ lru_fast_search(struct daos_lru_cache *lcache, daos_list_t *head,
 
 	if (llink->ll_ops->lop_cmp_keys(key, key_size, llink)) {
 		D__DEBUG(DB_TRACE, "Found item on the %s list.\n",
-			head == &lcache->dlc_busy_list ? "busy" : "idle");
+			head == &lcache->dlc_busy_list ? "busy" :
+			head == &lcache->dlc_hot_list ? "hot" : "idle");
 
 		llink->ll_ref++; /* +1 for caller */
 		return llink;
@@ -232,17 +304,19 @@ lru_mark_busy(struct daos_lru_cache *lcache, struct daos_llink *llink)
 		daos_list_add(&llink->ll_qlink, &lcache->dlc_busy_list);
 	} else {
 		lcache->dlc_idle_nr--;
+		if (llink->ll_hot)
+			lcache->dlc_hot_nr--;
 		daos_list_move(&llink->ll_qlink, &lcache->dlc_busy_list);
 	}
 	lcache->dlc_busy_nr++;
 }
 
-int
-daos_lru_ref_hold(struct daos_lru_cache *lcache, void *key,
-		  unsigned int key_size, void *create_args,
-		  struct daos_llink **rlink)
+static int
+lru_ref_hold(struct daos_lru_cache *lcache, void *key, unsigned int key_size,
+	     void *create_args, bool promote, struct daos_llink **rlink)
 {
 	struct daos_llink *llink;
+	bool		   hit = true;
 	int		   rc;
 
 	D__ASSERT(lcache != NULL && key != NULL && key_size > 0);
@@ -253,6 +327,10 @@ daos_lru_ref_hold(struct daos_lru_cache *lcache, void *key,
 	if (llink)
 		D__GOTO(found, rc = 0);
 
+	llink = lru_fast_search(lcache, &lcache->dlc_hot_list, key, key_size);
+	if (llink)
+		D__GOTO(found, rc = 0);
+
 	llink = lru_fast_search(lcache, &lcache->dlc_idle_list, key, key_size);
 	if (llink)
 		D__GOTO(found, rc = 0);
@@ -261,6 +339,7 @@ daos_lru_ref_hold(struct daos_lru_cache *lcache, void *key,
 	if (llink)
 		D__GOTO(found, rc = 0);
 
+	lcache->dlc_stats.ls_misses++;
 	if (!create_args)
 		D__GOTO(out, rc = -DER_NONEXIST);
 
@@ -272,6 +351,7 @@ daos_lru_ref_hold(struct daos_lru_cache *lcache, void *key,
 
 	D__DEBUG(DB_TRACE, "Inserting into LRU Hash table\n");
 	llink->ll_evicted = 0;
+	llink->ll_hot	  = 0;
 	llink->ll_ref	  = 1; /* 1 for caller */
 	llink->ll_ops	  = lcache->dlc_ops;
 	DAOS_INIT_LIST_HEAD(&llink->ll_qlink);
@@ -279,15 +359,42 @@ daos_lru_ref_hold(struct daos_lru_cache *lcache, void *key,
 	rc = dhash_rec_insert(&lcache->dlc_htable, key, key_size,
 			      &llink->ll_hlink, true);
 	D__ASSERT(rc == 0);
+	hit = false;
 found:
 	if (llink->ll_ref == 2) /* 1 for hash, 1 for the first holder */
 		lru_mark_busy(lcache, llink);
 
+	if (hit) {
+		lcache->dlc_stats.ls_hits++;
+		/* referenced again, it will be put on the hot list by
+		 * daos_lru_ref_release.
+		 */
+		if (promote && !llink->ll_hot) {
+			llink->ll_hot = 1;
+			lcache->dlc_stats.ls_promotions++;
+		}
+	}
 	*rlink = llink;
 out:
 	return rc;
 }
 
+int
+daos_lru_ref_hold(struct daos_lru_cache *lcache, void *key,
+		  unsigned int key_size, void *create_args,
+		  struct daos_llink **rlink)
+{
+	return lru_ref_hold(lcache, key, key_size, create_args, true, rlink);
+}
+
+int
+daos_lru_ref_hold_cold(struct daos_lru_cache *lcache, void *key,
+		       unsigned int key_size, void *create_args,
+		       struct daos_llink **rlink)
+{
+	return lru_ref_hold(lcache, key, key_size, create_args, false, rlink);
+}
+
 void
 daos_lru_ref_release(struct daos_lru_cache *lcache, struct daos_llink *llink)
 {
@@ -309,28 +416,20 @@ daos_lru_ref_release(struct daos_lru_cache *lcache, struct daos_llink *llink)
 			dhash_rec_delete_at(&lcache->dlc_htable,
 					    &llink->ll_hlink);
 		} else {
-			D__DEBUG(DB_TRACE,
-				"Moving %p to the idle list\n", llink);
+			D__DEBUG(DB_TRACE, "Moving %p to the %s list\n",
+				llink, llink->ll_hot ? "hot" : "idle");
 			lcache->dlc_idle_nr++;
-			daos_list_move(&llink->ll_qlink,
-				       &lcache->dlc_idle_list);
+			if (llink->ll_hot) {
+				lcache->dlc_hot_nr++;
+				daos_list_move(&llink->ll_qlink,
+					       &lcache->dlc_hot_list);
+			} else {
+				daos_list_move(&llink->ll_qlink,
+					       &lcache->dlc_idle_list);
+			}
 		}
 	}
 
-	while (lcache->dlc_idle_nr != 0 &&
-	       (lcache->dlc_busy_nr + lcache->dlc_idle_nr >=
-		lcache->dlc_csize)) {
-		D__DEBUG(DB_TRACE, "Evicting from object cache :%d, %d\n",
-			lcache->dlc_idle_nr, lcache->dlc_busy_nr);
-
-		/** evict from the tail of the list */
-		D__ASSERT(!daos_list_empty(&lcache->dlc_idle_list));
-		llink = container_of(lcache->dlc_idle_list.prev,
-				     struct daos_llink, ll_qlink);
-
-		daos_list_del_init(&llink->ll_qlink);
-		dhash_rec_delete_at(&lcache->dlc_htable, &llink->ll_hlink);
-		lcache->dlc_idle_nr--;
-	}
+	lru_cache_trim(lcache);
 	D__DEBUG(DB_TRACE, "Done releasing reference\n");
 }
@@ -30,6 +30,7 @@
 #define DDSUBSYS	DDFAC(common)
 
 #include <daos/common.h>
+#include <daos/list.h>
 #include <daos/mem.h>
 
 #if DAOS_HAS_PMDK
@@ -182,6 +183,344 @@ static umem_ops_t	vmem_ops = {
 	.mo_tx_abort	= NULL,
 };
 
+/*
+ * Volatile memory allocated from per-thread slabs.
+ *
+ * Each thread (service xstream) owns a set of slabs for different size
+ * classes, a slab allocates objects from chunks of memory it takes from
+ * system. Allocation and free by the owner thread need no lock. An object
+ * freed by a different thread is pushed to the remote free list of its
+ * chunk by atomic operations, the owner moves it back to the chunk on its
+ * next allocation or free. A chunk is returned to system as soon as all
+ * its objects are freed, unless it is the chunk the slab is allocating from.
+ *
+ * Slabs of an exited thread are never released, objects of such a slab
+ * can still be freed by other threads, but the memory is not reused.
+ */
+
+/** size of memory chunk allocated from system for a slab */
+#define VSLAB_CHUNK_SIZE	(64 << 10)
+/** slab class for objects larger than all size classes */
+#define VSLAB_CLASS_LARGE	(UMEM_SLAB_CLASS_MAX - 1)
+#define VSLAB_MAGIC		0x51ab51ab
+
+/** object sizes of slab classes */
+static const size_t vslab_sizes[VSLAB_CLASS_LARGE] = {
+	16, 32, 48, 64, 96, 128, 192, 256,
+	384, 512, 768, 1024, 1536, 2048, 3072, 4096,
+};
+
+struct vslab_chunk;
+
+/** header of each object, it is 16 bytes to keep alignment of malloc */
+struct vslab_hdr {
+	uint32_t			 sh_class;
+	uint32_t			 sh_magic;
+	union {
+		/** chunk of an allocated object of a size class */
+		struct vslab_chunk	*sh_chunk;
+		/** slab which allocated a large object */
+		struct vslab		*sh_slab;
+		/** link in a free list of the chunk */
+		struct vslab_hdr	*sh_next;
+	};
+};
+
+/** header of a chunk, objects are carved from the space after it */
+struct vslab_chunk {
+	/** link in vs_partial of the owner slab */
+	daos_list_t		 ck_link;
+	/** the slab owns this chunk */
+	struct vslab		*ck_slab;
+	/** free objects, only accessed by the owner */
+	struct vslab_hdr	*ck_free;
+	/** objects freed by other threads */
+	struct vslab_hdr	*ck_remote;
+	/** next chunk in vs_remote of the owner slab */
+	struct vslab_chunk	*ck_remote_next;
+	/** unused space */
+	char			*ck_cur;
+	char			*ck_end;
+	/** number of objects which have not been returned to ck_free */
+	unsigned int		 ck_used;
+} __attribute__((aligned(16)));
+
+struct vslab {
+	/** the chunk to allocate from */
+	struct vslab_chunk	*vs_curr;
+	/** other chunks which have free objects */
+	daos_list_t		 vs_partial;
+	/** chunks which have objects freed by other threads */
+	struct vslab_chunk	*vs_remote;
+	struct umem_slab_stat	 vs_stat;
+};
+
+static __thread struct vslab *vslabs;
+
+static inline int
+vslab_size2class(size_t size)
+{
+	int	i;
+
+	for (i = 0; i < VSLAB_CLASS_LARGE; i++) {
+		if (size <= vslab_sizes[i])
+			break;
+	}
+	return i;
+}
+
+/** Return slabs of the calling thread, allocate them on first use */
+static struct vslab *
+vslab_thread_slabs(void)
+{
+	int	i;
+
+	if (vslabs != NULL)
+		return vslabs;
+
+	/* never freed, other threads may free objects to these slabs */
+	vslabs = calloc(UMEM_SLAB_CLASS_MAX, sizeof(*vslabs));
+	if (vslabs == NULL)
+		return NULL;
+
+	for (i = 0; i < UMEM_SLAB_CLASS_MAX; i++)
+		DAOS_INIT_LIST_HEAD(&vslabs[i].vs_partial);
+	return vslabs;
+}
+
+static inline bool
+vslab_chunk_avail(struct vslab_chunk *ck, size_t size)
+{
+	return ck != NULL &&
+	       (ck->ck_free != NULL || ck->ck_cur + size <= ck->ck_end);
+}
+
+/** Return an object to its chunk, called by the owner of the chunk */
+static void
+vslab_chunk_put(struct vslab *slab, struct vslab_chunk *ck,
+		struct vslab_hdr *hdr, size_t size)
+{
+	if (ck->ck_free == NULL && ck != slab->vs_curr)
+		daos_list_add_tail(&ck->ck_link, &slab->vs_partial);
+
+	hdr->sh_next = ck->ck_free;
+	ck->ck_free = hdr;
+	ck->ck_used--;
+	slab->vs_stat.ss_free++;
+	slab->vs_stat.ss_cached++;
+	if (ck->ck_used != 0 || ck == slab->vs_curr)
+		return;
+
+	/* all objects of the chunk are free, return it to system */
+	daos_list_del(&ck->ck_link);
+	slab->vs_stat.ss_cached -= (ck->ck_cur - (char *)&ck[1]) / size;
+	slab->vs_stat.ss_mem -= VSLAB_CHUNK_SIZE;
+	free(ck);
+}
+
+/** Move objects freed by other threads back to their chunks */
+static void
+vslab_drain(struct vslab *slab, size_t size)
+{
+	struct vslab_chunk *ck;
+	struct vslab_chunk *next;
+	struct vslab_hdr   *hdr;
+	struct vslab_hdr   *tmp;
+
+	/* cheap check to avoid the atomic exchange in the common case */
+	if (__atomic_load_n(&slab->vs_remote, __ATOMIC_RELAXED) == NULL)
+		return;
+
+	ck = __atomic_exchange_n(&slab->vs_remote, NULL, __ATOMIC_ACQUIRE);
+	for (; ck != NULL; ck = next) {
+		/* ck can be pushed again once its remote list is taken */
+		next = ck->ck_remote_next;
+		hdr = __atomic_exchange_n(&ck->ck_remote, NULL,
+					  __ATOMIC_ACQUIRE);
+		for (; hdr != NULL; hdr = tmp) {
+			tmp = hdr->sh_next;
+			vslab_chunk_put(slab, ck, hdr, size);
+		}
+	}
+}
+
+/** Free an object of a chunk owned by another thread */
+static void
+vslab_remote_put(struct vslab_chunk *ck, struct vslab_hdr *hdr)
+{
+	struct vslab		*slab = ck->ck_slab;
+	struct vslab_hdr	*old;
+	struct vslab_chunk	*head;
+
+	old = __atomic_load_n(&ck->ck_remote, __ATOMIC_RELAXED);
+	do {
+		hdr->sh_next = old;
+	} while (!__atomic_compare_exchange_n(&ck->ck_remote, &old, hdr,
+					      true, __ATOMIC_RELEASE,
+					      __ATOMIC_RELAXED));
+	if (old != NULL)
+		return; /* the chunk is already in vs_remote */
+
+	/* ck_used is still non-zero, so the owner cannot release ck yet */
+	head = __atomic_load_n(&slab->vs_remote, __ATOMIC_RELAXED);
+	do {
+		ck->ck_remote_next = head;
+	} while (!__atomic_compare_exchange_n(&slab->vs_remote, &head, ck,
+					      true, __ATOMIC_RELEASE,
+					      __ATOMIC_RELAXED));
+}
+
+static struct vslab_hdr *
+vslab_get(struct vslab *slab, int cls)
+{
+	struct vslab_chunk *ck;
+	struct vslab_hdr   *hdr;
+	size_t		    size;
+
+	size = sizeof(*hdr) + vslab_sizes[cls];
+	vslab_drain(slab, size);
+
+	ck = slab->vs_curr;
+	if (!vslab_chunk_avail(ck, size)) {
+		/* the current chunk is fully allocated, switch to another */
+		if (!daos_list_empty(&slab->vs_partial)) {
+			ck = daos_list_entry(slab->vs_partial.next,
+					     struct vslab_chunk, ck_link);
+			daos_list_del_init(&ck->ck_link);
+		} else {
+			ck = malloc(VSLAB_CHUNK_SIZE);
+			if (ck == NULL)
+				return NULL;
+
+			memset(ck, 0, sizeof(*ck));
+			DAOS_INIT_LIST_HEAD(&ck->ck_link);
+			ck->ck_slab = slab;
+			ck->ck_cur = (char *)&ck[1];
+			ck->ck_end = (char *)ck + VSLAB_CHUNK_SIZE;
+			slab->vs_stat.ss_mem += VSLAB_CHUNK_SIZE;
+		}
+		slab->vs_curr = ck;
+	}
+	hdr = ck->ck_free;
+	if (hdr != NULL) {
+		ck->ck_free = hdr->sh_next;
+		slab->vs_stat.ss_cached--;
+	} else {
+		hdr = (struct vslab_hdr *)ck->ck_cur;
+		ck->ck_cur += size;
+	}
+	ck->ck_used++;
+	hdr->sh_chunk = ck;
+	return hdr;
+}
+
+static umem_id_t
+vslab_alloc(struct umem_instance *umm, size_t size, uint64_t flags,
+	    unsigned int type_num)
+{
+	struct vslab_hdr *hdr;
+	struct vslab	 *slab;
+	umem_id_t	  ummid = UMMID_NULL;
+	int		  cls;
+
+	slab = vslab_thread_slabs();
+	if (slab == NULL)
+		return ummid;
+
+	cls = vslab_size2class(size);
+	slab = &slab[cls];
+	if (cls == VSLAB_CLASS_LARGE) {
+		hdr = malloc(sizeof(*hdr) + size);
+		if (hdr != NULL)
+			hdr->sh_slab = slab;
+	} else {
+		hdr = vslab_get(slab, cls);
+	}
+
+	if (hdr == NULL)
+		return ummid;
+
+	hdr->sh_class = cls;
+	hdr->sh_magic = VSLAB_MAGIC;
+	slab->vs_stat.ss_alloc++;
+
+	if (flags & POBJ_FLAG_ZERO)
+		memset(&hdr[1], 0, size);
+
+	ummid.off = (uint64_t)&hdr[1];
+	return ummid;
+}
+
+static void
+vslab_free(struct umem_instance *umm, umem_id_t ummid)
+{
+	struct vslab_hdr   *hdr;
+	struct vslab_chunk *ck;
+	struct vslab	   *slab = NULL;
+	size_t		    size;
+
+	if (ummid.off == 0)
+		return;
+
+	hdr = (struct vslab_hdr *)ummid.off - 1;
+	D__ASSERTF(hdr->sh_magic == VSLAB_MAGIC && hdr->sh_class <
+		   UMEM_SLAB_CLASS_MAX, "Invalid slab object %p\n", hdr);
+
+	if (hdr->sh_class == VSLAB_CLASS_LARGE) {
+		/* count it by the allocating thread, it may be remote */
+		__atomic_add_fetch(&hdr->sh_slab->vs_stat.ss_free, 1,
+				   __ATOMIC_RELAXED);
+		free(hdr);
+		return;
+	}
+
+	if (vslabs != NULL)
+		slab = &vslabs[hdr->sh_class];
+
+	ck = hdr->sh_chunk;
+
+	if (ck->ck_slab != slab) {
+		vslab_remote_put(ck, hdr);
+		return;
+	}
+
+	size = sizeof(*hdr) + vslab_sizes[hdr->sh_class];
+	vslab_chunk_put(slab, ck, hdr, size);
+	vslab_drain(slab, size);
+}
+
+static umem_ops_t	vslab_ops = {
+	.mo_addr	= vmem_addr,
+	.mo_equal	= vmem_equal,
+	.mo_tx_free	= vslab_free,
+	.mo_tx_alloc	= vslab_alloc,
+	.mo_tx_add	= NULL,
+	.mo_tx_abort	= NULL,
+};
+
+/**
+ * Query usage counters of UMEM_CLASS_VMEM_SLAB for the calling thread.
+ *
+ * \param stats [OUT]	Array to return counters of size classes.
+ * \param nr [IN]	Size of \a stats, it should be UMEM_SLAB_CLASS_MAX.
+ *
+ * \return		Number of returned size classes.
+ */
+int
+umem_slab_query(struct umem_slab_stat *stats, int nr)
+{
+	int	i;
+
+	for (i = 0; i < nr && i < UMEM_SLAB_CLASS_MAX; i++) {
+		if (vslabs != NULL)
+			stats[i] = vslabs[i].vs_stat;
+		else
+			memset(&stats[i], 0, sizeof(stats[i]));
+		stats[i].ss_size = i == VSLAB_CLASS_LARGE ? 0 : vslab_sizes[i];
+	}
+	return i;
+}
+
 /** Unified memory class definition */
 struct umem_class {
 	umem_class_id_t           umc_id;
@@ -196,6 +535,11 @@ static struct umem_class umem_class_defined[] = {
 		.umc_ops	= &vmem_ops,
 		.umc_name	= "vmem",
 	},
+	{
+		.umc_id		= UMEM_CLASS_VMEM_SLAB,
+		.umc_ops	= &vslab_ops,
+		.umc_name	= "vmem_slab",
+	},
 #if DAOS_HAS_PMDK
 	{
 		.umc_id		= UMEM_CLASS_PMEM,
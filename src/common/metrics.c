@@ -0,0 +1,187 @@
+/**
+ * (C) Copyright 2017 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * GOVERNMENT LICENSE RIGHTS-OPEN SOURCE SOFTWARE
+ * The Government's rights to use, modify, reproduce, release, perform, display,
+ * or disclose this software are subject to the terms of the Apache License as
+ * provided in Contract No. B609815.
+ * Any reproduction of computer software, computer software documentation, or
+ * portions thereof marked with this legend must also reproduce the markings.
+ */
+/**
+ * Per-thread metrics, see daos/metrics.h
+ */
+#define DDSUBSYS	DDFAC(common)
+
+#include <pthread.h>
+#include <daos/metrics.h>
+
+__thread struct daos_metrics	*daos_metrics_tls;
+
+/** all threads with metrics */
+static DAOS_LIST_HEAD(metrics_list);
+static pthread_mutex_t		 metrics_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static const char *metric_cnt_names[] = {
+	[DMC_OBJ_UPDATE]	= "obj_update",
+	[DMC_OBJ_FETCH]		= "obj_fetch",
+	[DMC_BULK_BYTES]	= "bulk_bytes",
+	[DMC_VOS_OBJ_HIT]	= "vos_obj_cache_hit",
+	[DMC_VOS_OBJ_MISS]	= "vos_obj_cache_miss",
+	[DMC_VOS_OBJ_EVICT]	= "vos_obj_cache_evict",
+	[DMC_RDB_APPEND]	= "rdb_append",
+	[DMC_AGG_OBJ]		= "aggregate_obj",
+	[DMC_REBUILD_REC]	= "rebuild_rec",
+	[DMC_POOL_FORMAT_BYTES]	= "pool_format_bytes",
+	[DMC_VOS_COALESCE]	= "vos_coalesce_ext",
+};
+
+static const char *metric_gauge_names[] = {
+	[DMG_OBJ_INFLIGHT]	= "obj_inflight",
+	[DMG_REBUILD_INFLIGHT]	= "rebuild_inflight",
+	[DMG_POOL_FORMAT]	= "pool_format_inflight",
+	[DMG_POOL_DESTROY]	= "pool_destroy_inflight",
+};
+
+static const char *metric_hist_names[] = {
+	[DMH_OBJ_UPDATE]	= "obj_update_ns",
+	[DMH_OBJ_FETCH]		= "obj_fetch_ns",
+	[DMH_BULK]		= "bulk_ns",
+	[DMH_VOS_UPDATE]	= "vos_update_ns",
+	[DMH_VOS_FETCH]		= "vos_fetch_ns",
+	[DMH_BTR_PROBE_DEPTH]	= "btr_probe_depth",
+	[DMH_RDB_APPEND]	= "rdb_append_ns",
+	[DMH_AGG]		= "aggregate_ns",
+	[DMH_REBUILD_DKEY]	= "rebuild_dkey_ns",
+	[DMH_OBJ_GROUP_COMMIT]	= "obj_group_commit",
+	[DMH_OBJ_GROUP_WAIT]	= "obj_group_wait_ns",
+	[DMH_VOS_COALESCE]	= "vos_coalesce_ns",
+};
+
+const char *
+daos_metric_cnt_name(enum daos_metric_cnt id)
+{
+	return id < DMC_NR ? metric_cnt_names[id] : "unknown";
+}
+
+const char *
+daos_metric_gauge_name(enum daos_metric_gauge id)
+{
+	return id < DMG_NR ? metric_gauge_names[id] : "unknown";
+}
+
+const char *
+daos_metric_hist_name(enum daos_metric_hist id)
+{
+	return id < DMH_NR ? metric_hist_names[id] : "unknown";
+}
+
+void
+daos_metrics_init(struct daos_metrics *dm)
+{
+	D_CASSERT(ARRAY_SIZE(metric_cnt_names) == DMC_NR);
+	D_CASSERT(ARRAY_SIZE(metric_gauge_names) == DMG_NR);
+	D_CASSERT(ARRAY_SIZE(metric_hist_names) == DMH_NR);
+
+	memset(dm, 0, sizeof(*dm));
+
+	pthread_mutex_lock(&metrics_lock);
+	daos_list_add_tail(&dm->dm_link, &metrics_list);
+	pthread_mutex_unlock(&metrics_lock);
+
+	daos_metrics_tls = dm;
+}
+
+void
+daos_metrics_fini(struct daos_metrics *dm)
+{
+	if (daos_metrics_tls == dm)
+		daos_metrics_tls = NULL;
+
+	pthread_mutex_lock(&metrics_lock);
+	daos_list_del_init(&dm->dm_link);
+	pthread_mutex_unlock(&metrics_lock);
+}
+
+void
+daos_metrics_merge(struct daos_metrics *dm)
+{
+	struct daos_metrics	*tmp;
+	int			 i;
+
+	memset(dm, 0, sizeof(*dm));
+
+	pthread_mutex_lock(&metrics_lock);
+	daos_list_for_each_entry(tmp, &metrics_list, dm_link) {
+		for (i = 0; i < DMC_NR; i++)
+			dm->dm_cnts[i] += tmp->dm_cnts[i];
+
+		for (i = 0; i < DMG_NR; i++)
+			dm->dm_gauges[i] += tmp->dm_gauges[i];
+
+		for (i = 0; i < DMH_NR; i++)
+			daos_hist_merge(&dm->dm_hists[i], &tmp->dm_hists[i]);
+	}
+	pthread_mutex_unlock(&metrics_lock);
+}
+
+void
+daos_hist_merge(struct daos_hist *dst, struct daos_hist *src)
+{
+	int	i;
+
+	dst->h_count += src->h_count;
+	dst->h_sum += src->h_sum;
+	if (src->h_max > dst->h_max)
+		dst->h_max = src->h_max;
+	for (i = 0; i < DAOS_HIST_BUCKETS; i++)
+		dst->h_buckets[i] += src->h_buckets[i];
+}
+
+uint64_t
+daos_hist_bucket_lo(unsigned int idx)
+{
+	unsigned int	bits;
+
+	if (idx < 2 * DAOS_HIST_SUB_NR)
+		return idx;
+
+	bits = idx / DAOS_HIST_SUB_NR + DAOS_HIST_SUB_BITS - 1;
+	return (1ULL << bits) |
+	       ((uint64_t)(idx % DAOS_HIST_SUB_NR) <<
+		(bits - DAOS_HIST_SUB_BITS));
+}
+
+uint64_t
+daos_hist_percentile(struct daos_hist *hist, double pct)
+{
+	uint64_t	target;
+	uint64_t	sum = 0;
+	int		i;
+
+	if (hist->h_count == 0)
+		return 0;
+
+	target = hist->h_count * pct / 100;
+	if (target == 0)
+		target = 1;
+
+	for (i = 0; i < DAOS_HIST_BUCKETS; i++) {
+		sum += hist->h_buckets[i];
+		if (sum >= target)
+			return daos_hist_bucket_lo(i);
+	}
+	return hist->h_max;
+}
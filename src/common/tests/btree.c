@@ -51,6 +51,14 @@ struct ik_rec {
 	umem_id_t	ir_val_mmid;
 };
 
+#define IK_INLINE_MAX	60
+
+/** value stored inline in the record, see BTR_FEAT_REC_INLINE */
+struct ik_inline {
+	uint32_t	ii_val_size;
+	char		ii_val[IK_INLINE_MAX];
+};
+
 #define IK_TREE_CLASS	100
 #define POOL_NAME "/mnt/daos/btree-test"
 #define POOL_SIZE ((1024 * 1024  * 1024ULL))
@@ -75,6 +83,43 @@ ik_hkey_gen(struct btr_instance *tins, daos_iov_t *key_iov, void *hkey)
 	memcpy(hkey, ikey, sizeof(*ikey));
 }
 
+/**
+ * Hashed keys are ordered as native uint64_t, so the order agrees with the
+ * 64-bit prefix of BTR_FEAT_HKEY_PREFIX.
+ */
+static int
+ik_hkey_cmp(struct btr_instance *tins, struct btr_record *rec, void *hkey)
+{
+	uint64_t	key1;
+	uint64_t	key2;
+
+	memcpy(&key1, &rec->rec_hkey[0], sizeof(key1));
+	memcpy(&key2, hkey, sizeof(key2));
+	if (key1 == key2)
+		return 0;
+	return key1 < key2 ? -1 : 1;
+}
+
+static int
+ik_rec_inline_size(struct btr_instance *tins)
+{
+	return sizeof(struct ik_inline);
+}
+
+/** inline value of the record, it is only valid if rec_mmid is NULL */
+static struct ik_inline *
+ik_rec2inline(struct btr_record *rec)
+{
+	return (struct ik_inline *)&rec->rec_hkey[sizeof(uint64_t)];
+}
+
+static bool
+ik_rec_can_inline(struct btr_instance *tins, daos_iov_t *val_iov)
+{
+	return (tins->ti_root->tr_feats & BTR_FEAT_REC_INLINE) &&
+	       val_iov->iov_len <= IK_INLINE_MAX;
+}
+
 static int
 ik_rec_alloc(struct btr_instance *tins, daos_iov_t *key_iov,
 	      daos_iov_t *val_iov, struct btr_record *rec)
@@ -83,6 +128,15 @@ ik_rec_alloc(struct btr_instance *tins, daos_iov_t *key_iov,
 	struct ik_rec	      *irec;
 	char		      *vbuf;
 
+	if (ik_rec_can_inline(tins, val_iov)) {
+		struct ik_inline *inl = ik_rec2inline(rec);
+
+		inl->ii_val_size = val_iov->iov_len;
+		memcpy(inl->ii_val, val_iov->iov_buf, val_iov->iov_len);
+		rec->rec_mmid = UMMID_NULL;
+		return 0;
+	}
+
 	irec_mmid = umem_znew_typed(&tins->ti_umm, struct ik_rec);
 	D__ASSERT(!TMMID_IS_NULL(irec_mmid)); /* lazy bone... */
 
@@ -133,20 +187,31 @@ ik_rec_fetch(struct btr_instance *tins, struct btr_record *rec,
 	int		 val_size;
 	int		 key_size;
 
+	void		*key;
+
 	if (key_iov == NULL && val_iov == NULL)
 		return -EINVAL;
 
-	irec = (struct ik_rec *)umem_id2ptr(&tins->ti_umm, rec->rec_mmid);
-	val_size = irec->ir_val_size;
 	key_size = sizeof(irec->ir_key);
+	if (UMMID_IS_NULL(rec->rec_mmid)) {
+		struct ik_inline *inl = ik_rec2inline(rec);
+
+		key = &rec->rec_hkey[0];
+		val = inl->ii_val;
+		val_size = inl->ii_val_size;
+	} else {
+		irec = umem_id2ptr(&tins->ti_umm, rec->rec_mmid);
+		key = &irec->ir_key;
+		val = umem_id2ptr(&tins->ti_umm, irec->ir_val_mmid);
+		val_size = irec->ir_val_size;
+	}
 
-	val = umem_id2ptr(&tins->ti_umm, irec->ir_val_mmid);
 	if (key_iov != NULL) {
 		key_iov->iov_len = key_size;
 		if (key_iov->iov_buf == NULL)
-			key_iov->iov_buf = &irec->ir_key;
+			key_iov->iov_buf = key;
 		else if (key_iov->iov_buf_len >= key_size)
-			memcpy(key_iov->iov_buf, &irec->ir_key, key_size);
+			memcpy(key_iov->iov_buf, key, key_size);
 	}
 
 	if (val_iov != NULL) {
@@ -175,6 +240,16 @@ ik_rec_string(struct btr_instance *tins, struct btr_record *rec,
 		return buf;
 	}
 
+	if (UMMID_IS_NULL(rec->rec_mmid)) {
+		struct ik_inline *inl = ik_rec2inline(rec);
+
+		memcpy(&ikey, &rec->rec_hkey[0], sizeof(ikey));
+		nob = snprintf(buf, buf_len, DF_U64":", ikey);
+		strncpy(buf + nob, inl->ii_val,
+			min(inl->ii_val_size, buf_len - nob));
+		return buf;
+	}
+
 	irec = (struct ik_rec *)umem_id2ptr(&tins->ti_umm, rec->rec_mmid);
 	ikey = irec->ir_key;
 	nob = snprintf(buf, buf_len, DF_U64, ikey);
@@ -197,6 +272,18 @@ ik_rec_update(struct btr_instance *tins, struct btr_record *rec,
 	char			*val;
 	TMMID(struct ik_rec)	 irec_mmid;
 
+	if (UMMID_IS_NULL(rec->rec_mmid)) {
+		struct ik_inline *inl = ik_rec2inline(rec);
+
+		if (!ik_rec_can_inline(tins, val_iov))
+			return -DER_NO_PERM; /* replaced by dbtree */
+
+		umem_tx_add_ptr(umm, inl, sizeof(*inl));
+		memcpy(inl->ii_val, val_iov->iov_buf, val_iov->iov_len);
+		inl->ii_val_size = val_iov->iov_len;
+		return 0;
+	}
+
 	irec_mmid = umem_id_u2t(rec->rec_mmid, struct ik_rec);
 	irec = umem_id2ptr_typed(umm, irec_mmid);
 
@@ -226,17 +313,23 @@ ik_rec_stat(struct btr_instance *tins, struct btr_record *rec,
 	struct ik_rec		*irec;
 	TMMID(struct ik_rec)	 irec_mmid;
 
+	stat->rs_ksize = sizeof(irec->ir_key);
+	if (UMMID_IS_NULL(rec->rec_mmid)) {
+		stat->rs_vsize = ik_rec2inline(rec)->ii_val_size;
+		return 0;
+	}
+
 	irec_mmid = umem_id_u2t(rec->rec_mmid, struct ik_rec);
 	irec = umem_id2ptr_typed(umm, irec_mmid);
-
-	stat->rs_ksize = sizeof(irec->ir_key);
 	stat->rs_vsize = irec->ir_val_size;
 	return 0;
 }
 
 static btr_ops_t ik_ops = {
 	.to_hkey_size	= ik_hkey_size,
+	.to_rec_inline_size = ik_rec_inline_size,
 	.to_hkey_gen	= ik_hkey_gen,
+	.to_hkey_cmp	= ik_hkey_cmp,
 	.to_rec_alloc	= ik_rec_alloc,
 	.to_rec_free	= ik_rec_free,
 	.to_rec_fetch	= ik_rec_fetch,
@@ -259,8 +352,9 @@ static daos_handle_t		ik_toh;
 static int
 ik_btr_open_create(bool create, char *args)
 {
-	bool	inplace = false;
-	int	rc;
+	bool		inplace = false;
+	uint64_t	feats = 0;
+	int		rc;
 
 	if (!daos_handle_is_inval(ik_toh)) {
 		D__ERROR("Tree has been opened\n");
@@ -277,6 +371,24 @@ ik_btr_open_create(bool create, char *args)
 			args += 2;
 		}
 
+		if (args[0] == 'p') { /* search by key prefix */
+			feats = BTR_FEAT_HKEY_PREFIX;
+			if (args[1] != IK_SEP) {
+				D__ERROR("wrong parameter format %s\n", args);
+				return -1;
+			}
+			args += 2;
+		}
+
+		if (args[0] == 'n') { /* store small value inline */
+			feats |= BTR_FEAT_REC_INLINE;
+			if (args[1] != IK_SEP) {
+				D__ERROR("wrong parameter format %s\n", args);
+				return -1;
+			}
+			args += 2;
+		}
+
 		if (args[0] != 'o' || args[1] != IK_SEP_VAL) {
 			D__ERROR("incorrect format for tree order: %s\n", args);
 			return -1;
@@ -297,14 +409,17 @@ ik_btr_open_create(bool create, char *args)
 	}
 
 	if (create) {
-		D__PRINT("Create btree with order %d%s\n",
-			ik_order, inplace ? " inplace" : "");
+		D__PRINT("Create btree with order %d%s%s%s\n", ik_order,
+			inplace ? " inplace" : "",
+			(feats & BTR_FEAT_HKEY_PREFIX) ? " prefix" : "",
+			(feats & BTR_FEAT_REC_INLINE) ? " inline" : "");
 		if (inplace) {
-			rc = dbtree_create_inplace(IK_TREE_CLASS, 0, ik_order,
-						   &ik_uma, &ik_root, &ik_toh);
+			rc = dbtree_create_inplace(IK_TREE_CLASS, feats,
+						   ik_order, &ik_uma, &ik_root,
+						   &ik_toh);
 		} else {
-			rc = dbtree_create(IK_TREE_CLASS, 0, ik_order, &ik_uma,
-					   &ik_root_mmid, &ik_toh);
+			rc = dbtree_create(IK_TREE_CLASS, feats, ik_order,
+					   &ik_uma, &ik_root_mmid, &ik_toh);
 		}
 	} else {
 		D__PRINT("Open btree%s\n", inplace ? " inplace" : "");
@@ -354,8 +469,19 @@ btr_rec_verify_delete(umem_id_t *rec, daos_iov_t *key)
 	TMMID(struct ik_rec)	irec_mmid;
 	struct umem_instance	umm;
 	struct ik_rec		*irec;
+	struct btr_attr		attr;
 	int			rc;
 
+	if (UMMID_IS_NULL(*rec)) {
+		/* inline record has no body to be preserved */
+		rc = dbtree_query(ik_toh, &attr, NULL);
+		if (rc == 0 && (attr.ba_feats & BTR_FEAT_REC_INLINE))
+			return 0;
+
+		D__ERROR("No preserved record while delete\n");
+		return -1;
+	}
+
 	rc = umem_class_init(&ik_uma, &umm);
 	if (rc != 0) {
 		D__ERROR("Failed to instantiate umem while vefify: %d\n", rc);
@@ -464,6 +590,7 @@ ik_btr_kv_operate(enum ik_btr_opc opc, char *str, bool verbose)
 			break;
 
 		case BTR_OPC_DELETE_RETAIN:
+			rec_mmid = UMMID_NULL;
 			rc = dbtree_delete(ik_toh, &key_iov, &rec_mmid);
 			if (rc != 0) {
 				D__ERROR("Failed to delete "DF_U64"\n", key);
@@ -806,6 +933,712 @@ ik_btr_perf(unsigned int key_nr)
 	return 0;
 }
 
+#define IK_PROBE_LOOPS	4
+
+/**
+ * Compare probe throughput of the default binary search and the search by
+ * key prefix (BTR_FEAT_HKEY_PREFIX). Keys are looked up by dbtree_lookup()
+ * directly, so the cost of parsing command line string is excluded.
+ */
+static int
+ik_btr_probe_perf(unsigned int key_nr)
+{
+	uint64_t	 feats[2] = {0, BTR_FEAT_HKEY_PREFIX};
+	double		 rates[2];
+	unsigned int	*arr;
+	int		 i;
+	int		 j;
+	int		 rc = 0;
+
+	if (key_nr == 0 || key_nr > (1U << 28)) {
+		D__PRINT("Invalid key number: %d\n", key_nr);
+		return -1;
+	}
+
+	D__PRINT("Btree probe performance test, order=%u, keys=%u\n",
+		ik_order, key_nr);
+
+	arr = malloc(key_nr * sizeof(*arr));
+	D__ASSERT(arr != NULL);
+
+	for (i = 0; i < 2; i++) {
+		daos_handle_t	toh;
+		daos_iov_t	key_iov;
+		daos_iov_t	val_iov;
+		uint64_t	key;
+		double		then;
+		double		now;
+
+		rc = dbtree_create(IK_TREE_CLASS, feats[i], ik_order, &ik_uma,
+				   NULL, &toh);
+		if (rc != 0) {
+			D__PRINT("create failed: %d\n", rc);
+			goto out;
+		}
+
+		ik_btr_gen_keys(arr, key_nr);
+		for (j = 0; j < key_nr; j++) {
+			key = arr[j];
+			daos_iov_set(&key_iov, &key, sizeof(key));
+			daos_iov_set(&val_iov, &key, sizeof(key));
+
+			rc = dbtree_update(toh, &key_iov, &val_iov);
+			if (rc != 0) {
+				D__PRINT("update failed: %d\n", rc);
+				dbtree_destroy(toh);
+				goto out;
+			}
+		}
+
+		ik_btr_gen_keys(arr, key_nr);
+		then = dts_time_now();
+
+		for (j = 0; j < key_nr * IK_PROBE_LOOPS; j++) {
+			key = arr[j % key_nr];
+			daos_iov_set(&key_iov, &key, sizeof(key));
+			daos_iov_set(&val_iov, NULL, 0);
+
+			rc = dbtree_lookup(toh, &key_iov, &val_iov);
+			if (rc != 0) {
+				D__PRINT("lookup failed: %d\n", rc);
+				dbtree_destroy(toh);
+				goto out;
+			}
+		}
+		now = dts_time_now();
+		rates[i] = key_nr * IK_PROBE_LOOPS / (now - then);
+
+		D__PRINT("%-8s probe = %10.2f/sec\n",
+			feats[i] ? "prefix" : "default", rates[i]);
+		dbtree_destroy(toh);
+	}
+	D__PRINT("speedup = %.2f\n", rates[1] / rates[0]);
+ out:
+	free(arr);
+	return rc == 0 ? 0 : -1;
+}
+
+#define IK_BULK_BATCH	1024
+
+/** update all keys either one by one or by dbtree_update_batch() */
+static int
+ik_btr_bulk_update(daos_handle_t toh, uint64_t *keys, uint64_t *vals,
+		   unsigned int key_nr, bool batch)
+{
+	daos_iov_t	key_iovs[IK_BULK_BATCH];
+	daos_iov_t	val_iovs[IK_BULK_BATCH];
+	int		i;
+	int		j;
+	int		rc;
+
+	for (i = 0; i < key_nr; i += IK_BULK_BATCH) {
+		int	nr = min(key_nr - i, IK_BULK_BATCH);
+
+		for (j = 0; j < nr; j++) {
+			daos_iov_set(&key_iovs[j], &keys[i + j], sizeof(*keys));
+			daos_iov_set(&val_iovs[j], &vals[i + j], sizeof(*vals));
+		}
+
+		if (batch) {
+			rc = dbtree_update_batch(toh, nr, key_iovs, val_iovs);
+		} else {
+			for (j = 0, rc = 0; j < nr && rc == 0; j++)
+				rc = dbtree_update(toh, &key_iovs[j],
+						   &val_iovs[j]);
+		}
+		if (rc != 0) {
+			D__PRINT("update failed: %d\n", rc);
+			return rc;
+		}
+	}
+	return 0;
+}
+
+/** check values of all keys are \a key + \a delta */
+static int
+ik_btr_bulk_verify(daos_handle_t toh, uint64_t *keys, unsigned int key_nr,
+		   uint64_t delta)
+{
+	daos_iov_t	key_iov;
+	daos_iov_t	val_iov;
+	int		i;
+	int		rc;
+
+	for (i = 0; i < key_nr; i++) {
+		daos_iov_set(&key_iov, &keys[i], sizeof(keys[i]));
+		daos_iov_set(&val_iov, NULL, 0);
+
+		rc = dbtree_lookup(toh, &key_iov, &val_iov);
+		if (rc != 0) {
+			D__PRINT("lookup "DF_U64" failed: %d\n", keys[i], rc);
+			return rc;
+		}
+
+		if (*(uint64_t *)val_iov.iov_buf != keys[i] + delta) {
+			D__PRINT("key "DF_U64", wrong value "DF_U64"\n",
+				 keys[i], *(uint64_t *)val_iov.iov_buf);
+			return -1;
+		}
+	}
+	return 0;
+}
+
+/**
+ * Load sorted keys into empty trees by dbtree_update() and
+ * dbtree_update_batch(), compare the insertion rates and node fill, then
+ * verify batch update of unsorted and existing keys.
+ */
+static int
+ik_btr_bulk_perf(unsigned int key_nr)
+{
+	daos_handle_t	 toh;
+	struct btr_stat	 stat;
+	unsigned int	*arr;
+	uint64_t	*keys;
+	uint64_t	*vals;
+	double		 rates[2];
+	double		 then;
+	double		 now;
+	int		 i;
+	int		 rc;
+
+	if (key_nr == 0 || key_nr > (1U << 28)) {
+		D__PRINT("Invalid key number: %d\n", key_nr);
+		return -1;
+	}
+
+	D__PRINT("Btree bulk load test, order=%u, keys=%u\n",
+		ik_order, key_nr);
+
+	arr  = malloc(key_nr * sizeof(*arr));
+	keys = malloc(key_nr * sizeof(*keys));
+	vals = malloc(key_nr * sizeof(*vals));
+	D__ASSERT(arr != NULL && keys != NULL && vals != NULL);
+
+	/* keys are sorted as native uint64_t by BTR_FEAT_HKEY_PREFIX */
+	for (i = 0; i < key_nr; i++)
+		keys[i] = vals[i] = i + 1;
+
+	for (i = 0; i < 2; i++) {
+		rc = dbtree_create(IK_TREE_CLASS, BTR_FEAT_HKEY_PREFIX,
+				   ik_order, &ik_uma, NULL, &toh);
+		if (rc != 0) {
+			D__PRINT("create failed: %d\n", rc);
+			goto out;
+		}
+
+		then = dts_time_now();
+		rc = ik_btr_bulk_update(toh, keys, vals, key_nr, i == 1);
+		now = dts_time_now();
+		if (rc == 0)
+			rc = ik_btr_bulk_verify(toh, keys, key_nr, 0);
+		if (rc == 0)
+			rc = dbtree_query(toh, NULL, &stat);
+		if (rc == 0)
+			D__PRINT("%-8s nodes = %10"PRIu64", fill = %.1f%%\n",
+				 i == 0 ? "single" : "batch", stat.bs_node_nr,
+				 100.0 * stat.bs_rec_nr /
+				 (stat.bs_node_nr * (ik_order - 1)));
+		if (rc != 0 || i == 0) {
+			dbtree_destroy(toh);
+			if (rc != 0)
+				goto out;
+		}
+
+		rates[i] = key_nr / (now - then);
+		D__PRINT("%-8s update = %10.2f/sec\n",
+			 i == 0 ? "single" : "batch", rates[i]);
+	}
+	D__PRINT("speedup = %.2f\n", rates[1] / rates[0]);
+
+	/* overwrite all existing keys in random order, plus new keys */
+	ik_btr_gen_keys(arr, key_nr);
+	for (i = 0; i < key_nr; i++) {
+		keys[i] = arr[i] + (i & 1 ? key_nr : 0);
+		vals[i] = keys[i] + 1;
+	}
+
+	rc = ik_btr_bulk_update(toh, keys, vals, key_nr, true);
+	if (rc == 0)
+		rc = ik_btr_bulk_verify(toh, keys, key_nr, 1);
+	if (rc == 0)
+		D__PRINT("Verified batch update of unsorted keys\n");
+
+	dbtree_destroy(toh);
+ out:
+	free(vals);
+	free(keys);
+	free(arr);
+	return rc == 0 ? 0 : -1;
+}
+
+#define IK_RANGE_ROUNDS	16
+
+/** compare keys in the order of the tree, see ik_hkey_cmp() */
+static int
+ik_key_cmp(uint64_t key1, uint64_t key2)
+{
+	return (key1 > key2) - (key1 < key2);
+}
+
+/** check keys from 1 to \a key_nr exist in the tree only if \a exist */
+static int
+ik_btr_range_verify(daos_handle_t toh, bool *exist, unsigned int key_nr)
+{
+	daos_iov_t	key_iov;
+	daos_iov_t	val_iov;
+	uint64_t	key;
+	int		rc;
+
+	for (key = 1; key <= key_nr; key++) {
+		daos_iov_set(&key_iov, &key, sizeof(key));
+		daos_iov_set(&val_iov, NULL, 0);
+
+		rc = dbtree_lookup(toh, &key_iov, &val_iov);
+		if (rc != 0 && rc != -DER_NONEXIST) {
+			D__PRINT("lookup "DF_U64" failed: %d\n", key, rc);
+			return rc;
+		}
+
+		if ((rc == 0) != exist[key]) {
+			D__PRINT("key "DF_U64" should %sexist\n", key,
+				 exist[key] ? "" : "not ");
+			return -1;
+		}
+	}
+	return 0;
+}
+
+/** time the deletion of the middle half of sorted keys */
+static int
+ik_btr_range_perf(uint64_t *keys, unsigned int key_nr, bool range,
+		  double *rate)
+{
+	daos_handle_t	toh;
+	daos_iov_t	lo_iov;
+	daos_iov_t	hi_iov;
+	uint64_t	lo = key_nr / 4 + 1;
+	uint64_t	hi = lo + key_nr / 2 - 1;
+	uint64_t	key;
+	double		then;
+	int		rc;
+
+	rc = dbtree_create(IK_TREE_CLASS, BTR_FEAT_HKEY_PREFIX, ik_order,
+			   &ik_uma, NULL, &toh);
+	if (rc != 0) {
+		D__PRINT("create failed: %d\n", rc);
+		return rc;
+	}
+
+	rc = ik_btr_bulk_update(toh, keys, keys, key_nr, true);
+	if (rc != 0)
+		goto out;
+
+	then = dts_time_now();
+	if (range) {
+		daos_iov_set(&lo_iov, &lo, sizeof(lo));
+		daos_iov_set(&hi_iov, &hi, sizeof(hi));
+		rc = dbtree_delete_range(toh, &lo_iov, &hi_iov, NULL);
+	} else {
+		for (key = lo; key <= hi && rc == 0; key++) {
+			daos_iov_set(&lo_iov, &key, sizeof(key));
+			rc = dbtree_delete(toh, &lo_iov, NULL);
+		}
+	}
+	*rate = (hi - lo + 1) / (dts_time_now() - then);
+	if (rc != 0)
+		D__PRINT("delete failed: %d\n", rc);
+ out:
+	dbtree_destroy(toh);
+	return rc;
+}
+
+/**
+ * Delete random ranges of keys from the opened tree by dbtree_delete_range()
+ * and verify all keys after each round, then compare the deletion rates of
+ * dbtree_delete_range() and dbtree_delete().
+ */
+static int
+ik_btr_range_delete(unsigned int key_nr)
+{
+	daos_iov_t	 lo_iov;
+	daos_iov_t	 hi_iov;
+	unsigned int	*arr;
+	uint64_t	*keys;
+	bool		*exist;
+	double		 rates[2];
+	int		 i;
+	int		 rc;
+
+	if (daos_handle_is_inval(ik_toh)) {
+		D__PRINT("Can't find opened tree\n");
+		return -1;
+	}
+
+	if (key_nr < 4 || key_nr > (1U << 28)) {
+		D__PRINT("Invalid key number: %d\n", key_nr);
+		return -1;
+	}
+
+	arr   = malloc(key_nr * sizeof(*arr));
+	keys  = malloc(key_nr * sizeof(*keys));
+	exist = malloc((key_nr + 2) * sizeof(*exist));
+	D__ASSERT(arr != NULL && keys != NULL && exist != NULL);
+
+	D__PRINT("Range delete test, keys=%u\n", key_nr);
+	ik_btr_gen_keys(arr, key_nr);
+	for (i = 0; i < key_nr; i++)
+		keys[i] = arr[i];
+	memset(exist, 1, (key_nr + 2) * sizeof(*exist));
+	/* 0 and key_nr + 1 are never in the tree */
+	exist[0] = exist[key_nr + 1] = false;
+
+	rc = ik_btr_bulk_update(ik_toh, keys, keys, key_nr, false);
+	if (rc != 0)
+		goto out;
+
+	for (i = 0; i < IK_RANGE_ROUNDS; i++) {
+		uint64_t	lo = rand() % (key_nr + 2);
+		uint64_t	hi = rand() % (key_nr + 2);
+		uint64_t	key;
+
+		if (ik_key_cmp(lo, hi) > 0) {
+			key = lo;
+			lo = hi;
+			hi = key;
+		}
+
+		D__PRINT("Delete range ["DF_U64", "DF_U64"]\n", lo, hi);
+		daos_iov_set(&lo_iov, &lo, sizeof(lo));
+		daos_iov_set(&hi_iov, &hi, sizeof(hi));
+		rc = dbtree_delete_range(ik_toh, &lo_iov, &hi_iov, NULL);
+		if (rc != 0) {
+			D__PRINT("range delete failed: %d\n", rc);
+			goto out;
+		}
+
+		for (key = 1; key <= key_nr; key++) {
+			if (ik_key_cmp(lo, key) <= 0 &&
+			    ik_key_cmp(key, hi) <= 0)
+				exist[key] = false;
+		}
+
+		rc = ik_btr_range_verify(ik_toh, exist, key_nr);
+		if (rc != 0)
+			goto out;
+	}
+
+	rc = dbtree_delete_range(ik_toh, NULL, NULL, NULL);
+	if (rc == 0 && dbtree_is_empty(ik_toh) != 1) {
+		D__PRINT("Tree is not empty after deleting all records\n");
+		rc = -1;
+	}
+	if (rc != 0)
+		goto out;
+	D__PRINT("Verified %d rounds of range delete\n", IK_RANGE_ROUNDS);
+
+	for (i = 0; i < key_nr; i++)
+		keys[i] = i + 1;
+
+	for (i = 0; i < 2; i++) {
+		rc = ik_btr_range_perf(keys, key_nr, i == 1, &rates[i]);
+		if (rc != 0)
+			goto out;
+
+		D__PRINT("%-8s delete = %10.2f/sec\n",
+			 i == 0 ? "single" : "range", rates[i]);
+	}
+	D__PRINT("speedup = %.2f\n", rates[1] / rates[0]);
+ out:
+	free(exist);
+	free(keys);
+	free(arr);
+	return rc == 0 ? 0 : -1;
+}
+
+/**
+ * check keys from 1 to \a key_nr have values in \a vals, zero means the key
+ * should not exist
+ */
+static int
+ik_btr_snap_verify(daos_handle_t toh, uint64_t *vals, unsigned int key_nr)
+{
+	daos_iov_t	key_iov;
+	daos_iov_t	val_iov;
+	uint64_t	key;
+	uint64_t	val;
+	int		rc;
+
+	for (key = 1; key <= key_nr; key++) {
+		daos_iov_set(&key_iov, &key, sizeof(key));
+		daos_iov_set(&val_iov, NULL, 0);
+
+		rc = dbtree_lookup(toh, &key_iov, &val_iov);
+		if (rc == -DER_NONEXIST && vals[key] == 0)
+			continue;
+
+		if (rc != 0) {
+			D__PRINT("lookup "DF_U64" failed: %d\n", key, rc);
+			return rc;
+		}
+
+		memcpy(&val, val_iov.iov_buf, sizeof(val));
+		if (val != vals[key]) {
+			D__PRINT("key "DF_U64" value "DF_U64", expect "DF_U64
+				 "\n", key, val, vals[key]);
+			return -1;
+		}
+	}
+	return 0;
+}
+
+/**
+ * Update, delete or insert a random key of the opened tree, or delete a
+ * range of keys at every \a range_step steps.
+ */
+static int
+ik_btr_snap_modify(int step, int range_step, uint64_t *vals,
+		   unsigned int key_nr)
+{
+	daos_iov_t	key_iov;
+	daos_iov_t	val_iov;
+	uint64_t	key = rand() % key_nr + 1;
+	uint64_t	hi;
+	uint64_t	val;
+	int		rc = 0;
+
+	daos_iov_set(&key_iov, &key, sizeof(key));
+	daos_iov_set(&val_iov, &val, sizeof(val));
+
+	if (step % range_step == range_step - 1) {
+		hi = key + 8;
+		D__PRINT("Delete range ["DF_U64", "DF_U64"]\n", key, hi);
+		daos_iov_set(&val_iov, &hi, sizeof(hi));
+		rc = dbtree_delete_range(ik_toh, &key_iov, &val_iov, NULL);
+		for (val = 1; val <= 2 * key_nr; val++) {
+			if (ik_key_cmp(key, val) <= 0 &&
+			    ik_key_cmp(val, hi) <= 0)
+				vals[val] = 0;
+		}
+		return rc;
+	}
+
+	switch (step % 3) {
+	case 0: /* update */
+		val = key + key_nr;
+		rc = dbtree_update(ik_toh, &key_iov, &val_iov);
+		vals[key] = val;
+		break;
+	case 1: /* delete */
+		if (vals[key] == 0)
+			break;
+		rc = dbtree_delete(ik_toh, &key_iov, NULL);
+		vals[key] = 0;
+		break;
+	case 2: /* insert */
+		key += key_nr;
+		val = key;
+		rc = dbtree_update(ik_toh, &key_iov, &val_iov);
+		vals[key] = val;
+		break;
+	}
+	return rc;
+}
+
+/**
+ * Iterate a snapshot of the opened tree while keys are updated, deleted and
+ * inserted through the open handle, the snapshot should always see keys and
+ * values at the time it was taken. Another snapshot is taken in the middle,
+ * and the tree is verified after releasing all snapshots.
+ */
+static int
+ik_btr_snapshot(unsigned int key_nr)
+{
+	daos_handle_t	 snaps[2] = { DAOS_HDL_INVAL, DAOS_HDL_INVAL };
+	daos_handle_t	 ih = DAOS_HDL_INVAL;
+	daos_iov_t	 key_iov;
+	daos_iov_t	 val_iov;
+	unsigned int	*arr;
+	uint64_t	*keys;
+	uint64_t	*vals;
+	uint64_t	*snap_vals[2];
+	uint64_t	 key;
+	uint64_t	 val;
+	int		 range_step;
+	int		 nr;
+	int		 i;
+	int		 rc;
+
+	if (daos_handle_is_inval(ik_toh)) {
+		D__PRINT("Can't find opened tree\n");
+		return -1;
+	}
+
+	if (key_nr < 4 || key_nr > (1U << 28)) {
+		D__PRINT("Invalid key number: %d\n", key_nr);
+		return -1;
+	}
+
+	range_step = max(key_nr / 16, 2);
+
+	arr  = malloc(key_nr * sizeof(*arr));
+	keys = malloc(key_nr * sizeof(*keys));
+	vals = calloc(2 * key_nr + 1, sizeof(*vals));
+	for (i = 0; i < 2; i++)
+		snap_vals[i] = malloc((2 * key_nr + 1) * sizeof(*vals));
+	D__ASSERT(arr != NULL && keys != NULL && vals != NULL &&
+		  snap_vals[0] != NULL && snap_vals[1] != NULL);
+
+	D__PRINT("Snapshot test, keys=%u\n", key_nr);
+	ik_btr_gen_keys(arr, key_nr);
+	for (i = 0; i < key_nr; i++) {
+		keys[i] = arr[i];
+		vals[arr[i]] = arr[i];
+	}
+
+	rc = ik_btr_bulk_update(ik_toh, keys, keys, key_nr, false);
+	if (rc != 0)
+		goto out;
+
+	rc = dbtree_snapshot(ik_toh, &snaps[0]);
+	if (rc != 0) {
+		D__PRINT("snapshot failed: %d\n", rc);
+		goto out;
+	}
+	memcpy(snap_vals[0], vals, (2 * key_nr + 1) * sizeof(*vals));
+
+	rc = dbtree_iter_prepare(snaps[0], 0, &ih);
+	if (rc == 0)
+		rc = dbtree_iter_probe(ih, BTR_PROBE_FIRST, NULL, NULL);
+	if (rc != 0) {
+		D__PRINT("failed to iterate snapshot: %d\n", rc);
+		goto out;
+	}
+
+	for (nr = 0;; nr++) {
+		rc = ik_btr_snap_modify(nr, range_step, vals, key_nr);
+		if (rc != 0) {
+			D__PRINT("modification %d failed: %d\n", nr, rc);
+			goto out;
+		}
+
+		if (nr == key_nr / 2) {
+			rc = dbtree_snapshot(ik_toh, &snaps[1]);
+			if (rc != 0) {
+				D__PRINT("snapshot failed: %d\n", rc);
+				goto out;
+			}
+			memcpy(snap_vals[1], vals,
+			       (2 * key_nr + 1) * sizeof(*vals));
+		}
+
+		daos_iov_set(&key_iov, NULL, 0);
+		daos_iov_set(&val_iov, NULL, 0);
+		rc = dbtree_iter_fetch(ih, &key_iov, &val_iov, NULL);
+		if (rc != 0) {
+			D__PRINT("failed to fetch snapshot: %d\n", rc);
+			goto out;
+		}
+
+		memcpy(&key, key_iov.iov_buf, sizeof(key));
+		memcpy(&val, val_iov.iov_buf, sizeof(val));
+		if (key == 0 || key > key_nr || val != key) {
+			D__PRINT("snapshot sees "DF_U64":"DF_U64"\n", key, val);
+			D__GOTO(out, rc = -1);
+		}
+
+		rc = dbtree_iter_next(ih);
+		if (rc == -DER_NONEXIST)
+			break;
+		if (rc != 0) {
+			D__PRINT("failed to move iterator: %d\n", rc);
+			goto out;
+		}
+	}
+
+	if (nr + 1 != key_nr) {
+		D__PRINT("snapshot iterated %d records\n", nr + 1);
+		D__GOTO(out, rc = -1);
+	}
+	D__PRINT("Iterated the snapshot through %d modifications\n", nr + 1);
+
+	rc = dbtree_update(snaps[0], &key_iov, &val_iov);
+	if (rc != -DER_NO_PERM) {
+		D__PRINT("snapshot should be read-only: %d\n", rc);
+		D__GOTO(out, rc = -1);
+	}
+
+	rc = dbtree_destroy(ik_toh);
+	if (rc != -DER_BUSY) {
+		D__PRINT("tree with snapshots should not be destroyed: %d\n",
+			 rc);
+		D__GOTO(out, rc = -1);
+	}
+
+	for (i = 0; i < 2; i++) {
+		rc = ik_btr_snap_verify(snaps[i], snap_vals[i], 2 * key_nr);
+		if (rc != 0)
+			goto out;
+	}
+
+	/* release the older snapshot first, then modify the tree again */
+	dbtree_iter_finish(ih);
+	ih = DAOS_HDL_INVAL;
+	dbtree_close(snaps[0]);
+	snaps[0] = DAOS_HDL_INVAL;
+
+	for (i = 0; i < key_nr; i++) {
+		rc = ik_btr_snap_modify(i, range_step, vals, key_nr);
+		if (rc != 0) {
+			D__PRINT("modification %d failed: %d\n", i, rc);
+			goto out;
+		}
+	}
+
+	rc = ik_btr_snap_verify(snaps[1], snap_vals[1], 2 * key_nr);
+	if (rc != 0)
+		goto out;
+
+	dbtree_close(snaps[1]);
+	snaps[1] = DAOS_HDL_INVAL;
+
+	rc = ik_btr_snap_verify(ik_toh, vals, 2 * key_nr);
+	if (rc != 0)
+		goto out;
+	D__PRINT("Verified the tree and its snapshots\n");
+ out:
+	if (!daos_handle_is_inval(ih))
+		dbtree_iter_finish(ih);
+	for (i = 0; i < 2; i++) {
+		if (!daos_handle_is_inval(snaps[i]))
+			dbtree_close(snaps[i]);
+		free(snap_vals[i]);
+	}
+	free(vals);
+	free(keys);
+	free(arr);
+	return rc == 0 ? 0 : -1;
+}
+
+static void
+ik_slab_stat(void)
+{
+	struct umem_slab_stat	stats[UMEM_SLAB_CLASS_MAX];
+	int			nr;
+	int			i;
+
+	nr = umem_slab_query(stats, UMEM_SLAB_CLASS_MAX);
+	D__PRINT("slab size        alloc         free       cached     memory\n");
+	for (i = 0; i < nr; i++) {
+		if (stats[i].ss_alloc == 0)
+			continue;
+
+		D__PRINT("%9zu %12"PRIu64" %12"PRIu64" %12"PRIu64" %10"PRIu64
+			 "\n", stats[i].ss_size, stats[i].ss_alloc,
+			 stats[i].ss_free, stats[i].ss_cached, stats[i].ss_mem);
+	}
+}
+
 static struct option btr_ops[] = {
 	{ "create",	required_argument,	NULL,	'C'	},
 	{ "destroy",	no_argument,		NULL,	'D'	},
@@ -819,6 +1652,11 @@ static struct option btr_ops[] = {
 	{ "iterate",	required_argument,	NULL,	'i'	},
 	{ "batch",	required_argument,	NULL,	'b'	},
 	{ "perf",	required_argument,	NULL,	'p'	},
+	{ "probe_perf",	required_argument,	NULL,	'P'	},
+	{ "bulk",	required_argument,	NULL,	'l'	},
+	{ "range",	required_argument,	NULL,	'R'	},
+	{ "snapshot",	required_argument,	NULL,	'S'	},
+	{ "slab",	no_argument,		NULL,	's'	},
 	{ NULL,		0,			NULL,	0	},
 };
 
@@ -835,12 +1673,13 @@ main(int argc, char **argv)
 	if (rc != 0)
 		return rc;
 
-	rc = dbtree_class_register(IK_TREE_CLASS, 0, &ik_ops);
+	rc = dbtree_class_register(IK_TREE_CLASS, BTR_FEAT_HKEY_PREFIX |
+				   BTR_FEAT_REC_INLINE, &ik_ops);
 	D__ASSERT(rc == 0);
 
 	optind = 0;
 	ik_uma.uma_id = UMEM_CLASS_VMEM;
-	while ((rc = getopt_long(argc, argv, "mC:Docqu:d:r:f:i:b:p:",
+	while ((rc = getopt_long(argc, argv, "msC:Docqu:d:r:f:i:b:p:P:l:R:S:",
 				 btr_ops, NULL)) != -1) {
 		switch (rc) {
 		case 'C':
@@ -880,17 +1719,35 @@ main(int argc, char **argv)
 		case 'p':
 			rc = ik_btr_perf(atoi(optarg));
 			break;
+		case 'P':
+			rc = ik_btr_probe_perf(atoi(optarg));
+			break;
+		case 'l':
+			rc = ik_btr_bulk_perf(atoi(optarg));
+			break;
+		case 'R':
+			rc = ik_btr_range_delete(atoi(optarg));
+			break;
+		case 'S':
+			rc = ik_btr_snapshot(atoi(optarg));
+			break;
 		case 'm':
 			ik_uma.uma_id = UMEM_CLASS_PMEM;
 			ik_uma.uma_u.pmem_pool = pmemobj_create(POOL_NAME,
 						"btree-perf-test", POOL_SIZE,
 						0666);
 			break;
+		case 's':
+			ik_uma.uma_id = UMEM_CLASS_VMEM_SLAB;
+			break;
 		default:
 			D__PRINT("Unsupported command %c\n", rc);
 			break;
 		}
 	}
+	if (ik_uma.uma_id == UMEM_CLASS_VMEM_SLAB)
+		ik_slab_stat();
+
 	daos_debug_fini();
 	if (ik_uma.uma_id == UMEM_CLASS_PMEM) {
 		pmemobj_close(ik_uma.uma_u.pmem_pool);
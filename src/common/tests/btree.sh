@@ -7,6 +7,8 @@ ORDER=${ORDER:-3}
 DDEBUG=${DDEBUG:-0}
 INPLACE=${INPLACE:-"no"}
 BACKWARD=${BACKWARD:-"no"}
+PREFIX=${PREFIX:-"no"}
+INLINE=${INLINE:-"no"}
 BAT_NUM=${BAT_NUM:-"200000"}
 
 IPL=""
@@ -14,6 +16,14 @@ if [ "x$INPLACE" == "xyes" ]; then
 	IPL="i,"
 fi
 
+if [ "x$PREFIX" == "xyes" ]; then
+	IPL="${IPL}p,"
+fi
+
+if [ "x$INLINE" == "xyes" ]; then
+	IPL="${IPL}n,"
+fi
+
 IDIR="f"
 if [ "x$BACKWARD" == "xyes" ]; then
 	IDIR="b"
@@ -49,12 +59,34 @@ if [[ $1 != "perf" ]]; then
 	-o				\
 	-b $BAT_NUM			\
 	-D
+
+    echo "B+tree range delete test..."
+    $BTR	-C ${IPL}o:$ORDER		\
+	-R $BAT_NUM			\
+	-D
+
+    echo "B+tree snapshot test..."
+    $BTR	-C ${IPL}o:$ORDER		\
+	-S $BAT_NUM			\
+	-D
 else
     echo "B+tree performance test..."
     $BTR	-C ${IPL}o:$ORDER		\
 	-p $BAT_NUM			\
 	-D
 
+    echo "B+tree probe performance test..."
+    $BTR	-P $BAT_NUM
+
+    echo "B+tree bulk load test..."
+    $BTR	-l $BAT_NUM
+
+    echo "B+tree performance test using slab"
+    $BTR    -s                      \
+	-C ${IPL}o:$ORDER   \
+	-p $BAT_NUM             \
+	-D
+
     echo "B+tree performance test using pmemobj"
     $BTR    -m                      \
 	-C ${IPL}o:$ORDER   \
@@ -0,0 +1,257 @@
+/**
+ * (C) Copyright 2017 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * GOVERNMENT LICENSE RIGHTS-OPEN SOURCE SOFTWARE
+ * The Government's rights to use, modify, reproduce, release, perform, display,
+ * or disclose this software are subject to the terms of the Apache License as
+ * provided in Contract No. B609815.
+ * Any reproduction of computer software, computer software documentation, or
+ * portions thereof marked with this legend must also reproduce the markings.
+ */
+/**
+ * Checksum tests, verifies the known check values, that all kernels produce
+ * the same checksums for any length and alignment, and that a checksum can
+ * be computed piece by piece.
+ *
+ * Usage: csum [-b]
+ *   -b  also report the bandwidth of each kernel
+ */
+#define DDSUBSYS	DDFAC(tests)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <daos/common.h>
+#include <daos/csum.h>
+#include <daos/tests_lib.h>
+
+#define CSUM_TEST_LEN		(1 << 20)
+#define CSUM_TEST_LOOP		2000
+
+static const char *csum_kernel_names[] = {
+	[DAOS_CSUM_KERNEL_C]	= "c",
+	[DAOS_CSUM_KERNEL_HW]	= "hw",
+};
+
+static uint64_t
+csum_test_crc(int type, uint64_t crc, const void *buf, daos_size_t len)
+{
+	if (type == DAOS_CSUM_CRC32C)
+		return daos_crc32c(crc, buf, len);
+	return daos_crc64(crc, buf, len);
+}
+
+static int
+csum_test_check(int kernel)
+{
+	const char	*str = "123456789";
+
+	if (daos_crc32c(0, str, strlen(str)) != 0xe3069283U ||
+	    daos_crc64(0, str, strlen(str)) != 0x995dc9bbdf1939faULL) {
+		D__PRINT("kernel %s: wrong check value\n",
+			 csum_kernel_names[kernel]);
+		return -DER_IO;
+	}
+
+	if (daos_crc32c(0, str, 0) != 0 || daos_crc64(0, str, 0) != 0) {
+		D__PRINT("kernel %s: wrong checksum of empty buffer\n",
+			 csum_kernel_names[kernel]);
+		return -DER_IO;
+	}
+	return 0;
+}
+
+/** compare a kernel with the C kernel on random ranges of \a buf */
+static int
+csum_test_kernel(int kernel, int type, unsigned char *buf)
+{
+	int	i;
+
+	for (i = 0; i < CSUM_TEST_LOOP; i++) {
+		daos_size_t	off = rand() % 64;
+		daos_size_t	len;
+		daos_size_t	split;
+		uint64_t	ref;
+		uint64_t	crc;
+
+		/* mostly short buffers, to cover the tails of all loops */
+		len = (i % 4 == 0) ? rand() % (CSUM_TEST_LEN - 64) :
+				     rand() % 1024;
+
+		daos_csum_kernel_set(DAOS_CSUM_KERNEL_C);
+		ref = csum_test_crc(type, 0, &buf[off], len);
+
+		daos_csum_kernel_set(kernel);
+		crc = csum_test_crc(type, 0, &buf[off], len);
+		if (crc != ref) {
+			D__PRINT("kernel %s, type %s: mismatch at "DF_U64"+"
+				 DF_U64"\n", csum_kernel_names[kernel],
+				 daos_csum_type2name(type), off, len);
+			return -DER_IO;
+		}
+
+		split = len == 0 ? 0 : rand() % len;
+		crc = csum_test_crc(type, 0, &buf[off], split);
+		crc = csum_test_crc(type, crc, &buf[off + split], len - split);
+		if (crc != ref) {
+			D__PRINT("kernel %s, type %s: split mismatch at "DF_U64
+				 "+"DF_U64"/"DF_U64"\n",
+				 csum_kernel_names[kernel],
+				 daos_csum_type2name(type), off, split, len);
+			return -DER_IO;
+		}
+	}
+	return 0;
+}
+
+/** checksum of a sgl, and verification of a corrupted buffer */
+static int
+csum_test_ctx(int type, unsigned char *buf)
+{
+	struct daos_csum_ctx	ctx;
+	daos_csum_buf_t		csum;
+	daos_sg_list_t		sgl;
+	daos_iov_t		iovs[3];
+	uint64_t		val;
+	int			rc;
+
+	daos_iov_set(&iovs[0], buf, 100);
+	daos_iov_set(&iovs[1], NULL, 0);
+	daos_iov_set(&iovs[2], &buf[100], 4000);
+	sgl.sg_iovs = iovs;
+	sgl.sg_nr.num = sgl.sg_nr.num_out = 3;
+
+	daos_csum_init(&ctx, type);
+	daos_csum_update_sgl(&ctx, &sgl, 3);
+	if (ctx.cc_len != 4100 ||
+	    ctx.cc_val != csum_test_crc(type, 0, buf, 4100)) {
+		D__PRINT("type %s: wrong checksum of sgl\n",
+			 daos_csum_type2name(type));
+		return -DER_IO;
+	}
+
+	daos_csum_set(&csum, &val, sizeof(val));
+	daos_csum_final(&ctx, &csum);
+	if (csum.cs_type != type ||
+	    csum.cs_len != daos_csum_type2size(type)) {
+		D__PRINT("type %s: wrong size %d\n",
+			 daos_csum_type2name(type), csum.cs_len);
+		return -DER_IO;
+	}
+
+	rc = daos_csum_verify(&ctx, &csum);
+	if (rc != 0) {
+		D__PRINT("type %s: verify failed: %d\n",
+			 daos_csum_type2name(type), rc);
+		return rc;
+	}
+
+	buf[200] ^= 1;
+	daos_csum_init(&ctx, type);
+	daos_csum_update(&ctx, buf, 4100);
+	rc = daos_csum_verify(&ctx, &csum);
+	buf[200] ^= 1;
+	if (rc != -DER_IO) {
+		D__PRINT("type %s: corruption is not detected: %d\n",
+			 daos_csum_type2name(type), rc);
+		return -DER_INVAL;
+	}
+	return 0;
+}
+
+static void
+csum_test_bench(int kernel, int type, unsigned char *buf)
+{
+	double	start = dts_time_now();
+	int	loop = 200;
+	int	i;
+
+	for (i = 0; i < loop; i++)
+		csum_test_crc(type, 0, buf, CSUM_TEST_LEN);
+
+	D__PRINT("kernel %-2s %-6s %.1f MB/s\n", csum_kernel_names[kernel],
+		 daos_csum_type2name(type), (double)CSUM_TEST_LEN * loop /
+		 ((dts_time_now() - start) * 1000000));
+}
+
+int
+main(int argc, char **argv)
+{
+	unsigned char	*buf;
+	bool		 bench = false;
+	int		 kernel;
+	int		 type;
+	int		 rc;
+	int		 i;
+
+	rc = daos_debug_init(NULL);
+	if (rc != 0)
+		return rc;
+
+	while ((rc = getopt(argc, argv, "b")) != -1) {
+		switch (rc) {
+		case 'b':
+			bench = true;
+			break;
+		default:
+			D__PRINT("Usage: %s [-b]\n", argv[0]);
+			D__GOTO(out, rc = -DER_INVAL);
+		}
+	}
+
+	D__ALLOC(buf, CSUM_TEST_LEN);
+	if (buf == NULL)
+		D__GOTO(out, rc = -DER_NOMEM);
+
+	srand(0xc5);
+	for (i = 0; i < CSUM_TEST_LEN; i++)
+		buf[i] = rand();
+
+	rc = 0;
+	for (kernel = DAOS_CSUM_KERNEL_C; kernel <= DAOS_CSUM_KERNEL_HW;
+	     kernel++) {
+		if (daos_csum_kernel_set(kernel) != 0) {
+			D__PRINT("kernel %s is not supported\n",
+				 csum_kernel_names[kernel]);
+			continue;
+		}
+
+		rc = csum_test_check(kernel);
+		if (rc != 0)
+			break;
+
+		for (type = DAOS_CSUM_CRC32C; type <= DAOS_CSUM_CRC64;
+		     type++) {
+			rc = csum_test_kernel(kernel, type, buf);
+			if (rc != 0)
+				D__GOTO(out_free, rc);
+
+			rc = csum_test_ctx(type, buf);
+			if (rc != 0)
+				D__GOTO(out_free, rc);
+
+			if (bench)
+				csum_test_bench(kernel, type, buf);
+		}
+		D__PRINT("kernel %s passed\n", csum_kernel_names[kernel]);
+	}
+out_free:
+	daos_csum_kernel_set(DAOS_CSUM_KERNEL_AUTO);
+	D__FREE(buf, CSUM_TEST_LEN);
+out:
+	daos_debug_fini();
+	return rc;
+}
@@ -0,0 +1,239 @@
+/**
+ * (C) Copyright 2017 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * GOVERNMENT LICENSE RIGHTS-OPEN SOURCE SOFTWARE
+ * The Government's rights to use, modify, reproduce, release, perform, display,
+ * or disclose this software are subject to the terms of the Apache License as
+ * provided in Contract No. B609815.
+ * Any reproduction of computer software, computer software documentation, or
+ * portions thereof marked with this legend must also reproduce the markings.
+ */
+/**
+ * Erasure code tests, verifies all kernels produce the same parity and any
+ * combination of up to p lost cells can be reconstructed.
+ *
+ * Usage: ec [-b]
+ *   -b  also report the encoding bandwidth of each kernel
+ */
+#define DDSUBSYS	DDFAC(tests)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <daos/common.h>
+#include <daos/ec.h>
+#include <daos/tests_lib.h>
+
+#define EC_TEST_LEN	(64 << 10)
+/* not a multiple of the vector size, to cover the tails */
+#define EC_TEST_TAIL	13
+
+static struct {
+	unsigned int	k;
+	unsigned int	p;
+} ec_test_codes[] = {
+	{ 4, 2 },
+	{ 8, 2 },
+	{ 6, 3 },
+	{ 16, 4 },
+};
+
+static const char *ec_kernel_names[] = {
+	[DAOS_EC_KERNEL_C]	= "c",
+	[DAOS_EC_KERNEL_SSSE3]	= "ssse3",
+	[DAOS_EC_KERNEL_AVX2]	= "avx2",
+};
+
+static unsigned char *
+ec_test_cells_alloc(unsigned int nr, daos_size_t len, unsigned char **cells)
+{
+	unsigned char	*buf;
+	int		 i;
+
+	D__ALLOC(buf, nr * len);
+	if (buf == NULL)
+		return NULL;
+
+	for (i = 0; i < nr; i++)
+		cells[i] = &buf[i * len];
+	return buf;
+}
+
+static int
+ec_test_decode(struct daos_ec_codec *codec, unsigned int k, unsigned int p,
+	       daos_size_t len, unsigned char **cells)
+{
+	unsigned char	*buf;
+	unsigned char	*dup[DAOS_EC_CELL_MAX];
+	uint32_t	 lost;
+	int		 nr = 0;
+	int		 rc = 0;
+	int		 i;
+
+	buf = ec_test_cells_alloc(k + p, len, dup);
+	if (buf == NULL)
+		return -DER_NOMEM;
+
+	/* every combination of up to p lost cells */
+	for (lost = 1; lost < (1U << (k + p)); lost++) {
+		if (__builtin_popcount(lost) > p)
+			continue;
+
+		for (i = 0; i < k + p; i++) {
+			if (lost & (1U << i))
+				memset(dup[i], 0xa5, len);
+			else
+				memcpy(dup[i], cells[i], len);
+		}
+
+		rc = daos_ec_decode(codec, len, dup, lost);
+		if (rc != 0) {
+			D__PRINT("decode %d+%d lost %#x failed: %d\n",
+				 k, p, lost, rc);
+			D__GOTO(out, rc);
+		}
+
+		for (i = 0; i < k + p; i++) {
+			if (memcmp(dup[i], cells[i], len) != 0) {
+				D__PRINT("decode %d+%d lost %#x: cell %d "
+					 "mismatch\n", k, p, lost, i);
+				D__GOTO(out, rc = -DER_IO);
+			}
+		}
+		nr++;
+	}
+
+	/* too many lost cells */
+	lost = (1U << (p + 1)) - 1;
+	if (daos_ec_decode(codec, len, dup, lost) != -DER_IO) {
+		D__PRINT("decode %d+%d should fail with %d lost cells\n",
+			 k, p, p + 1);
+		D__GOTO(out, rc = -DER_INVAL);
+	}
+	D__PRINT("%d+%d: reconstructed %d combinations of lost cells\n",
+		 k, p, nr);
+out:
+	D__FREE(buf, (k + p) * len);
+	return rc;
+}
+
+static int
+ec_test_one(unsigned int k, unsigned int p, bool bench)
+{
+	struct daos_ec_codec	*codec;
+	unsigned char		*buf;
+	unsigned char		*ref_buf = NULL;
+	unsigned char		*cells[DAOS_EC_CELL_MAX];
+	unsigned char		*ref[DAOS_EC_CELL_MAX];
+	daos_size_t		 len = EC_TEST_LEN + EC_TEST_TAIL;
+	int			 kernel;
+	int			 rc;
+	int			 i;
+
+	rc = daos_ec_codec_create(k, p, &codec);
+	if (rc != 0)
+		return rc;
+
+	buf = ec_test_cells_alloc(k + p, len, cells);
+	ref_buf = ec_test_cells_alloc(p, len, ref);
+	if (buf == NULL || ref_buf == NULL)
+		D__GOTO(out, rc = -DER_NOMEM);
+
+	for (i = 0; i < k * len; i++)
+		buf[i] = rand();
+
+	daos_ec_kernel_set(DAOS_EC_KERNEL_C);
+	daos_ec_encode(codec, len, cells, ref);
+
+	for (kernel = DAOS_EC_KERNEL_C; kernel <= DAOS_EC_KERNEL_AVX2;
+	     kernel++) {
+		if (daos_ec_kernel_set(kernel) != 0) {
+			D__PRINT("%d+%d: kernel %s is not supported\n",
+				 k, p, ec_kernel_names[kernel]);
+			continue;
+		}
+
+		memset(&buf[k * len], 0, p * len);
+		daos_ec_encode(codec, len, cells, &cells[k]);
+		if (memcmp(&buf[k * len], ref_buf, p * len) != 0) {
+			D__PRINT("%d+%d: parity of kernel %s mismatch\n",
+				 k, p, ec_kernel_names[kernel]);
+			D__GOTO(out, rc = -DER_IO);
+		}
+
+		rc = ec_test_decode(codec, k, p, 4096 + EC_TEST_TAIL, cells);
+		if (rc != 0)
+			D__GOTO(out, rc);
+
+		if (bench) {
+			double	start = dts_time_now();
+			int	loop = 200;
+
+			for (i = 0; i < loop; i++)
+				daos_ec_encode(codec, len, cells, &cells[k]);
+			D__PRINT("%d+%d: kernel %-5s encode %.1f MB/s\n",
+				 k, p, ec_kernel_names[kernel],
+				 (double)k * len * loop /
+				 ((dts_time_now() - start) * 1000000));
+		}
+	}
+	D__PRINT("%d+%d: all kernels passed\n", k, p);
+out:
+	daos_ec_kernel_set(DAOS_EC_KERNEL_AUTO);
+	if (buf != NULL)
+		D__FREE(buf, (k + p) * len);
+	if (ref_buf != NULL)
+		D__FREE(ref_buf, p * len);
+	daos_ec_codec_destroy(codec);
+	return rc;
+}
+
+int
+main(int argc, char **argv)
+{
+	bool	bench = false;
+	int	rc;
+	int	i;
+
+	rc = daos_debug_init(NULL);
+	if (rc != 0)
+		return rc;
+
+	while ((rc = getopt(argc, argv, "b")) != -1) {
+		switch (rc) {
+		case 'b':
+			bench = true;
+			break;
+		default:
+			D__PRINT("Usage: %s [-b]\n", argv[0]);
+			D__GOTO(out, rc = -DER_INVAL);
+		}
+	}
+
+	srand(0xec);
+	for (i = 0; i < ARRAY_SIZE(ec_test_codes); i++) {
+		rc = ec_test_one(ec_test_codes[i].k, ec_test_codes[i].p,
+				 bench);
+		if (rc != 0) {
+			D__PRINT("EC test %d+%d failed: %d\n",
+				 ec_test_codes[i].k, ec_test_codes[i].p, rc);
+			break;
+		}
+	}
+out:
+	daos_debug_fini();
+	return rc;
+}
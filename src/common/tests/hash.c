@@ -0,0 +1,433 @@
+/**
+ * (C) Copyright 2017 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * GOVERNMENT LICENSE RIGHTS-OPEN SOURCE SOFTWARE
+ * The Government's rights to use, modify, reproduce, release, perform, display,
+ * or disclose this software are subject to the terms of the Apache License as
+ * provided in Contract No. B609815.
+ * Any reproduction of computer software, computer software documentation, or
+ * portions thereof marked with this legend must also reproduce the markings.
+ */
+/**
+ * Hash table tests, verifies records can be found while the table grows
+ * and shrinks, with all types of locks, and handles can be looked up by
+ * concurrent threads while they are deleted and reinserted.
+ *
+ * Usage: hash [-n records]
+ */
+#define DDSUBSYS	DDFAC(tests)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <sched.h>
+#include <daos/common.h>
+#include <daos/hash.h>
+
+#define HT_TEST_BITS	4
+#define HT_TEST_NR	(100 << 10)
+#define HH_TEST_NR	1024
+#define HH_TEST_THREADS	4
+
+struct ht_test_rec {
+	daos_list_t	hr_link;
+	uint64_t	hr_key;
+	int		hr_ref;
+};
+
+static struct ht_test_rec *
+ht_test_rec_obj(daos_list_t *rlink)
+{
+	return container_of(rlink, struct ht_test_rec, hr_link);
+}
+
+static int
+ht_test_key_get(struct dhash_table *htable, daos_list_t *rlink, void **key_pp)
+{
+	struct ht_test_rec *rec = ht_test_rec_obj(rlink);
+
+	*key_pp = &rec->hr_key;
+	return sizeof(rec->hr_key);
+}
+
+static bool
+ht_test_key_cmp(struct dhash_table *htable, daos_list_t *rlink,
+		const void *key, unsigned int ksize)
+{
+	D__ASSERT(ksize == sizeof(uint64_t));
+	return ht_test_rec_obj(rlink)->hr_key == *(const uint64_t *)key;
+}
+
+static void
+ht_test_rec_addref(struct dhash_table *htable, daos_list_t *rlink)
+{
+	ht_test_rec_obj(rlink)->hr_ref++;
+}
+
+static bool
+ht_test_rec_decref(struct dhash_table *htable, daos_list_t *rlink)
+{
+	struct ht_test_rec *rec = ht_test_rec_obj(rlink);
+
+	D__ASSERT(rec->hr_ref > 0);
+	rec->hr_ref--;
+	return false;
+}
+
+static dhash_table_ops_t ht_test_ops = {
+	.hop_key_get	= ht_test_key_get,
+	.hop_key_cmp	= ht_test_key_cmp,
+	.hop_rec_addref	= ht_test_rec_addref,
+	.hop_rec_decref	= ht_test_rec_decref,
+};
+
+/* no hop_key_get, so the table can't be resized */
+static dhash_table_ops_t ht_test_fixed_ops = {
+	.hop_key_cmp	= ht_test_key_cmp,
+	.hop_rec_addref	= ht_test_rec_addref,
+	.hop_rec_decref	= ht_test_rec_decref,
+};
+
+static int
+ht_test_count_cb(daos_list_t *rlink, void *args)
+{
+	(*(int *)args)++;
+	return 0;
+}
+
+/** lookup records in [start, end), they should exist if @exist is true */
+static int
+ht_test_lookup(struct dhash_table *htable, struct ht_test_rec *recs,
+	       int start, int end, bool exist)
+{
+	daos_list_t	*rlink;
+	int		 i;
+
+	for (i = start; i < end; i++) {
+		rlink = dhash_rec_find(htable, &recs[i].hr_key,
+				       sizeof(recs[i].hr_key));
+		if (rlink != (exist ? &recs[i].hr_link : NULL)) {
+			D__PRINT("record %d: lookup returned %p, expected %s\n",
+				 i, rlink, exist ? "the record" : "NULL");
+			return -DER_NONEXIST;
+		}
+		if (rlink != NULL)
+			dhash_rec_decref(htable, rlink);
+	}
+	return 0;
+}
+
+static int
+ht_test_one(uint32_t feats, dhash_table_ops_t *ops, int nr)
+{
+	struct dhash_table	 htable;
+	struct ht_test_rec	*recs;
+	bool			 resizable = (ops->hop_key_get != NULL);
+	unsigned int		 bits_max;
+	int			 left;
+	int			 count;
+	int			 rc;
+	int			 i;
+
+	D__ALLOC(recs, sizeof(*recs) * nr);
+	if (recs == NULL)
+		return -DER_NOMEM;
+
+	rc = dhash_table_create_inplace(feats, HT_TEST_BITS, NULL, ops,
+					&htable);
+	if (rc != 0)
+		D__GOTO(out, rc);
+
+	for (i = 0; i < nr; i++) {
+		DAOS_INIT_LIST_HEAD(&recs[i].hr_link);
+		recs[i].hr_key = daos_hash_mix64(i);
+		rc = dhash_rec_insert(&htable, &recs[i].hr_key,
+				      sizeof(recs[i].hr_key),
+				      &recs[i].hr_link, true);
+		if (rc != 0)
+			D__GOTO(destroy, rc);
+
+		/* some records inserted so far, while buckets are moving */
+		if (i % 1000 == 0) {
+			rc = ht_test_lookup(&htable, recs, i / 2, i + 1, true);
+			if (rc != 0)
+				D__GOTO(destroy, rc);
+		}
+	}
+
+	rc = ht_test_lookup(&htable, recs, 0, nr, true);
+	if (rc != 0)
+		D__GOTO(destroy, rc);
+
+	count = 0;
+	dhash_table_traverse(&htable, ht_test_count_cb, &count);
+	if (count != nr || htable.ht_nr != nr) {
+		D__PRINT("traversed %d records, table has %u, expected %d\n",
+			 count, htable.ht_nr, nr);
+		D__GOTO(destroy, rc = -DER_INVAL);
+	}
+
+	bits_max = htable.ht_bits;
+	if (resizable != (bits_max > HT_TEST_BITS)) {
+		D__PRINT("%d records in %u buckets\n", nr, 1U << bits_max);
+		D__GOTO(destroy, rc = -DER_INVAL);
+	}
+
+	/* delete by key and by link, the survivors should still be found */
+	left = nr / 16;
+	for (i = 0; i < nr - left; i++) {
+		bool	deleted;
+
+		if (i % 2 == 0)
+			deleted = dhash_rec_delete(&htable, &recs[i].hr_key,
+						   sizeof(recs[i].hr_key));
+		else
+			deleted = dhash_rec_delete_at(&htable,
+						      &recs[i].hr_link);
+		if (!deleted || recs[i].hr_ref != 0) {
+			D__PRINT("record %d: failed to delete\n", i);
+			D__GOTO(destroy, rc = -DER_INVAL);
+		}
+
+		if (i % 4096 == 0) {
+			rc = ht_test_lookup(&htable, recs, i / 2, i + 1, false);
+			if (rc == 0)
+				rc = ht_test_lookup(&htable, recs, i + 1, nr,
+						    true);
+			if (rc != 0)
+				D__GOTO(destroy, rc);
+		}
+	}
+
+	rc = ht_test_lookup(&htable, recs, 0, nr - left, false);
+	if (rc == 0)
+		rc = ht_test_lookup(&htable, recs, nr - left, nr, true);
+	if (rc != 0)
+		D__GOTO(destroy, rc);
+
+	if (resizable && htable.ht_bits >= bits_max) {
+		D__PRINT("%u records in %u buckets, the table did not "
+			 "shrink\n", htable.ht_nr, 1U << htable.ht_bits);
+		D__GOTO(destroy, rc = -DER_INVAL);
+	}
+	D__PRINT("feats %#x: %d records, %u->%u->%u buckets\n", feats, nr,
+		 1U << HT_TEST_BITS, 1U << bits_max, 1U << htable.ht_bits);
+destroy:
+	/* the survivors are purged, maybe in the middle of rehashing */
+	dhash_table_destroy_inplace(&htable, true);
+	for (i = 0; rc == 0 && i < nr; i++) {
+		if (recs[i].hr_ref != 0 ||
+		    !dhash_rec_unlinked(&recs[i].hr_link)) {
+			D__PRINT("record %d: not released by destroy\n", i);
+			rc = -DER_INVAL;
+		}
+	}
+out:
+	D__FREE(recs, sizeof(*recs) * nr);
+	return rc;
+}
+
+struct hh_test_rec {
+	struct daos_hlink	hr_hlink;
+	bool			hr_freed;
+};
+
+static struct daos_hhash	*hh_test_hash;
+static struct hh_test_rec	 hh_test_recs[HH_TEST_NR];
+static uint64_t			 hh_test_keys[HH_TEST_NR];
+static bool			 hh_test_stop;
+static int			 hh_test_errors;
+
+static void
+hh_test_free(struct daos_hlink *hlink)
+{
+	struct hh_test_rec *rec;
+
+	rec = container_of(hlink, struct hh_test_rec, hr_hlink);
+	__atomic_store_n(&rec->hr_freed, true, __ATOMIC_RELEASE);
+}
+
+static struct daos_hlink_ops hh_test_ops = {
+	.hop_free	= hh_test_free,
+};
+
+static void
+hh_test_insert(int i)
+{
+	struct hh_test_rec *rec = &hh_test_recs[i];
+	uint64_t	    key;
+
+	rec->hr_freed = false;
+	daos_hhash_hlink_init(&rec->hr_hlink, &hh_test_ops);
+	daos_hhash_link_insert(hh_test_hash, &rec->hr_hlink, DAOS_HTYPE_OBJ);
+	daos_hhash_link_key(&rec->hr_hlink, &key);
+	__atomic_store_n(&hh_test_keys[i], key, __ATOMIC_RELEASE);
+}
+
+/** delete the record, and wait for the refcounts of the readers */
+static void
+hh_test_delete(int i)
+{
+	struct hh_test_rec *rec = &hh_test_recs[i];
+
+	daos_hhash_link_delete(hh_test_hash, &rec->hr_hlink);
+	daos_hhash_link_putref(hh_test_hash, &rec->hr_hlink);
+	while (!__atomic_load_n(&rec->hr_freed, __ATOMIC_ACQUIRE))
+		sched_yield();
+}
+
+static void *
+hh_test_reader(void *arg)
+{
+	struct daos_hlink	*hlink;
+	struct hh_test_rec	*rec;
+	unsigned int		 seed = (unsigned long)arg;
+	uint64_t		 key;
+
+	while (!__atomic_load_n(&hh_test_stop, __ATOMIC_ACQUIRE)) {
+		key = __atomic_load_n(&hh_test_keys[rand_r(&seed) % HH_TEST_NR],
+				      __ATOMIC_ACQUIRE);
+		hlink = daos_hhash_link_lookup(hh_test_hash, key);
+		if (hlink == NULL)
+			continue;
+
+		rec = container_of(hlink, struct hh_test_rec, hr_hlink);
+		if (hlink->hl_key != key ||
+		    __atomic_load_n(&rec->hr_freed, __ATOMIC_ACQUIRE))
+			__atomic_add_fetch(&hh_test_errors, 1,
+					   __ATOMIC_RELAXED);
+		daos_hhash_link_putref(hh_test_hash, hlink);
+	}
+	return NULL;
+}
+
+static int
+hh_test(void)
+{
+	pthread_t	threads[HH_TEST_THREADS];
+	uint64_t	key;
+	int		nthreads;
+	int		rc;
+	int		i;
+	int		j;
+
+	rc = daos_hhash_create(DAOS_HHASH_BITS, &hh_test_hash);
+	if (rc != 0)
+		return rc;
+
+	for (i = 0; i < HH_TEST_NR; i++)
+		hh_test_insert(i);
+
+	/* stale, forged and mistyped keys */
+	key = hh_test_keys[0];
+	hh_test_delete(0);
+	hh_test_insert(0);
+	if (daos_hhash_link_lookup(hh_test_hash, key) != NULL ||
+	    daos_hhash_link_lookup(hh_test_hash, 0) != NULL ||
+	    daos_hhash_link_lookup(hh_test_hash,
+				   key & DAOS_HTYPE_MASK) != NULL ||
+	    daos_hhash_link_lookup(hh_test_hash,
+				   hh_test_keys[0] ^ DAOS_HTYPE_MASK) != NULL ||
+	    daos_hhash_link_lookup(hh_test_hash, -1ULL) != NULL ||
+	    daos_hhash_key_type(hh_test_keys[0]) != DAOS_HTYPE_OBJ) {
+		D__PRINT("invalid key is found\n");
+		D__GOTO(out, rc = -DER_INVAL);
+	}
+
+	for (nthreads = 0; nthreads < HH_TEST_THREADS; nthreads++) {
+		rc = pthread_create(&threads[nthreads], NULL, hh_test_reader,
+				    (void *)(unsigned long)nthreads);
+		if (rc != 0)
+			break;
+	}
+
+	for (j = 0; rc == 0 && j < 100; j++) {
+		for (i = 0; i < HH_TEST_NR; i++) {
+			hh_test_delete(i);
+			hh_test_insert(i);
+		}
+	}
+	__atomic_store_n(&hh_test_stop, true, __ATOMIC_RELEASE);
+	while (--nthreads >= 0)
+		pthread_join(threads[nthreads], NULL);
+	if (rc != 0)
+		D__GOTO(out, rc = daos_errno2der(rc));
+
+	if (hh_test_errors != 0) {
+		D__PRINT("%d lookups returned a deleted handle\n",
+			 hh_test_errors);
+		D__GOTO(out, rc = -DER_INVAL);
+	}
+	D__PRINT("%d handles reinserted %d times, with %d readers\n",
+		 HH_TEST_NR, j, HH_TEST_THREADS);
+out:
+	for (i = 0; i < HH_TEST_NR; i++)
+		daos_hhash_link_putref(hh_test_hash,
+				       &hh_test_recs[i].hr_hlink);
+	daos_hhash_destroy(hh_test_hash);
+	return rc;
+}
+
+int
+main(int argc, char **argv)
+{
+	uint32_t	feats[] = { DHASH_FT_NOLOCK, DHASH_FT_RWLOCK, 0 };
+	int		nr = HT_TEST_NR;
+	int		rc;
+	int		i;
+
+	rc = daos_debug_init(NULL);
+	if (rc != 0)
+		return rc;
+
+	while ((rc = getopt(argc, argv, "n:")) != -1) {
+		switch (rc) {
+		case 'n':
+			nr = atoi(optarg);
+			break;
+		default:
+			D__PRINT("Usage: %s [-n records]\n", argv[0]);
+			D__GOTO(out, rc = -DER_INVAL);
+		}
+	}
+
+	if (nr < 1000) {
+		D__PRINT("at least 1000 records\n");
+		D__GOTO(out, rc = -DER_INVAL);
+	}
+
+	for (i = 0; i < ARRAY_SIZE(feats); i++) {
+		rc = ht_test_one(feats[i], &ht_test_ops, nr);
+		if (rc != 0) {
+			D__PRINT("hash test feats %#x failed: %d\n", feats[i],
+				 rc);
+			D__GOTO(out, rc);
+		}
+	}
+
+	rc = ht_test_one(0, &ht_test_fixed_ops, nr / 16);
+	if (rc != 0) {
+		D__PRINT("hash test of fixed table failed: %d\n", rc);
+		D__GOTO(out, rc);
+	}
+
+	rc = hh_test();
+	if (rc != 0)
+		D__PRINT("handle hash test failed: %d\n", rc);
+out:
+	daos_debug_fini();
+	return rc;
+}
@@ -105,6 +105,60 @@ test_ref_hold(struct daos_lru_cache *cache,
 	return rc;
 }
 
+#define SCAN_KEY_BASE	(1ULL << 32)
+#define HOT_KEY_BASE	(1ULL << 33)
+
+/**
+ * Keys referenced more than once should survive a scan of many keys, which
+ * are referenced only once.
+ */
+static int
+test_scan_resist(struct daos_lru_cache *cache, unsigned int scan_nr)
+{
+	struct daos_llink	*link;
+	struct daos_lru_stats	*stats = &cache->dlc_stats;
+	unsigned int		 hot_nr = cache->dlc_csize / 2;
+	uint64_t		 key;
+	int			 i;
+	int			 rc;
+
+	for (i = 0; i < 2; i++) {
+		for (key = HOT_KEY_BASE; key < HOT_KEY_BASE + hot_nr; key++) {
+			rc = daos_lru_ref_hold(cache, &key, sizeof(key),
+					       (void *)1, &link);
+			if (rc)
+				return rc;
+			daos_lru_ref_release(cache, link);
+		}
+	}
+
+	/* a scan which holds each key twice without promoting */
+	for (i = 0; i < 2; i++) {
+		for (key = SCAN_KEY_BASE; key < SCAN_KEY_BASE + scan_nr;
+		     key++) {
+			rc = daos_lru_ref_hold_cold(cache, &key, sizeof(key),
+						    (void *)1, &link);
+			if (rc)
+				return rc;
+			daos_lru_ref_release(cache, link);
+		}
+	}
+
+	for (key = HOT_KEY_BASE; key < HOT_KEY_BASE + hot_nr; key++) {
+		rc = daos_lru_ref_hold(cache, &key, sizeof(key), NULL, &link);
+		if (rc) {
+			D__ERROR("Hot key "DF_U64" is evicted by scan\n", key);
+			return rc;
+		}
+		daos_lru_ref_release(cache, link);
+	}
+
+	D__PRINT("Scan resistance: hits "DF_U64", misses "DF_U64
+		 ", evictions "DF_U64", promotions "DF_U64"\n",
+		 stats->ls_hits, stats->ls_misses, stats->ls_evictions,
+		 stats->ls_promotions);
+	return 0;
+}
 
 int
 main(int argc, char **argv)
@@ -169,6 +223,8 @@ main(int argc, char **argv)
 	daos_lru_ref_release(tcache, link_ret[1]);
 	D__PRINT("Completed ref release for key: %"PRIu64"\n",
 		keys[1]);
+
+	rc = test_scan_resist(tcache, num_keys);
 exit:
 	daos_lru_cache_destroy(tcache);
 	if (keys)
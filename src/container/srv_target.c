@@ -174,6 +174,15 @@ cont_hdl_key_cmp(struct dhash_table *htable, daos_list_t *rlink,
 	return uuid_compare(hdl->sch_uuid, key) == 0;
 }
 
+static int
+cont_hdl_key_get(struct dhash_table *htable, daos_list_t *rlink, void **key_pp)
+{
+	struct ds_cont_hdl *hdl = cont_hdl_obj(rlink);
+
+	*key_pp = hdl->sch_uuid;
+	return sizeof(uuid_t);
+}
+
 static void
 cont_hdl_rec_addref(struct dhash_table *htable, daos_list_t *rlink)
 {
@@ -209,6 +218,7 @@ cont_hdl_rec_free(struct dhash_table *htable, daos_list_t *rlink)
 }
 
 static dhash_table_ops_t cont_hdl_hash_ops = {
+	.hop_key_get	= cont_hdl_key_get,
 	.hop_key_cmp	= cont_hdl_key_cmp,
 	.hop_rec_addref	= cont_hdl_rec_addref,
 	.hop_rec_decref	= cont_hdl_rec_decref,
@@ -910,16 +920,40 @@ set_container_purged_epoch(daos_handle_t vos_chdl,
 			    NULL, &finish);
 }
 
+/** coalesce record extents of an aggregated object */
+static int
+cont_epoch_coalesce_obj(daos_handle_t vos_chdl, daos_unit_oid_t oid,
+			daos_epoch_range_t *epr, unsigned int credits)
+{
+	vos_purge_anchor_t	anchor;
+	bool			finish = false;
+	int			rc;
+
+	memset(&anchor, 0, sizeof(anchor));
+	while (true) {
+		unsigned int	l_credits = credits;
+
+		rc = vos_epoch_coalesce(vos_chdl, oid, epr, &l_credits,
+					&anchor, &finish);
+		if (rc != 0 || finish)
+			return rc;
+		/* low priority, let other ULTs of the xstream run */
+		ABT_thread_yield();
+	}
+}
+
 static int
 cont_epoch_aggregate_one(void *vin)
 {
 	struct cont_tgt_epoch_aggregate_in	*in  = vin;
 	unsigned int				credits;
+	unsigned int				coalesce_credits = 0;
 	vos_iter_param_t			param;
 	struct ds_pool_child			*pool_child;
 	daos_handle_t				iter_hdl;
 	daos_handle_t				vos_chdl;
 	char					*purge_credits;
+	char					*coalesce;
 	char					*opstr;
 	int					aggregated;
 	int					found;
@@ -931,6 +965,14 @@ cont_epoch_aggregate_one(void *vin)
 	if (credits == 0)
 		credits = DAOS_PURGE_CREDITS_MAX;
 
+	coalesce = getenv("DAOS_COALESCE");
+	if (coalesce == NULL || strcasecmp(coalesce, "no") != 0) {
+		coalesce = getenv("DAOS_COALESCE_CREDITS");
+		coalesce_credits = daos_env2uint(coalesce);
+		if (coalesce_credits == 0)
+			coalesce_credits = DAOS_PURGE_CREDITS_MAX;
+	}
+
 	pool_child = ds_pool_child_lookup(in->tai_pool_uuid);
 	if (pool_child == NULL) {
 		D__ERROR(DF_CONT": pool child is NULL\n",
@@ -957,6 +999,8 @@ cont_epoch_aggregate_one(void *vin)
 	param.ip_hdl	    = vos_chdl;
 	param.ip_epr.epr_lo = in->tai_start_epoch;
 	param.ip_epr.epr_hi = in->tai_end_epoch;
+	/* only visit objects modified since the last aggregation */
+	param.ip_flags	    = VOS_IT_OBJ_DIRTY;
 
 	opstr = "preparing vos obj iterator ";
 	rc = vos_iter_prepare(VOS_ITER_OBJ, &param, &iter_hdl);
@@ -1030,6 +1074,16 @@ cont_epoch_aggregate_one(void *vin)
 			ABT_thread_yield();
 		}
 		aggregated++;
+
+		if (coalesce_credits != 0) {
+			rc = cont_epoch_coalesce_obj(vos_chdl, ent.ie_oid,
+						     &param.ip_epr,
+						     coalesce_credits);
+			/* coalescing is an optimization, keep aggregating */
+			if (rc != 0)
+				D__ERROR("failed to coalesce "DF_UOID": %d\n",
+					 DP_UOID(ent.ie_oid), rc);
+		}
 		opstr = "iter next with vos obj iterator";
 		rc = vos_iter_next(iter_hdl);
 	}
@@ -1090,6 +1144,9 @@ ds_cont_tgt_epoch_aggregate_aggregator(crt_rpc_t *source, crt_rpc_t *result,
 	return 0;
 }
 
+/** number of objects fetched from VOS at a time */
+#define CONT_OBJ_ITER_BATCH	16
+
 /* iterate all of objects of the container. */
 int
 ds_cont_obj_iter(daos_handle_t ph, uuid_t co_uuid,
@@ -1098,6 +1155,7 @@ ds_cont_obj_iter(daos_handle_t ph, uuid_t co_uuid,
 	vos_iter_param_t param;
 	daos_handle_t	 iter_h;
 	daos_handle_t	 coh;
+	bool		 end;
 	int		 rc;
 
 	rc = vos_cont_open(ph, co_uuid, &coh);
@@ -1127,31 +1185,31 @@ ds_cont_obj_iter(daos_handle_t ph, uuid_t co_uuid,
 		D__GOTO(iter_fini, rc);
 	}
 
-	while (1) {
-		vos_iter_entry_t ent;
+	do {
+		vos_iter_entry_t	ents[CONT_OBJ_ITER_BATCH];
+		unsigned int		nr = CONT_OBJ_ITER_BATCH;
+		int			i;
 
-		rc = vos_iter_fetch(iter_h, &ent, NULL);
-		if (rc != 0) {
-			/* reach to the end of the container */
-			if (rc == -DER_NONEXIST)
-				rc = 0;
-			else
-				D__ERROR("Fetch obj failed: %d\n", rc);
+		rc = vos_iter_fetch_batch(iter_h, ents, NULL, &nr);
+		if (rc != 0 && rc != -DER_NONEXIST) {
+			D__ERROR("Fetch obj failed: %d\n", rc);
 			break;
 		}
+		end = rc == -DER_NONEXIST;
+
+		for (i = 0, rc = 0; i < nr && rc == 0; i++) {
+			rc = callback(co_uuid, ents[i].ie_oid, arg);
+			D__DEBUG(DB_ANY, "iter "DF_UOID" rc: %d\n",
+				DP_UOID(ents[i].ie_oid), rc);
+		}
 
-		rc = callback(co_uuid, ent.ie_oid, arg);
 		if (rc) {
 			if (rc > 0)
 				rc = 0;
 			break;
 		}
-
-		D__DEBUG(DB_ANY, "iter "DF_UOID" rc: %d\n",
-			DP_UOID(ent.ie_oid), rc);
-
-		vos_iter_next(iter_h);
-	}
+		/* reach to the end of the container */
+	} while (!end);
 
 iter_fini:
 	vos_iter_finish(iter_h);
@@ -40,6 +40,4 @@ int dac_array_set_size(tse_task_t *task);
 int dac_kv_get(tse_task_t *task);
 int dac_kv_put(tse_task_t *task);
 int dac_kv_remove(tse_task_t *task);
-int dac_obj_fetch_multi(tse_task_t *task);
-int dac_obj_update_multi(tse_task_t *task);
 #endif /* __DAOS_ADDONS_H__ */
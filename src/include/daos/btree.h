@@ -64,10 +64,16 @@ struct btr_record {
 	 * Fix-size key can be stored in if it is small enough (DAOS_HKEY_MAX),
 	 * or hashed key for variable-length/large key. In the later case,
 	 * the hashed key can be used for efficient comparison.
+	 *
+	 * Trees with BTR_FEAT_REC_INLINE also store the record body right
+	 * after the hashed key, see btr_ops_t::to_rec_inline_size.
 	 */
 	char			rec_hkey[0];
 };
 
+/** the largest record body which can be stored inline */
+#define BTR_REC_INLINE_MAX	96
+
 /**
  * Tree node.
  *
@@ -80,7 +86,10 @@ struct btr_node {
 	uint16_t			tn_keyn;
 	/** padding bytes */
 	uint32_t			tn_pad_32;
-	/** generation, reserved for COW */
+	/**
+	 * generation of the tree when this node was allocated, the node is
+	 * copied on write if a pinned snapshot is not older than it.
+	 */
 	uint64_t			tn_gen;
 	/** the first child, it is unused on leaf node */
 	TMMID(struct btr_node)		tn_child;
@@ -88,6 +97,38 @@ struct btr_node {
 	struct btr_record		tn_recs[0];
 };
 
+/**
+ * Tree feature bits, they are stored in btr_root::tr_feats. A tree class
+ * registers all the features it can support, and a tree can be created
+ * with a subset of them.
+ */
+enum btr_feats {
+	/**
+	 * The first 8 bytes of the hashed key is a native uint64_t, and
+	 * records are ordered by this prefix before anything else. The
+	 * customized to_hkey_cmp is only called to resolve ties of the prefix,
+	 * so probe can search a node without calling it at each step.
+	 *
+	 * NB: hashed key size must be at least 8 bytes.
+	 */
+	BTR_FEAT_HKEY_PREFIX		= (1 << 0),
+	/**
+	 * Each record reserves to_rec_inline_size() bytes after the hashed
+	 * key, so small values can be stored in the leaf node itself instead
+	 * of a separately allocated body. The tree class sets rec_mmid to
+	 * UMMID_NULL for such records, so dbtree never calls to_rec_free()
+	 * for them.
+	 */
+	BTR_FEAT_REC_INLINE		= (1 << 1),
+	/**
+	 * Record bodies hold subtrees, to_rec_update() only returns or punches
+	 * the subtree and never changes the body, so records are updated in
+	 * place instead of being replaced while the tree has snapshots, see
+	 * dbtree_snapshot().
+	 */
+	BTR_FEAT_REC_SUBTREE		= (1 << 2),
+};
+
 enum {
 	BTR_ORDER_MIN			= 3,
 	BTR_ORDER_MAX			= 4096
@@ -111,7 +152,10 @@ struct btr_root {
 	uint32_t			tr_class;
 	/** the actual features of the tree, e.g. hash type, integer key */
 	uint64_t			tr_feats;
-	/** generation, reserved for COW */
+	/**
+	 * generation of the tree, it is bumped by each snapshot, see
+	 * dbtree_snapshot.
+	 */
 	uint64_t			tr_gen;
 	/** pointer to the root node, it is NULL for an empty tree */
 	TMMID(struct btr_node)		tr_node;
@@ -175,6 +219,15 @@ typedef struct {
 	 *			and memory class etc.
 	 */
 	int		(*to_hkey_size)(struct btr_instance *tins);
+	/**
+	 * Optional, mandatory for tree class supports BTR_FEAT_REC_INLINE:
+	 * Size of the inline record body stored after the hashed key, it
+	 * cannot exceed BTR_REC_INLINE_MAX.
+	 *
+	 * \param tins	[IN]	Tree instance which contains the root mmid
+	 *			and memory class etc.
+	 */
+	int		(*to_rec_inline_size)(struct btr_instance *tins);
 	/**
 	 * Optional:
 	 * Comparison of hashed key.
@@ -231,6 +284,11 @@ typedef struct {
 	 *			Optional: opaque buffer for providing arguments
 	 *			to handle special cases for free. for example,
 	 *			to return the freed record to the user
+	 * \a return	0	success.
+	 *		-DER_BUSY
+	 *			the body holds a subtree which has snapshots,
+	 *			it must be kept, the deletion or destroy fails.
+	 *		-ve	error code
 	 */
 	int		(*to_rec_free)(struct btr_instance *tins,
 				       struct btr_record *rec, void *args);
@@ -425,13 +483,18 @@ int  dbtree_open_inplace(struct btr_root *root, struct umem_attr *uma,
 int  dbtree_close(daos_handle_t toh);
 int  dbtree_destroy(daos_handle_t toh);
 int  dbtree_update(daos_handle_t toh, daos_iov_t *key, daos_iov_t *val);
+int  dbtree_update_batch(daos_handle_t toh, unsigned int nr,
+			 daos_iov_t *keys, daos_iov_t *vals);
 int  dbtree_fetch(daos_handle_t toh, dbtree_probe_opc_t opc,
 		  daos_iov_t *key, daos_iov_t *key_out, daos_iov_t *val_out);
 int  dbtree_lookup(daos_handle_t toh, daos_iov_t *key, daos_iov_t *val_out);
 int  dbtree_delete(daos_handle_t toh, daos_iov_t *key, void *args);
+int  dbtree_delete_range(daos_handle_t toh, daos_iov_t *key_lo,
+			 daos_iov_t *key_hi, void *args);
 int  dbtree_query(daos_handle_t toh, struct btr_attr *attr,
 		  struct btr_stat *stat);
 int  dbtree_is_empty(daos_handle_t toh);
+int  dbtree_snapshot(daos_handle_t toh, daos_handle_t *snap_toh);
 
 /******* iterator API ******************************************************/
 
@@ -0,0 +1,115 @@
+/**
+ * (C) Copyright 2017 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * GOVERNMENT LICENSE RIGHTS-OPEN SOURCE SOFTWARE
+ * The Government's rights to use, modify, reproduce, release, perform, display,
+ * or disclose this software are subject to the terms of the Apache License as
+ * provided in Contract No. B609815.
+ * Any reproduction of computer software, computer software documentation, or
+ * portions thereof marked with this legend must also reproduce the markings.
+ */
+/**
+ * Data checksums of VOS records: CRC32C (Castagnoli) and CRC64 (ECMA-182,
+ * reflected, as used by xz).
+ *
+ * Both checksums can be computed incrementally: the checksum of the
+ * concatenation of two buffers is the checksum of the second one started
+ * from the checksum of the first one, so data can be checksummed piece by
+ * piece while it is received.
+ */
+
+#ifndef __DAOS_CSUM_H__
+#define __DAOS_CSUM_H__
+
+#include <daos/common.h>
+
+/** Checksum types, stored in the cs_type of records */
+enum daos_csum_type {
+	DAOS_CSUM_NONE		= 0,
+	DAOS_CSUM_CRC32C	= 1,
+	DAOS_CSUM_CRC64		= 2,
+};
+
+/** Implementations of the CRC kernels */
+enum daos_csum_kernel {
+	/** the fastest one supported by the CPU */
+	DAOS_CSUM_KERNEL_AUTO,
+	/** portable C, slicing-by-8 tables */
+	DAOS_CSUM_KERNEL_C,
+	/** crc32 instruction of SSE4.2 for CRC32C, PCLMULQDQ folding for CRC64 */
+	DAOS_CSUM_KERNEL_HW,
+};
+
+/**
+ * Update the checksum \a crc with \a len bytes of \a buf, \a crc should be
+ * zero for the first buffer.
+ */
+uint32_t daos_crc32c(uint32_t crc, const void *buf, daos_size_t len);
+uint64_t daos_crc64(uint64_t crc, const void *buf, daos_size_t len);
+
+/**
+ * Return the checksum type of \a name, e.g. "crc32c" or "crc64", or
+ * DAOS_CSUM_NONE if it is not supported.
+ */
+int daos_csum_name2type(const char *name);
+const char *daos_csum_type2name(int type);
+/** Size in bytes of the checksum \a type */
+int daos_csum_type2size(int type);
+
+/** Checksum being computed */
+struct daos_csum_ctx {
+	/** enum daos_csum_type */
+	int			cc_type;
+	/** number of bytes checksummed */
+	daos_size_t		cc_len;
+	uint64_t		cc_val;
+};
+
+static inline void
+daos_csum_init(struct daos_csum_ctx *ctx, int type)
+{
+	ctx->cc_type = type;
+	ctx->cc_len = 0;
+	ctx->cc_val = 0;
+}
+
+/** Add \a len bytes of \a buf to the checksum */
+void daos_csum_update(struct daos_csum_ctx *ctx, const void *buf,
+		      daos_size_t len);
+
+/** Add the data of the first \a nr iovs of \a sgl to the checksum */
+void daos_csum_update_sgl(struct daos_csum_ctx *ctx, daos_sg_list_t *sgl,
+			  unsigned int nr);
+
+/**
+ * Store the checksum to \a csum, the buffer of \a csum should be large
+ * enough for the checksum type of \a ctx.
+ */
+void daos_csum_final(struct daos_csum_ctx *ctx, daos_csum_buf_t *csum);
+
+/**
+ * Compare the checksum of \a ctx with \a csum.
+ *
+ * \return		0 if they match, -DER_IO otherwise.
+ */
+int daos_csum_verify(struct daos_csum_ctx *ctx, daos_csum_buf_t *csum);
+
+/**
+ * Select the CRC kernels, it is mostly for testing and benchmarks.
+ * Returns -DER_NOSYS if the kernel is not supported by the CPU.
+ */
+int daos_csum_kernel_set(enum daos_csum_kernel kernel);
+
+#endif /* __DAOS_CSUM_H__ */
@@ -0,0 +1,91 @@
+/**
+ * (C) Copyright 2017 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * GOVERNMENT LICENSE RIGHTS-OPEN SOURCE SOFTWARE
+ * The Government's rights to use, modify, reproduce, release, perform, display,
+ * or disclose this software are subject to the terms of the Apache License as
+ * provided in Contract No. B609815.
+ * Any reproduction of computer software, computer software documentation, or
+ * portions thereof marked with this legend must also reproduce the markings.
+ */
+/**
+ * Reed-Solomon erasure code over GF(2^8), it is used by object classes with
+ * DAOS_RES_EC resilience.
+ *
+ * A codec has \a k data cells and \a p parity cells, the code is systematic
+ * and it works on bytes, so any byte range of the cells can be encoded or
+ * reconstructed independently as long as the same range is used for all of
+ * them.
+ */
+
+#ifndef __DAOS_EC_H__
+#define __DAOS_EC_H__
+
+#include <daos/common.h>
+
+/** Maximum number of cells (data + parity) of a codec */
+#define DAOS_EC_CELL_MAX	32
+
+/** Implementations of the GF(2^8) vector kernel */
+enum daos_ec_kernel {
+	/** the fastest one supported by the CPU */
+	DAOS_EC_KERNEL_AUTO,
+	/** portable C */
+	DAOS_EC_KERNEL_C,
+	/** 16 bytes per instruction, split table lookup by pshufb */
+	DAOS_EC_KERNEL_SSSE3,
+	/** 32 bytes per instruction */
+	DAOS_EC_KERNEL_AVX2,
+};
+
+struct daos_ec_codec;
+
+/**
+ * Create a codec with \a k data cells and \a p parity cells.
+ */
+int daos_ec_codec_create(unsigned int k, unsigned int p,
+			 struct daos_ec_codec **codec_p);
+void daos_ec_codec_destroy(struct daos_ec_codec *codec);
+
+/**
+ * Compute \a len bytes of each of the parity cells from the data cells.
+ *
+ * \param data	[IN]	array of \a k data buffers
+ * \param parity [OUT]	array of \a p parity buffers
+ */
+void daos_ec_encode(struct daos_ec_codec *codec, daos_size_t len,
+		    unsigned char **data, unsigned char **parity);
+
+/**
+ * Reconstruct the cells in the \a lost bitmap from \a k surviving cells.
+ *
+ * \param cells	[IN/OUT] array of \a k + \a p buffers, data cells first.
+ *			A cell is used as input if it is not NULL and not in
+ *			\a lost, the buffers of the lost cells are filled.
+ * \param lost	[IN]	bitmap of the cells to reconstruct
+ *
+ * \return		0 on success, -DER_IO if there are less than \a k
+ *			surviving cells.
+ */
+int daos_ec_decode(struct daos_ec_codec *codec, daos_size_t len,
+		   unsigned char **cells, uint32_t lost);
+
+/**
+ * Select the GF(2^8) kernel, it is mostly for testing and benchmarks.
+ * Returns -DER_NOSYS if the kernel is not supported by the CPU.
+ */
+int daos_ec_kernel_set(enum daos_ec_kernel kernel);
+
+#endif /* __DAOS_EC_H__ */
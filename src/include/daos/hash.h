@@ -126,8 +126,27 @@ enum dhash_feats {
 	 * within hop_addref/decref, because RW lock can't protect refcount.
 	 */
 	DHASH_FT_RWLOCK		= (1 << 1),
+	/**
+	 * The number of buckets is fixed at creation.
+	 *
+	 * By default, a hash table which provides hop_key_get() doubles its
+	 * buckets when the average chain is longer than DHASH_LOAD_MAX, and
+	 * halves them (but never below the creation size) when it is shorter
+	 * than 1/DHASH_LOAD_MIN. Records are moved to the new buckets by the
+	 * subsequent insert and delete, see DHASH_REHASH_STEP.
+	 */
+	DHASH_FT_NORESIZE	= (1 << 2),
 };
 
+/** grow the hash table if there are more records than buckets * this */
+#define DHASH_LOAD_MAX		2
+/** shrink the hash table if there are less records than buckets / this */
+#define DHASH_LOAD_MIN		8
+/** the hash table never grows beyond power2(DHASH_BITS_MAX) buckets */
+#define DHASH_BITS_MAX		26
+/** number of old buckets rehashed by each insert or delete */
+#define DHASH_REHASH_STEP	4
+
 /** a hash bucket */
 struct dhash_bucket {
 	daos_list_t		hb_head;
@@ -144,15 +163,21 @@ struct dhash_table {
 	};
 	/** bits to generate number of buckets */
 	unsigned int		 ht_bits;
+	/** the table never shrinks below the bits of creation */
+	unsigned int		 ht_min_bits;
+	/** bits of the old buckets being rehashed */
+	unsigned int		 ht_old_bits;
+	/** old buckets below this index have been rehashed */
+	unsigned int		 ht_rehash_idx;
 	/** feature bits */
 	unsigned int		 ht_feats;
+	/** total number of hash records */
+	unsigned int		 ht_nr;
 #if DHASH_DEBUG
 	/** maximum search depth ever */
 	unsigned int		 ht_dep_max;
 	/** maximum number of hash records */
 	unsigned int		 ht_nr_max;
-	/** total number of hash records */
-	unsigned int		 ht_nr;
 #endif
 	/** private data to pass into customized functions */
 	void			*ht_priv;
@@ -160,6 +185,8 @@ struct dhash_table {
 	dhash_table_ops_t	*ht_ops;
 	/** array of buckets */
 	struct dhash_bucket	*ht_buckets;
+	/** buckets before resizing, NULL if there is no rehash in progress */
+	struct dhash_bucket	*ht_old_buckets;
 };
 
 
@@ -232,6 +259,11 @@ struct daos_ulink {
 	struct daos_ulink_ops	*ul_ops;
 };
 
+/**
+ * Handle table, the key of a record is an index of the table plus a
+ * generation, so lookup takes no lock, see common/hash.c for the details.
+ * Refcounts of records are atomic.
+ */
 struct daos_hhash;
 
 int  daos_hhash_create(unsigned int bits, struct daos_hhash **hhash);
@@ -52,6 +52,8 @@ struct daos_llink {
 	unsigned int		ll_ref:30;
 	/** has been evicted */
 	unsigned int		ll_evicted:1;
+	/** has been referenced more than once, it is on the hot list */
+	unsigned int		ll_hot:1;
 	/**
 	 * ops to allocate and free reference
 	 * for this llink.
@@ -59,9 +61,33 @@ struct daos_llink {
 	struct daos_llink_ops	*ll_ops;
 };
 
+/** statistics of LRU cache */
+struct daos_lru_stats {
+	/** lookups which found the item in the cache */
+	uint64_t		ls_hits;
+	/** lookups which missed the cache */
+	uint64_t		ls_misses;
+	/** idle items evicted because the cache is full */
+	uint64_t		ls_evictions;
+	/** items promoted to the hot list */
+	uint64_t		ls_promotions;
+};
+
+/**
+ * Percentage of the cache can be used by hot idle items, the rest is left
+ * for items which have only been referenced once.
+ */
+#define DAOS_LRU_HOT_PCT	75
+
 /**
- * LRU cache implementation using dhash_table
- * and daos_list_t
+ * LRU cache implementation using dhash_table and daos_list_t.
+ *
+ * It is a scan-resistant 2Q cache: a new item starts on the cold list, it
+ * is promoted to the hot list when it is found in the cache again. Idle
+ * items are evicted from the tail of the cold list first, so a single pass
+ * over many items, e.g. aggregation or rebuild scan, can only flush other
+ * cold items. The hot list is LRU and capped by DAOS_LRU_HOT_PCT, items
+ * beyond the cap are demoted to the cold list.
  */
 struct daos_lru_cache {
 	/* Provided cache size */
@@ -70,10 +96,16 @@ struct daos_lru_cache {
 	uint32_t		dlc_idle_nr;
 	/* # busy items in the LRU (referenced by caller) */
 	uint32_t		dlc_busy_nr;
-	/* Queue head, holds idle refs (no refcnt) */
+	/** # idle items on the hot list */
+	uint32_t		dlc_hot_nr;
+	/* Queue head, holds idle refs which are referenced once (no refcnt) */
 	daos_list_t		dlc_idle_list;
+	/** Queue head, holds idle refs which are referenced again */
+	daos_list_t		dlc_hot_list;
 	/** list head of busy items in the LRU */
 	daos_list_t		dlc_busy_list;
+	/** statistics */
+	struct daos_lru_stats	dlc_stats;
 	/* Holds all refs but needs lookup */
 	struct dhash_table	dlc_htable;
 	/* ops to allocate and free reference */
@@ -107,6 +139,17 @@ daos_lru_cache_create(int bits, uint32_t feats,
 void
 daos_lru_cache_destroy(struct daos_lru_cache *lcache);
 
+/**
+ * Change size of the cache, idle items are evicted if the cache has more
+ * items than the new size.
+ *
+ * \param lcache	[IN]	DAOS LRU cache
+ * \param size		[IN]	New number of items, zero disables caching
+ *				of idle items.
+ */
+void
+daos_lru_cache_resize(struct daos_lru_cache *lcache, uint32_t size);
+
 typedef bool (*daos_lru_cond_cb_t)(struct daos_llink *llink, void *args);
 
 /**
@@ -140,6 +183,16 @@ int
 daos_lru_ref_hold(struct daos_lru_cache *lcache, void *key, unsigned int ksize,
 		  void *create_args, struct daos_llink **rlink);
 
+/**
+ * Same as daos_lru_ref_hold, but the item is not promoted to the hot list
+ * if it is found in the cache. It should be used by background scans which
+ * touch many items only once.
+ */
+int
+daos_lru_ref_hold_cold(struct daos_lru_cache *lcache, void *key,
+		       unsigned int ksize, void *create_args,
+		       struct daos_llink **rlink);
+
 /**
  * Release a reference from the cache and maintain a idle LRU list
  *
@@ -116,6 +116,11 @@ typedef enum {
 	UMEM_CLASS_VMEM,
 	/** persistent memory */
 	UMEM_CLASS_PMEM,
+	/**
+	 * volatile memory allocated from per-thread slabs, it has no lock,
+	 * so it is supposed to be used by service xstreams.
+	 */
+	UMEM_CLASS_VMEM_SLAB,
 	/** unknown */
 	UMEM_CLASS_UNKNOWN,
 } umem_class_id_t;
@@ -230,6 +235,29 @@ struct umem_instance {
 int  umem_class_init(struct umem_attr *uma, struct umem_instance *umm);
 void umem_attr_get(struct umem_instance *umm, struct umem_attr *uma);
 
+/** number of size classes of UMEM_CLASS_VMEM_SLAB, including the large one */
+#define UMEM_SLAB_CLASS_MAX	17
+
+/** usage counters of a size class of UMEM_CLASS_VMEM_SLAB */
+struct umem_slab_stat {
+	/** object size of the class, 0 for objects larger than all classes */
+	size_t		ss_size;
+	/** number of allocations */
+	uint64_t	ss_alloc;
+	/**
+	 * number of frees, objects freed by other threads are counted once
+	 * they are returned to the slab, large objects as soon as they are
+	 * freed. They are always counted by the allocating thread.
+	 */
+	uint64_t	ss_free;
+	/** number of free objects cached by the slab */
+	uint64_t	ss_cached;
+	/** bytes of chunks held by the slab, large objects are not counted */
+	uint64_t	ss_mem;
+};
+
+int  umem_slab_query(struct umem_slab_stat *stats, int nr);
+
 enum {
 	UMEM_TYPE_ANY,
 };
@@ -0,0 +1,242 @@
+/**
+ * (C) Copyright 2017 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * GOVERNMENT LICENSE RIGHTS-OPEN SOURCE SOFTWARE
+ * The Government's rights to use, modify, reproduce, release, perform, display,
+ * or disclose this software are subject to the terms of the Apache License as
+ * provided in Contract No. B609815.
+ * Any reproduction of computer software, computer software documentation, or
+ * portions thereof marked with this legend must also reproduce the markings.
+ */
+/**
+ * Lightweight metrics of the server hot paths: counters, gauges and
+ * log-linear histograms.
+ *
+ * Each thread owns a private set of metrics, so nothing is shared or locked
+ * on the hot path. A thread has no metrics until daos_metrics_init() is
+ * called on it, the server does it for each xstream, so the instrumented
+ * code of the common libraries only costs a TLS load on clients.
+ * daos_metrics_merge() sums the metrics of all threads on demand.
+ */
+
+#ifndef __DAOS_METRICS_H__
+#define __DAOS_METRICS_H__
+
+#include <time.h>
+#include <daos/common.h>
+#include <daos/list.h>
+
+/** Counters */
+enum daos_metric_cnt {
+	/** object update RPCs */
+	DMC_OBJ_UPDATE,
+	/** object fetch RPCs */
+	DMC_OBJ_FETCH,
+	/** bytes moved by bulk transfers */
+	DMC_BULK_BYTES,
+	/** lookups of the VOS object cache which hit */
+	DMC_VOS_OBJ_HIT,
+	/** lookups of the VOS object cache which miss */
+	DMC_VOS_OBJ_MISS,
+	/** objects evicted from the full VOS object cache */
+	DMC_VOS_OBJ_EVICT,
+	/** entries appended to the RDB log */
+	DMC_RDB_APPEND,
+	/** objects aggregated or discarded */
+	DMC_AGG_OBJ,
+	/** records rebuilt */
+	DMC_REBUILD_REC,
+	/** bytes of VOS files allocated and formatted for new pools */
+	DMC_POOL_FORMAT_BYTES,
+	/** record extents removed by coalescing */
+	DMC_VOS_COALESCE,
+	DMC_NR,
+};
+
+/** Gauges */
+enum daos_metric_gauge {
+	/** object RPCs being handled */
+	DMG_OBJ_INFLIGHT,
+	/** dkeys being rebuilt */
+	DMG_REBUILD_INFLIGHT,
+	/** VOS files being allocated and formatted for new pools */
+	DMG_POOL_FORMAT,
+	/** VOS files of destroyed pools being removed */
+	DMG_POOL_DESTROY,
+	DMG_NR,
+};
+
+/** Histograms, latencies are in nanoseconds */
+enum daos_metric_hist {
+	/** handling of object update RPC */
+	DMH_OBJ_UPDATE,
+	/** handling of object fetch RPC */
+	DMH_OBJ_FETCH,
+	/** bulk transfer */
+	DMH_BULK,
+	/** vos_obj_update() */
+	DMH_VOS_UPDATE,
+	/** vos_obj_fetch() */
+	DMH_VOS_FETCH,
+	/** number of tree levels visited by a dbtree probe */
+	DMH_BTR_PROBE_DEPTH,
+	/** rdb_raft_append_apply() */
+	DMH_RDB_APPEND,
+	/** one pass of aggregation or discard */
+	DMH_AGG,
+	/** rebuild of a dkey */
+	DMH_REBUILD_DKEY,
+	/** number of updates committed by a group commit */
+	DMH_OBJ_GROUP_COMMIT,
+	/** wait of an update for its group commit */
+	DMH_OBJ_GROUP_WAIT,
+	/** one pass of extent coalescing */
+	DMH_VOS_COALESCE,
+	DMH_NR,
+};
+
+/**
+ * Log-linear histogram: values below 2 * DAOS_HIST_SUB_NR have their own
+ * bucket, each power of two above is split into DAOS_HIST_SUB_NR buckets,
+ * so the relative error is below 1 / DAOS_HIST_SUB_NR.
+ */
+#define DAOS_HIST_SUB_BITS	4
+#define DAOS_HIST_SUB_NR	(1 << DAOS_HIST_SUB_BITS)
+/** values from 2^DAOS_HIST_MAX_BITS (about 18 minutes in ns) share a bucket */
+#define DAOS_HIST_MAX_BITS	40
+#define DAOS_HIST_BUCKETS	\
+	((DAOS_HIST_MAX_BITS - DAOS_HIST_SUB_BITS + 1) * DAOS_HIST_SUB_NR)
+
+struct daos_hist {
+	uint64_t		h_count;
+	uint64_t		h_sum;
+	uint64_t		h_max;
+	uint64_t		h_buckets[DAOS_HIST_BUCKETS];
+};
+
+struct daos_metrics {
+	uint64_t		dm_cnts[DMC_NR];
+	int64_t			dm_gauges[DMG_NR];
+	struct daos_hist	dm_hists[DMH_NR];
+	/** link on the list of all threads, unused by merged metrics */
+	daos_list_t		dm_link;
+};
+
+/** metrics of the current thread, NULL if it has no metrics */
+extern __thread struct daos_metrics *daos_metrics_tls;
+
+static inline unsigned int
+daos_hist_bucket(uint64_t val)
+{
+	unsigned int	bits;
+
+	if (val < 2 * DAOS_HIST_SUB_NR)
+		return val;
+
+	bits = 63 - __builtin_clzll(val);
+	if (bits >= DAOS_HIST_MAX_BITS)
+		return DAOS_HIST_BUCKETS - 1;
+
+	return (bits - DAOS_HIST_SUB_BITS + 1) * DAOS_HIST_SUB_NR +
+	       ((val >> (bits - DAOS_HIST_SUB_BITS)) & (DAOS_HIST_SUB_NR - 1));
+}
+
+static inline void
+daos_metric_inc(enum daos_metric_cnt id, uint64_t val)
+{
+	struct daos_metrics *dm = daos_metrics_tls;
+
+	if (dm != NULL)
+		dm->dm_cnts[id] += val;
+}
+
+static inline void
+daos_metric_gauge_add(enum daos_metric_gauge id, int64_t delta)
+{
+	struct daos_metrics *dm = daos_metrics_tls;
+
+	if (dm != NULL)
+		dm->dm_gauges[id] += delta;
+}
+
+static inline void
+daos_hist_record(struct daos_hist *hist, uint64_t val)
+{
+	hist->h_count++;
+	hist->h_sum += val;
+	if (val > hist->h_max)
+		hist->h_max = val;
+	hist->h_buckets[daos_hist_bucket(val)]++;
+}
+
+static inline void
+daos_metric_record(enum daos_metric_hist id, uint64_t val)
+{
+	struct daos_metrics *dm = daos_metrics_tls;
+
+	if (dm != NULL)
+		daos_hist_record(&dm->dm_hists[id], val);
+}
+
+/** Monotonic clock in nanoseconds */
+static inline uint64_t
+daos_metric_clock(void)
+{
+	struct timespec	ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/**
+ * Start a latency sample, it returns zero if the thread has no metrics so
+ * the clock is not read at all.
+ */
+static inline uint64_t
+daos_metric_tick(void)
+{
+	return daos_metrics_tls == NULL ? 0 : daos_metric_clock();
+}
+
+/** Record the latency since \a start returned by daos_metric_tick() */
+static inline void
+daos_metric_tock(enum daos_metric_hist id, uint64_t start)
+{
+	if (start != 0)
+		daos_metric_record(id, daos_metric_tick() - start);
+}
+
+/** Enable metrics on the current thread, \a dm is owned by the caller */
+void daos_metrics_init(struct daos_metrics *dm);
+void daos_metrics_fini(struct daos_metrics *dm);
+
+/**
+ * Sum the metrics of all threads into \a dm. Metrics of other threads are
+ * read without synchronization, so the result is not a precise snapshot.
+ */
+void daos_metrics_merge(struct daos_metrics *dm);
+
+/** Add the samples of \a src to \a dst */
+void daos_hist_merge(struct daos_hist *dst, struct daos_hist *src);
+/** Lowest value of the bucket \a idx */
+uint64_t daos_hist_bucket_lo(unsigned int idx);
+/** Approximate value at \a pct percent of the samples */
+uint64_t daos_hist_percentile(struct daos_hist *hist, double pct);
+
+const char *daos_metric_cnt_name(enum daos_metric_cnt id);
+const char *daos_metric_gauge_name(enum daos_metric_gauge id);
+const char *daos_metric_hist_name(enum daos_metric_hist id);
+
+#endif /* __DAOS_METRICS_H__ */
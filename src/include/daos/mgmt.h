@@ -40,6 +40,21 @@ int dc_pool_destroy(tse_task_t *task);
 int dc_pool_evict(tse_task_t *task);
 int dc_pool_extend(tse_task_t *task);
 int dc_mgmt_params_set(tse_task_t *task);
+int dc_mgmt_metrics_query(tse_task_t *task);
+
+struct daos_metrics;
+
+/**
+ * Query the metrics of a server, see daos/metrics.h.
+ *
+ * \param grp	[IN]	Process set name of the DAOS servers
+ * \param rank	[IN]	Rank of the server to query
+ * \param metrics [OUT]	Merged metrics of all xstreams of the server
+ * \param ev	[IN]	Completion event, it is optional and can be NULL.
+ *			The function will run in blocking mode if \a ev is NULL.
+ */
+int daos_mgmt_metrics_query(const char *grp, d_rank_t rank,
+			    struct daos_metrics *metrics, daos_event_t *ev);
 
 /**
  * object layout information.
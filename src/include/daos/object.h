@@ -68,7 +68,10 @@ int dc_obj_punch_dkeys(tse_task_t *task);
 int dc_obj_punch_akeys(tse_task_t *task);
 int dc_obj_query(tse_task_t *task);
 int dc_obj_fetch(tse_task_t *task);
+int dc_obj_fetch_shard(tse_task_t *task);
 int dc_obj_update(tse_task_t *task);
+int dc_obj_fetch_multi(tse_task_t *task);
+int dc_obj_update_multi(tse_task_t *task);
 int dc_obj_list_dkey(tse_task_t *task);
 int dc_obj_list_akey(tse_task_t *task);
 int dc_obj_list_rec(tse_task_t *task);
@@ -612,24 +612,36 @@ daos_obj_class_list(daos_handle_t coh, daos_oclass_list_t *clist,
  *		[OUT]	Fully populated DAOS object identifier with the the low
  *			96 bits untouched and the DAOS private	bits (the high
  *			32 bits) encoded.
+ * \param ofeats [IN]	Object features, e.g. DAOS_OF_DKEY_UINT64.
  * \param cid	[IN]	Class Identifier
  */
 static inline void
-daos_obj_id_generate(daos_obj_id_t *oid, daos_oclass_id_t cid)
+daos_obj_id_generate_feat(daos_obj_id_t *oid, daos_ofeat_t ofeats,
+			  daos_oclass_id_t cid)
 {
 	uint64_t hdr = cid;
 
 	oid->hi &= 0x00000000ffffffff;
 	/**
-	 * | 8-bit version | 8-bit unused |
-	 * | 16-bit object class          |
-	 * | 96-bit for upper layer ...  |
+	 * | 8-bit version | 8-bit features |
+	 * | 16-bit object class            |
+	 * | 96-bit for upper layer ...    |
 	 */
 	hdr <<= 32;
+	hdr |= (uint64_t)ofeats << 48;
 	hdr |= 0x1ULL << 56;
 	oid->hi |= hdr;
 }
 
+/**
+ * Same as daos_obj_id_generate_feat(), without any object feature.
+ */
+static inline void
+daos_obj_id_generate(daos_obj_id_t *oid, daos_oclass_id_t cid)
+{
+	daos_obj_id_generate_feat(oid, 0, cid);
+}
+
 static inline daos_oclass_id_t
 daos_obj_id2class(daos_obj_id_t oid)
 {
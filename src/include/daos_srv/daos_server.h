@@ -30,6 +30,7 @@
 
 #include <daos/common.h>
 #include <daos/rpc.h>
+#include <daos/metrics.h>
 #include <daos_srv/iv.h>
 #include <daos_event.h>
 #include <daos_task.h>
@@ -130,6 +131,8 @@ struct dss_module_info {
 	int			dmi_tid;
 	tse_sched_t		dmi_sched;
 	uint64_t		dmi_tse_ult_created:1;
+	/** metrics of this xstream, see daos/metrics.h */
+	struct daos_metrics	dmi_metrics;
 };
 
 extern struct dss_module_key	daos_srv_modkey;
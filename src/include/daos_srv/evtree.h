@@ -62,6 +62,7 @@ struct evt_ptr {
 	umem_id_t			pt_mmid;
 	/** cookie to insert this extent */
 	uuid_t				pt_cookie;
+	/** checksum of the whole extent */
 	uint64_t			pt_csum;
 	/** number of indices */
 	uint64_t			pt_inum;
@@ -71,7 +72,9 @@ struct evt_ptr {
 	uint32_t			pt_ref;
 	/** Pool map version for the record */
 	uint32_t			pt_ver;
-	uint32_t			pt_pad_32;
+	/** checksum type and size of \a pt_csum, see daos/csum.h */
+	uint16_t			pt_cs_type;
+	uint16_t			pt_cs_len;
 	/** embedded payload for tiny extent */
 	char				pt_payload[EVT_PTR_PAYLOAD];
 };
@@ -155,11 +158,29 @@ struct evt_root {
 	uint64_t			tr_feats;
 };
 
+/**
+ * Feature bits of the tree, exactly one of the policy bits should be set,
+ * the policy decides how rectangles are arranged in tree nodes.
+ */
 enum evt_feats {
 	/** rectangles are Sorted by their Start Offset */
 	EVT_FEAT_SORT_SOFF		= (1 << 0),
+	/**
+	 * R*-tree: nodes are split to minimize the overlap of their MBRs,
+	 * and part of the entries of a full leaf are inserted again before
+	 * splitting it.
+	 */
+	EVT_FEAT_RSTAR			= (1 << 1),
+	/**
+	 * rectangles are Sorted by their start EPoCh, it suits arrays which
+	 * are written in time order, e.g. logs.
+	 */
+	EVT_FEAT_SORT_EPC		= (1 << 2),
 };
 
+#define EVT_POLICY_MASK			\
+	(EVT_FEAT_SORT_SOFF | EVT_FEAT_RSTAR | EVT_FEAT_SORT_EPC)
+
 #define EVT_FEAT_DEFAULT		EVT_FEAT_SORT_SOFF
 
 /**
@@ -185,6 +206,11 @@ struct evt_entry {
 	umem_id_t			 en_mmid;
 	/** the returned memory address for \a evt_find */
 	void				*en_addr;
+	/**
+	 * checksum of the extent returned by \a evt_find, its cs_len is zero
+	 * if the extent has no checksum or only a part of it is visible.
+	 */
+	daos_csum_buf_t			 en_csum;
 };
 
 #define ERT_ENT_EMBEDDED		8
@@ -211,6 +237,36 @@ struct evt_entry_list {
 void evt_ent_list_init(struct evt_entry_list *ent_list);
 void evt_ent_list_fini(struct evt_entry_list *ent_list);
 
+/**
+ * Array of the visible extents returned by \a evt_find, they are sorted by
+ * offset and never overlap. The buffers are kept and grown on demand, so a
+ * long-lived array (e.g. one per xstream) can be reused without allocation.
+ */
+struct evt_entry_array {
+	/** number of visible extents in \a ea_ents */
+	unsigned int			 ea_ent_nr;
+	/** capacity of \a ea_ents */
+	unsigned int			 ea_size;
+	/** the visible extents */
+	struct evt_entry		*ea_ents;
+	/** scratch: all extents overlapping with the searched one */
+	struct evt_entry		*ea_raw;
+	/** number of entries in \a ea_raw */
+	unsigned int			 ea_raw_nr;
+	/** capacity of \a ea_raw and \a ea_heap */
+	unsigned int			 ea_raw_size;
+	/** scratch: heap of \a ea_raw indices ordered by epoch */
+	unsigned int			*ea_heap;
+};
+
+/** iterate over all visible extents of an ent_array */
+#define evt_ent_array_for_each(ent, ea)				\
+	for ((ent) = &(ea)->ea_ents[0];				\
+	     (ent) < &(ea)->ea_ents[(ea)->ea_ent_nr]; (ent)++)
+
+void evt_ent_array_init(struct evt_entry_array *ent_array);
+void evt_ent_array_fini(struct evt_entry_array *ent_array);
+
 struct evt_context;
 
 /**
@@ -236,6 +292,15 @@ struct evt_policy_ops {
 	int	(*po_rect_weight)(struct evt_context *tcx,
 				  struct evt_rect *rect,
 				  struct evt_weight *weight);
+	/**
+	 * Optional, pick entries of the full leaf node \a nd_mmid which
+	 * should be removed and inserted again instead of splitting the
+	 * node. Positions of the picked entries are stored in \a ats in
+	 * ascending order, the number of picked entries is returned.
+	 */
+	int	(*po_reinsert)(struct evt_context *tcx,
+			       TMMID(struct evt_node) nd_mmid,
+			       unsigned int *ats);
 
 	/** TODO: add more member functions */
 };
@@ -309,6 +374,47 @@ int evt_close(daos_handle_t toh);
  */
 int evt_destroy(daos_handle_t toh);
 
+/**
+ * Check if the tree has no extent.
+ *
+ * \param toh		[IN]	The tree open handle
+ *
+ * \return		1 if the tree is empty, 0 if not, negative value
+ *			if error.
+ */
+int evt_is_empty(daos_handle_t toh);
+
+/** Which extents of the range are removed by evt_delete_range() */
+enum evt_del_opc {
+	/** extents written within the epoch range */
+	EVT_DEL_WRITTEN,
+	/**
+	 * extents written within the epoch range and fully overwritten
+	 * before its high epoch, they are invisible since the high epoch.
+	 */
+	EVT_DEL_OVERWRITTEN,
+};
+
+/**
+ * Remove versioned extents which are fully covered by the offset range of
+ * \a range and selected by \a opc in its epoch range, then free their data.
+ * Extents partially covered by \a range are kept.
+ *
+ * Subtrees enclosed by \a range are freed as a whole without visiting their
+ * extents. Extents are open-ended until they are fully overwritten, so for
+ * EVT_DEL_WRITTEN, the epoch range should be open-ended (DAOS_EPOCH_MAX)
+ * whenever the caller knows there is no newer extent.
+ *
+ * \param toh		[IN]	The tree open handle
+ * \param opc		[IN]	See evt_del_opc
+ * \param range		[IN]	The offset and epoch range to delete
+ * \param cookie	[IN]	Only delete extents written by this cookie,
+ *				extents of all cookies are deleted if it is
+ *				NULL.
+ */
+int evt_delete_range(daos_handle_t toh, enum evt_del_opc opc,
+		     struct evt_rect *range, uuid_t cookie);
+
 /**
  * Insert a new extented version \a rect and its data memory ID \a mmid to
  * a opened tree.
@@ -317,9 +423,11 @@ int evt_destroy(daos_handle_t toh);
  * \param rect		[IN]	The versioned extent to insert
  * \param inob		[IN]	Number of bytes per index in \a rect
  * \param mmid		[IN]	Memory ID of the input data.
+ * \param csum		[IN]	Optional, checksum of the input data
  */
 int evt_insert(daos_handle_t toh, uuid_t cookie, uint32_t pm_ver,
-	       struct evt_rect *rect, uint32_t inob, umem_id_t mmid);
+	       struct evt_rect *rect, uint32_t inob, umem_id_t mmid,
+	       daos_csum_buf_t *csum);
 
 /**
  * Insert a new extented version \a rect into a opened tree, and copy data in
@@ -329,20 +437,27 @@ int evt_insert(daos_handle_t toh, uuid_t cookie, uint32_t pm_ver,
  * \param rect		[IN]	The versioned extent to insert
  * \param inob		[IN]	Number of bytes per index in \a rect
  * \param sgl		[IN]	Scatter/gather list to copy in
+ * \param csum		[IN]	Optional, checksum of the data
  */
 int evt_insert_sgl(daos_handle_t toh, uuid_t cookie, uint32_t pm_ver,
-		   struct evt_rect *rect, uint32_t inob, daos_sg_list_t *sgl);
+		   struct evt_rect *rect, uint32_t inob, daos_sg_list_t *sgl,
+		   daos_csum_buf_t *csum);
 
 /**
- * Search the tree and return all versioned extents which overlap with \a rect
- * to \a ent_list.
+ * Search the tree and return the visible parts of the versioned extents which
+ * overlap with \a rect to \a ent_array: for each index of \a rect, the extent
+ * with the highest epoch wins, and returned extents are clipped to the index
+ * range of \a rect. Punched extents are returned as well, their \a en_addr
+ * is NULL.
  *
  * \param toh		[IN]	The tree open handle
  * \param rect		[IN]	The versioned extent to search
- * \param ent_list	[OUT]	The returned entry list
+ * \param ent_array	[OUT]	The returned extents, sorted by offset. Its
+ *				buffers are reused if it has been used by
+ *				a previous search.
  */
 int evt_find(daos_handle_t toh, struct evt_rect *rect,
-	     struct evt_entry_list *ent_list);
+	     struct evt_entry_array *ent_array);
 
 /**
  * Debug function, it outputs status of tree nodes at level \a debug_level,
@@ -350,6 +465,26 @@ int evt_find(daos_handle_t toh, struct evt_rect *rect,
  */
 int evt_debug(daos_handle_t toh, int debug_level);
 
+/** Statistics of an open tree, they are not persistent */
+struct evt_stats {
+	/** number of tree searches */
+	uint64_t			es_searches;
+	/** number of tree nodes visited by searches */
+	uint64_t			es_node_visits;
+	/** number of node splits */
+	uint64_t			es_splits;
+	/** number of entries removed and inserted again by R*-tree */
+	uint64_t			es_reinserts;
+};
+
+/**
+ * Return statistics accumulated since the tree \a toh was opened.
+ *
+ * \param toh		[IN]	The tree open handle
+ * \param stats		[OUT]	The returned statistics
+ */
+int evt_stats_get(daos_handle_t toh, struct evt_stats *stats);
+
 enum {
 	/**
 	 * Use the embedded iterator of the open handle.
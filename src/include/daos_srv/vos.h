@@ -56,6 +56,15 @@ vos_init(void);
 void
 vos_fini(void);
 
+/**
+ * Change size of the object cache of the current xstream, the default size
+ * can be set by environment variable VOS_OBJ_CACHE_SIZE.
+ *
+ * \param size	[IN]	Number of cached objects
+ */
+void
+vos_obj_cache_resize(unsigned int size);
+
 
 /**
  * Versioning Object Storage Pool (VOSP)
@@ -216,6 +225,34 @@ vos_epoch_aggregate(daos_handle_t coh, daos_unit_oid_t oid,
 		    daos_epoch_range_t *epr, unsigned int *credits,
 		    vos_purge_anchor_t *anchor, bool *finished);
 
+/**
+ * Coalesces record extents of an object which has been aggregated to
+ * \a epr::epr_hi. Extents of akeys updated within \a epr are rewritten:
+ * versions hidden by newer extents are dropped, and adjacent extents are
+ * merged into larger ones, so fragments of small writes do not slow down
+ * fetches forever. Akeys with any extent newer than \a epr::epr_hi are
+ * skipped.
+ *
+ * It is throttled like vos_epoch_aggregate(), the caller should yield and
+ * call it again with the same \a anchor until \a finished is set.
+ *
+ * \param coh	  [IN]		Container open handle
+ * \param oid	  [IN]		Object to coalesce
+ * \param epr	  [IN]		The epoch range of aggregation
+ * \param credits [IN/OUT]	credits for probing keys and rewriting
+ *				extents
+ * \param anchor  [IN/OUT]	anchor returned for preemption.
+ * \param finished
+ *		  [OUT]		flag returned to notify completion
+ *				of coalescing to caller.
+ *
+ * \return			Zero on success, negative value if error
+ */
+int
+vos_epoch_coalesce(daos_handle_t coh, daos_unit_oid_t oid,
+		   daos_epoch_range_t *epr, unsigned int *credits,
+		   vos_purge_anchor_t *anchor, bool *finished);
+
 /**
  * Discards changes in all epochs with the epoch range \a epr
  * and \a cookie id.
@@ -278,6 +315,28 @@ vos_obj_fetch(daos_handle_t coh, daos_unit_oid_t oid, daos_epoch_t epoch,
 	      daos_sg_list_t *sgls);
 
 
+/**
+ * Fetch records of multiple dkeys from the specified object.
+ *
+ * \param coh	[IN]	Container open handle
+ * \param oid	[IN]	Object ID
+ * \param epoch	[IN]	Epoch for the fetch.
+ * \param dkey_nr [IN]	Number of distribution keys.
+ * \param dkeys	[IN]	Array of distribution keys.
+ * \param iod_nrs [IN]	Number of I/O descriptors of each dkey.
+ * \param iods	[IN/OUT]
+ *			Array of I/O descriptors of all dkeys, descriptors of
+ *			dkeys[i] follow those of dkeys[i - 1].
+ * \param sgls	[OUT]	Scatter/gather lists of \a iods.
+ *
+ * \return		Zero on success, negative value if error
+ */
+int
+vos_obj_fetch_multi(daos_handle_t coh, daos_unit_oid_t oid,
+		    daos_epoch_t epoch, unsigned int dkey_nr,
+		    daos_key_t *dkeys, unsigned int *iod_nrs, daos_iod_t *iods,
+		    daos_sg_list_t *sgls);
+
 /**
  * Update records for the specfied object.
  * If input buffer is not provided in \a sgl, then this function returns
@@ -310,6 +369,32 @@ vos_obj_update(daos_handle_t coh, daos_unit_oid_t oid, daos_epoch_t epoch,
 	       uuid_t cookie, uint32_t pm_ver, daos_key_t *dkey,
 	       unsigned int iod_nr, daos_iod_t *iods, daos_sg_list_t *sgls);
 
+/**
+ * Update records of multiple dkeys of the specified object atomically,
+ * either all dkeys are updated or none of them is.
+ *
+ * \param coh	[IN]	Container open handle
+ * \param oid	[IN]	object ID
+ * \param epoch	[IN]	Epoch for the update.
+ * \param cookie [IN]	Cookie ID to tag this update, see vos_obj_update().
+ * \param pm_ver [IN]   Pool map version for this update.
+ * \param dkey_nr [IN]	Number of distribution keys.
+ * \param dkeys	[IN]	Array of distribution keys.
+ * \param iod_nrs [IN]	Number of I/O descriptors of each dkey.
+ * \param iods [IN]	Array of I/O descriptors of all dkeys, descriptors of
+ *			dkeys[i] follow those of dkeys[i - 1].
+ * \param sgls	[IN]	Scatter/gather lists of \a iods, all buffers should
+ *			be provided.
+ *
+ * \return		Zero on success, negative value if error
+ */
+int
+vos_obj_update_multi(daos_handle_t coh, daos_unit_oid_t oid,
+		     daos_epoch_t epoch, uuid_t cookie, uint32_t pm_ver,
+		     unsigned int dkey_nr, daos_key_t *dkeys,
+		     unsigned int *iod_nrs, daos_iod_t *iods,
+		     daos_sg_list_t *sgls);
+
 /**
  * Punch an object, or punch a dkey, or punch an array of akeys under a akey.
  *
@@ -429,6 +514,31 @@ vos_obj_zc_update_end(daos_handle_t ioh, uuid_t cookie, uint32_t pm_ver,
 		      daos_key_t *dkey, unsigned int nr, daos_iod_t *iods,
 		      int err);
 
+/** Parameters of a zero-copy update, see \a vos_obj_zc_update_end */
+struct vos_zc_update {
+	daos_handle_t		 zu_ioh;
+	uuid_t			 zu_cookie;
+	uint32_t		 zu_pm_ver;
+	daos_key_t		*zu_dkey;
+	unsigned int		 zu_iod_nr;
+	daos_iod_t		*zu_iods;
+	/** [IN] errno of the update, [OUT] result of the update */
+	int			 zu_rc;
+};
+
+/**
+ * Finish a group of zero-copy updates, the updates of the same pool are
+ * submitted by one transaction, so they share the cost of flushing and
+ * draining of the transaction. Each update has its own result, changes of
+ * a failed update are never committed, the transaction is aborted and the
+ * other updates are submitted again without it.
+ *
+ * \param updates [IN/OUT] Array of updates, their \a zu_ioh are released.
+ * \param nr	[IN]	Number of updates in \a updates.
+ */
+void
+vos_obj_zc_update_end_group(struct vos_zc_update *updates, unsigned int nr);
+
 /**
  * Get the zero-copy scatter/gather list associated with a given I/O descriptor.
  *
@@ -439,6 +549,23 @@ vos_obj_zc_update_end(daos_handle_t ioh, uuid_t cookie, uint32_t pm_ver,
 int
 vos_obj_zc_sgl_at(daos_handle_t ioh, unsigned int idx, daos_sg_list_t **sgl_pp);
 
+struct daos_csum_ctx;
+
+/**
+ * Get the checksums of the zero-copy buffers of a given I/O descriptor of
+ * update, one for each iov of the sgl returned by vos_obj_zc_sgl_at().
+ * Caller can compute them while it receives the data, vos_obj_zc_update_end()
+ * computes the checksum of a buffer which has not been fully checksummed.
+ *
+ * \param ioh	[IN]	The ZC I/O handle.
+ * \param iod	[IN]	Index of the I/O descriptor array.
+ * \param csums_pp [OUT] The returned checksums, NULL if checksum is disabled
+ *			or it is not an update.
+ */
+int
+vos_obj_zc_csum_at(daos_handle_t ioh, unsigned int idx,
+		   struct daos_csum_ctx **csums_pp);
+
 /**
  * VOS iterator APIs
  */
@@ -526,6 +653,28 @@ int
 vos_iter_fetch(daos_handle_t ih, vos_iter_entry_t *entry,
 	       daos_hash_out_t *anchor);
 
+/**
+ * Return up to \a nr entries from the current cursor and move the cursor past
+ * them, it is the same as calling vos_iter_fetch() and vos_iter_next() for
+ * each entry but cheaper. Keys of the returned entries are not copied, they
+ * are valid until the iterator is finished or the tree is modified.
+ *
+ * \param ih	[IN]	Iterator handle
+ * \param entries [OUT]	Array of returned entries
+ * \param anchors [OUT]	Optional, array of anchors of the entries
+ * \param nr	[IN/OUT]
+ *			[IN]: size of \a entries and \a anchors
+ *			[OUT]: number of returned entries
+ *
+ * \return		Zero on success, the cursor is at the next entry
+ *			-DER_NONEXIST if the cursor reached the end, the
+ *			entries returned before the end are still valid
+ *			negative value if error
+ */
+int
+vos_iter_fetch_batch(daos_handle_t ih, vos_iter_entry_t *entries,
+		     daos_hash_out_t *anchors, unsigned int *nr);
+
 /**
  * Delete the current data entry of the iterator
  *
@@ -127,8 +127,36 @@ typedef struct {
 	daos_epoch_range_t	ip_epr;
 	/** epoch logic expression for the iterator */
 	vos_it_epc_expr_t	ip_epc_expr;
+	/**
+	 * Optional, key range for VOS_ITER_DKEY/AKEY, only valid for ordered
+	 * key tree (see daos_ofeat_t). Empty key means unbounded.
+	 */
+	daos_key_t		ip_key_lo;
+	daos_key_t		ip_key_hi;
+	/** Optional, only keys starting with it for VOS_ITER_DKEY/AKEY */
+	daos_key_t		ip_key_prefix;
+	/** iterator flags, see vos_it_flags */
+	unsigned int		ip_flags;
 } vos_iter_param_t;
 
+/** flags for the iterator */
+enum vos_it_flags {
+	/** iterate keys in descending order, only for ordered key tree */
+	VOS_IT_KEY_REVERSE	= (1 << 0),
+	/**
+	 * VOS_ITER_OBJ only: iterate objects modified within the epoch range
+	 * since the last aggregation, instead of all objects.
+	 */
+	VOS_IT_OBJ_DIRTY	= (1 << 1),
+	/**
+	 * VOS_ITER_DKEY/AKEY only: iterate a snapshot of the key tree taken
+	 * by vos_iter_prepare(). The iterator doesn't see changes made after
+	 * it, so it never re-probes its anchor, e.g. after the caller yields
+	 * or deletes the current key by vos_iter_delete().
+	 */
+	VOS_IT_SNAPSHOT		= (1 << 2),
+};
+
 /**
  * Returned entry of a VOS iterator
  */
@@ -47,6 +47,7 @@ typedef enum {
 	DAOS_OPC_POOL_EXTEND,
 	DAOS_OPC_POOL_EVICT,
 	DAOS_OPC_PARAMS_SET,
+	DAOS_OPC_METRICS_QUERY,
 
 	/** Pool APIs */
 	DAOS_OPC_POOL_CONNECT,
@@ -131,6 +132,14 @@ typedef struct {
 	uint64_t		value;
 } daos_params_set_t;
 
+struct daos_metrics;
+
+typedef struct {
+	const char		*grp;
+	d_rank_t		rank;
+	struct daos_metrics	*metrics;
+} daos_metrics_query_t;
+
 typedef struct {
 	unsigned int		mode;
 	unsigned int		uid;
@@ -374,6 +383,21 @@ typedef struct {
 	daos_iom_t		*maps;
 } daos_obj_fetch_t;
 
+/**
+ * Fetch shard-local extents of a shard of an erasure coded object, they are
+ * reconstructed from the other shards of the group if the shard is not
+ * available, e.g. it is being rebuilt.
+ */
+typedef struct {
+	daos_handle_t		oh;
+	daos_epoch_t		epoch;
+	daos_key_t		*dkey;
+	unsigned int		shard;
+	unsigned int		nr;
+	daos_iod_t		*iods;
+	daos_sg_list_t		*sgls;
+} daos_obj_fetch_shard_t;
+
 typedef struct {
 	daos_handle_t		oh;
 	daos_epoch_t		epoch;
@@ -383,6 +407,31 @@ typedef struct {
 	daos_sg_list_t		*sgls;
 } daos_obj_update_t;
 
+/** flags for daos_obj_list_dkey_t */
+enum {
+	/**
+	 * Only return the greatest dkey of each target, the object must be
+	 * created with ordered dkeys (DAOS_OF_DKEY_UINT64/LEXICAL).
+	 */
+	DAOS_OBJ_LIST_DKEY_LAST	= (1 << 0),
+};
+
+/**
+ * Filter of dkey/akey enumeration, it is evaluated by the targets so only
+ * the matched keys are returned. Empty keys are ignored.
+ */
+typedef struct {
+	/** only return keys starting with this prefix */
+	daos_key_t		kf_prefix;
+	/**
+	 * Key range (inclusive), the object must be created with ordered
+	 * keys (DAOS_OF_DKEY_UINT64/LEXICAL for dkeys, DAOS_OF_AKEY_* for
+	 * akeys).
+	 */
+	daos_key_t		kf_lo;
+	daos_key_t		kf_hi;
+} daos_key_filter_t;
+
 typedef struct {
 	daos_handle_t		oh;
 	daos_epoch_t		epoch;
@@ -390,6 +439,10 @@ typedef struct {
 	daos_key_desc_t		*kds;
 	daos_sg_list_t		*sgl;
 	daos_hash_out_t		*anchor;
+	/** optional, see DAOS_OBJ_LIST_DKEY_LAST */
+	uint32_t		flags;
+	/** optional, only return the dkeys matching the filter */
+	daos_key_filter_t	*filter;
 } daos_obj_list_dkey_t;
 
 typedef struct {
@@ -400,6 +453,8 @@ typedef struct {
 	daos_key_desc_t		*kds;
 	daos_sg_list_t		*sgl;
 	daos_hash_out_t		*anchor;
+	/** optional, only return the akeys matching the filter */
+	daos_key_filter_t	*filter;
 } daos_obj_list_akey_t;
 
 typedef struct {
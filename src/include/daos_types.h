@@ -355,6 +355,39 @@ typedef struct {
 	uint64_t	hi;
 } daos_obj_id_t;
 
+/**
+ * Object feature bits, they are encoded in the 8 bits between version and
+ * class of daos_obj_id_t::hi, see daos_obj_id_generate_feat().
+ */
+typedef uint8_t daos_ofeat_t;
+
+enum {
+	/**
+	 * dkeys are native uint64_t and ordered by their values, size of
+	 * dkey must be 8 bytes.
+	 */
+	DAOS_OF_DKEY_UINT64	= (1 << 0),
+	/**
+	 * dkeys are ordered lexically (memcmp, a shorter key is less than
+	 * a longer key with the same prefix), size of dkey must be less than
+	 * or equal to DAOS_OF_KEY_LEXICAL_MAX.
+	 */
+	DAOS_OF_DKEY_LEXICAL	= (1 << 1),
+	/** akeys are native uint64_t and ordered by their values */
+	DAOS_OF_AKEY_UINT64	= (1 << 2),
+	/** akeys are ordered lexically */
+	DAOS_OF_AKEY_LEXICAL	= (1 << 3),
+};
+
+/** the maximum key size for DAOS_OF_DKEY_LEXICAL and DAOS_OF_AKEY_LEXICAL */
+#define DAOS_OF_KEY_LEXICAL_MAX	15
+
+static inline daos_ofeat_t
+daos_obj_id2feat(daos_obj_id_t oid)
+{
+	return (oid.hi >> 48) & 0xff;
+}
+
 enum {
 	/** Shared read */
 	DAOS_OO_RO             = (1 << 1),
@@ -401,6 +434,7 @@ typedef enum {
  * List of default object class
  * R = replicated (number after R is number of replicas
  * S = small (1 stripe)
+ * EC = erasure coded (number of data cells P number of parity cells)
  */
 enum {
 	DAOS_OC_UNKNOWN,
@@ -415,6 +449,8 @@ enum {
 	DAOS_OC_R4_RW,		/* temporary class for testing */
 	DAOS_OC_REPL_MAX_RW,
 	DAOS_OC_ECHO_RW,	/* Echo class */
+	DAOS_OC_EC_4P2_RW,
+	DAOS_OC_EC_8P2_RW,
 };
 
 /** Object class attributes */
@@ -446,12 +482,14 @@ typedef struct daos_oclass_attr {
 		struct daos_ec_attr {
 			/** Type of EC */
 			unsigned int	 e_type;
-			/** EC group size */
+			/** EC group size, it is e_k + e_p */
 			unsigned int	 e_grp_size;
-			/**
-			 * TODO: add members to describe erasure coding
-			 * attributes
-			 */
+			/** number of data cells of a stripe */
+			unsigned int	 e_k;
+			/** number of parity cells of a stripe */
+			unsigned int	 e_p;
+			/** cell size in number of records */
+			unsigned int	 e_len;
 		} ec;
 	} u;
 	/** TODO: add more attributes */
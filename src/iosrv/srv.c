@@ -602,6 +602,8 @@ dss_srv_tls_init(const struct dss_thread_local_storage *dtls,
 	struct dss_module_info *info;
 
 	D__ALLOC_PTR(info);
+	if (info != NULL)
+		daos_metrics_init(&info->dmi_metrics);
 
 	return info;
 }
@@ -612,6 +614,7 @@ dss_srv_tls_fini(const struct dss_thread_local_storage *dtls,
 {
 	struct dss_module_info *info = (struct dss_module_info *)data;
 
+	daos_metrics_fini(&info->dmi_metrics);
 	D__FREE_PTR(info);
 }
 
@@ -28,6 +28,7 @@
 
 #include <daos/mgmt.h>
 #include <daos/event.h>
+#include <daos/metrics.h>
 #include "rpc.h"
 
 static int
@@ -148,6 +149,103 @@ err_grp:
 	return rc;
 }
 
+struct metrics_query_arg {
+	crt_rpc_t	*rpc;
+	crt_bulk_t	 bulk;
+};
+
+static int
+metrics_query_cp(tse_task_t *task, void *data)
+{
+	struct metrics_query_arg	*arg = data;
+	struct mgmt_srv_out		*out;
+	int				 rc = task->dt_result;
+
+	if (rc != 0) {
+		D__ERROR("RPC error while querying metrics: %d\n", rc);
+		D__GOTO(out, rc);
+	}
+
+	out = crt_reply_get(arg->rpc);
+	rc = out->srv_rc;
+	if (rc != 0)
+		D__ERROR("failed to query metrics: %d\n", rc);
+out:
+	crt_bulk_free(arg->bulk);
+	daos_group_detach(arg->rpc->cr_ep.ep_grp);
+	crt_req_decref(arg->rpc);
+	task->dt_result = rc;
+	return rc;
+}
+
+int
+dc_mgmt_metrics_query(tse_task_t *task)
+{
+	daos_metrics_query_t		*args;
+	struct mgmt_metrics_query_in	*in;
+	struct metrics_query_arg	 arg;
+	crt_endpoint_t			 ep;
+	crt_rpc_t			*rpc = NULL;
+	crt_opcode_t			 opc;
+	daos_iov_t			 iov;
+	daos_sg_list_t			 sgl;
+	crt_bulk_t			 bulk;
+	int				 rc;
+
+	args = dc_task_get_args(task);
+	if (args->metrics == NULL)
+		return -DER_INVAL;
+
+	rc = daos_group_attach(args->grp, &ep.ep_grp);
+	if (rc != 0)
+		return rc;
+
+	ep.ep_rank = args->rank;
+	ep.ep_tag = 0;
+	opc = DAOS_RPC_OPCODE(MGMT_METRICS_QUERY, DAOS_MGMT_MODULE, 1);
+	rc = crt_req_create(daos_task2ctx(task), &ep, opc, &rpc);
+	if (rc != 0) {
+		D__ERROR("crt_req_create(MGMT_METRICS_QUERY) failed, rc: %d.\n",
+			 rc);
+		D__GOTO(err_grp, rc);
+	}
+
+	daos_iov_set(&iov, args->metrics, sizeof(*args->metrics));
+	sgl.sg_nr.num = 1;
+	sgl.sg_nr.num_out = 0;
+	sgl.sg_iovs = &iov;
+
+	rc = crt_bulk_create(daos_task2ctx(task), daos2crt_sg(&sgl),
+			     CRT_BULK_RW, &bulk);
+	if (rc != 0)
+		D__GOTO(err_rpc, rc);
+
+	in = crt_req_get(rpc);
+	D__ASSERT(in != NULL);
+	in->mq_bulk = bulk;
+
+	arg.rpc = rpc;
+	arg.bulk = bulk;
+	rc = tse_task_register_comp_cb(task, metrics_query_cp, &arg,
+				       sizeof(arg));
+	if (rc != 0)
+		D__GOTO(err_bulk, rc);
+
+	crt_req_addref(rpc); /** for metrics_query_cp */
+	D__DEBUG(DB_MGMT, "query metrics of rank %u\n", args->rank);
+
+	/** send the request */
+	return daos_rpc_send(rpc, task);
+
+err_bulk:
+	crt_bulk_free(bulk);
+err_rpc:
+	crt_req_decref(rpc);
+err_grp:
+	daos_group_detach(ep.ep_grp);
+	return rc;
+}
+
 /**
  * Initialize management interface
  */
@@ -90,6 +90,10 @@ struct crt_msg_field *mgmt_tgt_params_set_in_fields[] = {
 	&CMF_UINT32,		/* tps_key_id */
 };
 
+struct crt_msg_field *mgmt_metrics_query_in_fields[] = {
+	&CMF_BULK,		/* mq_bulk */
+};
+
 struct crt_msg_field *mgmt_out_fields[] = {
 	&CMF_INT,		/* ssp_rc */
 };
@@ -121,6 +125,10 @@ struct crt_req_format DQF_MGMT_TGT_PARAMS_SET =
 	DEFINE_CRT_REQ_FMT("MGMT_TGT_PARAMS_SET", mgmt_tgt_params_set_in_fields,
 			    mgmt_out_fields);
 
+struct crt_req_format DQF_MGMT_METRICS_QUERY =
+	DEFINE_CRT_REQ_FMT("MGMT_METRICS_QUERY", mgmt_metrics_query_in_fields,
+			    mgmt_out_fields);
+
 struct daos_rpc mgmt_rpcs[] = {
 	{
 		.dr_name	= "MGMT_POOL_CREATE",
@@ -146,6 +154,12 @@ struct daos_rpc mgmt_rpcs[] = {
 		.dr_ver		= 1,
 		.dr_flags	= DAOS_RPC_NO_REPLY,
 		.dr_req_fmt	= &DQF_MGMT_PARAMS_SET,
+	}, {
+		.dr_name	= "MGMT_METRICS_QUERY",
+		.dr_opc		= MGMT_METRICS_QUERY,
+		.dr_ver		= 1,
+		.dr_flags	= 0,
+		.dr_req_fmt	= &DQF_MGMT_METRICS_QUERY,
 	}, {
 		.dr_opc		= 0
 	}
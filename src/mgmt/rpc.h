@@ -45,6 +45,7 @@ enum mgmt_operation {
 	MGMT_SVC_RIP		= 7,
 	MGMT_PARAMS_SET		= 8,
 	MGMT_TGT_PARAMS_SET	= 9,
+	MGMT_METRICS_QUERY	= 10,
 };
 
 struct mgmt_svc_rip_in {
@@ -113,6 +114,11 @@ struct mgmt_srv_out {
 	int	srv_rc;
 };
 
+struct mgmt_metrics_query_in {
+	/** buffer of struct daos_metrics */
+	crt_bulk_t	mq_bulk;
+};
+
 extern struct daos_rpc mgmt_rpcs[];
 extern struct daos_rpc mgmt_srv_rpcs[];
 
@@ -60,6 +60,9 @@ static struct daos_rpc_handler ds_mgmt_handlers[] = {
 	}, {
 		.dr_opc		= MGMT_TGT_PARAMS_SET,
 		.dr_hdlr	= ds_mgmt_tgt_params_set_hdlr,
+	}, {
+		.dr_opc		= MGMT_METRICS_QUERY,
+		.dr_hdlr	= ds_mgmt_metrics_query_hdlr,
 	}, {
 		.dr_opc = 0,
 	}
@@ -176,6 +179,97 @@ out:
 	crt_reply_send(rpc);
 }
 
+static int
+metrics_bulk_cb(const struct crt_bulk_cb_info *cb_info)
+{
+	ABT_eventual *eventual = cb_info->bci_arg;
+
+	ABT_eventual_set(*eventual, (void *)&cb_info->bci_rc,
+			 sizeof(cb_info->bci_rc));
+	return 0;
+}
+
+/**
+ * Merge the metrics of all xstreams of this server and transfer them to the
+ * client buffer.
+ */
+void
+ds_mgmt_metrics_query_hdlr(crt_rpc_t *rpc)
+{
+	struct mgmt_metrics_query_in	*in;
+	struct mgmt_srv_out		*out;
+	struct daos_metrics		*dm;
+	daos_size_t			 remote_size;
+	daos_iov_t			 iov;
+	daos_sg_list_t			 sgl;
+	crt_bulk_t			 bulk;
+	struct crt_bulk_desc		 desc;
+	crt_bulk_opid_t			 opid;
+	ABT_eventual			 eventual;
+	int				*status;
+	int				 rc;
+
+	in = crt_req_get(rpc);
+	D__ASSERT(in != NULL);
+
+	rc = crt_bulk_get_len(in->mq_bulk, &remote_size);
+	if (rc != 0)
+		D__GOTO(out, rc);
+	if (remote_size < sizeof(*dm)) {
+		D__ERROR("metrics buffer "DF_U64" < %zu\n", remote_size,
+			 sizeof(*dm));
+		D__GOTO(out, rc = -DER_TRUNC);
+	}
+
+	D__ALLOC_PTR(dm);
+	if (dm == NULL)
+		D__GOTO(out, rc = -DER_NOMEM);
+
+	daos_metrics_merge(dm);
+
+	daos_iov_set(&iov, dm, sizeof(*dm));
+	sgl.sg_nr.num = 1;
+	sgl.sg_nr.num_out = 0;
+	sgl.sg_iovs = &iov;
+
+	rc = crt_bulk_create(rpc->cr_ctx, daos2crt_sg(&sgl), CRT_BULK_RO,
+			     &bulk);
+	if (rc != 0)
+		D__GOTO(out_dm, rc);
+
+	desc.bd_rpc = rpc;
+	desc.bd_bulk_op = CRT_BULK_PUT;
+	desc.bd_remote_hdl = in->mq_bulk;
+	desc.bd_remote_off = 0;
+	desc.bd_local_hdl = bulk;
+	desc.bd_local_off = 0;
+	desc.bd_len = sizeof(*dm);
+
+	rc = ABT_eventual_create(sizeof(*status), &eventual);
+	if (rc != ABT_SUCCESS)
+		D__GOTO(out_bulk, rc = dss_abterr2der(rc));
+
+	rc = crt_bulk_transfer(&desc, metrics_bulk_cb, &eventual, &opid);
+	if (rc != 0)
+		D__GOTO(out_eventual, rc);
+
+	rc = ABT_eventual_wait(eventual, (void **)&status);
+	if (rc != ABT_SUCCESS)
+		D__GOTO(out_eventual, rc = dss_abterr2der(rc));
+
+	rc = *status;
+out_eventual:
+	ABT_eventual_free(&eventual);
+out_bulk:
+	crt_bulk_free(bulk);
+out_dm:
+	D__FREE_PTR(dm);
+out:
+	out = crt_reply_get(rpc);
+	out->srv_rc = rc;
+	crt_reply_send(rpc);
+}
+
 void
 ds_mgmt_hdlr_svc_rip(crt_rpc_t *rpc)
 {
@@ -266,14 +266,158 @@ ds_mgmt_tgt_pool_iterate(int (*cb)(const uuid_t uuid, void *arg), void *arg)
 	return rc == 0 ? rc_tmp : rc;
 }
 
+/** completion of the helper threads of tgt_vos_helpers_run() */
+struct tgt_vos_sync {
+	/** set by whoever drops the last pending reference */
+	ABT_eventual	tvs_eventual;
+	/** number of running helpers, plus one held by the caller */
+	int		tvs_pending;
+};
+
+struct tgt_vos_arg {
+	uuid_t		 tva_uuid;
+	/** pool directory, only used on destroy */
+	const char	*tva_dir;
+	daos_size_t	 tva_size;
+	/** index of the VOS file, i.e. xstream id */
+	int		 tva_tid;
+	int		 tva_rc;
+	/** completion shared by all the helpers */
+	struct tgt_vos_sync *tva_sync;
+	pthread_t	 tva_thread;
+};
+
+static inline void
+tgt_vos_sync_put(struct tgt_vos_sync *sync, int nr)
+{
+	if (__atomic_sub_fetch(&sync->tvs_pending, nr, __ATOMIC_ACQ_REL) == 0)
+		ABT_eventual_set(sync->tvs_eventual, NULL, 0);
+}
+
+/**
+ * Run \a func on one helper pthread per VOS file. The blocking file system
+ * and PMDK calls must not run on the service xstreams, which would stall
+ * the foreground I/O. The calling ULT waits until all the helpers are done.
+ *
+ * \return	number of failed helpers
+ */
+static int
+tgt_vos_helpers_run(struct tgt_vos_arg *args, int nr, void *(*func)(void *))
+{
+	struct tgt_vos_sync	sync;
+	int			started;
+	int			failed = 0;
+	int			i;
+	int			rc;
+
+	rc = ABT_eventual_create(0, &sync.tvs_eventual);
+	if (rc != ABT_SUCCESS) {
+		D__ERROR("failed to create eventual: %d\n", rc);
+		for (i = 0; i < nr; i++)
+			args[i].tva_rc = dss_abterr2der(rc);
+		return nr;
+	}
+	sync.tvs_pending = nr + 1;
+
+	for (started = 0; started < nr; started++) {
+		args[started].tva_sync = &sync;
+		rc = pthread_create(&args[started].tva_thread, NULL, func,
+				    &args[started]);
+		if (rc) {
+			D__ERROR("failed to create helper thread: %d\n", rc);
+			break;
+		}
+	}
+
+	/* drop the references of the helpers not started and of the caller */
+	tgt_vos_sync_put(&sync, nr - started + 1);
+	ABT_eventual_wait(sync.tvs_eventual, NULL);
+	ABT_eventual_free(&sync.tvs_eventual);
+
+	for (i = 0; i < nr; i++) {
+		if (i < started)
+			pthread_join(args[i].tva_thread, NULL);
+		else
+			args[i].tva_rc = -DER_NOMEM;
+
+		if (args[i].tva_rc)
+			failed++;
+	}
+	return failed;
+}
+
+static inline void
+tgt_vos_helper_done(struct tgt_vos_arg *arg, int rc)
+{
+	arg->tva_rc = rc;
+	tgt_vos_sync_put(arg->tva_sync, 1);
+}
+
+/**
+ * Helper thread body to allocate and format one VOS file of a target.
+ */
+static void *
+tgt_vos_create_one(void *varg)
+{
+	struct tgt_vos_arg	*arg = varg;
+	char			*path = NULL;
+	int			 fd = -1;
+	int			 rc;
+
+	rc = path_gen(arg->tva_uuid, newborns_path, VOS_FILE, &arg->tva_tid,
+		      &path);
+	if (rc)
+		D__GOTO(out, rc);
+
+	D__DEBUG(DB_MGMT, DF_UUID": creating vos file %s\n",
+		DP_UUID(arg->tva_uuid), path);
+
+	fd = open(path, O_CREAT|O_RDWR, 0600);
+	if (fd < 0) {
+		rc = daos_errno2der(errno);
+		D__ERROR(DF_UUID": failed to create vos file %s: %d\n",
+			DP_UUID(arg->tva_uuid), path, rc);
+		D__GOTO(out, rc);
+	}
+
+	rc = posix_fallocate(fd, 0, arg->tva_size);
+	if (rc) {
+		D__ERROR(DF_UUID": failed to allocate vos file %s with "
+			"size: "DF_U64", rc: %d.\n",
+			DP_UUID(arg->tva_uuid), path, arg->tva_size, rc);
+		D__GOTO(out, rc = daos_errno2der(rc));
+	}
+
+	/* A zero size accommodates the existing file */
+	rc = vos_pool_create(path, arg->tva_uuid, 0 /* size */);
+	if (rc) {
+		D__ERROR(DF_UUID": failed to init vos pool %s: %d\n",
+			DP_UUID(arg->tva_uuid), path, rc);
+		D__GOTO(out, rc);
+	}
+
+	rc = fsync(fd);
+	if (rc) {
+		rc = daos_errno2der(errno);
+		D__ERROR(DF_UUID": failed to sync vos pool %s: %d\n",
+			DP_UUID(arg->tva_uuid), path, rc);
+		D__GOTO(out, rc);
+	}
+out:
+	if (fd >= 0)
+		(void)close(fd);
+	free(path);
+	tgt_vos_helper_done(arg, rc);
+	return NULL;
+}
+
 static int
 tgt_vos_create(uuid_t uuid, daos_size_t tgt_size)
 {
-	daos_size_t	 size;
-	int		 i;
-	char		*path = NULL;
-	int		 fd = -1;
-	int		 rc = 0;
+	struct tgt_vos_arg	*args;
+	daos_size_t		 size;
+	int			 failed;
+	int			 i;
 
 	/**
 	 * Create one VOS file per execution stream
@@ -282,57 +426,36 @@ tgt_vos_create(uuid_t uuid, daos_size_t tgt_size)
 	size = max(tgt_size / dss_nxstreams, 1 << 24);
 	/** tc_in->tc_tgt_dev is assumed to point at PMEM for now */
 
-	for (i = 0; i < dss_nxstreams; i++) {
-
-		rc = path_gen(uuid, newborns_path, VOS_FILE, &i, &path);
-		if (rc)
-			break;
-
-		D__DEBUG(DB_MGMT, DF_UUID": creating vos file %s\n",
-			DP_UUID(uuid), path);
-
-		fd = open(path, O_CREAT|O_RDWR, 0600);
-		if (fd < 0) {
-			D__ERROR(DF_UUID": failed to create vos file %s: %d\n",
-				DP_UUID(uuid), path, rc);
-			rc = daos_errno2der(errno);
-			break;
-		}
-
-		rc = posix_fallocate(fd, 0, size);
-		if (rc) {
-			D__ERROR(DF_UUID": failed to allocate vos file %s with "
-				"size: "DF_U64", rc: %d.\n",
-				DP_UUID(uuid), path, size, rc);
-			rc = daos_errno2der(rc);
-			break;
-		}
+	D__ALLOC(args, dss_nxstreams * sizeof(*args));
+	if (args == NULL)
+		return -DER_NOMEM;
 
-		/* A zero size accommodates the existing file */
-		rc = vos_pool_create(path, (unsigned char *)uuid, 0 /* size */);
-		if (rc) {
-			D__ERROR(DF_UUID": failed to init vos pool %s: %d\n",
-				DP_UUID(uuid), path, rc);
-			break;
-		}
+	for (i = 0; i < dss_nxstreams; i++) {
+		uuid_copy(args[i].tva_uuid, uuid);
+		args[i].tva_size = size;
+		args[i].tva_tid = i;
+	}
 
-		rc = fsync(fd);
-		(void)close(fd);
-		fd = -1;
-		if (rc) {
-			D__ERROR(DF_UUID": failed to sync vos pool %s: %d\n",
-				DP_UUID(uuid), path, rc);
-			rc = daos_errno2der(errno);
-			break;
-		}
+	/**
+	 * VOS files are allocated and synced concurrently. pmemobj_create()
+	 * is serialized by vos_pmemobj_lock like all the other pmemobj pool
+	 * calls, so formatting still grows with the number of xstreams.
+	 */
+	daos_metric_gauge_add(DMG_POOL_FORMAT, dss_nxstreams);
+	failed = tgt_vos_helpers_run(args, dss_nxstreams, tgt_vos_create_one);
+	daos_metric_gauge_add(DMG_POOL_FORMAT, -dss_nxstreams);
+	daos_metric_inc(DMC_POOL_FORMAT_BYTES,
+			(dss_nxstreams - failed) * size);
+
+	D__FREE(args, dss_nxstreams * sizeof(*args));
+	if (failed > 0) {
+		D__ERROR(DF_UUID": failed to create %d vos files\n",
+			DP_UUID(uuid), failed);
+		return -DER_IO;
 	}
-	if (path)
-		free(path);
-	if (fd >= 0)
-		(void)close(fd);
 
 	/** brute force cleanup to be done by the caller */
-	return rc;
+	return 0;
 }
 
 static int
@@ -523,6 +646,54 @@ out:
 	crt_reply_send(tc_req);
 }
 
+/** Helper thread body to remove one VOS file of a zombie target */
+static void *
+tgt_vos_destroy_one(void *varg)
+{
+	struct tgt_vos_arg	*arg = varg;
+	char			*path;
+	int			 rc;
+
+	rc = asprintf(&path, "%s/"VOS_FILE"%d", arg->tva_dir, arg->tva_tid);
+	if (rc < 0) {
+		tgt_vos_helper_done(arg, -DER_NOMEM);
+		return NULL;
+	}
+
+	rc = unlink(path);
+	if (rc && errno != ENOENT)
+		D__ERROR("failed to remove %s: %d\n", path, errno);
+
+	free(path);
+	tgt_vos_helper_done(arg, 0);
+	return NULL;
+}
+
+/** remove a target from the ZOMBIES directory, \a zombie is freed */
+static void
+tgt_zombie_reap(void *zombie)
+{
+	struct tgt_vos_arg	*args;
+	int			 i;
+
+	/** VOS files are removed concurrently, then the rest of the tree */
+	D__ALLOC(args, dss_nxstreams * sizeof(*args));
+	if (args != NULL) {
+		for (i = 0; i < dss_nxstreams; i++) {
+			args[i].tva_dir = zombie;
+			args[i].tva_tid = i;
+		}
+		daos_metric_gauge_add(DMG_POOL_DESTROY, dss_nxstreams);
+		(void)tgt_vos_helpers_run(args, dss_nxstreams,
+					  tgt_vos_destroy_one);
+		daos_metric_gauge_add(DMG_POOL_DESTROY, -dss_nxstreams);
+		D__FREE(args, dss_nxstreams * sizeof(*args));
+	}
+	(void)subtree_destroy(zombie);
+	(void)rmdir(zombie);
+	free(zombie);
+}
+
 static int
 tgt_destroy(uuid_t pool_uuid, char *path)
 {
@@ -549,10 +720,17 @@ tgt_destroy(uuid_t pool_uuid, char *path)
 	/**
 	 * once successfully moved to the ZOMBIES directory, the target will
 	 * take care of retrying on failure and thus always report success to
-	 * the caller.
+	 * the caller. Removing the VOS files of a large pool can take a while,
+	 * so it is done by a background ULT and the zombie is reclaimed on
+	 * restart if the server stops before.
 	 */
-	(void)subtree_destroy(zombie);
-	(void)rmdir(zombie);
+	rc = dss_ult_create(tgt_zombie_reap, zombie, -1, NULL);
+	if (rc == 0)
+		return 0;
+
+	D__DEBUG(DB_MGMT, "failed to start zombie reaper: %d\n", rc);
+	tgt_zombie_reap(zombie);
+	return 0;
 out:
 	free(zombie);
 	return rc;
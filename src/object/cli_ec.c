@@ -0,0 +1,621 @@
+/**
+ * (C) Copyright 2017 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * GOVERNMENT LICENSE RIGHTS-OPEN SOURCE SOFTWARE
+ * The Government's rights to use, modify, reproduce, release, perform, display,
+ * or disclose this software are subject to the terms of the Apache License as
+ * provided in Contract No. B609815.
+ * Any reproduction of computer software, computer software documentation, or
+ * portions thereof marked with this legend must also reproduce the markings.
+ */
+/**
+ * This file is part of daos_sr
+ *
+ * src/object/cli_ec.c
+ *
+ * Client I/O of erasure coded objects.
+ *
+ * A redundancy group of an EC object has k data cells and p parity cells,
+ * each cell is a shard of the group. A stripe of an array is k * e_len
+ * records, cell d of stripe s is stored by shard d of the group at the
+ * shard-local indices [s * e_len, (s + 1) * e_len), parity cells are stored
+ * at the same indices of the parity shards. So all shards of a group have
+ * the same extents, and any range of shard-local indices can be encoded or
+ * reconstructed on its own.
+ *
+ * Single values are small, they are replicated to all shards of the group.
+ */
+#define DDSUBSYS	DDFAC(object)
+
+#include <pthread.h>
+#include <daos_types.h>
+#include <daos/ec.h>
+#include "obj_internal.h"
+
+/** per-iod buffer of all cells, only for array iods with data */
+struct ec_iod_buf {
+	unsigned char		*eb_buf;
+	/** size of each cell in bytes */
+	daos_size_t		 eb_cell_size;
+};
+
+struct obj_ec_io {
+	struct daos_ec_codec	*ei_codec;
+	enum obj_ec_op		 ei_op;
+	unsigned int		 ei_k;
+	unsigned int		 ei_p;
+	/** cell size in records */
+	unsigned int		 ei_len;
+	/** cell to reconstruct for OBJ_EC_FETCH_CELL */
+	int			 ei_cell;
+	/** bitmap of cells to send I/O to */
+	uint32_t		 ei_cells;
+	/** bitmap of cells to reconstruct */
+	uint32_t		 ei_lost;
+	/** the cell which also carries iods without buffer */
+	int			 ei_full_cell;
+	/** iods and sgls of the caller */
+	unsigned int		 ei_nr;
+	daos_iod_t		*ei_uiods;
+	daos_sg_list_t		*ei_usgls;
+	/** number of recxs of all iods */
+	unsigned int		 ei_recx_nr;
+	/**
+	 * Per-cell I/O descriptors, ei_nr entries are reserved for each
+	 * cell and ei_cell_nr[c] of them are used.
+	 */
+	unsigned int		 ei_cell_nr[DAOS_EC_CELL_MAX];
+	daos_iod_t		*ei_iods;
+	daos_sg_list_t		*ei_sgls;
+	daos_iov_t		*ei_iovs;
+	daos_recx_t		*ei_recxs;
+	struct ec_iod_buf	*ei_bufs;
+};
+
+/** codecs are read-only once created, they are shared by all objects */
+static struct daos_ec_codec	*ec_codecs[DAOS_EC_CELL_MAX][DAOS_EC_CELL_MAX];
+static pthread_mutex_t		 ec_codecs_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static int
+ec_codec_get(unsigned int k, unsigned int p, struct daos_ec_codec **codec_p)
+{
+	int	rc = 0;
+
+	if (k == 0 || p == 0 || k + p > DAOS_EC_CELL_MAX)
+		return -DER_INVAL;
+
+	pthread_mutex_lock(&ec_codecs_lock);
+	if (ec_codecs[k][p] == NULL)
+		rc = daos_ec_codec_create(k, p, &ec_codecs[k][p]);
+	*codec_p = ec_codecs[k][p];
+	pthread_mutex_unlock(&ec_codecs_lock);
+	return rc;
+}
+
+void
+obj_ec_fini(void)
+{
+	int	i;
+	int	j;
+
+	pthread_mutex_lock(&ec_codecs_lock);
+	for (i = 0; i < DAOS_EC_CELL_MAX; i++) {
+		for (j = 0; j < DAOS_EC_CELL_MAX; j++) {
+			if (ec_codecs[i][j] == NULL)
+				continue;
+			daos_ec_codec_destroy(ec_codecs[i][j]);
+			ec_codecs[i][j] = NULL;
+		}
+	}
+	pthread_mutex_unlock(&ec_codecs_lock);
+}
+
+static inline bool
+ec_iod_is_array(daos_iod_t *iod)
+{
+	return iod->iod_type == DAOS_IOD_ARRAY;
+}
+
+/** Map a recx of the caller to the shard-local recx of all cells */
+static void
+ec_recx_map(struct obj_ec_io *eio, daos_recx_t *urecx, daos_recx_t *recx)
+{
+	uint64_t	stripe = (uint64_t)eio->ei_k * eio->ei_len;
+	uint64_t	start;
+	uint64_t	end;
+
+	if (eio->ei_op == OBJ_EC_FETCH_CELL) {
+		/* shard-local already */
+		*recx = *urecx;
+		return;
+	}
+
+	start = urecx->rx_idx / stripe;
+	end = (urecx->rx_idx + urecx->rx_nr - 1) / stripe;
+	recx->rx_idx = start * eio->ei_len;
+	recx->rx_nr = (end - start + 1) * eio->ei_len;
+}
+
+/** Sequential access to the buffers of a sgl */
+struct ec_sgl_cursor {
+	daos_sg_list_t	*sc_sgl;
+	unsigned int	 sc_iov;
+	daos_size_t	 sc_off;
+};
+
+static void
+ec_sgl_cursor_init(struct ec_sgl_cursor *cur, daos_sg_list_t *sgl)
+{
+	cur->sc_sgl = sgl;
+	cur->sc_iov = 0;
+	cur->sc_off = 0;
+}
+
+/**
+ * Copy \a len bytes between \a buf and the sgl at the cursor, the sgl is the
+ * destination if \a to_sgl is true. Returns -DER_REC2BIG if the sgl is too
+ * short.
+ */
+static int
+ec_sgl_copy(struct ec_sgl_cursor *cur, unsigned char *buf, daos_size_t len,
+	    bool to_sgl)
+{
+	daos_sg_list_t	*sgl = cur->sc_sgl;
+
+	while (len > 0) {
+		daos_iov_t	*iov;
+		daos_size_t	 size;
+
+		if (cur->sc_iov >= sgl->sg_nr.num)
+			return -DER_REC2BIG;
+
+		iov = &sgl->sg_iovs[cur->sc_iov];
+		size = (to_sgl ? iov->iov_buf_len : iov->iov_len) -
+		       cur->sc_off;
+		if (size > len)
+			size = len;
+
+		if (to_sgl) {
+			memcpy((char *)iov->iov_buf + cur->sc_off, buf, size);
+			iov->iov_len = cur->sc_off + size;
+			sgl->sg_nr.num_out = cur->sc_iov + 1;
+		} else {
+			memcpy(buf, (char *)iov->iov_buf + cur->sc_off, size);
+		}
+
+		buf += size;
+		len -= size;
+		cur->sc_off += size;
+		if (cur->sc_off == (to_sgl ? iov->iov_buf_len : iov->iov_len)) {
+			cur->sc_iov++;
+			cur->sc_off = 0;
+		}
+	}
+	return 0;
+}
+
+static inline unsigned char *
+ec_cell_buf(struct ec_iod_buf *eb, unsigned int cell)
+{
+	return eb->eb_buf + cell * eb->eb_cell_size;
+}
+
+/** Split the data of an array iod into data cells and encode the parity */
+static int
+ec_iod_encode(struct obj_ec_io *eio, unsigned int idx)
+{
+	daos_iod_t		*iod = &eio->ei_uiods[idx];
+	struct ec_iod_buf	*eb = &eio->ei_bufs[idx];
+	unsigned char		*cells[DAOS_EC_CELL_MAX];
+	struct ec_sgl_cursor	 cur;
+	daos_size_t		 cell_bytes = eio->ei_len * iod->iod_size;
+	daos_size_t		 off = 0;
+	unsigned int		 i;
+	int			 rc;
+
+	ec_sgl_cursor_init(&cur, &eio->ei_usgls[idx]);
+	for (i = 0; i < iod->iod_nr; i++) {
+		daos_recx_t	*recx = &iod->iod_recxs[i];
+		uint64_t	 x;
+
+		/* aligned to stripe, see obj_ec_io_create() */
+		for (x = 0; x < recx->rx_nr; x += eio->ei_len) {
+			unsigned int	cell;
+			daos_size_t	pos;
+
+			cell = (x / eio->ei_len) % eio->ei_k;
+			pos = off +
+			      (x / (eio->ei_len * eio->ei_k)) * cell_bytes;
+			rc = ec_sgl_copy(&cur, ec_cell_buf(eb, cell) + pos,
+					 cell_bytes, false);
+			if (rc != 0)
+				return rc;
+		}
+		off += recx->rx_nr / eio->ei_k * iod->iod_size;
+	}
+	D__ASSERT(off == eb->eb_cell_size);
+
+	for (i = 0; i < eio->ei_k + eio->ei_p; i++)
+		cells[i] = ec_cell_buf(eb, i);
+
+	daos_ec_encode(eio->ei_codec, eb->eb_cell_size, cells,
+		       &cells[eio->ei_k]);
+	return 0;
+}
+
+/** Copy the records of an array iod from the data cells to the caller */
+static int
+ec_iod_copy_out(struct obj_ec_io *eio, unsigned int idx)
+{
+	daos_iod_t		*iod = &eio->ei_uiods[idx];
+	struct ec_iod_buf	*eb = &eio->ei_bufs[idx];
+	struct ec_sgl_cursor	 cur;
+	daos_size_t		 rsize = iod->iod_size;
+	daos_size_t		 off = 0;
+	uint64_t		 stripe = (uint64_t)eio->ei_k * eio->ei_len;
+	unsigned int		 i;
+	int			 rc;
+
+	ec_sgl_cursor_init(&cur, &eio->ei_usgls[idx]);
+	eio->ei_usgls[idx].sg_nr.num_out = 0;
+
+	if (eio->ei_op == OBJ_EC_FETCH_CELL)
+		return ec_sgl_copy(&cur, ec_cell_buf(eb, eio->ei_cell),
+				   eb->eb_cell_size, true);
+
+	for (i = 0; i < iod->iod_nr; i++) {
+		daos_recx_t	*recx = &iod->iod_recxs[i];
+		daos_recx_t	 lrecx;
+		uint64_t	 first = recx->rx_idx / stripe;
+		uint64_t	 x = recx->rx_idx;
+		uint64_t	 end = recx->rx_idx + recx->rx_nr;
+
+		while (x < end) {
+			uint64_t	within = x % eio->ei_len;
+			uint64_t	run = eio->ei_len - within;
+			unsigned int	cell;
+			daos_size_t	pos;
+
+			if (run > end - x)
+				run = end - x;
+
+			cell = (x % stripe) / eio->ei_len;
+			pos = off + ((x / stripe - first) * eio->ei_len +
+				     within) * rsize;
+			rc = ec_sgl_copy(&cur, ec_cell_buf(eb, cell) + pos,
+					 run * rsize, true);
+			if (rc != 0)
+				return rc;
+			x += run;
+		}
+
+		ec_recx_map(eio, recx, &lrecx);
+		off += lrecx.rx_nr * rsize;
+	}
+	return 0;
+}
+
+/** Does the iod need the cell buffers? */
+static bool
+ec_iod_buffered(struct obj_ec_io *eio, unsigned int idx)
+{
+	return eio->ei_usgls != NULL && eio->ei_bufs[idx].eb_buf != NULL;
+}
+
+/**
+ * Select the cells to read from \a avail, data cells are preferred so
+ * nothing needs to be decoded in the common case.
+ */
+static int
+ec_fetch_cells_select(struct obj_ec_io *eio, uint32_t avail, uint32_t want)
+{
+	unsigned int	nr = 0;
+	unsigned int	i;
+
+	eio->ei_cells = 0;
+	eio->ei_lost = want & ~avail;
+	for (i = 0; i < eio->ei_k + eio->ei_p && nr < eio->ei_k; i++) {
+		if (!(avail & (1U << i)))
+			continue;
+		eio->ei_cells |= 1U << i;
+		nr++;
+	}
+
+	if (nr < eio->ei_k) {
+		D__ERROR("Only %u cells of %u+%u are available\n",
+			nr, eio->ei_k, eio->ei_p);
+		return -DER_IO;
+	}
+	return 0;
+}
+
+/** Fill the I/O descriptors of \a cell */
+static void
+ec_cell_prep(struct obj_ec_io *eio, unsigned int cell)
+{
+	daos_iod_t	*iods = &eio->ei_iods[cell * eio->ei_nr];
+	daos_sg_list_t	*sgls = &eio->ei_sgls[cell * eio->ei_nr];
+	daos_iov_t	*iovs = &eio->ei_iovs[cell * eio->ei_nr];
+	daos_recx_t	*recxs = &eio->ei_recxs[cell * eio->ei_recx_nr];
+	unsigned int	 recx_off = 0;
+	unsigned int	 nr = 0;
+	unsigned int	 i;
+	unsigned int	 j;
+
+	for (i = 0; i < eio->ei_nr; i++) {
+		daos_iod_t	*uiod = &eio->ei_uiods[i];
+		bool		 buffered = ec_iod_buffered(eio, i);
+
+		/* only the full cell reads iods without cell buffers */
+		if (!buffered && eio->ei_op != OBJ_EC_UPDATE &&
+		    cell != eio->ei_full_cell)
+			continue;
+
+		iods[nr] = *uiod;
+		if (ec_iod_is_array(uiod)) {
+			iods[nr].iod_recxs = &recxs[recx_off];
+			for (j = 0; j < uiod->iod_nr; j++)
+				ec_recx_map(eio, &uiod->iod_recxs[j],
+					    &recxs[recx_off++]);
+		}
+
+		if (eio->ei_usgls == NULL) {
+			nr++;
+			continue;
+		}
+
+		if (buffered) {
+			daos_iov_set(&iovs[nr],
+				     ec_cell_buf(&eio->ei_bufs[i], cell),
+				     eio->ei_bufs[i].eb_cell_size);
+			sgls[nr].sg_nr.num = 1;
+			sgls[nr].sg_nr.num_out = 0;
+			sgls[nr].sg_iovs = &iovs[nr];
+		} else {
+			/* single value is replicated, read it directly */
+			sgls[nr] = eio->ei_usgls[i];
+		}
+		nr++;
+	}
+	eio->ei_cell_nr[cell] = nr;
+}
+
+int
+obj_ec_io_create(struct daos_oclass_attr *oca, enum obj_ec_op op, int cell,
+		 uint32_t avail, unsigned int nr, daos_iod_t *iods,
+		 daos_sg_list_t *sgls, struct obj_ec_io **eio_p)
+{
+	struct obj_ec_io	*eio;
+	unsigned int		 cells_nr;
+	unsigned int		 bufs = 0;
+	unsigned int		 i;
+	unsigned int		 j;
+	int			 rc;
+
+	D__ASSERT(oca->ca_resil == DAOS_RES_EC);
+	D__ALLOC_PTR(eio);
+	if (eio == NULL)
+		return -DER_NOMEM;
+
+	eio->ei_op	= op;
+	eio->ei_k	= oca->u.ec.e_k;
+	eio->ei_p	= oca->u.ec.e_p;
+	eio->ei_len	= oca->u.ec.e_len;
+	eio->ei_cell	= cell;
+	eio->ei_nr	= nr;
+	eio->ei_uiods	= iods;
+	eio->ei_usgls	= sgls;
+	cells_nr	= eio->ei_k + eio->ei_p;
+
+	rc = ec_codec_get(eio->ei_k, eio->ei_p, &eio->ei_codec);
+	if (rc != 0)
+		D__GOTO(failed, rc);
+
+	D__ALLOC(eio->ei_bufs, nr * sizeof(*eio->ei_bufs));
+	if (eio->ei_bufs == NULL)
+		D__GOTO(failed, rc = -DER_NOMEM);
+
+	for (i = 0; i < nr; i++) {
+		daos_iod_t		*iod = &iods[i];
+		struct ec_iod_buf	*eb = &eio->ei_bufs[i];
+		uint64_t		 stripe;
+
+		if (!ec_iod_is_array(iod))
+			continue;
+
+		eio->ei_recx_nr += iod->iod_nr;
+		stripe = (uint64_t)eio->ei_k * eio->ei_len;
+		for (j = 0; j < iod->iod_nr; j++) {
+			daos_recx_t	*recx = &iod->iod_recxs[j];
+			daos_recx_t	 lrecx;
+
+			if (recx->rx_nr == 0)
+				D__GOTO(failed, rc = -DER_INVAL);
+
+			/* partial stripe update requires read-modify-write
+			 * of the parity, which is not supported.
+			 */
+			if (op == OBJ_EC_UPDATE &&
+			    (recx->rx_idx % stripe != 0 ||
+			     recx->rx_nr % stripe != 0)) {
+				D__ERROR("EC update ["DF_U64", "DF_U64"] is "
+					"not aligned to stripe "DF_U64"\n",
+					recx->rx_idx, recx->rx_nr, stripe);
+				D__GOTO(failed, rc = -DER_INVAL);
+			}
+			ec_recx_map(eio, recx, &lrecx);
+			eb->eb_cell_size += lrecx.rx_nr * iod->iod_size;
+		}
+
+		if (sgls == NULL || iod->iod_size == 0) {
+			eb->eb_cell_size = 0;
+			continue;
+		}
+
+		D__ALLOC(eb->eb_buf, cells_nr * eb->eb_cell_size);
+		if (eb->eb_buf == NULL)
+			D__GOTO(failed, rc = -DER_NOMEM);
+		bufs++;
+	}
+
+	if (op == OBJ_EC_UPDATE) {
+		eio->ei_cells = (1U << cells_nr) - 1;
+		for (i = 0; i < nr; i++) {
+			if (!ec_iod_buffered(eio, i))
+				continue;
+			rc = ec_iod_encode(eio, i);
+			if (rc != 0)
+				D__GOTO(failed, rc);
+		}
+	} else {
+		uint32_t	want;
+
+		if (op == OBJ_EC_FETCH_CELL) {
+			/* the cell itself is not available */
+			want = 1U << cell;
+			avail &= ~want;
+		} else {
+			want = (1U << eio->ei_k) - 1;
+		}
+
+		rc = ec_fetch_cells_select(eio, avail, want);
+		if (rc != 0)
+			D__GOTO(failed, rc);
+
+		/* nothing to decode, e.g. size query or single values */
+		if (bufs == 0) {
+			eio->ei_cells &= -eio->ei_cells;
+			eio->ei_lost = 0;
+		}
+	}
+	eio->ei_full_cell = __builtin_ctz(eio->ei_cells);
+
+	D__ALLOC(eio->ei_iods, cells_nr * nr * sizeof(*eio->ei_iods));
+	D__ALLOC(eio->ei_sgls, cells_nr * nr * sizeof(*eio->ei_sgls));
+	D__ALLOC(eio->ei_iovs, cells_nr * nr * sizeof(*eio->ei_iovs));
+	if (eio->ei_recx_nr > 0)
+		D__ALLOC(eio->ei_recxs,
+			 cells_nr * eio->ei_recx_nr * sizeof(*eio->ei_recxs));
+	if (eio->ei_iods == NULL || eio->ei_sgls == NULL ||
+	    eio->ei_iovs == NULL ||
+	    (eio->ei_recx_nr > 0 && eio->ei_recxs == NULL))
+		D__GOTO(failed, rc = -DER_NOMEM);
+
+	for (i = 0; i < cells_nr; i++) {
+		if (eio->ei_cells & (1U << i))
+			ec_cell_prep(eio, i);
+	}
+
+	D__DEBUG(DB_IO, "EC %u+%u op %d cells %#x lost %#x\n",
+		eio->ei_k, eio->ei_p, op, eio->ei_cells, eio->ei_lost);
+	*eio_p = eio;
+	return 0;
+failed:
+	obj_ec_io_destroy(eio);
+	return rc;
+}
+
+void
+obj_ec_io_destroy(struct obj_ec_io *eio)
+{
+	unsigned int	cells_nr = eio->ei_k + eio->ei_p;
+	unsigned int	i;
+
+	if (eio->ei_bufs != NULL) {
+		for (i = 0; i < eio->ei_nr; i++) {
+			struct ec_iod_buf *eb = &eio->ei_bufs[i];
+
+			if (eb->eb_buf != NULL)
+				D__FREE(eb->eb_buf,
+					cells_nr * eb->eb_cell_size);
+		}
+		D__FREE(eio->ei_bufs, eio->ei_nr * sizeof(*eio->ei_bufs));
+	}
+
+	if (eio->ei_iods != NULL)
+		D__FREE(eio->ei_iods,
+			cells_nr * eio->ei_nr * sizeof(*eio->ei_iods));
+	if (eio->ei_sgls != NULL)
+		D__FREE(eio->ei_sgls,
+			cells_nr * eio->ei_nr * sizeof(*eio->ei_sgls));
+	if (eio->ei_iovs != NULL)
+		D__FREE(eio->ei_iovs,
+			cells_nr * eio->ei_nr * sizeof(*eio->ei_iovs));
+	if (eio->ei_recxs != NULL)
+		D__FREE(eio->ei_recxs,
+			cells_nr * eio->ei_recx_nr * sizeof(*eio->ei_recxs));
+	D__FREE_PTR(eio);
+}
+
+uint32_t
+obj_ec_io_cells(struct obj_ec_io *eio)
+{
+	return eio->ei_cells;
+}
+
+void
+obj_ec_cell_io(struct obj_ec_io *eio, unsigned int cell, unsigned int *nr,
+	       daos_iod_t **iods, daos_sg_list_t **sgls)
+{
+	D__ASSERT(eio->ei_cells & (1U << cell));
+	*nr = eio->ei_cell_nr[cell];
+	*iods = &eio->ei_iods[cell * eio->ei_nr];
+	*sgls = eio->ei_usgls == NULL ? NULL : &eio->ei_sgls[cell * eio->ei_nr];
+}
+
+int
+obj_ec_fetch_post(struct obj_ec_io *eio)
+{
+	daos_iod_t	*iods = &eio->ei_iods[eio->ei_full_cell * eio->ei_nr];
+	unsigned char	*cells[DAOS_EC_CELL_MAX];
+	unsigned int	 i;
+	unsigned int	 j;
+	int		 rc;
+
+	D__ASSERT(eio->ei_op != OBJ_EC_UPDATE);
+	D__ASSERT(eio->ei_cell_nr[eio->ei_full_cell] == eio->ei_nr);
+
+	for (i = 0; i < eio->ei_nr; i++) {
+		struct ec_iod_buf *eb = &eio->ei_bufs[i];
+
+		/* sizes returned by the full cell */
+		eio->ei_uiods[i].iod_size = iods[i].iod_size;
+		if (!ec_iod_buffered(eio, i))
+			continue;
+
+		if (eio->ei_lost != 0) {
+			for (j = 0; j < eio->ei_k + eio->ei_p; j++) {
+				if ((eio->ei_cells | eio->ei_lost) & (1U << j))
+					cells[j] = ec_cell_buf(eb, j);
+				else
+					cells[j] = NULL;
+			}
+
+			rc = daos_ec_decode(eio->ei_codec, eb->eb_cell_size,
+					    cells, eio->ei_lost);
+			if (rc != 0)
+				return rc;
+		}
+
+		/* nothing was found */
+		if (eio->ei_uiods[i].iod_size == 0)
+			continue;
+
+		rc = ec_iod_copy_out(eio, i);
+		if (rc != 0)
+			return rc;
+	}
+	return 0;
+}
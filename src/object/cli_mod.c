@@ -60,4 +60,5 @@ void
 dc_obj_fini(void)
 {
 	daos_rpc_unregister(daos_obj_rpcs);
+	obj_ec_fini();
 }
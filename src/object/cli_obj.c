@@ -36,6 +36,23 @@
 
 #define CLI_OBJ_IO_PARMS	8
 
+/** number of slots of obj_tgt_rd_inflight, it is a power of two */
+#define OBJ_TGT_RD_SLOTS	1024
+
+/**
+ * Number of in-flight read RPCs of each target, shared by all objects of
+ * the process and updated by atomic operations. A slot is indexed by the
+ * target id, so targets of different pools may share a slot, which only
+ * makes replica selection less accurate.
+ */
+static unsigned int	obj_tgt_rd_inflight[OBJ_TGT_RD_SLOTS];
+
+static inline unsigned int *
+obj_tgt_rd_slot(uint32_t target)
+{
+	return &obj_tgt_rd_inflight[target & (OBJ_TGT_RD_SLOTS - 1)];
+}
+
 static struct dc_object *
 obj_alloc(void)
 {
@@ -350,21 +367,73 @@ obj_grp_valid_shard_get(struct dc_object *obj, int idx,
 	return idx;
 }
 
+/**
+ * Select a replica of the group to read from. Instead of always reading
+ * the same replica for a dkey, pick the shard whose target has the fewest
+ * read RPCs in flight from this process, the scan starts from a round-robin
+ * cursor so idle replicas are used in turn. Rebuilding shards are skipped as
+ * in obj_grp_valid_shard_get().
+ */
 static int
-obj_grp_shard_get(struct dc_object *obj, uint32_t grp_idx,
-		  uint64_t hash, unsigned int map_ver, uint32_t op)
+obj_grp_read_shard_get(struct dc_object *obj, uint32_t grp_idx,
+		       unsigned int map_ver)
 {
-	int	grp_size;
-	int	idx;
+	struct pl_obj_layout	*layout;
+	unsigned int		 inflight = -1;
+	unsigned int		 cursor;
+	bool			 rebuilding = false;
+	int			 grp_size;
+	int			 shard = -1;
+	int			 i;
 
 	grp_size = obj_get_grp_size(obj);
-	idx = hash % grp_size + grp_idx * grp_size;
-	return obj_grp_valid_shard_get(obj, idx, map_ver, op);
+	D__ASSERT(grp_size > 0);
+
+	cursor = __atomic_fetch_add(&obj->cob_rd_cursor, 1, __ATOMIC_RELAXED);
+
+	pthread_rwlock_rdlock(&obj->cob_lock);
+	layout = obj->cob_layout;
+	if (layout->ol_ver != map_ver) {
+		pthread_rwlock_unlock(&obj->cob_lock);
+		return -DER_STALE;
+	}
+	D__ASSERT((grp_idx + 1) * grp_size <= layout->ol_nr);
+
+	for (i = 0; i < grp_size; i++) {
+		unsigned int	nr;
+		int		idx;
+
+		idx = grp_idx * grp_size + (cursor + i) % grp_size;
+		if (layout->ol_shards[idx].po_rebuilding) {
+			rebuilding = true;
+			continue;
+		}
+
+		if (layout->ol_shards[idx].po_shard == -1)
+			continue;
+
+		nr = __atomic_load_n(
+			obj_tgt_rd_slot(layout->ol_shards[idx].po_target),
+			__ATOMIC_RELAXED);
+		if (nr < inflight) {
+			inflight = nr;
+			shard = idx;
+			if (inflight == 0)
+				break;
+		}
+	}
+	pthread_rwlock_unlock(&obj->cob_lock);
+
+	if (shard < 0) {
+		/* see obj_grp_valid_shard_get() */
+		return rebuilding ? -DER_STALE : -DER_NONEXIST;
+	}
+	return shard;
 }
 
 static int
 obj_dkey2shard(struct dc_object *obj, daos_key_t *dkey,
-	       unsigned int map_ver, uint32_t op)
+	       unsigned int map_ver)
 {
 	uint64_t hash;
 	int	 grp_idx;
@@ -376,7 +445,40 @@ obj_dkey2shard(struct dc_object *obj, daos_key_t *dkey,
 	if (grp_idx < 0)
 		return grp_idx;
 
-	return obj_grp_shard_get(obj, grp_idx, hash, map_ver, op);
+	return obj_grp_read_shard_get(obj, grp_idx, map_ver);
+}
+
+static int
+obj_read_comp_cb(tse_task_t *task, void *data)
+{
+	unsigned int	*slot = *(unsigned int **)data;
+
+	__atomic_fetch_sub(slot, 1, __ATOMIC_RELAXED);
+	return 0;
+}
+
+/** Account a read RPC sent to \a shard until \a task completes */
+static int
+obj_read_track(tse_task_t *task, struct dc_object *obj, int shard,
+	       unsigned int map_ver)
+{
+	unsigned int	*slot = NULL;
+	int		 rc;
+
+	pthread_rwlock_rdlock(&obj->cob_lock);
+	if (obj->cob_layout->ol_ver == map_ver)
+		slot = obj_tgt_rd_slot(
+			obj->cob_layout->ol_shards[shard].po_target);
+	pthread_rwlock_unlock(&obj->cob_lock);
+	if (slot == NULL)
+		return 0; /* stale layout, the RPC will be retried */
+
+	__atomic_fetch_add(slot, 1, __ATOMIC_RELAXED);
+	rc = tse_task_register_comp_cb(task, obj_read_comp_cb, &slot,
+				       sizeof(slot));
+	if (rc != 0)
+		__atomic_fetch_sub(slot, 1, __ATOMIC_RELAXED);
+	return rc;
 }
 
 static int
@@ -732,55 +834,10 @@ obj_comp_cb(tse_task_t *task, void *arg)
 	return 0;
 }
 
-int
-dc_obj_fetch(tse_task_t *task)
-{
-	daos_obj_fetch_t	*args = dc_task_get_args(task);
-	struct dc_object	*obj;
-	unsigned int		map_ver;
-	int			shard;
-	daos_handle_t		shard_oh;
-	int			rc;
-
-	obj = obj_hdl2ptr(args->oh);
-	if (obj == NULL)
-		D__GOTO(out_task, rc = -DER_NO_HDL);
-
-	rc = tse_task_register_comp_cb(task, obj_comp_cb, &obj,
-				       sizeof(obj));
-	if (rc != 0) {
-		/* NB: process_rc_cb() will release refcount in other cases */
-		obj_decref(obj);
-		D__GOTO(out_task, rc);
-	}
-
-	rc = obj_ptr2pm_ver(obj, &map_ver);
-	if (rc)
-		D__GOTO(out_task, rc);
-
-	shard = obj_dkey2shard(obj, args->dkey, map_ver, DAOS_OPC_OBJ_UPDATE);
-	if (shard < 0)
-		D__GOTO(out_task, rc = shard);
-
-	rc = obj_shard_open(obj, shard, map_ver, &shard_oh);
-	if (rc != 0)
-		D__GOTO(out_task, rc);
-
-	D__DEBUG(DB_IO, "fetch "DF_OID" shard %u\n",
-		DP_OID(obj->cob_md.omd_id), shard);
-	rc = dc_obj_shard_fetch(shard_oh, args->epoch, args->dkey, args->nr,
-				args->iods, args->sgls, args->maps, map_ver,
-				task);
-	dc_obj_shard_close(shard_oh);
-	return rc;
-
-out_task:
-	tse_task_complete(task, rc);
-	return rc;
-}
-
 struct shard_update_args {
 	struct dc_object	*obj;
+	/** DAOS_OBJ_RPC_UPDATE, or DAOS_OBJ_RPC_FETCH for EC objects */
+	unsigned int		opc;
 	daos_epoch_t		epoch;
 	daos_key_t		*dkey;
 	unsigned int		nr;
@@ -821,15 +878,21 @@ shard_update_task(tse_task_t *task)
 	rc = obj_shard_open(obj, args->shard, args->map_ver, &shard_oh);
 	if (rc != 0) {
 		/* skip a failed target */
-		if (rc == -DER_NONEXIST) {
+		if (rc == -DER_NONEXIST && args->opc == DAOS_OBJ_RPC_UPDATE) {
 			tse_task_complete(task, 0);
 			rc = 0;
 		}
 		return rc;
 	}
 
-	rc = dc_obj_shard_update(shard_oh, args->epoch, args->dkey, args->nr,
-				 args->iods, args->sgls, args->map_ver, task);
+	if (args->opc == DAOS_OBJ_RPC_FETCH)
+		rc = dc_obj_shard_fetch(shard_oh, args->epoch, args->dkey,
+					args->nr, args->iods, args->sgls, NULL,
+					args->map_ver, task);
+	else
+		rc = dc_obj_shard_update(shard_oh, args->epoch, args->dkey,
+					 args->nr, args->iods, args->sgls,
+					 args->map_ver, task);
 
 	dc_obj_shard_close(shard_oh);
 	return rc;
@@ -849,17 +912,250 @@ shard_update_cb(tse_task_t *task, void *nouse)
 	return 0;
 }
 
+/**
+ * Send I/O to the shards [start, start + cnt) of the object, all of them
+ * get the same iods and sgls unless \a eio is provided, which has the iods
+ * and sgls of each cell of an EC group.
+ */
+static int
+obj_shards_rw(tse_task_t *task, struct dc_object *obj, unsigned int opc,
+	      daos_epoch_t epoch, daos_key_t *dkey, unsigned int nr,
+	      daos_iod_t *iods, daos_sg_list_t *sgls, struct obj_ec_io *eio,
+	      unsigned int shard, unsigned int cnt, unsigned int map_ver)
+{
+	tse_sched_t	*sched = tse_task2sched(task);
+	daos_list_t	 head;
+	int		 i;
+	int		 rc;
+
+	DAOS_INIT_LIST_HEAD(&head);
+	for (i = 0; i < cnt; i++, shard++) {
+		tse_task_t		 *shard_task;
+		struct shard_update_args *shard_arg;
+
+		if (eio != NULL && !(obj_ec_io_cells(eio) & (1U << i)))
+			continue;
+
+		rc = tse_task_create(shard_update_task, sched, NULL,
+				     &shard_task);
+		if (rc != 0)
+			D__GOTO(out_task, rc);
+
+		shard_arg = tse_task_buf_embedded(shard_task,
+						  sizeof(*shard_arg));
+		/* share the refcount taken by obj_comp_cb */
+		shard_arg->obj	   = obj;
+		shard_arg->opc	   = opc;
+		shard_arg->epoch   = epoch;
+		shard_arg->dkey	   = dkey;
+		shard_arg->nr	   = nr;
+		shard_arg->iods	   = iods;
+		shard_arg->sgls	   = sgls;
+		shard_arg->map_ver = map_ver;
+		shard_arg->shard   = shard;
+		shard_arg->retry   = false;
+		if (eio != NULL)
+			obj_ec_cell_io(eio, i, &shard_arg->nr,
+				       &shard_arg->iods, &shard_arg->sgls);
+
+		/* Register retry CB.
+		 * NB: share the obj refcount taken by obj_comp_cb
+		 * which is guaranteed to be called at the end.
+		 */
+		rc = tse_task_register_comp_cb(shard_task, shard_update_cb,
+					       NULL, 0);
+		if (rc != 0) {
+			tse_task_complete(task, rc);
+			D__GOTO(out_task, rc);
+		}
+
+		rc = tse_task_register_deps(task, 1, &shard_task);
+		if (rc != 0) {
+			tse_task_complete(shard_task, rc);
+			D__GOTO(out_task, rc);
+		}
+		tse_task_list_add(shard_task, &head);
+	}
+	tse_task_list_sched(&head, true);
+	return 0;
+out_task:
+	if (daos_list_empty(&head))
+		tse_task_complete(task, rc);
+	else
+		tse_task_list_abort(&head, rc);
+	return rc;
+}
+
+/** Bitmap of the shards of an EC group which can be read from */
+static int
+obj_ec_grp_avail(struct dc_object *obj, unsigned int start, unsigned int cnt,
+		 unsigned int map_ver, uint32_t *avail)
+{
+	struct pl_obj_layout	*layout;
+	int			 i;
+
+	*avail = 0;
+	pthread_rwlock_rdlock(&obj->cob_lock);
+	layout = obj->cob_layout;
+	if (layout->ol_ver != map_ver) {
+		pthread_rwlock_unlock(&obj->cob_lock);
+		return -DER_STALE;
+	}
+
+	for (i = 0; i < cnt; i++) {
+		struct pl_obj_shard *pos = &layout->ol_shards[start + i];
+
+		if (!pos->po_rebuilding && pos->po_shard != -1)
+			*avail |= 1U << i;
+	}
+	pthread_rwlock_unlock(&obj->cob_lock);
+	return 0;
+}
+
+struct obj_ec_arg {
+	struct obj_ec_io	*eio;
+	unsigned int		 opc;
+};
+
+static int
+obj_ec_comp_cb(tse_task_t *task, void *data)
+{
+	struct obj_ec_arg	*arg = data;
+	int			 result = 0;
+
+	/* NB: it runs before obj_comp_cb, which may retry the task */
+	if (arg->opc == DAOS_OBJ_RPC_FETCH) {
+		tse_task_result_process(task, shard_process_rc, &result);
+		if (task->dt_result == 0)
+			task->dt_result = result;
+		if (task->dt_result == 0)
+			task->dt_result = obj_ec_fetch_post(arg->eio);
+	}
+	obj_ec_io_destroy(arg->eio);
+	return 0;
+}
+
+/**
+ * I/O of an EC group [start, start + cnt), the shard tasks are dependencies
+ * of \a task, the EC I/O is released after all of them completed.
+ */
+static int
+obj_ec_rw(tse_task_t *task, struct dc_object *obj, enum obj_ec_op op,
+	  int cell, daos_epoch_t epoch, daos_key_t *dkey, unsigned int nr,
+	  daos_iod_t *iods, daos_sg_list_t *sgls, unsigned int start,
+	  unsigned int cnt, uint32_t avail, unsigned int map_ver)
+{
+	struct daos_oclass_attr	*oca;
+	struct obj_ec_arg	 arg;
+	int			 rc;
+
+	oca = daos_oclass_attr_find(obj->cob_md.omd_id);
+	D__ASSERT(oca != NULL);
+	rc = obj_ec_io_create(oca, op, cell, avail, nr, iods, sgls, &arg.eio);
+	if (rc != 0)
+		D__GOTO(out_task, rc);
+
+	arg.opc = op == OBJ_EC_UPDATE ? DAOS_OBJ_RPC_UPDATE :
+					DAOS_OBJ_RPC_FETCH;
+	rc = tse_task_register_comp_cb(task, obj_ec_comp_cb, &arg,
+				       sizeof(arg));
+	if (rc != 0) {
+		obj_ec_io_destroy(arg.eio);
+		D__GOTO(out_task, rc);
+	}
+
+	D__DEBUG(DB_IO, "EC %s "DF_OID" start %u cells %#x\n",
+		op == OBJ_EC_UPDATE ? "update" : "fetch",
+		DP_OID(obj->cob_md.omd_id), start, obj_ec_io_cells(arg.eio));
+	return obj_shards_rw(task, obj, arg.opc, epoch, dkey, nr, iods, sgls,
+			     arg.eio, start, cnt, map_ver);
+out_task:
+	tse_task_complete(task, rc);
+	return rc;
+}
+
+int
+dc_obj_fetch(tse_task_t *task)
+{
+	daos_obj_fetch_t	*args = dc_task_get_args(task);
+	struct daos_oclass_attr	*oca;
+	struct dc_object	*obj;
+	unsigned int		map_ver;
+	int			shard;
+	daos_handle_t		shard_oh;
+	int			rc;
+
+	obj = obj_hdl2ptr(args->oh);
+	if (obj == NULL)
+		D__GOTO(out_task, rc = -DER_NO_HDL);
+
+	rc = tse_task_register_comp_cb(task, obj_comp_cb, &obj,
+				       sizeof(obj));
+	if (rc != 0) {
+		/* NB: process_rc_cb() will release refcount in other cases */
+		obj_decref(obj);
+		D__GOTO(out_task, rc);
+	}
+
+	rc = obj_ptr2pm_ver(obj, &map_ver);
+	if (rc)
+		D__GOTO(out_task, rc);
+
+	oca = daos_oclass_attr_find(obj->cob_md.omd_id);
+	D__ASSERT(oca != NULL);
+	if (oca->ca_resil == DAOS_RES_EC) {
+		unsigned int	start;
+		unsigned int	cnt;
+		uint32_t	avail;
+
+		rc = obj_dkey2update_grp(obj, args->dkey, map_ver, &start,
+					 &cnt);
+		if (rc != 0)
+			D__GOTO(out_task, rc);
+
+		rc = obj_ec_grp_avail(obj, start, cnt, map_ver, &avail);
+		if (rc != 0)
+			D__GOTO(out_task, rc);
+
+		return obj_ec_rw(task, obj, OBJ_EC_FETCH, -1, args->epoch,
+				 args->dkey, args->nr, args->iods, args->sgls,
+				 start, cnt, avail, map_ver);
+	}
+
+	shard = obj_dkey2shard(obj, args->dkey, map_ver);
+	if (shard < 0)
+		D__GOTO(out_task, rc = shard);
+
+	rc = obj_read_track(task, obj, shard, map_ver);
+	if (rc != 0)
+		D__GOTO(out_task, rc);
+
+	rc = obj_shard_open(obj, shard, map_ver, &shard_oh);
+	if (rc != 0)
+		D__GOTO(out_task, rc);
+
+	D__DEBUG(DB_IO, "fetch "DF_OID" shard %u\n",
+		DP_OID(obj->cob_md.omd_id), shard);
+	rc = dc_obj_shard_fetch(shard_oh, args->epoch, args->dkey, args->nr,
+				args->iods, args->sgls, args->maps, map_ver,
+				task);
+	dc_obj_shard_close(shard_oh);
+	return rc;
+
+out_task:
+	tse_task_complete(task, rc);
+	return rc;
+}
+
 int
 dc_obj_update(tse_task_t *task)
 {
 	daos_obj_update_t	*args = dc_task_get_args(task);
-	tse_sched_t		*sched = tse_task2sched(task);
+	struct daos_oclass_attr	*oca;
 	struct dc_object	*obj;
-	daos_list_t		head;
 	unsigned int		shard;
 	unsigned int		shards_cnt;
 	unsigned int		map_ver;
-	int			i;
 	int			rc;
 
 	obj = obj_hdl2ptr(args->oh);
@@ -882,52 +1178,471 @@ dc_obj_update(tse_task_t *task)
 	if (rc != 0)
 		D__GOTO(out_task, rc);
 
+	oca = daos_oclass_attr_find(obj->cob_md.omd_id);
+	D__ASSERT(oca != NULL);
+	if (oca->ca_resil == DAOS_RES_EC)
+		return obj_ec_rw(task, obj, OBJ_EC_UPDATE, -1, args->epoch,
+				 args->dkey, args->nr, args->iods, args->sgls,
+				 shard, shards_cnt, 0, map_ver);
+
 	D__DEBUG(DB_IO, "update "DF_OID" start %u cnt %u\n",
 		DP_OID(obj->cob_md.omd_id), shard, shards_cnt);
 
-	DAOS_INIT_LIST_HEAD(&head);
-	for (i = 0; i < shards_cnt; i++, shard++) {
-		tse_task_t		 *shard_task;
-		struct shard_update_args *shard_arg;
+	return obj_shards_rw(task, obj, DAOS_OBJ_RPC_UPDATE, args->epoch,
+			     args->dkey, args->nr, args->iods, args->sgls,
+			     NULL, shard, shards_cnt, map_ver);
+out_task:
+	tse_task_complete(task, rc);
+	return rc;
+}
 
-		rc = tse_task_create(shard_update_task, sched, NULL,
-				     &shard_task);
+/** a dkey of a multi-dkey I/O and the shard and xstream to send it to */
+struct obj_multi_ent {
+	unsigned int	ome_shard;
+	unsigned int	ome_tag;
+	unsigned int	ome_idx;
+	unsigned int	ome_nr;
+	daos_size_t	ome_len;
+};
+
+/** batches of a multi-dkey I/O, released on completion of the I/O */
+struct obj_multi_ctx {
+	daos_list_t	 omc_mios;
+	daos_dkey_io_t	*omc_ios;
+	unsigned int	 omc_opc;
+};
+
+struct shard_multi_args {
+	struct dc_object	*obj;
+	struct obj_multi_io	*mio;
+	daos_epoch_t		 epoch;
+	unsigned int		 opc;
+	unsigned int		 map_ver;
+};
+
+static int
+obj_multi_ent_cmp(const void *a, const void *b)
+{
+	const struct obj_multi_ent *ea = a;
+	const struct obj_multi_ent *eb = b;
+
+	if (ea->ome_shard != eb->ome_shard)
+		return ea->ome_shard < eb->ome_shard ? -1 : 1;
+	if (ea->ome_tag != eb->ome_tag)
+		return ea->ome_tag < eb->ome_tag ? -1 : 1;
+	if (ea->ome_idx != eb->ome_idx)
+		return ea->ome_idx < eb->ome_idx ? -1 : 1;
+	return 0;
+}
+
+static daos_size_t
+obj_multi_io_size(unsigned int dkey_nr, unsigned int iod_nr)
+{
+	return sizeof(struct obj_multi_io) +
+	       iod_nr * (sizeof(daos_iod_t) + sizeof(daos_sg_list_t)) +
+	       dkey_nr * (sizeof(daos_key_t) + sizeof(uint32_t) +
+			  sizeof(unsigned int));
+}
+
+static void
+obj_multi_io_free(struct obj_multi_io *mio)
+{
+	D__FREE(mio, obj_multi_io_size(mio->omi_dkey_nr, mio->omi_iod_nr));
+}
+
+/** Build a batch of the dkeys \a ents, the arrays share one allocation */
+static struct obj_multi_io *
+obj_multi_io_alloc(daos_dkey_io_t *ios, struct obj_multi_ent *ents,
+		   unsigned int dkey_nr, unsigned int iod_nr)
+{
+	struct obj_multi_io	*mio;
+	unsigned int		 off = 0;
+	int			 i;
+
+	D__ALLOC(mio, obj_multi_io_size(dkey_nr, iod_nr));
+	if (mio == NULL)
+		return NULL;
+
+	mio->omi_shard	 = ents[0].ome_shard;
+	mio->omi_tag	 = ents[0].ome_tag;
+	mio->omi_dkey_nr = dkey_nr;
+	mio->omi_iod_nr	 = iod_nr;
+	mio->omi_iods	 = (daos_iod_t *)&mio[1];
+	mio->omi_sgls	 = (daos_sg_list_t *)&mio->omi_iods[iod_nr];
+	mio->omi_dkeys	 = (daos_key_t *)&mio->omi_sgls[iod_nr];
+	mio->omi_iod_nrs = (uint32_t *)&mio->omi_dkeys[dkey_nr];
+	mio->omi_idx	 = (unsigned int *)&mio->omi_iod_nrs[dkey_nr];
+
+	for (i = 0; i < dkey_nr; i++) {
+		daos_dkey_io_t *io = &ios[ents[i].ome_idx];
+
+		mio->omi_dkeys[i]   = *io->ioa_dkey;
+		mio->omi_iod_nrs[i] = io->ioa_nr;
+		mio->omi_idx[i]	    = ents[i].ome_idx;
+		memcpy(&mio->omi_iods[off], io->ioa_iods,
+		       io->ioa_nr * sizeof(*io->ioa_iods));
+		memcpy(&mio->omi_sgls[off], io->ioa_sgls,
+		       io->ioa_nr * sizeof(*io->ioa_sgls));
+		off += io->ioa_nr;
+	}
+	D__ASSERT(off == iod_nr);
+	return mio;
+}
+
+static int
+obj_multi_comp_cb(tse_task_t *task, void *data)
+{
+	struct obj_multi_ctx	*ctx = *((struct obj_multi_ctx **)data);
+	struct obj_multi_io	*mio;
+	struct obj_multi_io	*tmp;
+	int			 result = 0;
+	int			 i;
+	int			 j;
+
+	/* NB: it runs before obj_comp_cb, which may retry the task */
+	tse_task_result_process(task, shard_process_rc, &result);
+	if (task->dt_result == 0)
+		task->dt_result = result;
+
+	daos_list_for_each_entry_safe(mio, tmp, &ctx->omc_mios, omi_link) {
+		unsigned int off = 0;
+
+		/* copy sizes and sgl nrs of the fetched records back */
+		for (i = 0; i < mio->omi_dkey_nr &&
+			    ctx->omc_opc == DAOS_OBJ_RPC_FETCH_MULTI &&
+			    task->dt_result == 0; i++) {
+			daos_dkey_io_t *io = &ctx->omc_ios[mio->omi_idx[i]];
+
+			for (j = 0; j < io->ioa_nr; j++, off++) {
+				io->ioa_iods[j].iod_size =
+					mio->omi_iods[off].iod_size;
+				io->ioa_sgls[j].sg_nr.num_out =
+					mio->omi_sgls[off].sg_nr.num_out;
+			}
+		}
+		daos_list_del(&mio->omi_link);
+		obj_multi_io_free(mio);
+	}
+	D__FREE_PTR(ctx);
+	return 0;
+}
+
+static int
+shard_multi_task(tse_task_t *task)
+{
+	struct shard_multi_args	*args;
+	daos_handle_t		 shard_oh;
+	int			 rc;
+
+	args = tse_task_buf_embedded(task, sizeof(*args));
+	rc = obj_shard_open(args->obj, args->mio->omi_shard, args->map_ver,
+			    &shard_oh);
+	if (rc != 0) {
+		/* skip a failed target, see shard_update_task() */
+		if (rc == -DER_NONEXIST &&
+		    args->opc == DAOS_OBJ_RPC_UPDATE_MULTI)
+			rc = 0;
+		tse_task_complete(task, rc);
+		return rc;
+	}
+
+	rc = dc_obj_shard_rw_multi(shard_oh, args->opc, args->epoch,
+				   args->mio, args->map_ver, task);
+	dc_obj_shard_close(shard_oh);
+	return rc;
+}
+
+/**
+ * Xstream of \a shard which owns a dkey of \a hash, \a part_nrs caches the
+ * number of xstreams of each shard.
+ */
+static int
+obj_multi_shard_tag(struct dc_object *obj, unsigned int shard,
+		    unsigned int map_ver, uint64_t hash, unsigned int *part_nrs)
+{
+	daos_handle_t	shard_oh;
+	int		rc;
+
+	if (part_nrs[shard] == 0) {
+		rc = obj_shard_open(obj, shard, map_ver, &shard_oh);
 		if (rc != 0)
-			D__GOTO(out_task, rc);
+			return rc;
 
-		shard_arg = tse_task_buf_embedded(shard_task,
-						  sizeof(*shard_arg));
-		/* share the refcount taken by obj_comp_cb */
-		shard_arg->obj	   = obj;
-		shard_arg->epoch   = args->epoch;
-		shard_arg->dkey	   = args->dkey;
-		shard_arg->nr	   = args->nr;
-		shard_arg->iods	   = args->iods;
-		shard_arg->sgls	   = args->sgls;
-		shard_arg->map_ver = map_ver;
-		shard_arg->shard   = shard;
-		shard_arg->retry   = false;
+		part_nrs[shard] = dc_obj_shard_part_nr(shard_oh);
+		dc_obj_shard_close(shard_oh);
+	}
+	return hash % part_nrs[shard];
+}
 
-		/* Register retry CB.
-		 * NB: share the obj refcount taken by obj_comp_cb
-		 * which is guaranteed to be called at the end.
-		 */
-		rc = tse_task_register_comp_cb(shard_task, shard_update_cb,
-					       NULL, 0);
-		if (rc != 0) {
-			tse_task_complete(task, rc);
-			D__GOTO(out_task, rc);
+/**
+ * Add the dkey \a idx to the batches of the shards it is sent to, all the
+ * replicas of its group for update, one of them for fetch.
+ */
+static int
+obj_multi_ent_add(struct dc_object *obj, unsigned int opc,
+		  daos_dkey_io_t *io, unsigned int idx, daos_size_t len,
+		  unsigned int map_ver, unsigned int *part_nrs,
+		  struct obj_multi_ent *ents, unsigned int *ent_nr)
+{
+	uint64_t	hash;
+	int		grp_idx;
+	int		grp_size;
+	int		shard;
+	int		tag;
+	int		nr;
+	int		i;
+
+	hash = daos_hash_murmur64((unsigned char *)io->ioa_dkey->iov_buf,
+				  io->ioa_dkey->iov_len, 5731);
+	grp_idx = obj_dkey2grp(obj, hash, map_ver);
+	if (grp_idx < 0)
+		return grp_idx;
+
+	grp_size = obj_get_grp_size(obj);
+	/* one replica is enough for fetch */
+	nr = opc == DAOS_OBJ_RPC_FETCH_MULTI ? 1 : grp_size;
+	for (i = 0; i < nr; i++) {
+		if (opc == DAOS_OBJ_RPC_FETCH_MULTI) {
+			shard = obj_grp_read_shard_get(obj, grp_idx, map_ver);
+			if (shard < 0)
+				return shard;
+		} else {
+			shard = grp_idx * grp_size + i;
 		}
 
-		rc = tse_task_register_deps(task, 1, &shard_task);
+		tag = obj_multi_shard_tag(obj, shard, map_ver, hash, part_nrs);
+		if (tag == -DER_NONEXIST && opc == DAOS_OBJ_RPC_UPDATE_MULTI)
+			continue; /* skip a failed target */
+		if (tag < 0)
+			return tag;
+
+		ents[*ent_nr].ome_shard = shard;
+		ents[*ent_nr].ome_tag	= tag;
+		ents[*ent_nr].ome_idx	= idx;
+		ents[*ent_nr].ome_nr	= io->ioa_nr;
+		ents[*ent_nr].ome_len	= len;
+		(*ent_nr)++;
+	}
+	return 0;
+}
+
+/** per-dkey I/O for the dkeys which can not be batched */
+static int
+obj_multi_single_task(tse_task_t *task, unsigned int opc, daos_handle_t oh,
+		      daos_epoch_t epoch, daos_dkey_io_t *io,
+		      daos_list_t *head)
+{
+	daos_obj_fetch_t	*args;
+	tse_task_t		*io_task;
+	int			 rc;
+
+	rc = dc_task_create(opc == DAOS_OBJ_RPC_FETCH_MULTI ?
+			    dc_obj_fetch : dc_obj_update,
+			    tse_task2sched(task), NULL, &io_task);
+	if (rc != 0)
+		return rc;
+
+	D_CASSERT(sizeof(daos_obj_update_t) <= sizeof(daos_obj_fetch_t));
+	args = dc_task_get_args(io_task);
+	args->oh    = oh;
+	args->epoch = epoch;
+	args->dkey  = io->ioa_dkey;
+	args->nr    = io->ioa_nr;
+	args->iods  = io->ioa_iods;
+	args->sgls  = io->ioa_sgls;
+	args->maps  = opc == DAOS_OBJ_RPC_FETCH_MULTI ? io->ioa_maps : NULL;
+
+	rc = tse_task_register_deps(task, 1, &io_task);
+	if (rc != 0) {
+		tse_task_complete(io_task, rc);
+		return rc;
+	}
+	tse_task_list_add(io_task, head);
+	return 0;
+}
+
+/** send a batch of dkeys \a mio to its shard */
+static int
+obj_multi_shard_task(tse_task_t *task, struct dc_object *obj,
+		     unsigned int opc, daos_epoch_t epoch,
+		     struct obj_multi_io *mio, unsigned int map_ver,
+		     daos_list_t *head)
+{
+	struct shard_multi_args	*args;
+	tse_task_t		*shard_task;
+	int			 rc;
+
+	rc = tse_task_create(shard_multi_task, tse_task2sched(task), NULL,
+			     &shard_task);
+	if (rc != 0)
+		return rc;
+
+	args = tse_task_buf_embedded(shard_task, sizeof(*args));
+	/* share the refcount taken by obj_comp_cb */
+	args->obj     = obj;
+	args->mio     = mio;
+	args->epoch   = epoch;
+	args->opc     = opc;
+	args->map_ver = map_ver;
+
+	if (opc == DAOS_OBJ_RPC_FETCH_MULTI) {
+		rc = obj_read_track(shard_task, obj, mio->omi_shard, map_ver);
 		if (rc != 0) {
 			tse_task_complete(shard_task, rc);
-			D__GOTO(out_task, rc);
+			return rc;
 		}
-		tse_task_list_add(shard_task, &head);
 	}
-	tse_task_list_sched(&head, true);
+
+	rc = tse_task_register_deps(task, 1, &shard_task);
+	if (rc != 0) {
+		tse_task_complete(shard_task, rc);
+		return rc;
+	}
+	tse_task_list_add(shard_task, head);
+	return 0;
+}
+
+/**
+ * Update/fetch of many dkeys. Dkeys are grouped by the shard and the xstream
+ * they are sent to and each group is sent by one RPC, which is handled by
+ * the server in one ULT (see ds_obj_rw_multi_handler()). Batched data is
+ * always transferred inline, the dkeys with large data and the dkeys of EC
+ * objects are sent by a regular update/fetch.
+ */
+static int
+obj_multi_rw(tse_task_t *task, unsigned int opc)
+{
+	daos_obj_multi_io_t	*args = dc_task_get_args(task);
+	struct daos_oclass_attr	*oca;
+	struct dc_object	*obj;
+	struct obj_multi_ctx	*ctx = NULL;
+	struct obj_multi_ent	*ents = NULL;
+	unsigned int		*part_nrs = NULL;
+	unsigned int		 shard_nr;
+	unsigned int		 ent_max;
+	unsigned int		 ent_nr = 0;
+	unsigned int		 map_ver;
+	daos_list_t		 head;
+	bool			 batch;
+	int			 i;
+	int			 j;
+	int			 rc;
+
+	DAOS_INIT_LIST_HEAD(&head);
+	obj = obj_hdl2ptr(args->oh);
+	if (obj == NULL)
+		D__GOTO(out_task, rc = -DER_NO_HDL);
+
+	rc = tse_task_register_comp_cb(task, obj_comp_cb, &obj,
+				       sizeof(obj));
+	if (rc != 0) {
+		obj_decref(obj);
+		D__GOTO(out_task, rc);
+	}
+
+	rc = obj_ptr2pm_ver(obj, &map_ver);
+	if (rc)
+		D__GOTO(out_task, rc);
+
+	D__ALLOC_PTR(ctx);
+	if (ctx == NULL)
+		D__GOTO(out_task, rc = -DER_NOMEM);
+	DAOS_INIT_LIST_HEAD(&ctx->omc_mios);
+	ctx->omc_ios = args->io_array;
+	ctx->omc_opc = opc;
+
+	rc = tse_task_register_comp_cb(task, obj_multi_comp_cb, &ctx,
+				       sizeof(ctx));
+	if (rc != 0) {
+		D__FREE_PTR(ctx);
+		D__GOTO(out_task, rc);
+	}
+
+	oca = daos_oclass_attr_find(obj->cob_md.omd_id);
+	D__ASSERT(oca != NULL);
+	batch = oca->ca_resil != DAOS_RES_EC;
+
+	pthread_rwlock_rdlock(&obj->cob_lock);
+	shard_nr = obj->cob_layout->ol_nr;
+	pthread_rwlock_unlock(&obj->cob_lock);
+
+	ent_max = args->num_dkeys;
+	if (opc == DAOS_OBJ_RPC_UPDATE_MULTI)
+		ent_max *= obj_get_grp_size(obj);
+
+	D__ALLOC(ents, ent_max * sizeof(*ents));
+	D__ALLOC(part_nrs, shard_nr * sizeof(*part_nrs));
+	if (ents == NULL || part_nrs == NULL)
+		D__GOTO(out_free, rc = -DER_NOMEM);
+
+	for (i = 0; i < args->num_dkeys; i++) {
+		daos_dkey_io_t	*io = &args->io_array[i];
+		daos_size_t	 len = 0;
+
+		if (io->ioa_dkey == NULL || io->ioa_dkey->iov_buf == NULL ||
+		    io->ioa_nr == 0)
+			D__GOTO(out_free, rc = -DER_INVAL);
+
+		if (batch && io->ioa_sgls != NULL)
+			len = dc_obj_shard_io_len(io->ioa_nr, io->ioa_iods,
+						  io->ioa_sgls);
+
+		if (!batch || io->ioa_sgls == NULL || len >= OBJ_BULK_LIMIT) {
+			rc = obj_multi_single_task(task, opc, args->oh,
+						   args->epoch, io, &head);
+		} else {
+			rc = obj_multi_ent_add(obj, opc, io, i, len, map_ver,
+					       part_nrs, ents, &ent_nr);
+		}
+		if (rc != 0)
+			D__GOTO(out_free, rc);
+	}
+
+	qsort(ents, ent_nr, sizeof(*ents), obj_multi_ent_cmp);
+	for (i = 0; i < ent_nr; i = j) {
+		struct obj_multi_io	*mio;
+		unsigned int		 iod_nr = ents[i].ome_nr;
+		daos_size_t		 len = ents[i].ome_len;
+
+		/* dkeys of the same shard and xstream, up to the limits */
+		for (j = i + 1; j < ent_nr && j - i < OBJ_MULTI_DKEY_MAX; j++) {
+			if (ents[j].ome_shard != ents[i].ome_shard ||
+			    ents[j].ome_tag != ents[i].ome_tag ||
+			    len + ents[j].ome_len > OBJ_MULTI_DATA_LIMIT)
+				break;
+			iod_nr += ents[j].ome_nr;
+			len += ents[j].ome_len;
+		}
+
+		mio = obj_multi_io_alloc(args->io_array, &ents[i], j - i,
+					 iod_nr);
+		if (mio == NULL)
+			D__GOTO(out_free, rc = -DER_NOMEM);
+		daos_list_add_tail(&mio->omi_link, &ctx->omc_mios);
+
+		rc = obj_multi_shard_task(task, obj, opc, args->epoch, mio,
+					  map_ver, &head);
+		if (rc != 0)
+			D__GOTO(out_free, rc);
+	}
+
+	D__DEBUG(DB_IO, "%s "DF_OID" dkeys %u batched %u\n",
+		opc == DAOS_OBJ_RPC_UPDATE_MULTI ? "update" : "fetch",
+		DP_OID(obj->cob_md.omd_id), args->num_dkeys, ent_nr);
+	D__FREE(ents, ent_max * sizeof(*ents));
+	D__FREE(part_nrs, shard_nr * sizeof(*part_nrs));
+
+	if (daos_list_empty(&head))
+		tse_task_complete(task, 0);
+	else
+		tse_task_list_sched(&head, true);
 	return 0;
+
+out_free:
+	if (ents != NULL)
+		D__FREE(ents, ent_max * sizeof(*ents));
+	if (part_nrs != NULL)
+		D__FREE(part_nrs, shard_nr * sizeof(*part_nrs));
 out_task:
 	if (daos_list_empty(&head))
 		tse_task_complete(task, rc);
@@ -936,6 +1651,86 @@ out_task:
 	return rc;
 }
 
+int
+dc_obj_fetch_multi(tse_task_t *task)
+{
+	return obj_multi_rw(task, DAOS_OBJ_RPC_FETCH_MULTI);
+}
+
+int
+dc_obj_update_multi(tse_task_t *task)
+{
+	return obj_multi_rw(task, DAOS_OBJ_RPC_UPDATE_MULTI);
+}
+
+int
+dc_obj_fetch_shard(tse_task_t *task)
+{
+	daos_obj_fetch_shard_t	*args = dc_task_get_args(task);
+	struct daos_oclass_attr	*oca;
+	struct dc_object	*obj;
+	daos_handle_t		 shard_oh;
+	unsigned int		 map_ver;
+	unsigned int		 start;
+	unsigned int		 cell;
+	uint32_t		 avail;
+	int			 grp_size;
+	int			 rc;
+
+	obj = obj_hdl2ptr(args->oh);
+	if (obj == NULL)
+		D__GOTO(out_task, rc = -DER_NO_HDL);
+
+	rc = tse_task_register_comp_cb(task, obj_comp_cb, &obj,
+				       sizeof(obj));
+	if (rc != 0) {
+		/* NB: process_rc_cb() will release refcount in other cases */
+		obj_decref(obj);
+		D__GOTO(out_task, rc);
+	}
+
+	oca = daos_oclass_attr_find(obj->cob_md.omd_id);
+	D__ASSERT(oca != NULL);
+	if (oca->ca_resil != DAOS_RES_EC)
+		D__GOTO(out_task, rc = -DER_INVAL);
+
+	rc = obj_ptr2pm_ver(obj, &map_ver);
+	if (rc)
+		D__GOTO(out_task, rc);
+
+	if (args->shard >= obj->cob_layout->ol_nr)
+		D__GOTO(out_task, rc = -DER_INVAL);
+
+	grp_size = obj_get_grp_size(obj);
+	start = args->shard - args->shard % grp_size;
+	cell = args->shard - start;
+
+	rc = obj_ec_grp_avail(obj, start, grp_size, map_ver, &avail);
+	if (rc != 0)
+		D__GOTO(out_task, rc);
+
+	if (!(avail & (1U << cell))) {
+		D__DEBUG(DB_IO, "reconstruct "DF_OID" shard %u\n",
+			DP_OID(obj->cob_md.omd_id), args->shard);
+		return obj_ec_rw(task, obj, OBJ_EC_FETCH_CELL, cell,
+				 args->epoch, args->dkey, args->nr, args->iods,
+				 args->sgls, start, grp_size, avail, map_ver);
+	}
+
+	rc = obj_shard_open(obj, args->shard, map_ver, &shard_oh);
+	if (rc != 0)
+		D__GOTO(out_task, rc);
+
+	rc = dc_obj_shard_fetch(shard_oh, args->epoch, args->dkey, args->nr,
+				args->iods, args->sgls, NULL, map_ver, task);
+	dc_obj_shard_close(shard_oh);
+	return rc;
+
+out_task:
+	tse_task_complete(task, rc);
+	return rc;
+}
+
 struct obj_list_arg {
 	struct dc_object *obj;
 	daos_hash_out_t	 *anchor;
@@ -1006,7 +1801,8 @@ dc_obj_list_internal(daos_handle_t oh, uint32_t op, daos_epoch_t epoch,
 		     daos_sg_list_t *sgl, daos_recx_t *recxs,
 		     daos_epoch_range_t *eprs, uuid_t *cookies,
 		     uint32_t *versions, daos_hash_out_t *anchor,
-		     bool incr_order, bool single_shard, tse_task_t *task)
+		     bool incr_order, bool single_shard, uint32_t flags,
+		     daos_key_filter_t *filter, tse_task_t *task)
 {
 	struct dc_object	*obj;
 	unsigned int		map_ver;
@@ -1041,20 +1837,28 @@ dc_obj_list_internal(daos_handle_t oh, uint32_t op, daos_epoch_t epoch,
 	if (rc)
 		D__GOTO(out_task, rc);
 
-	if (op == DAOS_OBJ_DKEY_RPC_ENUMERATE) {
+	/* NB: enumeration has to stay on the same replica once it started,
+	 * the anchor is only meaningful to the shard it came from.
+	 */
+	if (!single_shard && daos_hash_is_zero(anchor) &&
+	    enum_anchor_get_tag(anchor) == 0) {
+		if (op == DAOS_OBJ_DKEY_RPC_ENUMERATE)
+			shard = obj_grp_read_shard_get(obj,
+				dc_obj_anchor2shard(anchor) /
+				obj_get_grp_size(obj), map_ver);
+		else
+			shard = obj_dkey2shard(obj, dkey, map_ver);
+	} else {
 		shard = dc_obj_anchor2shard(anchor);
 		shard = obj_grp_valid_shard_get(obj, shard, map_ver, op);
-		if (shard < 0)
-			D__GOTO(out_task, rc = shard);
-
-		dc_obj_shard2anchor(anchor, shard);
-	} else {
-		shard = obj_dkey2shard(obj, dkey, map_ver, op);
-		if (shard < 0)
-			D__GOTO(out_task, rc = shard);
-
-		dc_obj_shard2anchor(anchor, shard);
 	}
+	if (shard < 0)
+		D__GOTO(out_task, rc = shard);
+
+	dc_obj_shard2anchor(anchor, shard);
+	rc = obj_read_track(task, obj, shard, map_ver);
+	if (rc != 0)
+		D__GOTO(out_task, rc);
 
 	/** object will be decref by task complete cb */
 	rc = obj_shard_open(obj, shard, map_ver, &shard_oh);
@@ -1068,7 +1872,8 @@ dc_obj_list_internal(daos_handle_t oh, uint32_t op, daos_epoch_t epoch,
 					   incr_order, task);
 	else
 		rc = dc_obj_shard_list_key(shard_oh, op, epoch, dkey, nr,
-					   kds, sgl, anchor, map_ver, task);
+					   kds, sgl, anchor, map_ver, flags,
+					   filter, task);
 
 	D__DEBUG(DB_IO, "Enumerate keys in shard %d: rc %d\n", shard, rc);
 	dc_obj_shard_close(shard_oh);
@@ -1092,7 +1897,8 @@ dc_obj_list_dkey(tse_task_t *task)
 				    args->epoch, NULL, NULL, DAOS_IOD_NONE,
 				    NULL, args->nr, args->kds, args->sgl,
 				    NULL, NULL, NULL, NULL, args->anchor,
-				    true, false, task);
+				    true, false, args->flags, args->filter,
+				    task);
 }
 
 int
@@ -1107,7 +1913,8 @@ dc_obj_list_akey(tse_task_t *task)
 				    args->epoch, args->dkey, NULL,
 				    DAOS_IOD_NONE, NULL, args->nr, args->kds,
 				    args->sgl, NULL, NULL, NULL, NULL,
-				    args->anchor, true, false, task);
+				    args->anchor, true, false, 0, args->filter,
+				    task);
 }
 
 int
@@ -1123,7 +1930,7 @@ dc_obj_list_rec(tse_task_t *task)
 				    args->type, args->size, args->nr, NULL,
 				    NULL, args->recxs, args->eprs,
 				    args->cookies, args->versions, args->anchor,
-				    args->incr_order, false, task);
+				    args->incr_order, false, 0, NULL, task);
 }
 
 int
@@ -1138,7 +1945,7 @@ dc_obj_single_shard_list_dkey(tse_task_t *task)
 				    args->epoch, NULL, NULL, DAOS_IOD_NONE,
 				    NULL, args->nr, args->kds, args->sgl, NULL,
 				    NULL, NULL, NULL, args->anchor, true, true,
-				    task);
+				    args->flags, args->filter, task);
 }
 
 static int
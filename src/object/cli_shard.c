@@ -380,6 +380,20 @@ obj_shard_dkey2tag(struct dc_obj_shard *dobj, daos_key_t *dkey)
 	return hash;
 }
 
+unsigned int
+dc_obj_shard_part_nr(daos_handle_t oh)
+{
+	struct dc_obj_shard	*dobj;
+	unsigned int		 part_nr;
+
+	dobj = obj_shard_hdl2ptr(oh);
+	D__ASSERT(dobj != NULL);
+	part_nr = dobj->do_part_nr;
+	obj_shard_decref(dobj);
+
+	return part_nr;
+}
+
 static uint64_t
 iods_data_len(daos_iod_t *iods, int nr)
 {
@@ -413,6 +427,19 @@ sgls_buf_len(daos_sg_list_t *sgls, int nr)
 	return sgls_len;
 }
 
+daos_size_t
+dc_obj_shard_io_len(unsigned int nr, daos_iod_t *iods, daos_sg_list_t *sgls)
+{
+	daos_size_t len;
+
+	len = iods_data_len(iods, nr);
+	/* fetch of unknown size, let's try to get the size from sg list */
+	if (len == 0)
+		len = sgls_buf_len(sgls, nr);
+
+	return len;
+}
+
 static int
 obj_shard_rw_bulk_prep(crt_rpc_t *rpc, unsigned int nr, daos_sg_list_t *sgls,
 		       tse_task_t *task)
@@ -613,6 +640,162 @@ out_task:
 	return rc;
 }
 
+struct obj_rw_multi_args {
+	crt_rpc_t		*rpc;
+	struct dc_pool		*pool;
+	struct obj_multi_io	*mio;
+};
+
+static int
+dc_rw_multi_cb(tse_task_t *task, void *arg)
+{
+	struct obj_rw_multi_args *rw_args = arg;
+	struct obj_multi_io	 *mio = rw_args->mio;
+	struct obj_rw_out	 *orwo;
+	uint64_t		 *sizes;
+	int			  ret = task->dt_result;
+	int			  rc = 0;
+	int			  i;
+
+	if (ret != 0) {
+		D__ERROR("RPC %d failed: %d\n",
+			opc_get(rw_args->rpc->cr_opc), ret);
+		D__GOTO(out, ret);
+	}
+
+	rc = obj_reply_get_status(rw_args->rpc);
+	if (rc != 0) {
+		D__ERROR("rpc %p RPC %d failed: %d\n", rw_args->rpc,
+			opc_get(rw_args->rpc->cr_opc), rc);
+		D__GOTO(out, rc);
+	}
+
+	if (opc_get(rw_args->rpc->cr_opc) != DAOS_OBJ_RPC_FETCH_MULTI)
+		D__GOTO(out, rc);
+
+	orwo = crt_reply_get(rw_args->rpc);
+	if (orwo->orw_sizes.da_count != mio->omi_iod_nr) {
+		D__ERROR("out:%u != in:%u\n",
+			(unsigned int)orwo->orw_sizes.da_count,
+			mio->omi_iod_nr);
+		D__GOTO(out, rc = -DER_PROTO);
+	}
+
+	sizes = orwo->orw_sizes.da_arrays;
+	for (i = 0; i < mio->omi_iod_nr; i++)
+		mio->omi_iods[i].iod_size = sizes[i];
+
+	rc = dc_obj_shard_sgl_copy(mio->omi_sgls, mio->omi_iod_nr,
+				   orwo->orw_sgls.da_arrays,
+				   orwo->orw_sgls.da_count);
+out:
+	crt_req_decref(rw_args->rpc);
+	dc_pool_put(rw_args->pool);
+
+	if (ret == 0 || obj_retry_error(rc))
+		ret = rc;
+	return ret;
+}
+
+/**
+ * Send the dkeys of \a mio to the shard \a oh by one RPC, data is always
+ * transferred inline, so the caller should only batch small I/Os.
+ */
+int
+dc_obj_shard_rw_multi(daos_handle_t oh, unsigned int opc, daos_epoch_t epoch,
+		      struct obj_multi_io *mio, unsigned int map_ver,
+		      tse_task_t *task)
+{
+	struct dc_obj_shard	 *dobj;
+	struct dc_pool		 *pool = NULL;
+	struct obj_rw_multi_in	 *orm;
+	struct obj_rw_multi_args  rw_args;
+	crt_endpoint_t		  tgt_ep;
+	crt_rpc_t		 *req;
+	uuid_t			  cont_hdl_uuid;
+	uuid_t			  cont_uuid;
+	int			  rc;
+
+	D__ASSERT(opc == DAOS_OBJ_RPC_UPDATE_MULTI ||
+		  opc == DAOS_OBJ_RPC_FETCH_MULTI);
+	if (!obj_shard_io_check(mio->omi_iod_nr, mio->omi_iods))
+		D__GOTO(out_task, rc = -DER_INVAL);
+
+	dobj = obj_shard_hdl2ptr(oh);
+	if (dobj == NULL)
+		D__GOTO(out_task, rc = -DER_NO_HDL);
+
+	rc = dc_cont_hdl2uuid(dobj->do_co_hdl, &cont_hdl_uuid, &cont_uuid);
+	if (rc != 0) {
+		obj_shard_decref(dobj);
+		D__GOTO(out_task, rc);
+	}
+
+	pool = obj_shard_ptr2pool(dobj);
+	if (pool == NULL) {
+		obj_shard_decref(dobj);
+		D__GOTO(out_task, rc = -DER_NO_HDL);
+	}
+
+	tgt_ep.ep_grp = pool->dp_group;
+	tgt_ep.ep_rank = dobj->do_rank;
+	tgt_ep.ep_tag = mio->omi_tag;
+
+	D__DEBUG(DB_TRACE, "opc %d dkeys %u rank %d tag %d\n", opc,
+		mio->omi_dkey_nr, tgt_ep.ep_rank, tgt_ep.ep_tag);
+	rc = obj_req_create(daos_task2ctx(task), &tgt_ep, opc, &req);
+	if (rc != 0) {
+		obj_shard_decref(dobj);
+		D__GOTO(out_pool, rc);
+	}
+
+	orm = crt_req_get(req);
+	D__ASSERT(orm != NULL);
+
+	orm->orm_oid = dobj->do_id;
+	uuid_copy(orm->orm_co_hdl, cont_hdl_uuid);
+	uuid_copy(orm->orm_co_uuid, cont_uuid);
+	obj_shard_decref(dobj);
+
+	orm->orm_epoch = epoch;
+	orm->orm_map_ver = map_ver;
+	orm->orm_nr = mio->omi_iod_nr;
+	orm->orm_dkeys.da_count = mio->omi_dkey_nr;
+	orm->orm_dkeys.da_arrays = mio->omi_dkeys;
+	orm->orm_iod_nrs.da_count = mio->omi_dkey_nr;
+	orm->orm_iod_nrs.da_arrays = mio->omi_iod_nrs;
+	orm->orm_iods.da_count = mio->omi_iod_nr;
+	orm->orm_iods.da_arrays = mio->omi_iods;
+	orm->orm_sgls.da_count = mio->omi_iod_nr;
+	orm->orm_sgls.da_arrays = mio->omi_sgls;
+
+	crt_req_addref(req);
+	rw_args.rpc = req;
+	rw_args.pool = pool;
+	rw_args.mio = mio;
+
+	rc = tse_task_register_comp_cb(task, dc_rw_multi_cb, &rw_args,
+				       sizeof(rw_args));
+	if (rc != 0)
+		D__GOTO(out_args, rc);
+
+	rc = daos_rpc_send(req, task);
+	if (rc != 0) {
+		D__ERROR("multi update/fetch rpc failed rc %d\n", rc);
+		D__GOTO(out_args, rc);
+	}
+	return rc;
+
+out_args:
+	crt_req_decref(req);
+	crt_req_decref(req);
+out_pool:
+	dc_pool_put(pool);
+out_task:
+	tse_task_complete(task, rc);
+	return rc;
+}
+
 int
 dc_shard_punch(tse_task_t *task)
 {
@@ -815,6 +998,7 @@ dc_obj_shard_list_internal(daos_handle_t oh, enum obj_rpc_opc opc,
 			   daos_recx_t *recxs, daos_epoch_range_t *eprs,
 			   uuid_t *cookies, uint32_t *versions,
 			   daos_hash_out_t *anchor, unsigned int map_ver,
+			   uint32_t flags, daos_key_filter_t *filter,
 			   tse_task_t *task)
 {
 	crt_endpoint_t		tgt_ep;
@@ -872,6 +1056,14 @@ dc_obj_shard_list_internal(daos_handle_t oh, enum obj_rpc_opc opc,
 	oei->oei_epoch = epoch;
 	oei->oei_nr = *nr;
 	oei->oei_rec_type = type;
+	oei->oei_flags = 0;
+	if (flags & DAOS_OBJ_LIST_DKEY_LAST)
+		oei->oei_flags |= OBJ_ENUM_KEY_LAST;
+	if (filter != NULL) {
+		oei->oei_key_prefix = filter->kf_prefix;
+		oei->oei_key_lo = filter->kf_lo;
+		oei->oei_key_hi = filter->kf_hi;
+	}
 	enum_anchor_copy_hkey(&oei->oei_anchor, anchor);
 	if (sgl != NULL) {
 		oei->oei_sgl = *sgl;
@@ -942,7 +1134,7 @@ dc_obj_shard_list_rec(daos_handle_t oh, enum obj_rpc_opc opc,
 	return dc_obj_shard_list_internal(oh, opc, epoch, dkey, akey,
 					  type, size, nr, NULL, NULL,
 					  recxs, eprs, cookies, versions,
-					  anchor, map_ver, task);
+					  anchor, map_ver, 0, NULL, task);
 }
 
 int
@@ -950,10 +1142,11 @@ dc_obj_shard_list_key(daos_handle_t oh, enum obj_rpc_opc opc,
 		      daos_epoch_t epoch, daos_key_t *key, uint32_t *nr,
 		      daos_key_desc_t *kds, daos_sg_list_t *sgl,
 		      daos_hash_out_t *anchor, unsigned int map_ver,
+		      uint32_t flags, daos_key_filter_t *filter,
 		      tse_task_t *task)
 {
 	return dc_obj_shard_list_internal(oh, opc, epoch, key, NULL,
 					  DAOS_IOD_NONE, NULL, nr, kds, sgl,
 					  NULL, NULL, NULL, NULL, anchor,
-					  map_ver, task);
+					  map_ver, flags, filter, task);
 }
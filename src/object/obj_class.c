@@ -25,6 +25,12 @@
 #include "obj_internal.h"
 #include <daos_api.h>
 
+/**
+ * Cell size (records) of the predefined EC classes, array updates of these
+ * classes must cover full stripes, i.e. multiple of e_k cells.
+ */
+#define OBJ_EC_CELL_LEN		4096
+
 /** DAOS object class */
 struct daos_obj_class {
 	/** class name */
@@ -167,6 +173,36 @@ static struct daos_obj_class daos_obj_classes[] = {
 			},
 		},
 	},
+	{
+		.oc_name	= "ec_4p2_rw",
+		.oc_id		= DAOS_OC_EC_4P2_RW,
+		{
+			.ca_schema		= DAOS_OS_STRIPED,
+			.ca_resil		= DAOS_RES_EC,
+			.ca_grp_nr		= DAOS_OBJ_GRP_MAX,
+			.u.ec			= {
+				.e_grp_size	= 6,
+				.e_k		= 4,
+				.e_p		= 2,
+				.e_len		= OBJ_EC_CELL_LEN,
+			},
+		},
+	},
+	{
+		.oc_name	= "ec_8p2_rw",
+		.oc_id		= DAOS_OC_EC_8P2_RW,
+		{
+			.ca_schema		= DAOS_OS_STRIPED,
+			.ca_resil		= DAOS_RES_EC,
+			.ca_grp_nr		= DAOS_OBJ_GRP_MAX,
+			.u.ec			= {
+				.e_grp_size	= 10,
+				.e_k		= 8,
+				.e_p		= 2,
+				.e_len		= OBJ_EC_CELL_LEN,
+			},
+		},
+	},
 	{
 		.oc_name	= NULL,
 		.oc_id		= DAOS_OC_UNKNOWN,
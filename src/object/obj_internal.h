@@ -52,6 +52,14 @@ extern bool	cli_bypass_rpc;
  * this mode is for performance evaluation on low bandwidth network.
  */
 extern bool	srv_bypass_bulk;
+/**
+ * Group commit of zero-copy updates on server side, up to this number of
+ * updates of an xstream are submitted to VOS by one transaction, zero or one
+ * disables group commit.
+ */
+extern unsigned int	srv_group_commit;
+/** how long the first update of a group waits for others, in microseconds */
+extern unsigned int	srv_group_commit_window;
 
 /** Client stack object */
 struct dc_object {
@@ -74,6 +82,8 @@ struct dc_object {
 	struct pl_obj_layout	*cob_layout;
 	/** shard object handles */
 	daos_handle_t		*cob_mohs;
+	/** round-robin cursor to spread reads over idle replicas (atomic) */
+	unsigned int		 cob_rd_cursor;
 };
 
 /* client object shard */
@@ -148,8 +158,14 @@ enum_anchor_set_tag(daos_hash_out_t *anchor, uint32_t tag)
 }
 
 extern struct dss_module_key obj_module_key;
+struct obj_group;
+
 struct obj_tls {
-	d_sg_list_t	ot_echo_sgl;
+	d_sg_list_t		 ot_echo_sgl;
+	/** open group commit which is accepting updates */
+	struct obj_group	*ot_group;
+	/** zero-copy updates which are not in a group yet */
+	unsigned int		 ot_update_pending;
 };
 
 int dc_obj_shard_open(daos_handle_t coh, uint32_t tgt, daos_unit_oid_t id,
@@ -165,10 +181,40 @@ int dc_obj_shard_fetch(daos_handle_t oh, daos_epoch_t epoch,
 		       daos_iod_t *iods, daos_sg_list_t *sgls,
 		       daos_iom_t *maps, unsigned int map_ver,
 		       tse_task_t *task);
+/**
+ * Dkeys of a multi-dkey update/fetch which are sent to the same shard and
+ * xstream by one RPC, the iods and sgls of the dkeys are shallow copies of
+ * the caller's and are flattened into one array.
+ */
+struct obj_multi_io {
+	daos_list_t		 omi_link;
+	unsigned int		 omi_shard;
+	unsigned int		 omi_tag;
+	unsigned int		 omi_dkey_nr;
+	/** total number of iods */
+	unsigned int		 omi_iod_nr;
+	daos_key_t		*omi_dkeys;
+	uint32_t		*omi_iod_nrs;
+	daos_iod_t		*omi_iods;
+	daos_sg_list_t		*omi_sgls;
+	/** index of each dkey in the caller's array */
+	unsigned int		*omi_idx;
+};
+
+int dc_obj_shard_rw_multi(daos_handle_t oh, unsigned int opc,
+			  daos_epoch_t epoch, struct obj_multi_io *mio,
+			  unsigned int map_ver, tse_task_t *task);
+/** size of the data of an update/fetch, see OBJ_BULK_LIMIT */
+daos_size_t dc_obj_shard_io_len(unsigned int nr, daos_iod_t *iods,
+				daos_sg_list_t *sgls);
+/** number of xstreams of the target of \a oh, see obj_shard_dkey2tag() */
+unsigned int dc_obj_shard_part_nr(daos_handle_t oh);
+
 int dc_obj_shard_list_key(daos_handle_t oh, uint32_t op, daos_epoch_t epoch,
 			  daos_key_t *key, uint32_t *nr, daos_key_desc_t *kds,
 			  daos_sg_list_t *sgl, daos_hash_out_t *anchor,
-			  unsigned int map_ver, tse_task_t *task);
+			  unsigned int map_ver, uint32_t flags,
+			  daos_key_filter_t *filter, tse_task_t *task);
 int dc_obj_shard_list_rec(daos_handle_t oh, uint32_t op,
 		      daos_epoch_t epoch, daos_key_t *dkey,
 		      daos_key_t *akey, daos_iod_type_t type,
@@ -178,6 +224,39 @@ int dc_obj_shard_list_rec(daos_handle_t oh, uint32_t op,
 		      daos_hash_out_t *anchor, unsigned int map_ver,
 		      bool incr_order, tse_task_t *task);
 
+/** EC I/O of a redundancy group, see cli_ec.c */
+enum obj_ec_op {
+	/** update records of the object */
+	OBJ_EC_UPDATE,
+	/** fetch records of the object */
+	OBJ_EC_FETCH,
+	/** fetch shard-local extents of a cell, it is used by rebuild */
+	OBJ_EC_FETCH_CELL,
+};
+
+struct obj_ec_io;
+
+/**
+ * Prepare EC I/O of a redundancy group. Updates are split into k data cells
+ * and encoded, fetches read from the cells in \a avail and reconstruct the
+ * data cells which are not available, \a cell is the cell to fetch for
+ * OBJ_EC_FETCH_CELL.
+ */
+int obj_ec_io_create(struct daos_oclass_attr *oca, enum obj_ec_op op,
+		     int cell, uint32_t avail, unsigned int nr,
+		     daos_iod_t *iods, daos_sg_list_t *sgls,
+		     struct obj_ec_io **eio_p);
+void obj_ec_io_destroy(struct obj_ec_io *eio);
+/** bitmap of the cells of the group to send I/O to */
+uint32_t obj_ec_io_cells(struct obj_ec_io *eio);
+/** the iods and sgls to send to \a cell */
+void obj_ec_cell_io(struct obj_ec_io *eio, unsigned int cell,
+		    unsigned int *nr, daos_iod_t **iods,
+		    daos_sg_list_t **sgls);
+/** reconstruct and copy fetched data to the caller */
+int obj_ec_fetch_post(struct obj_ec_io *eio);
+void obj_ec_fini(void);
+
 static inline bool
 obj_retry_error(int err)
 {
@@ -206,6 +285,7 @@ void obj_shard_decref(struct dc_obj_shard *shard);
 
 /* srv_obj.c */
 void ds_obj_rw_handler(crt_rpc_t *rpc);
+void ds_obj_rw_multi_handler(crt_rpc_t *rpc);
 void ds_obj_enum_handler(crt_rpc_t *rpc);
 void ds_obj_punch_handler(crt_rpc_t *rpc);
 
@@ -50,6 +50,19 @@ static struct crt_msg_field *obj_rw_out_fields[] = {
 	&DMF_SGL_ARRAY, /* return buffer */
 };
 
+static struct crt_msg_field *obj_rw_multi_in_fields[] = {
+	&DMF_OID,	/* object ID */
+	&CMF_UUID,	/* container handle uuid */
+	&CMF_UUID,	/* container uuid */
+	&CMF_UINT64,	/* epoch */
+	&CMF_UINT32,	/* map_version */
+	&CMF_UINT32,	/* total count of iod and sg */
+	&DMF_KEY_ARRAY,	/* dkey array */
+	&DMF_UINT32_ARRAY, /* count of iod of each dkey */
+	&DMF_IOD_ARRAY, /* I/O descriptor array */
+	&DMF_SGL_ARRAY, /* scatter/gather array */
+};
+
 static struct crt_msg_field *obj_key_enum_in_fields[] = {
 	&DMF_OID,	/* object ID */
 	&CMF_UUID,	/* container handle uuid */
@@ -58,9 +71,12 @@ static struct crt_msg_field *obj_key_enum_in_fields[] = {
 	&CMF_UINT32,	/* map_version */
 	&CMF_UINT32,	/* number of kds */
 	&CMF_UINT32,	/* list type SINGLE/ARRAY/NONE */
-	&CMF_UINT32,	/* pad  */
+	&CMF_UINT32,	/* flags */
 	&DMF_IOVEC,     /* dkey */
 	&DMF_IOVEC,     /* akey */
+	&DMF_IOVEC,	/* key prefix */
+	&DMF_IOVEC,	/* lower bound of key range */
+	&DMF_IOVEC,	/* upper bound of key range */
 	&DMF_HASH_OUT,	/* hash anchor */
 	&DMF_SGL_DESC,	/* sgl_descriptor */
 	&CMF_BULK,	/* BULK array for dkey */
@@ -105,6 +121,16 @@ static struct crt_req_format DQF_OBJ_FETCH =
 			   obj_rw_in_fields,
 			   obj_rw_out_fields);
 
+static struct crt_req_format DQF_OBJ_UPDATE_MULTI =
+	DEFINE_CRT_REQ_FMT("DAOS_OBJ_UPDATE_MULTI",
+			   obj_rw_multi_in_fields,
+			   obj_rw_out_fields);
+
+static struct crt_req_format DQF_OBJ_FETCH_MULTI =
+	DEFINE_CRT_REQ_FMT("DAOS_OBJ_FETCH_MULTI",
+			   obj_rw_multi_in_fields,
+			   obj_rw_out_fields);
+
 static struct crt_req_format DQF_DKEY_ENUMERATE =
 	DEFINE_CRT_REQ_FMT("DAOS_DKEY_ENUM",
 			   obj_key_enum_in_fields,
@@ -184,6 +210,18 @@ struct daos_rpc daos_obj_rpcs[] = {
 		.dr_ver		= 1,
 		.dr_flags	= 0,
 		.dr_req_fmt	= &DQF_OBJ_PUNCH_AKEYS,
+	}, {
+		.dr_name	= "DAOS_OBJ_UPDATE_MULTI",
+		.dr_opc		= DAOS_OBJ_RPC_UPDATE_MULTI,
+		.dr_ver		= 1,
+		.dr_flags	= 0,
+		.dr_req_fmt	= &DQF_OBJ_UPDATE_MULTI,
+	}, {
+		.dr_name	= "DAOS_OBJ_FETCH_MULTI",
+		.dr_opc		= DAOS_OBJ_RPC_FETCH_MULTI,
+		.dr_ver		= 1,
+		.dr_flags	= 0,
+		.dr_req_fmt	= &DQF_OBJ_FETCH_MULTI,
 	}, {
 		.dr_opc		= 0
 	}
@@ -211,6 +249,8 @@ obj_reply_set_status(crt_rpc_t *rpc, int status)
 	switch (opc_get(rpc->cr_opc)) {
 	case DAOS_OBJ_RPC_UPDATE:
 	case DAOS_OBJ_RPC_FETCH:
+	case DAOS_OBJ_RPC_UPDATE_MULTI:
+	case DAOS_OBJ_RPC_FETCH_MULTI:
 		((struct obj_rw_out *)reply)->orw_ret = status;
 		break;
 	case DAOS_OBJ_DKEY_RPC_ENUMERATE:
@@ -236,6 +276,8 @@ obj_reply_get_status(crt_rpc_t *rpc)
 	switch (opc_get(rpc->cr_opc)) {
 	case DAOS_OBJ_RPC_UPDATE:
 	case DAOS_OBJ_RPC_FETCH:
+	case DAOS_OBJ_RPC_UPDATE_MULTI:
+	case DAOS_OBJ_RPC_FETCH_MULTI:
 		return ((struct obj_rw_out *)reply)->orw_ret;
 	case DAOS_OBJ_DKEY_RPC_ENUMERATE:
 	case DAOS_OBJ_AKEY_RPC_ENUMERATE:
@@ -259,6 +301,8 @@ obj_reply_map_version_set(crt_rpc_t *rpc, uint32_t map_version)
 	switch (opc_get(rpc->cr_opc)) {
 	case DAOS_OBJ_RPC_UPDATE:
 	case DAOS_OBJ_RPC_FETCH:
+	case DAOS_OBJ_RPC_UPDATE_MULTI:
+	case DAOS_OBJ_RPC_FETCH_MULTI:
 		((struct obj_rw_out *)reply)->orw_map_version = map_version;
 		break;
 	case DAOS_OBJ_DKEY_RPC_ENUMERATE:
@@ -285,6 +329,8 @@ obj_reply_map_version_get(crt_rpc_t *rpc)
 	switch (opc_get(rpc->cr_opc)) {
 	case DAOS_OBJ_RPC_UPDATE:
 	case DAOS_OBJ_RPC_FETCH:
+	case DAOS_OBJ_RPC_UPDATE_MULTI:
+	case DAOS_OBJ_RPC_FETCH_MULTI:
 		return ((struct obj_rw_out *)reply)->orw_map_version;
 	case DAOS_OBJ_DKEY_RPC_ENUMERATE:
 	case DAOS_OBJ_AKEY_RPC_ENUMERATE:
@@ -54,6 +54,8 @@ enum obj_rpc_opc {
 	DAOS_OBJ_RPC_PUNCH		= 6,
 	DAOS_OBJ_RPC_PUNCH_DKEYS	= 7,
 	DAOS_OBJ_RPC_PUNCH_AKEYS	= 8,
+	DAOS_OBJ_RPC_UPDATE_MULTI	= 9,
+	DAOS_OBJ_RPC_FETCH_MULTI	= 10,
 };
 
 struct obj_rw_in {
@@ -78,6 +80,37 @@ struct obj_rw_out {
 	struct crt_array	orw_sgls;
 };
 
+/**
+ * Update/fetch of many dkeys of an object on the same target xstream, the
+ * iods and sgls of all dkeys are flattened into one array, orm_iod_nrs has
+ * the number of iods of each dkey. Data is always transferred inline, the
+ * reply is obj_rw_out with the sizes and sgls of all the flattened iods.
+ */
+struct obj_rw_multi_in {
+	daos_unit_oid_t		orm_oid;
+	uuid_t			orm_co_hdl;
+	uuid_t			orm_co_uuid;
+	uint64_t		orm_epoch;
+	uint32_t		orm_map_ver;
+	/** total number of iods */
+	uint32_t		orm_nr;
+	struct crt_array	orm_dkeys;
+	struct crt_array	orm_iod_nrs;
+	struct crt_array	orm_iods;
+	struct crt_array	orm_sgls;
+};
+
+/** max number of dkeys in a multi-dkey RPC */
+#define OBJ_MULTI_DKEY_MAX	256
+/** max inline data of a multi-dkey RPC */
+#define OBJ_MULTI_DATA_LIMIT	(16 * OBJ_BULK_LIMIT)
+
+/** flags of object enumeration, see obj_key_enum_in::oei_flags */
+enum obj_enum_flags {
+	/** only return the greatest key of the ordered key tree */
+	OBJ_ENUM_KEY_LAST	= (1 << 0),
+};
+
 /* object Enumerate in/out */
 struct obj_key_enum_in {
 	daos_unit_oid_t		oei_oid;
@@ -87,9 +120,13 @@ struct obj_key_enum_in {
 	uint32_t		oei_map_ver;
 	uint32_t		oei_nr;
 	uint32_t		oei_rec_type;
-	uint32_t		oei_pad;
+	uint32_t		oei_flags;
 	daos_key_t		oei_dkey;
 	daos_key_t		oei_akey;
+	/** optional filter of the enumerated keys, see daos_key_filter_t */
+	daos_key_t		oei_key_prefix;
+	daos_key_t		oei_key_lo;
+	daos_key_t		oei_key_hi;
 	daos_hash_out_t		oei_anchor;
 	daos_sg_list_t		oei_sgl;
 	crt_bulk_t		oei_bulk;
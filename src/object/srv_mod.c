@@ -31,6 +31,8 @@
 #include "obj_internal.h"
 
 bool srv_bypass_bulk;
+unsigned int srv_group_commit = 16;
+unsigned int srv_group_commit_window = 100;
 
 static int
 obj_mod_init(void)
@@ -43,6 +45,17 @@ obj_mod_init(void)
 		srv_bypass_bulk = true;
 	}
 
+	env = getenv("DAOS_GROUP_COMMIT");
+	if (env != NULL)
+		srv_group_commit = daos_env2uint(env);
+
+	env = getenv("DAOS_GROUP_COMMIT_WINDOW");
+	if (env != NULL)
+		srv_group_commit_window = daos_env2uint(env);
+
+	D__DEBUG(DB_IO, "group commit %u updates, window %u us\n",
+		 srv_group_commit, srv_group_commit_window);
+
 	dss_abt_pool_choose_cb_register(DAOS_OBJ_MODULE,
 					ds_obj_abt_pool_choose_cb);
 	return 0;
@@ -88,6 +101,14 @@ static struct daos_rpc_handler obj_handlers[] = {
 		.dr_opc		= DAOS_OBJ_RPC_PUNCH_AKEYS,
 		.dr_hdlr	= ds_obj_punch_handler,
 	},
+	{
+		.dr_opc		= DAOS_OBJ_RPC_UPDATE_MULTI,
+		.dr_hdlr	= ds_obj_rw_multi_handler,
+	},
+	{
+		.dr_opc		= DAOS_OBJ_RPC_FETCH_MULTI,
+		.dr_hdlr	= ds_obj_rw_multi_handler,
+	},
 	{
 		.dr_opc		= 0
 	}
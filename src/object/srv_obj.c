@@ -32,6 +32,8 @@
 
 #include <abt.h>
 #include <daos/rpc.h>
+#include <daos/csum.h>
+#include <daos/metrics.h>
 #include <daos_srv/pool.h>
 #include <daos_srv/rebuild.h>
 #include <daos_srv/container.h>
@@ -46,6 +48,165 @@ obj_tls_get()
 	return dss_module_key_get(dss_tls_get(), &obj_module_key);
 }
 
+/**
+ * Zero-copy updates of an xstream which are submitted to VOS together. The
+ * first update of a group is the leader, it sleeps to let other updates join
+ * the group, then submits the group when the group is full, the window is
+ * over or no other update can join. The update which fills the group or is
+ * the last pending one wakes up the leader, the other updates wait for the
+ * leader to submit the group.
+ */
+struct obj_group {
+	struct vos_zc_update	*og_updates;
+	unsigned int		 og_nr;
+	unsigned int		 og_ref;
+	/** set by the leader after the group is submitted */
+	ABT_eventual		 og_eventual;
+	/** wake up the leader, no more update can join the group */
+	ABT_cond		 og_ready;
+	ABT_mutex		 og_lock;
+};
+
+static void
+obj_group_put(struct obj_group *grp)
+{
+	D__ASSERT(grp->og_ref > 0);
+	if (--grp->og_ref > 0)
+		return;
+
+	ABT_eventual_free(&grp->og_eventual);
+	ABT_cond_free(&grp->og_ready);
+	ABT_mutex_free(&grp->og_lock);
+	D__FREE(grp->og_updates, srv_group_commit * sizeof(*grp->og_updates));
+	D__FREE_PTR(grp);
+}
+
+static int
+obj_group_create(struct obj_group **grpp)
+{
+	struct obj_group	*grp;
+	int			 rc;
+
+	D__ALLOC_PTR(grp);
+	if (grp == NULL)
+		return -DER_NOMEM;
+
+	D__ALLOC(grp->og_updates, srv_group_commit * sizeof(*grp->og_updates));
+	if (grp->og_updates == NULL)
+		D__GOTO(failed, rc = -DER_NOMEM);
+
+	rc = ABT_eventual_create(0, &grp->og_eventual);
+	if (rc != ABT_SUCCESS)
+		D__GOTO(failed_updates, rc = dss_abterr2der(rc));
+
+	rc = ABT_cond_create(&grp->og_ready);
+	if (rc != ABT_SUCCESS)
+		D__GOTO(failed_eventual, rc = dss_abterr2der(rc));
+
+	rc = ABT_mutex_create(&grp->og_lock);
+	if (rc != ABT_SUCCESS)
+		D__GOTO(failed_cond, rc = dss_abterr2der(rc));
+
+	*grpp = grp;
+	return 0;
+failed_cond:
+	ABT_cond_free(&grp->og_ready);
+failed_eventual:
+	ABT_eventual_free(&grp->og_eventual);
+failed_updates:
+	D__FREE(grp->og_updates, srv_group_commit * sizeof(*grp->og_updates));
+failed:
+	D__FREE_PTR(grp);
+	return rc;
+}
+
+/**
+ * The leader waits until the group is full, no other update can join, or
+ * the group commit window is over.
+ */
+static void
+obj_group_wait(struct obj_tls *tls, struct obj_group *grp)
+{
+	struct timespec	deadline;
+	int		rc;
+
+	clock_gettime(CLOCK_REALTIME, &deadline);
+	deadline.tv_nsec += srv_group_commit_window * 1000ULL;
+	deadline.tv_sec += deadline.tv_nsec / 1000000000;
+	deadline.tv_nsec %= 1000000000;
+
+	ABT_mutex_lock(grp->og_lock);
+	while (tls->ot_group == grp && tls->ot_update_pending > 0) {
+		rc = ABT_cond_timedwait(grp->og_ready, grp->og_lock,
+					&deadline);
+		if (rc != ABT_SUCCESS) /* timed out */
+			break;
+	}
+	ABT_mutex_unlock(grp->og_lock);
+}
+
+/**
+ * Submit a zero-copy update by the group commit of the current xstream, it
+ * returns after the whole group is submitted, so the reply is only sent
+ * after the update is durable. A failed update does not fail the others,
+ * see vos_obj_zc_update_end_group().
+ */
+static int
+ds_obj_group_update_end(daos_handle_t ioh, uuid_t cookie, uint32_t pm_ver,
+			daos_key_t *dkey, unsigned int nr, daos_iod_t *iods,
+			int status)
+{
+	struct obj_tls		*tls = obj_tls_get();
+	struct obj_group	*grp = tls->ot_group;
+	struct vos_zc_update	*upd;
+	uint64_t		 start = daos_metric_tick();
+	bool			 leader = false;
+	int			 rc;
+
+	if (grp == NULL) {
+		rc = obj_group_create(&grp);
+		if (rc != 0) /* submit it alone */
+			return vos_obj_zc_update_end(ioh, cookie, pm_ver, dkey,
+						     nr, iods, status);
+		tls->ot_group = grp;
+		leader = true;
+	}
+
+	upd = &grp->og_updates[grp->og_nr++];
+	upd->zu_ioh = ioh;
+	uuid_copy(upd->zu_cookie, cookie);
+	upd->zu_pm_ver = pm_ver;
+	upd->zu_dkey = dkey;
+	upd->zu_iod_nr = nr;
+	upd->zu_iods = iods;
+	upd->zu_rc = status;
+	grp->og_ref++;
+	if (grp->og_nr == srv_group_commit)
+		tls->ot_group = NULL; /* full */
+
+	if (leader) {
+		obj_group_wait(tls, grp);
+		if (tls->ot_group == grp)
+			tls->ot_group = NULL;
+
+		vos_obj_zc_update_end_group(grp->og_updates, grp->og_nr);
+		daos_metric_record(DMH_OBJ_GROUP_COMMIT, grp->og_nr);
+		ABT_eventual_set(grp->og_eventual, NULL, 0);
+	} else {
+		if (tls->ot_group != grp || tls->ot_update_pending == 0) {
+			ABT_mutex_lock(grp->og_lock);
+			ABT_cond_signal(grp->og_ready);
+			ABT_mutex_unlock(grp->og_lock);
+		}
+		ABT_eventual_wait(grp->og_eventual, NULL);
+	}
+
+	rc = upd->zu_rc;
+	daos_metric_tock(DMH_OBJ_GROUP_WAIT, start);
+	obj_group_put(grp);
+	return rc;
+}
+
 /**
  * After bulk finish, let's send reply, then release the resource.
  */
@@ -61,7 +222,16 @@ ds_obj_rw_complete(crt_rpc_t *rpc, daos_handle_t ioh, int status,
 		orwi = crt_req_get(rpc);
 		D__ASSERT(orwi != NULL);
 
-		if (opc_get(rpc->cr_opc) == DAOS_OBJ_RPC_UPDATE) {
+		if (opc_get(rpc->cr_opc) == DAOS_OBJ_RPC_UPDATE &&
+		    srv_group_commit > 1) {
+			obj_tls_get()->ot_update_pending--;
+			rc = ds_obj_group_update_end(ioh, cookie, map_version,
+						     &orwi->orw_dkey,
+						     orwi->orw_nr,
+						     orwi->orw_iods.da_arrays,
+						     status);
+
+		} else if (opc_get(rpc->cr_opc) == DAOS_OBJ_RPC_UPDATE) {
 			rc = vos_obj_zc_update_end(ioh, cookie, map_version,
 						   &orwi->orw_dkey,
 						   orwi->orw_nr,
@@ -153,6 +323,60 @@ bulk_complete_cb(const struct crt_bulk_cb_info *cb_info)
 	return rc;
 }
 
+/** bulk transfer of a segment of zero-copy buffers which need checksums */
+struct ds_bulk_csum_args {
+	struct ds_bulk_async_args	*bc_args;
+	daos_iov_t			*bc_iovs;
+	/** checksums of the iovs, see vos_obj_zc_csum_at() */
+	struct daos_csum_ctx		*bc_csums;
+	unsigned int			 bc_nr;
+};
+
+static int
+bulk_csum_complete_cb(const struct crt_bulk_cb_info *cb_info)
+{
+	struct ds_bulk_csum_args	*csum_args;
+	struct crt_bulk_cb_info		 info = *cb_info;
+	int				 i;
+
+	csum_args = (struct ds_bulk_csum_args *)cb_info->bci_arg;
+	/* checksum the data of this segment while the other segments are
+	 * still being transferred, so VOS doesn't have to read it again.
+	 */
+	for (i = 0; cb_info->bci_rc == 0 && i < csum_args->bc_nr; i++)
+		daos_csum_update(&csum_args->bc_csums[i],
+				 csum_args->bc_iovs[i].iov_buf,
+				 csum_args->bc_iovs[i].iov_len);
+
+	info.bci_arg = csum_args->bc_args;
+	D__FREE_PTR(csum_args);
+	return bulk_complete_cb(&info);
+}
+
+static int
+bulk_csum_transfer(struct crt_bulk_desc *bulk_desc,
+		   struct ds_bulk_async_args *arg, daos_sg_list_t *sgl,
+		   struct daos_csum_ctx *csums, crt_bulk_opid_t *bulk_opid)
+{
+	struct ds_bulk_csum_args	*csum_args;
+	int				 rc;
+
+	D__ALLOC_PTR(csum_args);
+	if (csum_args == NULL)
+		return -DER_NOMEM;
+
+	csum_args->bc_args  = arg;
+	csum_args->bc_iovs  = sgl->sg_iovs;
+	csum_args->bc_csums = csums;
+	csum_args->bc_nr    = sgl->sg_nr.num;
+
+	rc = crt_bulk_transfer(bulk_desc, bulk_csum_complete_cb, csum_args,
+			       bulk_opid);
+	if (rc < 0)
+		D__FREE_PTR(csum_args);
+	return rc;
+}
+
 /**
  * Simulate bulk transfer by memcpy, all data are actually dropped.
  */
@@ -205,6 +429,7 @@ ds_bulk_transfer(crt_rpc_t *rpc, crt_bulk_op_t bulk_op,
 	int			i;
 	int			rc;
 	int			*status;
+	uint64_t		start = daos_metric_tick();
 
 	bulk_perm = bulk_op == CRT_BULK_PUT ? CRT_BULK_RO : CRT_BULK_RW;
 	rc = ABT_eventual_create(sizeof(*status), &arg.eventual);
@@ -213,6 +438,7 @@ ds_bulk_transfer(crt_rpc_t *rpc, crt_bulk_op_t bulk_op,
 
 	for (i = 0; i < sgl_nr; i++) {
 		daos_sg_list_t		*sgl;
+		struct daos_csum_ctx	*csums = NULL;
 		struct crt_bulk_desc	 bulk_desc;
 		crt_bulk_t		 local_bulk_hdl;
 		int			 ret = 0;
@@ -233,6 +459,9 @@ ds_bulk_transfer(crt_rpc_t *rpc, crt_bulk_op_t bulk_op,
 				continue;
 			}
 			D__ASSERT(sgl != NULL);
+
+			if (bulk_op == CRT_BULK_GET)
+				vos_obj_zc_csum_at(ioh, i, &csums);
 		}
 
 		if (srv_bypass_bulk) {
@@ -307,8 +536,15 @@ ds_bulk_transfer(crt_rpc_t *rpc, crt_bulk_op_t bulk_op,
 			bulk_desc.bd_local_off	= 0;
 
 			arg.bulks_inflight++;
-			ret = crt_bulk_transfer(&bulk_desc, bulk_complete_cb,
-						&arg, &bulk_opid);
+			if (csums != NULL)
+				ret = bulk_csum_transfer(&bulk_desc, &arg,
+							 &sgl_sent,
+							 &csums[start],
+							 &bulk_opid);
+			else
+				ret = crt_bulk_transfer(&bulk_desc,
+							bulk_complete_cb,
+							&arg, &bulk_opid);
 			if (ret < 0) {
 				D__ERROR("crt_bulk_transfer failed, rc: %d.\n",
 					ret);
@@ -317,6 +553,8 @@ ds_bulk_transfer(crt_rpc_t *rpc, crt_bulk_op_t bulk_op,
 				crt_req_decref(rpc);
 				if (rc == 0)
 					rc = ret;
+			} else {
+				daos_metric_inc(DMC_BULK_BYTES, length);
 			}
 			offset += length;
 		}
@@ -334,6 +572,7 @@ ds_bulk_transfer(crt_rpc_t *rpc, crt_bulk_op_t bulk_op,
 	/* arg.result might not be set through bulk_complete_cb */
 	if (rc == 0)
 		rc = arg.result;
+	daos_metric_tock(DMH_BULK, start);
 out_eventual:
 	ABT_eventual_free(&arg.eventual);
 	return rc;
@@ -630,6 +869,8 @@ ds_obj_rw_handler(crt_rpc_t *rpc)
 	daos_handle_t		ioh = DAOS_HDL_INVAL;
 	crt_bulk_op_t		bulk_op;
 	uint32_t		map_version = 0;
+	uint64_t		start;
+	bool			update;
 	int			rc;
 
 	orw = crt_req_get(rpc);
@@ -638,6 +879,10 @@ ds_obj_rw_handler(crt_rpc_t *rpc)
 	if (daos_obj_id2class(orw->orw_oid.id_pub) == DAOS_OC_ECHO_RW)
 		return ds_obj_rw_echo_handler(rpc);
 
+	update = opc_get(rpc->cr_opc) == DAOS_OBJ_RPC_UPDATE;
+	start = daos_metric_tick();
+	daos_metric_gauge_add(DMG_OBJ_INFLIGHT, 1);
+
 	rc = ds_check_container(orw->orw_co_hdl, orw->orw_co_uuid,
 				&cont_hdl, &cont);
 	if (rc)
@@ -683,6 +928,8 @@ ds_obj_rw_handler(crt_rpc_t *rpc)
 			D__GOTO(out, rc);
 		}
 
+		if (srv_group_commit > 1)
+			obj_tls_get()->ot_update_pending++;
 		bulk_op = CRT_BULK_GET;
 	} else {
 		struct obj_rw_out *orwo = crt_reply_get(rpc);
@@ -725,6 +972,141 @@ out:
 			ds_cont_put(cont); /* -1 for rebuild container */
 		ds_cont_hdl_put(cont_hdl);
 	}
+
+	daos_metric_gauge_add(DMG_OBJ_INFLIGHT, -1);
+	daos_metric_inc(update ? DMC_OBJ_UPDATE : DMC_OBJ_FETCH, 1);
+	daos_metric_tock(update ? DMH_OBJ_UPDATE : DMH_OBJ_FETCH, start);
+}
+
+/**
+ * Update/fetch of many dkeys in one ULT, the container handle is looked up
+ * and the map version is checked once for all of them. The dkeys are
+ * processed in order and the first failure is returned.
+ */
+void
+ds_obj_rw_multi_handler(crt_rpc_t *rpc)
+{
+	struct obj_rw_multi_in	*orm;
+	struct obj_rw_out	*orwo;
+	struct ds_cont_hdl	*cont_hdl = NULL;
+	struct ds_cont		*cont = NULL;
+	daos_key_t		*dkeys;
+	uint32_t		*iod_nrs;
+	daos_iod_t		*iods;
+	daos_sg_list_t		*sgls;
+	uint64_t		*sizes = NULL;
+	uint32_t		 map_version = 0;
+	uint64_t		 start;
+	unsigned int		 off;
+	bool			 update;
+	int			 i;
+	int			 rc;
+
+	orm = crt_req_get(rpc);
+	orwo = crt_reply_get(rpc);
+	D__ASSERT(orm != NULL && orwo != NULL);
+
+	update = opc_get(rpc->cr_opc) == DAOS_OBJ_RPC_UPDATE_MULTI;
+	start = daos_metric_tick();
+	daos_metric_gauge_add(DMG_OBJ_INFLIGHT, 1);
+
+	dkeys = orm->orm_dkeys.da_arrays;
+	iod_nrs = orm->orm_iod_nrs.da_arrays;
+	iods = orm->orm_iods.da_arrays;
+	sgls = orm->orm_sgls.da_arrays;
+	if (orm->orm_iod_nrs.da_count != orm->orm_dkeys.da_count ||
+	    orm->orm_iods.da_count != orm->orm_nr ||
+	    orm->orm_sgls.da_count != orm->orm_nr)
+		D__GOTO(out, rc = -DER_PROTO);
+
+	rc = ds_check_container(orm->orm_co_hdl, orm->orm_co_uuid,
+				&cont_hdl, &cont);
+	if (rc)
+		D__GOTO(out, rc);
+
+	if (update && !(cont_hdl->sch_capas & DAOS_COO_RW))
+		D__GOTO(out, rc = -DER_NO_PERM);
+
+	D__ASSERT(cont_hdl->sch_pool != NULL);
+	map_version = cont_hdl->sch_pool->spc_map_version;
+	if (orm->orm_map_ver < map_version) {
+		/* see ds_obj_rw_handler() */
+		D__WARN("stale version req %d map_version %d\n",
+			orm->orm_map_ver, map_version);
+		if (!update)
+			D__GOTO(out, rc = -DER_STALE);
+	}
+
+	if (!update) {
+		D__ALLOC(sizes, orm->orm_nr * sizeof(*sizes));
+		if (sizes == NULL)
+			D__GOTO(out, rc = -DER_NOMEM);
+	}
+
+	D__DEBUG(DB_TRACE, "opc %d "DF_UOID" dkeys %u tag %d\n",
+		opc_get(rpc->cr_opc), DP_UOID(orm->orm_oid),
+		(unsigned int)orm->orm_dkeys.da_count,
+		dss_get_module_info()->dmi_tid);
+
+	for (i = 0, off = 0; i < orm->orm_dkeys.da_count; i++) {
+		if (iod_nrs[i] == 0 || off + iod_nrs[i] > orm->orm_nr)
+			D__GOTO(out, rc = -DER_PROTO);
+		off += iod_nrs[i];
+	}
+
+	if (off != orm->orm_nr)
+		D__GOTO(out, rc = -DER_PROTO);
+
+	/* all dkeys are applied in one transaction, or none of them */
+	if (update)
+		rc = vos_obj_update_multi(cont->sc_hdl, orm->orm_oid,
+					  orm->orm_epoch, cont_hdl->sch_uuid,
+					  map_version, orm->orm_dkeys.da_count,
+					  dkeys, iod_nrs, iods, sgls);
+	else
+		rc = vos_obj_fetch_multi(cont->sc_hdl, orm->orm_oid,
+					 orm->orm_epoch,
+					 orm->orm_dkeys.da_count, dkeys,
+					 iod_nrs, iods, sgls);
+	if (rc != 0) {
+		D__ERROR(DF_UOID" %u dkeys %s failed: %d\n",
+			DP_UOID(orm->orm_oid),
+			(unsigned int)orm->orm_dkeys.da_count,
+			update ? "update" : "fetch", rc);
+		D__GOTO(out, rc);
+	}
+
+	if (!update) {
+		for (i = 0; i < orm->orm_nr; i++)
+			sizes[i] = iods[i].iod_size;
+
+		orwo->orw_sizes.da_arrays = sizes;
+		orwo->orw_sizes.da_count = orm->orm_nr;
+		orwo->orw_sgls.da_arrays = sgls;
+		orwo->orw_sgls.da_count = orm->orm_nr;
+	}
+out:
+	orwo->orw_ret = rc;
+	orwo->orw_map_version = map_version;
+	rc = crt_reply_send(rpc);
+	if (rc != 0)
+		D__ERROR("send reply failed: %d\n", rc);
+
+	if (sizes != NULL)
+		D__FREE(sizes, orm->orm_nr * sizeof(*sizes));
+	orwo->orw_sizes.da_arrays = NULL;
+	orwo->orw_sizes.da_count = 0;
+
+	if (cont_hdl) {
+		if (!cont_hdl->sch_cont)
+			ds_cont_put(cont); /* -1 for rebuild container */
+		ds_cont_hdl_put(cont_hdl);
+	}
+
+	daos_metric_gauge_add(DMG_OBJ_INFLIGHT, -1);
+	daos_metric_inc(update ? DMC_OBJ_UPDATE : DMC_OBJ_FETCH,
+			orm->orm_dkeys.da_count);
+	daos_metric_tock(update ? DMH_OBJ_UPDATE : DMH_OBJ_FETCH, start);
 }
 
 static void
@@ -845,6 +1227,9 @@ fill_rec(vos_iter_entry_t *key_ent, struct obj_key_enum_in *oei,
 	return 0;
 }
 
+/** number of entries fetched from VOS at a time by enumeration */
+#define DS_ITER_BATCH	16
+
 struct ds_iter_arg {
 	struct obj_key_enum_in *oei;
 	struct obj_key_enum_out *oeo;
@@ -871,10 +1256,15 @@ ds_iter_single_vos(void *data)
 	struct ds_cont_hdl	*cont_hdl;
 	struct ds_cont		*cont;
 	vos_iter_entry_t	key_ent;
+	vos_iter_entry_t	*ents = NULL;
+	daos_hash_out_t		*anchors = NULL;
 	vos_iter_param_t	param;
 	daos_handle_t		ih;
 	daos_hash_out_t		*probe_hash;
+	unsigned int		nr;
+	bool			end = false;
 	int			type;
+	int			i;
 	int			rc;
 
 	rc = ds_check_container(oei->oei_co_hdl, oei->oei_co_uuid,
@@ -927,7 +1317,18 @@ ds_iter_single_vos(void *data)
 		} else {
 			if (oei->oei_akey.iov_len > 0)
 				param.ip_akey = oei->oei_akey;
+			/* the greatest key is the first one in reverse order */
+			if (oei->oei_flags & OBJ_ENUM_KEY_LAST)
+				param.ip_flags |= VOS_IT_KEY_REVERSE;
 		}
+		/* enumerate a snapshot of the key tree, e.g. for rebuild
+		 * scan, so the returned keys are a consistent view of it.
+		 */
+		param.ip_flags |= VOS_IT_SNAPSHOT;
+		/* filter keys in VOS, only the matched ones are returned */
+		param.ip_key_prefix = oei->oei_key_prefix;
+		param.ip_key_lo = oei->oei_key_lo;
+		param.ip_key_hi = oei->oei_key_hi;
 	}
 
 	D__DEBUG(DB_TRACE, ""DF_UOID" iterate type %d tag %d\n",
@@ -958,24 +1359,54 @@ ds_iter_single_vos(void *data)
 		D__GOTO(out_iter_fini, rc);
 	}
 
-	while (iter_arg->key_nr < oei->oei_nr) {
-		rc = vos_iter_fetch(ih, &key_ent, &oeo->oeo_anchor);
-		if (rc != 0)
-			break;
+	D__ALLOC(ents, DS_ITER_BATCH * sizeof(*ents));
+	D__ALLOC(anchors, DS_ITER_BATCH * sizeof(*anchors));
+	if (ents == NULL || anchors == NULL)
+		D__GOTO(out_iter_fini, rc = -DER_NOMEM);
 
-		/* fill the key to iov if there are enough space */
-		if (type == VOS_ITER_AKEY || type == VOS_ITER_DKEY)
-			rc = fill_key(&key_ent, oei, oeo, &iter_arg->key_nr,
-				      &iter_arg->iovs_idx);
+	while (iter_arg->key_nr < oei->oei_nr && !end) {
+		/* only need one key, then move to the next target */
+		if (oei->oei_flags & OBJ_ENUM_KEY_LAST)
+			nr = 1;
 		else
-			rc = fill_rec(&key_ent, oei, oeo, &iter_arg->key_nr);
+			nr = min(oei->oei_nr - iter_arg->key_nr,
+				 DS_ITER_BATCH);
 
-		if (rc != 0) {
-			if (rc == 1)
-				rc = vos_iter_next(ih);
+		rc = vos_iter_fetch_batch(ih, ents, anchors, &nr);
+		if (rc == -DER_NONEXIST)
+			end = true;
+		else if (rc != 0)
+			break;
+
+		for (i = 0, rc = 0; i < nr && rc == 0; i++) {
+			/* fill the key to iov if there are enough space */
+			if (type == VOS_ITER_AKEY || type == VOS_ITER_DKEY)
+				rc = fill_key(&ents[i], oei, oeo,
+					      &iter_arg->key_nr,
+					      &iter_arg->iovs_idx);
+			else
+				rc = fill_rec(&ents[i], oei, oeo,
+					      &iter_arg->key_nr);
+		}
+
+		if (rc < 0)
 			break;
+
+		if (rc == 1 && i < nr) {
+			/* full, resume from the first unused entry */
+			oeo->oeo_anchor = anchors[i];
+			D__GOTO(out_iter_fini, rc = 0);
 		}
-		vos_iter_next(ih);
+
+		if (rc == 1) {
+			/* full, the cursor is at the first unused entry */
+			rc = end ? -DER_NONEXIST : 0;
+			break;
+		}
+
+		if (oei->oei_flags & OBJ_ENUM_KEY_LAST)
+			end = true;
+		rc = end ? -DER_NONEXIST : 0;
 	}
 
 	if (rc == 0) /* anchor for the next call */
@@ -987,6 +1418,10 @@ ds_iter_single_vos(void *data)
 	}
 	D_EXIT;
 out_iter_fini:
+	if (ents != NULL)
+		D__FREE(ents, DS_ITER_BATCH * sizeof(*ents));
+	if (anchors != NULL)
+		D__FREE(anchors, DS_ITER_BATCH * sizeof(*anchors));
 	vos_iter_finish(ih);
 out_cont_hdl:
 	if (!cont_hdl->sch_cont)
@@ -411,6 +411,15 @@ pool_hdl_key_cmp(struct dhash_table *htable, daos_list_t *rlink,
 	return uuid_compare(hdl->sph_uuid, key) == 0;
 }
 
+static int
+pool_hdl_key_get(struct dhash_table *htable, daos_list_t *rlink, void **key_pp)
+{
+	struct ds_pool_hdl *hdl = pool_hdl_obj(rlink);
+
+	*key_pp = hdl->sph_uuid;
+	return sizeof(uuid_t);
+}
+
 static void
 pool_hdl_rec_addref(struct dhash_table *htable, daos_list_t *rlink)
 {
@@ -441,6 +450,7 @@ pool_hdl_rec_free(struct dhash_table *htable, daos_list_t *rlink)
 }
 
 static dhash_table_ops_t pool_hdl_hash_ops = {
+	.hop_key_get	= pool_hdl_key_get,
 	.hop_key_cmp	= pool_hdl_key_cmp,
 	.hop_rec_addref	= pool_hdl_rec_addref,
 	.hop_rec_decref	= pool_hdl_rec_decref,
@@ -640,7 +640,18 @@ rdb_raft_result_key_cmp(struct dhash_table *htable, daos_list_t *rlink,
 	return memcmp(&result->drr_index, key, sizeof(result->drr_index)) == 0;
 }
 
+static int
+rdb_raft_result_key_get(struct dhash_table *htable, daos_list_t *rlink,
+			void **key_pp)
+{
+	struct rdb_raft_result *result = rdb_raft_result_obj(rlink);
+
+	*key_pp = &result->drr_index;
+	return sizeof(result->drr_index);
+}
+
 static dhash_table_ops_t rdb_raft_result_hash_ops = {
+	.hop_key_get = rdb_raft_result_key_get,
 	.hop_key_cmp = rdb_raft_result_key_cmp
 };
 
@@ -696,6 +707,7 @@ rdb_raft_append_apply(struct rdb *db, void *entry, size_t size, void *result)
 	msg_entry_t		mentry;
 	msg_entry_response_t	mresponse;
 	struct rdb_raft_state	state;
+	uint64_t		start = daos_metric_tick();
 	int			rc;
 
 	mentry.term = raft_get_current_term(db->d_raft);
@@ -711,6 +723,7 @@ rdb_raft_append_apply(struct rdb *db, void *entry, size_t size, void *result)
 		D__ERROR(DF_DB": failed to append entry: %d\n", DP_DB(db), rc);
 		return rc;
 	}
+	daos_metric_inc(DMC_RDB_APPEND, 1);
 
 	if (result != NULL) {
 		/*
@@ -726,6 +739,7 @@ rdb_raft_append_apply(struct rdb *db, void *entry, size_t size, void *result)
 
 	if (result != NULL)
 		rdb_raft_unregister_result(db, mresponse.idx);
+	daos_metric_tock(DMH_RDB_APPEND, start);
 	return rc;
 }
 
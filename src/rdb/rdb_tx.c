@@ -569,6 +569,62 @@ rdb_tx_apply_op(struct rdb *db, struct rdb_tx_op *op, daos_list_t *destroyed)
 	return rc;
 }
 
+/* Maximal number of updates applied by one rdb_tx_apply_updates() call */
+#define RDB_TX_BATCH_MAX	64
+
+/*
+ * Apply the update \a op together with the updates of the same KVS that
+ * immediately follow it in \a buf, by a single dbtree_update_batch() call.
+ * Return the length of \a buf consumed by the following updates, or an
+ * error. An undecodable op stops the batch and is left to the caller.
+ */
+static ssize_t
+rdb_tx_apply_updates(struct rdb *db, struct rdb_tx_op *op, const void *buf,
+		     size_t len)
+{
+	daos_iov_t		keys[RDB_TX_BATCH_MAX];
+	daos_iov_t		values[RDB_TX_BATCH_MAX];
+	struct rdb_tree	       *tree;
+	const void	       *p = buf;
+	unsigned int		nr = 1;
+	int			rc;
+
+	D__ASSERT(op->dto_opc == RDB_TX_UPDATE);
+	keys[0] = op->dto_key;
+	values[0] = op->dto_value;
+
+	while (p < buf + len && nr < RDB_TX_BATCH_MAX) {
+		struct rdb_tx_op	next;
+		ssize_t			n;
+
+		n = rdb_tx_op_decode(p, buf + len - p, &next);
+		if (n < 0 || next.dto_opc != RDB_TX_UPDATE ||
+		    next.dto_kvs.iov_len != op->dto_kvs.iov_len ||
+		    memcmp(next.dto_kvs.iov_buf, op->dto_kvs.iov_buf,
+			   op->dto_kvs.iov_len) != 0)
+			break;
+
+		keys[nr] = next.dto_key;
+		values[nr] = next.dto_value;
+		nr++;
+		p += n;
+	}
+
+	D__DEBUG(DB_ANY, DF_DB": "DF_TX_OP" + %u updates\n", DP_DB(db),
+		DP_TX_OP(op), nr - 1);
+
+	rc = rdb_tree_lookup(db, &op->dto_kvs, &tree);
+	if (rc != 0)
+		return rc;
+
+	rc = dbtree_update_batch(tree->de_hdl, nr, keys, values);
+	rdb_tree_put(db, tree);
+	if (rc != 0)
+		return rc;
+
+	return p - buf;
+}
+
 /* Is "error" deterministic? */
 static inline bool
 rdb_tx_deterministic_error(int error)
@@ -609,7 +665,16 @@ rdb_tx_apply(struct rdb *db, uint64_t index, const void *buf, size_t len,
 					len, p);
 				pmemobj_tx_abort(n);
 			}
-			rc = rdb_tx_apply_op(db, &op, destroyed);
+			p += n;
+			if (op.dto_opc == RDB_TX_UPDATE) {
+				/* Consecutive updates of a KVS are batched. */
+				n = rdb_tx_apply_updates(db, &op, p,
+							 buf + len - p);
+				rc = n < 0 ? n : 0;
+			} else {
+				n = 0;
+				rc = rdb_tx_apply_op(db, &op, destroyed);
+			}
 			if (rc != 0) {
 				if (!rdb_tx_deterministic_error(rc))
 					D__ERROR(DF_DB": failed to apply entry "
@@ -69,11 +69,33 @@ rebuild_get_nstream_idx(daos_key_t *dkey)
 	return hash;
 }
 
+/**
+ * Shards of an EC group store different cells, so the extents of the shard
+ * being rebuilt are fetched by its shard-local indices, they are
+ * reconstructed from the other shards of the group.
+ */
+static int
+rebuild_fetch(struct rebuild_dkey *rdkey, daos_handle_t oh, daos_iod_t *iod,
+	      daos_sg_list_t *sgl)
+{
+	struct daos_oclass_attr	*oca;
+
+	oca = daos_oclass_attr_find(rdkey->rd_oid.id_pub);
+	if (oca != NULL && oca->ca_resil == DAOS_RES_EC &&
+	    iod->iod_type == DAOS_IOD_ARRAY)
+		return ds_obj_fetch_shard(oh, rdkey->rd_epoch, &rdkey->rd_dkey,
+					  rdkey->rd_oid.id_shard, 1, iod, sgl);
+
+	return ds_obj_fetch(oh, rdkey->rd_epoch, &rdkey->rd_dkey, 1, iod,
+			    sgl, NULL);
+}
+
 #define MAX_BUF_SIZE 2048
 static int
 rebuild_fetch_update_inline(struct rebuild_dkey *rdkey, daos_handle_t oh,
 			    daos_key_t *akey, unsigned int num,
-			    unsigned int type, daos_recx_t *recxs,
+			    unsigned int type, daos_size_t size,
+			    daos_recx_t *recxs,
 			    daos_epoch_range_t *eprs, uuid_t cookie,
 			    uint32_t version, struct ds_cont *ds_cont)
 {
@@ -94,9 +116,9 @@ rebuild_fetch_update_inline(struct rebuild_dkey *rdkey, daos_handle_t oh,
 	iod.iod_eprs = eprs;
 	iod.iod_nr = num;
 	iod.iod_type = type;
+	iod.iod_size = size;
 
-	rc = ds_obj_fetch(oh, rdkey->rd_epoch, &rdkey->rd_dkey, 1, &iod,
-			  &sgl, NULL);
+	rc = rebuild_fetch(rdkey, oh, &iod, &sgl);
 	if (rc)
 		return rc;
 
@@ -138,8 +160,7 @@ rebuild_fetch_update_bulk(struct rebuild_dkey *rdkey, daos_handle_t oh,
 	if (rc)
 		D__GOTO(end, rc);
 
-	rc = ds_obj_fetch(oh, rdkey->rd_epoch, &rdkey->rd_dkey, 1, &iod,
-			  sgl, NULL);
+	rc = rebuild_fetch(rdkey, oh, &iod, sgl);
 	if (rc)
 		D__GOTO(end, rc);
 end:
@@ -160,8 +181,8 @@ rebuild_fetch_update(struct rebuild_dkey *rdkey, daos_handle_t oh,
 	buf_size = size * num;
 	if (buf_size < MAX_BUF_SIZE)
 		return rebuild_fetch_update_inline(rdkey, oh, akey, num, type,
-						   recxs, eprs, cookie, version,
-						   ds_cont);
+						   size, recxs, eprs, cookie,
+						   version, ds_cont);
 	else
 		return rebuild_fetch_update_bulk(rdkey, oh, akey, num, type,
 						 size, recxs, eprs, cookie,
@@ -244,6 +265,7 @@ next:
 		dss_get_module_info()->dmi_tid);
 
 	tls->rebuild_pool_rec_count += total;
+	daos_metric_inc(DMC_REBUILD_REC, total);
 
 	return rc;
 }
@@ -437,8 +459,13 @@ rebuild_dkey_ult(void *arg)
 		ABT_mutex_unlock(puller->rp_lock);
 
 		daos_list_for_each_entry_safe(rdkey, tmp, &dkey_list, rd_list) {
+			uint64_t	start = daos_metric_tick();
+
 			daos_list_del(&rdkey->rd_list);
+			daos_metric_gauge_add(DMG_REBUILD_INFLIGHT, 1);
 			rc = rebuild_one_dkey(rpt, rdkey);
+			daos_metric_gauge_add(DMG_REBUILD_INFLIGHT, -1);
+			daos_metric_tock(DMH_REBUILD_DKEY, start);
 			D__DEBUG(DB_TRACE, DF_UOID" rebuild dkey %.*s rc = %d"
 				" tag %d\n", DP_UOID(rdkey->rd_oid),
 				(int)rdkey->rd_dkey.iov_len,
@@ -785,7 +812,7 @@ rebuild_obj_hdl_get(struct rebuild_tgt_pool_tracker *rpt, daos_handle_t *hdl)
 	}
 
 	memset(&uma, 0, sizeof(uma));
-	uma.uma_id = UMEM_CLASS_VMEM;
+	uma.uma_id = UMEM_CLASS_VMEM_SLAB;
 	rc = dbtree_create_inplace(DBTREE_CLASS_NV, 0, 4, &uma,
 				   &rpt->rt_local_root,
 				   &rpt->rt_local_root_hdl);
@@ -812,6 +839,7 @@ rebuild_obj_handler(crt_rpc_t *rpc)
 	uint32_t			*shards;
 	unsigned int			shards_count;
 	daos_handle_t			btr_hdl;
+	unsigned int			nr;
 	unsigned int			i;
 	int				rc;
 
@@ -844,32 +872,35 @@ rebuild_obj_handler(crt_rpc_t *rpc)
 	if (rc)
 		D__GOTO(out, rc);
 
-	/* Insert these oids/conts into the local rebuild tree */
-	for (i = 0; i < oids_count; i++) {
-		rc = rebuild_cont_obj_insert(btr_hdl, co_uuids[i],
-					     oids[i], shards[i]);
-		if (rc == 1) {
-			D__DEBUG(DB_TRACE, "insert local "DF_UOID" "DF_UUID
-				" %u hdl %"PRIx64"\n", DP_UOID(oids[i]),
-				DP_UUID(co_uuids[i]), shards[i],
-				btr_hdl.cookie);
-		} else if (rc == 0) {
+	/*
+	 * Insert these oids/conts into the local rebuild tree, objects of
+	 * the same container are inserted by one batch.
+	 */
+	for (i = 0; i < oids_count; i += nr) {
+		for (nr = 1; i + nr < oids_count; nr++) {
+			if (uuid_compare(co_uuids[i], co_uuids[i + nr]) != 0)
+				break;
+		}
+
+		rc = rebuild_cont_objs_insert(btr_hdl, co_uuids[i], &oids[i],
+					      &shards[i], nr);
+		if (rc < 0)
+			D__GOTO(out, rc);
+
+		D__DEBUG(DB_TRACE, "insert local %d/%u objects of "DF_UUID
+			" hdl %"PRIx64"\n", rc, nr, DP_UUID(co_uuids[i]),
+			btr_hdl.cookie);
+		if (rc < (int)nr) {
 			struct rebuild_pool_tls *tls;
 
 			tls = rebuild_pool_tls_lookup(rpt->rt_pool_uuid,
 						      rpt->rt_rebuild_ver);
 			D_ASSERT(tls != NULL);
 
-			tls->rebuild_pool_obj_count++;
-			D__DEBUG(DB_TRACE, ""DF_UOID" "DF_UUID" %u exist.\n",
-				DP_UOID(oids[i]), DP_UUID(co_uuids[i]),
-				shards[i]);
-		} else if (rc < 0) {
-			break;
+			tls->rebuild_pool_obj_count += nr - rc;
 		}
 	}
-	if (rc < 0)
-		D__GOTO(out, rc);
+	rc = 0;
 
 	/* Check and create task to iterate the local rebuild tree */
 	if (!rpt->rt_lead_puller_running) {
@@ -243,6 +243,11 @@ int
 rebuild_cont_obj_insert(daos_handle_t toh, uuid_t co_uuid,
 			daos_unit_oid_t oid, unsigned int shard);
 
+int
+rebuild_cont_objs_insert(daos_handle_t toh, uuid_t co_uuid,
+			 daos_unit_oid_t *oids, uint32_t *shards,
+			 unsigned int nr);
+
 struct rebuild_tgt_pool_tracker *
 rebuild_tgt_pool_tracker_lookup(uuid_t pool_uuid, unsigned int ver);
 
@@ -271,6 +276,10 @@ int ds_obj_fetch(daos_handle_t oh, daos_epoch_t epoch,
 		 daos_iod_t *iods, daos_sg_list_t *sgls,
 		 daos_iom_t *maps);
 
+int ds_obj_fetch_shard(daos_handle_t oh, daos_epoch_t epoch,
+		       daos_key_t *dkey, unsigned int shard, unsigned int nr,
+		       daos_iod_t *iods, daos_sg_list_t *sgls);
+
 int ds_obj_list_rec(daos_handle_t oh, daos_epoch_t epoch, daos_key_t *dkey,
 		daos_key_t *akey, daos_iod_type_t type, daos_size_t *size,
 		uint32_t *nr, daos_recx_t *recxs, daos_epoch_range_t *eprs,
@@ -287,7 +287,7 @@ rebuild_tree_create(daos_handle_t toh, unsigned int tree_class,
 	memset(&root, 0, sizeof(root));
 	root.root_hdl = DAOS_HDL_INVAL;
 	memset(&uma, 0, sizeof(uma));
-	uma.uma_id = UMEM_CLASS_VMEM;
+	uma.uma_id = UMEM_CLASS_VMEM_SLAB;
 
 	rc = dbtree_create_inplace(tree_class, 0, 4, &uma,
 				   broot, &root.root_hdl);
@@ -335,11 +335,11 @@ rebuild_uuid_tree_create(daos_handle_t toh, uuid_t uuid,
 				   sizeof(uuid_t), rootp);
 }
 
-int
-rebuild_cont_obj_insert(daos_handle_t toh, uuid_t co_uuid,
-			daos_unit_oid_t oid, unsigned int shard)
+/* Find the container rebuild tree, create it if it does not exist */
+static int
+rebuild_cont_root_get(daos_handle_t toh, uuid_t co_uuid,
+		      struct rebuild_root **rootp)
 {
-	struct rebuild_root *cont_root;
 	daos_iov_t	key_iov;
 	daos_iov_t	val_iov;
 	int		rc;
@@ -347,17 +347,27 @@ rebuild_cont_obj_insert(daos_handle_t toh, uuid_t co_uuid,
 	daos_iov_set(&key_iov, co_uuid, sizeof(uuid_t));
 	daos_iov_set(&val_iov, NULL, 0);
 	rc = dbtree_lookup(toh, &key_iov, &val_iov);
-	if (rc < 0) {
-		if (rc != -DER_NONEXIST)
-			D__GOTO(out, rc);
+	if (rc == -DER_NONEXIST)
+		return rebuild_uuid_tree_create(toh, co_uuid, rootp);
+	if (rc < 0)
+		return rc;
 
-		rc = rebuild_uuid_tree_create(toh, co_uuid,
-					      &cont_root);
-		if (rc)
-			D__GOTO(out, rc);
-	} else {
-		cont_root = val_iov.iov_buf;
-	}
+	*rootp = val_iov.iov_buf;
+	return 0;
+}
+
+int
+rebuild_cont_obj_insert(daos_handle_t toh, uuid_t co_uuid,
+			daos_unit_oid_t oid, unsigned int shard)
+{
+	struct rebuild_root *cont_root;
+	daos_iov_t	key_iov;
+	daos_iov_t	val_iov;
+	int		rc;
+
+	rc = rebuild_cont_root_get(toh, co_uuid, &cont_root);
+	if (rc)
+		D__GOTO(out, rc);
 
 	oid.id_shard = shard;
 	/* Finally look up the object under the container tree */
@@ -383,6 +393,107 @@ out:
 	return rc;
 }
 
+static int
+rebuild_uoid_cmp(const void *p1, const void *p2)
+{
+	const daos_unit_oid_t *oid1 = p1;
+	const daos_unit_oid_t *oid2 = p2;
+
+	if (oid1->id_pub.hi != oid2->id_pub.hi)
+		return oid1->id_pub.hi < oid2->id_pub.hi ? -1 : 1;
+	if (oid1->id_pub.lo != oid2->id_pub.lo)
+		return oid1->id_pub.lo < oid2->id_pub.lo ? -1 : 1;
+	if (oid1->id_shard != oid2->id_shard)
+		return oid1->id_shard < oid2->id_shard ? -1 : 1;
+	return 0;
+}
+
+/**
+ * Insert \a nr objects of the container \a co_uuid into the rebuild tree,
+ * objects which are not in the tree yet are inserted by one batch update.
+ * Duplicate objects in \a oids are inserted once.
+ *
+ * \return	number of inserted objects, or negative error code.
+ */
+int
+rebuild_cont_objs_insert(daos_handle_t toh, uuid_t co_uuid,
+			 daos_unit_oid_t *oids, uint32_t *shards,
+			 unsigned int nr)
+{
+	struct rebuild_root	*cont_root;
+	daos_unit_oid_t		*keys = NULL;
+	daos_iov_t		*key_iovs = NULL;
+	daos_iov_t		*val_iovs = NULL;
+	unsigned int		 count = 0;
+	unsigned int		 nr_new;
+	unsigned int		 i;
+	int			 rc;
+
+	rc = rebuild_cont_root_get(toh, co_uuid, &cont_root);
+	if (rc)
+		D__GOTO(out, rc);
+
+	D__ALLOC(keys, nr * sizeof(*keys));
+	D__ALLOC(key_iovs, nr * sizeof(*key_iovs));
+	D__ALLOC(val_iovs, nr * sizeof(*val_iovs));
+	if (keys == NULL || key_iovs == NULL || val_iovs == NULL)
+		D__GOTO(out, rc = -DER_NOMEM);
+
+	for (i = 0; i < nr; i++) {
+		daos_iov_t	val_iov;
+		uint32_t	shard;
+
+		keys[count] = oids[i];
+		keys[count].id_shard = shards[i];
+		daos_iov_set(&key_iovs[count], &keys[count], sizeof(keys[0]));
+		daos_iov_set(&val_iov, &shard, sizeof(shard));
+		rc = dbtree_lookup(cont_root->root_hdl, &key_iovs[count],
+				   &val_iov);
+		if (rc == 0)
+			continue;
+		if (rc != -DER_NONEXIST)
+			D__GOTO(out, rc);
+		count++;
+	}
+
+	/* the same object can appear more than once, only count it once */
+	qsort(keys, count, sizeof(*keys), rebuild_uoid_cmp);
+	for (i = 0, nr_new = 0; i < count; i++) {
+		if (nr_new > 0 && rebuild_uoid_cmp(&keys[nr_new - 1],
+						   &keys[i]) == 0)
+			continue;
+
+		keys[nr_new] = keys[i];
+		daos_iov_set(&key_iovs[nr_new], &keys[nr_new],
+			     sizeof(keys[0]));
+		daos_iov_set(&val_iovs[nr_new], &keys[nr_new].id_shard,
+			     sizeof(keys[0].id_shard));
+		nr_new++;
+	}
+	count = nr_new;
+
+	rc = dbtree_update_batch(cont_root->root_hdl, count, key_iovs,
+				 val_iovs);
+	if (rc < 0) {
+		D__ERROR("failed to insert %u objects of cont "DF_UUID
+			": rc %d\n", count, DP_UUID(co_uuid), rc);
+		D__GOTO(out, rc);
+	}
+	cont_root->count += count;
+	D__DEBUG(DB_TRACE, "insert %u/%u objects into cont_root %p of "
+		DF_UUID" count %d\n", count, nr, cont_root, DP_UUID(co_uuid),
+		cont_root->count);
+	rc = count;
+out:
+	if (keys != NULL)
+		D__FREE(keys, nr * sizeof(*keys));
+	if (key_iovs != NULL)
+		D__FREE(key_iovs, nr * sizeof(*key_iovs));
+	if (val_iovs != NULL)
+		D__FREE(val_iovs, nr * sizeof(*val_iovs));
+	return rc;
+}
+
 /**
  * The rebuild objects will be gathered into a global objects arrary by
  * target id.
@@ -699,7 +810,7 @@ rebuild_tgt_scan_handler(crt_rpc_t *rpc)
 
 	/* step-2: Create the btree root for global object scan list */
 	memset(&uma, 0, sizeof(uma));
-	uma.uma_id = UMEM_CLASS_VMEM;
+	uma.uma_id = UMEM_CLASS_VMEM_SLAB;
 	rc = dbtree_create(DBTREE_CLASS_NV, 0, 4, &uma, NULL,
 			   &scan_arg->rebuild_tree_hdl);
 	if (rc != 0) {
@@ -219,6 +219,32 @@ ds_obj_fetch(daos_handle_t oh, daos_epoch_t epoch,
 	return dss_task_run(task, DSS_POOL_PRIV_LOW_PRIORITY);
 }
 
+int
+ds_obj_fetch_shard(daos_handle_t oh, daos_epoch_t epoch,
+		   daos_key_t *dkey, unsigned int shard, unsigned int nr,
+		   daos_iod_t *iods, daos_sg_list_t *sgls)
+{
+	tse_task_t		*task;
+	daos_obj_fetch_shard_t	*arg;
+	int			 rc;
+
+	rc = dc_task_create(dc_obj_fetch_shard, dss_tse_scheduler(), NULL,
+			    &task);
+	if (rc)
+		return rc;
+
+	arg = dc_task_get_args(task);
+	arg->oh		= oh;
+	arg->epoch	= epoch;
+	arg->dkey	= dkey;
+	arg->shard	= shard;
+	arg->nr		= nr;
+	arg->iods	= iods;
+	arg->sgls	= sgls;
+
+	return dss_task_run(task, DSS_POOL_PRIV_LOW_PRIORITY);
+}
+
 int
 ds_obj_list_rec(daos_handle_t oh, daos_epoch_t epoch, daos_key_t *dkey,
 		daos_key_t *akey, daos_iod_type_t type, daos_size_t *size,
@@ -10,6 +10,7 @@
 #include <unistd.h>
 #include <fcntl.h>
 #include <getopt.h>
+#include <math.h>
 
 #define DDSUBSYS       DDFAC(tests)
 
@@ -17,6 +18,7 @@
 #include <daos.h>
 #include <daos/common.h>
 #include <daos/tests_lib.h>
+#include <daos/metrics.h>
 #include <daos_srv/vos.h>
 #include <daos_test.h>
 #include "dts_common.h"
@@ -44,13 +46,132 @@ bool			 ts_overwrite;
 /* use zero-copy API for VOS, ignored for "echo" or "daos" */
 bool			 ts_zero_copy;
 
+/* run the fetch phase after the update phase */
+bool			 ts_fetch;
+/* percentage of fetches of the mixed phase, no mixed phase if it's -ve */
+int			 ts_mix_pct	= -1;
+
+/* key access distribution of the fetch and mixed phases */
+enum ts_dist {
+	TS_DIST_SEQ,
+	TS_DIST_UNIFORM,
+	TS_DIST_ZIPF,
+};
+
+enum ts_dist		 ts_dist	= TS_DIST_SEQ;
+double			 ts_zipf_theta	= 0.99;
+/* path of the JSON report, "-" for stdout */
+char			*ts_json;
+
 uuid_t			 ts_cookie;		/* update cookie for VOS */
 daos_handle_t		 ts_oh;			/* object open handle */
 daos_obj_id_t		 ts_oid;		/* object ID */
 daos_unit_oid_t		 ts_uoid;		/* object shard ID (for VOS) */
+daos_obj_id_t		*ts_oids;		/* all objects of this rank */
+/* shuffled indices of array records */
+int			*ts_indices;
 
 struct dts_context	 ts_ctx;
 
+enum {
+	TS_OP_UPDATE,
+	TS_OP_FETCH,
+	TS_OP_NR,
+};
+
+static const char *ts_op_names[] = {
+	[TS_OP_UPDATE]	= "update",
+	[TS_OP_FETCH]	= "fetch",
+};
+
+/* a test phase, results are reduced to rank 0 by ts_phase_reduce() */
+struct ts_phase {
+	const char		*tp_name;
+	/* percentage of fetches */
+	int			 tp_fetch_pct;
+	enum ts_dist		 tp_dist;
+	double			 tp_start;
+	double			 tp_end;
+	/* duration from the first start to the last end of all ranks */
+	double			 tp_duration;
+	double			 tp_duration_max;
+	double			 tp_duration_min;
+	double			 tp_duration_avg;
+	/* latency in nanoseconds of each type of operation */
+	struct daos_hist	 tp_lat[TS_OP_NR];
+};
+
+/* Zipfian generator of YCSB, see "Quickly Generating Billion-Record
+ * Synthetic Databases" by Gray et al.
+ */
+struct ts_zipf {
+	uint64_t		 tz_nr;
+	double			 tz_theta;
+	double			 tz_alpha;
+	double			 tz_zetan;
+	double			 tz_eta;
+};
+
+static struct ts_zipf	 ts_zipf;
+
+static double
+ts_zeta(uint64_t nr, double theta)
+{
+	double		sum = 0;
+	uint64_t	i;
+
+	for (i = 1; i <= nr; i++)
+		sum += 1 / pow(i, theta);
+	return sum;
+}
+
+static void
+ts_zipf_init(struct ts_zipf *zipf, uint64_t nr, double theta)
+{
+	if (zipf->tz_nr == nr && zipf->tz_theta == theta)
+		return;
+
+	zipf->tz_nr	= nr;
+	zipf->tz_theta	= theta;
+	zipf->tz_alpha	= 1 / (1 - theta);
+	zipf->tz_zetan	= ts_zeta(nr, theta);
+	zipf->tz_eta	= (1 - pow(2.0 / nr, 1 - theta)) /
+			  (1 - ts_zeta(2, theta) / zipf->tz_zetan);
+}
+
+static uint64_t
+ts_zipf_next(struct ts_zipf *zipf)
+{
+	double	u = drand48();
+	double	uz = u * zipf->tz_zetan;
+	double	idx;
+
+	if (uz < 1)
+		return 0;
+	if (uz < 1 + pow(0.5, zipf->tz_theta))
+		return 1;
+
+	idx = zipf->tz_nr * pow(zipf->tz_eta * u - zipf->tz_eta + 1,
+				zipf->tz_alpha);
+	return idx >= zipf->tz_nr ? zipf->tz_nr - 1 : idx;
+}
+
+/* the \a seq-th access of a dkey, returns record index within the dkey */
+static uint64_t
+ts_dist_next(enum ts_dist dist, uint64_t seq, uint64_t nr)
+{
+	switch (dist) {
+	default:
+		D__ASSERT(0);
+	case TS_DIST_SEQ:
+		return seq;
+	case TS_DIST_UNIFORM:
+		return ((uint64_t)lrand48() << 31 | lrand48()) % nr;
+	case TS_DIST_ZIPF:
+		return ts_zipf_next(&ts_zipf);
+	}
+}
+
 static int
 ts_vos_update(struct dts_io_credit *cred, daos_epoch_t epoch)
 {
@@ -93,6 +214,45 @@ ts_vos_update(struct dts_io_credit *cred, daos_epoch_t epoch)
 	return 0;
 }
 
+static int
+ts_vos_fetch(struct dts_io_credit *cred, daos_epoch_t epoch)
+{
+	int	rc;
+
+	if (!ts_zero_copy) {
+		rc = vos_obj_fetch(ts_ctx.tsc_coh, ts_uoid, epoch,
+				   &cred->tc_dkey, 1, &cred->tc_iod,
+				   &cred->tc_sgl);
+		if (rc)
+			return -1;
+
+	} else { /* zero-copy */
+		daos_sg_list_t	*sgl;
+		daos_handle_t	 ioh;
+
+		rc = vos_obj_zc_fetch_begin(ts_ctx.tsc_coh, ts_uoid, epoch,
+					    &cred->tc_dkey, 1,
+					    &cred->tc_iod, &ioh);
+		if (rc)
+			return rc;
+
+		rc = vos_obj_zc_sgl_at(ioh, 0, &sgl);
+		if (rc == 0 && sgl->sg_nr.num_out == 1 &&
+		    sgl->sg_iovs[0].iov_buf != NULL) {
+			memcpy(cred->tc_sgl.sg_iovs[0].iov_buf,
+			       sgl->sg_iovs[0].iov_buf,
+			       min(sgl->sg_iovs[0].iov_len,
+				   cred->tc_sgl.sg_iovs[0].iov_buf_len));
+		}
+
+		rc = vos_obj_zc_fetch_end(ioh, &cred->tc_dkey, 1,
+					  &cred->tc_iod, rc);
+		if (rc)
+			return rc;
+	}
+	return 0;
+}
+
 static int
 ts_daos_update(struct dts_io_credit *cred, daos_epoch_t epoch)
 {
@@ -104,139 +264,330 @@ ts_daos_update(struct dts_io_credit *cred, daos_epoch_t epoch)
 }
 
 static int
-ts_key_insert(void)
+ts_daos_fetch(struct dts_io_credit *cred, daos_epoch_t epoch)
 {
-	int		*indices;
-	char		 dkey_buf[DTS_KEY_LEN];
-	char		 akey_buf[DTS_KEY_LEN];
+	int	rc;
+
+	rc = daos_obj_fetch(ts_oh, epoch, &cred->tc_dkey, 1,
+			    &cred->tc_iod, &cred->tc_sgl, NULL, cred->tc_evp);
+	return rc;
+}
+
+/* setup the credit to access record \a idx of dkey \a dkey_idx */
+static daos_epoch_t
+ts_io_prep(struct dts_io_credit *cred, int op, unsigned int dkey_idx,
+	   uint64_t idx)
+{
+	daos_iod_t	*iod  = &cred->tc_iod;
+	daos_sg_list_t	*sgl  = &cred->tc_sgl;
+	daos_recx_t	*recx = &cred->tc_recx;
 	int		 vsize = ts_ctx.tsc_cred_vsize;
-	int		 i;
-	int		 j;
-	int		 rc = 0;
-	daos_epoch_t	 epoch = 0;
+	unsigned int	 akey_idx = idx / ts_recx_p_akey;
+	unsigned int	 rec_idx = idx % ts_recx_p_akey;
+
+	memset(iod, 0, sizeof(*iod));
+	memset(sgl, 0, sizeof(*sgl));
+	memset(recx, 0, sizeof(*recx));
+
+	/* setup dkey */
+	snprintf(cred->tc_dbuf, DTS_KEY_LEN, "blade-%u", dkey_idx);
+	daos_iov_set(&cred->tc_dkey, cred->tc_dbuf, strlen(cred->tc_dbuf));
+
+	/* setup I/O descriptor */
+	snprintf(cred->tc_abuf, DTS_KEY_LEN, "walker-%u", akey_idx);
+	daos_iov_set(&iod->iod_name, cred->tc_abuf, strlen(cred->tc_abuf));
+	if (ts_single) {
+		iod->iod_type = DAOS_IOD_SINGLE;
+		iod->iod_size = vsize;
+		recx->rx_nr = 1;
+	} else {
+		iod->iod_type = DAOS_IOD_ARRAY;
+		iod->iod_size = 1;
+		recx->rx_nr  = vsize;
+		recx->rx_idx = ts_overwrite ?
+			       0 : ts_indices[rec_idx] * vsize;
+	}
+	iod->iod_nr    = 1;
+	iod->iod_recxs = recx;
+
+	if (op == TS_OP_UPDATE) {
+		/* initialize value buffer */
+		cred->tc_vbuf[0] = 'A' + rec_idx % 26;
+		cred->tc_vbuf[1] = 'a' + rec_idx % 26;
+		cred->tc_vbuf[2] = cred->tc_vbuf[vsize - 1] = 0;
+	}
 
-	indices = dts_rand_iarr_alloc(ts_recx_p_akey, 0);
-	D__ASSERT(indices != NULL);
+	daos_iov_set(&cred->tc_val, cred->tc_vbuf, vsize);
+	sgl->sg_iovs = &cred->tc_val;
+	sgl->sg_nr.num = 1;
 
-	dts_key_gen(dkey_buf, DTS_KEY_LEN, "blade");
+	/* overwrite can replace orignal data and reduce space consumption,
+	 * otherwise each record is written in its own epoch, which is also
+	 * the epoch to fetch it.
+	 */
+	return ts_overwrite ? 0 : idx + 1;
+}
 
-	for (i = 0; i < ts_akey_p_dkey; i++) {
+static int
+ts_io(struct dts_io_credit *cred, int op, daos_epoch_t epoch,
+      struct daos_hist *lat)
+{
+	int	rc;
 
-		dts_key_gen(akey_buf, DTS_KEY_LEN, "walker");
+	cred->tc_start = daos_metric_clock();
+	/* the latency of asynchronous I/O is recorded on completion */
+	cred->tc_lat = cred->tc_evp != NULL ? lat : NULL;
 
-		for (j = 0; j < ts_recx_p_akey; j++) {
-			struct dts_io_credit *cred;
-			daos_iod_t	     *iod;
-			daos_sg_list_t	     *sgl;
-			daos_recx_t	     *recx;
+	if (ts_class == DAOS_OC_RAW)
+		rc = op == TS_OP_UPDATE ? ts_vos_update(cred, epoch) :
+					  ts_vos_fetch(cred, epoch);
+	else
+		rc = op == TS_OP_UPDATE ? ts_daos_update(cred, epoch) :
+					  ts_daos_fetch(cred, epoch);
 
-			cred = dts_credit_take(&ts_ctx);
-			if (!cred) {
-				fprintf(stderr, "test failed\n");
-				return -1;
-			}
+	if (rc == 0 && cred->tc_evp == NULL)
+		daos_hist_record(lat, daos_metric_clock() - cred->tc_start);
+	return rc;
+}
 
-			iod  = &cred->tc_iod;
-			sgl  = &cred->tc_sgl;
-			recx = &cred->tc_recx;
-
-			memset(iod, 0, sizeof(*iod));
-			memset(sgl, 0, sizeof(*sgl));
-			memset(recx, 0, sizeof(*recx));
-
-			/* setup dkey */
-			memcpy(cred->tc_dbuf, dkey_buf, strlen(dkey_buf));
-			daos_iov_set(&cred->tc_dkey, cred->tc_dbuf,
-				     strlen(cred->tc_dbuf));
-
-			/* setup I/O descriptor */
-			memcpy(cred->tc_abuf, akey_buf, strlen(akey_buf));
-			daos_iov_set(&iod->iod_name, cred->tc_abuf,
-				     strlen(cred->tc_abuf));
-			if (ts_single) {
-				iod->iod_type = DAOS_IOD_SINGLE;
-				iod->iod_size = vsize;
-			} else {
-				iod->iod_type = DAOS_IOD_ARRAY;
-				iod->iod_size = 1;
-			}
-			if (ts_single) {
-				recx->rx_nr = 1;
-			} else {
-				recx->rx_nr  = vsize;
-				recx->rx_idx = ts_overwrite ?
-					       0 : indices[j] * vsize;
-			}
-			iod->iod_nr    = 1;
-			iod->iod_recxs = recx;
-
-			/* initialize value buffer and setup sgl */
-			cred->tc_vbuf[0] = 'A' + j % 26;
-			cred->tc_vbuf[1] = 'a' + j % 26;
-			cred->tc_vbuf[2] = cred->tc_vbuf[vsize - 1] = 0;
-
-			daos_iov_set(&cred->tc_val, cred->tc_vbuf, vsize);
-			sgl->sg_iovs = &cred->tc_val;
-			sgl->sg_nr.num = 1;
-
-			/* overwrite can replace orignal data and reduce space
-			 * consumption.
-			 */
-			if (!ts_overwrite)
-				epoch++;
-
-			if (ts_class == DAOS_OC_RAW)
-				rc = ts_vos_update(cred, epoch);
-			else
-				rc = ts_daos_update(cred, epoch);
-
-			if (rc != 0) {
-				fprintf(stderr, "Update failed: %d\n", rc);
-				D__GOTO(failed, rc);
-			}
+static int
+ts_dkey_run(struct ts_phase *phase, unsigned int dkey_idx)
+{
+	uint64_t	nr = (uint64_t)ts_akey_p_dkey * ts_recx_p_akey;
+	uint64_t	i;
+	int		rc = 0;
+
+	for (i = 0; i < nr; i++) {
+		struct dts_io_credit	*cred;
+		daos_epoch_t		 epoch;
+		uint64_t		 idx;
+		int			 op;
+
+		cred = dts_credit_take(&ts_ctx);
+		if (!cred) {
+			fprintf(stderr, "test failed\n");
+			return -1;
+		}
+
+		op = (lrand48() % 100) < phase->tp_fetch_pct ?
+		     TS_OP_FETCH : TS_OP_UPDATE;
+		idx = ts_dist_next(phase->tp_dist, i, nr);
+		epoch = ts_io_prep(cred, op, dkey_idx, idx);
+
+		rc = ts_io(cred, op, epoch, &phase->tp_lat[op]);
+		if (rc != 0) {
+			fprintf(stderr, "%s failed: %d\n", ts_op_names[op], rc);
+			break;
 		}
 	}
-failed:
-	free(indices);
 	return rc;
 }
 
 static int
-ts_write_perf(void)
+ts_phase_run(struct ts_phase *phase)
 {
 	int	i;
 	int	j;
-	int	rc;
+	int	rc = 0;
 
+	if (phase->tp_dist == TS_DIST_ZIPF)
+		ts_zipf_init(&ts_zipf,
+			     (uint64_t)ts_akey_p_dkey * ts_recx_p_akey,
+			     ts_zipf_theta);
+
+	phase->tp_start = dts_time_now();
 	for (i = 0; i < ts_obj_p_cont; i++) {
-		ts_oid = dts_oid_gen(ts_class, ts_ctx.tsc_mpi_rank);
-
-		for (j = 0; j < ts_dkey_p_obj; j++) {
-			if (ts_class != DAOS_OC_RAW) {
-				rc = daos_obj_open(ts_ctx.tsc_coh, ts_oid, 1,
-						   DAOS_OO_RW, &ts_oh, NULL);
-				if (rc) {
-					fprintf(stderr, "object open failed\n");
-					return -1;
-				}
-			} else {
-				memset(&ts_uoid, 0, sizeof(ts_uoid));
-				ts_uoid.id_pub = ts_oid;
+		ts_oid = ts_oids[i];
+		if (ts_class != DAOS_OC_RAW) {
+			rc = daos_obj_open(ts_ctx.tsc_coh, ts_oid, 1,
+					   DAOS_OO_RW, &ts_oh, NULL);
+			if (rc) {
+				fprintf(stderr, "object open failed\n");
+				rc = -1;
+				break;
 			}
+		} else {
+			memset(&ts_uoid, 0, sizeof(ts_uoid));
+			ts_uoid.id_pub = ts_oid;
+		}
 
-			rc = ts_key_insert();
-			if (rc)
-				return rc;
+		for (j = 0; j < ts_dkey_p_obj && rc == 0; j++)
+			rc = ts_dkey_run(phase, j);
 
-			if (ts_class != DAOS_OC_RAW)
-				daos_obj_close(ts_oh, NULL);
-		}
+		/* all I/Os of the object should complete before close */
+		if (rc == 0)
+			rc = dts_credit_drain(&ts_ctx);
+
+		if (ts_class != DAOS_OC_RAW)
+			daos_obj_close(ts_oh, NULL);
+		if (rc)
+			break;
 	}
+	phase->tp_end = dts_time_now();
+
+	if (ts_ctx.tsc_mpi_size > 1) {
+		int rc_g;
 
-	rc = dts_credit_drain(&ts_ctx);
+		MPI_Allreduce(&rc, &rc_g, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+		rc = rc_g;
+	}
 	return rc;
 }
 
+/* reduce results of all ranks to rank 0 */
+static void
+ts_phase_reduce(struct ts_phase *phase)
+{
+	struct daos_hist	*lat;
+	double			 duration = phase->tp_end - phase->tp_start;
+	double			 first_start;
+	double			 last_end;
+	double			 duration_sum;
+	int			 i;
+
+	if (ts_ctx.tsc_mpi_size == 1) {
+		phase->tp_duration = duration;
+		phase->tp_duration_max = phase->tp_duration_min = duration;
+		phase->tp_duration_avg = duration;
+		return;
+	}
+
+	MPI_Reduce(&phase->tp_start, &first_start, 1, MPI_DOUBLE,
+		   MPI_MIN, 0, MPI_COMM_WORLD);
+	MPI_Reduce(&phase->tp_end, &last_end, 1, MPI_DOUBLE,
+		   MPI_MAX, 0, MPI_COMM_WORLD);
+	phase->tp_duration = last_end - first_start;
+
+	MPI_Reduce(&duration, &phase->tp_duration_max, 1, MPI_DOUBLE,
+		   MPI_MAX, 0, MPI_COMM_WORLD);
+	MPI_Reduce(&duration, &phase->tp_duration_min, 1, MPI_DOUBLE,
+		   MPI_MIN, 0, MPI_COMM_WORLD);
+	MPI_Reduce(&duration, &duration_sum, 1, MPI_DOUBLE,
+		   MPI_SUM, 0, MPI_COMM_WORLD);
+	phase->tp_duration_avg = duration_sum / ts_ctx.tsc_mpi_size;
+
+	D__ALLOC_PTR(lat);
+	D__ASSERT(lat != NULL);
+	for (i = 0; i < TS_OP_NR; i++) {
+		/* h_count, h_sum and buckets are summed, h_max is not */
+		MPI_Reduce(&phase->tp_lat[i], lat,
+			   sizeof(*lat) / sizeof(uint64_t), MPI_UINT64_T,
+			   MPI_SUM, 0, MPI_COMM_WORLD);
+		MPI_Reduce(&phase->tp_lat[i].h_max, &lat->h_max, 1,
+			   MPI_UINT64_T, MPI_MAX, 0, MPI_COMM_WORLD);
+		if (ts_ctx.tsc_mpi_rank == 0)
+			phase->tp_lat[i] = *lat;
+	}
+	D__FREE_PTR(lat);
+}
+
+static const char *
+ts_dist_name(enum ts_dist dist)
+{
+	switch (dist) {
+	default:
+		return "unknown";
+	case TS_DIST_SEQ:
+		return "sequential";
+	case TS_DIST_UNIFORM:
+		return "uniform";
+	case TS_DIST_ZIPF:
+		return "zipfian";
+	}
+}
+
+static void
+ts_phase_print(struct ts_phase *phase)
+{
+	uint64_t	total = 0;
+	double		rate;
+	double		bandwidth;
+	int		i;
+
+	for (i = 0; i < TS_OP_NR; i++)
+		total += phase->tp_lat[i].h_count;
+
+	rate = total / phase->tp_duration;
+	bandwidth = (rate * ts_ctx.tsc_cred_vsize) / (1024 * 1024);
+
+	fprintf(stdout, "%s (%d%% fetch, %s):\n"
+		"\tduration : %-10.6f sec\n"
+		"\tbandwith : %-10.3f MB/sec\n"
+		"\trate     : %-10.2f IO/sec\n",
+		phase->tp_name, phase->tp_fetch_pct,
+		ts_dist_name(phase->tp_dist), phase->tp_duration,
+		bandwidth, rate);
+
+	for (i = 0; i < TS_OP_NR; i++) {
+		struct daos_hist *lat = &phase->tp_lat[i];
+
+		if (lat->h_count == 0)
+			continue;
+
+		fprintf(stdout, "\t%-6s latency (us): avg %.3f p50 %.3f "
+			"p99 %.3f p99.9 %.3f max %.3f\n", ts_op_names[i],
+			(double)lat->h_sum / lat->h_count / 1000,
+			daos_hist_percentile(lat, 50) / 1000.0,
+			daos_hist_percentile(lat, 99) / 1000.0,
+			daos_hist_percentile(lat, 99.9) / 1000.0,
+			lat->h_max / 1000.0);
+	}
+
+	fprintf(stdout, "\tduration across processes: max %-10.6f "
+		"min %-10.6f avg %-10.6f sec\n", phase->tp_duration_max,
+		phase->tp_duration_min, phase->tp_duration_avg);
+}
+
+static void
+ts_phase_json(FILE *fp, struct ts_phase *phase, bool last)
+{
+	uint64_t	total = 0;
+	int		i;
+
+	for (i = 0; i < TS_OP_NR; i++)
+		total += phase->tp_lat[i].h_count;
+
+	fprintf(fp, "    {\n"
+		"      \"name\": \"%s\",\n"
+		"      \"fetch_pct\": %d,\n"
+		"      \"distribution\": \"%s\",\n"
+		"      \"duration\": %.6f,\n"
+		"      \"duration_max\": %.6f,\n"
+		"      \"duration_min\": %.6f,\n"
+		"      \"duration_avg\": %.6f,\n"
+		"      \"ops\": %"PRIu64",\n"
+		"      \"rate\": %.2f,\n"
+		"      \"bandwidth_mb\": %.3f",
+		phase->tp_name, phase->tp_fetch_pct,
+		ts_dist_name(phase->tp_dist), phase->tp_duration,
+		phase->tp_duration_max, phase->tp_duration_min,
+		phase->tp_duration_avg, total, total / phase->tp_duration,
+		total * (double)ts_ctx.tsc_cred_vsize /
+		(1024 * 1024) / phase->tp_duration);
+
+	for (i = 0; i < TS_OP_NR; i++) {
+		struct daos_hist *lat = &phase->tp_lat[i];
+
+		if (lat->h_count == 0)
+			continue;
+
+		fprintf(fp, ",\n"
+			"      \"%s\": {\n"
+			"        \"ops\": %"PRIu64",\n"
+			"        \"lat_avg_ns\": %"PRIu64",\n"
+			"        \"lat_p50_ns\": %"PRIu64",\n"
+			"        \"lat_p99_ns\": %"PRIu64",\n"
+			"        \"lat_p999_ns\": %"PRIu64",\n"
+			"        \"lat_max_ns\": %"PRIu64"\n"
+			"      }", ts_op_names[i], lat->h_count,
+			lat->h_sum / lat->h_count,
+			daos_hist_percentile(lat, 50),
+			daos_hist_percentile(lat, 99),
+			daos_hist_percentile(lat, 99.9), lat->h_max);
+	}
+	fprintf(fp, "\n    }%s\n", last ? "" : ",");
+}
+
 static uint64_t
 ts_val_factor(uint64_t val, char factor)
 {
@@ -347,7 +698,65 @@ The options are as follows:\n\
 	storage space.\n\
 \n\
 -f pathname\n\
-	Full path name of the VOS file.\n");
+	Full path name of the VOS file.\n\
+\n\
+-F	Fetch all the records after the update phase.\n\
+\n\
+-R number\n\
+	Run a mixed phase after the update (and fetch) phase, the number is\n\
+	the percentage of fetches, between 0 and 100.\n\
+\n\
+-D seq|uniform|zipf[:theta]\n\
+	Key access distribution of the fetch and mixed phases, the update\n\
+	phase always writes all records sequentially. The default value is\n\
+	'seq', theta of zipfian distribution is 0.99 by default.\n\
+\n\
+-j pathname\n\
+	Also write results as JSON to the file, '-' stands for stdout.\n");
+}
+
+static void
+ts_report_json(struct ts_phase *phases, int nr)
+{
+	FILE	*fp;
+	int	 i;
+
+	if (strcmp(ts_json, "-") == 0) {
+		fp = stdout;
+	} else {
+		fp = fopen(ts_json, "w");
+		if (fp == NULL) {
+			fprintf(stderr, "Failed to open %s: %s\n", ts_json,
+				strerror(errno));
+			return;
+		}
+	}
+
+	fprintf(fp, "{\n"
+		"  \"test\": \"%s\",\n"
+		"  \"procs\": %d,\n"
+		"  \"credits\": %d,\n"
+		"  \"obj_per_cont\": %u,\n"
+		"  \"dkey_per_obj\": %u,\n"
+		"  \"akey_per_dkey\": %u,\n"
+		"  \"recx_per_akey\": %u,\n"
+		"  \"value_type\": \"%s\",\n"
+		"  \"value_size\": %d,\n"
+		"  \"zero_copy\": %s,\n"
+		"  \"overwrite\": %s,\n"
+		"  \"phases\": [\n",
+		ts_class_name(), ts_ctx.tsc_mpi_size, ts_ctx.tsc_cred_nr,
+		ts_obj_p_cont, ts_dkey_p_obj, ts_akey_p_dkey, ts_recx_p_akey,
+		ts_val_type(), ts_ctx.tsc_cred_vsize,
+		ts_zero_copy ? "true" : "false",
+		ts_overwrite ? "true" : "false");
+
+	for (i = 0; i < nr; i++)
+		ts_phase_json(fp, &phases[i], i == nr - 1);
+
+	fprintf(fp, "  ]\n}\n");
+	if (fp != stdout)
+		fclose(fp);
 }
 
 static struct option ts_ops[] = {
@@ -363,6 +772,10 @@ static struct option ts_ops[] = {
 	{ "zcopy",	no_argument,		NULL,	'z' },
 	{ "overwrite",	no_argument,		NULL,	't' },
 	{ "file",	required_argument,	NULL,	'f' },
+	{ "fetch",	no_argument,		NULL,	'F' },
+	{ "mix",	required_argument,	NULL,	'R' },
+	{ "dist",	required_argument,	NULL,	'D' },
+	{ "json",	required_argument,	NULL,	'j' },
 	{ "help",	no_argument,		NULL,	'h' },
 	{ NULL,		0,			NULL,	0   },
 };
@@ -374,8 +787,9 @@ main(int argc, char **argv)
 	int		credits   = -1;	/* sync mode */
 	int		vsize	   = 32;	/* default value size */
 	d_rank_t	svc_rank  = 0;	/* pool service rank */
-	double		then;
-	double		now;
+	struct ts_phase	phases[3];
+	int		phase_nr = 0;
+	int		i;
 	int		rc;
 
 	MPI_Init(&argc, &argv);
@@ -383,7 +797,7 @@ main(int argc, char **argv)
 	MPI_Comm_size(MPI_COMM_WORLD, &ts_ctx.tsc_mpi_size);
 
 	memset(ts_pmem_file, 0, sizeof(ts_pmem_file));
-	while ((rc = getopt_long(argc, argv, "P:T:C:o:d:a:r:As:ztf:h",
+	while ((rc = getopt_long(argc, argv, "P:T:C:o:d:a:r:As:ztf:FR:D:j:h",
 				 ts_ops, NULL)) != -1) {
 		char	*endp;
 
@@ -449,6 +863,40 @@ main(int argc, char **argv)
 		case 'f':
 			strncpy(ts_pmem_file, optarg, PATH_MAX - 1);
 			break;
+		case 'F':
+			ts_fetch = true;
+			break;
+		case 'R':
+			ts_mix_pct = strtoul(optarg, &endp, 0);
+			if (ts_mix_pct > 100) {
+				if (ts_ctx.tsc_mpi_rank == 0)
+					ts_print_usage();
+				return -1;
+			}
+			break;
+		case 'D':
+			if (!strcasecmp(optarg, "seq")) {
+				ts_dist = TS_DIST_SEQ;
+			} else if (!strcasecmp(optarg, "uniform")) {
+				ts_dist = TS_DIST_UNIFORM;
+			} else if (!strncasecmp(optarg, "zipf", 4)) {
+				ts_dist = TS_DIST_ZIPF;
+				if (optarg[4] == ':')
+					ts_zipf_theta = strtod(&optarg[5],
+							       &endp);
+			} else {
+				if (ts_ctx.tsc_mpi_rank == 0)
+					ts_print_usage();
+				return -1;
+			}
+			if (ts_zipf_theta <= 0 || ts_zipf_theta >= 1) {
+				fprintf(stderr, "theta should be in (0, 1)\n");
+				return -1;
+			}
+			break;
+		case 'j':
+			ts_json = optarg;
+			break;
 		case 'h':
 			if (ts_ctx.tsc_mpi_rank == 0)
 				ts_print_usage();
@@ -503,6 +951,9 @@ main(int argc, char **argv)
 			"\tvalue size    : %u\n"
 			"\tzero copy     : %s\n"
 			"\toverwrite     : %s\n"
+			"\tfetch         : %s\n"
+			"\tmixed fetch   : %d%% (no mixed phase for -ve)\n"
+			"\tdistribution  : %s\n"
 			"\tVOS file      : %s\n",
 			ts_class_name(),
 			(unsigned int)(pool_size >> 20),
@@ -516,9 +967,21 @@ main(int argc, char **argv)
 			vsize,
 			ts_yes_or_no(ts_zero_copy),
 			ts_yes_or_no(ts_overwrite),
+			ts_yes_or_no(ts_fetch),
+			ts_mix_pct,
+			ts_dist_name(ts_dist),
 			ts_class == DAOS_OC_RAW ? ts_pmem_file : "<NULL>");
 	}
 
+	ts_oids = calloc(ts_obj_p_cont, sizeof(*ts_oids));
+	ts_indices = dts_rand_iarr_alloc(ts_recx_p_akey, 0);
+	if (ts_oids == NULL || ts_indices == NULL)
+		return -1;
+
+	for (i = 0; i < ts_obj_p_cont; i++)
+		ts_oids[i] = dts_oid_gen(ts_class, ts_ctx.tsc_mpi_rank);
+	srand48(ts_ctx.tsc_mpi_rank);
+
 	rc = dts_ctx_init(&ts_ctx);
 	if (rc)
 		return -1;
@@ -527,87 +990,50 @@ main(int argc, char **argv)
 		fprintf(stdout, "Started...\n");
 	MPI_Barrier(MPI_COMM_WORLD);
 
-	then = dts_time_now();
-	/* TODO: add fetch performance test */
-	rc = ts_write_perf();
-	now = dts_time_now();
-
-	if (ts_ctx.tsc_mpi_size > 1) {
-		int rc_g;
+	memset(phases, 0, sizeof(phases));
+	phases[phase_nr].tp_name	= "update";
+	phases[phase_nr].tp_fetch_pct	= 0;
+	phases[phase_nr].tp_dist	= TS_DIST_SEQ;
+	phase_nr++;
+
+	if (ts_fetch) {
+		phases[phase_nr].tp_name	= "fetch";
+		phases[phase_nr].tp_fetch_pct	= 100;
+		phases[phase_nr].tp_dist	= ts_dist;
+		phase_nr++;
+	}
 
-		MPI_Allreduce(&rc, &rc_g, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
-		rc = rc_g;
+	if (ts_mix_pct >= 0) {
+		phases[phase_nr].tp_name	= "mixed";
+		phases[phase_nr].tp_fetch_pct	= ts_mix_pct;
+		phases[phase_nr].tp_dist	= ts_dist;
+		phase_nr++;
 	}
 
-	if (rc) {
-		fprintf(stderr, "Failed: %d\n", rc);
-	} else {
-		double		duration, agg_duration;
-		double		first_start;
-		double		last_end;
-		double		duration_max;
-		double		duration_min;
-		double		duration_sum;
-
-		duration = now - then;
-
-		if (ts_ctx.tsc_mpi_size > 1) {
-			MPI_Reduce(&then, &first_start, 1, MPI_DOUBLE,
-				   MPI_MIN, 0, MPI_COMM_WORLD);
-			MPI_Reduce(&now, &last_end, 1, MPI_DOUBLE,
-				   MPI_MAX, 0, MPI_COMM_WORLD);
-		} else {
-			first_start = then;
-			last_end = now;
+	for (i = 0; i < phase_nr; i++) {
+		MPI_Barrier(MPI_COMM_WORLD);
+		rc = ts_phase_run(&phases[i]);
+		if (rc) {
+			fprintf(stderr, "Phase %s failed: %d\n",
+				phases[i].tp_name, rc);
+			break;
 		}
 
-		agg_duration = last_end - first_start;
-
-		if (ts_ctx.tsc_mpi_size > 1) {
-			MPI_Reduce(&duration, &duration_max, 1, MPI_DOUBLE,
-				   MPI_MAX, 0, MPI_COMM_WORLD);
-			MPI_Reduce(&duration, &duration_min, 1, MPI_DOUBLE,
-				   MPI_MIN, 0, MPI_COMM_WORLD);
-			MPI_Reduce(&duration, &duration_sum, 1, MPI_DOUBLE,
-				   MPI_SUM, 0, MPI_COMM_WORLD);
-		} else {
-			duration_max = duration_min = duration_sum = duration;
-		}
+		ts_phase_reduce(&phases[i]);
+		if (ts_ctx.tsc_mpi_rank == 0)
+			ts_phase_print(&phases[i]);
+	}
 
-		if (ts_ctx.tsc_mpi_rank == 0) {
-			unsigned long	total;
-			double		bandwidth;
-			double		latency;
-			double		rate;
-
-			total = ts_ctx.tsc_mpi_size *
-				ts_obj_p_cont * ts_dkey_p_obj *
-				ts_akey_p_dkey * ts_recx_p_akey;
-
-			rate = total / agg_duration;
-			latency = (agg_duration * 1000 * 1000) / total;
-			bandwidth = (rate * vsize) / (1024 * 1024);
-
-			fprintf(stdout, "Successfully completed:\n"
-				"\tduration : %-10.6f sec\n"
-				"\tbandwith : %-10.3f MB/sec\n"
-				"\trate     : %-10.2f IO/sec\n"
-				"\tlatency  : %-10.3f us "
-				"(nonsense if credits > 1)\n",
-				agg_duration, bandwidth, rate, latency);
-
-			fprintf(stdout, "Duration across processes:\n");
-			fprintf(stdout, "MAX duration : %-10.6f sec\n",
-				duration_max);
-			fprintf(stdout, "MIN duration : %-10.6f sec\n",
-				duration_min);
-			fprintf(stdout, "Average duration : %-10.6f sec\n",
-				duration_sum / ts_ctx.tsc_mpi_size);
-		}
+	if (rc == 0 && ts_ctx.tsc_mpi_rank == 0) {
+		fprintf(stdout, "Successfully completed\n");
+		if (ts_json != NULL)
+			ts_report_json(phases, phase_nr);
 	}
 
 	dts_ctx_fini(&ts_ctx);
 	MPI_Finalize();
+	free(ts_indices);
+	free(ts_oids);
 
 	return 0;
 }
@@ -43,6 +43,7 @@
 #include <daos.h>
 #include <daos/common.h>
 #include <daos/tests_lib.h>
+#include <daos/metrics.h>
 #include <daos_srv/vos.h>
 #include <daos_test.h>
 #include "dts_common.h"
@@ -79,14 +80,21 @@ credit_poll(struct dts_context *tsc, bool drain)
 		}
 
 		for (i = 0; i < rc; i++) {
-			int err = evs[i]->ev_error;
+			struct dts_io_credit *cred;
+			int		      err = evs[i]->ev_error;
 
 			if (err != 0) {
 				fprintf(stderr, "failed op: %d\n", err);
 				return err;
 			}
-			tsc->tsc_credits[tsc->tsc_cred_avail] =
-			   container_of(evs[i], struct dts_io_credit, tc_ev);
+			cred = container_of(evs[i], struct dts_io_credit,
+					    tc_ev);
+			if (cred->tc_lat != NULL)
+				daos_hist_record(cred->tc_lat,
+						 daos_metric_clock() -
+						 cred->tc_start);
+
+			tsc->tsc_credits[tsc->tsc_cred_avail] = cred;
 
 			tsc->tsc_cred_inuse--;
 			tsc->tsc_cred_avail++;
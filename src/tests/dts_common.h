@@ -26,6 +26,8 @@
 
 #define DTS_KEY_LEN		64
 
+struct daos_hist;
+
 /**
  * I/O credit, the utility can only issue \a ts_credits_avail concurrent I/Os,
  * each credit can carry all parameters for the asynchronous I/O call.
@@ -46,6 +48,13 @@ struct dts_io_credit {
 	daos_event_t		 tc_ev;
 	/** points to \a tc_ev in async mode, otherwise it's NULL */
 	daos_event_t		*tc_evp;
+	/** submit time of the I/O in nanoseconds */
+	uint64_t		 tc_start;
+	/**
+	 * optional, latency of the asynchronous I/O is added to this
+	 * histogram on completion
+	 */
+	struct daos_hist	*tc_lat;
 };
 
 #define DTS_CRED_MAX		1024
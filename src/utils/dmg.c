@@ -31,6 +31,7 @@
 #include <daos/common.h>
 #include <daos/object.h>
 #include <daos/mgmt.h>
+#include <daos/metrics.h>
 
 const unsigned int	 default_mode = 0731;
 const char		*default_size = "256M";
@@ -456,6 +457,77 @@ kill_hdlr(int argc, char *argv[])
 	return 0;
 }
 
+static int
+metrics_hdlr(int argc, char *argv[])
+{
+	struct option		options[] = {
+		{"group",	required_argument,	NULL,	'G'},
+		{"rank",	required_argument,	NULL,	'r'},
+		{NULL,		0,			NULL,	0}
+	};
+	const char	       *group = default_group;
+	d_rank_t		rank = -1;
+	struct daos_metrics    *dm;
+	int			rc;
+	int			i;
+
+	while ((rc = getopt_long(argc, argv, "", options, NULL)) != -1) {
+		switch (rc) {
+		case 'G':
+			group = optarg;
+			break;
+		case 'r':
+			rank = atoi(optarg);
+			break;
+		default:
+			return 2;
+		}
+	}
+
+	if (rank == (d_rank_t)-1) {
+		fprintf(stderr, "valid target rank required\n");
+		return 2;
+	}
+
+	D__ALLOC_PTR(dm);
+	if (dm == NULL)
+		return -DER_NOMEM;
+
+	rc = daos_mgmt_metrics_query(group, rank, dm, NULL);
+	if (rc != 0) {
+		fprintf(stderr, "failed to query metrics of rank %u: %d\n",
+			rank, rc);
+		D__GOTO(out, rc);
+	}
+
+	printf("counters:\n");
+	for (i = 0; i < DMC_NR; i++)
+		printf("  %-20s %"PRIu64"\n", daos_metric_cnt_name(i),
+		       dm->dm_cnts[i]);
+
+	printf("gauges:\n");
+	for (i = 0; i < DMG_NR; i++)
+		printf("  %-20s %"PRId64"\n", daos_metric_gauge_name(i),
+		       dm->dm_gauges[i]);
+
+	printf("histograms:\n");
+	printf("  %-20s %12s %10s %10s %10s %10s\n", "", "count", "avg",
+	       "p50", "p99", "max");
+	for (i = 0; i < DMH_NR; i++) {
+		struct daos_hist *hist = &dm->dm_hists[i];
+
+		printf("  %-20s %12"PRIu64" %10"PRIu64" %10"PRIu64
+		       " %10"PRIu64" %10"PRIu64"\n",
+		       daos_metric_hist_name(i), hist->h_count,
+		       hist->h_count == 0 ? 0 : hist->h_sum / hist->h_count,
+		       daos_hist_percentile(hist, 50),
+		       daos_hist_percentile(hist, 99), hist->h_max);
+	}
+out:
+	D__FREE_PTR(dm);
+	return rc;
+}
+
 /* oid str: oid_hi.oid_lo */
 static int
 daos_obj_id_parse(const char *oid_str, daos_obj_id_t *oid)
@@ -625,6 +697,7 @@ commands:\n\
   exclude	exclude a target from a pool\n\
   kill		kill remote daos server\n\
   layout	get object layout\n\
+  metrics	query metrics of a daos server\n\
   help		print this message and exit\n");
 	printf("\
 create options:\n\
@@ -660,6 +733,10 @@ kill options:\n\
   --force	unclean shutdown\n\
   --rank=INT	rank of the DAOS server to kill\n", default_group);
 	printf("\
+metrics options:\n\
+  --group=STR	pool server process group (\"%s\")\n\
+  --rank=INT	rank of the DAOS server to query\n", default_group);
+	printf("\
 query options:\n\
   --group=STR	pool server process group (\"%s\")\n\
   --pool=UUID	pool UUID\n\
@@ -694,6 +771,8 @@ main(int argc, char *argv[])
 		hdlr = pool_op_hdlr;
 	else if (strcmp(argv[1], "layout") == 0)
 		hdlr = obj_op_hdlr;
+	else if (strcmp(argv[1], "metrics") == 0)
+		hdlr = metrics_hdlr;
 
 	if (hdlr == NULL || hdlr == help_hdlr) {
 		help_hdlr(argc, argv);
@@ -95,6 +95,17 @@ struct evt_context {
 	struct evt_trace		*tc_trace;
 	/** customized operation table for different tree policies */
 	struct evt_policy_ops		*tc_ops;
+	/**
+	 * entries removed from a full leaf by forced reinsert, only for
+	 * policies which have \a po_reinsert, there are \a tc_order slots.
+	 */
+	struct evt_entry		*tc_reinsert;
+	/** number of entries in \a tc_reinsert */
+	unsigned int			 tc_reinsert_nr;
+	/** forced reinsert has been done by the current insert */
+	bool				 tc_reinserted;
+	/** statistics of this open handle */
+	struct evt_stats		 tc_stats;
 };
 
 #define EVT_NODE_NULL			TMMID_NULL(struct evt_node)
@@ -173,6 +184,9 @@ evt_tcx_decref(struct evt_context *tcx)
 	D__ASSERT(tcx->tc_ref > 0);
 	tcx->tc_ref--;
 	if (tcx->tc_ref == 0) {
+		if (tcx->tc_reinsert != NULL)
+			D__FREE(tcx->tc_reinsert,
+				tcx->tc_order * sizeof(*tcx->tc_reinsert));
 		tcx->tc_magic = EVT_HDL_DEAD;
 		D__FREE_PTR(tcx);
 	}
@@ -25,15 +25,34 @@
 #include "evt_priv.h"
 
 static struct evt_policy_ops evt_ssof_pol_ops;
+static struct evt_policy_ops evt_rstar_pol_ops;
+static struct evt_policy_ops evt_sepc_pol_ops;
 /**
- * Tree policy table.
- * - Sorted by Start Offset(SSOF): it is the only policy for now.
+ * Tree policy table, indexed by the bit position of the policy feature.
+ * - Sorted by Start Offset(SSOF)
+ * - R*-tree (RSTAR)
+ * - Sorted by Start EPoCh (SEPC)
  */
 static struct evt_policy_ops *evt_policies[] = {
 	&evt_ssof_pol_ops,
+	&evt_rstar_pol_ops,
+	&evt_sepc_pol_ops,
 	NULL,
 };
 
+/** Return the operation table of the tree policy of \a feats */
+static struct evt_policy_ops *
+evt_feats2policy(uint64_t feats)
+{
+	uint64_t	pol = feats & EVT_POLICY_MASK;
+
+	/* exactly one policy */
+	if (pol == 0 || (pol & (pol - 1)) != 0)
+		return NULL;
+
+	return evt_policies[__builtin_ctzll(pol)];
+}
+
 static struct evt_rect *evt_node_mbr_get(struct evt_context *tcx,
 					 TMMID(struct evt_node) nd_mmid);
 
@@ -229,11 +248,256 @@ evt_ent_list_alloc(struct evt_entry_list *ent_list)
 	return ent;
 }
 
-/** Sort all entries of the ent_list */
+/** Initialize an entry array */
+void
+evt_ent_array_init(struct evt_entry_array *ent_array)
+{
+	memset(ent_array, 0, sizeof(*ent_array));
+}
+
+/** Finalize an entry array and release all its buffers */
+void
+evt_ent_array_fini(struct evt_entry_array *ent_array)
+{
+	if (ent_array->ea_ents != NULL)
+		D__FREE(ent_array->ea_ents,
+			ent_array->ea_size * sizeof(*ent_array->ea_ents));
+	if (ent_array->ea_raw != NULL)
+		D__FREE(ent_array->ea_raw,
+			ent_array->ea_raw_size * sizeof(*ent_array->ea_raw));
+	if (ent_array->ea_heap != NULL)
+		D__FREE(ent_array->ea_heap,
+			ent_array->ea_raw_size * sizeof(*ent_array->ea_heap));
+	memset(ent_array, 0, sizeof(*ent_array));
+}
+
+/** Grow the visible extents of \a ent_array to at least \a size entries */
+static int
+evt_ent_array_reserve(struct evt_entry_array *ent_array, unsigned int size)
+{
+	struct evt_entry	*ents;
+	unsigned int		 new_size;
+
+	if (ent_array->ea_size >= size)
+		return 0;
+
+	new_size = max(ent_array->ea_size, ERT_ENT_EMBEDDED * 4);
+	while (new_size < size)
+		new_size <<= 1;
+
+	D__ALLOC(ents, new_size * sizeof(*ents));
+	if (ents == NULL)
+		return -DER_NOMEM;
+
+	if (ent_array->ea_ents != NULL)
+		D__FREE(ent_array->ea_ents,
+			ent_array->ea_size * sizeof(*ents));
+	ent_array->ea_ents = ents;
+	ent_array->ea_size = new_size;
+	return 0;
+}
+
+/**
+ * Take a free raw entry of \a ent_array, buffers are doubled if they are
+ * full, but never shrunk.
+ */
+static struct evt_entry *
+evt_ent_array_raw_alloc(struct evt_entry_array *ent_array)
+{
+	struct evt_entry	*ent;
+
+	if (ent_array->ea_raw_nr == ent_array->ea_raw_size) {
+		struct evt_entry	*raw;
+		unsigned int		*heap;
+		unsigned int		 size;
+
+		size = max(ent_array->ea_raw_size * 2, ERT_ENT_EMBEDDED * 4);
+		D__ALLOC(raw, size * sizeof(*raw));
+		if (raw == NULL)
+			return NULL;
+
+		D__ALLOC(heap, size * sizeof(*heap));
+		if (heap == NULL) {
+			D__FREE(raw, size * sizeof(*raw));
+			return NULL;
+		}
+
+		if (ent_array->ea_raw != NULL) {
+			memcpy(raw, ent_array->ea_raw,
+			       ent_array->ea_raw_nr * sizeof(*raw));
+			D__FREE(ent_array->ea_raw,
+				ent_array->ea_raw_size * sizeof(*raw));
+			D__FREE(ent_array->ea_heap,
+				ent_array->ea_raw_size * sizeof(*heap));
+		}
+		ent_array->ea_raw = raw;
+		ent_array->ea_heap = heap;
+		ent_array->ea_raw_size = size;
+	}
+
+	ent = &ent_array->ea_raw[ent_array->ea_raw_nr++];
+	memset(ent, 0, sizeof(*ent));
+	return ent;
+}
+
+/** sort extents by start offset, then by descending epoch */
+static int
+evt_ent_cmp(const void *p1, const void *p2)
+{
+	const struct evt_rect *rt1 = &((const struct evt_entry *)p1)->en_rect;
+	const struct evt_rect *rt2 = &((const struct evt_entry *)p2)->en_rect;
+
+	if (rt1->rc_off_lo != rt2->rc_off_lo)
+		return rt1->rc_off_lo < rt2->rc_off_lo ? -1 : 1;
+	if (rt1->rc_epc_lo != rt2->rc_epc_lo)
+		return rt1->rc_epc_lo > rt2->rc_epc_lo ? -1 : 1;
+	return 0;
+}
+
+/** is raw entry \a i1 newer than raw entry \a i2 */
+static inline bool
+evt_ent_newer(struct evt_entry *raw, unsigned int i1, unsigned int i2)
+{
+	return raw[i1].en_rect.rc_epc_lo > raw[i2].en_rect.rc_epc_lo;
+}
+
+/** push raw entry \a idx to the max-heap of epochs */
+static void
+evt_ent_heap_push(struct evt_entry_array *ent_array, unsigned int *nr,
+		  unsigned int idx)
+{
+	unsigned int	*heap = ent_array->ea_heap;
+	unsigned int	 i = (*nr)++;
+
+	while (i > 0 &&
+	       evt_ent_newer(ent_array->ea_raw, idx, heap[(i - 1) / 2])) {
+		heap[i] = heap[(i - 1) / 2];
+		i = (i - 1) / 2;
+	}
+	heap[i] = idx;
+}
+
+/** remove the newest raw entry from the max-heap of epochs */
 static void
-evt_ent_list_sort(struct evt_entry_list *ent_list)
+evt_ent_heap_pop(struct evt_entry_array *ent_array, unsigned int *nr)
 {
-	/* TODO */
+	unsigned int	*heap = ent_array->ea_heap;
+	unsigned int	 last;
+	unsigned int	 i = 0;
+
+	last = heap[--(*nr)];
+	while (2 * i + 1 < *nr) {
+		unsigned int	child = 2 * i + 1;
+
+		if (child + 1 < *nr &&
+		    evt_ent_newer(ent_array->ea_raw, heap[child + 1],
+				  heap[child]))
+			child++;
+		if (!evt_ent_newer(ent_array->ea_raw, heap[child], last))
+			break;
+		heap[i] = heap[child];
+		i = child;
+	}
+	heap[i] = last;
+}
+
+/** append the part [lo, hi] of \a src to the visible extents */
+static void
+evt_ent_array_emit(struct evt_entry_array *ent_array, struct evt_entry *src,
+		   daos_off_t lo, daos_off_t hi)
+{
+	struct evt_entry	*ent;
+	daos_size_t		 skip;
+
+	D__ASSERT(ent_array->ea_ent_nr < ent_array->ea_size);
+	ent = &ent_array->ea_ents[ent_array->ea_ent_nr++];
+
+	*ent = *src;
+	skip = lo - src->en_rect.rc_off_lo;
+	ent->en_rect.rc_off_lo = lo;
+	ent->en_rect.rc_off_hi = hi;
+	if (ent->en_addr != NULL) {
+		ent->en_offset += skip;
+		ent->en_addr = (char *)ent->en_addr + skip * ent->en_inob;
+	}
+
+	/* checksum only covers the whole extent */
+	if (lo != src->en_rect.rc_off_lo || hi != src->en_rect.rc_off_hi)
+		daos_csum_set(&ent->en_csum, NULL, 0);
+}
+
+/**
+ * Resolve the raw extents collected by the search of \a rect into visible
+ * extents: sweep the raw extents in order of offset, and keep the extents
+ * covering the current offset in a heap ordered by epoch, the newest one is
+ * visible until it ends or a newer extent starts.
+ *
+ * Raw extents have been clipped to the offsets of \a rect, n raw extents
+ * produce at most 2n - 1 visible extents.
+ */
+static int
+evt_ent_array_resolve(struct evt_entry_array *ent_array,
+		      struct evt_rect *rect)
+{
+	struct evt_entry	*raw = ent_array->ea_raw;
+	unsigned int		 raw_nr = ent_array->ea_raw_nr;
+	unsigned int		 heap_nr = 0;
+	unsigned int		 i = 0;
+	daos_off_t		 pos;
+	int			 rc;
+
+	ent_array->ea_ent_nr = 0;
+	if (raw_nr == 0)
+		return 0;
+
+	rc = evt_ent_array_reserve(ent_array, 2 * raw_nr);
+	if (rc != 0)
+		return rc;
+
+	qsort(raw, raw_nr, sizeof(*raw), evt_ent_cmp);
+
+	pos = raw[0].en_rect.rc_off_lo;
+	while (1) {
+		struct evt_entry	*top;
+		daos_off_t		 end;
+		unsigned int		 j;
+
+		for (; i < raw_nr && raw[i].en_rect.rc_off_lo <= pos; i++)
+			evt_ent_heap_push(ent_array, &heap_nr, i);
+
+		/* drop the extents which end before the current offset */
+		while (heap_nr > 0 &&
+		       raw[ent_array->ea_heap[0]].en_rect.rc_off_hi < pos)
+			evt_ent_heap_pop(ent_array, &heap_nr);
+
+		if (heap_nr == 0) {
+			if (i == raw_nr)
+				break; /* all done */
+			/* a hole, jump to the next extent */
+			pos = raw[i].en_rect.rc_off_lo;
+			continue;
+		}
+
+		top = &raw[ent_array->ea_heap[0]];
+		end = top->en_rect.rc_off_hi;
+		/* visible until a newer extent starts */
+		for (j = i; j < raw_nr && raw[j].en_rect.rc_off_lo <= end;
+		     j++) {
+			if (raw[j].en_rect.rc_epc_lo > top->en_rect.rc_epc_lo) {
+				end = raw[j].en_rect.rc_off_lo - 1;
+				break;
+			}
+		}
+
+		evt_ent_array_emit(ent_array, top, pos, end);
+		if (end >= rect->rc_off_hi)
+			break;
+		pos = end + 1;
+	}
+
+	D__DEBUG(DB_TRACE, "Resolved %u extents to %u visible extents\n",
+		 raw_nr, ent_array->ea_ent_nr);
+	return 0;
 }
 
 daos_handle_t
@@ -328,9 +592,6 @@ evt_tcx_create(TMMID(struct evt_root) root_mmid, struct evt_root *root,
 	tcx->tc_ref = 1; /* for the caller */
 	tcx->tc_magic = EVT_HDL_ALIVE;
 
-	/* XXX choose ops based on feature bits */
-	tcx->tc_ops = evt_policies[0];
-
 	evt_ent_list_init(&tcx->tc_ent_list);
 	DAOS_INIT_LIST_HEAD(&tcx->tc_ent_clipping);
 	DAOS_INIT_LIST_HEAD(&tcx->tc_ent_inserting);
@@ -363,6 +624,19 @@ evt_tcx_create(TMMID(struct evt_root) root_mmid, struct evt_root *root,
 			TMMID_P(root_mmid));
 	}
 
+	tcx->tc_ops = evt_feats2policy(tcx->tc_feats);
+	if (tcx->tc_ops == NULL) {
+		D__ERROR("Invalid feature bits "DF_X64"\n", tcx->tc_feats);
+		D__GOTO(failed, rc = -DER_INVAL);
+	}
+
+	if (tcx->tc_ops->po_reinsert != NULL) {
+		D__ALLOC(tcx->tc_reinsert,
+			 tcx->tc_order * sizeof(*tcx->tc_reinsert));
+		if (tcx->tc_reinsert == NULL)
+			D__GOTO(failed, rc = -DER_NOMEM);
+	}
+
 	evt_tcx_set_dep(tcx, depth);
 	*tcx_pp = tcx;
 	return 0;
@@ -395,12 +669,13 @@ evt_tcx_clone(struct evt_context *tcx, struct evt_context **tcx_pp)
  * \param mmid		[IN]	Optional, memory ID of the external buffer
  * \param idx_nob	[IN]	Number Of Bytes per index
  * \param idx_num	[IN]	Indicies within the extent
+ * \param csum		[IN]	Optional, checksum of the extent
  * \param ptr_mmid_p	[OUT]	The returned memory ID of extent pointer.
  */
 static int
 evt_ptr_create(struct evt_context *tcx, uuid_t cookie, uint32_t pm_ver,
 	       umem_id_t mmid, uint32_t idx_nob, uint64_t idx_num,
-	       TMMID(struct evt_ptr) *ptr_mmid_p)
+	       daos_csum_buf_t *csum, TMMID(struct evt_ptr) *ptr_mmid_p)
 {
 	struct evt_ptr		*ptr;
 	TMMID(struct evt_ptr)	 ptr_mmid;
@@ -416,6 +691,15 @@ evt_ptr_create(struct evt_context *tcx, uuid_t cookie, uint32_t pm_ver,
 	uuid_copy(ptr->pt_cookie, cookie);
 	ptr->pt_ver = pm_ver;
 
+	if (csum != NULL && csum->cs_len != 0) {
+		if (csum->cs_len > sizeof(ptr->pt_csum))
+			D__GOTO(failed, rc = -DER_INVAL);
+
+		ptr->pt_cs_type = csum->cs_type;
+		ptr->pt_cs_len = csum->cs_len;
+		memcpy(&ptr->pt_csum, csum->cs_csum, csum->cs_len);
+	}
+
 	if (UMMID_IS_NULL(mmid) && idx_nob * idx_num > EVT_PTR_PAYLOAD) {
 		mmid = umem_alloc(evt_umm(tcx), idx_nob * idx_num);
 		if (UMMID_IS_NULL(mmid))
@@ -572,7 +856,6 @@ evt_node_is_full(struct evt_context *tcx, TMMID(struct evt_node) nd_mmid)
 	return nd->tn_nr == tcx->tc_order;
 }
 
-#if 0
 static inline void
 evt_node_set(struct evt_context *tcx, TMMID(struct evt_node) nd_mmid,
 	     unsigned int bits)
@@ -581,7 +864,6 @@ evt_node_set(struct evt_context *tcx, TMMID(struct evt_node) nd_mmid,
 
 	nd->tn_flags |= bits;
 }
-#endif
 
 static inline void
 evt_node_unset(struct evt_context *tcx, TMMID(struct evt_node) nd_mmid,
@@ -768,7 +1050,6 @@ evt_node_destroy(struct evt_context *tcx, TMMID(struct evt_node) nd_mmid,
 	evt_node_free(tcx, nd_mmid);
 }
 
-#if 0
 static inline int
 evt_node_tx_add(struct evt_context *tcx, TMMID(struct evt_node) nd_mmid)
 {
@@ -780,7 +1061,6 @@ evt_node_tx_add(struct evt_context *tcx, TMMID(struct evt_node) nd_mmid)
 			       evt_node_size(tcx, nd->tn_flags));
 	return rc;
 }
-#endif
 
 /** Return the MBR of a node */
 static struct evt_rect *
@@ -828,6 +1108,7 @@ evt_node_split(struct evt_context *tcx, bool leaf,
 {
 	int	rc;
 
+	tcx->tc_stats.es_splits++;
 	rc = tcx->tc_ops->po_split(tcx, leaf, src_mmid, dst_mmid);
 	if (rc == 0) { /* calculate MBR for both nodes */
 		evt_node_mbr_cal(tcx, src_mmid);
@@ -1153,6 +1434,84 @@ evt_select_node(struct evt_context *tcx, struct evt_rect *rect,
 	return rc < 0 ? nd_mmid1 : nd_mmid2;
 }
 
+/**
+ * Remove the entry at the offset \a at of the node \a nd_mmid, it is a leaf
+ * record or a child node, which should be freed by the caller.
+ */
+static void
+evt_node_entry_remove(struct evt_context *tcx, TMMID(struct evt_node) nd_mmid,
+		      unsigned int at)
+{
+	struct evt_node		*nd = evt_tmmid2ptr(tcx, nd_mmid);
+	struct evt_rect		*rect;
+	int			 nr;
+
+	D__ASSERT(at < nd->tn_nr);
+	nr = nd->tn_nr - at - 1;
+	rect = evt_node_rect_at(tcx, nd_mmid, at);
+	memmove(rect, rect + 1, nr * sizeof(*rect));
+	if (evt_node_is_leaf(tcx, nd_mmid)) {
+		struct evt_ptr_ref *pref = evt_node_pref_at(tcx, nd_mmid, at);
+
+		memmove(pref, pref + 1, nr * sizeof(*pref));
+	} else {
+		TMMID(struct evt_node) *child;
+
+		child = evt_node_child_at(tcx, nd_mmid, at);
+		memmove(child, child + 1, nr * sizeof(*child));
+	}
+	nd->tn_nr--;
+}
+
+/**
+ * Forced reinsert: instead of splitting the full leaf at \a level of the
+ * trace, move the entries picked by the tree policy to tcx::tc_reinsert,
+ * they will be inserted again by evt_insert_entries(). MBRs of the leaf and
+ * all its ancestors are recomputed because they could have shrunk.
+ *
+ * Removed entries keep their refcount on the extent pointers until they are
+ * inserted again.
+ */
+static int
+evt_node_reinsert(struct evt_context *tcx, int level)
+{
+	TMMID(struct evt_node)	 nd_mmid = tcx->tc_trace[level].tr_node;
+	unsigned int		 ats[EVT_ORDER_MAX];
+	int			 nr;
+	int			 i;
+
+	nr = tcx->tc_ops->po_reinsert(tcx, nd_mmid, ats);
+	D__ASSERT(nr > 0 && nr < tcx->tc_order);
+	D__DEBUG(DB_TRACE, "Reinsert %d entries at level %d\n", nr, level);
+
+	tcx->tc_reinserted = true;
+	tcx->tc_stats.es_reinserts += nr;
+	/* remove from the tail so positions of other entries are kept */
+	for (i = nr - 1; i >= 0; i--) {
+		struct evt_entry	*ent;
+		struct evt_ptr_ref	*pref;
+
+		ent = &tcx->tc_reinsert[tcx->tc_reinsert_nr++];
+		memset(ent, 0, sizeof(*ent));
+		ent->en_rect = *evt_node_rect_at(tcx, nd_mmid, ats[i]);
+		pref = evt_node_pref_at(tcx, nd_mmid, ats[i]);
+		ent->en_offset = pref->pr_offset;
+		ent->en_mmid = umem_id_t2u(pref->pr_ptr_mmid);
+		evt_node_entry_remove(tcx, nd_mmid, ats[i]);
+	}
+
+	evt_node_mbr_cal(tcx, nd_mmid);
+	for (level--; level >= 0; level--) {
+		struct evt_trace *trace = &tcx->tc_trace[level];
+
+		*evt_node_rect_at(tcx, trace->tr_node, trace->tr_at) =
+			*evt_node_mbr_get(tcx, nd_mmid);
+		nd_mmid = trace->tr_node;
+		evt_node_mbr_cal(tcx, nd_mmid);
+	}
+	return 0;
+}
+
 /**
  * Insert an entry \a entry to the leaf node located by the trace of \a tcx.
  * If the leaf node is full it will be split. The split will bubble up if its
@@ -1212,11 +1571,20 @@ evt_insert_or_split(struct evt_context *tcx, struct evt_entry *ent_new)
 			level--;
 			continue;
 		}
+		leaf = evt_node_is_leaf(tcx, nm_cur);
+		if (leaf && level != 0 && tcx->tc_ops->po_reinsert != NULL &&
+		    !tcx->tc_reinserted) {
+			/* only once for each insert, and never for the root */
+			rc = evt_node_reinsert(tcx, level);
+			if (rc != 0)
+				D__GOTO(failed, rc);
+			continue; /* the leaf is not full anymore */
+		}
+
 		/* Try to split */
 
 		D__DEBUG(DB_TRACE, "Split node at level %d\n", level);
 
-		leaf = evt_node_is_leaf(tcx, nm_cur);
 		rc = evt_node_alloc(tcx, leaf ? EVT_NODE_LEAF : 0, &nm_new);
 		if (rc != 0)
 			D__GOTO(failed, rc);
@@ -1362,6 +1730,19 @@ evt_insert_entries(struct evt_context *tcx)
 		if (rc != 0)
 			D__GOTO(failed, rc);
 	}
+
+	/* entries removed by forced reinsert */
+	while (tcx->tc_reinsert_nr > 0) {
+		struct evt_entry ent;
+
+		ent = tcx->tc_reinsert[--tcx->tc_reinsert_nr];
+		rc = evt_insert_entry(tcx, &ent);
+		if (rc != 0)
+			D__GOTO(failed, rc);
+
+		/* the leaf has taken its own refcount */
+		evt_ptr_decref(tcx, umem_id_u2t(ent.en_mmid, struct evt_ptr));
+	}
 	D_EXIT;
 	return 0;
 failed:
@@ -1390,6 +1771,8 @@ evt_insert_ptr(struct evt_context *tcx, struct evt_rect *rect,
 	DAOS_INIT_LIST_HEAD(&tcx->tc_ent_clipping);
 	DAOS_INIT_LIST_HEAD(&tcx->tc_ent_inserting);
 	evt_ent_list_init(&tcx->tc_ent_list);
+	tcx->tc_reinsert_nr = 0;
+	tcx->tc_reinserted = false;
 
 	if (tcx->tc_depth == 0) { /* empty tree */
 		rc = evt_root_activate(tcx);
@@ -1431,7 +1814,8 @@ evt_insert_ptr(struct evt_context *tcx, struct evt_rect *rect,
  */
 int
 evt_insert(daos_handle_t toh, uuid_t cookie, uint32_t pm_ver,
-	   struct evt_rect *rect, uint32_t inob, umem_id_t mmid)
+	   struct evt_rect *rect, uint32_t inob, umem_id_t mmid,
+	   daos_csum_buf_t *csum)
 {
 	struct evt_context	*tcx;
 	TMMID(struct evt_ptr)	 ptr_mmid;
@@ -1442,7 +1826,7 @@ evt_insert(daos_handle_t toh, uuid_t cookie, uint32_t pm_ver,
 		return -DER_NO_HDL;
 
 	rc = evt_ptr_create(tcx, cookie, pm_ver, mmid, inob,
-			    evt_rect_width(rect), &ptr_mmid);
+			    evt_rect_width(rect), csum, &ptr_mmid);
 	if (rc != 0)
 		return rc;
 
@@ -1464,7 +1848,8 @@ evt_insert(daos_handle_t toh, uuid_t cookie, uint32_t pm_ver,
  */
 int
 evt_insert_sgl(daos_handle_t toh, uuid_t cookie, uint32_t pm_ver,
-	       struct evt_rect *rect, uint32_t inob, daos_sg_list_t *sgl)
+	       struct evt_rect *rect, uint32_t inob, daos_sg_list_t *sgl,
+	       daos_csum_buf_t *csum)
 {
 	struct evt_context	*tcx;
 	TMMID(struct evt_ptr)	 ptr_mmid;
@@ -1476,7 +1861,7 @@ evt_insert_sgl(daos_handle_t toh, uuid_t cookie, uint32_t pm_ver,
 		return -DER_NO_HDL;
 
 	rc = evt_ptr_create(tcx, cookie, pm_ver, UMMID_NULL, inob,
-			    evt_rect_width(rect), &ptr_mmid);
+			    evt_rect_width(rect), csum, &ptr_mmid);
 	if (rc != 0)
 		return rc;
 
@@ -1551,6 +1936,15 @@ evt_fill_entry(struct evt_context *tcx, TMMID(struct evt_node) nd_mmid,
 	uuid_copy(entry->en_cookie, ptr->pt_cookie);
 	entry->en_ver = ptr->pt_ver;
 
+	/* checksum covers the whole extent, a clipped part can't be verified */
+	if (pref->pr_offset + offset == 0 && width == ptr->pt_inum) {
+		daos_csum_set(&entry->en_csum, &ptr->pt_csum, ptr->pt_cs_len);
+		entry->en_csum.cs_type = ptr->pt_cs_type;
+	} else {
+		daos_csum_set(&entry->en_csum, NULL, 0);
+		entry->en_csum.cs_type = 0;
+	}
+
 	addr = evt_ptr_payload(tcx, pref->pr_ptr_mmid, &entry->en_inob, NULL);
 	if (addr == NULL) { /* punched */
 		entry->en_addr   = NULL;
@@ -1565,18 +1959,18 @@ evt_fill_entry(struct evt_context *tcx, TMMID(struct evt_node) nd_mmid,
 
 /**
  * Find all versioned extents which intercept with the input one \a rect.
- * It attaches all found extents and their data pointers on \a ent_list if
- * \a no_overlap is false, otherwise returns error if there is any overlapped
- * extent.
+ * It stores all found extents and their data pointers either on \a ent_list
+ * or in the raw entries of \a ent_array, the other one should be NULL.
  *
  * \param rect		[IN]	Rectangle to check.
- * \param no_overlap	[IN]	Returns error if \a rect overlap with any
- *				existent extent.
  * \param ent_list	[OUT]	The returned entries for overlapped extents.
+ * \param ent_array	[OUT]	The returned raw entries for overlapped
+ *				extents.
  */
-int
-evt_find_ent_list(struct evt_context *tcx, enum evt_find_opc find_opc,
-		  struct evt_rect *rect, struct evt_entry_list *ent_list)
+static int
+evt_find_ents(struct evt_context *tcx, enum evt_find_opc find_opc,
+	      struct evt_rect *rect, struct evt_entry_list *ent_list,
+	      struct evt_entry_array *ent_array)
 {
 	TMMID(struct evt_node)	 nd_mmid;
 	int			 level;
@@ -1585,10 +1979,12 @@ evt_find_ent_list(struct evt_context *tcx, enum evt_find_opc find_opc,
 	int			 rc = 0;
 
 	D__DEBUG(DB_TRACE, "Searching rectangle "DF_RECT"\n", DP_RECT(rect));
+	tcx->tc_stats.es_searches++;
 	if (tcx->tc_root->tr_depth == 0)
 		return 0; /* empty tree */
 
 	evt_tcx_reset_trace(tcx);
+	tcx->tc_stats.es_node_visits++;
 
 	level = at = 0;
 	nd_mmid = tcx->tc_root->tr_node;
@@ -1666,6 +2062,16 @@ evt_find_ent_list(struct evt_context *tcx, enum evt_find_opc find_opc,
 				    overlap == RT_OVERLAP_SAME)
 					break; /* matched */
 
+				if (overlap == RT_OVERLAP_YES &&
+				    rtmp->rc_epc_lo != rect->rc_epc_lo) {
+					/* Partial overwrite from another
+					 * epoch, both extents are kept and
+					 * evt_find() resolves the visible
+					 * parts.
+					 */
+					continue;
+				}
+
 				D__DEBUG(DB_IO, "Invalid overlap for capping :"
 					DF_RECT" overlaps with "DF_RECT"\n",
 					DP_RECT(rect), DP_RECT(rtmp));
@@ -1681,7 +2087,10 @@ evt_find_ent_list(struct evt_context *tcx, enum evt_find_opc find_opc,
 				break;
 			}
 
-			ent = evt_ent_list_alloc(ent_list);
+			if (ent_array != NULL)
+				ent = evt_ent_array_raw_alloc(ent_array);
+			else
+				ent = evt_ent_list_alloc(ent_list);
 			if (ent == NULL)
 				D__GOTO(out, rc = -DER_NOMEM);
 
@@ -1716,12 +2125,14 @@ evt_find_ent_list(struct evt_context *tcx, enum evt_find_opc find_opc,
 			nd_mmid = *evt_node_child_at(tcx, nd_mmid, i);
 			at = 0;
 			level++;
+			tcx->tc_stats.es_node_visits++;
 
 		} else {
 			struct evt_trace *trace;
 
 			if (level == 0) { /* done with the root */
 				D__DEBUG(DB_TRACE, "Found total %d rects\n",
+					ent_array ? ent_array->ea_raw_nr :
 					ent_list ? ent_list->el_ent_nr : 0);
 				return 0; /* succeed and return */
 			}
@@ -1735,20 +2146,31 @@ evt_find_ent_list(struct evt_context *tcx, enum evt_find_opc find_opc,
 	}
 	D_EXIT;
 out:
-	if (rc != 0)
+	if (rc != 0 && ent_list != NULL)
 		evt_ent_list_fini(ent_list);
 	return rc;
 }
 
+/**
+ * Find all versioned extents which intercept with the input one \a rect,
+ * and attach them and their data pointers on \a ent_list.
+ */
+int
+evt_find_ent_list(struct evt_context *tcx, enum evt_find_opc find_opc,
+		  struct evt_rect *rect, struct evt_entry_list *ent_list)
+{
+	return evt_find_ents(tcx, find_opc, rect, ent_list, NULL);
+}
+
 /**
  * Find all versioned extents intercepting with the input rectangle \a rect
- * and return their data pointers.
+ * and return the data pointers of their visible parts.
  *
  * Please check API comment in evtree.h for the details.
  */
 int
 evt_find(daos_handle_t toh, struct evt_rect *rect,
-	 struct evt_entry_list *ent_list)
+	 struct evt_entry_array *ent_array)
 {
 	struct evt_context *tcx;
 	int		    rc;
@@ -1757,18 +2179,35 @@ evt_find(daos_handle_t toh, struct evt_rect *rect,
 	if (tcx == NULL)
 		return -DER_NO_HDL;
 
-	evt_ent_list_init(ent_list);
-	rc = evt_find_ent_list(tcx, EVT_FIND_ALL, rect, ent_list);
-	if (rc != 0) {
-		evt_ent_list_fini(ent_list);
+	ent_array->ea_ent_nr = 0;
+	ent_array->ea_raw_nr = 0;
+	rc = evt_find_ents(tcx, EVT_FIND_ALL, rect, NULL, ent_array);
+	if (rc != 0)
 		D__GOTO(out, rc);
-	}
-	evt_ent_list_sort(ent_list);
+
+	rc = evt_ent_array_resolve(ent_array, rect);
 	D_EXIT;
  out:
 	return rc;
 }
 
+/**
+ * Return statistics of an open tree.
+ * Please check API comment in evtree.h for the details.
+ */
+int
+evt_stats_get(daos_handle_t toh, struct evt_stats *stats)
+{
+	struct evt_context *tcx;
+
+	tcx = evt_hdl2tcx(toh);
+	if (tcx == NULL)
+		return -DER_NO_HDL;
+
+	*stats = tcx->tc_stats;
+	return 0;
+}
+
 /** move the probing trace forward or backward */
 bool
 evt_move_trace(struct evt_context *tcx, bool forward)
@@ -1895,7 +2334,7 @@ evt_create(uint64_t feats, unsigned int order, struct umem_attr *uma,
 	struct evt_context *tcx;
 	int		    rc;
 
-	if (!(feats & EVT_FEAT_SORT_SOFF)) {
+	if (evt_feats2policy(feats) == NULL) {
 		D__DEBUG(DB_TRACE, "Unknown feature bits "DF_X64"\n", feats);
 		return -DER_INVAL;
 	}
@@ -1932,7 +2371,7 @@ evt_create_inplace(uint64_t feats, unsigned int order, struct umem_attr *uma,
 	struct evt_context *tcx;
 	int		    rc;
 
-	if (!(feats & EVT_FEAT_SORT_SOFF)) {
+	if (evt_feats2policy(feats) == NULL) {
 		D__DEBUG(DB_TRACE, "Unknown feature bits "DF_X64"\n", feats);
 		return -DER_INVAL;
 	}
@@ -1977,6 +2416,223 @@ evt_destroy(daos_handle_t toh)
 	return rc;
 }
 
+/**
+ * Is the evtree empty or not
+ *
+ * \return	0	Not empty
+ *		1	Empty
+ *		-ve	error code
+ */
+int
+evt_is_empty(daos_handle_t toh)
+{
+	struct evt_context *tcx;
+
+	tcx = evt_hdl2tcx(toh);
+	if (tcx == NULL)
+		return -DER_NO_HDL;
+
+	return evt_root_empty(tcx);
+}
+
+/**
+ * Is the versioned extent \a rect within the deletion range \a range: the
+ * extent is in the offset range, and it is written in the epoch range, for
+ * EVT_DEL_OVERWRITTEN, it should also be overwritten before the high epoch
+ * of the range.
+ */
+static bool
+evt_rect_in_range(enum evt_del_opc opc, struct evt_rect *range,
+		  struct evt_rect *rect)
+{
+	if (rect->rc_off_lo < range->rc_off_lo ||
+	    rect->rc_off_hi > range->rc_off_hi ||
+	    rect->rc_epc_lo < range->rc_epc_lo ||
+	    rect->rc_epc_lo > range->rc_epc_hi)
+		return false;
+
+	return opc == EVT_DEL_WRITTEN || rect->rc_epc_hi < range->rc_epc_hi;
+}
+
+/**
+ * Is the MBR \a mbr fully enclosed by the deletion range \a range, so all
+ * extents bounded by it can be deleted without being checked one by one.
+ *
+ * The high epoch of an MBR is the high epoch of its newest extent, which
+ * is DAOS_EPOCH_MAX for an extent that is not fully overwritten yet. Such
+ * an MBR does not bound the epoch at which its extents are written, so for
+ * EVT_DEL_WRITTEN it is only enclosed by an open-ended range. The test is
+ * exact for EVT_DEL_OVERWRITTEN, which never deletes open-ended extents.
+ */
+static bool
+evt_mbr_in_range(enum evt_del_opc opc, struct evt_rect *range,
+		 struct evt_rect *mbr)
+{
+	if (!evt_rect_in_range(opc, range, mbr))
+		return false;
+
+	return range->rc_epc_hi == DAOS_EPOCH_MAX ||
+	       mbr->rc_epc_hi <= range->rc_epc_hi;
+}
+
+/** Is the leaf extent \a rect written by the update tagged with \a cookie */
+static bool
+evt_rect_match_cookie(struct evt_context *tcx, TMMID(struct evt_node) nd_mmid,
+		      int at, uuid_t cookie)
+{
+	struct evt_ptr_ref	*pref;
+	struct evt_ptr		*ptr;
+
+	if (cookie == NULL)
+		return true;
+
+	pref = evt_node_pref_at(tcx, nd_mmid, at);
+	ptr = evt_tmmid2ptr(tcx, pref->pr_ptr_mmid);
+	return uuid_compare(ptr->pt_cookie, cookie) == 0;
+}
+
+/**
+ * Delete all extents within \a range from the subtree of \a nd_mmid, see
+ * evt_rect_in_range() for \a opc. Only extents written by \a cookie are
+ * deleted if it is not NULL:
+ * - children out of the range are skipped.
+ * - children enclosed by the range are destroyed as a whole, unless there
+ *   is a cookie to check.
+ * - children partially in the range are visited recursively, they are
+ *   removed if nothing is left, otherwise their MBRs are refreshed.
+ *
+ * It returns the number of remaining entries of the node, MBR of the node
+ * is recomputed if it is not empty.
+ */
+static int
+evt_node_delete_range(struct evt_context *tcx, TMMID(struct evt_node) nd_mmid,
+		      int level, enum evt_del_opc opc, struct evt_rect *range,
+		      uuid_t cookie)
+{
+	struct evt_node	*nd = evt_tmmid2ptr(tcx, nd_mmid);
+	bool		 leaf = evt_node_is_leaf(tcx, nd_mmid);
+	bool		 changed = false;
+	int		 i;
+
+	for (i = 0; i < nd->tn_nr;) {
+		struct evt_rect		*rect;
+		TMMID(struct evt_node)	 child_mmid;
+		bool			 remove = true;
+
+		rect = evt_node_rect_at(tcx, nd_mmid, i);
+		if (leaf) {
+			remove = evt_rect_in_range(opc, range, rect) &&
+				 evt_rect_match_cookie(tcx, nd_mmid, i, cookie);
+		} else if (evt_rect_overlap(rect, range, false) ==
+			   RT_OVERLAP_NO) {
+			remove = false;
+		} else {
+			child_mmid = *evt_node_child_at(tcx, nd_mmid, i);
+			if ((cookie != NULL ||
+			     !evt_mbr_in_range(opc, range, rect)) &&
+			    evt_node_delete_range(tcx, child_mmid, level + 1,
+						  opc, range, cookie) != 0) {
+				struct evt_rect *mbr;
+
+				remove = false;
+				mbr = evt_node_mbr_get(tcx, child_mmid);
+				if (memcmp(rect, mbr, sizeof(*mbr)) != 0) {
+					if (!changed && evt_has_tx(tcx))
+						evt_node_tx_add(tcx, nd_mmid);
+					changed = true;
+					*rect = *mbr;
+				}
+			}
+		}
+
+		if (!remove) {
+			i++;
+			continue;
+		}
+
+		if (!changed && evt_has_tx(tcx))
+			evt_node_tx_add(tcx, nd_mmid);
+		changed = true;
+
+		if (leaf) {
+			struct evt_ptr_ref *pref;
+
+			pref = evt_node_pref_at(tcx, nd_mmid, i);
+			evt_ptr_decref(tcx, pref->pr_ptr_mmid);
+		} else {
+			/* NB: an emptied child has no record or descendant */
+			evt_node_destroy(tcx, child_mmid, level + 1);
+		}
+		evt_node_entry_remove(tcx, nd_mmid, i);
+	}
+
+	D__DEBUG(DB_TRACE, "%d entries left at level %d, changed %d\n",
+		nd->tn_nr, level, changed);
+	if (changed && nd->tn_nr != 0)
+		evt_node_mbr_cal(tcx, nd_mmid);
+
+	return nd->tn_nr;
+}
+
+/**
+ * Delete all versioned extents within \a range from the tree.
+ * Please check API comment in evtree.h for the details.
+ */
+int
+evt_delete_range(daos_handle_t toh, enum evt_del_opc opc,
+		 struct evt_rect *range, uuid_t cookie)
+{
+	struct evt_context	*tcx;
+	struct evt_root		*root;
+	TMMID(struct evt_node)	 nd_mmid;
+	int			 nr;
+	int			 rc;
+
+	tcx = evt_hdl2tcx(toh);
+	if (tcx == NULL)
+		return -DER_NO_HDL;
+
+	if (evt_root_empty(tcx))
+		return 0;
+
+	D__DEBUG(DB_TRACE, "Delete range "DF_RECT"\n", DP_RECT(range));
+	root = tcx->tc_root;
+	nd_mmid = root->tr_node;
+	nr = evt_node_delete_range(tcx, nd_mmid, 0, opc, range, cookie);
+
+	if (evt_has_tx(tcx) &&
+	    (nr == 0 || (nr == 1 && !evt_node_is_leaf(tcx, nd_mmid)))) {
+		rc = evt_root_tx_add(tcx);
+		if (rc != 0)
+			return rc;
+	}
+
+	if (nr == 0) { /* nothing left */
+		evt_node_free(tcx, nd_mmid);
+		root->tr_node = EVT_NODE_NULL;
+		root->tr_depth = 0;
+	}
+
+	/* replace the root by its only child */
+	while (nr == 1 && !evt_node_is_leaf(tcx, nd_mmid)) {
+		TMMID(struct evt_node) child_mmid;
+
+		child_mmid = *evt_node_child_at(tcx, nd_mmid, 0);
+		evt_node_free(tcx, nd_mmid);
+
+		nd_mmid = child_mmid;
+		if (evt_has_tx(tcx))
+			evt_node_tx_add(tcx, nd_mmid);
+		evt_node_set(tcx, nd_mmid, EVT_NODE_ROOT);
+
+		root->tr_node = nd_mmid;
+		root->tr_depth--;
+		nr = evt_tmmid2ptr(tcx, nd_mmid)->tn_nr;
+	}
+	evt_tcx_set_dep(tcx, root->tr_depth);
+	return 0;
+}
+
 /** Output tree node status */
 static void
 evt_node_debug(struct evt_context *tcx, TMMID(struct evt_node) nd_mmid,
@@ -2036,8 +2692,78 @@ evt_debug(daos_handle_t toh, int debug_level)
 /**
  * Tree policies
  *
- * Only support SSOF for now (see below).
+ * - SSOF: sorted by start offset
+ * - RSTAR: R*-tree split and forced reinsert
+ * - SEPC: sorted by start epoch
+ */
+
+/** Store the entry \a ent at the offset \a at of node \a nd_mmid */
+static void
+evt_node_entry_set(struct evt_context *tcx, TMMID(struct evt_node) nd_mmid,
+		   unsigned int at, struct evt_entry *ent)
+{
+	*evt_node_rect_at(tcx, nd_mmid, at) = ent->en_rect;
+	if (evt_node_is_leaf(tcx, nd_mmid)) {
+		struct evt_ptr_ref *pref = evt_node_pref_at(tcx, nd_mmid, at);
+
+		pref->pr_offset   = ent->en_offset;
+		pref->pr_inum	  = evt_rect_width(&ent->en_rect);
+		pref->pr_ptr_mmid = umem_id_u2t(ent->en_mmid, struct evt_ptr);
+		evt_ptr_addref(tcx, pref->pr_ptr_mmid);
+	} else {
+		*evt_node_child_at(tcx, nd_mmid, at) =
+			umem_id_u2t(ent->en_mmid, struct evt_node);
+	}
+}
+
+/**
+ * Insert \a ent to node \a nd_mmid and keep entries of the node sorted by
+ * \a cmp.
  */
+static int
+evt_sorted_insert(struct evt_context *tcx, TMMID(struct evt_node) nd_mmid,
+		  struct evt_entry *ent,
+		  int (*cmp)(struct evt_context *tcx, struct evt_rect *rt1,
+			     struct evt_rect *rt2))
+{
+	struct evt_node		*nd   = evt_tmmid2ptr(tcx, nd_mmid);
+	struct evt_rect		*rect;
+	int			 i;
+	bool			 leaf;
+
+	D__ASSERT(!evt_node_is_full(tcx, nd_mmid));
+
+	leaf = evt_node_is_leaf(tcx, nd_mmid);
+
+	/* NB: can use binary search to optimize */
+	for (i = 0; i < nd->tn_nr; i++) {
+		int	nr;
+
+		rect = evt_node_rect_at(tcx, nd_mmid, i);
+		if (cmp(tcx, rect, &ent->en_rect) < 0)
+			continue;
+
+		nr = nd->tn_nr - i;
+		memmove(rect + 1, rect, nr * sizeof(*rect));
+		if (leaf) {
+			struct evt_ptr_ref *pref;
+
+			pref = evt_node_pref_at(tcx, nd_mmid, i);
+			memmove(pref + 1, pref, nr * sizeof(*pref));
+		} else {
+			TMMID(struct evt_node) *nmid;
+
+			nmid = evt_node_child_at(tcx, nd_mmid, i);
+			memmove(nmid + 1, nmid, nr * sizeof(*nmid));
+		}
+		break;
+	}
+
+	/* NB: attach at the end if i == nd->tn_nr */
+	evt_node_entry_set(tcx, nd_mmid, i, ent);
+	nd->tn_nr++;
+	return 0;
+}
 
 /**
  * Sorted by Start OFfset (SSOF)
@@ -2076,59 +2802,7 @@ static int
 evt_ssof_insert(struct evt_context *tcx, TMMID(struct evt_node) nd_mmid,
 		struct evt_entry *ent)
 {
-	struct evt_node		*nd   = evt_tmmid2ptr(tcx, nd_mmid);
-	struct evt_rect		*rect = NULL;
-	struct evt_ptr_ref	*pref = NULL;
-	TMMID(struct evt_node)	*nmid = NULL;
-	int			 i;
-	int			 rc;
-	bool			 leaf;
-
-	D__ASSERT(!evt_node_is_full(tcx, nd_mmid));
-
-	leaf = evt_node_is_leaf(tcx, nd_mmid);
-
-	/* NB: can use binary search to optimize */
-	for (i = 0; i < nd->tn_nr; i++) {
-		int	nr;
-
-		rect = evt_node_rect_at(tcx, nd_mmid, i);
-		rc = evt_ssof_cmp_rect(tcx, rect, &ent->en_rect);
-		if (rc < 0)
-			continue;
-
-		nr = nd->tn_nr - i;
-		memmove(rect + 1, rect, nr * sizeof(*rect));
-		if (leaf) {
-			pref = evt_node_pref_at(tcx, nd_mmid, i);
-			memmove(pref + 1, pref, nr * sizeof(*pref));
-		} else {
-			nmid = evt_node_child_at(tcx, nd_mmid, i);
-			memmove(nmid + 1, nmid, nr * sizeof(*nmid));
-		}
-		break;
-	}
-
-	if (i == nd->tn_nr) { /* attach at the end */
-		rect = evt_node_rect_at(tcx, nd_mmid, nd->tn_nr);
-		if (leaf)
-			pref = evt_node_pref_at(tcx, nd_mmid, nd->tn_nr);
-		else
-			nmid = evt_node_child_at(tcx, nd_mmid, nd->tn_nr);
-	}
-
-	*rect = ent->en_rect;
-	if (leaf) {
-		pref->pr_offset   = ent->en_offset;
-		pref->pr_inum	  = evt_rect_width(&ent->en_rect);
-		pref->pr_ptr_mmid = umem_id_u2t(ent->en_mmid, struct evt_ptr),
-		evt_ptr_addref(tcx, pref->pr_ptr_mmid);
-	} else {
-		*nmid = umem_id_u2t(ent->en_mmid, struct evt_node);
-	}
-
-	nd->tn_nr++;
-	return 0;
+	return evt_sorted_insert(tcx, nd_mmid, ent, evt_ssof_cmp_rect);
 }
 
 static int
@@ -2194,3 +2868,367 @@ static struct evt_policy_ops evt_ssof_pol_ops = {
 	.po_split		= evt_ssof_split,
 	.po_rect_weight		= evt_ssof_rect_weight,
 };
+
+/**
+ * R*-tree (RSTAR)
+ *
+ * Nodes are split along the axis where the MBRs of the two new nodes have
+ * the smallest margin, at the position where they overlap the least. Before
+ * splitting a full leaf, the entries farthest from the center of the leaf
+ * are removed and inserted again, so they can find a better place in the
+ * tree.
+ *
+ * The high epoch of most extents is DAOS_EPOCH_MAX, so geometry of the
+ * split is computed on offsets and start epochs only.
+ */
+
+/** minimum fill of a split node, in percent of the tree order */
+#define EVT_RSTAR_FILL_MIN	40
+/** entries removed by forced reinsert, in percent of the tree order */
+#define EVT_RSTAR_REINSERT	30
+
+/** entry of a node being split */
+struct evt_rstar_ent {
+	struct evt_rect			 re_rect;
+	union {
+		struct evt_ptr_ref	 re_pref;
+		TMMID(struct evt_node)	 re_child;
+	};
+};
+
+/** bounding box of offsets and start epochs */
+struct evt_rstar_box {
+	daos_off_t			 rb_off_lo;
+	daos_off_t			 rb_off_hi;
+	daos_epoch_t			 rb_epc_lo;
+	daos_epoch_t			 rb_epc_hi;
+};
+
+static void
+evt_rstar_box_merge(struct evt_rstar_box *box, struct evt_rect *rect,
+		    bool first)
+{
+	if (first || box->rb_off_lo > rect->rc_off_lo)
+		box->rb_off_lo = rect->rc_off_lo;
+	if (first || box->rb_off_hi < rect->rc_off_hi)
+		box->rb_off_hi = rect->rc_off_hi;
+	if (first || box->rb_epc_lo > rect->rc_epc_lo)
+		box->rb_epc_lo = rect->rc_epc_lo;
+	if (first || box->rb_epc_hi < rect->rc_epc_lo)
+		box->rb_epc_hi = rect->rc_epc_lo;
+}
+
+static double
+evt_rstar_margin(struct evt_rstar_box *box)
+{
+	return (double)(box->rb_off_hi - box->rb_off_lo + 1) +
+	       (double)(box->rb_epc_hi - box->rb_epc_lo + 1);
+}
+
+static double
+evt_rstar_area(struct evt_rstar_box *box)
+{
+	return (double)(box->rb_off_hi - box->rb_off_lo + 1) *
+	       (double)(box->rb_epc_hi - box->rb_epc_lo + 1);
+}
+
+static double
+evt_rstar_overlap(struct evt_rstar_box *b1, struct evt_rstar_box *b2)
+{
+	struct evt_rstar_box box;
+
+	box.rb_off_lo = max(b1->rb_off_lo, b2->rb_off_lo);
+	box.rb_off_hi = min(b1->rb_off_hi, b2->rb_off_hi);
+	box.rb_epc_lo = max(b1->rb_epc_lo, b2->rb_epc_lo);
+	box.rb_epc_hi = min(b1->rb_epc_hi, b2->rb_epc_hi);
+	if (box.rb_off_lo > box.rb_off_hi || box.rb_epc_lo > box.rb_epc_hi)
+		return 0;
+
+	return evt_rstar_area(&box);
+}
+
+/** sort keys of the split axes */
+enum {
+	EVT_RSTAR_AXIS_OFF_LO,
+	EVT_RSTAR_AXIS_OFF_HI,
+	EVT_RSTAR_AXIS_EPC,
+	EVT_RSTAR_AXIS_NR,
+};
+
+static int
+evt_rstar_cmp(struct evt_rect *rt1, struct evt_rect *rt2, int axis)
+{
+	uint64_t	k1[2];
+	uint64_t	k2[2];
+
+	switch (axis) {
+	default:
+		D__ASSERT(0);
+	case EVT_RSTAR_AXIS_OFF_LO:
+		k1[0] = rt1->rc_off_lo, k1[1] = rt1->rc_off_hi;
+		k2[0] = rt2->rc_off_lo, k2[1] = rt2->rc_off_hi;
+		break;
+	case EVT_RSTAR_AXIS_OFF_HI:
+		k1[0] = rt1->rc_off_hi, k1[1] = rt1->rc_off_lo;
+		k2[0] = rt2->rc_off_hi, k2[1] = rt2->rc_off_lo;
+		break;
+	case EVT_RSTAR_AXIS_EPC:
+		k1[0] = rt1->rc_epc_lo, k1[1] = rt1->rc_off_lo;
+		k2[0] = rt2->rc_epc_lo, k2[1] = rt2->rc_off_lo;
+		break;
+	}
+
+	if (k1[0] != k2[0])
+		return k1[0] < k2[0] ? -1 : 1;
+	if (k1[1] != k2[1])
+		return k1[1] < k2[1] ? -1 : 1;
+	return 0;
+}
+
+/**
+ * Sort \a idx along \a axis, and compute bounding boxes of the first i + 1
+ * entries to \a pre[i] and of the last n - i entries to \a suf[i].
+ */
+static void
+evt_rstar_sort(struct evt_rstar_ent *ents, unsigned int *idx, int nr,
+	       int axis, struct evt_rstar_box *pre, struct evt_rstar_box *suf)
+{
+	int	i;
+	int	j;
+
+	/* insertion sort, nodes are small and split is not frequent */
+	for (i = 1; i < nr; i++) {
+		unsigned int tmp = idx[i];
+
+		for (j = i; j > 0 && evt_rstar_cmp(&ents[tmp].re_rect,
+						   &ents[idx[j - 1]].re_rect,
+						   axis) < 0; j--)
+			idx[j] = idx[j - 1];
+		idx[j] = tmp;
+	}
+
+	for (i = 0; i < nr; i++) {
+		if (i > 0)
+			pre[i] = pre[i - 1];
+		evt_rstar_box_merge(&pre[i], &ents[idx[i]].re_rect, i == 0);
+	}
+
+	for (i = nr - 1; i >= 0; i--) {
+		if (i < nr - 1)
+			suf[i] = suf[i + 1];
+		evt_rstar_box_merge(&suf[i], &ents[idx[i]].re_rect,
+				    i == nr - 1);
+	}
+}
+
+static int
+evt_rstar_split(struct evt_context *tcx, bool leaf,
+		TMMID(struct evt_node) src_mmid,
+		TMMID(struct evt_node) dst_mmid)
+{
+	struct evt_node		*nd_src = evt_tmmid2ptr(tcx, src_mmid);
+	struct evt_node		*nd_dst = evt_tmmid2ptr(tcx, dst_mmid);
+	struct evt_rstar_ent	*ents;
+	struct evt_rstar_box	*pre;
+	struct evt_rstar_box	*suf;
+	unsigned int		*idx;
+	double			 best = 0;
+	double			 overlap = 0;
+	double			 area = 0;
+	int			 best_axis = 0;
+	int			 nr = nd_src->tn_nr;
+	int			 fill;
+	int			 axis;
+	int			 i;
+	int			 k;
+	int			 rc = 0;
+
+	D__ASSERT(nr == tcx->tc_order);
+	fill = max(nr * EVT_RSTAR_FILL_MIN / 100, 1);
+
+	D__ALLOC(ents, nr * sizeof(*ents));
+	D__ALLOC(pre, 2 * nr * sizeof(*pre));
+	D__ALLOC(idx, nr * sizeof(*idx));
+	if (ents == NULL || pre == NULL || idx == NULL)
+		D__GOTO(out, rc = -DER_NOMEM);
+	suf = &pre[nr];
+
+	for (i = 0; i < nr; i++) {
+		ents[i].re_rect = *evt_node_rect_at(tcx, src_mmid, i);
+		if (leaf)
+			ents[i].re_pref = *evt_node_pref_at(tcx, src_mmid, i);
+		else
+			ents[i].re_child = *evt_node_child_at(tcx, src_mmid, i);
+		idx[i] = i;
+	}
+
+	/* choose the axis with the minimum sum of margins */
+	for (axis = 0; axis < EVT_RSTAR_AXIS_NR; axis++) {
+		double	margin = 0;
+
+		evt_rstar_sort(ents, idx, nr, axis, pre, suf);
+		for (k = fill; k <= nr - fill; k++)
+			margin += evt_rstar_margin(&pre[k - 1]) +
+				  evt_rstar_margin(&suf[k]);
+
+		if (axis == 0 || margin < best) {
+			best = margin;
+			best_axis = axis;
+		}
+	}
+
+	/* choose the distribution with the minimum overlap, then area */
+	evt_rstar_sort(ents, idx, nr, best_axis, pre, suf);
+	i = fill;
+	for (k = fill; k <= nr - fill; k++) {
+		double	ov;
+		double	ar;
+
+		ov = evt_rstar_overlap(&pre[k - 1], &suf[k]);
+		ar = evt_rstar_area(&pre[k - 1]) + evt_rstar_area(&suf[k]);
+		if (k == fill || ov < overlap ||
+		    (ov == overlap && ar < area)) {
+			overlap = ov;
+			area = ar;
+			i = k;
+		}
+	}
+	k = i;
+	D__DEBUG(DB_TRACE, "Split %d entries at %d along axis %d\n",
+		 nr, k, best_axis);
+
+	for (i = 0; i < nr; i++) {
+		TMMID(struct evt_node)	mmid = i < k ? src_mmid : dst_mmid;
+		int			at = i < k ? i : i - k;
+		struct evt_rstar_ent	*ent = &ents[idx[i]];
+
+		*evt_node_rect_at(tcx, mmid, at) = ent->re_rect;
+		if (leaf)
+			*evt_node_pref_at(tcx, mmid, at) = ent->re_pref;
+		else
+			*evt_node_child_at(tcx, mmid, at) = ent->re_child;
+	}
+	nd_dst->tn_nr = nr - k;
+	nd_src->tn_nr = k;
+ out:
+	if (ents != NULL)
+		D__FREE(ents, nr * sizeof(*ents));
+	if (pre != NULL)
+		D__FREE(pre, 2 * nr * sizeof(*pre));
+	if (idx != NULL)
+		D__FREE(idx, nr * sizeof(*idx));
+	return rc;
+}
+
+static int
+evt_rstar_insert(struct evt_context *tcx, TMMID(struct evt_node) nd_mmid,
+		 struct evt_entry *ent)
+{
+	struct evt_node	*nd = evt_tmmid2ptr(tcx, nd_mmid);
+
+	/* order of entries does not matter, split sorts them anyway */
+	D__ASSERT(!evt_node_is_full(tcx, nd_mmid));
+	evt_node_entry_set(tcx, nd_mmid, nd->tn_nr, ent);
+	nd->tn_nr++;
+	return 0;
+}
+
+/** Pick the entries whose centers are the farthest from the node center */
+static int
+evt_rstar_reinsert(struct evt_context *tcx, TMMID(struct evt_node) nd_mmid,
+		   unsigned int *ats)
+{
+	struct evt_node	*nd = evt_tmmid2ptr(tcx, nd_mmid);
+	struct evt_rect	*mbr = evt_node_mbr_get(tcx, nd_mmid);
+	double		 dist[EVT_ORDER_MAX];
+	double		 center;
+	int		 nr;
+	int		 i;
+	int		 j;
+
+	nr = max(nd->tn_nr * EVT_RSTAR_REINSERT / 100, 1);
+	center = ((double)mbr->rc_off_lo + mbr->rc_off_hi) / 2;
+	for (i = 0; i < nd->tn_nr; i++) {
+		struct evt_rect *rect = evt_node_rect_at(tcx, nd_mmid, i);
+
+		dist[i] = ((double)rect->rc_off_lo + rect->rc_off_hi) / 2 -
+			  center;
+		if (dist[i] < 0)
+			dist[i] = -dist[i];
+	}
+
+	/* mark the picked entries with a negative distance */
+	for (j = 0; j < nr; j++) {
+		int	far = -1;
+
+		for (i = 0; i < nd->tn_nr; i++) {
+			if (dist[i] >= 0 && (far < 0 || dist[i] > dist[far]))
+				far = i;
+		}
+		dist[far] = -1;
+	}
+
+	for (i = j = 0; i < nd->tn_nr; i++) {
+		if (dist[i] < 0)
+			ats[j++] = i;
+	}
+	D__ASSERT(j == nr);
+	return nr;
+}
+
+static struct evt_policy_ops evt_rstar_pol_ops = {
+	.po_insert		= evt_rstar_insert,
+	.po_split		= evt_rstar_split,
+	/* least enlargement of offsets, then of epochs, same as SSOF */
+	.po_rect_weight		= evt_ssof_rect_weight,
+	.po_reinsert		= evt_rstar_reinsert,
+};
+
+/**
+ * Sorted by Start EPoCh (SEPC)
+ *
+ * Extents are sorted by start epoch and a new extent goes to the subtree
+ * whose epochs are least extended by it. If writes come in time order, each
+ * subtree covers a range of epochs, and the newest subtree takes all new
+ * extents.
+ */
+
+static int
+evt_sepc_cmp_rect(struct evt_context *tcx, struct evt_rect *rt1,
+		  struct evt_rect *rt2)
+{
+	if (rt1->rc_epc_lo != rt2->rc_epc_lo)
+		return rt1->rc_epc_lo < rt2->rc_epc_lo ? -1 : 1;
+
+	if (rt1->rc_off_lo != rt2->rc_off_lo)
+		return rt1->rc_off_lo < rt2->rc_off_lo ? -1 : 1;
+
+	if (rt1->rc_off_hi != rt2->rc_off_hi)
+		return rt1->rc_off_hi < rt2->rc_off_hi ? -1 : 1;
+
+	return 0;
+}
+
+static int
+evt_sepc_insert(struct evt_context *tcx, TMMID(struct evt_node) nd_mmid,
+		struct evt_entry *ent)
+{
+	return evt_sorted_insert(tcx, nd_mmid, ent, evt_sepc_cmp_rect);
+}
+
+static int
+evt_sepc_rect_weight(struct evt_context *tcx, struct evt_rect *rect,
+		     struct evt_weight *weight)
+{
+	memset(weight, 0, sizeof(*weight));
+	weight->wt_major = -rect->rc_epc_lo;
+	weight->wt_minor = rect->rc_off_hi - rect->rc_off_lo;
+	return 0;
+}
+
+static struct evt_policy_ops evt_sepc_pol_ops = {
+	.po_insert		= evt_sepc_insert,
+	/* the new node takes the newer half, same as SSOF */
+	.po_split		= evt_ssof_split,
+	.po_rect_weight		= evt_sepc_rect_weight,
+};
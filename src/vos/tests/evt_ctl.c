@@ -50,6 +50,16 @@ static struct umem_attr	ts_uma = {
 #define ORDER_DEF		16
 
 static int			ts_order = ORDER_DEF;
+static uint64_t			ts_feats = EVT_FEAT_DEFAULT;
+
+static struct {
+	const char	*name;
+	uint64_t	 feats;
+} ts_policies[] = {
+	{ "ssof",	EVT_FEAT_SORT_SOFF	},
+	{ "rstar",	EVT_FEAT_RSTAR		},
+	{ "sepc",	EVT_FEAT_SORT_EPC	},
+};
 
 static TMMID(struct evt_root)	ts_root_mmid;
 static struct evt_root		ts_root;
@@ -93,6 +103,28 @@ ts_open_create(bool create, char *args)
 			return -1;
 		}
 
+		ts_feats = EVT_FEAT_DEFAULT;
+		args = strchr(args, EVT_SEP);
+		if (args != NULL) { /* tree policy */
+			int	i;
+
+			if (args[1] != 'p' || args[2] != EVT_SEP_VAL) {
+				D__PRINT("incorrect format for policy: %s\n",
+					args + 1);
+				return -1;
+			}
+
+			for (i = 0; i < ARRAY_SIZE(ts_policies); i++) {
+				if (strcmp(&args[3], ts_policies[i].name) == 0)
+					break;
+			}
+			if (i == ARRAY_SIZE(ts_policies)) {
+				D__PRINT("Unknown policy %s\n", &args[3]);
+				return -1;
+			}
+			ts_feats = ts_policies[i].feats;
+		}
+
 	} else if (!create) {
 		inplace = (ts_root.tr_feats != 0);
 		if (TMMID_IS_NULL(ts_root_mmid) && !inplace) {
@@ -105,10 +137,10 @@ ts_open_create(bool create, char *args)
 		D__PRINT("Create evtree with order %d%s\n",
 			ts_order, inplace ? " inplace" : "");
 		if (inplace) {
-			rc = evt_create_inplace(EVT_FEAT_DEFAULT, ts_order,
+			rc = evt_create_inplace(ts_feats, ts_order,
 						&ts_uma, &ts_root, &ts_toh);
 		} else {
-			rc = evt_create(EVT_FEAT_DEFAULT, ts_order, &ts_uma,
+			rc = evt_create(ts_feats, ts_order, &ts_uma,
 					&ts_root_mmid, &ts_toh);
 		}
 	} else {
@@ -226,7 +258,8 @@ ts_add_rect(char *args)
 	sgl.sg_nr.num = 1;
 	sgl.sg_iovs = &iov;
 
-	rc = evt_insert_sgl(ts_toh, ts_uuid, 0, &rect, val ? 1 : 0, &sgl);
+	rc = evt_insert_sgl(ts_toh, ts_uuid, 0, &rect, val ? 1 : 0, &sgl,
+			    NULL);
 	if (rc != 0)
 		D__FATAL("Add rect failed %d\n", rc);
 
@@ -238,7 +271,7 @@ ts_find_rect(char *args)
 {
 	struct evt_entry	*ent;
 	struct evt_rect		 rect;
-	struct evt_entry_list	 enlist;
+	struct evt_entry_array	 enarr;
 	int			 rc;
 
 	if (args == NULL)
@@ -250,21 +283,94 @@ ts_find_rect(char *args)
 
 	D__PRINT("Search rectangle "DF_RECT"\n", DP_RECT(&rect));
 
-	evt_ent_list_init(&enlist);
-	rc = evt_find(ts_toh, &rect, &enlist);
+	evt_ent_array_init(&enarr);
+	rc = evt_find(ts_toh, &rect, &enarr);
 	if (rc != 0)
 		D__FATAL("Add rect failed %d\n", rc);
 
-	evt_ent_list_for_each(ent, &enlist) {
-		D__PRINT("Find rect "DF_RECT", val=%s\n",
+	evt_ent_array_for_each(ent, &enarr) {
+		D__PRINT("Find rect "DF_RECT", val=%.*s\n",
 			DP_RECT(&ent->en_rect),
+			ent->en_addr ? (int)evt_rect_width(&ent->en_rect) : 6,
 			ent->en_addr ? (char *)ent->en_addr : "<NULL>");
 	}
 
-	evt_ent_list_fini(&enlist);
+	evt_ent_array_fini(&enarr);
 	return rc;
 }
 
+/**
+ * Delete extents in the range, then check no extent in the range is left.
+ * The epoch range is "@lo-hi", or only one epoch "@epoch". Only overwritten
+ * extents are deleted if the range is prefixed by "o:".
+ */
+static int
+ts_delete_rect(char *args)
+{
+	struct evt_rect	 rect;
+	enum evt_del_opc opc = EVT_DEL_WRITTEN;
+	daos_handle_t	 ih;
+	int		 nr;
+	int		 rc;
+
+	if (args == NULL)
+		return -1;
+
+	if (strncmp(args, "o:", 2) == 0) {
+		opc = EVT_DEL_OVERWRITTEN;
+		args += 2;
+	}
+
+	rc = ts_parse_rect(args, &rect, NULL);
+	if (rc != 0)
+		return -1;
+
+	D__PRINT("Delete %s range "DF_RECT"\n",
+		 opc == EVT_DEL_WRITTEN ? "written" : "overwritten",
+		 DP_RECT(&rect));
+	rc = evt_delete_range(ts_toh, opc, &rect, NULL);
+	if (rc != 0) {
+		D__PRINT("Delete range failed %d\n", rc);
+		return -1;
+	}
+
+	rc = evt_iter_prepare(ts_toh, 0, &ih);
+	if (rc != 0) {
+		D__PRINT("Failed to prepare iterator: %d\n", rc);
+		return -1;
+	}
+
+	rc = evt_iter_probe(ih, EVT_ITER_FIRST, NULL, NULL);
+	for (nr = 0; rc == 0; nr++) {
+		struct evt_entry ent;
+		struct evt_rect	*r = &ent.en_rect;
+
+		rc = evt_iter_fetch(ih, &ent, NULL);
+		if (rc != 0)
+			break;
+
+		if (r->rc_off_lo >= rect.rc_off_lo &&
+		    r->rc_off_hi <= rect.rc_off_hi &&
+		    r->rc_epc_lo >= rect.rc_epc_lo &&
+		    r->rc_epc_lo <= rect.rc_epc_hi &&
+		    (opc == EVT_DEL_WRITTEN ||
+		     r->rc_epc_hi < rect.rc_epc_hi)) {
+			D__PRINT("Extent "DF_RECT" is not deleted\n",
+				 DP_RECT(r));
+			D__GOTO(out, rc = -DER_INVAL);
+		}
+		rc = evt_iter_next(ih);
+	}
+
+	if (rc == -DER_NONEXIST) {
+		D__PRINT("%d extents left\n", nr);
+		rc = 0;
+	}
+ out:
+	evt_iter_finish(ih);
+	return rc == 0 ? 0 : -1;
+}
+
 static int
 ts_list_rect(void)
 {
@@ -400,7 +506,7 @@ ts_many_add(char *args)
 		sgl.sg_nr.num = 1;
 		sgl.sg_iovs = &iov;
 
-		rc = evt_insert_sgl(ts_toh, ts_uuid, 0, &rect, 1, &sgl);
+		rc = evt_insert_sgl(ts_toh, ts_uuid, 0, &rect, 1, &sgl, NULL);
 		if (rc != 0) {
 			D__FATAL("Add rect %d failed %d\n", i, rc);
 			break;
@@ -412,6 +518,146 @@ ts_many_add(char *args)
 	return rc;
 }
 
+#define TS_BENCH_EXT		16
+/* one of TS_BENCH_OVERWRITE writes overwrites a random old extent */
+#define TS_BENCH_OVERWRITE	10
+#define TS_BENCH_QUERY_EXT	8
+
+/**
+ * Log-like workload on a private tree of policy \a feats: extents are
+ * appended in time order, a few of them overwrite old extents, then random
+ * ranges are searched at the latest epoch.
+ */
+static int
+ts_bench_policy(const char *name, uint64_t feats, int nr, int query_nr)
+{
+	TMMID(struct evt_root)	 root_mmid;
+	struct evt_entry_array	 enarr;
+	struct evt_stats	 stats;
+	struct evt_stats	 stats_ins;
+	struct evt_rect		 rect;
+	daos_sg_list_t		 sgl;
+	daos_iov_t		 iov;
+	daos_handle_t		 toh;
+	char			 buf[TS_BENCH_EXT * 4];
+	double			 ins_time;
+	double			 now;
+	int			 i;
+	int			 rc;
+
+	rc = evt_create(feats, ts_order, &ts_uma, &root_mmid, &toh);
+	if (rc != 0) {
+		D__PRINT("Failed to create %s tree: %d\n", name, rc);
+		return rc;
+	}
+
+	memset(buf, 'x', sizeof(buf));
+	sgl.sg_nr.num = 1;
+	sgl.sg_iovs = &iov;
+
+	now = dts_time_now();
+	for (i = 0; i < nr; i++) {
+		if (i > 0 && rand() % TS_BENCH_OVERWRITE == 0) {
+			rect.rc_off_lo = (rand() % i) * TS_BENCH_EXT +
+					 rand() % TS_BENCH_EXT;
+			rect.rc_off_hi = rect.rc_off_lo +
+					 rand() % sizeof(buf);
+		} else {
+			rect.rc_off_lo = i * TS_BENCH_EXT;
+			rect.rc_off_hi = rect.rc_off_lo + TS_BENCH_EXT - 1;
+		}
+		rect.rc_epc_lo = i + 1;
+		rect.rc_epc_hi = DAOS_EPOCH_MAX;
+
+		daos_iov_set(&iov, buf, evt_rect_width(&rect));
+		rc = evt_insert_sgl(toh, ts_uuid, 0, &rect, 1, &sgl, NULL);
+		if (rc != 0) {
+			D__PRINT("Insert "DF_RECT" failed: %d\n",
+				 DP_RECT(&rect), rc);
+			D__GOTO(out, rc);
+		}
+	}
+	ins_time = dts_time_now() - now;
+	evt_stats_get(toh, &stats_ins);
+
+	evt_ent_array_init(&enarr);
+	now = dts_time_now();
+	for (i = 0; i < query_nr; i++) {
+		rect.rc_off_lo = (rand() % nr) * TS_BENCH_EXT;
+		rect.rc_off_hi = rect.rc_off_lo +
+				 TS_BENCH_QUERY_EXT * TS_BENCH_EXT - 1;
+		rect.rc_epc_lo = rect.rc_epc_hi = nr + 1;
+
+		rc = evt_find(toh, &rect, &enarr);
+		if (rc != 0) {
+			D__PRINT("Find "DF_RECT" failed: %d\n",
+				 DP_RECT(&rect), rc);
+			break;
+		}
+	}
+	now = dts_time_now() - now;
+	evt_ent_array_fini(&enarr);
+	if (rc != 0)
+		D__GOTO(out, rc);
+
+	evt_stats_get(toh, &stats);
+	D__PRINT("%-6s insert %6.2f us/op, %6lu splits, %7lu reinserts, "
+		 "find %6.2f us/op, %6.1f nodes/query\n", name,
+		 ins_time * 1000000 / nr, stats.es_splits,
+		 stats.es_reinserts, now * 1000000 / query_nr,
+		 (double)(stats.es_node_visits - stats_ins.es_node_visits) /
+		 query_nr);
+ out:
+	evt_destroy(toh);
+	return rc;
+}
+
+static int
+ts_bench(char *args)
+{
+	char	*tmp;
+	int	 nr;
+	int	 query_nr;
+	int	 i;
+	int	 rc;
+
+	/* argument format: "n:NUM,q:NUM"
+	 * n: number of extents
+	 * q: number of queries
+	 */
+	if (args[0] != 'n' || args[1] != EVT_SEP_VAL) {
+		D__PRINT("Invalid parameter %s\n", args);
+		return -1;
+	}
+	nr = strtol(&args[2], &tmp, 0);
+	if (nr <= 0 || *tmp != EVT_SEP) {
+		D__PRINT("Invalid parameter %s\n", args);
+		return -1;
+	}
+	args = tmp + 1;
+
+	if (args[0] != 'q' || args[1] != EVT_SEP_VAL) {
+		D__PRINT("Invalid parameter %s\n", args);
+		return -1;
+	}
+	query_nr = strtol(&args[2], &tmp, 0);
+	if (query_nr <= 0) {
+		D__PRINT("Invalid query number %d\n", query_nr);
+		return -1;
+	}
+
+	D__PRINT("Policy benchmark: order %d, %d extents, %d queries\n",
+		 ts_order, nr, query_nr);
+	for (i = 0; i < ARRAY_SIZE(ts_policies); i++) {
+		srand(nr);
+		rc = ts_bench_policy(ts_policies[i].name, ts_policies[i].feats,
+				     nr, query_nr);
+		if (rc != 0)
+			return rc;
+	}
+	return 0;
+}
+
 static int
 ts_tree_debug(char *args)
 {
@@ -433,6 +679,7 @@ static struct option ts_ops[] = {
 	{ "delete",	required_argument,	NULL,	'd'	},
 	{ "list",	no_argument,		NULL,	'l'	},
 	{ "debug",	required_argument,	NULL,	'b'	},
+	{ "bench",	required_argument,	NULL,	'B'	},
 	{ NULL,		0,			NULL,	0	},
 };
 
@@ -463,12 +710,18 @@ ts_cmd_run(char opc, char *args)
 	case 'f':
 		rc = ts_find_rect(args);
 		break;
+	case 'd':
+		rc = ts_delete_rect(args);
+		break;
 	case 'l':
 		rc = ts_list_rect();
 		break;
 	case 'b':
 		rc = ts_tree_debug(args);
 		break;
+	case 'B':
+		rc = ts_bench(args);
+		break;
 	default:
 		D__PRINT("Unsupported command %c\n", opc);
 		rc = 0;
@@ -497,7 +750,7 @@ main(int argc, char **argv)
 	}
 
 	optind = 0;
-	while ((rc = getopt_long(argc, argv, "C:a:m:f:d:b:Docl",
+	while ((rc = getopt_long(argc, argv, "C:a:m:f:d:b:B:Docl",
 				 ts_ops, NULL)) != -1) {
 		rc = ts_cmd_run(rc, optarg);
 		if (rc != 0)
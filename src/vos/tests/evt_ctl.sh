@@ -3,7 +3,10 @@
 DAOS_DIR=${DAOS_DIR:-$(cd $(dirname $0)/../../..; echo $PWD)}
 EVT_CTL=.$DAOS_DIR/build/src/vos/tests/evt_ctl
 
-$EVT_CTL -C o:4				\
+# tree policy: ssof, rstar or sepc
+POLICY=${POLICY:-"ssof"}
+
+$EVT_CTL -C o:4,p:$POLICY		\
 	-a "20-24@2:black"		\
 	-a "90-95@4:coffee"		\
 	-a "50-56@2:scarlet"		\
@@ -14,10 +17,42 @@ $EVT_CTL -C o:4				\
 	-a "10-15@2:spider"		\
 	-a "35-40@4:yellow"		\
 	-a "0-3@1:bulk"			\
+	-a "22-27@5:abcdef"		\
+	-a "93-97@1:tiger"		\
 	-f "20-30@3"			\
 	-f "28-52@3"			\
 	-f "20-30@0"			\
 	-f "0-100@1"			\
 	-f "0-100@4"			\
+	-f "18-30@5"			\
+	-f "90-99@4"			\
 	-b "-1"				\
+	-d "20-30@3-5"			\
+	-f "20-30@5"			\
+	-d "0-60@1-2"			\
+	-l				\
+	-d "0-100@0-10"			\
+	-D
+
+$EVT_CTL -C o:4,p:$POLICY		\
+	-a "0-4@1:apple"		\
+	-a "0-4@2:peach"		\
+	-a "0-4@3:lemon"		\
+	-a "10-14@1:grape"		\
+	-a "10-14@4:mango"		\
+	-a "20-24@2:berry"		\
+	-a "30-34@1:melon"		\
+	-a "30-34@2:olive"		\
+	-d "o:0-40@1-3"			\
+	-f "0-40@3"			\
+	-l				\
 	-D
+
+$EVT_CTL -C o:8,p:$POLICY		\
+	-m "e:4,n:4000"			\
+	-d "1000-9000@2"		\
+	-d "0-4000@1-3"			\
+	-d "0-16000@0-4"		\
+	-D
+
+$EVT_CTL -B "n:20000,q:2000"
@@ -30,6 +30,7 @@
 #define DDSUBSYS	DDFAC(tests)
 
 #include <vts_io.h>
+#include <daos_api.h>
 
 /* key generator */
 static unsigned int		vts_key_gen;
@@ -797,6 +798,63 @@ io_iter_test_with_anchor(void **state)
 	assert_int_equal(nr, vts_cntr.cn_dkeys);
 }
 
+#define IOT_BATCH_NR	7
+
+/** count dkeys by batches, restart once from an anchor of a batch */
+static void
+io_iter_test_batch(void **state)
+{
+	struct io_test_args	*arg = *state;
+	vos_iter_param_t	 param;
+	vos_iter_entry_t	 ents[IOT_BATCH_NR];
+	daos_hash_out_t		 anchors[IOT_BATCH_NR];
+	daos_handle_t		 ih;
+	unsigned int		 nr;
+	bool			 probed = false;
+	int			 total = 0;
+	int			 rc;
+
+	memset(&param, 0, sizeof(param));
+	param.ip_hdl		= arg->ctx.tc_co_hdl;
+	param.ip_oid		= arg->oid;
+	param.ip_epr.epr_lo	= vts_epoch_gen + 10;
+	param.ip_epr.epr_hi	= DAOS_EPOCH_MAX;
+	param.ip_epc_expr	= VOS_IT_EPC_GE;
+
+	rc = vos_iter_prepare(VOS_ITER_DKEY, &param, &ih);
+	assert_int_equal(rc, 0);
+
+	rc = vos_iter_probe(ih, NULL);
+	assert_int_equal(rc, 0);
+
+	do {
+		nr = IOT_BATCH_NR;
+		rc = vos_iter_fetch_batch(ih, ents, anchors, &nr);
+		assert_true(rc == 0 || rc == -DER_NONEXIST);
+		assert_true(nr <= IOT_BATCH_NR);
+
+		if (!probed && rc == 0 && nr > 2) {
+			/* drop the tail of this batch and probe its anchor */
+			probed = true;
+			total += 2;
+			rc = vos_iter_probe(ih, &anchors[2]);
+			assert_int_equal(rc, 0);
+			continue;
+		}
+		total += nr;
+	} while (rc == 0);
+
+	nr = IOT_BATCH_NR;
+	rc = vos_iter_fetch_batch(ih, ents, anchors, &nr);
+	assert_int_equal(rc, -DER_NONEXIST);
+	assert_int_equal(nr, 0);
+	vos_iter_finish(ih);
+
+	print_message("Enumerated by batch: %d, total_dkeys: %lu.\n",
+		      total, vts_cntr.cn_dkeys);
+	assert_int_equal(total, vts_cntr.cn_dkeys);
+}
+
 #define IOT_FA_DKEYS	100
 
 static void
@@ -830,6 +888,217 @@ io_iter_test_dkey_cond(void **state)
 	assert_int_equal(nr, vts_cntr.cn_fa_dkeys);
 }
 
+#define IOT_ORDERED_DKEYS	64
+
+/** iterate ordered dkeys in [lo, hi], returns number of enumerated keys */
+static int
+io_iter_ordered_dkey_check(struct io_test_args *arg, daos_unit_oid_t oid,
+			   uint64_t lo, uint64_t hi, bool reverse)
+{
+	vos_iter_param_t	param;
+	vos_iter_entry_t	ent;
+	daos_handle_t		ih;
+	uint64_t		prev = 0;
+	uint64_t		key;
+	int			nr = 0;
+	int			rc;
+
+	memset(&param, 0, sizeof(param));
+	param.ip_hdl		= arg->ctx.tc_co_hdl;
+	param.ip_oid		= oid;
+	param.ip_epr.epr_lo	= param.ip_epr.epr_hi = DAOS_EPOCH_MAX;
+	daos_iov_set(&param.ip_key_lo, &lo, sizeof(lo));
+	daos_iov_set(&param.ip_key_hi, &hi, sizeof(hi));
+	if (reverse)
+		param.ip_flags = VOS_IT_KEY_REVERSE;
+
+	rc = vos_iter_prepare(VOS_ITER_DKEY, &param, &ih);
+	assert_int_equal(rc, 0);
+
+	rc = vos_iter_probe(ih, NULL);
+	while (rc == 0) {
+		rc = vos_iter_fetch(ih, &ent, NULL);
+		assert_int_equal(rc, 0);
+		assert_int_equal(ent.ie_key.iov_len, sizeof(key));
+		memcpy(&key, ent.ie_key.iov_buf, sizeof(key));
+
+		assert_true(key >= lo && key <= hi);
+		if (nr != 0)
+			assert_true(reverse ? key < prev : key > prev);
+		prev = key;
+		nr++;
+		rc = vos_iter_next(ih);
+	}
+	assert_int_equal(rc, -DER_NONEXIST);
+	vos_iter_finish(ih);
+	return nr;
+}
+
+static void
+io_iter_ordered_dkey(void **state)
+{
+	struct io_test_args	*arg = *state;
+	daos_unit_oid_t		 oid;
+	daos_key_t		 dkey;
+	daos_key_t		 akey;
+	daos_recx_t		 rex;
+	daos_iov_t		 val_iov;
+	daos_iod_t		 iod;
+	daos_sg_list_t		 sgl;
+	uuid_t			 cookie;
+	char			 akey_buf[UPDATE_AKEY_SIZE];
+	char			 update_buf[UPDATE_BUF_SIZE];
+	uint64_t		 key;
+	int			 i;
+	int			 rc;
+
+	memset(&iod, 0, sizeof(iod));
+	memset(&rex, 0, sizeof(rex));
+	memset(&sgl, 0, sizeof(sgl));
+
+	oid = gen_oid();
+	daos_obj_id_generate_feat(&oid.id_pub, DAOS_OF_DKEY_UINT64,
+				  daos_obj_id2class(oid.id_pub));
+
+	dts_key_gen(&akey_buf[0], UPDATE_AKEY_SIZE, UPDATE_AKEY);
+	daos_iov_set(&akey, &akey_buf[0], strlen(akey_buf));
+	dts_buf_render(update_buf, UPDATE_BUF_SIZE);
+	daos_iov_set(&val_iov, &update_buf[0], UPDATE_BUF_SIZE);
+	rex.rx_nr	= 1;
+	sgl.sg_nr.num	= 1;
+	sgl.sg_iovs	= &val_iov;
+	iod.iod_name	= akey;
+	iod.iod_recxs	= &rex;
+	iod.iod_nr	= 1;
+	iod.iod_size	= UPDATE_BUF_SIZE;
+	iod.iod_type	= DAOS_IOD_ARRAY;
+	uuid_generate(cookie);
+
+	/* insert keys 1, 3, 5 ... in a scrambled order */
+	for (i = 0; i < IOT_ORDERED_DKEYS; i++) {
+		key = ((i * 37) % IOT_ORDERED_DKEYS) * 2 + 1;
+		daos_iov_set(&dkey, &key, sizeof(key));
+		rc = vos_obj_update(arg->ctx.tc_co_hdl, oid, 1, cookie, 0,
+				    &dkey, 1, &iod, &sgl);
+		assert_int_equal(rc, 0);
+	}
+
+	/* a uint64 ordered dkey must be 8 bytes */
+	daos_iov_set(&dkey, &key, sizeof(uint32_t));
+	rc = vos_obj_update(arg->ctx.tc_co_hdl, oid, 1, cookie, 0,
+			    &dkey, 1, &iod, &sgl);
+	assert_int_equal(rc, -DER_INVAL);
+
+	rc = io_iter_ordered_dkey_check(arg, oid, 0, UINT64_MAX, false);
+	assert_int_equal(rc, IOT_ORDERED_DKEYS);
+	rc = io_iter_ordered_dkey_check(arg, oid, 0, UINT64_MAX, true);
+	assert_int_equal(rc, IOT_ORDERED_DKEYS);
+
+	/* [10, 20] covers 11, 13, 15, 17, 19 */
+	rc = io_iter_ordered_dkey_check(arg, oid, 10, 20, false);
+	assert_int_equal(rc, 5);
+	rc = io_iter_ordered_dkey_check(arg, oid, 10, 20, true);
+	assert_int_equal(rc, 5);
+}
+
+static const char *io_prefix_dkeys[] = {
+	"group:1", "user:1:a", "user:10:x", "user:1:b", "user:2:a", "user:",
+	"user:1:",
+};
+
+/** iterate dkeys with \a prefix, returns number of enumerated keys */
+static int
+io_iter_prefix_dkey_check(struct io_test_args *arg, daos_unit_oid_t oid,
+			  char *prefix, bool reverse)
+{
+	vos_iter_param_t	param;
+	vos_iter_entry_t	ent;
+	daos_handle_t		ih;
+	int			nr = 0;
+	int			rc;
+
+	memset(&param, 0, sizeof(param));
+	param.ip_hdl		= arg->ctx.tc_co_hdl;
+	param.ip_oid		= oid;
+	param.ip_epr.epr_lo	= param.ip_epr.epr_hi = DAOS_EPOCH_MAX;
+	daos_iov_set(&param.ip_key_prefix, prefix, strlen(prefix));
+	if (reverse)
+		param.ip_flags = VOS_IT_KEY_REVERSE;
+
+	rc = vos_iter_prepare(VOS_ITER_DKEY, &param, &ih);
+	assert_int_equal(rc, 0);
+
+	rc = vos_iter_probe(ih, NULL);
+	while (rc == 0) {
+		rc = vos_iter_fetch(ih, &ent, NULL);
+		assert_int_equal(rc, 0);
+		assert_true(ent.ie_key.iov_len >= strlen(prefix));
+		assert_memory_equal(ent.ie_key.iov_buf, prefix,
+				    strlen(prefix));
+		nr++;
+		rc = vos_iter_next(ih);
+	}
+	assert_int_equal(rc, -DER_NONEXIST);
+	vos_iter_finish(ih);
+	return nr;
+}
+
+static void
+io_iter_prefix_dkey(void **state)
+{
+	struct io_test_args	*arg = *state;
+	daos_unit_oid_t		 oids[2];
+	daos_key_t		 dkey;
+	daos_iov_t		 val_iov;
+	daos_iod_t		 iod;
+	daos_sg_list_t		 sgl;
+	uuid_t			 cookie;
+	char			 val = 'x';
+	int			 i;
+	int			 j;
+	int			 rc;
+
+	memset(&iod, 0, sizeof(iod));
+	memset(&sgl, 0, sizeof(sgl));
+	daos_iov_set(&iod.iod_name, "akey", strlen("akey"));
+	daos_iov_set(&val_iov, &val, sizeof(val));
+	sgl.sg_nr.num	= 1;
+	sgl.sg_iovs	= &val_iov;
+	iod.iod_nr	= 1;
+	iod.iod_size	= sizeof(val);
+	iod.iod_type	= DAOS_IOD_SINGLE;
+	uuid_generate(cookie);
+
+	/* hashed and lexical ordered dkeys */
+	oids[0] = gen_oid();
+	oids[1] = gen_oid();
+	daos_obj_id_generate_feat(&oids[1].id_pub, DAOS_OF_DKEY_LEXICAL,
+				  daos_obj_id2class(oids[1].id_pub));
+
+	for (i = 0; i < 2; i++) {
+		for (j = 0; j < ARRAY_SIZE(io_prefix_dkeys); j++) {
+			daos_iov_set(&dkey, (void *)io_prefix_dkeys[j],
+				     strlen(io_prefix_dkeys[j]));
+			rc = vos_obj_update(arg->ctx.tc_co_hdl, oids[i], 1,
+					    cookie, 0, &dkey, 1, &iod, &sgl);
+			assert_int_equal(rc, 0);
+		}
+
+		/* user:1:a, user:1:b, user:1: */
+		rc = io_iter_prefix_dkey_check(arg, oids[i], "user:1:", false);
+		assert_int_equal(rc, 3);
+		rc = io_iter_prefix_dkey_check(arg, oids[i], "user:", false);
+		assert_int_equal(rc, 6);
+		rc = io_iter_prefix_dkey_check(arg, oids[i], "none", false);
+		assert_int_equal(rc, 0);
+	}
+
+	rc = io_iter_prefix_dkey_check(arg, oids[1], "user:1:", true);
+	assert_int_equal(rc, 3);
+	rc = io_iter_prefix_dkey_check(arg, oids[1], "user:1", true);
+	assert_int_equal(rc, 4);
+}
+
 #define RANGE_ITER_KEYS 10
 
 static int
@@ -1328,6 +1597,177 @@ io_simple_one_key(void **state)
 	}
 }
 
+#define MULTI_DKEY_NR	4
+
+/** update and fetch multiple dkeys by one call, failure updates nothing */
+static void
+io_multi_dkey(void **state)
+{
+	struct io_test_args	*arg = *state;
+	char			 dkey_bufs[MULTI_DKEY_NR][UPDATE_DKEY_SIZE];
+	char			 akey_buf[UPDATE_AKEY_SIZE];
+	char			 update_bufs[MULTI_DKEY_NR][UPDATE_BUF_SIZE];
+	char			 fetch_bufs[MULTI_DKEY_NR][UPDATE_BUF_SIZE];
+	daos_key_t		 dkeys[MULTI_DKEY_NR];
+	daos_iod_t		 iods[MULTI_DKEY_NR];
+	daos_sg_list_t		 sgls[MULTI_DKEY_NR];
+	daos_iov_t		 iovs[MULTI_DKEY_NR];
+	unsigned int		 iod_nrs[MULTI_DKEY_NR];
+	struct daos_uuid	 cookie;
+	int			 i;
+	int			 rc;
+
+	arg->ta_flags = 0;
+	cookie = gen_rand_cookie();
+	dts_key_gen(&akey_buf[0], UPDATE_AKEY_SIZE, UPDATE_AKEY);
+
+	memset(iods, 0, sizeof(iods));
+	for (i = 0; i < MULTI_DKEY_NR; i++) {
+		dts_key_gen(&dkey_bufs[i][0], UPDATE_DKEY_SIZE, UPDATE_DKEY);
+		daos_iov_set(&dkeys[i], &dkey_bufs[i][0],
+			     strlen(dkey_bufs[i]));
+		dts_buf_render(update_bufs[i], UPDATE_BUF_SIZE);
+		daos_iov_set(&iovs[i], &update_bufs[i][0], UPDATE_BUF_SIZE);
+		sgls[i].sg_nr.num = 1;
+		sgls[i].sg_iovs = &iovs[i];
+		daos_iov_set(&iods[i].iod_name, &akey_buf[0],
+			     strlen(akey_buf));
+		iods[i].iod_type = DAOS_IOD_SINGLE;
+		iods[i].iod_size = UPDATE_BUF_SIZE;
+		iods[i].iod_nr = 1;
+		iod_nrs[i] = 1;
+	}
+
+	/* the last dkey has less data than its iod, nothing is updated */
+	iovs[MULTI_DKEY_NR - 1].iov_len = 1;
+	rc = vos_obj_update_multi(arg->ctx.tc_co_hdl, arg->oid, 1,
+				  cookie.uuid, 0, MULTI_DKEY_NR, dkeys,
+				  iod_nrs, iods, sgls);
+	assert_int_not_equal(rc, 0);
+
+	for (i = 0; i < MULTI_DKEY_NR; i++) {
+		daos_iov_set(&iovs[i], &fetch_bufs[i][0], UPDATE_BUF_SIZE);
+		iods[i].iod_size = DAOS_REC_ANY;
+	}
+	rc = vos_obj_fetch_multi(arg->ctx.tc_co_hdl, arg->oid, 1,
+				 MULTI_DKEY_NR, dkeys, iod_nrs, iods, sgls);
+	assert_int_equal(rc, 0);
+	for (i = 0; i < MULTI_DKEY_NR; i++)
+		assert_int_equal(iods[i].iod_size, 0);
+
+	for (i = 0; i < MULTI_DKEY_NR; i++) {
+		daos_iov_set(&iovs[i], &update_bufs[i][0], UPDATE_BUF_SIZE);
+		iods[i].iod_size = UPDATE_BUF_SIZE;
+	}
+	rc = vos_obj_update_multi(arg->ctx.tc_co_hdl, arg->oid, 1,
+				  cookie.uuid, 0, MULTI_DKEY_NR, dkeys,
+				  iod_nrs, iods, sgls);
+	assert_int_equal(rc, 0);
+
+	for (i = 0; i < MULTI_DKEY_NR; i++) {
+		memset(fetch_bufs[i], 0, UPDATE_BUF_SIZE);
+		daos_iov_set(&iovs[i], &fetch_bufs[i][0], UPDATE_BUF_SIZE);
+		iods[i].iod_size = DAOS_REC_ANY;
+	}
+	rc = vos_obj_fetch_multi(arg->ctx.tc_co_hdl, arg->oid, 1,
+				 MULTI_DKEY_NR, dkeys, iod_nrs, iods, sgls);
+	assert_int_equal(rc, 0);
+	for (i = 0; i < MULTI_DKEY_NR; i++) {
+		assert_int_equal(iods[i].iod_size, UPDATE_BUF_SIZE);
+		assert_memory_equal(update_bufs[i], fetch_bufs[i],
+				    UPDATE_BUF_SIZE);
+	}
+}
+
+#define ZC_GROUP_NR	3
+
+/**
+ * submit a group of ZC updates, a failed update in the middle of the group
+ * is dropped and the others are committed
+ */
+static void
+io_zc_update_group(void **state)
+{
+	struct io_test_args	*arg = *state;
+	struct vos_zc_update	 updates[ZC_GROUP_NR];
+	daos_unit_oid_t		 oid;
+	uint64_t		 keys[ZC_GROUP_NR];
+	char			 akey_buf[UPDATE_AKEY_SIZE];
+	char			 update_bufs[ZC_GROUP_NR][UPDATE_BUF_SIZE];
+	char			 fetch_buf[UPDATE_BUF_SIZE];
+	daos_key_t		 dkeys[ZC_GROUP_NR];
+	daos_iod_t		 iods[ZC_GROUP_NR];
+	daos_sg_list_t		*iod_sgl;
+	daos_sg_list_t		 sgl;
+	daos_iov_t		 iov;
+	uuid_t			 cookie;
+	int			 i;
+	int			 rc;
+
+	oid = gen_oid();
+	daos_obj_id_generate_feat(&oid.id_pub, DAOS_OF_DKEY_UINT64,
+				  daos_obj_id2class(oid.id_pub));
+	dts_key_gen(&akey_buf[0], UPDATE_AKEY_SIZE, UPDATE_AKEY);
+	uuid_generate(cookie);
+
+	memset(iods, 0, sizeof(iods));
+	memset(updates, 0, sizeof(updates));
+	for (i = 0; i < ZC_GROUP_NR; i++) {
+		keys[i] = i + 1;
+		daos_iov_set(&dkeys[i], &keys[i], sizeof(keys[i]));
+		daos_iov_set(&iods[i].iod_name, &akey_buf[0],
+			     strlen(akey_buf));
+		iods[i].iod_type = DAOS_IOD_SINGLE;
+		iods[i].iod_size = UPDATE_BUF_SIZE;
+		iods[i].iod_nr = 1;
+	}
+	/* a uint64 ordered dkey must be 8 bytes, the second update fails */
+	dkeys[1].iov_len = sizeof(uint32_t);
+
+	for (i = 0; i < ZC_GROUP_NR; i++) {
+		rc = vos_obj_zc_update_begin(arg->ctx.tc_co_hdl, oid, 1,
+					     &dkeys[i], 1, &iods[i],
+					     &updates[i].zu_ioh);
+		assert_int_equal(rc, 0);
+
+		rc = vos_obj_zc_sgl_at(updates[i].zu_ioh, 0, &iod_sgl);
+		assert_int_equal(rc, 0);
+		assert_int_equal(iod_sgl->sg_nr.num_out, 1);
+		assert_int_equal(iod_sgl->sg_iovs[0].iov_len, UPDATE_BUF_SIZE);
+
+		dts_buf_render(update_bufs[i], UPDATE_BUF_SIZE);
+		memcpy(iod_sgl->sg_iovs[0].iov_buf, update_bufs[i],
+		       UPDATE_BUF_SIZE);
+
+		uuid_copy(updates[i].zu_cookie, cookie);
+		updates[i].zu_dkey = &dkeys[i];
+		updates[i].zu_iod_nr = 1;
+		updates[i].zu_iods = &iods[i];
+	}
+
+	vos_obj_zc_update_end_group(updates, ZC_GROUP_NR);
+	assert_int_equal(updates[0].zu_rc, 0);
+	assert_int_equal(updates[1].zu_rc, -DER_INVAL);
+	assert_int_equal(updates[2].zu_rc, 0);
+
+	sgl.sg_nr.num = 1;
+	sgl.sg_iovs = &iov;
+	for (i = 0; i < ZC_GROUP_NR; i++) {
+		if (i == 1)
+			continue;
+
+		memset(fetch_buf, 0, UPDATE_BUF_SIZE);
+		daos_iov_set(&iov, &fetch_buf[0], UPDATE_BUF_SIZE);
+		iods[i].iod_size = DAOS_REC_ANY;
+		rc = vos_obj_fetch(arg->ctx.tc_co_hdl, oid, 1, &dkeys[i], 1,
+				   &iods[i], &sgl);
+		assert_int_equal(rc, 0);
+		assert_int_equal(iods[i].iod_size, UPDATE_BUF_SIZE);
+		assert_memory_equal(update_bufs[i], fetch_buf,
+				    UPDATE_BUF_SIZE);
+	}
+}
+
 static void
 io_simple_one_key_cross_container(void **state)
 {
@@ -1570,6 +2010,10 @@ static const struct CMUnitTest io_tests[] = {
 		io_simple_punch, NULL, NULL},
 	{ "VOS205: Simple near-epoch retrieval test",
 		io_simple_near_epoch, NULL, NULL},
+	{ "VOS206: Multi-dkey update/fetch test",
+		io_multi_dkey, NULL, NULL},
+	{ "VOS207: ZC update group with a failed update",
+		io_zc_update_group, NULL, NULL},
 	{ "VOS220: 100K update/fetch/verify test",
 		io_multiple_dkey, NULL, NULL},
 	{ "VOS222: overwrite test",
@@ -1582,8 +2026,14 @@ static const struct CMUnitTest io_tests[] = {
 
 	{ "VOS240.1: KV Iter tests with anchor (for dkey)",
 		io_iter_test_with_anchor, NULL, NULL},
+	{ "VOS240.1.1: KV Iter tests by batch (for dkey)",
+		io_iter_test_batch, NULL, NULL},
 	{ "VOS240.2: d-key enumeration with condition (akey)",
 		io_iter_test_dkey_cond, NULL, NULL},
+	{ "VOS240.2.1: ordered d-key range enumeration",
+		io_iter_ordered_dkey, NULL, NULL},
+	{ "VOS240.2.2: d-key prefix enumeration",
+		io_iter_prefix_dkey, NULL, NULL},
 	{ "VOS240.3: KV range Iteration tests (for dkey)",
 		io_obj_forward_iter_test, NULL, NULL},
 	{ "VOS240.4: KV reverse range Iteration tests (for dkey)",
@@ -1364,6 +1364,252 @@ io_multi_recx_overwrite_test_with_credits(void **state)
 
 
 
+static int
+io_dirty_obj_count(struct io_test_args *arg, daos_epoch_range_t *epr)
+{
+	vos_iter_param_t	param;
+	daos_handle_t		ih;
+	int			nr = 0;
+	int			rc;
+
+	memset(&param, 0, sizeof(param));
+	param.ip_hdl	= arg->ctx.tc_co_hdl;
+	param.ip_epr	= *epr;
+	param.ip_flags	= VOS_IT_OBJ_DIRTY;
+
+	rc = vos_iter_prepare(VOS_ITER_OBJ, &param, &ih);
+	assert_int_equal(rc, 0);
+
+	rc = vos_iter_probe(ih, NULL);
+	while (rc == 0) {
+		vos_iter_entry_t	ent;
+
+		rc = vos_iter_fetch(ih, &ent, NULL);
+		assert_int_equal(rc, 0);
+		assert_true(ent.ie_epr.epr_lo <= epr->epr_hi &&
+			    ent.ie_epr.epr_hi >= epr->epr_lo);
+		nr++;
+		rc = vos_iter_next(ih);
+	}
+	assert_int_equal(rc, -DER_NONEXIST);
+	vos_iter_finish(ih);
+	return nr;
+}
+
+static void
+io_dirty_obj_aggregate_test(void **state)
+{
+	struct io_test_args	*arg = *state;
+	struct daos_uuid	cookie;
+	daos_epoch_range_t	range;
+	daos_epoch_t		epochs[] = {10, 20, 30};
+	daos_unit_oid_t		oids[2];
+	daos_unit_oid_t		oid_null;
+	struct vts_counter	cntrs;
+	bool			finish;
+	int			i;
+	int			rc;
+
+	arg->ta_flags = 0;
+	cookie = gen_rand_cookie();
+	oids[0] = arg->oid;
+	oids[1] = dts_unit_oid_gen(0, 0);
+
+	/* oids[0] is updated in epoch 10 & 20, oids[1] in epoch 30 */
+	for (i = 0; i < 3; i++) {
+		struct io_req	*req = NULL;
+		char		 dkey_buf[UPDATE_DKEY_SIZE];
+		char		 akey_buf[UPDATE_AKEY_SIZE];
+		int		 idx;
+
+		arg->oid = oids[i / 2];
+		set_key_and_index(&dkey_buf[0], &akey_buf[0], &idx);
+		rc = io_update(arg, epochs[i], &cookie, &dkey_buf[0],
+			       &akey_buf[0], &cntrs, &req, idx, UPDATE_VERBOSE);
+		assert_int_equal(rc, 0);
+		daos_list_add(&req->rlist, &arg->req_list);
+	}
+	arg->oid = oids[0];
+
+	range.epr_lo = 0;
+	range.epr_hi = DAOS_EPOCH_MAX;
+	assert_int_equal(io_dirty_obj_count(arg, &range), 2);
+
+	range.epr_hi = 25;
+	assert_int_equal(io_dirty_obj_count(arg, &range), 1);
+
+	/* aggregation of [0, 20] completed, oids[0] should be pruned */
+	range.epr_hi = 20;
+	memset(&oid_null, 0, sizeof(oid_null));
+	rc = vos_epoch_aggregate(arg->ctx.tc_co_hdl, oid_null, &range,
+				 NULL, NULL, &finish);
+	assert_int_equal(rc, 0);
+	assert_true(finish);
+
+	range.epr_hi = DAOS_EPOCH_MAX;
+	assert_int_equal(io_dirty_obj_count(arg, &range), 1);
+
+	range.epr_hi = 20;
+	assert_int_equal(io_dirty_obj_count(arg, &range), 0);
+
+	/* [31, 40] does not cover epoch 30, oids[1] should not be pruned */
+	range.epr_lo = 31;
+	range.epr_hi = 40;
+	rc = vos_epoch_aggregate(arg->ctx.tc_co_hdl, oid_null, &range,
+				 NULL, NULL, &finish);
+	assert_int_equal(rc, 0);
+
+	range.epr_lo = 0;
+	range.epr_hi = DAOS_EPOCH_MAX;
+	assert_int_equal(io_dirty_obj_count(arg, &range), 1);
+}
+
+#define COALESCE_EXTS	32
+#define COALESCE_WIDTH	8
+
+/** update \a nr records at \a idx of \a akey with \a buf */
+static void
+io_coalesce_update(struct io_test_args *arg, daos_epoch_t epoch,
+		   char *akey, uint64_t idx, uint64_t nr, char *buf)
+{
+	daos_iov_t	dkey;
+	daos_iov_t	val_iov;
+	daos_recx_t	rex;
+	daos_iod_t	iod;
+	daos_sg_list_t	sgl;
+	uuid_t		cookie;
+	int		rc;
+
+	memset(&iod, 0, sizeof(iod));
+	daos_iov_set(&dkey, "coalesce", strlen("coalesce"));
+	daos_iov_set(&iod.iod_name, akey, strlen(akey));
+	daos_iov_set(&val_iov, buf, nr);
+	rex.rx_idx	= idx;
+	rex.rx_nr	= nr;
+	iod.iod_recxs	= &rex;
+	iod.iod_nr	= 1;
+	iod.iod_size	= 1;
+	iod.iod_type	= DAOS_IOD_ARRAY;
+	sgl.sg_nr.num	= 1;
+	sgl.sg_iovs	= &val_iov;
+	uuid_generate(cookie);
+
+	rc = vos_obj_update(arg->ctx.tc_co_hdl, arg->oid, epoch, cookie, 0,
+			    &dkey, 1, &iod, &sgl);
+	assert_int_equal(rc, 0);
+}
+
+/** return the number of extents of \a akey */
+static int
+io_coalesce_count(struct io_test_args *arg, char *akey)
+{
+	vos_iter_param_t	param;
+	vos_iter_entry_t	ent;
+	daos_handle_t		ih;
+	int			nr = 0;
+	int			rc;
+
+	memset(&param, 0, sizeof(param));
+	param.ip_hdl		= arg->ctx.tc_co_hdl;
+	param.ip_oid		= arg->oid;
+	param.ip_epr.epr_hi	= DAOS_EPOCH_MAX;
+	daos_iov_set(&param.ip_dkey, "coalesce", strlen("coalesce"));
+	daos_iov_set(&param.ip_akey, akey, strlen(akey));
+
+	rc = vos_iter_prepare(VOS_ITER_RECX, &param, &ih);
+	assert_int_equal(rc, 0);
+
+	rc = vos_iter_probe(ih, NULL);
+	while (rc == 0) {
+		rc = vos_iter_fetch(ih, &ent, NULL);
+		assert_int_equal(rc, 0);
+		nr++;
+		rc = vos_iter_next(ih);
+	}
+	assert_int_equal(rc, -DER_NONEXIST);
+	vos_iter_finish(ih);
+	return nr;
+}
+
+static void
+io_coalesce_test(void **state)
+{
+	struct io_test_args	*arg = *state;
+	daos_epoch_range_t	 range;
+	vos_purge_anchor_t	 anchor;
+	daos_iov_t		 dkey;
+	daos_iov_t		 val_iov;
+	daos_recx_t		 rex;
+	daos_iod_t		 iod;
+	daos_sg_list_t		 sgl;
+	char			 expected[COALESCE_EXTS * COALESCE_WIDTH];
+	char			 buf[COALESCE_EXTS * COALESCE_WIDTH];
+	bool			 finish;
+	int			 i;
+	int			 rc;
+
+	/* a file written in small chunks, and then partly overwritten */
+	for (i = 0; i < sizeof(expected); i++)
+		expected[i] = 'a' + i % 26;
+	for (i = 0; i < COALESCE_EXTS; i++)
+		io_coalesce_update(arg, 10 + i, "small", i * COALESCE_WIDTH,
+				   COALESCE_WIDTH,
+				   &expected[i * COALESCE_WIDTH]);
+
+	memset(&expected[4], 'z', COALESCE_WIDTH);
+	io_coalesce_update(arg, 50, "small", 4, COALESCE_WIDTH,
+			   &expected[4]);
+	assert_int_equal(io_coalesce_count(arg, "small"), COALESCE_EXTS + 1);
+
+	/* newer than the aggregated epochs, should be skipped */
+	io_coalesce_update(arg, 100, "newer", 0, COALESCE_WIDTH, buf);
+	io_coalesce_update(arg, 101, "newer", COALESCE_WIDTH, COALESCE_WIDTH,
+			   buf);
+
+	/* a hole splits the extents into two runs, only one of them merges */
+	io_coalesce_update(arg, 10, "hole", 0, COALESCE_WIDTH, buf);
+	io_coalesce_update(arg, 11, "hole", COALESCE_WIDTH, COALESCE_WIDTH,
+			   buf);
+	io_coalesce_update(arg, 12, "hole", 4 * COALESCE_WIDTH,
+			   COALESCE_WIDTH, buf);
+
+	/* small credits to cover preemption */
+	range.epr_lo = 0;
+	range.epr_hi = 60;
+	memset(&anchor, 0, sizeof(anchor));
+	for (finish = false, i = 0; !finish; i++) {
+		unsigned int	credits = 4;
+
+		rc = vos_epoch_coalesce(arg->ctx.tc_co_hdl, arg->oid, &range,
+					&credits, &anchor, &finish);
+		assert_int_equal(rc, 0);
+		assert_true(i < 100);
+	}
+
+	assert_int_equal(io_coalesce_count(arg, "small"), 1);
+	assert_int_equal(io_coalesce_count(arg, "newer"), 2);
+	assert_int_equal(io_coalesce_count(arg, "hole"), 2);
+
+	memset(&iod, 0, sizeof(iod));
+	memset(buf, 0, sizeof(buf));
+	daos_iov_set(&dkey, "coalesce", strlen("coalesce"));
+	daos_iov_set(&iod.iod_name, "small", strlen("small"));
+	daos_iov_set(&val_iov, buf, sizeof(buf));
+	rex.rx_idx	= 0;
+	rex.rx_nr	= sizeof(buf);
+	iod.iod_recxs	= &rex;
+	iod.iod_nr	= 1;
+	iod.iod_size	= 1;
+	iod.iod_type	= DAOS_IOD_ARRAY;
+	sgl.sg_nr.num	= 1;
+	sgl.sg_iovs	= &val_iov;
+
+	rc = vos_obj_fetch(arg->ctx.tc_co_hdl, arg->oid, range.epr_hi, &dkey,
+			   1, &iod, &sgl);
+	assert_int_equal(rc, 0);
+	assert_memory_equal(buf, expected, sizeof(buf));
+}
+
 static const struct CMUnitTest discard_tests[] = {
 	{ "VOS301: VOS Simple discard test",
 		io_simple_one_key_discard, io_simple_discard_setup,
@@ -1430,6 +1676,12 @@ static const struct CMUnitTest aggregate_tests[] = {
 	{ "VOS403.3: VOS recx update aggregate test",
 		io_multi_recx_aggregate_test, io_multi_recx_discard_setup,
 		io_multikey_discard_teardown},
+	{ "VOS403.4: VOS dirty object aggregate test",
+		io_dirty_obj_aggregate_test, io_multikey_discard_setup,
+		io_multikey_discard_teardown},
+	{ "VOS404: VOS coalesce extents after aggregation",
+		io_coalesce_test, io_multikey_discard_setup,
+		io_multikey_discard_teardown},
 
 };
 
@@ -48,60 +48,26 @@ vos_get_obj_cache(void)
 #endif
 }
 
-int
-vos_csum_enabled(void)
+struct evt_entry_array *
+vos_ent_array_get(void)
 {
 #ifdef VOS_STANDALONE
-	return vsa_imems_inst->vis_enable_checksum;
+	return &vsa_imems_inst->vis_ent_array;
 #else
-	return vos_tls_get()->vtl_imems_inst.vis_enable_checksum;
+	return &vos_tls_get()->vtl_imems_inst.vis_ent_array;
 #endif
 }
 
 int
-vos_csum_compute(daos_sg_list_t *sgl, daos_csum_buf_t *csum)
+vos_csum_type(void)
 {
-	int	i;
-	int	rc;
 #ifdef VOS_STANDALONE
-	mchecksum_object_t *checksum = &vsa_imems_inst->vis_checksum;
+	return vsa_imems_inst->vis_csum_type;
 #else
-	mchecksum_object_t *checksum =
-		&vos_tls_get()->vtl_imems_inst.vis_checksum;
+	return vos_tls_get()->vtl_imems_inst.vis_csum_type;
 #endif
-
-	if (!sgl->sg_iovs)
-		return 0;
-
-	rc = mchecksum_reset(*checksum);
-	if (rc <= 0) {
-		D__ERROR("Error in resetting checksum: %d\n", rc);
-		D__GOTO(failed, rc = -DER_IO);
-	}
-
-	for (i = 0; i < sgl->sg_nr.num_out; i++) {
-		if (!sgl->sg_iovs[i].iov_buf ||
-		    !sgl->sg_iovs[i].iov_len)
-			continue;
-
-		/* accumulates a partial checksum of the input data */
-		rc = mchecksum_update(*checksum, sgl->sg_iovs[i].iov_buf,
-				      sgl->sg_iovs[i].iov_len);
-		if (rc <= 0) {
-			D__ERROR("Error in updating checksum: %d\n", rc);
-			D__GOTO(failed, rc = -DER_IO);
-		}
-	}
-	rc = 0;
-	csum->cs_len = mchecksum_get_size(*checksum);
-	D__ASSERT(csum->cs_buf_len >= csum->cs_len);
-
-	/* get checksum result */
-	mchecksum_get(*checksum, csum->cs_csum, csum->cs_buf_len,
-		      MCHECKSUM_FINALIZE /* Unused for crc64 */);
-failed:
-	return rc;
 }
+
 /**
  * VOS in-memory structure creation.
  * Handle-hash:
@@ -129,6 +95,8 @@ vos_imem_strts_destroy(struct vos_imem_strts *imem_inst)
 
 	if (imem_inst->vis_cont_hhash)
 		daos_uhash_destroy(imem_inst->vis_cont_hhash);
+
+	evt_ent_array_fini(&imem_inst->vis_ent_array);
 }
 
 static inline int
@@ -137,6 +105,7 @@ vos_imem_strts_create(struct vos_imem_strts *imem_inst)
 	char *env;
 	int   rc;
 
+	evt_ent_array_init(&imem_inst->vis_ent_array);
 	rc = vos_obj_cache_create(LRU_CACHE_BITS,
 				  &imem_inst->vis_ocache);
 	if (rc) {
@@ -144,6 +113,12 @@ vos_imem_strts_create(struct vos_imem_strts *imem_inst)
 		return rc;
 	}
 
+	env = getenv("VOS_OBJ_CACHE_SIZE");
+	if (env != NULL) {
+		D__DEBUG(DB_TRACE, "Object cache size %s\n", env);
+		daos_lru_cache_resize(imem_inst->vis_ocache, atoi(env));
+	}
+
 	rc = daos_uhash_create(0 /* no locking */, VOS_POOL_HHASH_BITS,
 			       &imem_inst->vis_pool_hhash);
 	if (rc) {
@@ -159,18 +134,9 @@ vos_imem_strts_create(struct vos_imem_strts *imem_inst)
 	}
 
 	env = getenv("VOS_CHECKSUM");
-	if (daos_csum_supported(env)) {
-		rc = mchecksum_init(env, &imem_inst->vis_checksum);
-		if (!rc) {
-			D__ERROR("Error in initializing checksum\n");
-			goto failed;
-		}
-
+	imem_inst->vis_csum_type = daos_csum_name2type(env);
+	if (imem_inst->vis_csum_type != DAOS_CSUM_NONE)
 		D__DEBUG(DB_IO, "Enable VOS checksum=%s\n", env);
-		imem_inst->vis_enable_checksum = 1;
-	} else {
-		imem_inst->vis_enable_checksum = 0;
-	}
 
 	return 0;
 failed:
@@ -250,6 +216,12 @@ vos_mod_init(void)
 		return rc;
 	}
 
+	rc = vos_dirty_tab_register();
+	if (rc) {
+		D__ERROR("VOS dirty object btree initialization error\n");
+		return rc;
+	}
+
 	rc = vos_obj_tree_register();
 	if (rc)
 		D__ERROR("Failed to register vos trees\n");
@@ -103,6 +103,14 @@ cont_df_rec_alloc(struct btr_instance *tins, daos_iov_t *key_iov,
 		D__ERROR("VOS object index create failure\n");
 		D__GOTO(exit, rc);
 	}
+
+	if (vos_pool_has_dirty_tab(args->ca_pool)) {
+		rc = vos_dirty_tab_create(args->ca_pool, &cont_df->cd_dtab_df);
+		if (rc) {
+			D__ERROR("VOS dirty object table create failure\n");
+			D__GOTO(exit, rc);
+		}
+	}
 	rec->rec_mmid = umem_id_t2u(cont_mmid);
 	D_EXIT;
 exit:
@@ -165,6 +173,8 @@ cont_free(struct daos_ulink *ulink)
 
 	cont = container_of(ulink, struct vos_container, vc_uhlink);
 	dbtree_close(cont->vc_btr_hdl);
+	if (!daos_handle_is_inval(cont->vc_dtab_hdl))
+		dbtree_close(cont->vc_dtab_hdl);
 
 	D__FREE_PTR(cont);
 }
@@ -335,6 +345,18 @@ vos_cont_open(daos_handle_t poh, uuid_t co_uuid, daos_handle_t *coh)
 		D__GOTO(exit, rc);
 	}
 
+	/* vc_dtab_hdl stays invalid for pools without dirty object table */
+	cont->vc_dtab_hdl = DAOS_HDL_INVAL;
+	if (vos_pool_has_dirty_tab(vpool)) {
+		rc = dbtree_open_inplace(&args.ca_cont_df->cd_dtab_df.dtb_btr,
+					 &cont->vc_pool->vp_uma,
+					 &cont->vc_dtab_hdl);
+		if (rc) {
+			D__ERROR("Dirty object table open failed\n");
+			D__GOTO(exit, rc);
+		}
+	}
+
 	rc = cont_insert(cont, &ukey, coh);
 	if (rc) {
 		D__ERROR("Error inserting vos container handle to uuid hash\n");
@@ -434,6 +456,16 @@ vos_cont_destroy(daos_handle_t poh, uuid_t co_uuid)
 			pmemobj_tx_abort(EFAULT);
 		}
 
+		if (vos_pool_has_dirty_tab(vpool)) {
+			rc = vos_dirty_tab_destroy(vpool,
+						&args.ca_cont_df->cd_dtab_df);
+			if (rc) {
+				D__ERROR("Dirty table destroy failed: %d\n",
+					rc);
+				pmemobj_tx_abort(EFAULT);
+			}
+		}
+
 		daos_iov_set(&iov, &uuid, sizeof(struct daos_uuid));
 		rc = dbtree_delete(vpool->vp_cont_th, &iov, NULL);
 	}  TX_ONABORT {
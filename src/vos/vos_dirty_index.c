@@ -0,0 +1,285 @@
+/**
+ * (C) Copyright 2016 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * GOVERNMENT LICENSE RIGHTS-OPEN SOURCE SOFTWARE
+ * The Government's rights to use, modify, reproduce, release, perform, display,
+ * or disclose this software are subject to the terms of the Apache License as
+ * provided in Contract No. B609815.
+ * Any reproduction of computer software, computer software documentation, or
+ * portions thereof marked with this legend must also reproduce the markings.
+ */
+/**
+ * VOS dirty object table
+ * vos/vos_dirty_index.c
+ *
+ * The dirty object table records objects modified since the last aggregated
+ * epoch of the container, so aggregation and discard only need to visit the
+ * objects in this table instead of scanning the whole object index.
+ */
+#define DDSUBSYS	DDFAC(vos)
+
+#include <daos_errno.h>
+#include <daos/mem.h>
+#include <daos/btree.h>
+#include <daos_types.h>
+#include <vos_internal.h>
+#include <vos_obj.h>
+
+static int
+dirty_hkey_size(struct btr_instance *tins)
+{
+	return sizeof(daos_unit_oid_t);
+}
+
+static void
+dirty_hkey_gen(struct btr_instance *tins, daos_iov_t *key_iov, void *hkey)
+{
+	daos_unit_oid_t	*oid = hkey;
+
+	D__ASSERT(key_iov->iov_len == sizeof(daos_unit_oid_t));
+	*oid = *(daos_unit_oid_t *)key_iov->iov_buf;
+	oid->id_pad_32 = 0;
+}
+
+static int
+dirty_rec_alloc(struct btr_instance *tins, daos_iov_t *key_iov,
+		daos_iov_t *val_iov, struct btr_record *rec)
+{
+	struct vos_dirty_obj_df		*dobj;
+	TMMID(struct vos_dirty_obj_df)	 dobj_mmid;
+
+	D__ASSERT(key_iov->iov_len == sizeof(daos_unit_oid_t));
+	D__ASSERT(val_iov->iov_len == sizeof(daos_epoch_t));
+
+	dobj_mmid = umem_znew_typed(&tins->ti_umm, struct vos_dirty_obj_df);
+	if (TMMID_IS_NULL(dobj_mmid))
+		return -DER_NOMEM;
+
+	dobj = umem_id2ptr_typed(&tins->ti_umm, dobj_mmid);
+	dobj->do_id	= *(daos_unit_oid_t *)key_iov->iov_buf;
+	dobj->do_epc_lo	= *(daos_epoch_t *)val_iov->iov_buf;
+	dobj->do_epc_hi	= dobj->do_epc_lo;
+
+	rec->rec_mmid = umem_id_t2u(dobj_mmid);
+	return 0;
+}
+
+static int
+dirty_rec_free(struct btr_instance *tins, struct btr_record *rec, void *args)
+{
+	umem_free(&tins->ti_umm, rec->rec_mmid);
+	return 0;
+}
+
+static int
+dirty_rec_fetch(struct btr_instance *tins, struct btr_record *rec,
+		daos_iov_t *key_iov, daos_iov_t *val_iov)
+{
+	struct vos_dirty_obj_df	*dobj;
+
+	dobj = umem_id2ptr(&tins->ti_umm, rec->rec_mmid);
+	if (key_iov != NULL)
+		daos_iov_set(key_iov, &dobj->do_id, sizeof(dobj->do_id));
+	if (val_iov != NULL)
+		daos_iov_set(val_iov, dobj, sizeof(*dobj));
+	return 0;
+}
+
+static int
+dirty_rec_update(struct btr_instance *tins, struct btr_record *rec,
+		 daos_iov_t *key_iov, daos_iov_t *val_iov)
+{
+	struct vos_dirty_obj_df	*dobj;
+	daos_epoch_t		 epoch;
+
+	D__ASSERT(val_iov->iov_len == sizeof(daos_epoch_t));
+	epoch = *(daos_epoch_t *)val_iov->iov_buf;
+
+	dobj = umem_id2ptr(&tins->ti_umm, rec->rec_mmid);
+	/* the common case: keep writing to an object in the same epoch */
+	if (epoch >= dobj->do_epc_lo && epoch <= dobj->do_epc_hi)
+		return 0;
+
+	umem_tx_add(&tins->ti_umm, rec->rec_mmid, sizeof(*dobj));
+	if (epoch < dobj->do_epc_lo)
+		dobj->do_epc_lo = epoch;
+	if (epoch > dobj->do_epc_hi)
+		dobj->do_epc_hi = epoch;
+	return 0;
+}
+
+static btr_ops_t dirty_tab_ops = {
+	.to_hkey_size	= dirty_hkey_size,
+	.to_hkey_gen	= dirty_hkey_gen,
+	.to_rec_alloc	= dirty_rec_alloc,
+	.to_rec_free	= dirty_rec_free,
+	.to_rec_fetch	= dirty_rec_fetch,
+	.to_rec_update	= dirty_rec_update,
+};
+
+int
+vos_dirty_obj_mark(struct vos_container *cont, daos_unit_oid_t oid,
+		   daos_epoch_t epoch)
+{
+	daos_iov_t	kiov;
+	daos_iov_t	viov;
+	int		rc;
+
+	if (daos_handle_is_inval(cont->vc_dtab_hdl))
+		return 0; /* the pool has no dirty object table */
+
+	daos_iov_set(&kiov, &oid, sizeof(oid));
+	daos_iov_set(&viov, &epoch, sizeof(epoch));
+
+	rc = dbtree_update(cont->vc_dtab_hdl, &kiov, &viov);
+	if (rc != 0)
+		D__ERROR("Failed to mark "DF_UOID" dirty: %d\n",
+			DP_UOID(oid), rc);
+	return rc;
+}
+
+int
+vos_dirty_obj_prune(struct vos_container *cont, daos_epoch_range_t *epr)
+{
+	struct umem_instance	*umm = &cont->vc_pool->vp_umm;
+	daos_hash_out_t		 anchor;
+	daos_handle_t		 ih;
+	int			 pruned = 0;
+	int			 rc;
+
+	if (daos_handle_is_inval(cont->vc_dtab_hdl))
+		return 0;
+
+	rc = dbtree_iter_prepare(cont->vc_dtab_hdl, 0, &ih);
+	if (rc != 0)
+		return rc;
+
+	TX_BEGIN(vos_cont2pop(cont)) {
+		rc = dbtree_iter_probe(ih, BTR_PROBE_FIRST, NULL, NULL);
+		while (rc == 0) {
+			struct vos_dirty_obj_df	*dobj;
+			daos_iov_t		 viov;
+
+			daos_iov_set(&viov, NULL, 0);
+			rc = dbtree_iter_fetch(ih, NULL, &viov, &anchor);
+			if (rc != 0)
+				break;
+
+			dobj = viov.iov_buf;
+			if (dobj->do_epc_lo < epr->epr_lo ||
+			    dobj->do_epc_lo > epr->epr_hi) {
+				/* modifications before or after the range
+				 * have not been aggregated
+				 */
+				rc = dbtree_iter_next(ih);
+				continue;
+			}
+
+			if (dobj->do_epc_hi > epr->epr_hi) {
+				/* still has modifications after the range */
+				umem_tx_add_ptr(umm, dobj, sizeof(*dobj));
+				dobj->do_epc_lo = epr->epr_hi + 1;
+				rc = dbtree_iter_next(ih);
+				continue;
+			}
+
+			rc = dbtree_iter_delete(ih, NULL);
+			if (rc != 0)
+				break;
+
+			pruned++;
+			/* need to probe again after the delete */
+			rc = dbtree_iter_probe(ih, BTR_PROBE_GE, NULL, &anchor);
+		}
+
+		if (rc == -DER_NONEXIST)
+			rc = 0;
+		if (rc != 0)
+			pmemobj_tx_abort(EFAULT);
+	} TX_ONABORT {
+		rc = umem_tx_errno(rc);
+		D__ERROR("Failed to prune dirty objects: %d\n", rc);
+	} TX_END
+
+	D__DEBUG(DB_EPC, "Pruned %d dirty objects ["DF_U64", "DF_U64"]: %d\n",
+		pruned, epr->epr_lo, epr->epr_hi, rc);
+	dbtree_iter_finish(ih);
+	return rc;
+}
+
+int
+vos_dirty_tab_register(void)
+{
+	int	rc;
+
+	D__DEBUG(DB_DF, "Registering class for dirty object table: %d\n",
+		VOS_BTR_DIRTY_TABLE);
+
+	rc = dbtree_class_register(VOS_BTR_DIRTY_TABLE, 0, &dirty_tab_ops);
+	if (rc)
+		D__ERROR("dbtree create failed\n");
+	return rc;
+}
+
+int
+vos_dirty_tab_create(struct vos_pool *pool, struct vos_dirty_table_df *dtab_df)
+{
+	daos_handle_t	btr_hdl;
+	int		rc = 0;
+
+	if (!pool || !dtab_df) {
+		D__ERROR("Invalid handle\n");
+		return -DER_INVAL;
+	}
+
+	if (!dtab_df->dtb_btr.tr_class) {
+		D__DEBUG(DB_DF, "create dirty object table in-place: %d\n",
+			VOS_BTR_DIRTY_TABLE);
+
+		rc = dbtree_create_inplace(VOS_BTR_DIRTY_TABLE, 0,
+					   OT_BTREE_ORDER, &pool->vp_uma,
+					   &dtab_df->dtb_btr, &btr_hdl);
+		if (rc) {
+			D__ERROR("dbtree create failed\n");
+			return rc;
+		}
+		dbtree_close(btr_hdl);
+	}
+	return rc;
+}
+
+int
+vos_dirty_tab_destroy(struct vos_pool *pool,
+		      struct vos_dirty_table_df *dtab_df)
+{
+	daos_handle_t	btr_hdl;
+	int		rc;
+
+	if (!pool || !dtab_df) {
+		D__ERROR("Invalid handle\n");
+		return -DER_INVAL;
+	}
+
+	rc = dbtree_open_inplace(&dtab_df->dtb_btr, &pool->vp_uma, &btr_hdl);
+	if (rc) {
+		D__ERROR("Dirty object table open failed\n");
+		return -DER_NONEXIST;
+	}
+
+	rc = dbtree_destroy(btr_hdl);
+	if (rc)
+		D__ERROR("Dirty object table destroy failed\n");
+	return rc;
+}
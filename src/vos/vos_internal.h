@@ -38,7 +38,7 @@
 #include <daos_srv/daos_server.h>
 #include <vos_layout.h>
 #include <vos_obj.h>
-#include <mchecksum.h>
+#include <daos/csum.h>
 
 extern struct dss_module_key vos_module_key;
 extern umem_class_id_t vos_mem_class;
@@ -92,6 +92,8 @@ struct vos_container {
 	 * within container
 	 */
 	struct vos_obj_table_df	*vc_otab_df;
+	/* DAOS handle for dirty object table btree */
+	daos_handle_t		vc_dtab_hdl;
 	/** Direct pointer to the VOS container */
 	struct vos_cont_df	*vc_cont_df;
 };
@@ -106,9 +108,10 @@ struct vos_imem_strts {
 	/** (container/pool, etc.,) */
 	struct dhash_table	*vis_pool_hhash;
 	struct dhash_table	*vis_cont_hhash;
-	int			vis_enable_checksum;
-	mchecksum_object_t	vis_checksum;
-
+	/** checksum type of updates, DAOS_CSUM_NONE if disabled */
+	int			vis_csum_type;
+	/** Visible extents returned by evtree searches of fetch */
+	struct evt_entry_array	vis_ent_array;
 };
 
 
@@ -230,6 +233,14 @@ vos_pool_ptr2df(struct vos_pool *pool)
 	return vos_pool_pop2df(vos_pool_ptr2pop(pool));
 }
 
+/** Does the pool have the dirty object table in containers? */
+static inline bool
+vos_pool_has_dirty_tab(struct vos_pool *pool)
+{
+	return vos_pool_ptr2df(pool)->pd_incompat_flags &
+	       VOS_POOL_INCOMPAT_DIRTY_TAB;
+}
+
 static inline void
 vos_pool_addref(struct vos_pool *pool)
 {
@@ -252,14 +263,16 @@ PMEMobjpool *vos_coh2pop(daos_handle_t coh);
 struct daos_lru_cache *vos_get_obj_cache(void);
 
 /**
- * Check if checksum is enabled
+ * Getting the reusable array for evtree searches, fetch does not yield
+ * so it is not shared by concurrent fetches of the xstream.
+ * Wrapper for TLS and standalone mode
  */
-int vos_csum_enabled(void);
+struct evt_entry_array *vos_ent_array_get(void);
 
 /**
- * compute checksum for a sgl using CRC64
+ * Checksum type of updates, it is DAOS_CSUM_NONE if checksum is disabled
  */
-int vos_csum_compute(daos_sg_list_t *sgl, daos_csum_buf_t *csum);
+int vos_csum_type(void);
 /**
  * Register btree class for container table, it is called within vos_init()
  *
@@ -386,6 +399,70 @@ vos_obj_tab_create(struct vos_pool *pool, struct vos_obj_table_df *otab_df);
 int
 vos_obj_tab_destroy(struct vos_pool *pool, struct vos_obj_table_df *otab_df);
 
+/**
+ * VOS dirty object table class register for btree
+ * Called with vos_init()
+ *
+ * \return		0 on success and negative on
+ *			failure
+ */
+int
+vos_dirty_tab_register(void);
+
+/**
+ * Create the dirty object table of a container
+ * Called from vos_container_create.
+ *
+ * \param pool		[IN]	vos pool
+ * \param dtab_df	[IN]	dirty object table (pmem data structure)
+ *
+ * \return		0 on success and negative on failure
+ */
+int
+vos_dirty_tab_create(struct vos_pool *pool,
+		     struct vos_dirty_table_df *dtab_df);
+
+/**
+ * Destroy the dirty object table of a container
+ * Called from vos_container_destroy
+ *
+ * \param pool		[IN]	vos pool
+ * \param dtab_df	[IN]	dirty object table (pmem data structure)
+ *
+ * \return		0 on success and negative on failure
+ */
+int
+vos_dirty_tab_destroy(struct vos_pool *pool,
+		      struct vos_dirty_table_df *dtab_df);
+
+/**
+ * Record that object \a oid is modified in \a epoch, it should be called
+ * within the transaction of the modification.
+ *
+ * \param cont		[IN]	vos container
+ * \param oid		[IN]	modified object
+ * \param epoch		[IN]	modified epoch
+ *
+ * \return		0 on success and negative on failure
+ */
+int
+vos_dirty_obj_mark(struct vos_container *cont, daos_unit_oid_t oid,
+		   daos_epoch_t epoch);
+
+/**
+ * Remove objects whose modifications are all within \a epr from the dirty
+ * object table, and raise the lower bound of objects which also have later
+ * modifications. It is called after all objects in the table have been
+ * aggregated for the epoch range \a epr.
+ *
+ * \param cont		[IN]	vos container
+ * \param epr		[IN]	aggregated epoch range
+ *
+ * \return		0 on success and negative on failure
+ */
+int
+vos_dirty_obj_prune(struct vos_container *cont, daos_epoch_range_t *epr);
+
 enum vos_tree_class {
 	/** the first reserved tree class */
 	VOS_BTR_BEGIN		= DBTREE_VOS_BEGIN,
@@ -401,13 +478,41 @@ enum vos_tree_class {
 	VOS_BTR_CONT_TABLE	= (VOS_BTR_BEGIN + 4),
 	/** tree type for cookie index table */
 	VOS_BTR_COOKIE		= (VOS_BTR_BEGIN + 5),
+	/** dirty object table */
+	VOS_BTR_DIRTY_TABLE	= (VOS_BTR_BEGIN + 6),
 	/** the last reserved tree class */
 	VOS_BTR_END,
 };
 
+/**
+ * Feature bits of VOS key trees, they are stored in btr_root::tr_feats
+ * together with feature bits of dbtree.
+ */
+/** keys of the tree are ordered as native uint64_t */
+#define VOS_KEY_CMP_UINT64	(1ULL << 63)
+/** keys of the tree are ordered lexically */
+#define VOS_KEY_CMP_LEXICAL	(1ULL << 62)
+/** akey trees created under a dkey tree are ordered as native uint64_t */
+#define VOS_AKEY_CMP_UINT64	(1ULL << 61)
+/** akey trees created under a dkey tree are ordered lexically */
+#define VOS_AKEY_CMP_LEXICAL	(1ULL << 60)
+
+#define VOS_KEY_CMP_MASK	(VOS_KEY_CMP_UINT64 | VOS_KEY_CMP_LEXICAL)
+#define VOS_AKEY_CMP_MASK	(VOS_AKEY_CMP_UINT64 | VOS_AKEY_CMP_LEXICAL)
+
 int vos_obj_tree_init(struct vos_object *obj);
+int vos_obj_coalesce(struct vos_object *obj, daos_key_t *dkey,
+		     daos_key_t *akey, daos_epoch_t epoch,
+		     unsigned int *credits);
+int vos_obj_discard_akey(struct vos_object *obj, daos_key_t *dkey,
+			 daos_key_t *akey, daos_epoch_range_t *epr,
+			 uuid_t cookie, bool *empty);
+int vos_obj_aggregate_akey(struct vos_object *obj, daos_key_t *dkey,
+			   daos_key_t *akey, daos_epoch_range_t *epr,
+			   bool *empty);
 int vos_obj_tree_fini(struct vos_object *obj);
 int vos_obj_tree_register(void);
+int vos_key_cmp_ordered(uint64_t feats, daos_key_t *key1, daos_key_t *key2);
 
 /**
  * Data structure which carries the keys, epoch ranges to the multi-nested
@@ -425,7 +530,10 @@ struct vos_key_bundle {
  * to the multi-nested btree.
  */
 struct vos_rec_bundle {
-	/** Optional, externally allocated buffer mmid */
+	/**
+	 * Input  : optional, externally allocated buffer mmid
+	 * Output : mmid of the value, it is NULL for an inline value
+	 */
 	umem_id_t		 rb_mmid;
 	/** checksum buffer for the daos key */
 	daos_csum_buf_t		*rb_csum;
@@ -678,6 +786,14 @@ struct vos_iter_ops {
 	int	(*iop_fetch)(struct vos_iterator *iter,
 			     vos_iter_entry_t *it_entry,
 			     daos_hash_out_t *anchor);
+	/**
+	 * Optional, fetch up to \a nr records from the cursor and move the
+	 * cursor past them, see vos_iter_fetch_batch().
+	 */
+	int	(*iop_fetch_batch)(struct vos_iterator *iter,
+				   vos_iter_entry_t *entries,
+				   daos_hash_out_t *anchors,
+				   unsigned int *nr);
 	/** Delete the record that the cursor points to */
 	int	(*iop_delete)(struct vos_iterator *iter,
 			      void *args);
@@ -205,6 +205,59 @@ vos_iter_fetch(daos_handle_t ih, vos_iter_entry_t *it_entry,
 	return iter->it_ops->iop_fetch(iter, it_entry, anchor);
 }
 
+/** fetch and move the cursor one entry at a time */
+static int
+vos_iter_fetch_each(struct vos_iterator *iter, vos_iter_entry_t *entries,
+		    daos_hash_out_t *anchors, unsigned int *nr)
+{
+	int	i;
+	int	rc = 0;
+
+	for (i = 0; i < *nr && rc == 0; i++) {
+		rc = iter->it_ops->iop_fetch(iter, &entries[i],
+					     anchors ? &anchors[i] : NULL);
+		if (rc != 0)
+			break;
+
+		rc = iter->it_ops->iop_next(iter);
+	}
+	*nr = i;
+	return rc;
+}
+
+int
+vos_iter_fetch_batch(daos_handle_t ih, vos_iter_entry_t *entries,
+		     daos_hash_out_t *anchors, unsigned int *nr)
+{
+	struct vos_iterator *iter = vos_hdl2iter(ih);
+	int		     rc;
+
+	if (iter->it_state == VOS_ITS_NONE) {
+		D__ERROR("Please call vos_iter_probe to initialise cursor\n");
+		return -DER_NO_PERM;
+	}
+
+	if (iter->it_state == VOS_ITS_END) {
+		D__DEBUG(DB_TRACE, "The end of iteration\n");
+		*nr = 0;
+		return -DER_NONEXIST;
+	}
+
+	D__ASSERT(iter->it_ops != NULL);
+	rc = -DER_NOSYS;
+	if (iter->it_ops->iop_fetch_batch != NULL)
+		rc = iter->it_ops->iop_fetch_batch(iter, entries, anchors, nr);
+	if (rc == -DER_NOSYS)
+		rc = vos_iter_fetch_each(iter, entries, anchors, nr);
+
+	if (rc == -DER_NONEXIST)
+		iter->it_state = VOS_ITS_END;
+	else if (rc != 0)
+		iter->it_state = VOS_ITS_NONE;
+
+	return rc;
+}
+
 int
 vos_iter_delete(daos_handle_t ih, void *args)
 {
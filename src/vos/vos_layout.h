@@ -74,6 +74,7 @@ POBJ_LAYOUT_TOID(vos_pool_layout, struct vos_obj_df);
 POBJ_LAYOUT_TOID(vos_pool_layout, struct vos_cookie_rec_df);
 POBJ_LAYOUT_TOID(vos_pool_layout, struct vos_krec_df);
 POBJ_LAYOUT_TOID(vos_pool_layout, struct vos_irec_df);
+POBJ_LAYOUT_TOID(vos_pool_layout, struct vos_dirty_obj_df);
 POBJ_LAYOUT_END(vos_pool_layout);
 
 
@@ -95,6 +96,15 @@ struct vos_cookie_rec_df {
 	daos_epoch_t		cr_max_epoch;
 };
 
+/** Incompatible features of vos_pool_df::pd_incompat_flags */
+enum vos_pool_incompat {
+	/**
+	 * Containers have the dirty object table vos_cont_df::cd_dtab_df,
+	 * containers of pools created before it have no room for the table.
+	 */
+	VOS_POOL_INCOMPAT_DIRTY_TAB	= (1ULL << 0),
+};
+
 struct vos_pool_df {
 	/* Structs stored in LE or BE representation */
 	uint32_t				pd_magic;
@@ -122,11 +132,31 @@ struct vos_obj_table_df {
 	struct btr_root			obt_btr;
 };
 
+/**
+ * VOS dirty object table
+ * Objects modified since the last aggregated epoch, it is an in-place btree
+ * indexed by object ID.
+ */
+struct vos_dirty_table_df {
+	struct btr_root			dtb_btr;
+};
+
+/** Record of the dirty object table */
+struct vos_dirty_obj_df {
+	daos_unit_oid_t			do_id;
+	/** the lowest modified epoch which has not been aggregated */
+	daos_epoch_t			do_epc_lo;
+	/** the highest modified epoch */
+	daos_epoch_t			do_epc_hi;
+};
+
 /* VOS Container Value */
 struct vos_cont_df {
 	uuid_t				cd_id;
 	vos_cont_info_t			cd_info;
 	struct vos_obj_table_df		cd_otab_df;
+	/** only valid if the pool has VOS_POOL_INCOMPAT_DIRTY_TAB */
+	struct vos_dirty_table_df	cd_dtab_df;
 };
 
 /** btree (d/a-key) record bit flags */
@@ -177,6 +207,25 @@ struct vos_irec_df {
 	char				ir_body[0];
 };
 
+/** single values up to this size are stored inline, see vos_irec_inline_df */
+#define VOS_IREC_INLINE_MAX		64
+
+/**
+ * Single value stored inline in the leaf record of btree VOS_BTR_SINGV, it
+ * replaces vos_irec_df of small values without checksum, so they don't need
+ * a separate allocation. btr_record::rec_mmid is UMMID_NULL for such record.
+ */
+struct vos_irec_inline_df {
+	/** pool map version */
+	uint32_t			ii_ver;
+	/** length of value */
+	uint16_t			ii_size;
+	/** padding bytes */
+	uint16_t			ii_pad16;
+	/** value */
+	char				ii_body[VOS_IREC_INLINE_MAX];
+};
+
 /**
  * VOS object, assume all objects are KV store...
  * NB: PMEM data structure.
@@ -29,6 +29,7 @@
 
 #include <daos_types.h>
 #include <daos/btree.h>
+#include <daos/metrics.h>
 #include <daos_srv/vos.h>
 #include <vos_internal.h>
 #include "vos_internal.h"
@@ -39,12 +40,26 @@ struct vos_obj_iter {
 	struct vos_iterator	 it_iter;
 	/** handle of iterator */
 	daos_handle_t		 it_hdl;
+	/**
+	 * open handle of the key tree if \a it_hdl iterates a snapshot of it,
+	 * see VOS_IT_SNAPSHOT, keys are deleted through it.
+	 */
+	daos_handle_t		 it_toh;
 	/** condition of the iterator: epoch logic expression */
 	vos_it_epc_expr_t	 it_epc_expr;
 	/** condition of the iterator: epoch range */
 	daos_epoch_range_t	 it_epr;
 	/** condition of the iterator: attribute key */
 	daos_key_t		 it_akey;
+	/** condition of the iterator: key range of ordered key tree */
+	daos_key_t		 it_key_lo;
+	daos_key_t		 it_key_hi;
+	/** condition of the iterator: key prefix */
+	daos_key_t		 it_key_prefix;
+	/** key order of the iterated tree, VOS_KEY_CMP_* or zero */
+	uint64_t		 it_key_feats;
+	/** iterator flags, see vos_it_flags */
+	unsigned int		 it_flags;
 	/* reference on the object */
 	struct vos_object	*it_obj;
 };
@@ -84,6 +99,18 @@ struct iod_buf {
 	unsigned int		 db_mmid_nr;
 	/** pre-allocated pmem buffers (for zc update only) */
 	umem_id_t		*db_mmids;
+	/**
+	 * checksums of the pre-allocated pmem buffers, they can be computed
+	 * while the data is transferred (for zc update only)
+	 */
+	struct daos_csum_ctx	*db_csums;
+	/**
+	 * copy of an inline single value (for zc fetch only), the value
+	 * stored in the btree leaf can be moved by a concurrent update
+	 * while the upper level stack is transferring it.
+	 */
+	void			*db_inline;
+	daos_size_t		 db_inline_size;
 };
 
 static bool
@@ -196,22 +223,6 @@ iobuf_fetch(struct iod_buf *iobuf, daos_iov_t *iov)
 	else
 		rc = iobuf_cp_fetch(iobuf, iov);
 
-	if (rc)
-		D__GOTO(out, rc);
-
-	if (vos_csum_enabled()) {
-		daos_csum_buf_t	cbuf;
-		uint64_t	csum;
-
-		/* XXX This is just for performance evaluation, checksum is
-		 * not verified becausre the original checksum is not stored.
-		 */
-		daos_csum_set(&cbuf, &csum, sizeof(csum));
-		rc = vos_csum_compute(&iobuf->db_sgl, &cbuf);
-		if (rc != 0)
-			D_ERROR("Checksum compute error: %d\n", rc);
-	}
-out:
 	return rc;
 }
 
@@ -274,25 +285,74 @@ iobuf_zc_update(struct iod_buf *iobuf)
 static int
 iobuf_update(struct iod_buf *iobuf, daos_iov_t *iov)
 {
-	int	rc;
-
-	if (vos_csum_enabled()) {
-		daos_csum_buf_t	 cbuf;
-		uint64_t	 csum;
-
-		/* XXX: checksum is not stored for now */
-		daos_csum_set(&cbuf, &csum, sizeof(csum));
-		rc = vos_csum_compute(&iobuf->db_sgl, &cbuf);
-		if (rc != 0)
-			D_ERROR("Checksum compute error: %d\n", rc);
-	}
-
 	if (iobuf->db_zc)
 		return iobuf_zc_update(iobuf); /* iov is ignored */
 	else
 		return iobuf_cp_update(iobuf, iov);
 }
 
+/**
+ * Compute checksum of the next \a size bytes of \a iobuf, it should be
+ * called before iobuf_update() consumes them. Checksum of a zero-copy buffer
+ * could have been computed while the data was transferred, see
+ * vos_obj_zc_csum_at(). \a csum has zero cs_len if checksum is disabled.
+ */
+static void
+iobuf_csum(struct iod_buf *iobuf, daos_size_t size, daos_csum_buf_t *csum)
+{
+	struct daos_csum_ctx	 ctx;
+	daos_sg_list_t		*sgl = &iobuf->db_sgl;
+	daos_off_t		 off = iobuf->db_iov_off;
+	unsigned int		 at = iobuf->db_at;
+	int			 type = vos_csum_type();
+
+	if (type == DAOS_CSUM_NONE || size == 0 || iobuf_sgl_empty(iobuf)) {
+		csum->cs_len = 0;
+		return;
+	}
+
+	if (iobuf->db_csums != NULL &&
+	    iobuf->db_csums[at].cc_len == sgl->sg_iovs[at].iov_len) {
+		ctx = iobuf->db_csums[at];
+		D__ASSERT(ctx.cc_len == size);
+	} else {
+		daos_csum_init(&ctx, type);
+		for (; size != 0 && at < sgl->sg_nr.num; at++, off = 0) {
+			daos_iov_t	*iov = &sgl->sg_iovs[at];
+			daos_size_t	 nob;
+
+			if (iov->iov_buf == NULL || iov->iov_len <= off)
+				break;
+
+			nob = min(size, iov->iov_len - off);
+			daos_csum_update(&ctx, iov->iov_buf + off, nob);
+			size -= nob;
+		}
+	}
+	daos_csum_final(&ctx, csum);
+}
+
+/** Verify \a size bytes at \a addr against the stored checksum \a csum */
+static int
+vos_csum_verify(void *addr, daos_size_t size, daos_csum_buf_t *csum)
+{
+	struct daos_csum_ctx	ctx;
+	int			rc;
+
+	if (daos_csum_type2size(csum->cs_type) == 0) {
+		D__ERROR("Invalid checksum type %d\n", csum->cs_type);
+		return -DER_IO;
+	}
+
+	daos_csum_init(&ctx, csum->cs_type);
+	daos_csum_update(&ctx, addr, size);
+	rc = daos_csum_verify(&ctx, csum);
+	if (rc != 0)
+		D__ERROR("Checksum %s mismatch of "DF_U64" bytes at %p\n",
+			 daos_csum_type2name(csum->cs_type), size, addr);
+	return rc;
+}
+
 static void
 vos_empty_sgl(daos_sg_list_t *sgl)
 {
@@ -470,6 +530,25 @@ akey_fetch_single(daos_handle_t toh, daos_epoch_range_t *epr,
 		D__GOTO(out, rc);
 	}
 
+	if (iobuf->db_zc && !iobuf_sgl_empty(iobuf) && diov.iov_len != 0 &&
+	    UMMID_IS_NULL(rbund.rb_mmid)) {
+		/* inline value lives in the btree node, copy it out */
+		D__ASSERT(iobuf->db_inline == NULL);
+		D__ALLOC(iobuf->db_inline, diov.iov_len);
+		if (iobuf->db_inline == NULL)
+			D__GOTO(out, rc = -DER_NOMEM);
+
+		iobuf->db_inline_size = diov.iov_len;
+		memcpy(iobuf->db_inline, diov.iov_buf, diov.iov_len);
+		diov.iov_buf = iobuf->db_inline;
+	}
+
+	if (csum.cs_len != 0 && !iobuf_sgl_empty(iobuf)) {
+		rc = vos_csum_verify(diov.iov_buf, diov.iov_len, &csum);
+		if (rc != 0)
+			D__GOTO(out, rc);
+	}
+
 	rc = iobuf_fetch(iobuf, &diov);
 	if (rc != 0)
 		D__GOTO(out, rc);
@@ -486,7 +565,7 @@ akey_fetch_recx(daos_handle_t toh, daos_epoch_range_t *epr, daos_recx_t *recx,
 		daos_size_t *rsize_p, struct iod_buf *iobuf)
 {
 	struct evt_entry	*ent;
-	struct evt_entry_list	 ent_list;
+	struct evt_entry_array	*ent_array = vos_ent_array_get();
 	struct evt_rect		 rect;
 	daos_iov_t		 iov;
 	daos_size_t		 holes; /* hole width */
@@ -503,14 +582,14 @@ akey_fetch_recx(daos_handle_t toh, daos_epoch_range_t *epr, daos_recx_t *recx,
 	rect.rc_epc_lo = epr->epr_lo;
 	rect.rc_epc_hi = epr->epr_hi;
 
-	evt_ent_list_init(&ent_list);
-	rc = evt_find(toh, &rect, &ent_list);
+	/* visible extents are sorted and never overlap */
+	rc = evt_find(toh, &rect, ent_array);
 	if (rc != 0)
 		D__GOTO(failed, rc);
 
 	rsize = 0;
 	holes = 0;
-	evt_ent_list_for_each(ent, &ent_list) {
+	evt_ent_array_for_each(ent, ent_array) {
 		daos_off_t	lo = ent->en_rect.rc_off_lo;
 		daos_off_t	hi = ent->en_rect.rc_off_hi;
 		daos_size_t	nr;
@@ -550,6 +629,13 @@ akey_fetch_recx(daos_handle_t toh, daos_epoch_range_t *epr, daos_recx_t *recx,
 			holes = 0;
 		}
 
+		if (ent->en_csum.cs_len != 0 && !iobuf_sgl_empty(iobuf)) {
+			rc = vos_csum_verify(ent->en_addr, nr * rsize,
+					     &ent->en_csum);
+			if (rc != 0)
+				D__GOTO(failed, rc);
+		}
+
 		daos_iov_set(&iov, ent->en_addr, nr * rsize);
 		rc = iobuf_fetch(iobuf, &iov);
 		if (rc != 0)
@@ -575,7 +661,6 @@ akey_fetch_recx(daos_handle_t toh, daos_epoch_range_t *epr, daos_recx_t *recx,
 	*rsize_p = rsize;
 	D_EXIT;
  failed:
-	evt_ent_list_fini(&ent_list);
 	return rc;
 }
 
@@ -715,6 +800,7 @@ vos_obj_fetch(daos_handle_t coh, daos_unit_oid_t oid, daos_epoch_t epoch,
 	      daos_sg_list_t *sgls)
 {
 	struct vos_object *obj;
+	uint64_t	   start = daos_metric_tick();
 	int		   rc;
 
 	D__DEBUG(DB_TRACE, "Fetch "DF_UOID", desc_nr %d, epoch "DF_U64"\n",
@@ -739,6 +825,54 @@ vos_obj_fetch(daos_handle_t coh, daos_unit_oid_t oid, daos_epoch_t epoch,
 	rc = dkey_fetch(obj, epoch, dkey, iod_nr, iods, sgls, NULL);
  out:
 	vos_obj_release(vos_obj_cache_current(), obj);
+	daos_metric_tock(DMH_VOS_FETCH, start);
+	return rc;
+}
+
+/**
+ * Fetch records of multiple dkeys from the specified object, the object is
+ * held only once.
+ */
+int
+vos_obj_fetch_multi(daos_handle_t coh, daos_unit_oid_t oid,
+		    daos_epoch_t epoch, unsigned int dkey_nr,
+		    daos_key_t *dkeys, unsigned int *iod_nrs, daos_iod_t *iods,
+		    daos_sg_list_t *sgls)
+{
+	struct vos_object *obj;
+	uint64_t	   start = daos_metric_tick();
+	unsigned int	   off;
+	int		   i;
+	int		   rc;
+
+	D__DEBUG(DB_TRACE, "Fetch "DF_UOID", dkey_nr %d, epoch "DF_U64"\n",
+		DP_UOID(oid), dkey_nr, epoch);
+
+	rc = vos_obj_hold(vos_obj_cache_current(), coh, oid, epoch, true, &obj);
+	if (rc != 0)
+		return rc;
+
+	for (i = 0, off = 0; i < dkey_nr; off += iod_nrs[i], i++) {
+		daos_sg_list_t	*dkey_sgls = sgls == NULL ? NULL : &sgls[off];
+		int		 j;
+
+		if (!vos_obj_is_empty(obj)) {
+			rc = dkey_fetch(obj, epoch, &dkeys[i], iod_nrs[i],
+					&iods[off], dkey_sgls, NULL);
+			if (rc != 0)
+				break;
+			continue;
+		}
+
+		for (j = 0; j < iod_nrs[i]; j++) {
+			iods[off + j].iod_size = 0;
+			if (dkey_sgls != NULL)
+				vos_empty_sgl(&dkey_sgls[j]);
+		}
+	}
+
+	vos_obj_release(vos_obj_cache_current(), obj);
+	daos_metric_tock(DMH_VOS_FETCH, start);
 	return rc;
 }
 
@@ -753,20 +887,34 @@ akey_update_single(daos_handle_t toh, daos_epoch_range_t *epr, uuid_t cookie,
 	daos_iov_t		riov;
 	daos_iov_t		iov; /* iov for the sink buffer */
 	umem_id_t		mmid;
+	uint64_t		csum_val;
+	char			vbuf[VOS_IREC_INLINE_MAX];
+	bool			copied = false;
 	int			rc;
 
 	tree_key_bundle2iov(&kbund, &kiov);
 	kbund.kb_epr	= epr;
 
-	daos_csum_set(&csum, NULL, 0);
+	D__ASSERT(iobuf->db_at == 0);
+	daos_csum_set(&csum, &csum_val, sizeof(csum_val));
+	iobuf_csum(iobuf, rsize, &csum);
 	daos_iov_set(&iov, NULL, rsize);
 
-	D__ASSERT(iobuf->db_at == 0);
 	if (iobuf->db_zc) {
 		D__ASSERT(iobuf->db_mmid_nr == 1);
 		mmid = iobuf->db_mmids[0];
 	} else {
 		mmid = UMMID_NULL;
+		/* gather small value upfront, so it can be stored inline
+		 * within the btree record, see vos_irec_inline_df.
+		 */
+		if (rsize != 0 && rsize <= VOS_IREC_INLINE_MAX) {
+			iov.iov_buf = vbuf;
+			rc = iobuf_update(iobuf, &iov);
+			if (rc != 0)
+				D__GOTO(out, rc = -DER_IO_INVAL);
+			copied = true;
+		}
 	}
 
 	tree_rec_bundle2iov(&rbund, &riov);
@@ -783,9 +931,11 @@ akey_update_single(daos_handle_t toh, daos_epoch_range_t *epr, uuid_t cookie,
 		D__GOTO(out, rc);
 	}
 
-	rc = iobuf_update(iobuf, &iov);
-	if (rc != 0)
-		D__GOTO(out, rc = -DER_IO_INVAL);
+	if (!copied) {
+		rc = iobuf_update(iobuf, &iov);
+		if (rc != 0)
+			D__GOTO(out, rc = -DER_IO_INVAL);
+	}
 
 	D_EXIT;
 out:
@@ -802,6 +952,8 @@ akey_update_recx(daos_handle_t toh, daos_epoch_range_t *epr, uuid_t cookie,
 		 struct iod_buf *iobuf)
 {
 	struct evt_rect	rect;
+	daos_csum_buf_t	csum;
+	uint64_t	csum_val;
 	daos_iov_t	iov;
 	int		rc;
 
@@ -810,10 +962,13 @@ akey_update_recx(daos_handle_t toh, daos_epoch_range_t *epr, uuid_t cookie,
 	rect.rc_off_lo = recx->rx_idx;
 	rect.rc_off_hi = recx->rx_idx + recx->rx_nr - 1;
 
+	daos_csum_set(&csum, &csum_val, sizeof(csum_val));
+	iobuf_csum(iobuf, recx->rx_nr * rsize, &csum);
+
 	daos_iov_set(&iov, NULL, rsize);
 	if (iobuf->db_zc) {
 		rc = evt_insert(toh, cookie, pm_ver, &rect, rsize,
-				iobuf->db_mmids[iobuf->db_at]);
+				iobuf->db_mmids[iobuf->db_at], &csum);
 		if (rc != 0)
 			D__GOTO(out, rc);
 	} else {
@@ -827,7 +982,8 @@ akey_update_recx(daos_handle_t toh, daos_epoch_range_t *epr, uuid_t cookie,
 		 * copy actual data into those buffers after evt_insert_sgl().
 		 * See iobuf_update() for the details.
 		 */
-		rc = evt_insert_sgl(toh, cookie, pm_ver, &rect, rsize, &sgl);
+		rc = evt_insert_sgl(toh, cookie, pm_ver, &rect, rsize, &sgl,
+				    &csum);
 		if (rc != 0)
 			D__GOTO(out, rc);
 
@@ -939,6 +1095,11 @@ dkey_update(struct vos_object *obj, daos_epoch_t epoch, uuid_t cookie,
 		D__ERROR("Failed to record cookie: %d\n", rc);
 		D__GOTO(out, rc);
 	}
+
+	/* aggregation and discard only visit objects in the dirty table */
+	rc = vos_dirty_obj_mark(obj->obj_cont, obj->obj_id, epoch);
+	if (rc)
+		D__GOTO(out, rc);
 	D_EXIT;
  out:
 	tree_release(ak_toh, false);
@@ -955,6 +1116,7 @@ vos_obj_update(daos_handle_t coh, daos_unit_oid_t oid, daos_epoch_t epoch,
 {
 	struct vos_object	*obj;
 	PMEMobjpool		*pop;
+	uint64_t		start = daos_metric_tick();
 	int			rc;
 
 	D__DEBUG(DB_IO, "Update "DF_UOID", desc_nr %d, cookie "DF_UUID" epoch "
@@ -975,6 +1137,60 @@ vos_obj_update(daos_handle_t coh, daos_unit_oid_t oid, daos_epoch_t epoch,
 	} TX_END
 
 	vos_obj_release(vos_obj_cache_current(), obj);
+	daos_metric_tock(DMH_VOS_UPDATE, start);
+	return rc;
+}
+
+/**
+ * Update records of multiple dkeys of the specified object, the object is
+ * held once and all dkeys are updated in the same transaction.
+ */
+int
+vos_obj_update_multi(daos_handle_t coh, daos_unit_oid_t oid,
+		     daos_epoch_t epoch, uuid_t cookie, uint32_t pm_ver,
+		     unsigned int dkey_nr, daos_key_t *dkeys,
+		     unsigned int *iod_nrs, daos_iod_t *iods,
+		     daos_sg_list_t *sgls)
+{
+	struct vos_object	*obj;
+	PMEMobjpool		*pop;
+	uint64_t		start = daos_metric_tick();
+	int			rc;
+
+	D__DEBUG(DB_IO, "Update "DF_UOID", dkey_nr %d, cookie "DF_UUID
+		" epoch "DF_U64"\n", DP_UOID(oid), dkey_nr, DP_UUID(cookie),
+		epoch);
+
+	rc = vos_obj_hold(vos_obj_cache_current(), coh, oid, epoch, false,
+			  &obj);
+	if (rc != 0)
+		return rc;
+
+	pop = vos_obj2pop(obj);
+	TX_BEGIN(pop) {
+		unsigned int	off = 0;
+		int		i;
+
+		for (i = 0; i < dkey_nr; i++) {
+			rc = dkey_update(obj, epoch, cookie, pm_ver, &dkeys[i],
+					 iod_nrs[i], &iods[off],
+					 sgls == NULL ? NULL : &sgls[off],
+					 NULL);
+			if (rc != 0) {
+				D__ERROR(DF_UOID" dkey %d update failed: %d\n",
+					DP_UOID(oid), i, rc);
+				/* none of the dkeys should be updated */
+				pmemobj_tx_abort(rc);
+			}
+			off += iod_nrs[i];
+		}
+	} TX_ONABORT {
+		rc = umem_tx_errno(rc);
+		D__DEBUG(DB_IO, "Failed to update object: %d\n", rc);
+	} TX_END
+
+	vos_obj_release(vos_obj_cache_current(), obj);
+	daos_metric_tock(DMH_VOS_UPDATE, start);
 	return rc;
 }
 
@@ -1066,46 +1282,686 @@ failed:
  * Punch an object, or punch a dkey, or punch an array of akeys.
  */
 int
-vos_obj_punch(daos_handle_t coh, daos_unit_oid_t oid, daos_epoch_t epoch,
-	      uuid_t cookie, uint32_t pm_ver, daos_key_t *dkey,
-	      unsigned int akey_nr, daos_key_t *akeys)
+vos_obj_punch(daos_handle_t coh, daos_unit_oid_t oid, daos_epoch_t epoch,
+	      uuid_t cookie, uint32_t pm_ver, daos_key_t *dkey,
+	      unsigned int akey_nr, daos_key_t *akeys)
+{
+	PMEMobjpool	  *pop;
+	struct vos_object *obj;
+	int		   rc;
+
+	D__DEBUG(DB_IO, "Punch "DF_UOID", cookie "DF_UUID" epoch "
+		DF_U64"\n", DP_UOID(oid), DP_UUID(cookie), epoch);
+
+	rc = vos_obj_hold(vos_obj_cache_current(), coh, oid, epoch, true,
+			  &obj);
+	if (rc != 0)
+		return rc;
+
+	if (vos_obj_is_empty(obj)) /* nothing to do */
+		D__GOTO(out, rc = 0);
+
+	pop = vos_obj2pop(obj);
+	TX_BEGIN(pop) {
+		if (dkey) { /* key punch */
+			rc = key_punch(obj, epoch, cookie, pm_ver, dkey,
+				       akey_nr, akeys);
+		} else { /* object punch */
+			rc = obj_punch(coh, obj, epoch, cookie);
+		}
+
+		if (rc == 0)
+			rc = vos_dirty_obj_mark(vos_hdl2cont(coh), oid, epoch);
+
+	} TX_ONABORT {
+		rc = umem_tx_errno(rc);
+		D__DEBUG(DB_IO, "Failed to punch object: %d\n", rc);
+	} TX_END
+	D_EXIT;
+ out:
+	vos_obj_release(vos_obj_cache_current(), obj);
+	return rc;
+}
+
+/**
+ * @} vos_obj_io_func
+ */
+
+/**
+ * @defgroup vos_obj_coalesce functions to coalesce record extents
+ * @{
+ */
+
+/** upper bound of the data size of a coalesced extent */
+#define VOS_COALESCE_NOB_MAX	(1 << 20)
+
+/** adjacent visible extents which are rewritten as one extent */
+struct vos_coalesce_run {
+	struct evt_rect		cr_rect;
+	uuid_t			cr_cookie;
+	uint32_t		cr_ver;
+	/** number of bytes per index, zero for punched extents */
+	uint32_t		cr_inob;
+	/** the first visible extent of the run and the number of them */
+	unsigned int		cr_first;
+	unsigned int		cr_nr;
+	/** an extent crosses the boundaries, it cannot be rewritten */
+	bool			cr_skip;
+	/** the new data buffer */
+	umem_id_t		cr_mmid;
+	daos_csum_buf_t		cr_csum;
+	uint64_t		cr_csum_val;
+};
+
+/**
+ * Count all extents of the evtree \a toh and return the offset range which
+ * bounds them, \a nr is zero if the tree is empty or any extent is newer
+ * than \a epoch, which means it cannot be coalesced yet.
+ */
+static int
+recx_coalesce_scan(daos_handle_t toh, daos_epoch_t epoch,
+		   struct evt_rect *rect, unsigned int *nr)
+{
+	struct evt_entry	ent;
+	daos_handle_t		ih;
+	unsigned int		count = 0;
+	int			rc;
+
+	*nr = 0;
+	rc = evt_iter_prepare(toh, EVT_ITER_EMBEDDED, &ih);
+	if (rc != 0)
+		return rc;
+
+	rc = evt_iter_probe(ih, EVT_ITER_FIRST, NULL, NULL);
+	while (rc == 0) {
+		rc = evt_iter_fetch(ih, &ent, NULL);
+		if (rc != 0)
+			break;
+
+		if (ent.en_rect.rc_epc_lo > epoch) {
+			count = 0;
+			break;
+		}
+
+		if (count == 0 || rect->rc_off_lo > ent.en_rect.rc_off_lo)
+			rect->rc_off_lo = ent.en_rect.rc_off_lo;
+		if (count == 0 || rect->rc_off_hi < ent.en_rect.rc_off_hi)
+			rect->rc_off_hi = ent.en_rect.rc_off_hi;
+		count++;
+
+		rc = evt_iter_next(ih);
+	}
+	evt_iter_finish(ih);
+
+	if (rc != 0 && rc != -DER_NONEXIST)
+		return rc;
+
+	rect->rc_epc_lo = rect->rc_epc_hi = epoch;
+	*nr = count;
+	return 0;
+}
+
+/**
+ * Group the visible extents of \a ent_array into runs of adjacent extents
+ * with the same record size, return the number of runs.
+ */
+static unsigned int
+recx_coalesce_plan(struct evt_entry_array *ent_array,
+		   struct vos_coalesce_run *runs)
+{
+	struct vos_coalesce_run	*run = NULL;
+	struct evt_entry	*ent;
+	unsigned int		 nr = 0;
+	unsigned int		 i = 0;
+
+	evt_ent_array_for_each(ent, ent_array) {
+		struct evt_rect	*rect = &ent->en_rect;
+		daos_size_t	 width;
+
+		width = run == NULL ? 0 : evt_rect_width(&run->cr_rect);
+		if (run == NULL || run->cr_inob != ent->en_inob ||
+		    run->cr_rect.rc_off_hi + 1 != rect->rc_off_lo ||
+		    (width + evt_rect_width(rect)) * ent->en_inob >
+		    VOS_COALESCE_NOB_MAX) {
+			run = &runs[nr++];
+			memset(run, 0, sizeof(*run));
+			run->cr_rect  = *rect;
+			run->cr_rect.rc_epc_hi = DAOS_EPOCH_MAX;
+			run->cr_inob  = ent->en_inob;
+			run->cr_first = i;
+		}
+
+		/* the coalesced extent is as new as its newest part */
+		if (run->cr_nr == 0 ||
+		    run->cr_rect.rc_epc_lo <= rect->rc_epc_lo) {
+			run->cr_rect.rc_epc_lo = rect->rc_epc_lo;
+			uuid_copy(run->cr_cookie, ent->en_cookie);
+		}
+		run->cr_rect.rc_off_hi = rect->rc_off_hi;
+		run->cr_ver = max(run->cr_ver, ent->en_ver);
+		run->cr_nr++;
+		i++;
+	}
+	return nr;
+}
+
+/** Find the run of \a runs which covers offset \a off */
+static unsigned int
+recx_coalesce_run_find(struct vos_coalesce_run *runs, unsigned int run_nr,
+		       daos_off_t off)
+{
+	unsigned int	lo = 0;
+	unsigned int	hi = run_nr - 1;
+	unsigned int	mid;
+
+	while (lo < hi) {
+		mid = (lo + hi + 1) / 2;
+		if (runs[mid].cr_rect.rc_off_lo <= off)
+			lo = mid;
+		else
+			hi = mid - 1;
+	}
+	return lo;
+}
+
+/**
+ * Skip the runs which an extent of the evtree \a toh crosses the boundaries
+ * of. The extents of a run are deleted by its offset range, which cannot
+ * delete such an extent.
+ */
+static int
+recx_coalesce_check(daos_handle_t toh, struct vos_coalesce_run *runs,
+		    unsigned int run_nr)
+{
+	struct evt_entry	ent;
+	struct evt_rect		*rect;
+	daos_handle_t		ih;
+	unsigned int		i;
+	int			rc;
+
+	rc = evt_iter_prepare(toh, EVT_ITER_EMBEDDED, &ih);
+	if (rc != 0)
+		return rc;
+
+	rc = evt_iter_probe(ih, EVT_ITER_FIRST, NULL, NULL);
+	while (rc == 0) {
+		rc = evt_iter_fetch(ih, &ent, NULL);
+		if (rc != 0)
+			break;
+
+		rect = &ent.en_rect;
+		i = recx_coalesce_run_find(runs, run_nr, rect->rc_off_lo);
+		if (rect->rc_off_hi > runs[i].cr_rect.rc_off_hi) {
+			while (i < run_nr &&
+			       runs[i].cr_rect.rc_off_lo <= rect->rc_off_hi)
+				runs[i++].cr_skip = true;
+		}
+		rc = evt_iter_next(ih);
+	}
+	evt_iter_finish(ih);
+
+	return rc == -DER_NONEXIST ? 0 : rc;
+}
+
+/**
+ * Copy data of the visible extents of \a run to a new buffer, checksums
+ * of the old extents are verified and the new one is computed.
+ */
+static int
+recx_coalesce_copy(struct umem_instance *umm, struct evt_entry_array *ent_array,
+		   struct vos_coalesce_run *run)
+{
+	struct daos_csum_ctx	 ctx;
+	struct evt_entry	*ent;
+	int			 type = vos_csum_type();
+	char			*addr;
+	int			 i;
+	int			 rc;
+
+	daos_csum_set(&run->cr_csum, &run->cr_csum_val,
+		      sizeof(run->cr_csum_val));
+	run->cr_csum.cs_len = 0;
+	if (run->cr_inob == 0) /* punched */
+		return 0;
+
+	run->cr_mmid = umem_alloc(umm, evt_rect_width(&run->cr_rect) *
+				  run->cr_inob);
+	if (UMMID_IS_NULL(run->cr_mmid))
+		return -DER_NOMEM;
+
+	if (type != DAOS_CSUM_NONE)
+		daos_csum_init(&ctx, type);
+
+	addr = umem_id2ptr(umm, run->cr_mmid);
+	for (i = 0; i < run->cr_nr; i++) {
+		daos_size_t	nob;
+
+		ent = &ent_array->ea_ents[run->cr_first + i];
+		nob = evt_rect_width(&ent->en_rect) * ent->en_inob;
+		if (ent->en_csum.cs_len != 0) {
+			rc = vos_csum_verify(ent->en_addr, nob, &ent->en_csum);
+			if (rc != 0)
+				return rc;
+		}
+
+		memcpy(addr, ent->en_addr, nob);
+		if (type != DAOS_CSUM_NONE)
+			daos_csum_update(&ctx, addr, nob);
+		addr += nob;
+	}
+
+	if (type != DAOS_CSUM_NONE)
+		daos_csum_final(&ctx, &run->cr_csum);
+	return 0;
+}
+
+/**
+ * Replace the extents of \a run by one extent in a transaction, the old
+ * extents, including the versions hidden by them, are deleted by the offset
+ * range of the run.
+ */
+static int
+recx_coalesce_run(struct vos_object *obj, daos_handle_t toh,
+		  struct evt_entry_array *ent_array,
+		  struct vos_coalesce_run *run)
+{
+	struct evt_rect	range = run->cr_rect;
+	int		rc = 0;
+
+	/* no extent is newer than the run, see recx_coalesce_scan() */
+	range.rc_epc_lo = 0;
+	range.rc_epc_hi = DAOS_EPOCH_MAX;
+
+	TX_BEGIN(vos_obj2pop(obj)) {
+		/* copy data before the old extents are freed */
+		rc = recx_coalesce_copy(vos_obj2umm(obj), ent_array, run);
+		if (rc != 0)
+			pmemobj_tx_abort(rc);
+
+		rc = evt_delete_range(toh, EVT_DEL_WRITTEN, &range, NULL);
+		if (rc != 0)
+			pmemobj_tx_abort(rc);
+
+		rc = evt_insert(toh, run->cr_cookie, run->cr_ver,
+				&run->cr_rect, run->cr_inob, run->cr_mmid,
+				&run->cr_csum);
+		if (rc != 0)
+			pmemobj_tx_abort(rc);
+	} TX_ONABORT {
+		rc = umem_tx_errno(rc);
+		D__ERROR("Failed to coalesce %u extents: %d\n", run->cr_nr,
+			 rc);
+	} TX_END
+
+	return rc;
+}
+
+/**
+ * Rewrite the record extents of \a akey which are not newer than \a epoch:
+ * adjacent visible extents are merged into extents of up to
+ * VOS_COALESCE_NOB_MAX bytes, and versions hidden by them are dropped. Each
+ * merged run is rewritten by its own transaction, other extents are kept.
+ * The akey is skipped if it has any extent newer than \a epoch.
+ *
+ * Number of extents rewritten is consumed from \a credits, the rest of the
+ * runs are left to a later call once they are used up.
+ */
+int
+vos_obj_coalesce(struct vos_object *obj, daos_key_t *dkey, daos_key_t *akey,
+		 daos_epoch_t epoch, unsigned int *credits)
+{
+	struct evt_entry_array	*ent_array = vos_ent_array_get();
+	struct vos_coalesce_run	*runs = NULL;
+	daos_epoch_range_t	 epr;
+	struct evt_rect		 rect;
+	daos_handle_t		 dk_toh;
+	daos_handle_t		 ak_toh;
+	unsigned int		 ext_nr;
+	unsigned int		 run_nr = 0;
+	unsigned int		 runs_size = 0;
+	unsigned int		 merged = 0;
+	unsigned int		 coalesced = 0;
+	int			 i;
+	int			 rc;
+
+	rc = vos_obj_tree_init(obj);
+	if (rc != 0)
+		return rc;
+
+	epr.epr_lo = epr.epr_hi = epoch;
+	rc = tree_prepare(obj, &epr, obj->obj_toh, VOS_BTR_DKEY, dkey, 0,
+			  &dk_toh);
+	if (rc != 0)
+		return rc == -DER_NONEXIST ? 0 : rc;
+
+	rc = tree_prepare(obj, &epr, dk_toh, VOS_BTR_AKEY, akey, SUBTR_EVT,
+			  &ak_toh);
+	if (rc != 0)
+		D__GOTO(out_dkey, rc = (rc == -DER_NONEXIST ? 0 : rc));
+
+	rc = recx_coalesce_scan(ak_toh, epoch, &rect, &ext_nr);
+	if (rc != 0 || ext_nr < 2)
+		D__GOTO(out_akey, rc);
+
+	rc = evt_find(ak_toh, &rect, ent_array);
+	if (rc != 0)
+		D__GOTO(out_akey, rc);
+
+	runs_size = ent_array->ea_ent_nr * sizeof(*runs);
+	D__ALLOC(runs, runs_size);
+	if (runs == NULL)
+		D__GOTO(out_akey, rc = -DER_NOMEM);
+
+	run_nr = recx_coalesce_plan(ent_array, runs);
+	if (run_nr == ent_array->ea_ent_nr) /* nothing to merge */
+		D__GOTO(out_akey, rc = 0);
+
+	rc = recx_coalesce_check(ak_toh, runs, run_nr);
+	if (rc != 0)
+		D__GOTO(out_akey, rc);
+
+	for (i = 0; i < run_nr && *credits > 0; i++) {
+		if (runs[i].cr_nr < 2 || runs[i].cr_skip)
+			continue;
+
+		rc = recx_coalesce_run(obj, ak_toh, ent_array, &runs[i]);
+		if (rc != 0)
+			break;
+
+		*credits -= min(*credits, runs[i].cr_nr);
+		coalesced += runs[i].cr_nr;
+		merged++;
+	}
+
+	if (merged > 0) {
+		D__DEBUG(DB_EPC, "Coalesced %u extents to %u\n", coalesced,
+			 merged);
+		daos_metric_inc(DMC_VOS_COALESCE, coalesced - merged);
+	}
+	D_EXIT;
+ out_akey:
+	if (runs != NULL)
+		D__FREE(runs, runs_size);
+	tree_release(ak_toh, true);
+ out_dkey:
+	tree_release(dk_toh, false);
+	return rc;
+}
+
+/**
+ * @} vos_obj_coalesce
+ */
+
+/**
+ * @defgroup vos_obj_purge functions to purge versions of an akey
+ * @{
+ */
+
+/** Open both the single value btree and the evtree of \a akey */
+static int
+akey_trees_open(struct vos_object *obj, daos_epoch_range_t *epr,
+		daos_key_t *dkey, daos_key_t *akey, daos_handle_t *sv_toh,
+		daos_handle_t *ev_toh)
+{
+	daos_handle_t	dk_toh;
+	int		rc;
+
+	rc = vos_obj_tree_init(obj);
+	if (rc != 0)
+		return rc;
+
+	rc = tree_prepare(obj, epr, obj->obj_toh, VOS_BTR_DKEY, dkey, 0,
+			  &dk_toh);
+	if (rc != 0)
+		return rc;
+
+	rc = tree_prepare(obj, epr, dk_toh, VOS_BTR_AKEY, akey, 0, sv_toh);
+	if (rc != 0)
+		D__GOTO(out, rc);
+
+	rc = tree_prepare(obj, epr, dk_toh, VOS_BTR_AKEY, akey, SUBTR_EVT,
+			  ev_toh);
+	if (rc != 0)
+		tree_release(*sv_toh, false);
+	D_EXIT;
+ out:
+	tree_release(dk_toh, false);
+	return rc;
+}
+
+/** Close the trees opened by akey_trees_open(), return true if both empty */
+static bool
+akey_trees_close(daos_handle_t sv_toh, daos_handle_t ev_toh)
+{
+	bool	empty;
+
+	empty = dbtree_is_empty(sv_toh) == 1 && evt_is_empty(ev_toh) == 1;
+	tree_release(ev_toh, true);
+	tree_release(sv_toh, false);
+	return empty;
+}
+
+/** Delete all the single values written within [\a lo, \a hi] */
+static int
+singv_delete_range(daos_handle_t toh, daos_epoch_t lo, daos_epoch_t hi)
+{
+	struct vos_key_bundle	kbund_lo;
+	struct vos_key_bundle	kbund_hi;
+	daos_epoch_range_t	epr_lo;
+	daos_epoch_range_t	epr_hi;
+	daos_iov_t		kiov_lo;
+	daos_iov_t		kiov_hi;
+
+	D__DEBUG(DB_EPC, "Delete single values ["DF_U64", "DF_U64"]\n",
+		 lo, hi);
+
+	epr_lo.epr_lo = epr_lo.epr_hi = lo;
+	tree_key_bundle2iov(&kbund_lo, &kiov_lo);
+	kbund_lo.kb_epr = &epr_lo;
+
+	epr_hi.epr_lo = epr_hi.epr_hi = hi;
+	tree_key_bundle2iov(&kbund_hi, &kiov_hi);
+	kbund_hi.kb_epr = &epr_hi;
+
+	return dbtree_delete_range(toh, &kiov_lo, &kiov_hi, NULL);
+}
+
+/**
+ * Find the first run of adjacent single values written by \a cookie within
+ * [\a lo, \a hi], the run is returned in \a run, and \a lo is set to the
+ * epoch to start the next search. \a run::epr_lo is larger than
+ * \a run::epr_hi if there is no such a run.
+ *
+ * \return	1 if the search has reached \a hi, 0 if there could be more
+ *		runs, negative value if error.
+ */
+static int
+singv_cookie_run(daos_handle_t toh, uuid_t cookie, daos_epoch_t *lo,
+		 daos_epoch_t hi, daos_epoch_range_t *run)
+{
+	struct vos_key_bundle	kbund;
+	struct vos_rec_bundle	rbund;
+	daos_epoch_range_t	epr;
+	daos_csum_buf_t		csum;
+	daos_iov_t		kiov;
+	daos_iov_t		riov;
+	daos_iov_t		diov;
+	daos_handle_t		ih;
+	int			rc;
+
+	run->epr_lo = DAOS_EPOCH_MAX;
+	run->epr_hi = 0;
+
+	rc = dbtree_iter_prepare(toh, BTR_ITER_EMBEDDED, &ih);
+	if (rc != 0)
+		return rc;
+
+	tree_key_bundle2iov(&kbund, &kiov);
+	kbund.kb_epr = &epr;
+	epr.epr_lo = epr.epr_hi = *lo;
+
+	tree_rec_bundle2iov(&rbund, &riov);
+	rbund.rb_iov  = &diov;
+	rbund.rb_csum = &csum;
+
+	rc = dbtree_iter_probe(ih, BTR_PROBE_GE, &kiov, NULL);
+	while (rc == 0) {
+		daos_iov_set(&diov, NULL, 0);
+		daos_csum_set(&csum, NULL, 0);
+		rc = dbtree_iter_fetch(ih, &kiov, &riov, NULL);
+		if (rc != 0)
+			break;
+
+		if (epr.epr_lo > hi) {
+			rc = 1;
+			break;
+		}
+
+		if (uuid_compare(rbund.rb_cookie, cookie) == 0) {
+			if (run->epr_lo > run->epr_hi)
+				run->epr_lo = epr.epr_lo;
+			run->epr_hi = epr.epr_lo;
+
+		} else if (run->epr_lo <= run->epr_hi) {
+			/* end of the run, the next search skips this one */
+			*lo = epr.epr_lo + 1;
+			break;
+		}
+		rc = dbtree_iter_next(ih);
+	}
+	dbtree_iter_finish(ih);
+
+	return rc == -DER_NONEXIST ? 1 : rc;
+}
+
+/**
+ * Discard all versions of \a akey written by \a cookie within \a epr. Each
+ * run of adjacent single values of the cookie is deleted as a range, record
+ * extents are deleted by one walk of the evtree. \a empty is set to true if
+ * nothing is left under the akey.
+ */
+int
+vos_obj_discard_akey(struct vos_object *obj, daos_key_t *dkey,
+		     daos_key_t *akey, daos_epoch_range_t *epr, uuid_t cookie,
+		     bool *empty)
+{
+	struct evt_rect		rect;
+	daos_epoch_range_t	run;
+	daos_epoch_t		lo;
+	daos_handle_t		sv_toh;
+	daos_handle_t		ev_toh;
+	bool			done;
+	int			rc;
+
+	*empty = false;
+	rc = akey_trees_open(obj, epr, dkey, akey, &sv_toh, &ev_toh);
+	if (rc != 0)
+		return rc == -DER_NONEXIST ? 0 : rc;
+
+	lo = epr->epr_lo;
+	do {
+		rc = singv_cookie_run(sv_toh, cookie, &lo, epr->epr_hi, &run);
+		if (rc < 0)
+			D__GOTO(out, rc);
+
+		done = (rc == 1);
+		rc = 0;
+		if (run.epr_lo <= run.epr_hi)
+			rc = singv_delete_range(sv_toh, run.epr_lo, run.epr_hi);
+	} while (rc == 0 && !done);
+
+	if (rc != 0)
+		D__GOTO(out, rc);
+
+	rect.rc_off_lo = 0;
+	rect.rc_off_hi = ~0ULL;
+	rect.rc_epc_lo = epr->epr_lo;
+	rect.rc_epc_hi = epr->epr_hi;
+
+	TX_BEGIN(vos_obj2pop(obj)) {
+		rc = evt_delete_range(ev_toh, EVT_DEL_WRITTEN, &rect, cookie);
+		if (rc != 0)
+			pmemobj_tx_abort(rc);
+	} TX_ONABORT {
+		rc = umem_tx_errno(rc);
+		D__ERROR("Failed to discard extents: %d\n", rc);
+	} TX_END
+	D_EXIT;
+ out:
+	*empty = akey_trees_close(sv_toh, ev_toh);
+	return rc;
+}
+
+/**
+ * Aggregate versions of \a akey within \a epr: the single values hidden by
+ * the latest one within \a epr are deleted as a range, so are the record
+ * extents fully overwritten within \a epr. \a empty is set to true if
+ * nothing is left under the akey.
+ */
+int
+vos_obj_aggregate_akey(struct vos_object *obj, daos_key_t *dkey,
+		       daos_key_t *akey, daos_epoch_range_t *epr, bool *empty)
 {
-	PMEMobjpool	  *pop;
-	struct vos_object *obj;
-	int		   rc;
+	struct vos_key_bundle	kbund;
+	struct vos_rec_bundle	rbund;
+	daos_epoch_range_t	latest;
+	daos_csum_buf_t		csum;
+	struct evt_rect		rect;
+	daos_iov_t		kiov;
+	daos_iov_t		riov;
+	daos_iov_t		diov;
+	daos_handle_t		sv_toh;
+	daos_handle_t		ev_toh;
+	int			rc;
 
-	D__DEBUG(DB_IO, "Punch "DF_UOID", cookie "DF_UUID" epoch "
-		DF_U64"\n", DP_UOID(oid), DP_UUID(cookie), epoch);
+	*empty = false;
+	rc = akey_trees_open(obj, epr, dkey, akey, &sv_toh, &ev_toh);
+	if (rc != 0)
+		return rc == -DER_NONEXIST ? 0 : rc;
 
-	rc = vos_obj_hold(vos_obj_cache_current(), coh, oid, epoch, true,
-			  &obj);
+	/* the latest single value within the range is kept */
+	tree_key_bundle2iov(&kbund, &kiov);
+	kbund.kb_epr = &latest;
+	latest.epr_lo = latest.epr_hi = epr->epr_hi;
+
+	tree_rec_bundle2iov(&rbund, &riov);
+	rbund.rb_iov  = &diov;
+	rbund.rb_csum = &csum;
+	daos_iov_set(&diov, NULL, 0);
+	daos_csum_set(&csum, NULL, 0);
+
+	rc = dbtree_fetch(sv_toh, BTR_PROBE_LE, &kiov, &kiov, &riov);
+	if (rc == 0 && latest.epr_lo > epr->epr_lo)
+		rc = singv_delete_range(sv_toh, epr->epr_lo, latest.epr_lo - 1);
+	else if (rc == -DER_NONEXIST)
+		rc = 0;
 	if (rc != 0)
-		return rc;
+		D__GOTO(out, rc);
 
-	if (vos_obj_is_empty(obj)) /* nothing to do */
+	if (epr->epr_lo == epr->epr_hi)
 		D__GOTO(out, rc = 0);
 
-	pop = vos_obj2pop(obj);
-	TX_BEGIN(pop) {
-		if (dkey) { /* key punch */
-			rc = key_punch(obj, epoch, cookie, pm_ver, dkey,
-				       akey_nr, akeys);
-		} else { /* object punch */
-			rc = obj_punch(coh, obj, epoch, cookie);
-		}
+	rect.rc_off_lo = 0;
+	rect.rc_off_hi = ~0ULL;
+	rect.rc_epc_lo = epr->epr_lo;
+	rect.rc_epc_hi = epr->epr_hi;
 
+	TX_BEGIN(vos_obj2pop(obj)) {
+		rc = evt_delete_range(ev_toh, EVT_DEL_OVERWRITTEN, &rect, NULL);
+		if (rc != 0)
+			pmemobj_tx_abort(rc);
 	} TX_ONABORT {
 		rc = umem_tx_errno(rc);
-		D__DEBUG(DB_IO, "Failed to punch object: %d\n", rc);
+		D__ERROR("Failed to aggregate extents: %d\n", rc);
 	} TX_END
 	D_EXIT;
  out:
-	vos_obj_release(vos_obj_cache_current(), obj);
+	*empty = akey_trees_close(sv_toh, ev_toh);
 	return rc;
 }
 
 /**
- * @} vos_obj_io_func
+ * @} vos_obj_purge
  */
 
 /*
@@ -1221,6 +2077,16 @@ vos_zcc_free_iobuf(struct vos_zc_context *zcc, bool has_tx, int err)
 	     iobuf < &zcc->zc_iobufs[zcc->zc_iod_nr]; iobuf++) {
 
 		daos_sgl_fini(&iobuf->db_sgl, false);
+		if (iobuf->db_inline != NULL) {
+			D__FREE(iobuf->db_inline, iobuf->db_inline_size);
+			iobuf->db_inline = NULL;
+		}
+
+		if (iobuf->db_csums != NULL) {
+			D__FREE(iobuf->db_csums,
+				iobuf->db_mmid_nr * sizeof(*iobuf->db_csums));
+		}
+
 		if (iobuf->db_mmids == NULL)
 			continue;
 
@@ -1345,6 +2211,7 @@ vos_obj_zc_fetch_begin(daos_handle_t coh, daos_unit_oid_t oid,
 		       daos_handle_t *ioh)
 {
 	struct vos_zc_context *zcc;
+	uint64_t	       start = daos_metric_tick();
 	int		       i;
 	int		       rc;
 
@@ -1363,6 +2230,7 @@ vos_obj_zc_fetch_begin(daos_handle_t coh, daos_unit_oid_t oid,
 
 	D__DEBUG(DB_IO, "Prepared zcbufs for fetching %d iods\n", iod_nr);
 	*ioh = vos_zcc2ioh(zcc);
+	daos_metric_tock(DMH_VOS_FETCH, start);
 	return 0;
  failed:
 	vos_obj_zc_fetch_end(vos_zcc2ioh(zcc), dkey, iod_nr, iods, rc);
@@ -1429,6 +2297,8 @@ akey_zc_update_begin(struct vos_zc_context *zcc, int iod_idx)
 	struct vos_object	*obj = zcc->zc_obj;
 	daos_iod_t		*iod = &zcc->zc_iods[iod_idx];
 	struct iod_buf		*iobuf = &zcc->zc_iobufs[iod_idx];
+	daos_csum_buf_t		 csum;
+	int			 cs_type = vos_csum_type();
 	int	i;
 	int	rc;
 
@@ -1446,6 +2316,25 @@ akey_zc_update_begin(struct vos_zc_context *zcc, int iod_idx)
 	if (rc != 0)
 		return -DER_NOMEM;
 
+	daos_csum_set(&csum, NULL, 0);
+	if (cs_type != DAOS_CSUM_NONE) {
+		D__ALLOC(iobuf->db_csums,
+			 iod->iod_nr * sizeof(*iobuf->db_csums));
+		if (iobuf->db_csums == NULL)
+			return -DER_NOMEM;
+
+		for (i = 0; i < iod->iod_nr; i++)
+			daos_csum_init(&iobuf->db_csums[i], cs_type);
+
+		/* space of checksum is reserved in the record of single
+		 * value, it is filled by vos_obj_zc_update_end().
+		 */
+		if (iod->iod_size != 0) {
+			csum.cs_type = cs_type;
+			csum.cs_len = daos_csum_type2size(cs_type);
+		}
+	}
+
 	for (i = 0; i < iod->iod_nr; i++) {
 		void		*addr;
 		umem_id_t	 mmid;
@@ -1454,7 +2343,7 @@ akey_zc_update_begin(struct vos_zc_context *zcc, int iod_idx)
 		if (iod->iod_type == DAOS_IOD_SINGLE) {
 			struct vos_irec_df *irec;
 
-			size = vos_recx2irec_size(iod->iod_size, NULL);
+			size = vos_recx2irec_size(iod->iod_size, &csum);
 
 			mmid = vos_zc_reserve(zcc, size);
 			if (UMMID_IS_NULL(mmid))
@@ -1465,8 +2354,8 @@ akey_zc_update_begin(struct vos_zc_context *zcc, int iod_idx)
 			 */
 			irec = (struct vos_irec_df *)
 				umem_id2ptr(vos_obj2umm(obj), mmid);
-			irec->ir_cs_size = 0;
-			irec->ir_cs_type = 0;
+			irec->ir_cs_size = csum.cs_len;
+			irec->ir_cs_type = csum.cs_type;
 
 			addr = vos_irec2data(irec);
 			size = iod->iod_size;
@@ -1552,6 +2441,60 @@ vos_obj_zc_update_begin(daos_handle_t coh, daos_unit_oid_t oid,
 	return rc;
 }
 
+/**
+ * Publish the reserved buffers of a zero-copy update, it should be called
+ * within the transaction which indexes the update. The buffers are cancelled
+ * if the transaction is aborted.
+ */
+static int
+vos_zcc_publish(struct vos_zc_context *zcc)
+{
+	if (zcc->zc_actv_at == 0)
+		return 0;
+
+	D__DEBUG(DB_IO, "Publish ZC reservation\n");
+	return umem_tx_publish(vos_obj2umm(zcc->zc_obj), zcc->zc_actv,
+			       zcc->zc_actv_at);
+}
+
+/**
+ * Index the records of a zero-copy update, it should be called within a
+ * transaction. The I/O buffers are rewound first, so the update can be
+ * indexed again after the transaction is aborted.
+ */
+static int
+vos_zcc_index(struct vos_zc_context *zcc, uuid_t cookie, uint32_t pm_ver,
+	      daos_key_t *dkey, unsigned int iod_nr, daos_iod_t *iods)
+{
+	int	i;
+
+	for (i = 0; i < zcc->zc_iod_nr; i++) {
+		zcc->zc_iobufs[i].db_at = 0;
+		zcc->zc_iobufs[i].db_iov_off = 0;
+	}
+
+	D__DEBUG(DB_IO, "Submit ZC update\n");
+	return dkey_update(zcc->zc_obj, zcc->zc_epoch, cookie, pm_ver, dkey,
+			   iod_nr, iods, NULL, zcc);
+}
+
+/**
+ * Publish the reserved buffers of a zero-copy update and index its records,
+ * it should be called within a transaction.
+ */
+static int
+vos_zcc_submit(struct vos_zc_context *zcc, uuid_t cookie, uint32_t pm_ver,
+	       daos_key_t *dkey, unsigned int iod_nr, daos_iod_t *iods)
+{
+	int	rc;
+
+	rc = vos_zcc_publish(zcc);
+	if (rc != 0)
+		return rc;
+
+	return vos_zcc_index(zcc, cookie, pm_ver, dkey, iod_nr, iods);
+}
+
 /**
  * Submit the current zero-copy I/O operation to VOS and release responding
  * resources.
@@ -1563,6 +2506,7 @@ vos_obj_zc_update_end(daos_handle_t ioh, uuid_t cookie, uint32_t pm_ver,
 {
 	struct vos_zc_context	*zcc = vos_ioh2zcc(ioh);
 	PMEMobjpool		*pop;
+	uint64_t		 start = daos_metric_tick();
 
 	D__ASSERT(zcc->zc_is_update);
 	if (err != 0)
@@ -1577,25 +2521,138 @@ vos_obj_zc_update_end(daos_handle_t ioh, uuid_t cookie, uint32_t pm_ver,
 	pop = vos_obj2pop(zcc->zc_obj);
 
 	TX_BEGIN(pop) {
-		if (zcc->zc_actv_at != 0) {
-			D__DEBUG(DB_IO, "Publish ZC reservation\n");
-			err = umem_tx_publish(vos_obj2umm(zcc->zc_obj),
-					      zcc->zc_actv, zcc->zc_actv_at);
-		}
-		D__DEBUG(DB_IO, "Submit ZC update\n");
-		err = dkey_update(zcc->zc_obj, zcc->zc_epoch, cookie,
-				  pm_ver, dkey, iod_nr, iods, NULL, zcc);
+		err = vos_zcc_submit(zcc, cookie, pm_ver, dkey, iod_nr, iods);
 	} TX_ONABORT {
 		err = umem_tx_errno(err);
 		D__DEBUG(DB_IO, "Failed to submit ZC update: %d\n", err);
 	} TX_END
 
+	daos_metric_tock(DMH_VOS_UPDATE, start);
 	D_EXIT;
  out:
 	vos_zcc_destroy(zcc, err);
 	return err;
 }
 
+/** Pool of a pending update of the group, NULL if it has been finished */
+static PMEMobjpool *
+vos_zc_update2pop(struct vos_zc_update *update)
+{
+	if (daos_handle_is_inval(update->zu_ioh))
+		return NULL;
+
+	return vos_obj2pop(vos_ioh2zcc(update->zu_ioh)->zc_obj);
+}
+
+/** Release a member of the group and account it as one update */
+static void
+vos_zc_update_finish(struct vos_zc_update *update, uint64_t start)
+{
+	vos_zcc_destroy(vos_ioh2zcc(update->zu_ioh), update->zu_rc);
+	update->zu_ioh = DAOS_HDL_INVAL;
+	daos_metric_tock(DMH_VOS_UPDATE, start);
+}
+
+void
+vos_obj_zc_update_end_group(struct vos_zc_update *updates, unsigned int nr)
+{
+	struct vos_zc_update	*upd;
+	struct vos_zc_context	*zcc;
+	PMEMobjpool		*pop;
+	uint64_t		 start = daos_metric_tick();
+	volatile int		 failed;
+	volatile int		 rc;
+	int			 i;
+	int			 j;
+
+	for (i = 0; i < nr; i++) {
+		upd = &updates[i];
+		zcc = vos_ioh2zcc(upd->zu_ioh);
+		D__ASSERT(zcc->zc_is_update && zcc->zc_obj != NULL);
+		if (upd->zu_rc == 0)
+			upd->zu_rc = vos_obj_revalidate(vos_obj_cache_current(),
+							zcc->zc_epoch,
+							&zcc->zc_obj);
+		if (upd->zu_rc != 0)
+			vos_zc_update_finish(upd, start);
+	}
+
+	for (i = 0; i < nr; i++) {
+		pop = vos_zc_update2pop(&updates[i]);
+		if (pop == NULL) /* failed or submitted already */
+			continue;
+
+again:
+		/*
+		 * One transaction for all pending updates of this pool. If an
+		 * update fails, the transaction is aborted so none of its
+		 * changes is committed, then the others are submitted again
+		 * without it. An abort which is not returned by an update,
+		 * e.g. PMDK aborts the transaction if it runs out of space,
+		 * is blamed on the update being indexed.
+		 *
+		 * Reserved buffers are published after all updates have been
+		 * indexed, they are cancelled by an abort after publishing,
+		 * so the updates cannot be submitted again.
+		 */
+		rc = 0;
+		failed = -1;
+		TX_BEGIN(pop) {
+			for (j = i; j < nr; j++) {
+				upd = &updates[j];
+				if (vos_zc_update2pop(upd) != pop)
+					continue;
+
+				failed = j;
+				upd->zu_rc = vos_zcc_index(
+					vos_ioh2zcc(upd->zu_ioh),
+					upd->zu_cookie, upd->zu_pm_ver,
+					upd->zu_dkey, upd->zu_iod_nr,
+					upd->zu_iods);
+				if (upd->zu_rc != 0)
+					pmemobj_tx_abort(upd->zu_rc);
+			}
+			failed = -1;
+
+			for (j = i; j < nr; j++) {
+				upd = &updates[j];
+				if (vos_zc_update2pop(upd) != pop)
+					continue;
+
+				rc = vos_zcc_publish(vos_ioh2zcc(upd->zu_ioh));
+				if (rc != 0)
+					pmemobj_tx_abort(rc);
+			}
+		} TX_ONABORT {
+			rc = umem_tx_errno(rc);
+			D__DEBUG(DB_IO, "Failed to submit ZC group: %d\n", rc);
+		} TX_END
+
+		if (failed >= 0) {
+			if (updates[failed].zu_rc == 0)
+				updates[failed].zu_rc = rc;
+			vos_zc_update_finish(&updates[failed], start);
+			if (vos_zc_update2pop(&updates[i]) != NULL)
+				goto again;
+			for (j = i + 1; j < nr; j++) {
+				if (vos_zc_update2pop(&updates[j]) == pop)
+					goto again;
+			}
+			continue;
+		}
+
+		for (j = i; j < nr; j++) {
+			upd = &updates[j];
+			if (vos_zc_update2pop(upd) != pop)
+				continue;
+
+			if (rc != 0)
+				upd->zu_rc = rc;
+			vos_zc_update_finish(upd, start);
+		}
+	}
+}
+
 int
 vos_obj_zc_sgl_at(daos_handle_t ioh, unsigned int idx, daos_sg_list_t **sgl_pp)
 {
@@ -1613,6 +2670,24 @@ vos_obj_zc_sgl_at(daos_handle_t ioh, unsigned int idx, daos_sg_list_t **sgl_pp)
 	return 0;
 }
 
+int
+vos_obj_zc_csum_at(daos_handle_t ioh, unsigned int idx,
+		   struct daos_csum_ctx **csums_pp)
+{
+	struct vos_zc_context *zcc = vos_ioh2zcc(ioh);
+
+	D__ASSERT(zcc->zc_iobufs != NULL);
+	if (idx >= zcc->zc_iod_nr) {
+		*csums_pp = NULL;
+		D__DEBUG(DB_IO, "Invalid iod index %d/%d.\n",
+			idx, zcc->zc_iod_nr);
+		return -DER_NONEXIST;
+	}
+
+	*csums_pp = zcc->zc_iobufs[idx].db_csums;
+	return 0;
+}
+
 /**
  * @} vos_obj_zio_func
  */
@@ -1649,6 +2724,31 @@ key_iter_fetch(struct vos_obj_iter *oiter, vos_iter_entry_t *ent,
 	return dbtree_iter_fetch(oiter->it_hdl, &kiov, &riov, anchor);
 }
 
+static inline bool
+key_iter_reverse(struct vos_obj_iter *oiter)
+{
+	return oiter->it_flags & VOS_IT_KEY_REVERSE;
+}
+
+static inline bool
+key_iter_has_prefix(struct vos_obj_iter *oiter, daos_key_t *key)
+{
+	daos_key_t	*prefix = &oiter->it_key_prefix;
+
+	return key->iov_len >= prefix->iov_len &&
+	       memcmp(key->iov_buf, prefix->iov_buf, prefix->iov_len) == 0;
+}
+
+/** move to the next record in the iteration order */
+static int
+key_iter_move(struct vos_obj_iter *oiter)
+{
+	if (key_iter_reverse(oiter))
+		return dbtree_iter_prev(oiter->it_hdl);
+	else
+		return dbtree_iter_next(oiter->it_hdl);
+}
+
 /**
  * Check if the current entry can match the iterator condition, this function
  * retuns IT_OPC_NOOP for true, returns IT_OPC_NEXT or IT_OPC_PROBE if further
@@ -1656,7 +2756,8 @@ key_iter_fetch(struct vos_obj_iter *oiter, vos_iter_entry_t *ent,
  * probed and its epoch range are also returned to @ent.
  */
 static int
-key_iter_match(struct vos_obj_iter *oiter, vos_iter_entry_t *ent)
+key_iter_match(struct vos_obj_iter *oiter, vos_iter_entry_t *ent,
+	       daos_hash_out_t *anchor)
 {
 	struct vos_object	*obj = oiter->it_obj;
 	daos_epoch_range_t	*epr = &oiter->it_epr;
@@ -1665,13 +2766,42 @@ key_iter_match(struct vos_obj_iter *oiter, vos_iter_entry_t *ent)
 	daos_handle_t		 toh;
 	daos_iov_t		 kiov;
 	daos_iov_t		 riov;
+	bool			 below;
 	int			 iop;
 	int			 rc;
 
-	rc = key_iter_fetch(oiter, ent, NULL);
+	rc = key_iter_fetch(oiter, ent, anchor);
 	if (rc)
 		D__GOTO(out, iop = rc);
 
+	/* check key range of the ordered key tree */
+	if (oiter->it_key_lo.iov_len != 0 &&
+	    vos_key_cmp_ordered(oiter->it_key_feats, &ent->ie_key,
+				&oiter->it_key_lo) < 0) {
+		D__GOTO(out, iop = key_iter_reverse(oiter) ?
+			-DER_NONEXIST : IT_OPC_NEXT);
+	}
+
+	if (oiter->it_key_hi.iov_len != 0 &&
+	    vos_key_cmp_ordered(oiter->it_key_feats, &ent->ie_key,
+				&oiter->it_key_hi) > 0) {
+		D__GOTO(out, iop = key_iter_reverse(oiter) ?
+			IT_OPC_NEXT : -DER_NONEXIST);
+	}
+
+	/* check key prefix */
+	if (oiter->it_key_prefix.iov_len != 0 &&
+	    !key_iter_has_prefix(oiter, &ent->ie_key)) {
+		if (!(oiter->it_key_feats & VOS_KEY_CMP_LEXICAL))
+			D__GOTO(out, iop = IT_OPC_NEXT);
+
+		/* keys with the prefix are contiguous in a lexical tree */
+		below = vos_key_cmp_ordered(oiter->it_key_feats, &ent->ie_key,
+					    &oiter->it_key_prefix) < 0;
+		D__GOTO(out, iop = below == key_iter_reverse(oiter) ?
+			-DER_NONEXIST : IT_OPC_NEXT);
+	}
+
 	/* check epoch condition */
 	iop = IT_OPC_NOOP;
 	if (ent->ie_epr.epr_hi < epr->epr_lo) {
@@ -1688,6 +2818,10 @@ key_iter_match(struct vos_obj_iter *oiter, vos_iter_entry_t *ent)
 		}
 	}
 
+	/* NB: no cheap way to probe backward, just move to the previous one */
+	if (iop == IT_OPC_PROBE && key_iter_reverse(oiter))
+		iop = IT_OPC_NEXT;
+
 	if (iop != IT_OPC_NOOP)
 		D__GOTO(out, iop); /* not in the range, need further operation */
 
@@ -1724,19 +2858,24 @@ out:
 /**
  * Check if the current item can match the provided condition (with the
  * giving a-key). If the item can't match the condition, this function
- * traverses the tree until a matched item is found.
+ * traverses the tree until a matched item is found. The matched item and
+ * its anchor are returned to the optional \a ent and \a anchor.
  */
 static int
-key_iter_find_match(struct vos_obj_iter *oiter)
+key_iter_find_match(struct vos_obj_iter *oiter, vos_iter_entry_t *ent,
+		    daos_hash_out_t *anchor)
 {
-	int	rc;
+	vos_iter_entry_t	entry;
+	int			rc;
+
+	if (ent == NULL)
+		ent = &entry;
 
 	while (1) {
-		vos_iter_entry_t	entry;
 		struct vos_key_bundle	kbund;
 		daos_iov_t		kiov;
 
-		rc = key_iter_match(oiter, &entry);
+		rc = key_iter_match(oiter, ent, anchor);
 		switch (rc) {
 		default:
 			D_ERROR("match failed, rc=%d\n", rc);
@@ -1750,8 +2889,8 @@ key_iter_find_match(struct vos_obj_iter *oiter)
 		case IT_OPC_PROBE:
 			/* probe the returned key and epoch range */
 			tree_key_bundle2iov(&kbund, &kiov);
-			kbund.kb_key	= &entry.ie_key;
-			kbund.kb_epr	= &entry.ie_epr;
+			kbund.kb_key	= &ent->ie_key;
+			kbund.kb_epr	= &ent->ie_epr;
 			rc = dbtree_iter_probe(oiter->it_hdl, BTR_PROBE_GE,
 					       &kiov, NULL);
 			if (rc)
@@ -1760,7 +2899,7 @@ key_iter_find_match(struct vos_obj_iter *oiter)
 
 		case IT_OPC_NEXT:
 			/* move to the next tree record */
-			rc = dbtree_iter_next(oiter->it_hdl);
+			rc = key_iter_move(oiter);
 			if (rc)
 				D__GOTO(out, rc);
 			break;
@@ -1774,15 +2913,45 @@ key_iter_find_match(struct vos_obj_iter *oiter)
 static int
 key_iter_probe(struct vos_obj_iter *oiter, daos_hash_out_t *anchor)
 {
-	int	rc;
+	struct vos_key_bundle	 kbund;
+	daos_epoch_range_t	 epr;
+	daos_iov_t		 kiov;
+	daos_iov_t		*key = NULL;
+	dbtree_probe_opc_t	 opc;
+	int			 rc;
+
+	if (anchor != NULL) {
+		opc = key_iter_reverse(oiter) ? BTR_PROBE_LE : BTR_PROBE_GE;
+
+	} else if (key_iter_reverse(oiter)) {
+		opc = BTR_PROBE_LAST;
+		if (oiter->it_key_hi.iov_len != 0) {
+			/* the last version of the upper bound */
+			opc = BTR_PROBE_LE;
+			kbund.kb_key = &oiter->it_key_hi;
+			epr.epr_lo = epr.epr_hi = DAOS_EPOCH_MAX;
+		}
+	} else {
+		opc = BTR_PROBE_FIRST;
+		if (oiter->it_key_lo.iov_len != 0) {
+			/* the first version of the lower bound */
+			opc = BTR_PROBE_GE;
+			kbund.kb_key = &oiter->it_key_lo;
+			epr.epr_lo = epr.epr_hi = 0;
+		}
+	}
+
+	if (anchor == NULL && opc & BTR_PROBE_EQ) {
+		tree_key_bundle2iov(&kbund, &kiov);
+		kbund.kb_epr = &epr;
+		key = &kiov;
+	}
 
-	rc = dbtree_iter_probe(oiter->it_hdl,
-			       anchor ? BTR_PROBE_GE : BTR_PROBE_FIRST,
-			       NULL, anchor);
+	rc = dbtree_iter_probe(oiter->it_hdl, opc, key, anchor);
 	if (rc)
 		D__GOTO(out, rc);
 
-	rc = key_iter_find_match(oiter);
+	rc = key_iter_find_match(oiter, NULL, NULL);
 	if (rc)
 		D__GOTO(out, rc);
 	D_EXIT;
@@ -1795,11 +2964,11 @@ key_iter_next(struct vos_obj_iter *oiter)
 {
 	int	rc;
 
-	rc = dbtree_iter_next(oiter->it_hdl);
+	rc = key_iter_move(oiter);
 	if (rc)
 		D__GOTO(out, rc);
 
-	rc = key_iter_find_match(oiter);
+	rc = key_iter_find_match(oiter, NULL, NULL);
 	if (rc)
 		D__GOTO(out, rc);
 	D_EXIT;
@@ -1807,16 +2976,110 @@ out:
 	return rc;
 }
 
+/**
+ * Matching a key already fetches it, so the keys found by moving the cursor
+ * are returned straight away instead of being fetched again.
+ */
+static int
+key_iter_fetch_batch(struct vos_obj_iter *oiter, vos_iter_entry_t *entries,
+		     daos_hash_out_t *anchors, unsigned int *nr)
+{
+	int	i;
+	int	rc;
+
+	rc = key_iter_fetch(oiter, &entries[0], anchors);
+	if (rc) {
+		*nr = 0;
+		return rc;
+	}
+
+	for (i = 1; i <= *nr; i++) {
+		rc = key_iter_move(oiter);
+		if (rc)
+			break;
+
+		if (i == *nr) /* only move the cursor past the last one */
+			rc = key_iter_find_match(oiter, NULL, NULL);
+		else
+			rc = key_iter_find_match(oiter, &entries[i],
+						 anchors ? &anchors[i] : NULL);
+		if (rc)
+			break;
+	}
+	*nr = min(i, *nr);
+	return rc;
+}
+
+/**
+ * Delete the current key of a snapshot iterator from the key tree, the
+ * iterator still points to the key, so it can move on without re-probing.
+ */
+static int
+key_iter_delete(struct vos_obj_iter *oiter, void *args)
+{
+	vos_iter_entry_t	ent;
+	struct vos_key_bundle	kbund;
+	daos_iov_t		kiov;
+	int			rc;
+
+	rc = key_iter_fetch(oiter, &ent, NULL);
+	if (rc != 0)
+		return rc;
+
+	tree_key_bundle2iov(&kbund, &kiov);
+	kbund.kb_key	= &ent.ie_key;
+	kbund.kb_epr	= &ent.ie_epr;
+
+	rc = dbtree_delete(oiter->it_toh, &kiov, args);
+	if (rc == -DER_NONEXIST) /* changed since the snapshot */
+		rc = 0;
+	return rc;
+}
+
+/**
+ * Prepare the iterator on a snapshot of the key tree \a oiter::it_toh, the
+ * snapshot is released when the iterator is finished.
+ */
+static int
+key_iter_snapshot(struct vos_obj_iter *oiter)
+{
+	daos_handle_t	snap_toh;
+	int		rc;
+
+	rc = dbtree_snapshot(oiter->it_toh, &snap_toh);
+	if (rc != 0) {
+		D__ERROR("Cannot take snapshot of the key tree: %d\n", rc);
+		return rc;
+	}
+
+	rc = dbtree_iter_prepare(snap_toh, BTR_ITER_EMBEDDED, &oiter->it_hdl);
+	dbtree_close(snap_toh);
+	return rc;
+}
+
 /**
  * Iterator for the d-key tree.
  */
 static int
 dkey_iter_prepare(struct vos_obj_iter *oiter, daos_key_t *akey)
 {
+	struct vos_object	*obj = oiter->it_obj;
+	int			 rc;
+
 	/* optional condition, d-keys with the provided attribute (a-key) */
 	oiter->it_akey = *akey;
+	oiter->it_key_feats = obj->obj_df->vo_tree.tr_feats & VOS_KEY_CMP_MASK;
+
+	if (!(oiter->it_flags & VOS_IT_SNAPSHOT))
+		return dbtree_iter_prepare(obj->obj_toh, 0, &oiter->it_hdl);
+
+	/* the iterator owns an open handle to delete keys */
+	rc = dbtree_open_inplace(&obj->obj_df->vo_tree, vos_obj2uma(obj),
+				 &oiter->it_toh);
+	if (rc != 0)
+		return rc;
 
-	return dbtree_iter_prepare(oiter->it_obj->obj_toh, 0, &oiter->it_hdl);
+	return key_iter_snapshot(oiter);
 }
 
 /**
@@ -1826,6 +3089,7 @@ static int
 akey_iter_prepare(struct vos_obj_iter *oiter, daos_key_t *dkey)
 {
 	struct vos_object	*obj = oiter->it_obj;
+	struct btr_attr		 attr;
 	daos_handle_t		 toh;
 	int			 rc;
 
@@ -1836,6 +3100,18 @@ akey_iter_prepare(struct vos_obj_iter *oiter, daos_key_t *dkey)
 		return rc;
 	}
 
+	rc = dbtree_query(toh, &attr, NULL);
+	if (rc) {
+		tree_release(toh, false);
+		return rc;
+	}
+	oiter->it_key_feats = attr.ba_feats & VOS_KEY_CMP_MASK;
+
+	if (oiter->it_flags & VOS_IT_SNAPSHOT) {
+		oiter->it_toh = toh; /* released by vos_obj_iter_fini */
+		return key_iter_snapshot(oiter);
+	}
+
 	/* see BTR_ITER_EMBEDDED for the details */
 	rc = dbtree_iter_prepare(toh, BTR_ITER_EMBEDDED, &oiter->it_hdl);
 	if (rc)
@@ -2197,6 +3473,7 @@ recx_iter_fetch(struct vos_obj_iter *oiter, vos_iter_entry_t *it_entry,
 	it_entry->ie_recx.rx_idx = rect->rc_off_lo;
 	it_entry->ie_recx.rx_nr	 = rect->rc_off_hi - rect->rc_off_lo + 1;
 	it_entry->ie_rsize	 = entry.en_inob;
+	it_entry->ie_csum	 = entry.en_csum;
 	uuid_copy(it_entry->ie_cookie, entry.en_cookie);
 	it_entry->ie_ver	= entry.en_ver;
  out:
@@ -2233,12 +3510,13 @@ vos_obj_iter_prep(vos_iter_type_t type, vos_iter_param_t *param,
 		return -DER_NOMEM;
 
 	oiter->it_epr = param->ip_epr;
+	oiter->it_flags = param->ip_flags;
 	/* XXX the condition epoch ranges could cover multiple versions of
 	 * the object/key if it's punched more than once.
 	 */
-	rc = vos_obj_hold(vos_obj_cache_current(), param->ip_hdl,
-			  param->ip_oid, param->ip_epr.epr_hi, true,
-			  &oiter->it_obj);
+	rc = vos_obj_hold_cold(vos_obj_cache_current(), param->ip_hdl,
+			       param->ip_oid, param->ip_epr.epr_hi, true,
+			       &oiter->it_obj);
 	if (rc != 0)
 		D__GOTO(failed, rc);
 
@@ -2279,6 +3557,34 @@ vos_obj_iter_prep(vos_iter_type_t type, vos_iter_param_t *param,
 	if (rc != 0)
 		D__GOTO(failed, rc);
 
+	if (param->ip_key_lo.iov_len != 0 || param->ip_key_hi.iov_len != 0 ||
+	    param->ip_flags & VOS_IT_KEY_REVERSE) {
+		/* key range and order are only meaningful for ordered keys */
+		if ((type != VOS_ITER_DKEY && type != VOS_ITER_AKEY) ||
+		    oiter->it_key_feats == 0) {
+			D__ERROR("Key range/order requires ordered key tree\n");
+			D__GOTO(failed, rc = -DER_INVAL);
+		}
+		oiter->it_key_lo = param->ip_key_lo;
+		oiter->it_key_hi = param->ip_key_hi;
+	}
+
+	if (param->ip_key_prefix.iov_len != 0) {
+		if (type != VOS_ITER_DKEY && type != VOS_ITER_AKEY) {
+			D__ERROR("Key prefix is only for key iterators\n");
+			D__GOTO(failed, rc = -DER_INVAL);
+		}
+		oiter->it_key_prefix = param->ip_key_prefix;
+
+		/* start from the prefix if it is above the lower bound */
+		if ((oiter->it_key_feats & VOS_KEY_CMP_LEXICAL) &&
+		    (oiter->it_key_lo.iov_len == 0 ||
+		     vos_key_cmp_ordered(oiter->it_key_feats,
+					 &oiter->it_key_lo,
+					 &oiter->it_key_prefix) < 0))
+			oiter->it_key_lo = oiter->it_key_prefix;
+	}
+
 	*iter_pp = &oiter->it_iter;
 	return 0;
  failed:
@@ -2312,6 +3618,10 @@ vos_obj_iter_fini(struct vos_iterator *iter)
 		break;
 	}
  out:
+	/* after the snapshot is released by the iterator */
+	if (!daos_handle_is_inval(oiter->it_toh))
+		dbtree_close(oiter->it_toh);
+
 	if (oiter->it_obj != NULL)
 		vos_obj_release(vos_obj_cache_current(), oiter->it_obj);
 
@@ -2386,6 +3696,27 @@ vos_obj_iter_fetch(struct vos_iterator *iter, vos_iter_entry_t *it_entry,
 	}
 }
 
+static int
+vos_obj_iter_fetch_batch(struct vos_iterator *iter, vos_iter_entry_t *entries,
+			 daos_hash_out_t *anchors, unsigned int *nr)
+{
+	struct vos_obj_iter *oiter = vos_iter2oiter(iter);
+
+	switch (iter->it_type) {
+	default:
+		D__ASSERT(0);
+		return -DER_INVAL;
+
+	case VOS_ITER_DKEY:
+	case VOS_ITER_AKEY:
+		return key_iter_fetch_batch(oiter, entries, anchors, nr);
+
+	case VOS_ITER_SINGLE:
+	case VOS_ITER_RECX:
+		return -DER_NOSYS; /* one by one */
+	}
+}
+
 static int
 obj_iter_delete(struct vos_obj_iter *oiter, void *args)
 {
@@ -2396,7 +3727,10 @@ obj_iter_delete(struct vos_obj_iter *oiter, void *args)
 	pop = vos_obj2pop(oiter->it_obj);
 
 	TX_BEGIN(pop) {
-		rc = dbtree_iter_delete(oiter->it_hdl, args);
+		if (daos_handle_is_inval(oiter->it_toh))
+			rc = dbtree_iter_delete(oiter->it_hdl, args);
+		else
+			rc = key_iter_delete(oiter, args);
 	} TX_ONABORT {
 		rc = umem_tx_errno(rc);
 		D__ERROR("Failed to delete iter entry: %d\n", rc);
@@ -2440,6 +3774,9 @@ vos_obj_iter_empty(struct vos_iterator *iter)
 	case VOS_ITER_DKEY:
 	case VOS_ITER_AKEY:
 	case VOS_ITER_SINGLE:
+		/* the snapshot doesn't see keys deleted by the iterator */
+		if (!daos_handle_is_inval(oiter->it_toh))
+			return dbtree_is_empty(oiter->it_toh);
 		return dbtree_iter_empty(oiter->it_hdl);
 	case VOS_ITER_RECX:
 		return -DER_NOSYS;
@@ -2452,6 +3789,7 @@ struct vos_iter_ops	vos_obj_iter_ops = {
 	.iop_probe	= vos_obj_iter_probe,
 	.iop_next	= vos_obj_iter_next,
 	.iop_fetch	= vos_obj_iter_fetch,
+	.iop_fetch_batch = vos_obj_iter_fetch_batch,
 	.iop_delete	= vos_obj_iter_delete,
 	.iop_empty	= vos_obj_iter_empty,
 };
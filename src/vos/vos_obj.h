@@ -66,6 +66,16 @@ vos_obj_hold(struct daos_lru_cache *occ, daos_handle_t coh,
 	     daos_unit_oid_t oid, daos_epoch_t epoch,
 	     bool no_create, struct vos_object **obj_p);
 
+/**
+ * Same as vos_obj_hold, but it does not promote the object in the cache,
+ * it is for iterators and aggregation which scan many objects once, so they
+ * do not flush the frequently accessed objects out of the cache.
+ */
+int
+vos_obj_hold_cold(struct daos_lru_cache *occ, daos_handle_t coh,
+		  daos_unit_oid_t oid, daos_epoch_t epoch,
+		  bool no_create, struct vos_object **obj_p);
+
 /**
  * Release the object cache reference.
  *
@@ -27,10 +27,10 @@
  * index API defined for PMEM are used here by the cache..
  *
  * LRU cache implementation:
- * Simple LRU based object cache for Object index table
- * Uses a hashtable and a doubly linked list to set and get
- * entries. The size of both hashtable and linked list are
- * fixed length.
+ * Scan-resistant 2Q cache for Object index table, see daos_lru_cache.
+ * Uses a hashtable and doubly linked lists to set and get
+ * entries. The size of hashtable is fixed, the number of cached
+ * objects can be changed by vos_obj_cache_resize().
  *
  * Author: Vishwanath Venkatesan <vishwanath.venkatesan@intel.com>
  */
@@ -42,6 +42,7 @@
 #include <vos_obj.h>
 #include <vos_internal.h>
 #include <daos_errno.h>
+#include <daos/metrics.h>
 
 /**
  * Local type for VOS LRU key
@@ -188,19 +189,28 @@ vos_obj_cache_current(void)
 	return vos_get_obj_cache();
 }
 
+void
+vos_obj_cache_resize(unsigned int size)
+{
+	daos_lru_cache_resize(vos_obj_cache_current(), size);
+}
+
 void
 vos_obj_release(struct daos_lru_cache *occ, struct vos_object *obj)
 {
+	uint64_t	evictions;
 
 	D__ASSERT((occ != NULL) && (obj != NULL));
+	evictions = occ->dlc_stats.ls_evictions;
 	daos_lru_ref_release(occ, &obj->obj_llink);
+	daos_metric_inc(DMC_VOS_OBJ_EVICT,
+			occ->dlc_stats.ls_evictions - evictions);
 }
 
-
-int
-vos_obj_hold(struct daos_lru_cache *occ, daos_handle_t coh,
-	     daos_unit_oid_t oid, daos_epoch_t epoch,
-	     bool no_create, struct vos_object **obj_p)
+static int
+obj_cache_hold(struct daos_lru_cache *occ, daos_handle_t coh,
+	       daos_unit_oid_t oid, daos_epoch_t epoch, bool no_create,
+	       bool cold, struct vos_object **obj_p)
 {
 
 	struct vos_object	*obj = NULL;
@@ -221,7 +231,12 @@ vos_obj_hold(struct daos_lru_cache *occ, daos_handle_t coh,
 	lkey.olk_obj_id = oid;
 
 	while (1) {
-		rc = daos_lru_ref_hold(occ, &lkey, sizeof(lkey), cont, &lret);
+		if (cold)
+			rc = daos_lru_ref_hold_cold(occ, &lkey, sizeof(lkey),
+						    cont, &lret);
+		else
+			rc = daos_lru_ref_hold(occ, &lkey, sizeof(lkey), cont,
+					       &lret);
 		if (rc)
 			D__GOTO(failed, rc);
 
@@ -230,8 +245,10 @@ vos_obj_hold(struct daos_lru_cache *occ, daos_handle_t coh,
 			break;
 
 		if (obj->obj_df->vo_epc_lo <= epoch &&
-		    obj->obj_df->vo_epc_hi >= epoch)
+		    obj->obj_df->vo_epc_hi >= epoch) {
+			daos_metric_inc(DMC_VOS_OBJ_HIT, 1);
 			D__GOTO(found, rc = 0);
+		}
 
 		D__DEBUG(DB_IO, "Evict obj ["DF_U64":"DF_U64" -> "DF_U64"]\n",
 			obj->obj_df->vo_epc_lo, obj->obj_df->vo_epc_hi, epoch);
@@ -246,6 +263,7 @@ vos_obj_hold(struct daos_lru_cache *occ, daos_handle_t coh,
 	}
 	D__DEBUG(DB_TRACE, "%s durable object in epoch="DF_U64"\n",
 		no_create ? "find" : "find/create", epoch);
+	daos_metric_inc(DMC_VOS_OBJ_MISS, 1);
 
 	if (no_create) {
 		rc = vos_oi_find(cont, oid, epoch, &obj->obj_df);
@@ -269,6 +287,22 @@ failed:
 	return	rc;
 }
 
+int
+vos_obj_hold(struct daos_lru_cache *occ, daos_handle_t coh,
+	     daos_unit_oid_t oid, daos_epoch_t epoch,
+	     bool no_create, struct vos_object **obj_p)
+{
+	return obj_cache_hold(occ, coh, oid, epoch, no_create, false, obj_p);
+}
+
+int
+vos_obj_hold_cold(struct daos_lru_cache *occ, daos_handle_t coh,
+		  daos_unit_oid_t oid, daos_epoch_t epoch,
+		  bool no_create, struct vos_object **obj_p)
+{
+	return obj_cache_hold(occ, coh, oid, epoch, no_create, true, obj_p);
+}
+
 void
 vos_obj_evict(struct vos_object *obj)
 {
@@ -44,6 +44,8 @@ struct vos_oid_iter {
 	daos_epoch_range_t	oit_epr;
 	/* Reference to the container */
 	struct vos_container	*oit_cont;
+	/** iterate the dirty object table instead of the OI table */
+	bool			 oit_dirty;
 };
 
 #define OHKEY_LEN		16
@@ -157,10 +159,20 @@ obj_df_rec_free(struct btr_instance *tins, struct btr_record *rec, void *args)
 
 		umem_attr_get(&tins->ti_umm, &uma);
 		rc = dbtree_open_inplace(&vobj->vo_tree, &uma, &toh);
-		if (rc != 0)
+		if (rc != 0) {
 			D__ERROR("Failed to open KV tree: %d\n", rc);
-		else
-			dbtree_destroy(toh);
+		} else {
+			rc = dbtree_destroy(toh);
+			if (rc != 0) {
+				/* keep the object, e.g. the KV tree root is
+				 * pinned by a snapshot.
+				 */
+				D__DEBUG(DB_TRACE, "Failed to destroy KV tree: "
+					 "%d\n", rc);
+				dbtree_close(toh);
+				return rc;
+			}
+		}
 	}
 	umem_free_typed(umm, obj_mmid);
 	return rc;
@@ -362,9 +374,13 @@ oiter_prep(vos_iter_type_t type, vos_iter_param_t *param,
 
 	oid_iter->oit_epr  = param->ip_epr;
 	oid_iter->oit_cont = cont;
+	/* fall back to the object index if there is no dirty object table */
+	oid_iter->oit_dirty = (param->ip_flags & VOS_IT_OBJ_DIRTY) &&
+			      !daos_handle_is_inval(cont->vc_dtab_hdl);
 	vos_cont_addref(cont);
 
-	rc = dbtree_iter_prepare(cont->vc_btr_hdl, 0, &oid_iter->oit_hdl);
+	rc = dbtree_iter_prepare(oid_iter->oit_dirty ? cont->vc_dtab_hdl :
+				 cont->vc_btr_hdl, 0, &oid_iter->oit_hdl);
 	if (rc)
 		D__GOTO(exit, rc);
 
@@ -375,6 +391,37 @@ exit:
 	return rc;
 }
 
+/**
+ * Dirty table version of oiter_probe_match(), there is only one record for
+ * each object, so just skip the objects not modified within the epoch range.
+ */
+static int
+oiter_dirty_match(struct vos_oid_iter *oiter)
+{
+	daos_epoch_range_t	*epr = &oiter->oit_epr;
+	int			 rc;
+
+	while (1) {
+		struct vos_dirty_obj_df	*dobj;
+		daos_iov_t		 iov;
+
+		daos_iov_set(&iov, NULL, 0);
+		rc = dbtree_iter_fetch(oiter->oit_hdl, NULL, &iov, NULL);
+		if (rc != 0)
+			return rc;
+
+		D__ASSERT(iov.iov_len == sizeof(struct vos_dirty_obj_df));
+		dobj = (struct vos_dirty_obj_df *)iov.iov_buf;
+		if (dobj->do_epc_hi >= epr->epr_lo &&
+		    dobj->do_epc_lo <= epr->epr_hi)
+			return 0;
+
+		rc = dbtree_iter_next(oiter->oit_hdl);
+		if (rc != 0)
+			return rc;
+	}
+}
+
 /**
  * This function checks if the current object can match the condition, it
  * returns immediately on true, otherwise it will move the iterator cursor
@@ -391,6 +438,9 @@ oiter_probe_match(struct vos_iterator *iter)
 	    oiter->oit_epr.epr_hi == DAOS_EPOCH_MAX)
 		D__GOTO(out, rc = 0); /* no condition */
 
+	if (oiter->oit_dirty)
+		D__GOTO(out, rc = oiter_dirty_match(oiter));
+
 	while (1) {
 		struct vos_obj_df	*obj_df;
 		struct vos_obj_key	 key;
@@ -515,6 +565,18 @@ oiter_fetch(struct vos_iterator *iter, vos_iter_entry_t *it_entry,
 		return rc;
 	}
 
+	if (oid_iter->oit_dirty) {
+		struct vos_dirty_obj_df	*dobj;
+
+		D__ASSERT(rec_iov.iov_len == sizeof(struct vos_dirty_obj_df));
+		dobj = (struct vos_dirty_obj_df *)rec_iov.iov_buf;
+
+		it_entry->ie_oid = dobj->do_id;
+		it_entry->ie_epr.epr_lo = dobj->do_epc_lo;
+		it_entry->ie_epr.epr_hi = dobj->do_epc_hi;
+		return 0;
+	}
+
 	D__ASSERT(rec_iov.iov_len == sizeof(struct vos_obj_df));
 	obj_df = (struct vos_obj_df *)rec_iov.iov_buf;
 
@@ -526,6 +588,46 @@ oiter_fetch(struct vos_iterator *iter, vos_iter_entry_t *it_entry,
 	return 0;
 }
 
+/**
+ * Delete the object version held by the purge context (the one covering the
+ * upper bound of the epoch range) from the OI table, the dirty record is
+ * only removed after the last version of the object has gone.
+ */
+static int
+oiter_dirty_delete(struct vos_oid_iter *oiter)
+{
+	struct vos_container	*cont = oiter->oit_cont;
+	struct vos_obj_key	 okey;
+	daos_iov_t		 kiov;
+	daos_iov_t		 viov;
+	int			 rc;
+
+	daos_iov_set(&viov, NULL, 0);
+	rc = dbtree_iter_fetch(oiter->oit_hdl, NULL, &viov, NULL);
+	if (rc != 0)
+		return rc;
+
+	okey.o_oid = ((struct vos_dirty_obj_df *)viov.iov_buf)->do_id;
+	okey.o_epc_lo = okey.o_epc_hi = oiter->oit_epr.epr_hi;
+	daos_iov_set(&kiov, &okey, sizeof(okey));
+
+	rc = dbtree_delete(cont->vc_btr_hdl, &kiov, NULL);
+	if (rc != 0 && rc != -DER_NONEXIST)
+		return rc;
+
+	/* any other version of this object? */
+	okey.o_epc_lo = 0;
+	okey.o_epc_hi = DAOS_EPOCH_MAX;
+	daos_iov_set(&viov, NULL, 0);
+	rc = dbtree_lookup(cont->vc_btr_hdl, &kiov, &viov);
+	if (rc == 0)
+		return 0;
+	if (rc != -DER_NONEXIST)
+		return rc;
+
+	return dbtree_iter_delete(oiter->oit_hdl, NULL);
+}
+
 static int
 oiter_delete(struct vos_iterator *iter, void *args)
 {
@@ -537,7 +639,12 @@ oiter_delete(struct vos_iterator *iter, void *args)
 	pop = vos_cont2pop(oiter->oit_cont);
 
 	TX_BEGIN(pop) {
-		rc = dbtree_iter_delete(oiter->oit_hdl, args);
+		if (oiter->oit_dirty)
+			rc = oiter_dirty_delete(oiter);
+		else
+			rc = dbtree_iter_delete(oiter->oit_hdl, args);
+		if (rc != 0)
+			pmemobj_tx_abort(rc);
 	} TX_ONABORT {
 		rc = umem_tx_errno(rc);
 		D__ERROR("Failed to delete oid entry: %d\n", rc);
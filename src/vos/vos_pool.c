@@ -96,7 +96,7 @@ pool_alloc(uuid_t uuid, struct vos_pool **pool_p)
 	uuid_copy(pool->vp_id, uuid);
 
 	memset(&uma, 0, sizeof(uma));
-	uma.uma_id = UMEM_CLASS_VMEM;
+	uma.uma_id = UMEM_CLASS_VMEM_SLAB;
 	/* Create a cookie index table in DRAM */
 	rc = vos_cookie_tab_create(&uma, &pool->vp_cookie_tab,
 				    &pool->vp_cookie_th);
@@ -205,6 +205,7 @@ vos_pool_create(const char *path, uuid_t uuid, daos_size_t size)
 			pmemobj_tx_abort(EFAULT);
 
 		uuid_copy(pool_df->pd_id, uuid);
+		pool_df->pd_incompat_flags = VOS_POOL_INCOMPAT_DIRTY_TAB;
 		pool_df->pd_pool_info.pif_size  = size;
 		/* XXX we don't really maintain the available size */
 		pool_df->pd_pool_info.pif_avail = size - pmemobj_root_size(ph);
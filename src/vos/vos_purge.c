@@ -29,6 +29,7 @@
 #define DDSUBSYS	DDFAC(vos)
 
 #include <daos/btree.h>
+#include <daos/metrics.h>
 #include <daos_srv/vos.h>
 #include <vos_internal.h>
 
@@ -44,16 +45,14 @@ struct purge_context {
 	uuid_t			 pc_cookie;
 	/** recursive iterator parameters */
 	vos_iter_param_t	 pc_param;
+	/** coalesce record extents of akeys instead of aggregating */
+	bool			 pc_coalesce;
 };
 
 enum { /* iterator operation code */
 	ITR_NEXT		= (1 << 0),
 	/** Probe the first node */
 	ITR_PROBE_FIRST		= (1 << 1),
-	/** Probe a specific anchor */
-	ITR_PROBE_ANCHOR	= (1 << 2),
-	/** Max iterator probe anchor (recx) */
-	ITR_MAX_PROBE_ANCHOR	= (1 << 3),
 	/** Reuse iterator (for restarting) */
 	ITR_REUSE_ANCHOR	= (1 << 4),
 };
@@ -109,14 +108,18 @@ purge_ctx_init(struct purge_context *pcx, vos_iter_entry_t *ent)
 		 *   range.
 		 * - discard: discard new versions and the punch operations.
 		 */
-		rc = vos_obj_hold(vos_obj_cache_current(), param->ip_hdl,
-				  ent->ie_oid, param->ip_epr.epr_hi, true,
-				  &pcx->pc_obj);
+		rc = vos_obj_hold_cold(vos_obj_cache_current(), param->ip_hdl,
+				       ent->ie_oid, param->ip_epr.epr_hi, true,
+				       &pcx->pc_obj);
 		if (rc != 0)
 			break;
 		param->ip_oid = ent->ie_oid;
 		daos_iov_set(&param->ip_dkey, NULL, 0);
 		daos_iov_set(&param->ip_akey, NULL, 0);
+		/* key iterators scan snapshots of the key trees, so they
+		 * move on without re-probing after deleting a key.
+		 */
+		param->ip_flags |= VOS_IT_SNAPSHOT;
 		pcx->pc_pop  = vos_obj2pop(pcx->pc_obj);
 		pcx->pc_type = VOS_ITER_DKEY;
 		break;
@@ -384,73 +387,33 @@ purge_ctx_set_complete(struct purge_context *pcx, bool *finish,
 }
 
 /**
- * Recx aggregation uses a additional max_iterator which always tracks and
- * retains the max epoch in the {recx, epoch} tree. This approach is used
- * to avoid issues with unsorted cases with EV-Tree. This function probes
- * the max iterators for recx on different scenarios.
- */
-/**
- * max-iter probing during different types of iterations:
- * ITR_NEXT requires max ih probe only when recx's are different. In all
- * other case max-iter needs to be probed.
- * FIRST		: to set the max_iter
- * ITR_MAX_PROBE	: max_iter is deleted
- * ITR_PROBE		: need to reset max_iter while setting anchor as
- *			  well as while deleting a record pointed but
- *			  regular iterator max iterator pos is changed.
- *			  NB: If reverse iteration is used
- *			  this additional probe is skipped.
- *
- * ITR_NEXT && entries	: probe max_iter on itr_next only when ent && ent_max
- *			  are pointing to different recx's.
+ * Aggregate all versions of the akey of \a pcx in one go, it costs one
+ * credit. See vos_obj_aggregate_akey() for the details.
  */
 static int
-recx_max_iter_probe(int opc, vos_iter_entry_t *ent, vos_iter_entry_t *ent_max,
-		    vos_purge_anchor_t *vp_anchor, daos_hash_out_t *anchor,
-		    vos_it_epc_expr_t epc, daos_handle_t *ih_max)
+akey_aggregate(struct purge_context *pcx, int *empty_ret,
+	       unsigned int *credits_ret, vos_purge_anchor_t *vp_anchor)
 {
+	vos_iter_param_t	*param = &pcx->pc_param;
+	bool			 empty;
+	int			 rc;
 
-	int	rc = 0;
-	char	*opstr;
-	bool	it_reverse_skip;
-
-	it_reverse_skip = ((epc == VOS_IT_EPC_RR) && (opc & ITR_PROBE_ANCHOR));
-
-	if ((opc & ITR_NEXT) || it_reverse_skip)
-		return 0;
-
-	if (opc & ITR_REUSE_ANCHOR) {
-		opstr = "probe max-iter from max_anchor";
-		rc = vos_iter_probe(*ih_max, &vp_anchor->pa_recx_max);
-	} else {
-		/*
-		 * ITR_PROBE_FIRST, ITR_NEXT, ITR_PROBE_MAX_ANCHOR,
-		 * ITR_PROBE_ANCHOR
-		 */
-		opstr  = "probe max-iter hdl";
-		rc = vos_iter_probe(*ih_max, anchor);
-	}
-
-	/**
-	 * No need to check for -DER_NONEXIST, max_iterator
-	 * will never overtake regular iterator
-	 */
-	if (rc == 0) {
-		opstr = "fetch max-iter entry";
-		rc = vos_iter_fetch(*ih_max, ent_max, &vp_anchor->pa_recx_max);
-	}
+	rc = vos_obj_aggregate_akey(pcx->pc_obj, &param->ip_dkey,
+				    &param->ip_akey, &param->ip_epr, &empty);
+	if (rc != 0)
+		return rc;
 
-	if (rc != 0) {
-		D__ERROR("%s max-iterator failed to %s: %d\n",
-			vos_iter_type2name(VOS_ITER_SINGLE), opstr, rc);
-	}
-	return rc;
+	(*credits_ret)--;
+	purge_ctx_set_complete(pcx, NULL, vp_anchor);
+	if (empty_ret != NULL)
+		*empty_ret = empty;
+	return 0;
 }
 
 /**
  * core function of aggregation, similar to discard recursively enter
- * different trees and delete the leaf record or retain based on the
- * epoch in the epoch-range. recx aggregation is done in recx_epoch_aggregate
+ * different trees and delete empty subtrees, versions of each akey are
+ * aggregated by akey_aggregate.
  */
 int
 epoch_aggregate(struct purge_context *pcx, int *empty_ret,
@@ -460,11 +423,9 @@ epoch_aggregate(struct purge_context *pcx, int *empty_ret,
 	int			rc = 0;
 	int			aggregated, found;
 	int			opc;
-	daos_handle_t		ih, ih_max;
+	daos_handle_t		ih;
 	daos_hash_out_t		anchor;
-	vos_iter_entry_t	ent_max;
 	unsigned int		credits = *credits_ret;
-	bool			val_tree = (pcx->pc_type == VOS_ITER_SINGLE);
 
 
 	D__DEBUG(DB_EPC, "Enter %s iterator with credits: %u\n", pcx_name(pcx),
@@ -478,6 +439,9 @@ epoch_aggregate(struct purge_context *pcx, int *empty_ret,
 	if (purge_ctx_test_complete(pcx, finish, vp_anchor))
 		return 0;
 
+	if (pcx->pc_type == VOS_ITER_SINGLE)
+		return akey_aggregate(pcx, empty_ret, credits_ret, vp_anchor);
+
 	if (purge_ctx_anchor_is_set(pcx, vp_anchor)) {
 
 		D__DEBUG(DB_EPC, "Probing from existing %s iterator\n",
@@ -500,33 +464,14 @@ epoch_aggregate(struct purge_context *pcx, int *empty_ret,
 		return rc;
 	}
 
-	if (val_tree) {
-		/** prepare the max iterator */
-		rc = vos_iter_prepare(pcx->pc_type, &pcx->pc_param, &ih_max);
-		if (rc == -DER_NONEXIST) {
-			D__DEBUG(DB_EPC, "Exit from empty %s.\n", pcx_name(pcx));
-			return 0;
-		}
-
-		if (rc != 0) {
-			D__ERROR("Failed to create %s max_iterator: %d\n",
-				pcx_name(pcx), rc);
-			return rc;
-		}
-		memset(&ent_max, 0, sizeof(vos_iter_entry_t));
-	}
-
 	for (aggregated = found = 0; true;) {
 
 		vos_iter_entry_t	ent;
-		daos_handle_t		*del_hdl;
 		char			*opstr;
 		int			empty = 0;
-		bool			max_reset = false;
 		bool			it_first = (opc & ITR_PROBE_FIRST);
 		bool			it_reuse = (opc & ITR_REUSE_ANCHOR);
 		bool			it_next  = (opc & ITR_NEXT);
-		bool			it_max   = (opc & ITR_MAX_PROBE_ANCHOR);
 
 		if (it_first) {
 			opstr = "probe_first";
@@ -542,20 +487,12 @@ epoch_aggregate(struct purge_context *pcx, int *empty_ret,
 			purge_ctx_reset_complete(pcx, vp_anchor);
 
 		} else {
-			/*
-			 * ITR_PROBE_ANCHOR, ITR_MAX_PROBE_ANCHOR,
-			 * ITR_REUSE_ANCHOR
-			 */
+			/* ITR_REUSE_ANCHOR */
 			opstr = "probe_anchor";
 			rc = vos_iter_probe(ih, &anchor);
 		}
 
-		/*
-		 * Skip fetch while probing for max iterator
-		 * after deleting max_iterator.
-		 * Use the entry from previous fetch.
-		 */
-		if (rc == 0 && !it_max) {
+		if (rc == 0) {
 			opstr = "fetch";
 			rc = vos_iter_fetch(ih, &ent, &anchor);
 		}
@@ -575,15 +512,6 @@ epoch_aggregate(struct purge_context *pcx, int *empty_ret,
 			D__GOTO(out, rc);
 		}
 
-		if (val_tree) {
-			rc = recx_max_iter_probe(opc, &ent, &ent_max,
-						 vp_anchor, &anchor,
-						 pcx->pc_param.ip_epc_expr,
-						 &ih_max);
-			if (rc != 0)
-				D__GOTO(out, rc);
-		}
-
 		if (!credits) {
 			purge_ctx_anchor_ctl(pcx, vp_anchor, &anchor,
 					     ANCHOR_SET);
@@ -591,16 +519,27 @@ epoch_aggregate(struct purge_context *pcx, int *empty_ret,
 		}
 
 		/* Probing REUSED_ANCHOR should not be counted for credits */
-		if (!it_max && !it_reuse) {
+		if (!it_reuse) {
 			found++;
 			credits--;
 		}
 
-		if (pcx->pc_type == VOS_ITER_SINGLE) {
-			/* Delete the record pointed to by regular iterator */
-			empty = (ent_max.ie_epr.epr_lo != ent.ie_epr.epr_lo);
-			/* Delete the record pinter by max iterator */
-			max_reset = (ent_max.ie_epr.epr_lo < ent.ie_epr.epr_lo);
+		if (pcx->pc_coalesce &&
+		    pcx->pc_type == VOS_ITER_AKEY) {
+			/* rewrite extents of the akey, nothing to delete */
+			rc = vos_obj_coalesce(pcx->pc_obj,
+					      &pcx->pc_param.ip_dkey,
+					      &ent.ie_key,
+					      pcx->pc_param.ip_epr.epr_hi,
+					      &credits);
+			if (rc != 0)
+				D__GOTO(out, rc);
+
+			if (!credits) { /* the akey may have more to merge */
+				purge_ctx_anchor_ctl(pcx, vp_anchor, &anchor,
+						     ANCHOR_SET);
+				D__GOTO(out, rc);
+			}
 		} else {
 			rc = purge_ctx_init(pcx, &ent);
 			if (rc != 0) {
@@ -628,23 +567,8 @@ epoch_aggregate(struct purge_context *pcx, int *empty_ret,
 			continue;
 		}
 
-		/*
-		 * if current position is greater than max
-		 * delete the max iterator and move to the next
-		 * rec in epr.
-		 *
-		 * else: delete current pos if < max and probe.
-		 */
-		if (max_reset) {
-			del_hdl = &ih_max;
-			opc = ITR_MAX_PROBE_ANCHOR;
-		} else {
-			del_hdl = &ih;
-			opc = ITR_PROBE_ANCHOR;
-		}
-
 		TX_BEGIN(pcx->pc_pop) {
-			rc = vos_iter_delete(*del_hdl, NULL);
+			rc = vos_iter_delete(ih, NULL);
 			if (rc != 0) {
 				D__DEBUG(DB_EPC, "Failed to delete %s: %d\n",
 					pcx_name(pcx), rc);
@@ -660,6 +584,8 @@ epoch_aggregate(struct purge_context *pcx, int *empty_ret,
 
 		/* Number of keys aggregated in this tree ctx */
 		aggregated++;
+		/* the snapshot iterator still points to the deleted key */
+		opc = ITR_NEXT;
 	}
 
 	if (rc == 0 && empty_ret != NULL) {
@@ -668,9 +594,6 @@ epoch_aggregate(struct purge_context *pcx, int *empty_ret,
 		rc = 0;
 	}
 out:
-	if (rc == 0 && val_tree)
-		vos_iter_finish(ih_max);
-
 	*credits_ret = credits;
 	D__DEBUG(DB_EPC,
 		"aggregated %d, found: %d %s(s) rem credits: %u\n",
@@ -680,9 +603,28 @@ out:
 	return rc;
 }
 
+/**
+ * Discard all versions of the akey of \a pcx written by the cookie to
+ * discard. See vos_obj_discard_akey() for the details.
+ */
+static int
+akey_discard(struct purge_context *pcx, int *empty_ret)
+{
+	vos_iter_param_t	*param = &pcx->pc_param;
+	bool			 empty;
+	int			 rc;
+
+	rc = vos_obj_discard_akey(pcx->pc_obj, &param->ip_dkey,
+				  &param->ip_akey, &param->ip_epr,
+				  pcx->pc_cookie, &empty);
+	if (rc == 0 && empty_ret != NULL)
+		*empty_ret = empty;
+	return rc;
+}
+
 /*
  * Core function of discard, it can recursively enter different trees, and
- * delete the leaf record, or empty subtree.
+ * delete empty subtrees, versions of each akey are discarded by akey_discard.
  */
 static int
 epoch_discard(struct purge_context *pcx, int *empty_ret)
@@ -694,6 +636,9 @@ epoch_discard(struct purge_context *pcx, int *empty_ret)
 	int		opc;
 	int		rc;
 
+	if (pcx->pc_type == VOS_ITER_SINGLE)
+		return akey_discard(pcx, empty_ret);
+
 	D__DEBUG(DB_EPC, "Enter %s iterator\n", pcx_name(pcx));
 
 	rc = vos_iter_prepare(pcx->pc_type, &pcx->pc_param, &ih);
@@ -711,17 +656,13 @@ epoch_discard(struct purge_context *pcx, int *empty_ret)
 
 	for (discarded = found = 0; true; ) {
 		char		 *opstr;
-		int		  empty;
+		int		  empty = 0;
 		vos_iter_entry_t  ent;
 
 		if (opc == ITR_PROBE_FIRST) {
 			opstr = "probe_first";
 			rc = vos_iter_probe(ih, NULL);
 
-		} else if (opc == ITR_PROBE_ANCHOR) {
-			opstr = "probe_anchor";
-			rc = vos_iter_probe(ih, &anchor);
-
 		} else { /* ITR_NEXT */
 			opstr = "next";
 			rc = vos_iter_next(ih);
@@ -745,26 +686,21 @@ epoch_discard(struct purge_context *pcx, int *empty_ret)
 		}
 
 		found++;
-		if (pcx->pc_type == VOS_ITER_SINGLE) {
-			/* the last level tree */
-			empty = !uuid_compare(ent.ie_cookie, pcx->pc_cookie);
-		} else {
-			/* prepare the context for the subtree */
-			rc = purge_ctx_init(pcx, &ent);
-			if (rc != 0) {
-				D__DEBUG(DB_EPC, "%s context enter failed: %d\n",
-					pcx_name(pcx), rc);
-				D__GOTO(out, rc);
-			}
-
-			/* enter the subtree */
-			rc = epoch_discard(pcx, &empty);
-			/* exit from the context of subtree */
-			purge_ctx_fini(pcx, rc);
-			if (rc != 0)
-				D__GOTO(out, rc);
+		/* prepare the context for the subtree */
+		rc = purge_ctx_init(pcx, &ent);
+		if (rc != 0) {
+			D__DEBUG(DB_EPC, "%s context enter failed: %d\n",
+				pcx_name(pcx), rc);
+			D__GOTO(out, rc);
 		}
 
+		/* enter the subtree */
+		rc = epoch_discard(pcx, &empty);
+		/* exit from the context of subtree */
+		purge_ctx_fini(pcx, rc);
+		if (rc != 0)
+			D__GOTO(out, rc);
+
 		if (!empty) { /* subtree or record is not empty */
 			opc = ITR_NEXT;
 			continue;
@@ -787,8 +723,8 @@ epoch_discard(struct purge_context *pcx, int *empty_ret)
 			D__GOTO(out, rc);
 
 		discarded++;
-		/* need to probe again after the delete */
-		opc = ITR_PROBE_ANCHOR;
+		/* the snapshot iterator still points to the deleted key */
+		opc = ITR_NEXT;
 	}
 	D__DEBUG(DB_EPC, "Discard %d of %d %s(s)\n",
 		discarded, found, pcx_name(pcx));
@@ -809,6 +745,7 @@ vos_epoch_discard(daos_handle_t coh, daos_epoch_range_t *epr, uuid_t cookie)
 	struct vos_container	*cont = vos_hdl2cont(coh);
 	struct purge_context	pcx;
 	daos_epoch_t		max_epoch;
+	uint64_t		start;
 	int			rc;
 
 	D__DEBUG(DB_EPC, "Epoch discard for "DF_UUID" ["DF_U64", "DF_U64"]\n",
@@ -832,14 +769,18 @@ vos_epoch_discard(daos_handle_t coh, daos_epoch_range_t *epr, uuid_t cookie)
 	pcx.pc_type	    = VOS_ITER_NONE;
 	pcx.pc_param.ip_hdl = coh;
 	pcx.pc_param.ip_epr = *epr;
+	/* only objects modified since the last aggregation can be discarded */
+	pcx.pc_param.ip_flags = VOS_IT_OBJ_DIRTY;
 	uuid_copy(pcx.pc_cookie, cookie);
 	purge_set_iter_expr(&pcx, epr);
 
 	rc = purge_ctx_init(&pcx, NULL);
 	D__ASSERT(rc == 0);
 
+	start = daos_metric_tick();
 	rc = epoch_discard(&pcx, NULL);
 	purge_ctx_fini(&pcx, rc);
+	daos_metric_tock(DMH_AGG, start);
 	return rc;
 }
 
@@ -852,8 +793,14 @@ vos_epoch_aggregate(daos_handle_t coh, daos_unit_oid_t oid,
 	struct purge_context	pcx;
 	vos_iter_entry_t	oid_entry;
 	vos_cont_info_t		vc_info;
+	uint64_t		start;
 
 	if (daos_unit_oid_is_null(oid)) {
+		/* all dirty objects in this range have been aggregated */
+		rc = vos_dirty_obj_prune(vos_hdl2cont(coh), epr);
+		if (rc != 0)
+			return rc;
+
 		vos_cont_set_purged_epoch(coh, epr->epr_hi);
 		*finished = true;
 		D__DEBUG(DB_EPC, "Setting the epoch in container\n");
@@ -903,7 +850,63 @@ vos_epoch_aggregate(daos_handle_t coh, daos_unit_oid_t oid,
 	rc = purge_ctx_init(&pcx, &oid_entry);
 	D__ASSERT(rc == 0);
 
+	start = daos_metric_tick();
+	rc = epoch_aggregate(&pcx, NULL, credits, anchor, finished);
+	purge_ctx_fini(&pcx, rc);
+	daos_metric_tock(DMH_AGG, start);
+	if (rc == 0 && *finished)
+		daos_metric_inc(DMC_AGG_OBJ, 1);
+	return rc;
+}
+
+int
+vos_epoch_coalesce(daos_handle_t coh, daos_unit_oid_t oid,
+		   daos_epoch_range_t *epr, unsigned int *credits,
+		   vos_purge_anchor_t *anchor, bool *finished)
+{
+	struct purge_context	pcx;
+	vos_iter_entry_t	oid_entry;
+	uint64_t		start;
+	int			rc;
+
+	D__DEBUG(DB_EPC, "Coalesce "DF_OID" ["DF_U64"->"DF_U64"]\n",
+		DP_OID(oid.id_pub), epr->epr_lo, epr->epr_hi);
+
+	if (epr->epr_hi < epr->epr_lo) {
+		D__ERROR("range::epr_lo cannot be lesser than range::epr_hi\n");
+		return -DER_INVAL;
+	}
+
+	if (!purge_anchor_is_valid(anchor)) {
+		D__ERROR("Invalid anchor provided\n");
+		return -DER_INVAL;
+	}
+
+	*finished = false;
+	if (purge_oid_is_aggregated(anchor, oid)) {
+		*finished = true;
+		return 0;
+	}
+
+	memset(&pcx, 0, sizeof(pcx));
+	pcx.pc_type		= VOS_ITER_OBJ;
+	pcx.pc_param.ip_hdl	= coh;
+	pcx.pc_param.ip_epr	= *epr;
+	pcx.pc_coalesce		= true;
+	purge_set_iter_expr(&pcx, epr);
+
+	oid_entry.ie_oid	= oid;
+	rc = purge_ctx_init(&pcx, &oid_entry);
+	if (rc == -DER_NONEXIST) { /* object has been discarded */
+		*finished = true;
+		return 0;
+	}
+	if (rc != 0)
+		return rc;
+
+	start = daos_metric_tick();
 	rc = epoch_aggregate(&pcx, NULL, credits, anchor, finished);
 	purge_ctx_fini(&pcx, rc);
+	daos_metric_tock(DMH_VOS_COALESCE, start);
 	return rc;
 }
@@ -78,7 +78,7 @@ vos_iov2rec_bundle(daos_iov_t *val_iov)
  * hashed key for the key-btree, it is stored in btr_record::rec_hkey
  */
 struct kb_hkey {
-	/** murmur64 hash */
+	/** murmur64 hash, it is the key prefix of BTR_FEAT_HKEY_PREFIX */
 	uint64_t	kb_hash1;
 	/** reserved: the second hash to avoid hash collison of murmur64 */
 	uint64_t	kb_hash2;
@@ -170,6 +170,87 @@ kb_hkey_size(struct btr_instance *tins)
 	return sizeof(struct kb_hkey);
 }
 
+/**
+ * Convert a key of ordered key tree to two 64-bit integers, comparing them
+ * numerically has the same result as comparing the keys in the tree order.
+ *
+ * A lexical key is zero padded to 15 bytes and followed by its size, so
+ * the shorter one of two keys with the same prefix is less than the other.
+ * Key size is supposed to be validated by kb_key_check() before insertion.
+ */
+static void
+kb_key_order(uint64_t feats, daos_key_t *key, uint64_t *hash1,
+	     uint64_t *hash2)
+{
+	unsigned char	buf[2 * sizeof(uint64_t)];
+	int		i;
+
+	memset(buf, 0, sizeof(buf));
+	if (feats & VOS_KEY_CMP_UINT64) {
+		memcpy(hash1, key->iov_buf, min(key->iov_len, sizeof(*hash1)));
+		if (key->iov_len < sizeof(*hash1))
+			memset((char *)hash1 + key->iov_len, 0,
+			       sizeof(*hash1) - key->iov_len);
+		*hash2 = 0;
+		return;
+	}
+
+	D__ASSERT(feats & VOS_KEY_CMP_LEXICAL);
+	memcpy(buf, key->iov_buf, min(key->iov_len, DAOS_OF_KEY_LEXICAL_MAX));
+	/* an oversized key can never match any stored key */
+	buf[DAOS_OF_KEY_LEXICAL_MAX] = min(key->iov_len,
+					   DAOS_OF_KEY_LEXICAL_MAX + 1);
+
+	for (*hash1 = *hash2 = 0, i = 0; i < sizeof(uint64_t); i++) {
+		*hash1 = (*hash1 << 8) | buf[i];
+		*hash2 = (*hash2 << 8) | buf[i + sizeof(uint64_t)];
+	}
+}
+
+/** check if the key can be stored in a tree with feature bits \a feats */
+static int
+kb_key_check(uint64_t feats, daos_key_t *key)
+{
+	if ((feats & VOS_KEY_CMP_UINT64) && key->iov_len != sizeof(uint64_t)) {
+		D__ERROR("Key size %d should be %d for uint64 ordered key\n",
+			(int)key->iov_len, (int)sizeof(uint64_t));
+		return -DER_INVAL;
+	}
+
+	if ((feats & VOS_KEY_CMP_LEXICAL) &&
+	    key->iov_len > DAOS_OF_KEY_LEXICAL_MAX) {
+		D__ERROR("Key size %d is too large for lexical ordered key\n",
+			(int)key->iov_len);
+		return -DER_INVAL;
+	}
+	return 0;
+}
+
+/**
+ * Compare two keys of an ordered key tree.
+ *
+ * \param feats	[IN]	Feature bits of the tree, VOS_KEY_CMP_UINT64 or
+ *			VOS_KEY_CMP_LEXICAL should be set.
+ *
+ * \return		-1, 0, 1 if \a key1 is less than, equal to, or greater
+ *			than \a key2.
+ */
+int
+vos_key_cmp_ordered(uint64_t feats, daos_key_t *key1, daos_key_t *key2)
+{
+	uint64_t	hash1[2];
+	uint64_t	hash2[2];
+
+	kb_key_order(feats, key1, &hash1[0], &hash1[1]);
+	kb_key_order(feats, key2, &hash2[0], &hash2[1]);
+
+	if (hash1[0] != hash2[0])
+		return hash1[0] < hash2[0] ? -1 : 1;
+	if (hash1[1] != hash2[1])
+		return hash1[1] < hash2[1] ? -1 : 1;
+	return 0;
+}
+
 /** generate hkey */
 static void
 kb_hkey_gen(struct btr_instance *tins, daos_iov_t *key_iov, void *hkey)
@@ -177,10 +258,16 @@ kb_hkey_gen(struct btr_instance *tins, daos_iov_t *key_iov, void *hkey)
 	struct kb_hkey		*kkey  = (struct kb_hkey *)hkey;
 	struct vos_key_bundle	*kbund = vos_iov2key_bundle(key_iov);
 	daos_key_t		*key   = kbund->kb_key;
+	uint64_t		 feats = tins->ti_root->tr_feats;
 
-	kkey->kb_hash1  = daos_hash_murmur64(key->iov_buf, key->iov_len,
-					     VOS_BTR_MUR_SEED);
-	kkey->kb_hash2  = daos_hash_string_u32(key->iov_buf, key->iov_len);
+	if (feats & VOS_KEY_CMP_MASK) {
+		kb_key_order(feats, key, &kkey->kb_hash1, &kkey->kb_hash2);
+	} else {
+		kkey->kb_hash1 = daos_hash_murmur64(key->iov_buf, key->iov_len,
+						    VOS_BTR_MUR_SEED);
+		kkey->kb_hash2 = daos_hash_string_u32(key->iov_buf,
+						      key->iov_len);
+	}
 	kkey->kb_epc_lo = kbund->kb_epr->epr_lo;
 	kkey->kb_epc_hi = kbund->kb_epr->epr_hi;
 }
@@ -263,6 +350,7 @@ kb_rec_alloc(struct btr_instance *tins, daos_iov_t *key_iov,
 	struct vos_krec_df	*krec;
 	struct vos_btr_attr	*ta;
 	struct umem_attr	 uma;
+	uint64_t		 feats;
 	daos_handle_t		 btr_oh = DAOS_HDL_INVAL;
 	daos_handle_t		 evt_oh = DAOS_HDL_INVAL;
 	int			 rc;
@@ -270,6 +358,10 @@ kb_rec_alloc(struct btr_instance *tins, daos_iov_t *key_iov,
 	kbund = vos_iov2key_bundle(key_iov);
 	rbund = vos_iov2rec_bundle(val_iov);
 
+	rc = kb_key_check(tins->ti_root->tr_feats, kbund->kb_key);
+	if (rc != 0)
+		return rc;
+
 	rec->rec_mmid = umem_zalloc(&tins->ti_umm,
 				    vos_krec_size(rbund->rb_tclass, rbund));
 	if (UMMID_IS_NULL(rec->rec_mmid))
@@ -283,8 +375,16 @@ kb_rec_alloc(struct btr_instance *tins, daos_iov_t *key_iov,
 
 	D__DEBUG(DB_TRACE, "Create dbtree %s\n", ta->ta_name);
 
+	/* akey tree inherits the key order specified for akeys of the object */
+	feats = ta->ta_feats;
+	if (tins->ti_root->tr_class == VOS_BTR_DKEY) {
+		D_CASSERT(VOS_AKEY_CMP_UINT64 << 2 == VOS_KEY_CMP_UINT64);
+		D_CASSERT(VOS_AKEY_CMP_LEXICAL << 2 == VOS_KEY_CMP_LEXICAL);
+		feats |= (tins->ti_root->tr_feats & VOS_AKEY_CMP_MASK) << 2;
+	}
+
 	umem_attr_get(&tins->ti_umm, &uma);
-	rc = dbtree_create_inplace(ta->ta_class, ta->ta_feats, ta->ta_order,
+	rc = dbtree_create_inplace(ta->ta_class, feats, ta->ta_order,
 				   &uma, &krec->kr_btr, &btr_oh);
 	if (rc != 0) {
 		D__ERROR("Failed to create btree: %d\n", rc);
@@ -337,10 +437,20 @@ kb_rec_free(struct btr_instance *tins, struct btr_record *rec, void *args)
 	/* has subtree? */
 	if (krec->kr_btr.tr_order) {
 		rc = dbtree_open_inplace(&krec->kr_btr, &uma, &toh);
-		if (rc != 0)
+		if (rc != 0) {
 			D__ERROR("Failed to open btree: %d\n", rc);
-		else
-			dbtree_destroy(toh);
+		} else {
+			rc = dbtree_destroy(toh);
+			if (rc != 0) {
+				/* keep the record, e.g. the subtree root is
+				 * pinned by a snapshot.
+				 */
+				D__DEBUG(DB_TRACE, "Failed to destroy btree: "
+					 "%d\n", rc);
+				dbtree_close(toh);
+				return rc;
+			}
+		}
 	}
 
 	if ((krec->kr_bmap & KREC_BF_EVT) && krec->kr_evt[0].tr_order) {
@@ -440,15 +550,62 @@ struct svb_hkey {
 	uuid_t		sv_cookie;
 };
 
+/** inline value of the record, it is only valid if rec_mmid is NULL */
+static inline struct vos_irec_inline_df *
+svb_rec2inline(struct btr_record *rec)
+{
+	return (struct vos_irec_inline_df *)
+		&rec->rec_hkey[sizeof(struct svb_hkey)];
+}
+
 /**
- * Set size for the record and returns write buffer address of the record,
- * so caller can copy/rdma data into it.
+ * Value can be stored inline if it is small and has no checksum. Data of
+ * zero-copy update is already in rb_mmid, otherwise caller should provide
+ * the data, because the record could be copied to the tree node after
+ * allocation.
+ */
+static bool
+svb_rec_can_inline(struct btr_instance *tins, struct vos_rec_bundle *rbund)
+{
+	if (!(tins->ti_root->tr_feats & BTR_FEAT_REC_INLINE))
+		return false;
+
+	if (!UMMID_IS_NULL(rbund->rb_mmid) ||
+	    rbund->rb_rsize > VOS_IREC_INLINE_MAX)
+		return false;
+
+	if (rbund->rb_csum != NULL && rbund->rb_csum->cs_len != 0)
+		return false;
+
+	return rbund->rb_rsize == 0 || rbund->rb_iov->iov_buf != NULL;
+}
+
+static void
+svb_rec_copy_in_inline(struct btr_record *rec, struct vos_rec_bundle *rbund)
+{
+	struct vos_irec_inline_df *inl = svb_rec2inline(rec);
+	daos_iov_t		  *iov = rbund->rb_iov;
+
+	inl->ii_ver	= rbund->rb_ver;
+	inl->ii_size	= iov->iov_len;
+	inl->ii_pad16	= 0;
+	if (inl->ii_size != 0)
+		memcpy(inl->ii_body, iov->iov_buf, inl->ii_size);
+
+	if (rbund->rb_csum != NULL)
+		rbund->rb_csum->cs_csum = NULL;
+}
+
+/**
+ * Set size for the record and copy data and checksum into it if caller has
+ * provided them, otherwise returns write buffer address of the record, so
+ * caller can copy/rdma data into it.
  */
 static int
 svb_rec_copy_in(struct btr_instance *tins, struct btr_record *rec,
 		struct vos_key_bundle *kbund, struct vos_rec_bundle *rbund)
 {
-	struct vos_irec_df	*irec	= vos_rec2irec(tins, rec);
+	struct vos_irec_df	*irec;
 	daos_csum_buf_t		*csum	= rbund->rb_csum;
 	daos_iov_t		*iov	= rbund->rb_iov;
 	struct svb_hkey		*skey;
@@ -460,7 +617,12 @@ svb_rec_copy_in(struct btr_instance *tins, struct btr_record *rec,
 	/** Updating the cookie for this update */
 	uuid_copy(skey->sv_cookie, rbund->rb_cookie);
 
-	/** XXX: fix this after CSUM is added to iterator */
+	if (UMMID_IS_NULL(rec->rec_mmid)) {
+		svb_rec_copy_in_inline(rec, rbund);
+		return 0;
+	}
+
+	irec = vos_rec2irec(tins, rec);
 	irec->ir_cs_size = csum->cs_len;
 	irec->ir_cs_type = csum->cs_type;
 	irec->ir_size	 = iov->iov_len;
@@ -472,8 +634,15 @@ svb_rec_copy_in(struct btr_instance *tins, struct btr_record *rec,
 		return 0;
 	}
 
-	csum->cs_csum = vos_irec2csum(irec);
-	iov->iov_buf = vos_irec2data(irec);
+	if (csum->cs_len != 0 && csum->cs_csum != NULL)
+		memcpy(vos_irec2csum(irec), csum->cs_csum, csum->cs_len);
+	else
+		csum->cs_csum = vos_irec2csum(irec);
+
+	if (iov->iov_buf != NULL) /* data provided by caller */
+		memcpy(vos_irec2data(irec), iov->iov_buf, iov->iov_len);
+	else
+		iov->iov_buf = vos_irec2data(irec);
 	return 0;
 }
 
@@ -485,7 +654,7 @@ svb_rec_copy_out(struct btr_instance *tins, struct btr_record *rec,
 		 struct vos_key_bundle *kbund, struct vos_rec_bundle *rbund)
 {
 	struct svb_hkey	   *skey = (struct svb_hkey *)&rec->rec_hkey[0];
-	struct vos_irec_df *irec  = vos_rec2irec(tins, rec);
+	struct vos_irec_df *irec;
 	daos_csum_buf_t	   *csum  = rbund->rb_csum;
 	daos_iov_t	   *iov   = rbund->rb_iov;
 
@@ -495,6 +664,23 @@ svb_rec_copy_out(struct btr_instance *tins, struct btr_record *rec,
 	}
 	uuid_copy(rbund->rb_cookie, skey->sv_cookie);
 
+	if (UMMID_IS_NULL(rec->rec_mmid)) {
+		struct vos_irec_inline_df *inl = svb_rec2inline(rec);
+
+		iov->iov_len = iov->iov_buf_len = inl->ii_size;
+		if (inl->ii_size != 0) {
+			iov->iov_buf	= inl->ii_body;
+			csum->cs_len	= 0;
+			csum->cs_type	= 0;
+			csum->cs_csum	= NULL;
+		}
+		rbund->rb_rsize	= inl->ii_size;
+		rbund->rb_ver	= inl->ii_ver;
+		rbund->rb_mmid	= UMMID_NULL;
+		return 0;
+	}
+
+	irec = vos_rec2irec(tins, rec);
 	/* NB: return record address, caller should copy/rma data for it */
 	iov->iov_len = iov->iov_buf_len = irec->ir_size;
 	if (irec->ir_size != 0) {
@@ -505,6 +691,7 @@ svb_rec_copy_out(struct btr_instance *tins, struct btr_record *rec,
 	}
 	rbund->rb_rsize	= irec->ir_size;
 	rbund->rb_ver	= irec->ir_ver;
+	rbund->rb_mmid	= rec->rec_mmid;
 	return 0;
 }
 
@@ -519,6 +706,14 @@ svb_hkey_size(struct btr_instance *tins)
 	return sizeof(struct svb_hkey);
 }
 
+/** size of the inline value stored after hashed-key */
+static int
+svb_rec_inline_size(struct btr_instance *tins)
+{
+	D_CASSERT(sizeof(struct vos_irec_inline_df) <= BTR_REC_INLINE_MAX);
+	return sizeof(struct vos_irec_inline_df);
+}
+
 /** generate hkey */
 static void
 svb_hkey_gen(struct btr_instance *tins, daos_iov_t *key_iov, void *hkey)
@@ -558,7 +753,9 @@ svb_rec_alloc(struct btr_instance *tins, daos_iov_t *key_iov,
 	kbund = vos_iov2key_bundle(key_iov);
 	rbund = vos_iov2rec_bundle(val_iov);
 
-	if (UMMID_IS_NULL(rbund->rb_mmid)) {
+	if (svb_rec_can_inline(tins, rbund)) {
+		rec->rec_mmid = UMMID_NULL;
+	} else if (UMMID_IS_NULL(rbund->rb_mmid)) {
 		rec->rec_mmid = umem_alloc(&tins->ti_umm,
 					   vos_irec_size(rbund));
 		if (UMMID_IS_NULL(rec->rec_mmid))
@@ -615,11 +812,25 @@ svb_rec_update(struct btr_instance *tins, struct btr_record *rec,
 
 	kbund = vos_iov2key_bundle(key_iov);
 	rbund = vos_iov2rec_bundle(val_iov);
+	skey = (struct svb_hkey *)&rec->rec_hkey[0];
 
-	if (!UMMID_IS_NULL(rbund->rb_mmid) ||
+	if (UMMID_IS_NULL(rec->rec_mmid)) {
+		/* inline value can be overwritten by another inline value */
+		if (!svb_rec_can_inline(tins, rbund))
+			return -DER_NO_PERM;
+
+		D__DEBUG(DB_IO, "Overwrite inline epoch "DF_U64"\n",
+			 skey->sv_epoch);
+		umem_tx_add_ptr(&tins->ti_umm, skey, sizeof(*skey) +
+				sizeof(struct vos_irec_inline_df));
+		return svb_rec_copy_in(tins, rec, kbund, rbund);
+	}
+
+	if (!UMMID_IS_NULL(rbund->rb_mmid) || svb_rec_can_inline(tins, rbund) ||
 	    !vos_irec_size_equal(vos_rec2irec(tins, rec), rbund)) {
 		/* This function should return -DER_NO_PERM to dbtree if:
 		 * - it is a rdma, the original record should be replaced.
+		 * - the new value can be stored inline.
 		 * - the new record size cannot match the original one, so we
 		 *   need to realloc and copyin data to the new space.
 		 *
@@ -629,7 +840,6 @@ svb_rec_update(struct btr_instance *tins, struct btr_record *rec,
 		return -DER_NO_PERM;
 	}
 
-	skey = (struct svb_hkey *)&rec->rec_hkey[0];
 	D__DEBUG(DB_IO, "Overwrite epoch "DF_U64"\n", skey->sv_epoch);
 
 	umem_tx_add(&tins->ti_umm, rec->rec_mmid, vos_irec_size(rbund));
@@ -638,6 +848,7 @@ svb_rec_update(struct btr_instance *tins, struct btr_record *rec,
 
 static btr_ops_t singv_btr_ops = {
 	.to_hkey_size		= svb_hkey_size,
+	.to_rec_inline_size	= svb_rec_inline_size,
 	.to_hkey_gen		= svb_hkey_gen,
 	.to_hkey_cmp		= svb_hkey_cmp,
 	.to_rec_alloc		= svb_rec_alloc,
@@ -653,21 +864,21 @@ static struct vos_btr_attr vos_btr_attrs[] = {
 	{
 		.ta_class	= VOS_BTR_DKEY,
 		.ta_order	= VOS_BTR_ORDER,
-		.ta_feats	= 0,
+		.ta_feats	= BTR_FEAT_HKEY_PREFIX | BTR_FEAT_REC_SUBTREE,
 		.ta_name	= "vos_dkey",
 		.ta_ops		= &key_btr_ops,
 	},
 	{
 		.ta_class	= VOS_BTR_AKEY,
 		.ta_order	= VOS_BTR_ORDER,
-		.ta_feats	= 0,
+		.ta_feats	= BTR_FEAT_HKEY_PREFIX | BTR_FEAT_REC_SUBTREE,
 		.ta_name	= "vos_akey",
 		.ta_ops		= &key_btr_ops,
 	},
 	{
 		.ta_class	= VOS_BTR_SINGV,
 		.ta_order	= VOS_BTR_ORDER,
-		.ta_feats	= 0,
+		.ta_feats	= BTR_FEAT_REC_INLINE,
 		.ta_name	= "singv",
 		.ta_ops		= &singv_btr_ops,
 	},
@@ -693,8 +904,21 @@ vos_obj_tree_init(struct vos_object *obj)
 
 	D__ASSERT(obj->obj_df);
 	if (obj->obj_df->vo_tree.tr_class == 0) {
+		daos_ofeat_t	ofeats = daos_obj_id2feat(obj->obj_id.id_pub);
+		uint64_t	feats = ta->ta_feats;
+
+		if (ofeats & DAOS_OF_DKEY_UINT64)
+			feats |= VOS_KEY_CMP_UINT64;
+		else if (ofeats & DAOS_OF_DKEY_LEXICAL)
+			feats |= VOS_KEY_CMP_LEXICAL;
+
+		if (ofeats & DAOS_OF_AKEY_UINT64)
+			feats |= VOS_AKEY_CMP_UINT64;
+		else if (ofeats & DAOS_OF_AKEY_LEXICAL)
+			feats |= VOS_AKEY_CMP_LEXICAL;
+
 		D__DEBUG(DB_DF, "Create btree for object\n");
-		rc = dbtree_create_inplace(ta->ta_class, ta->ta_feats,
+		rc = dbtree_create_inplace(ta->ta_class, feats,
 					   ta->ta_order, vos_obj2uma(obj),
 					   &obj->obj_df->vo_tree,
 					   &obj->obj_toh);
@@ -729,7 +953,15 @@ vos_obj_tree_register(void)
 	int		     rc = 0;
 
 	for (ta = &vos_btr_attrs[0]; ta->ta_class != VOS_BTR_END; ta++) {
-		rc = dbtree_class_register(ta->ta_class, ta->ta_feats,
+		uint64_t feats = ta->ta_feats;
+
+		/* key order is selected while creating the tree */
+		if (ta->ta_class == VOS_BTR_DKEY)
+			feats |= VOS_KEY_CMP_MASK | VOS_AKEY_CMP_MASK;
+		else if (ta->ta_class == VOS_BTR_AKEY)
+			feats |= VOS_KEY_CMP_MASK;
+
+		rc = dbtree_class_register(ta->ta_class, feats,
 					   ta->ta_ops);
 		if (rc != 0) {
 			D__ERROR("Failed to register %s: %d\n", ta->ta_name, rc);